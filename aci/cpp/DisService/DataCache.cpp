@@ -24,6 +24,7 @@
 #include "DisServiceDataCacheQuery.h"
 #include "DisServiceDefs.h"
 #include "Message.h"
+#include "SharedBuffer.h"
 
 #if defined (USE_SQLITE)
     #include "SQLMessageHeaderStorage.h"
@@ -166,9 +167,9 @@ void DataCache::getDataInternal (const char *pszId, Result &result)
     switch (pEntry->ui8Type) {
         case DC_Entry:
             result.ui8StorageType = MEMORY;
-            result.pData = malloc (pEntry->ui32Length);
+            result.pData = ((Entry*)pEntry)->pBuf->copy();
             if (result.pData != NULL) {
-                memcpy (result.pData, ((Entry*)pEntry)->pData, pEntry->ui32Length);
+                dataCopied (pEntry->ui32Length);
             }
             break;
 
@@ -256,6 +257,29 @@ int DataCache::release (const char *pszId, void *pData)
     return 0;
 }
 
+SharedBuffer * DataCache::getSharedData (const char *pszId)
+{
+    if (pszId == NULL) {
+        return NULL;
+    }
+    if (isAllChunksMessageID (pszId)) {
+        // The large object has to be reassembled
+        return DataCacheInterface::getSharedData (pszId);
+    }
+
+    _m.lock (21);
+    Entry *pEntry = _dataCache.get (pszId);
+    if ((pEntry == NULL) || (pEntry->ui8Type != DC_Entry) || (pEntry->pBuf == NULL)) {
+        _m.unlock (21);
+        return NULL;
+    }
+    SharedBuffer *pBuf = pEntry->pBuf->retain();
+    _m.unlock (21);
+
+    dataShared (pBuf->getLength());
+    return pBuf;
+}
+
 PtrLList<Message> * DataCache::getMatchingFragments (const char *pszGroupName, const char *pszSenderNodeId,
                                                      uint32 ui32MsgSeqId, uint8 ui8ChunkId, uint32 ui32StartOffset,
                                                      uint32 ui32EndOffset)
@@ -421,8 +445,11 @@ int DataCache::addDataNoNotifyInternal (MessageHeader *pMessageHeader, const voi
     Entry *pEntry = new Entry();
     pEntry->ui8Type = DC_Entry;
     pEntry->ui32Length = pMessageHeader->getFragmentLength();
-    pEntry->pData = malloc (pEntry->ui32Length);
-    memcpy (pEntry->pData, pData, pEntry->ui32Length);
+    pEntry->pBuf = SharedBuffer::copyOf (pData, pEntry->ui32Length);
+    if (pEntry->pBuf == NULL) {
+        delete pEntry;
+        return -4;
+    }
 
     int rc = addDataNoNotifyInternal (pMessageHeader, pEntry, uiListenerID);
     if (rc != 0) {
@@ -446,11 +473,12 @@ int DataCache::addDataNoNotifyInternal (MessageHeader *pMessageHeader, Entry *pE
         return -1;
     }
 
-    if (false == cleanCache (pEntry->ui32Length, pMessageHeader, pEntry->pData)) {
+    void *pData = (void *) pEntry->pBuf->getData();
+    if (false == cleanCache (pEntry->ui32Length, pMessageHeader, pData)) {
         return -2;
     }
 
-    Message msg (pMessageHeader, pEntry->pData);
+    Message msg (pMessageHeader, pData);
     if (0 == _pDB->insert (&msg)) {
         _dataCache.put (pMessageHeader->getMsgId(), pEntry);
         checkAndLogMsg (pszMethodName, Logger::L_Info,
@@ -536,14 +564,17 @@ DataCache::EntryHeader::~EntryHeader()
 DataCache::Entry::Entry()
     : EntryHeader (DC_Entry)
 {
-    pData = NULL;
+    pBuf = NULL;
     ui32Length = 0;
 }
 
 DataCache::Entry::~Entry()
 {
-    free (pData);
-    pData = NULL;
+    // The buffer is deallocated when the last reference is released
+    if (pBuf != NULL) {
+        pBuf->release();
+        pBuf = NULL;
+    }
     ui32Length = 0;
 }
 
@@ -40,6 +40,7 @@ namespace IHMC_ACI
     class DataCacheExpirationController;
     class Message;
     class MessageHeader;
+    class SharedBuffer;
     class StorageInterface;
     #if defined (USE_SQLITE)
         class SQLMessageHeaderStorage;
@@ -71,6 +72,13 @@ namespace IHMC_ACI
             void getData (const char *pszId, Result &result);
             int release (const char *pszId, Result &result);
 
+            /**
+             * Returns a reference to the stored buffer, without copying it.
+             * Large objects that need to be reassembled are returned as a
+             * new buffer.
+             */
+            SharedBuffer * getSharedData (const char *pszId);
+
             // GET THE WHOLE MESSAGE (MessageInfo AND Data)
             NOMADSUtil::PtrLList<Message> * getMatchingFragments (const char *pszGroupName, const char *pszSenderNodeId,
                                                                   uint32 ui32MsgSeqId, uint8 ui8ChunkId,
@@ -102,9 +110,8 @@ namespace IHMC_ACI
 
         protected:
             /**
-             * NOTE: DataCache does not make a copy of the data, therefore, the caller
-             *       must not modify or delete the value of data after it has been added
-             *       into the cache.
+             * NOTE: DataCache makes a copy of the data into an immutable SharedBuffer,
+             *       that is then shared with the callers of getSharedData().
              * NOTE: This data cache implementation stores the MessageHeaders in the data
              * base while the data is kept in a StringHashtable.
              */
@@ -149,7 +156,7 @@ namespace IHMC_ACI
                 ~Entry (void);
                 uint32 getLength (void);
 
-                void *pData;
+                SharedBuffer *pBuf;
             };
 
             struct FileEntry : public EntryHeader
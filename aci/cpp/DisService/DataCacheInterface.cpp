@@ -27,6 +27,7 @@
 #include "Message.h"
 #include "MessageInfo.h"
 #include "PersistentDataCache.h"
+#include "SharedBuffer.h"
 
 #include "ChunkingManager.h"
 
@@ -418,6 +419,43 @@ bool DataCacheInterface::cleanCache (uint32 ui32Length, MessageHeader *pMH, void
     return true;
 }
 
+SharedBuffer * DataCacheInterface::getSharedData (const char *pszId)
+{
+    uint32 ui32Len = 0;
+    const void *pData = getData (pszId, ui32Len);
+    if (pData == NULL) {
+        return NULL;
+    }
+    SharedBuffer *pBuf = SharedBuffer::adopt ((void *) pData, ui32Len);
+    if (pBuf == NULL) {
+        release (pszId, (void *) pData);
+    }
+    return pBuf;
+}
+
+void DataCacheInterface::getBufferStats (BufferStats &stats)
+{
+    _mBufferStats.lock();
+    stats = _bufferStats;
+    _mBufferStats.unlock();
+}
+
+void DataCacheInterface::dataCopied (uint32 ui32Len)
+{
+    _mBufferStats.lock();
+    _bufferStats.ui32Copies++;
+    _bufferStats.ui64BytesCopied += ui32Len;
+    _mBufferStats.unlock();
+}
+
+void DataCacheInterface::dataShared (uint32 ui32Len)
+{
+    _mBufferStats.lock();
+    _bufferStats.ui32SharedReferences++;
+    _bufferStats.ui64BytesShared += ui32Len;
+    _mBufferStats.unlock();
+}
+
 //==============================================================================
 //  Result
 //==============================================================================
@@ -432,6 +470,15 @@ DataCacheInterface::Result::~Result (void)
 {
 }
 
+//==============================================================================
+//  BufferStats
+//==============================================================================
+DataCacheInterface::BufferStats::BufferStats (void)
+    : ui32Copies (0U), ui64BytesCopied (0U),
+      ui32SharedReferences (0U), ui64BytesShared (0U)
+{
+}
+
 ////////////////////////////// DataCacheFactory ////////////////////////////////
 
 DataCacheInterface * DataCacheFactory::_pDataCache = NULL;
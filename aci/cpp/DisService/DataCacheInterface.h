@@ -28,6 +28,7 @@
 
 #include "DArray2.h"
 #include "FTypes.h"
+#include "Mutex.h"
 #include "PtrLList.h"
 #include "StorageInterface.h"
 #include "StringHashtable.h"
@@ -51,6 +52,7 @@ namespace IHMC_ACI
     class DisServiceDataCacheQuery;
     class MessageHeader;
     class Message;
+    class SharedBuffer;
     class Subscription;
 
     class DataCacheInterface : public Controllable
@@ -102,6 +104,23 @@ namespace IHMC_ACI
                 void *pData;
             };
 
+            /**
+             * Counters on the payloads handed out by the cache.
+             * - ui32Copies/ui64BytesCopied: payloads returned as a copy (by
+             *   getData() and getMessages())
+             * - ui32SharedReferences/ui64BytesShared: payloads returned as a
+             *   reference to the cached buffer (by getSharedData()), that is
+             *   the number of copies, and of bytes, that were saved.
+             */
+            struct BufferStats {
+                BufferStats (void);
+
+                uint32 ui32Copies;
+                uint64 ui64BytesCopied;
+                uint32 ui32SharedReferences;
+                uint64 ui64BytesShared;
+            };
+
             StorageInterface * getStorageInterface (void);
 
             int deregisterAllDataCacheListeners (void);
@@ -234,6 +253,19 @@ namespace IHMC_ACI
             virtual void getData (const char *pszId, Result &result) = 0;
             virtual int release (const char *pszId, Result &result)=0;
 
+            /**
+             * Returns a reference to the data of the message/fragment/chunk
+             * identified by pszId, or NULL if it is not in the cache.
+             * The returned buffer must not be modified, and it must be
+             * released by the caller by calling SharedBuffer::release().
+             * Differently from getData(), the data is not copied when the
+             * implementation of the cache allows it.  The default
+             * implementation wraps the copy returned by getData().
+             */
+            virtual SharedBuffer * getSharedData (const char *pszId);
+
+            void getBufferStats (BufferStats &stats);
+
             char ** getDisseminationServiceIds (const char *pszObjectId, const char *pszInstanceId);
 
             // MISC
@@ -323,6 +355,10 @@ namespace IHMC_ACI
             virtual int deleteDataAndMessageInfo (const char *pszKey,
                                                   bool bIsLatestMessagePushedByNode)=0;
 
+            // Update the counters returned by getBufferStats()
+            void dataCopied (uint32 ui32Len);
+            void dataShared (uint32 ui32Len);
+
         protected:
             uint32 _ui32CacheLimit;
             uint32 _secRange;
@@ -333,6 +369,9 @@ namespace IHMC_ACI
 
         private:
             NOMADSUtil::PtrLList<Message> * getMatchingFragments (NOMADSUtil::PtrLList<MessageHeader> *pMIs);
+
+            BufferStats _bufferStats;
+            NOMADSUtil::Mutex _mBufferStats;
     };
 
     inline StorageInterface * DataCacheInterface::getStorageInterface (void)
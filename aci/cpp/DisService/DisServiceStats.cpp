@@ -360,6 +360,17 @@ void DisServiceStats::dataMessageForwarded (void)
     _ui32DataFragFrwded++;
 }
 
+void DisServiceStats::dataCacheBufferStatsUpdated (uint32 ui32DataCopies, uint64 ui64DataBytesCopied,
+                                                   uint32 ui32SharedDataReferences, uint64 ui64DataBytesShared)
+{
+    _m.lock (185);
+    _dataCacheBufferInfo.ui32DataCopies = ui32DataCopies;
+    _dataCacheBufferInfo.ui64DataBytesCopied = ui64DataBytesCopied;
+    _dataCacheBufferInfo.ui32SharedDataReferences = ui32SharedDataReferences;
+    _dataCacheBufferInfo.ui64DataBytesShared = ui64DataBytesShared;
+    _m.unlock (185);
+}
+
 void DisServiceStats::queryMessageSent (uint16 ui16Size)
 {
     _ui32QueryMessageSent++;
@@ -93,6 +93,10 @@ namespace IHMC_ACI
             void dataMessageReceived (const char *pszRemoteNodeId);
             void dataMessageForwarded (void);
 
+            // Counters on the payloads returned by the data cache (see DataCacheInterface::BufferStats)
+            void dataCacheBufferStatsUpdated (uint32 ui32DataCopies, uint64 ui64DataBytesCopied,
+                                              uint32 ui32SharedDataReferences, uint64 ui64DataBytesShared);
+
         private:
             // Methods internal to DisServiceStats
             Stats * getStatsForClientGroupTag (uint16 ui16ClientId, const char *pszGroupName, uint16 ui16Tag);
@@ -151,6 +155,8 @@ namespace IHMC_ACI
             uint32 _ui32TargetedDuplicateTraffic;
             uint32 _ui32OverheardDuplicateTraffic;
 
+            DisServiceDataCacheBufferInfo _dataCacheBufferInfo;
+
             NOMADSUtil::StringHashtable<DisServiceBasicStatisticsInfoByPeer> _statsByPeer;
     };
 }
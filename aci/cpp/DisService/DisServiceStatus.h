@@ -45,7 +45,8 @@ namespace IHMC_ACI
         DSSF_End = 0x01,
         DSSF_OverallStats = 0x02,
         DSSF_PerClientGroupTagStats = 0x03,
-        DSSF_DuplicateTrafficInfo = 0x04
+        DSSF_DuplicateTrafficInfo = 0x04,
+        DSSF_DataCacheBufferInfo = 0x05
     };
 
     struct DisServiceBasicStatisticsInfo
@@ -115,6 +116,19 @@ namespace IHMC_ACI
         uint32 ui32OverheardDuplicateTraffic;
     };
 
+    // Copies of the cached payloads, and copies saved by sharing the cached buffers
+    struct DisServiceDataCacheBufferInfo
+    {
+        DisServiceDataCacheBufferInfo (void);
+
+        void write (msgpack::packer<msgpack::sbuffer> *pPacker);
+
+        uint32 ui32DataCopies;
+        uint64 ui64DataBytesCopied;
+        uint32 ui32SharedDataReferences;
+        uint64 ui64DataBytesShared;
+    };
+
     struct DisServiceClientGroupTagStatsInfoHeader
     {
         void write (msgpack::packer<msgpack::sbuffer> *pPacker);
@@ -205,6 +219,23 @@ namespace IHMC_ACI
         pPacker->pack_uint32 (ui32TargetedDuplicateTraffic);
         pPacker->pack_uint32 (ui32OverheardDuplicateTraffic);
     }
+
+    inline DisServiceDataCacheBufferInfo::DisServiceDataCacheBufferInfo (void)
+    {
+        ui32DataCopies = 0;
+        ui64DataBytesCopied = 0;
+        ui32SharedDataReferences = 0;
+        ui64DataBytesShared = 0;
+    }
+
+    inline void DisServiceDataCacheBufferInfo::write (msgpack::packer<msgpack::sbuffer> *pPacker)
+    {
+        if (pPacker == NULL) return;
+        pPacker->pack_uint32 (ui32DataCopies);
+        pPacker->pack_uint64 (ui64DataBytesCopied);
+        pPacker->pack_uint32 (ui32SharedDataReferences);
+        pPacker->pack_uint64 (ui64DataBytesShared);
+    }
 }
 
 #endif   // #ifndef INCL_DIS_SERVICE_STATUS_H
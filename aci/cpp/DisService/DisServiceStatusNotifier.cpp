@@ -161,6 +161,10 @@ int DisServiceStatusNotifier::sendSummaryStats (DisServiceStats *pStats)
         pDSBSIByPeer->write (&_packer);
     }
 
+    ui8Flags = DSSF_DataCacheBufferInfo;
+    _packer.pack_short (ui8Flags);
+    pStats->_dataCacheBufferInfo.write (&_packer);
+
     ui8Flags = DSSF_End;
     _packer.pack_short (ui8Flags);
 
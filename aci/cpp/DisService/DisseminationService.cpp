@@ -49,6 +49,7 @@
 #include "ReceivedMessagesInterface.h"
 #include "RequestsState.h"
 #include "SessionId.h"
+#include "SharedBuffer.h"
 #include "SQLMessageHeaderStorage.h"
 #include "Subscription.h"
 #include "SubscriptionFactory.h"
@@ -829,23 +830,26 @@ int DisseminationService::pushInternal (uint16 ui16ClientId, char *pszMsgId)
     MessageHeader *pMH = _pDataCacheInterface->getMessageInfo (pszMsgId);
     assert (!pMH->isChunk());
 
-    const void *pData = _pDataCacheInterface->getData (pszMsgId);
+    SharedBuffer *pData = _pDataCacheInterface->getSharedData (pszMsgId);
     if (pMH == nullptr || pData == nullptr) {
+        if (pData != nullptr) {
+            pData->release();
+        }
         return -3;
     }
 
     void *pDataCopy = malloc (pMH->getTotalMessageLength());
-    memcpy (pDataCopy, pData, pMH->getTotalMessageLength());
+    memcpy (pDataCopy, pData->getData(), pMH->getTotalMessageLength());
     Message *pMsgCopy = new Message (pMH->clone(), pDataCopy);
     _pSubscriptionState->messageArrived (pMsgCopy, nullptr); // send to other applications
                                                           // running on the same instance
                                                           // of DisService.
                                                           // SubscriptionState deallocates it!
-    Message msg (pMH, pData);
+    Message msg (pMH, pData->getData());
     int rc = pushInternal (ui16ClientId, &msg);
 
     //first release the data, because when you release pMH, it gets deleted
-    _pDataCacheInterface->release (pMH->getMsgId(), (void*) pData);
+    pData->release();
     _pDataCacheInterface->release (pMH->getMsgId(), pMH);
     return rc;
 }
@@ -2243,7 +2247,7 @@ void DisseminationService::run (void)
             while ((pCurr = pNext) != nullptr) {
                 pNext = pMessagesToNotify->getNext();
                 MessageHeader *pMH = _pDataCacheInterface->getMessageInfo (pCurr->msgId.c_str());
-                const void *pData = _pDataCacheInterface->getData (pCurr->msgId.c_str());
+                SharedBuffer *pData = _pDataCacheInterface->getSharedData (pCurr->msgId.c_str());
                 if (pMH != nullptr && pData != nullptr) {
                     bool bIsMetadata;
                     bool bIsMetadataWrappedInData;
@@ -2255,14 +2259,16 @@ void DisseminationService::run (void)
                         bIsMetadata = pMI->isMetaData();
                         bIsMetadataWrappedInData = pMI->isMetaDataWrappedInData();
                     }
-                    Message msg (pMH, pData);
+                    Message msg (pMH, pData->getData());
                     _mToListeners.lock (267);
                     notifyDisseminationServiceListener (pCurr->ui16ClientId, &msg, bIsMetadata,
                                                         bIsMetadataWrappedInData, pCurr->searchId);
                     _mToListeners.unlock (267);
                 }
                 _pDataCacheInterface->release (pCurr->msgId.c_str(), pMH);
-                _pDataCacheInterface->release (pCurr->msgId.c_str(), (void*)pData);
+                if (pData != nullptr) {
+                    pData->release();
+                }
                 pMessagesToNotify->remove (pCurr);
                 delete pCurr;
             }
@@ -2492,6 +2498,12 @@ int DisseminationService::sendStatus (void)
     int retStats, retTopology;
     retStats = retTopology = 0;
     if ((_pStatusNotifier) && (_pStats)) {
+        if (_pDataCacheInterface != nullptr) {
+            DataCacheInterface::BufferStats bufferStats;
+            _pDataCacheInterface->getBufferStats (bufferStats);
+            _pStats->dataCacheBufferStatsUpdated (bufferStats.ui32Copies, bufferStats.ui64BytesCopied,
+                                                  bufferStats.ui32SharedReferences, bufferStats.ui64BytesShared);
+        }
         retStats = _pStatusNotifier->sendSummaryStats (_pStats);
         //retTopology  = _pStatusNotifier->sendNeighborList ((const char **) _pPeerState->getAllNeighborIPs());
     }
@@ -2786,14 +2798,18 @@ int DisseminationService::handleHistoryRequestMessage (DisServiceHistoryRequest
                             }*/
 
                             for (MessageHeader *pMH = pMHs->getFirst(); pMH != nullptr; pMH = pMHs->getNext()) {
-                                const void *pData = _pDataCacheInterface->getData (pMH->getMsgId());
-                                Message *pMsg = new Message (pMH, pData);
+                                SharedBuffer *pData = _pDataCacheInterface->getSharedData (pMH->getMsgId());
+                                if (pData == nullptr) {
+                                    continue;
+                                }
+                                Message *pMsg = new Message (pMH, pData->getData());
                                 DisServiceDataMsg *pDataMsg = new DisServiceDataMsg (getNodeId(), pMsg);
                                 broadcastDisServiceDataMsg (pDataMsg, "Handling History Request");
                                 delete pDataMsg;
                                 delete pMsg;
                                 pDataMsg = nullptr;
                                 pMsg = nullptr;
+                                pData->release();
                             }
                             //DisServiceHistoryRequestReplyMsg dhrr (getNodeId(), pMID);
                             //broadcastDisServiceCntrlMsg (&dhrr);
@@ -3383,7 +3399,7 @@ int DisseminationService::getData (const char *pszMsgId, uint32 *ui32DataLength,
         return -1;
     }
     _mGetData.lock (68);
-    const void *pBuffer = _pDataCacheInterface->getData (pszMsgId, *ui32DataLength);
+    SharedBuffer *pBuffer = _pDataCacheInterface->getSharedData (pszMsgId);
     if (pBuffer == nullptr) {
          checkAndLogMsg ("DisseminationService::getData", Logger::L_Info,
                          "no data has been found in the cache %s\n", pszMsgId);
@@ -3395,10 +3411,9 @@ int DisseminationService::getData (const char *pszMsgId, uint32 *ui32DataLength,
         checkAndLogMsg ("DisseminationService::getData", Logger::L_Info,
                         "data found in the cache %s\n", pszMsgId);
     }
-    (*pData) = calloc ((*ui32DataLength), sizeof(char));
-    memcpy ((*pData), pBuffer, (*ui32DataLength));
-
-    _pDataCacheInterface->release (pszMsgId, (void*)pBuffer);
+    (*ui32DataLength) = pBuffer->getLength();
+    (*pData) = pBuffer->copy();
+    pBuffer->release();
 
     _mGetData.unlock (68);
     return 0;
@@ -24,8 +24,13 @@
 #include "DisServiceDefs.h"
 #include "PeerStatusListener.h"
 
+#include "BufferReader.h"
 #include "Logger.h"
 #include "NLFLib.h"
+#include "PipelinedRpc.h"
+#include "ShmRpcChannel.h"
+#include "SimpleCommHelper2.h"
+#include "Writer.h"
 
 #include <string.h>
 
@@ -42,11 +47,14 @@ DisseminationServiceProxy::DisseminationServiceProxy (uint16 ui16ApplicationId)
     : _mutex (16), _mutexReconnect (17)
 {
     _pCommHelper = NULL;
+    _pRpcClient = NULL;
     _pHandler = NULL;
     _pListener = NULL;
     _pPeerStatusListener = NULL;
     _ui16ApplicationId = ui16ApplicationId;
     _bUsingBackgroundReconnect = false;
+    _bUsingPipelinedRpc = false;
+    _bUsingSharedMemory = false;
     _bReconnectStarted = false;
     _pReconnectSemaphore = new Semaphore(0);
 }
@@ -69,6 +77,11 @@ DisseminationServiceProxy::~DisseminationServiceProxy (void)
         delete _pCommHelper;
         _pCommHelper = NULL;
     }
+    if (_pRpcClient) {
+        _pRpcClient->requestTermination();
+        _pRpcClient->release();
+        _pRpcClient = NULL;
+    }
     delete _pReconnectSemaphore;
     _pReconnectSemaphore = 0;
 
@@ -89,7 +102,8 @@ DisseminationServiceProxy::~DisseminationServiceProxy (void)
     _pReconnectSemaphore = 0;
 }
 
-int DisseminationServiceProxy::init (const char *pszHost, uint16 ui16Port, bool bUseBackgroundReconnect)
+int DisseminationServiceProxy::init (const char *pszHost, uint16 ui16Port, bool bUseBackgroundReconnect,
+                                     bool bUsePipelinedRpc, bool bUseSharedMemory)
 {
     if (pszHost == NULL) {
         pszHost = "127.0.0.1";
@@ -101,6 +115,8 @@ int DisseminationServiceProxy::init (const char *pszHost, uint16 ui16Port, bool
     _sHost = pszHost;
     _ui16Port = ui16Port;
     _bUsingBackgroundReconnect = bUseBackgroundReconnect;
+    _bUsingPipelinedRpc = bUsePipelinedRpc;
+    _bUsingSharedMemory = bUseSharedMemory;
 
     if (bUseBackgroundReconnect) {
         start();
@@ -170,6 +186,13 @@ void DisseminationServiceProxy::run()
             delete _pHandler;
             _pHandler = NULL;
         }
+        if (_pRpcClient != NULL) {
+            // Wakes up the callers waiting for responses, that still hold
+            // a reference to the client
+            _pRpcClient->requestTermination();
+            _pRpcClient->release();
+            _pRpcClient = NULL;
+        }
         _mutex.unlock (136);
 
         while (tryConnect() != 0) {
@@ -211,12 +234,20 @@ int DisseminationServiceProxy::tryConnect()
     else {
         _ui16ApplicationId = (uint16) rc;   // The server may have assigned a different id than requested
     }
+    PipelinedRpcClient *pRpcClient = NULL;
+    if (_bUsingPipelinedRpc && _bUsingSharedMemory) {
+        pRpcClient = registerProxyShm (_ui16ApplicationId);
+    }
+    if (_bUsingPipelinedRpc && (pRpcClient == NULL)) {
+        pRpcClient = registerProxyRpc (_ui16ApplicationId);
+    }
 
     _mutex.lock (138);
     checkAndLogMsg ("DisseminationServiceProxy:tryConnect", Logger::L_Info,
                     "connected to proxy server, appid %d\n", _ui16ApplicationId);
 
     _pCommHelper = pch;
+    _pRpcClient = pRpcClient;
     _pHandler = new DisseminationServiceProxyCallbackHandler (this, pchCallback);
     _pHandler->start();
 
@@ -408,6 +439,15 @@ int DisseminationServiceProxy::push (const char *pszGroupName, const char *pszOb
                                      int64 i64ExpirationTime, uint16 ui16HistoryWindow, uint16 ui16Tag, uint8 ui8Priority,
                                      char *pszIdBuf, uint32 ui32IdBufLen)
 {
+    if (_bUsingPipelinedRpc) {
+        const uint32 ui32RequestId = pushAsync (pszGroupName, pszObjectId, pszInstanceId, pszMimeType,
+                                                pMetadata, ui32MetadataLength, pData, ui32Length, i64ExpirationTime,
+                                                ui16HistoryWindow, ui16Tag, ui8Priority);
+        if (ui32RequestId != 0U) {
+            return waitForPush (ui32RequestId, pszIdBuf, ui32IdBufLen);
+        }
+        // The pipelined RPC connection is not available, use the text protocol
+    }
     _mutex.lock (139);
     CHECK_CONNECTION_OR_FAIL (139);
     try {
@@ -453,6 +493,137 @@ int DisseminationServiceProxy::push (const char *pszGroupName, const char *pszOb
     }
 }
 
+int DisseminationServiceProxy::pushMany (const char *pszGroupName, PushMessage *pMessages, unsigned int uiCount)
+{
+    if ((pszGroupName == NULL) || ((pMessages == NULL) && (uiCount > 0))) {
+        return -1;
+    }
+    for (unsigned int i = 0; i < uiCount; i++) {
+        pMessages[i].rc = -1;
+        pMessages[i].pszId = NULL;
+    }
+
+    PushRequest req;
+    req.pszGroupName = pszGroupName;
+    req.pMessages = pMessages;
+    req.ui32Count = uiCount;
+    const uint32 ui32Count = uiCount;
+
+    PipelinedRpcClient *pRpcClient = getRpcClient();
+    if ((pRpcClient == NULL) || !pRpcClient->isConnected()) {
+        if (pRpcClient != NULL) {
+            pRpcClient->release();
+        }
+        pushOneAtATime (pszGroupName, pMessages, uiCount);
+        return 0;
+    }
+    // The reference keeps the client alive, without holding _mutex while waiting
+    BufferReader *pResponse = NULL;
+    int rc = pRpcClient->call (RPC_PUSH_MANY, &marshalPushMany, &req, &pResponse);
+    if (rc == -4) {
+        // The batch does not fit in a request: split it in two.  A single
+        // message that does not fit either is sent by push(), that falls
+        // back to the text protocol
+        pRpcClient->release();
+        if (uiCount == 1) {
+            pushOneAtATime (pszGroupName, pMessages, uiCount);
+            return 0;
+        }
+        const unsigned int uiFirstHalf = uiCount / 2;
+        const int rcFirstHalf = pushMany (pszGroupName, pMessages, uiFirstHalf);
+        const int rcSecondHalf = pushMany (pszGroupName, pMessages + uiFirstHalf, uiCount - uiFirstHalf);
+        return (rcFirstHalf < 0 ? rcFirstHalf : rcSecondHalf);
+    }
+    if (rc < 0) {
+        checkAndLogMsg ("DisseminationServiceProxy::pushMany", Logger::L_MildError,
+                        "pushMany of %u messages failed\n", uiCount);
+        if (!pRpcClient->isConnected()) {
+            startReconnect();
+        }
+        pRpcClient->release();
+        return -3;
+    }
+    pRpcClient->release();
+
+    uint32 ui32Replies = 0;
+    rc = (((pResponse->read32 (&ui32Replies) < 0) || (ui32Replies != ui32Count)) ? -4 : 0);
+    for (unsigned int i = 0; (i < uiCount) && (rc == 0); i++) {
+        int32 i32Rc = 0;
+        if ((pResponse->read32 (&i32Rc) < 0) || (pResponse->readString (&pMessages[i].pszId) < 0)) {
+            rc = -4;
+        }
+        else {
+            pMessages[i].rc = i32Rc;
+        }
+    }
+    delete pResponse;
+    return rc;
+}
+
+uint32 DisseminationServiceProxy::pushAsync (const char *pszGroupName, const char *pszObjectId, const char *pszInstanceId,
+                                             const char *pszMimeType, const void *pMetadata, uint32 ui32MetadataLength,
+                                             const void *pData, uint32 ui32Length, int64 i64ExpirationTime,
+                                             uint16 ui16HistoryWindow, uint16 ui16Tag, uint8 ui8Priority)
+{
+    if (pszGroupName == NULL) {
+        return 0;
+    }
+    PushMessage msg;
+    msg.pszObjectId = pszObjectId;
+    msg.pszInstanceId = pszInstanceId;
+    msg.pszMimeType = pszMimeType;
+    msg.pMetadata = pMetadata;
+    msg.ui32MetadataLength = ui32MetadataLength;
+    msg.pData = pData;
+    msg.ui32Length = ui32Length;
+    msg.i64ExpirationTime = i64ExpirationTime;
+    msg.ui16HistoryWindow = ui16HistoryWindow;
+    msg.ui16Tag = ui16Tag;
+    msg.ui8Priority = ui8Priority;
+    PushRequest req;
+    req.pszGroupName = pszGroupName;
+    req.pMessages = &msg;
+    req.ui32Count = 1U;
+    PipelinedRpcClient *pRpcClient = getRpcClient();
+    if (pRpcClient == NULL) {
+        return 0;
+    }
+    const uint32 ui32RequestId = pRpcClient->send (RPC_PUSH, &marshalPush, &req);
+    pRpcClient->release();
+    return ui32RequestId;
+}
+
+int DisseminationServiceProxy::waitForPush (uint32 ui32RequestId, char *pszIdBuf, uint32 ui32IdBufLen)
+{
+    // The reference keeps the client alive, without holding _mutex while waiting
+    PipelinedRpcClient *pRpcClient = getRpcClient();
+    if (pRpcClient == NULL) {
+        return -1;
+    }
+    BufferReader *pResponse = NULL;
+    int rc = pRpcClient->wait (ui32RequestId, &pResponse);
+    if (rc < 0) {
+        checkAndLogMsg ("DisseminationServiceProxy::waitForPush", Logger::L_MildError,
+                        "push request %u failed; rc = %d\n", ui32RequestId, rc);
+        if (!pRpcClient->isConnected()) {
+            startReconnect();
+        }
+        pRpcClient->release();
+        return -2;
+    }
+    pRpcClient->release();
+
+    char *pszMsgId = NULL;
+    rc = ((pResponse->readString (&pszMsgId) < 0) || (pszMsgId == NULL) ? -3 : 0);
+    if ((rc == 0) && (pszIdBuf != NULL)) {
+        strncpy (pszIdBuf, pszMsgId, ui32IdBufLen);
+        pszIdBuf [ui32IdBufLen-1] = '\0';
+    }
+    free (pszMsgId);
+    delete pResponse;
+    return rc;
+}
+
 int DisseminationServiceProxy::makeAvailable (const char *pszGroupName, const char *pszObjectId, const char *pszInstanceId,
                                               const void *pMetadata, uint32 ui32MetadataLength, const void *pData, uint32 ui32Length,
                                               const char *pszDataMimeType, int64 i64Expiration, uint16 ui16HistoryWindow, uint16 ui16Tag,
@@ -1275,6 +1446,151 @@ int DisseminationServiceProxy::registerProxy (CommHelper2 *pch, CommHelper2 *pch
     }
 }
 
+SimpleCommHelper2 * DisseminationServiceProxy::connectRpcCommHelper (void)
+{
+    TCPSocket *pSocket = new TCPSocket();
+    int rc = pSocket->connect (_sHost.c_str(), _ui16Port);
+    if (rc != 0) {
+        checkAndLogMsg ("DisseminationServiceProxy:connectRpcCommHelper", Logger::L_MildError,
+                        "failed to connect to remote host %s on port %d; rc = %d\n", _sHost.c_str(), _ui16Port, rc);
+        delete pSocket;
+        return NULL;
+    }
+    pSocket->bufferingMode (false);
+    SimpleCommHelper2 *pchRpc = new SimpleCommHelper2();
+    if (0 != (rc = pchRpc->init (pSocket))) {
+        checkAndLogMsg ("DisseminationServiceProxy:connectRpcCommHelper", Logger::L_MildError,
+                        "failed to initialize CommHelper; rc = %d\n", rc);
+        delete pSocket;
+        delete pchRpc;
+        return NULL;
+    }
+    pchRpc->setDeleteUnderlyingSocket (true);
+    return pchRpc;
+}
+
+PipelinedRpcClient * DisseminationServiceProxy::registerProxyRpc (uint16 ui16ApplicationId)
+{
+    SimpleCommHelper2 *pchRpc = connectRpcCommHelper();
+    if (pchRpc == NULL) {
+        return NULL;
+    }
+
+    SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+    pchRpc->sendLine (error, "%s %d", PipelinedRpc::REGISTER_PROXY_RPC.c_str(), (int) ui16ApplicationId);
+    if (error == SimpleCommHelper2::None) {
+        pchRpc->receiveMatch (error, "OK");
+    }
+    if (error != SimpleCommHelper2::None) {
+        checkAndLogMsg ("DisseminationServiceProxy:registerProxyRpc", Logger::L_Warning,
+                        "the server did not accept the pipelined RPC connection (error %d), "
+                        "using the text protocol only\n", (int) error);
+        delete pchRpc;
+        return NULL;
+    }
+    PipelinedRpcClient *pRpcClient = new PipelinedRpcClient (pchRpc);
+    pRpcClient->start();
+    return pRpcClient;
+}
+
+PipelinedRpcClient * DisseminationServiceProxy::registerProxyShm (uint16 ui16ApplicationId)
+{
+    SimpleCommHelper2 *pchRpc = connectRpcCommHelper();
+    if (pchRpc == NULL) {
+        return NULL;
+    }
+    ShmRpcChannel *pChannel = ShmRpcChannel::offer (pchRpc, ui16ApplicationId);
+    if (pChannel == NULL) {
+        checkAndLogMsg ("DisseminationServiceProxy:registerProxyShm", Logger::L_Info,
+                        "the server did not accept the shared memory channel, using the TCP connection\n");
+        delete pchRpc;
+        return NULL;
+    }
+    PipelinedRpcClient *pRpcClient = new PipelinedRpcClient (pChannel);
+    pRpcClient->start();
+    return pRpcClient;
+}
+
+PipelinedRpcClient * DisseminationServiceProxy::getRpcClient (void)
+{
+    _mutex.lock (266);
+    PipelinedRpcClient *pRpcClient = _pRpcClient;
+    if (pRpcClient != NULL) {
+        pRpcClient->addRef();
+    }
+    _mutex.unlock (266);
+    return pRpcClient;
+}
+
+void DisseminationServiceProxy::pushOneAtATime (const char *pszGroupName, PushMessage *pMessages, unsigned int uiCount)
+{
+    char szId[512];
+    for (unsigned int i = 0; i < uiCount; i++) {
+        PushMessage &msg = pMessages[i];
+        msg.rc = push (pszGroupName, msg.pszObjectId, msg.pszInstanceId, msg.pszMimeType, msg.pMetadata,
+                       msg.ui32MetadataLength, msg.pData, msg.ui32Length, msg.i64ExpirationTime,
+                       msg.ui16HistoryWindow, msg.ui16Tag, msg.ui8Priority, szId, sizeof (szId));
+        if (msg.rc == 0) {
+            msg.pszId = strDup (szId);
+        }
+    }
+}
+
+int DisseminationServiceProxy::writePushMessage (Writer *pWriter, const char *pszObjectId, const char *pszInstanceId,
+                                                 const char *pszMimeType, const void *pMetadata, uint32 ui32MetadataLength,
+                                                 const void *pData, uint32 ui32Length, int64 i64ExpirationTime,
+                                                 uint16 ui16HistoryWindow, uint16 ui16Tag, uint8 ui8Priority)
+{
+    if ((pWriter->writeString (pszObjectId) < 0) || (pWriter->writeString (pszInstanceId) < 0) ||
+        (pWriter->writeString (pszMimeType) < 0)) {
+        return -1;
+    }
+    if ((pWriter->write32 (&ui32MetadataLength) < 0) ||
+        ((ui32MetadataLength > 0) && (pWriter->writeBytes (pMetadata, ui32MetadataLength) < 0))) {
+        return -2;
+    }
+    if ((pWriter->write32 (&ui32Length) < 0) ||
+        ((ui32Length > 0) && (pWriter->writeBytes (pData, ui32Length) < 0))) {
+        return -3;
+    }
+    if ((pWriter->write64 (&i64ExpirationTime) < 0) || (pWriter->write16 (&ui16HistoryWindow) < 0) ||
+        (pWriter->write16 (&ui16Tag) < 0) || (pWriter->write8 (&ui8Priority) < 0)) {
+        return -4;
+    }
+    return 0;
+}
+
+int DisseminationServiceProxy::marshalPush (const void *pArg, Writer *pWriter)
+{
+    const PushRequest *pReq = static_cast<const PushRequest *> (pArg);
+    const PushMessage &msg = pReq->pMessages[0];
+    if ((pWriter->writeString (pReq->pszGroupName) < 0) ||
+        (writePushMessage (pWriter, msg.pszObjectId, msg.pszInstanceId, msg.pszMimeType, msg.pMetadata,
+                           msg.ui32MetadataLength, msg.pData, msg.ui32Length, msg.i64ExpirationTime,
+                           msg.ui16HistoryWindow, msg.ui16Tag, msg.ui8Priority) < 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+int DisseminationServiceProxy::marshalPushMany (const void *pArg, Writer *pWriter)
+{
+    const PushRequest *pReq = static_cast<const PushRequest *> (pArg);
+    uint32 ui32Count = pReq->ui32Count;
+    if ((pWriter->writeString (pReq->pszGroupName) < 0) || (pWriter->write32 (&ui32Count) < 0)) {
+        return -1;
+    }
+    for (uint32 i = 0; i < ui32Count; i++) {
+        const PushMessage &msg = pReq->pMessages[i];
+        if (writePushMessage (pWriter, msg.pszObjectId, msg.pszInstanceId, msg.pszMimeType, msg.pMetadata,
+                              msg.ui32MetadataLength, msg.pData, msg.ui32Length, msg.i64ExpirationTime,
+                              msg.ui16HistoryWindow, msg.ui16Tag, msg.ui8Priority) < 0) {
+            return -2;
+        }
+    }
+    return 0;
+}
+
 bool DisseminationServiceProxy::dataArrived (const char *pszSender, const char *pszGroupName, uint32 ui32SeqId,
                                              const char *pszObjectId, const char *pszInstanceId, const char *pszMimeType,
                                              const void *pData, uint32 ui32Length, uint32 ui32MetadataLength,
@@ -32,6 +32,13 @@
 #include "LList.h"
 #include <stddef.h>
 
+namespace NOMADSUtil
+{
+    class PipelinedRpcClient;
+    class SimpleCommHelper2;
+    class Writer;
+}
+
 namespace IHMC_ACI
 {
     class DisseminationServiceProxyCallbackHandler;
@@ -42,6 +49,32 @@ namespace IHMC_ACI
     class DisseminationServiceProxy: public NOMADSUtil::ManageableThread
     {
         public:
+            // Methods of the pipelined RPC connection
+            static const uint16 RPC_PING = 0x01;
+            static const uint16 RPC_PUSH = 0x02;
+            static const uint16 RPC_PUSH_MANY = 0x03;
+
+            // A message for pushMany()
+            struct PushMessage
+            {
+                const char *pszObjectId;
+                const char *pszInstanceId;
+                const char *pszMimeType;
+                const void *pMetadata;
+                uint32 ui32MetadataLength;
+                const void *pData;
+                uint32 ui32Length;
+                int64 i64ExpirationTime;
+                uint16 ui16HistoryWindow;
+                uint16 ui16Tag;
+                uint8 ui8Priority;
+
+                // Set by pushMany(): the result of the push and, if successful,
+                // the id of the message, that must be deallocated with free()
+                int rc;
+                char *pszId;
+            };
+
             DisseminationServiceProxy (uint16 ui16ApplicationId = 0);
             virtual ~DisseminationServiceProxy (void);
 
@@ -49,9 +82,19 @@ namespace IHMC_ACI
              * Initialize the proxy by connecting it to the DisseminationService Proxy Server
              * By default, connects to the proxy on localhost (127.0.0.1)
              *
+             * If bUsePipelinedRpc is set, push requests are sent on an additional
+             * connection that carries binary frames and allows several requests
+             * in flight. Servers that do not support it may not reply to the
+             * registration of the additional connection, therefore it should only
+             * be enabled with up to date servers.
+             * If bUseSharedMemory is also set, and the server runs on the same
+             * host, the binary frames are exchanged through shared memory
+             * instead (see ShmRpcChannel.h).
+             *
              * Returns 0 if successful or a negative value in case of error
              */
-            int init (const char *pszHost = NULL, uint16 ui16Port = 0, bool bUseBackgroundReconnect = false);
+            int init (const char *pszHost = NULL, uint16 ui16Port = 0, bool bUseBackgroundReconnect = false,
+                      bool bUsePipelinedRpc = false, bool bUseSharedMemory = false);
 
             int getNodeId (char *&pszNodeId);
             int getPeerList (char **&ppszPeerList);
@@ -108,6 +151,36 @@ namespace IHMC_ACI
                       const void *pMetadata, uint32 ui32MetadataLength, const void *pData, uint32 ui32Length, int64 i64ExpirationTime,
                       uint16 ui16HistoryWindow, uint16 ui16Tag, uint8 ui8Priority, char *pszIdBuf, uint32 ui32IdBufLen);
 
+            /**
+             * Pushes uiCount messages to pszGroupName with a single request.
+             * The result of each push, and the id of each pushed message, are
+             * stored in the rc and pszId fields of the message.
+             * If the pipelined RPC connection is not available, the messages are
+             * pushed one at a time.  A batch that is too large for the connection
+             * (a shared memory channel only takes requests up to half of its ring)
+             * is split into smaller requests.
+             * Returns 0 if the request was served, a negative value otherwise.
+             */
+            int pushMany (const char *pszGroupName, PushMessage *pMessages, unsigned int uiCount);
+
+            /**
+             * Sends a push request on the pipelined RPC connection, without
+             * waiting for the reply, that must then be retrieved with waitForPush().
+             * Returns the id of the request, or 0 if the request could not be sent
+             * (for instance because the pipelined RPC connection is not available).
+             */
+            uint32 pushAsync (const char *pszGroupName, const char *pszObjectId, const char *pszInstanceId,
+                              const char *pszMimeType, const void *pMetadata, uint32 ui32MetadataLength,
+                              const void *pData, uint32 ui32Length, int64 i64ExpirationTime,
+                              uint16 ui16HistoryWindow, uint16 ui16Tag, uint8 ui8Priority);
+
+            /**
+             * Waits for the reply to the request returned by pushAsync().
+             * pszIdBuf and ui32IdBufLen have the same meaning as in push().
+             * Returns 0 if successful or a negative value in case of error.
+             */
+            int waitForPush (uint32 ui32RequestId, char *pszIdBuf, uint32 ui32IdBufLen);
+
             /**
              * Makes the specified data available and disseminates the associated metadata to nodes belonging to
              * the specified group that are reachable. The data is stored in the network until the specified
@@ -329,6 +402,35 @@ namespace IHMC_ACI
             int registerProxy (NOMADSUtil::CommHelper2 *pch, NOMADSUtil::CommHelper2 *pchCallback,
                                uint16 ui16DesiredApplicationId);
 
+            NOMADSUtil::PipelinedRpcClient * registerProxyRpc (uint16 ui16ApplicationId);
+            NOMADSUtil::PipelinedRpcClient * registerProxyShm (uint16 ui16ApplicationId);
+            NOMADSUtil::SimpleCommHelper2 * connectRpcCommHelper (void);
+
+            // Returns the pipelined RPC client with a reference that the
+            // caller must release(), or NULL if the connection is not open
+            NOMADSUtil::PipelinedRpcClient * getRpcClient (void);
+
+            // Pushes the messages of a pushMany() request one at a time
+            void pushOneAtATime (const char *pszGroupName, PushMessage *pMessages, unsigned int uiCount);
+
+            // Writes the fields of a message of a RPC_PUSH or RPC_PUSH_MANY request
+            static int writePushMessage (NOMADSUtil::Writer *pWriter, const char *pszObjectId, const char *pszInstanceId,
+                                         const char *pszMimeType, const void *pMetadata, uint32 ui32MetadataLength,
+                                         const void *pData, uint32 ui32Length, int64 i64ExpirationTime,
+                                         uint16 ui16HistoryWindow, uint16 ui16Tag, uint8 ui8Priority);
+
+            // The arguments of a RPC_PUSH (ui32Count is 1) or RPC_PUSH_MANY request
+            struct PushRequest
+            {
+                const char *pszGroupName;
+                const PushMessage *pMessages;
+                uint32 ui32Count;
+            };
+
+            // Marshal a PushRequest, writing the messages directly into the frame
+            static int marshalPush (const void *pArg, NOMADSUtil::Writer *pWriter);
+            static int marshalPushMany (const void *pArg, NOMADSUtil::Writer *pWriter);
+
             bool dataArrived (const char *pszSender, const char *pszGroupName, uint32 ui32SeqId,
                               const char *pszObjectId, const char *pszInstanceId, const char *pszMimeType,
                               const void *pData, uint32 ui32Length, uint32 ui32MetadataLength,
@@ -384,6 +486,7 @@ namespace IHMC_ACI
             };
 
             NOMADSUtil::CommHelper2 *_pCommHelper;
+            NOMADSUtil::PipelinedRpcClient *_pRpcClient;    // NULL unless the pipelined RPC connection is open
             DisseminationServiceProxyListener *_pListener;
             PeerStatusListener *_pPeerStatusListener;
             SearchListener *_pSearchListener;
@@ -394,6 +497,8 @@ namespace IHMC_ACI
             NOMADSUtil::String _sHost;
             uint16 _ui16Port;
             bool _bUsingBackgroundReconnect;
+            bool _bUsingPipelinedRpc;
+            bool _bUsingSharedMemory;
             bool _bReconnectStarted;
             NOMADSUtil::Semaphore *_pReconnectSemaphore;
 
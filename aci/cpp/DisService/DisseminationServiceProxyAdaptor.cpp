@@ -25,20 +25,86 @@
 
 #include "DisseminationService.h"
 #include "DisServiceDefs.h"
+#include "DisseminationServiceProxy.h"
 #include "DisseminationServiceProxyServer.h"
 
 #include "CommHelper2.h"
 #include "Logger.h"
+#include "PipelinedRpc.h"
 
 using namespace IHMC_ACI;
 using namespace NOMADSUtil;
 
+namespace DISSEMINATION_SERVICE_PROXY_ADAPTOR
+{
+    // A message of a RPC_PUSH or RPC_PUSH_MANY request
+    struct RpcPushMessage
+    {
+        RpcPushMessage (void)
+            : pszObjectId (NULL), pszInstanceId (NULL), pszMimeType (NULL), pMetadata (NULL),
+              ui32MetadataLength (0), pData (NULL), ui32Length (0), i64ExpirationTime (0),
+              ui16HistoryWindow (0), ui16Tag (0), ui8Priority (0) {}
+
+        ~RpcPushMessage (void)
+        {
+            free (pszObjectId);
+            free (pszInstanceId);
+            free (pszMimeType);
+        }
+
+        // The blob is not copied: pBuf points into the request frame
+        static int readBlob (Reader *pReader, const void *&pBuf, uint32 &ui32Len)
+        {
+            if ((pReader->read32 (&ui32Len) < 0) || (ui32Len > PipelinedRpc::MAX_PAYLOAD_LEN)) {
+                return -1;
+            }
+            if ((ui32Len > 0) && (NULL == (pBuf = PipelinedRpc::readInPlace (pReader, ui32Len)))) {
+                return -2;
+            }
+            return 0;
+        }
+
+        // Reads the fields written by DisseminationServiceProxy::writePushMessage().
+        // The metadata and the data are valid until the request is processed
+        int read (Reader *pReader)
+        {
+            if ((pReader->readString (&pszObjectId) < 0) || (pReader->readString (&pszInstanceId) < 0) ||
+                (pReader->readString (&pszMimeType) < 0)) {
+                return -1;
+            }
+            if ((readBlob (pReader, pMetadata, ui32MetadataLength) < 0) || (readBlob (pReader, pData, ui32Length) < 0)) {
+                return -2;
+            }
+            if ((pReader->read64 (&i64ExpirationTime) < 0) || (pReader->read16 (&ui16HistoryWindow) < 0) ||
+                (pReader->read16 (&ui16Tag) < 0) || (pReader->read8 (&ui8Priority) < 0)) {
+                return -3;
+            }
+            return 0;
+        }
+
+        char *pszObjectId;
+        char *pszInstanceId;
+        char *pszMimeType;
+        const void *pMetadata;
+        uint32 ui32MetadataLength;
+        const void *pData;
+        uint32 ui32Length;
+        int64 i64ExpirationTime;
+        uint16 ui16HistoryWindow;
+        uint16 ui16Tag;
+        uint8 ui8Priority;
+    };
+}
+
+using namespace DISSEMINATION_SERVICE_PROXY_ADAPTOR;
+
 DisseminationServiceProxyAdaptor::DisseminationServiceProxyAdaptor (DisseminationServiceProxyServer *pDSProxyServer)
     : SearchListener ("DisseminationServiceProxyAdaptor"), _mutex (18)
 {
     _pDissSvc = pDSProxyServer->getDisseminationServiceRef();
     _pDissSvcProxyServer = pDSProxyServer;
     _pCallbackCommHelper = NULL;
+    _pRpcServer = NULL;
     _bListenerRegistered = false;
     _bPeerStatusListenerRegistered = false;
     _bSearchListenerRegistered = false;
@@ -71,6 +137,11 @@ DisseminationServiceProxyAdaptor::~DisseminationServiceProxyAdaptor()
     _pDissSvcProxyServer->_proxies.remove (szId);
 
     // Close connections
+    if (_pRpcServer != NULL) {
+        // Waits for the request being served, if any
+        delete _pRpcServer;
+        _pRpcServer = NULL;
+    }
     if (_pCommHelper != NULL) {
         CommHelperError error = SimpleCommHelper2::None;
          _pCommHelper->closeConnection (error);
@@ -106,6 +177,15 @@ void DisseminationServiceProxyAdaptor::setCallbackCommHelper(SimpleCommHelper2 *
     _mutex.unlock (157);
 }
 
+void DisseminationServiceProxyAdaptor::setRpcChannel (RpcChannel *pChannel)
+{
+    if (_pRpcServer != NULL) {
+        delete _pRpcServer;
+    }
+    _pRpcServer = new PipelinedRpcServer (pChannel, &DisseminationServiceProxyAdaptor::rpcMethodInvoked, this);
+    _pRpcServer->start();
+}
+
 void DisseminationServiceProxyAdaptor::run()
 {
     const char *pszMethodName = "DisseminationServiceProxyAdaptor::run";
@@ -1482,6 +1562,75 @@ bool DisseminationServiceProxyAdaptor::doSearchReply (CommHelperError &err)
     return bSucceded;
 }
 
+int DisseminationServiceProxyAdaptor::rpcMethodInvoked (void *pAdaptor, uint16 ui16Method, Reader *pRequest, Writer *pResponse)
+{
+    DisseminationServiceProxyAdaptor *pThis = static_cast<DisseminationServiceProxyAdaptor *> (pAdaptor);
+    switch (ui16Method) {
+        case DisseminationServiceProxy::RPC_PING:
+            return 0;
+
+        case DisseminationServiceProxy::RPC_PUSH:
+            return pThis->doRpcPush (pRequest, pResponse);
+
+        case DisseminationServiceProxy::RPC_PUSH_MANY:
+            return pThis->doRpcPushMany (pRequest, pResponse);
+
+        default:
+            return -1;
+    }
+}
+
+int DisseminationServiceProxyAdaptor::doRpcPush (Reader *pRequest, Writer *pResponse)
+{
+    char *pszGroupName = NULL;
+    RpcPushMessage msg;
+    if ((pRequest->readString (&pszGroupName) < 0) || (pszGroupName == NULL) || (msg.read (pRequest) < 0)) {
+        free (pszGroupName);
+        return -1;
+    }
+    char buf[512];
+    int rc = _pDissSvc->push (getClientID(), pszGroupName, msg.pszObjectId, msg.pszInstanceId, msg.pszMimeType,
+                              msg.pMetadata, msg.ui32MetadataLength, msg.pData, msg.ui32Length, msg.i64ExpirationTime,
+                              msg.ui16HistoryWindow, msg.ui16Tag, msg.ui8Priority, buf, sizeof (buf));
+    free (pszGroupName);
+    if ((rc != 0) || (pResponse->writeString (buf) < 0)) {
+        return -2;
+    }
+    return 0;
+}
+
+int DisseminationServiceProxyAdaptor::doRpcPushMany (Reader *pRequest, Writer *pResponse)
+{
+    char *pszGroupName = NULL;
+    uint32 ui32Count = 0;
+    if ((pRequest->readString (&pszGroupName) < 0) || (pszGroupName == NULL) ||
+        (pRequest->read32 (&ui32Count) < 0) || (pResponse->write32 (&ui32Count) < 0)) {
+        free (pszGroupName);
+        return -1;
+    }
+    // Each message is pushed independently: the result of each push is
+    // returned along with the id of the message
+    int rc = 0;
+    char buf[512];
+    for (uint32 i = 0; (i < ui32Count) && (rc == 0); i++) {
+        RpcPushMessage msg;
+        if (msg.read (pRequest) < 0) {
+            rc = -1;
+            break;
+        }
+        buf[0] = '\0';
+        int32 i32Rc = _pDissSvc->push (getClientID(), pszGroupName, msg.pszObjectId, msg.pszInstanceId, msg.pszMimeType,
+                                       msg.pMetadata, msg.ui32MetadataLength, msg.pData, msg.ui32Length,
+                                       msg.i64ExpirationTime, msg.ui16HistoryWindow, msg.ui16Tag, msg.ui8Priority,
+                                       buf, sizeof (buf));
+        if ((pResponse->write32 (&i32Rc) < 0) || (pResponse->writeString (i32Rc == 0 ? buf : NULL) < 0)) {
+            rc = -2;
+        }
+    }
+    free (pszGroupName);
+    return rc;
+}
+
 CommHelperError DisseminationServiceProxyAdaptor::messageArrivedCallback (const char *pszCallbackId, const char *pszOriginator,
                                                                           const char *pszGroupName, uint32 ui32SeqId,
                                                                           const char *pszObjectId, const char *pszInstanceId,
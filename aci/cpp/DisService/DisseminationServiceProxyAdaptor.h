@@ -32,7 +32,9 @@
 namespace NOMADSUtil
 {
     class Logger;
+    class PipelinedRpcServer;
     class Reader;
+    class RpcChannel;
     class Writer;
 }
 
@@ -84,6 +86,9 @@ namespace IHMC_ACI
                                  NOMADSUtil::InetAddr toAddr);
 
             void setCallbackCommHelper (NOMADSUtil::SimpleCommHelper2 *pCommHelper);
+
+            // Serves the requests arriving on the pipelined RPC channel
+            void setRpcChannel (NOMADSUtil::RpcChannel *pChannel);
             void run (void);
 
             uint16 getClientID (void);
@@ -156,6 +161,11 @@ namespace IHMC_ACI
             bool doSearch (CommHelperError &err);
             bool doSearchReply (CommHelperError &err);
 
+            static int rpcMethodInvoked (void *pAdaptor, uint16 ui16Method, NOMADSUtil::Reader *pRequest,
+                                         NOMADSUtil::Writer *pResponse);
+            int doRpcPush (NOMADSUtil::Reader *pRequest, NOMADSUtil::Writer *pResponse);
+            int doRpcPushMany (NOMADSUtil::Reader *pRequest, NOMADSUtil::Writer *pResponse);
+
             CommHelperError messageArrivedCallback (const char *pszCallbackId, const char *pszOriginator,
                                                     const char *pszGroupName, uint32 ui32SeqId,
                                                     const char *pszObjectId, const char *pszInstanceId, const char *pszMimeType);
@@ -164,6 +174,7 @@ namespace IHMC_ACI
             uint16 _ui16ClientID;
             NOMADSUtil::SimpleCommHelper2 *_pCommHelper;
             NOMADSUtil::SimpleCommHelper2 *_pCallbackCommHelper;
+            NOMADSUtil::PipelinedRpcServer *_pRpcServer;
             NOMADSUtil::LoggingMutex _mutex;
 
         private:
@@ -26,6 +26,8 @@
 #include "Exceptions.h"
 #include "InetAddr.h"
 #include "Logger.h"
+#include "PipelinedRpc.h"
+#include "ShmRpcChannel.h"
 #include "SimpleCommHelper2.h"
 #include "TCPSocket.h"
 
@@ -186,9 +188,19 @@ void DSProxyServerConnHandler::run()
     else if (0 == stricmp (ppszBuf[0], "RegisterProxyCallback")) {
         doRegisterProxyCallback (_pCommHelper, atoi(ppszBuf[1]));
     }
+    else if (0 == stricmp (ppszBuf[0], PipelinedRpc::REGISTER_PROXY_RPC.c_str())) {
+        doRegisterProxyRpc (_pCommHelper, atoi(ppszBuf[1]));
+    }
+    else if (0 == stricmp (ppszBuf[0], ShmRpcChannel::REGISTER_PROXY_SHM.c_str())) {
+        doRegisterProxyShm (_pCommHelper, atoi(ppszBuf[1]));
+    }
     else {
-        checkAndLogMsg (pszMethodName, Logger::L_Warning, "Expected RegisterProxy "
-                        "or RegisterProxyCallback but got something else\n");
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "Expected RegisterProxy, RegisterProxyCallback, "
+                        "%s or %s but got something else\n", PipelinedRpc::REGISTER_PROXY_RPC.c_str(),
+                        ShmRpcChannel::REGISTER_PROXY_SHM.c_str());
+        // Lets the client know that the registration failed
+        _pCommHelper->closeConnection (err);
+        delete _pCommHelper;
     }
 
     delete this;
@@ -257,3 +269,65 @@ void DSProxyServerConnHandler::doRegisterProxyCallback (SimpleCommHelper2 *pComm
     }
 }
 
+void DSProxyServerConnHandler::doRegisterProxyRpc (SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationId)
+{
+    char szProxyId[10];
+    snprintf (szProxyId, sizeof(szProxyId)-1, "%d", ui16ApplicationId);
+
+    DisseminationServiceProxyAdaptor *pAdaptor = _pDissSvcProxyServer->_proxies.get (szProxyId);
+
+    SimpleCommHelper2::Error err = SimpleCommHelper2::None;
+    if (pAdaptor != NULL) {
+        pCommHelper->sendLine (err, "OK");
+        if (err != SimpleCommHelper2::None) {
+            checkAndLogMsg ("DSProxyServerConnHandler::doRegisterProxyRpc",
+                          Logger::L_SevereError, "sendLine failed\n");
+            pCommHelper->closeConnection (err);
+            delete pCommHelper;
+        }
+        else {
+            // From now on, the connection carries binary frames
+            pAdaptor->setRpcChannel (new TCPRpcChannel (pCommHelper));
+        }
+    }
+    else {
+        checkAndLogMsg ("DSProxyServerConnHandler::doRegisterProxyRpc", Logger::L_MildError,
+                        "did not find proxy with id %d to register an RPC handler\n",
+                        (int) ui16ApplicationId);
+        pCommHelper->sendLine (err, "ERROR: proxy with id %d not found", ui16ApplicationId);
+        pCommHelper->closeConnection (err);
+        delete pCommHelper;
+    }
+}
+
+void DSProxyServerConnHandler::doRegisterProxyShm (SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationId)
+{
+    char szProxyId[10];
+    snprintf (szProxyId, sizeof(szProxyId)-1, "%d", ui16ApplicationId);
+
+    DisseminationServiceProxyAdaptor *pAdaptor = _pDissSvcProxyServer->_proxies.get (szProxyId);
+    ShmRpcChannel *pChannel = (pAdaptor == NULL ? NULL : ShmRpcChannel::accept (pCommHelper));
+
+    SimpleCommHelper2::Error err = SimpleCommHelper2::None;
+    if (pChannel != NULL) {
+        // From now on, pCommHelper belongs to the channel
+        pCommHelper->sendLine (err, "OK");
+        if (err != SimpleCommHelper2::None) {
+            checkAndLogMsg ("DSProxyServerConnHandler::doRegisterProxyShm",
+                          Logger::L_SevereError, "sendLine failed\n");
+            delete pChannel;
+        }
+        else {
+            pAdaptor->setRpcChannel (pChannel);
+        }
+    }
+    else {
+        checkAndLogMsg ("DSProxyServerConnHandler::doRegisterProxyShm", Logger::L_Info,
+                        "could not open a shared memory channel for proxy with id %d\n",
+                        (int) ui16ApplicationId);
+        // The client falls back on the TCP connection
+        pCommHelper->sendLine (err, "ERROR: shared memory not available for proxy with id %d", ui16ApplicationId);
+        pCommHelper->closeConnection (err);
+        delete pCommHelper;
+    }
+}
@@ -76,6 +76,8 @@ namespace IHMC_ACI
         private:
             void doRegisterProxy (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
             void doRegisterProxyCallback (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
+            void doRegisterProxyRpc (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
+            void doRegisterProxyShm (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
 
         private:
             NOMADSUtil::SimpleCommHelper2 *_pCommHelper;
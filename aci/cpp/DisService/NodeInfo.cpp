@@ -27,6 +27,7 @@
 #include "Message.h"
 #include "MessageInfo.h"
 #include "WorldState.h"
+#include "XPathPredicate.h"
 
 #include "Graph.h"
 #include "Logger.h"
@@ -1057,10 +1058,13 @@ void LocalNodeInfo::removeClient (uint16 ui16ClientId)
 
 bool LocalNodeInfo::hasSubscription (Message *pMessage)
 {
+    // The message is parsed at most once, regardless of the number of
+    // clients that have a predicate subscription for its group
+    XMLMessageDocument doc (pMessage);
     _m.lock (317);
     for (UInt32Hashtable<SubscriptionList>::Iterator i = _localSubscriptions.getAllElements(); !i.end(); i.nextElement()) {
         SubscriptionList *pSL = i.getValue();
-        if (pSL->hasSubscriptionWild (pMessage)) {
+        if (pSL->hasSubscriptionWild (pMessage, doc)) {
             _m.unlock (317);
             return true;
         }
@@ -0,0 +1,530 @@
+/*
+ * PayloadSegmentStore.cpp
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "PayloadSegmentStore.h"
+
+#include "DisServiceDefs.h"
+
+#include "FileUtils.h"
+#include "Logger.h"
+#include "NLFLib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined (UNIX)
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/types.h>
+#endif
+
+using namespace IHMC_ACI;
+using namespace NOMADSUtil;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+namespace PAYLOAD_SEGMENT_STORE
+{
+    // Every payload is preceded by a record header, so that the append
+    // position of a segment can be recovered by walking its records.
+    // The file is zero-filled when it is created, therefore the first
+    // record without the magic number marks the end of the written data.
+    const uint32 RECORD_MAGIC = 0x4C505344;     // "DSPL"
+    const uint32 RECORD_HEADER_LEN = 8;
+    const uint32 RECORD_ALIGNMENT = 8;
+    const uint32 PAGE_SIZE = 4096;
+    const char * const SEGMENT_FILE_PREFIX = "seg-";
+    const char * const SEGMENT_FILE_SUFFIX = ".dat";
+
+    uint32 roundUp (uint32 ui32Value, uint32 ui32Multiple)
+    {
+        return ((ui32Value + ui32Multiple - 1) / ui32Multiple) * ui32Multiple;
+    }
+}
+
+using namespace PAYLOAD_SEGMENT_STORE;
+
+//------------------------------------------------------------------------------
+// PayloadView
+//------------------------------------------------------------------------------
+
+PayloadView::PayloadView (void)
+    : _pStore (NULL),
+      _ui32SegmentId (0),
+      _pData (NULL),
+      _ui32Len (0),
+      _pOwnedData (NULL)
+{
+}
+
+PayloadView::~PayloadView (void)
+{
+    release();
+}
+
+const void * PayloadView::getData (void) const
+{
+    return _pData;
+}
+
+uint32 PayloadView::getLength (void) const
+{
+    return _ui32Len;
+}
+
+bool PayloadView::isMapped (void) const
+{
+    return (_pStore != NULL);
+}
+
+void * PayloadView::detach (void)
+{
+    void *pData = _pOwnedData;
+    if ((pData == NULL) && (_pData != NULL) && (_ui32Len > 0)) {
+        pData = malloc (_ui32Len);
+        if (pData == NULL) {
+            checkAndLogMsg ("PayloadView::detach", memoryExhausted);
+        }
+        else {
+            memcpy (pData, _pData, _ui32Len);
+        }
+    }
+    _pOwnedData = NULL;
+    release();
+    return pData;
+}
+
+void PayloadView::release (void)
+{
+    if (_pStore != NULL) {
+        _pStore->release (_ui32SegmentId);
+        _pStore = NULL;
+    }
+    if (_pOwnedData != NULL) {
+        free (_pOwnedData);
+        _pOwnedData = NULL;
+    }
+    _ui32SegmentId = 0;
+    _pData = NULL;
+    _ui32Len = 0;
+}
+
+void PayloadView::setOwned (void *pData, uint32 ui32Len)
+{
+    release();
+    _pOwnedData = pData;
+    _pData = pData;
+    _ui32Len = (pData == NULL ? 0 : ui32Len);
+}
+
+//------------------------------------------------------------------------------
+// PayloadSegmentStore::Segment
+//------------------------------------------------------------------------------
+
+PayloadSegmentStore::Segment::Segment (void)
+    : iFd (-1),
+      pBase (NULL),
+      ui32Capacity (0),
+      ui32Used (0),
+      ui32Pins (0),
+      bSealed (false),
+      bDirty (false),
+      bRemoved (false)
+{
+}
+
+PayloadSegmentStore::Segment::~Segment (void)
+{
+}
+
+//------------------------------------------------------------------------------
+// PayloadSegmentStore
+//------------------------------------------------------------------------------
+
+PayloadSegmentStore::PayloadSegmentStore (const char *pszDirName, uint32 ui32SegmentSize)
+    : _dirName (pszDirName),
+      _ui32SegmentSize (roundUp (ui32SegmentSize < PAGE_SIZE ? PAGE_SIZE : ui32SegmentSize, PAGE_SIZE)),
+      _ui32NextSegmentId (1),
+      _ui32ActiveSegmentId (0),
+      _segments (true)
+{
+}
+
+PayloadSegmentStore::~PayloadSegmentStore (void)
+{
+    sync();
+    _m.lock();
+    for (UInt32Hashtable<Segment>::Iterator i = _segments.getAllElements(); !i.end(); i.nextElement()) {
+        Segment *pSegment = i.getValue();
+        if (pSegment->ui32Pins > 0) {
+            checkAndLogMsg ("PayloadSegmentStore::~PayloadSegmentStore", Logger::L_Warning,
+                            "segment %u is being unmapped while still referenced by %u views\n",
+                            i.getKey(), pSegment->ui32Pins);
+        }
+        unmap (pSegment);
+    }
+    _segments.removeAll();
+    _m.unlock();
+}
+
+int PayloadSegmentStore::init (void)
+{
+    const char *pszMethodName = "PayloadSegmentStore::init";
+    #if defined (UNIX)
+        if (_dirName.length() <= 0) {
+            return -1;
+        }
+        if (!FileUtils::directoryExists (_dirName) && !FileUtils::createDirectory (_dirName)) {
+            checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                            "could not create directory %s\n", _dirName.c_str());
+            return -2;
+        }
+
+        DIR *pDir = opendir (_dirName);
+        if (pDir == NULL) {
+            checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                            "could not open directory %s\n", _dirName.c_str());
+            return -3;
+        }
+
+        _m.lock();
+        uint32 ui32LastSegmentId = 0;
+        for (struct dirent *pDe = readdir (pDir); pDe != NULL; pDe = readdir (pDir)) {
+            unsigned int uiSegmentId = 0;
+            char suffix[8];
+            if ((sscanf (pDe->d_name, "seg-%u%7s", &uiSegmentId, suffix) != 2) ||
+                (strcmp (suffix, SEGMENT_FILE_SUFFIX) != 0) || (uiSegmentId == 0)) {
+                continue;
+            }
+            Segment *pSegment = openSegment (uiSegmentId, 0, false);
+            if (pSegment == NULL) {
+                continue;
+            }
+            recover (pSegment);
+            pSegment->bSealed = true;
+            _segments.put (uiSegmentId, pSegment);
+            if (uiSegmentId > ui32LastSegmentId) {
+                ui32LastSegmentId = uiSegmentId;
+            }
+        }
+        closedir (pDir);
+
+        _ui32NextSegmentId = ui32LastSegmentId + 1;
+        if (ui32LastSegmentId > 0) {
+            // Keep appending to the most recent segment
+            Segment *pLast = _segments.get (ui32LastSegmentId);
+            pLast->bSealed = false;
+            _ui32ActiveSegmentId = ui32LastSegmentId;
+        }
+        checkAndLogMsg (pszMethodName, Logger::L_Info, "mapped %lu existing segments in %s\n",
+                        _segments.getCount(), _dirName.c_str());
+        _m.unlock();
+        return 0;
+    #else
+        checkAndLogMsg (pszMethodName, Logger::L_Info,
+                        "memory-mapped segments are not supported on this platform\n");
+        return -1;
+    #endif
+}
+
+int PayloadSegmentStore::append (const void *pData, uint32 ui32Len, uint32 &ui32SegmentId, uint32 &ui32Offset)
+{
+    if ((pData == NULL) || (ui32Len == 0)) {
+        return -1;
+    }
+    if (ui32Len > (0x7FFFFFFFU - RECORD_HEADER_LEN - PAGE_SIZE)) {
+        // Offsets and lengths are stored as signed 32-bit integers
+        return -2;
+    }
+    const uint32 ui32RecordLen = roundUp (RECORD_HEADER_LEN + ui32Len, RECORD_ALIGNMENT);
+
+    _m.lock();
+    Segment *pSegment = (_ui32ActiveSegmentId == 0 ? NULL : _segments.get (_ui32ActiveSegmentId));
+    if ((pSegment == NULL) || ((pSegment->ui32Capacity - pSegment->ui32Used) < ui32RecordLen)) {
+        pSegment = newActiveSegment (ui32RecordLen);
+        if (pSegment == NULL) {
+            _m.unlock();
+            return -3;
+        }
+    }
+
+    // Write the data before the header: a record is not recovered unless
+    // its header is in place
+    uint8 *pRecord = pSegment->pBase + pSegment->ui32Used;
+    memcpy (pRecord + RECORD_HEADER_LEN, pData, ui32Len);
+    memcpy (pRecord + 4, &ui32Len, 4);
+    memcpy (pRecord, &RECORD_MAGIC, 4);
+
+    ui32SegmentId = _ui32ActiveSegmentId;
+    ui32Offset = pSegment->ui32Used + RECORD_HEADER_LEN;
+    pSegment->ui32Used += ui32RecordLen;
+    pSegment->bDirty = true;
+    _m.unlock();
+    return 0;
+}
+
+void * PayloadSegmentStore::copy (uint32 ui32SegmentId, uint32 ui32Offset, uint32 ui32Len)
+{
+    if (ui32Len == 0) {
+        return NULL;
+    }
+    _m.lock();
+    Segment *pSegment = _segments.get (ui32SegmentId);
+    if ((pSegment == NULL) || pSegment->bRemoved || (ui32Offset > pSegment->ui32Used) ||
+        (ui32Len > (pSegment->ui32Used - ui32Offset))) {
+        _m.unlock();
+        checkAndLogMsg ("PayloadSegmentStore::copy", Logger::L_Warning,
+                        "invalid locator %u:%u:%u\n", ui32SegmentId, ui32Offset, ui32Len);
+        return NULL;
+    }
+    void *pData = malloc (ui32Len);
+    if (pData == NULL) {
+        _m.unlock();
+        checkAndLogMsg ("PayloadSegmentStore::copy", memoryExhausted);
+        return NULL;
+    }
+    memcpy (pData, pSegment->pBase + ui32Offset, ui32Len);
+    _m.unlock();
+    return pData;
+}
+
+int PayloadSegmentStore::getView (uint32 ui32SegmentId, uint32 ui32Offset, uint32 ui32Len, PayloadView &view)
+{
+    view.release();
+    _m.lock();
+    Segment *pSegment = _segments.get (ui32SegmentId);
+    if ((pSegment == NULL) || pSegment->bRemoved || (ui32Offset > pSegment->ui32Used) ||
+        (ui32Len > (pSegment->ui32Used - ui32Offset))) {
+        _m.unlock();
+        checkAndLogMsg ("PayloadSegmentStore::getView", Logger::L_Warning,
+                        "invalid locator %u:%u:%u\n", ui32SegmentId, ui32Offset, ui32Len);
+        return -1;
+    }
+    pSegment->ui32Pins++;
+    view._pStore = this;
+    view._ui32SegmentId = ui32SegmentId;
+    view._pData = pSegment->pBase + ui32Offset;
+    view._ui32Len = ui32Len;
+    _m.unlock();
+    return 0;
+}
+
+int PayloadSegmentStore::sync (void)
+{
+    int rc = 0;
+    _m.lock();
+    #if defined (UNIX)
+        for (UInt32Hashtable<Segment>::Iterator i = _segments.getAllElements(); !i.end(); i.nextElement()) {
+            Segment *pSegment = i.getValue();
+            if (!pSegment->bDirty || pSegment->bRemoved) {
+                continue;
+            }
+            if (msync (pSegment->pBase, pSegment->ui32Used, MS_SYNC) != 0) {
+                checkAndLogMsg ("PayloadSegmentStore::sync", Logger::L_MildError,
+                                "msync failed for segment %u\n", i.getKey());
+                rc = -1;
+                continue;
+            }
+            pSegment->bDirty = false;
+        }
+    #endif
+    _m.unlock();
+    return rc;
+}
+
+unsigned int PayloadSegmentStore::getSealedSegments (DArray2<uint32> &segmentIds, DArray2<uint32> &usedBytes)
+{
+    unsigned int uiCount = 0;
+    _m.lock();
+    for (UInt32Hashtable<Segment>::Iterator i = _segments.getAllElements(); !i.end(); i.nextElement()) {
+        Segment *pSegment = i.getValue();
+        if (pSegment->bSealed && !pSegment->bRemoved) {
+            segmentIds[uiCount] = i.getKey();
+            usedBytes[uiCount] = pSegment->ui32Used;
+            uiCount++;
+        }
+    }
+    _m.unlock();
+    return uiCount;
+}
+
+int PayloadSegmentStore::removeSegment (uint32 ui32SegmentId)
+{
+    _m.lock();
+    Segment *pSegment = _segments.get (ui32SegmentId);
+    if ((pSegment == NULL) || pSegment->bRemoved) {
+        _m.unlock();
+        return -1;
+    }
+    if (ui32SegmentId == _ui32ActiveSegmentId) {
+        _m.unlock();
+        return -2;
+    }
+
+    // The file can be unlinked right away: the mapping stays valid until
+    // the segment is unmapped
+    FileUtils::deleteFile (pSegment->fileName);
+    pSegment->bRemoved = true;
+    if (pSegment->ui32Pins == 0) {
+        unmap (pSegment);
+        delete _segments.remove (ui32SegmentId);
+    }
+    checkAndLogMsg ("PayloadSegmentStore::removeSegment", Logger::L_Info,
+                    "removed segment %u\n", ui32SegmentId);
+    _m.unlock();
+    return 0;
+}
+
+String PayloadSegmentStore::getSegmentFileName (uint32 ui32SegmentId) const
+{
+    char szId[12];
+    sprintf (szId, "%u", ui32SegmentId);
+    String fileName (_dirName);
+    fileName += getPathSepCharAsString();
+    fileName += SEGMENT_FILE_PREFIX;
+    fileName += szId;
+    fileName += SEGMENT_FILE_SUFFIX;
+    return fileName;
+}
+
+PayloadSegmentStore::Segment * PayloadSegmentStore::openSegment (uint32 ui32SegmentId, uint32 ui32Capacity, bool bCreate)
+{
+    #if defined (UNIX)
+        const char *pszMethodName = "PayloadSegmentStore::openSegment";
+        const String fileName (getSegmentFileName (ui32SegmentId));
+        int iFd = open (fileName, bCreate ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0644);
+        if (iFd < 0) {
+            checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                            "could not open segment file %s\n", fileName.c_str());
+            return NULL;
+        }
+        if (bCreate) {
+            // The file is sparse and zero-filled
+            if (ftruncate (iFd, (off_t) ui32Capacity) != 0) {
+                checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                                "could not resize segment file %s to %u bytes\n",
+                                fileName.c_str(), ui32Capacity);
+                close (iFd);
+                unlink (fileName);
+                return NULL;
+            }
+        }
+        else {
+            struct stat st;
+            if ((fstat (iFd, &st) != 0) || (st.st_size <= 0) || (st.st_size > 0x7FFFFFFF)) {
+                checkAndLogMsg (pszMethodName, Logger::L_Warning,
+                                "ignoring segment file %s\n", fileName.c_str());
+                close (iFd);
+                return NULL;
+            }
+            ui32Capacity = (uint32) st.st_size;
+        }
+        void *pBase = mmap (NULL, ui32Capacity, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+        if (pBase == MAP_FAILED) {
+            checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                            "could not map segment file %s\n", fileName.c_str());
+            close (iFd);
+            if (bCreate) {
+                unlink (fileName);
+            }
+            return NULL;
+        }
+
+        Segment *pSegment = new Segment();
+        if (pSegment == NULL) {
+            checkAndLogMsg (pszMethodName, memoryExhausted);
+            munmap (pBase, ui32Capacity);
+            close (iFd);
+            return NULL;
+        }
+        pSegment->iFd = iFd;
+        pSegment->pBase = (uint8 *) pBase;
+        pSegment->ui32Capacity = ui32Capacity;
+        pSegment->fileName = fileName;
+        return pSegment;
+    #else
+        return NULL;
+    #endif
+}
+
+PayloadSegmentStore::Segment * PayloadSegmentStore::newActiveSegment (uint32 ui32MinCapacity)
+{
+    Segment *pActive = (_ui32ActiveSegmentId == 0 ? NULL : _segments.get (_ui32ActiveSegmentId));
+    if (pActive != NULL) {
+        pActive->bSealed = true;
+    }
+    const uint32 ui32Capacity = (ui32MinCapacity > _ui32SegmentSize ?
+                                 roundUp (ui32MinCapacity, PAGE_SIZE) : _ui32SegmentSize);
+    const uint32 ui32SegmentId = _ui32NextSegmentId++;
+    Segment *pSegment = openSegment (ui32SegmentId, ui32Capacity, true);
+    if (pSegment == NULL) {
+        return NULL;
+    }
+    _segments.put (ui32SegmentId, pSegment);
+    _ui32ActiveSegmentId = ui32SegmentId;
+    return pSegment;
+}
+
+void PayloadSegmentStore::recover (Segment *pSegment)
+{
+    uint32 ui32Offset = 0;
+    while ((pSegment->ui32Capacity - ui32Offset) >= RECORD_HEADER_LEN) {
+        uint32 ui32Magic, ui32Len;
+        memcpy (&ui32Magic, pSegment->pBase + ui32Offset, 4);
+        memcpy (&ui32Len, pSegment->pBase + ui32Offset + 4, 4);
+        if ((ui32Magic != RECORD_MAGIC) ||
+            (ui32Len > (pSegment->ui32Capacity - ui32Offset - RECORD_HEADER_LEN))) {
+            break;
+        }
+        ui32Offset += roundUp (RECORD_HEADER_LEN + ui32Len, RECORD_ALIGNMENT);
+    }
+    pSegment->ui32Used = (ui32Offset > pSegment->ui32Capacity ? pSegment->ui32Capacity : ui32Offset);
+}
+
+void PayloadSegmentStore::unmap (Segment *pSegment)
+{
+    #if defined (UNIX)
+        if (pSegment->pBase != NULL) {
+            munmap (pSegment->pBase, pSegment->ui32Capacity);
+            pSegment->pBase = NULL;
+        }
+        if (pSegment->iFd >= 0) {
+            close (pSegment->iFd);
+            pSegment->iFd = -1;
+        }
+    #endif
+}
+
+void PayloadSegmentStore::release (uint32 ui32SegmentId)
+{
+    _m.lock();
+    Segment *pSegment = _segments.get (ui32SegmentId);
+    if ((pSegment != NULL) && (pSegment->ui32Pins > 0)) {
+        pSegment->ui32Pins--;
+        if (pSegment->bRemoved && (pSegment->ui32Pins == 0)) {
+            unmap (pSegment);
+            delete _segments.remove (ui32SegmentId);
+        }
+    }
+    _m.unlock();
+}
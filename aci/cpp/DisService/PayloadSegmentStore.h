@@ -0,0 +1,192 @@
+/*
+ * PayloadSegmentStore.h
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Log-structured store for the payloads of the messages in the persistent
+ * data cache.
+ *
+ * Payloads are appended to fixed-size segment files that are memory-mapped,
+ * and they are addressed by (segment id, offset, length).  Segments are never
+ * modified after being written: when a segment is full it is sealed and a new
+ * one is created.  Space is reclaimed by removing sealed segments that do not
+ * contain live payloads anymore (see SQLMessageStorage's compaction).
+ *
+ * Segment ids start from 1, therefore 0 can be used to mark a missing locator.
+ *
+ * Memory-mapped segments are only supported on UNIX platforms; elsewhere
+ * init() fails and the caller is expected to keep the payloads in the
+ * database.
+ */
+
+#ifndef INCL_PAYLOAD_SEGMENT_STORE_H
+#define INCL_PAYLOAD_SEGMENT_STORE_H
+
+#include "DArray2.h"
+#include "FTypes.h"
+#include "Mutex.h"
+#include "StrClass.h"
+#include "UInt32Hashtable.h"
+
+namespace IHMC_ACI
+{
+    class PayloadSegmentStore;
+
+    /*
+     * Read-only view of a payload.  As long as the view is held, the segment
+     * that contains the payload stays mapped, even if it gets compacted in the
+     * meanwhile.  Payloads that are not stored in a segment (for instance the
+     * ones stored in the database by older versions) are returned as a copy
+     * owned by the view.
+     */
+    class PayloadView
+    {
+        public:
+            PayloadView (void);
+            ~PayloadView (void);
+
+            const void * getData (void) const;
+            uint32 getLength (void) const;
+
+            /*
+             * Returns true if the view points into a memory-mapped segment,
+             * false if the data was copied.
+             */
+            bool isMapped (void) const;
+
+            /*
+             * Returns a buffer with the data, that must be deallocated by the
+             * caller by calling free(), and releases the view.  Mapped data
+             * is copied, owned data is handed over as it is.
+             */
+            void * detach (void);
+
+            void release (void);
+
+        private:
+            friend class PayloadSegmentStore;
+            friend class SQLMessageStorage;
+
+            // Views can not be copied
+            PayloadView (const PayloadView &);
+            PayloadView & operator = (const PayloadView &);
+
+            void setOwned (void *pData, uint32 ui32Len);
+
+            PayloadSegmentStore *_pStore;
+            uint32 _ui32SegmentId;
+            const void *_pData;
+            uint32 _ui32Len;
+            void *_pOwnedData;
+    };
+
+    class PayloadSegmentStore
+    {
+        public:
+            static const uint32 DEFAULT_SEGMENT_SIZE = 64U * 1024U * 1024U;
+
+            /*
+             * pszDirName is the directory that contains the segment files.
+             * It is created if it does not exist.
+             */
+            PayloadSegmentStore (const char *pszDirName, uint32 ui32SegmentSize = DEFAULT_SEGMENT_SIZE);
+            ~PayloadSegmentStore (void);
+
+            /*
+             * Maps the segments that already exist in the directory and
+             * recovers the append position of each one of them.
+             * Returns 0 if successful, a negative number otherwise.
+             */
+            int init (void);
+
+            /*
+             * Appends the payload to the active segment and returns its
+             * locator.  Payloads larger than the segment size are stored in a
+             * dedicated segment.
+             * Returns 0 if successful, a negative number otherwise.
+             */
+            int append (const void *pData, uint32 ui32Len, uint32 &ui32SegmentId, uint32 &ui32Offset);
+
+            /*
+             * Returns a copy of the payload, that must be deallocated by the
+             * caller by calling free(), or NULL if the locator is not valid.
+             */
+            void * copy (uint32 ui32SegmentId, uint32 ui32Offset, uint32 ui32Len);
+
+            /*
+             * Sets view to point to the payload in the mapped segment.
+             * Returns 0 if successful, a negative number otherwise.
+             */
+            int getView (uint32 ui32SegmentId, uint32 ui32Offset, uint32 ui32Len, PayloadView &view);
+
+            /*
+             * Flushes the segments that have been written since the last
+             * call to disk.  It should be called before committing the
+             * locators of the written payloads.
+             */
+            int sync (void);
+
+            /*
+             * Fills segmentIds and usedBytes with the ids of the sealed
+             * segments, and the number of bytes written in each one of them.
+             * Returns the number of sealed segments.
+             */
+            unsigned int getSealedSegments (NOMADSUtil::DArray2<uint32> &segmentIds,
+                                            NOMADSUtil::DArray2<uint32> &usedBytes);
+
+            /*
+             * Deletes the segment file.  If the segment is referenced by any
+             * view, the segment is unmapped when the last view is released.
+             * The active segment can not be removed.
+             */
+            int removeSegment (uint32 ui32SegmentId);
+
+        private:
+            friend class PayloadView;
+
+            struct Segment
+            {
+                Segment (void);
+                ~Segment (void);
+
+                int iFd;
+                uint8 *pBase;
+                uint32 ui32Capacity;
+                uint32 ui32Used;
+                uint32 ui32Pins;
+                bool bSealed;
+                bool bDirty;
+                bool bRemoved;
+                NOMADSUtil::String fileName;
+            };
+
+            NOMADSUtil::String getSegmentFileName (uint32 ui32SegmentId) const;
+            Segment * openSegment (uint32 ui32SegmentId, uint32 ui32Capacity, bool bCreate);
+            Segment * newActiveSegment (uint32 ui32MinCapacity);
+            void recover (Segment *pSegment);
+            void unmap (Segment *pSegment);
+            void release (uint32 ui32SegmentId);
+
+            const NOMADSUtil::String _dirName;
+            const uint32 _ui32SegmentSize;
+            uint32 _ui32NextSegmentId;
+            uint32 _ui32ActiveSegmentId;
+            NOMADSUtil::UInt32Hashtable<Segment> _segments;
+            NOMADSUtil::Mutex _m;
+    };
+}
+
+#endif  // INCL_PAYLOAD_SEGMENT_STORE_H
@@ -24,7 +24,10 @@
 #include "Message.h"
 #include "MessageInfo.h"
 
+#include "SharedBuffer.h"
+
 #if defined (USE_SQLITE)
+    #include "PayloadSegmentStore.h"
     #include "SQLMessageStorage.h"
 #else
     #include "Storage.h"
@@ -39,6 +42,46 @@
 using namespace IHMC_ACI;
 using namespace NOMADSUtil;
 
+#if defined (USE_SQLITE)
+namespace IHMC_ACI
+{
+    // Buffer that holds a view on a payload stored by SQLMessageStorage
+    class PayloadSharedBuffer : public SharedBuffer
+    {
+        public:
+            PayloadSharedBuffer (void);
+
+            PayloadView & getView (void);
+            void init (void);
+
+        protected:
+            ~PayloadSharedBuffer (void);
+
+        private:
+            PayloadView _view;
+    };
+}
+
+PayloadSharedBuffer::PayloadSharedBuffer (void)
+{
+}
+
+PayloadSharedBuffer::~PayloadSharedBuffer (void)
+{
+    _view.release();
+}
+
+PayloadView & PayloadSharedBuffer::getView (void)
+{
+    return _view;
+}
+
+void PayloadSharedBuffer::init (void)
+{
+    setData (_view.getData(), _view.getLength());
+}
+#endif
+
 PersistentDataCache::PersistentDataCache (bool bUseTransactionTimer)
 {
     // Setting cache's size parameters to the default value 0
@@ -203,6 +246,34 @@ int PersistentDataCache::release (const char *pszId, void *pData)
     return 0;
 }
 
+SharedBuffer * PersistentDataCache::getSharedData (const char *pszId)
+{
+    if (pszId == NULL) {
+        return NULL;
+    }
+    #if defined (USE_SQLITE)
+        if (!isAllChunksMessageID (pszId)) {
+            PayloadSharedBuffer *pBuf = new PayloadSharedBuffer();
+            _m.lock (80);
+            int rc = _pPersistentDB->getDataView (pszId, pBuf->getView());
+            _m.unlock (80);
+            if ((rc < 0) || (pBuf->getView().getData() == NULL)) {
+                pBuf->release();
+                return NULL;
+            }
+            pBuf->init();
+            if (pBuf->getView().isMapped()) {
+                dataShared (pBuf->getLength());
+            }
+            else {
+                dataCopied (pBuf->getLength());
+            }
+            return pBuf;
+        }
+    #endif
+    return DataCacheInterface::getSharedData (pszId);
+}
+
 void PersistentDataCache::getData (const char *pszId, Result &result)
 {
     _m.lock (82);
@@ -317,6 +388,9 @@ void PersistentDataCache::getDataInternal (const char *pszId, Result &result)
 
     result.ui8StorageType = MEMORY;
     result.ui32Length = pMH == NULL ? 0 : pMH->getFragmentLength();
+    if (result.pData != NULL) {
+        dataCopied (result.ui32Length);
+    }
 
     delete pMsg->getMessageHeader();
     delete pMsg;
@@ -44,6 +44,7 @@ namespace IHMC_ACI
     class Message;
     class MessageHeader;
     class MessageInfo;
+    class SharedBuffer;
     class SQLMessageStorage;
 }
 
@@ -84,6 +85,13 @@ namespace IHMC_ACI
             int release (const char *pszId, Result &result);
             int release (const char *pszId, MessageHeader *pMI);
 
+            /**
+             * When the payload is stored in a memory-mapped segment, the
+             * returned buffer points into the mapping, that stays valid until
+             * the buffer is released.  Otherwise the buffer is a copy.
+             */
+            SharedBuffer * getSharedData (const char *pszId);
+
             void clear (void);
 
         protected:
@@ -127,6 +127,12 @@ const uint8 SQLMessageHeaderStorage::FIELD_ARRIVAL_TIMESTAMP_COLUMN_NUMBER = 23;
 const String SQLMessageHeaderStorage::FIELD_DATA = "data";
 const uint8 SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER = 24;
 
+const String SQLMessageHeaderStorage::FIELD_SEGMENT_ID = "segmentId";
+const uint8 SQLMessageHeaderStorage::FIELD_SEGMENT_ID_COLUMN_NUMBER = 25;
+
+const String SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET = "segmentOffset";
+const uint8 SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET_COLUMN_NUMBER = 26;
+
 //==========================================================================
 //  HANDY GROUPS OF COLUMNS
 //==========================================================================
@@ -141,7 +147,7 @@ const String SQLMessageHeaderStorage::METAINFO_FIELDS = (String) FIELD_GROUP_NAM
                                                                + FIELD_ACKNOLEDGMENT + ", " + FIELD_METADATA;
 
 const String SQLMessageHeaderStorage::ALL = (String) METAINFO_FIELDS + ", " + FIELD_ARRIVAL_TIMESTAMP;
-const String SQLMessageHeaderStorage::ALL_PERSISTENT = (String) ALL + ", " + FIELD_DATA;
+const String SQLMessageHeaderStorage::ALL_PERSISTENT = (String) ALL + ", " + FIELD_DATA + ", " + FIELD_SEGMENT_ID + ", " + FIELD_SEGMENT_OFFSET;
 
 const String SQLMessageHeaderStorage::PRIMARY_KEY = (String) FIELD_GROUP_NAME + ", " + FIELD_SENDER_ID + ", " + FIELD_MSG_SEQ_ID + ", " +
                                                        FIELD_CHUNK_ID + ", " + FIELD_FRAGMENT_OFFSET + ", " + FIELD_FRAGMENT_LENGTH;
@@ -241,6 +247,11 @@ int SQLMessageHeaderStorage::init()
         _m.unlock (201);
         return -2;
     }
+    if (upgradeTable() < 0) {
+        checkAndLogMsg (pszMethodName, Logger::L_SevereError, "could not upgrade table\n");
+        _m.unlock (201);
+        return -2;
+    }
 
     String index = "CREATE INDEX seqIdIdx ON ";
     index = index + TABLE_NAME;
@@ -274,6 +285,11 @@ int SQLMessageHeaderStorage::init()
     return 0;
 }
 
+int SQLMessageHeaderStorage::upgradeTable (void)
+{
+    return 0;
+}
+
 PropertyStoreInterface * SQLMessageHeaderStorage::getPropertyStore (void)
 {
     return _pPropStore;
@@ -228,6 +228,14 @@ namespace IHMC_ACI
             static const NOMADSUtil::String FIELD_DATA;
             static const uint8 FIELD_DATA_COLUMN_NUMBER;
 
+            // Locator of the payload in the PayloadSegmentStore.  When the
+            // payload is stored in a segment, FIELD_DATA is NULL.
+            static const NOMADSUtil::String FIELD_SEGMENT_ID;
+            static const uint8 FIELD_SEGMENT_ID_COLUMN_NUMBER;
+
+            static const NOMADSUtil::String FIELD_SEGMENT_OFFSET;
+            static const uint8 FIELD_SEGMENT_OFFSET_COLUMN_NUMBER;
+
             static const NOMADSUtil::String METAINFO_FIELDS;
             static const NOMADSUtil::String ALL;
             static const NOMADSUtil::String ALL_PERSISTENT;
@@ -285,6 +293,12 @@ namespace IHMC_ACI
             virtual NOMADSUtil::String getCreateTableSQLStatement (void);
             virtual NOMADSUtil::String getInsertIntoTableSQLStatement (void);
 
+            /*
+             * Called after the table is created, to add the columns that
+             * may be missing from tables created by previous versions
+             */
+            virtual int upgradeTable (void);
+
             virtual int eliminateAllTheMessageFragments (const char *pszGroupName, const char *pszSenderNodeId,
                                                          uint32 ui32MsgSeqId, uint8 ui8ChunkId,
                                                          NOMADSUtil::DArray2<NOMADSUtil::String> *pDeleteMessageIDs);
@@ -23,12 +23,17 @@
 #define TRANSACTION_COMMIT_INTERVAL 60000
 // iterations
 #define VACUUM_INTERVAL 10
+// milliseconds
+#define COMPACTION_INTERVAL 30000
+// percentage of live data under which a sealed segment is compacted
+#define COMPACTION_THRESHOLD 50
 
 #include "DisServiceDataCacheQuery.h"
 #include "DisServiceDefs.h"
 #include "DSSFLib.h"
 #include "Message.h"
 #include "MessageInfo.h"
+#include "PayloadSegmentStore.h"
 #include "SQLMessageHeaderStorage.h"
 
 #include "PreparedStatement.h"
@@ -48,13 +53,17 @@ using namespace NOMADSUtil;
 SQLMessageStorage::SQLMessageStorage (const char *pszDBName, bool bUseTransactionTimer)
     : SQLMessageHeaderStorage (pszDBName),
     _pCommitThread (NULL),
+    _pCompactionThread (NULL),
     _bUseTransactionTimer (pszDBName == NULL ? false : bUseTransactionTimer),
+    _pPayloadStore (NULL),
     _pDSDCQuery (new DisServiceDataCacheQuery()),
     _pGetData (NULL),
     _pGetFullyQualifiedMsg (NULL),
     _pGetMsg (NULL),
     _pGetComplChunksPrepStmt (NULL),
-    _pGetComplAnnotationsPrepStmt (NULL)
+    _pGetComplAnnotationsPrepStmt (NULL),
+    _pGetSegmentRecords (NULL),
+    _pRelocatePayload (NULL)
 {
 }
 
@@ -70,9 +79,25 @@ SQLMessageStorage::~SQLMessageStorage (void)
     _pGetComplChunksPrepStmt = NULL;
     delete _pGetComplAnnotationsPrepStmt;
     _pGetComplAnnotationsPrepStmt = NULL;
+    if (_pCompactionThread != NULL) {
+        // Wake the thread up, and wait for it to be done with the payload
+        // store before deleting it
+        _pCompactionThread->requestTermination();
+        _pCompactionThread->requestTerminationAndWait();
+        delete _pCompactionThread;
+        _pCompactionThread = NULL;
+    }
     if (_pCommitThread != NULL && _pCommitThread->isRunning()) {
         _pCommitThread->requestTermination();
     }
+    _m.lock (233);
+    delete _pGetSegmentRecords;
+    _pGetSegmentRecords = NULL;
+    delete _pRelocatePayload;
+    _pRelocatePayload = NULL;
+    delete _pPayloadStore;
+    _pPayloadStore = NULL;
+    _m.unlock (233);
 }
 
 int SQLMessageStorage::init()
@@ -83,6 +108,30 @@ int SQLMessageStorage::init()
 
     const char *pszMethodName = "SQLMessageStorage::init";
 
+    if ((_dbName.length() > 0) && (_dbName != ":memory:")) {
+        // The payloads of an on-disk database are stored in memory-mapped
+        // segments, next to the database file
+        String segmentsDir (_dbName);
+        segmentsDir += ".segments";
+        _pPayloadStore = new PayloadSegmentStore (segmentsDir);
+        if (_pPayloadStore->init() < 0) {
+            checkAndLogMsg (pszMethodName, Logger::L_Warning, "could not initialize the "
+                            "payload segments in %s; data will be stored in the database\n",
+                            segmentsDir.c_str());
+            delete _pPayloadStore;
+            _pPayloadStore = NULL;
+        }
+        else {
+            _pCompactionThread = new CompactionThread (this);
+            _pCompactionThread->start();
+            // requestTerminationAndWait() does not wait for a thread that
+            // has not started yet
+            while (!_pCompactionThread->isRunning()) {
+                sleepForMilliseconds (10);
+            }
+        }
+    }
+
     // start a transaction. jk 12/2009
     // Now we can set whether or not we are using transactions using a setting in the configuration file.
     // Eventually we should probably fix it so the transaction timer interval is configurable as well.
@@ -141,6 +190,8 @@ String SQLMessageStorage::getCreateTableSQLStatement()
     sql = sql + FIELD_METADATA +" INT, ";
     sql = sql + FIELD_ARRIVAL_TIMESTAMP +" INT, ";
     sql = sql + FIELD_DATA +" BLOB, ";
+    sql = sql + FIELD_SEGMENT_ID +" INT, ";
+    sql = sql + FIELD_SEGMENT_OFFSET +" INT, ";
 
     sql += "PRIMARY KEY (";
     sql = sql + SQLMessageHeaderStorage::PRIMARY_KEY + "));";
@@ -157,31 +208,155 @@ String SQLMessageStorage::getInsertIntoTableSQLStatement()
                          "?,?,?,?,?,"
                          "?,?,?,?,?,"
                          "?,?,?,?,?,"
-                         "?,?,?,?,?);";
+                         "?,?,?,?,?,"
+                         "?,?);";
 
     return sql;
 }
 
+int SQLMessageStorage::upgradeTable (void)
+{
+    const char *pszMethodName = "SQLMessageStorage::upgradeTable";
+
+    // Tables created by previous versions do not have the locator columns
+    String sql = (String) "PRAGMA table_info (" + SQLMessageHeaderStorage::TABLE_NAME + ");";
+    PreparedStatement *pStmt = (*_pDB)->prepare (sql);
+    if (pStmt == NULL) {
+        checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                        "failed to prepare statement: %s\n", sql.c_str());
+        return -1;
+    }
+    Row *pRow = pStmt->getRow();
+    if (pRow == NULL) {
+        checkAndLogMsg (pszMethodName, memoryExhausted);
+        delete pStmt;
+        return -2;
+    }
+    bool bHasSegmentId = false;
+    bool bHasSegmentOffset = false;
+    while (pStmt->next (pRow)) {
+        char *pszColumnName = NULL;
+        if ((pRow->getValue (1, &pszColumnName) == 0) && (pszColumnName != NULL)) {
+            if (SQLMessageHeaderStorage::FIELD_SEGMENT_ID == pszColumnName) {
+                bHasSegmentId = true;
+            }
+            else if (SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET == pszColumnName) {
+                bHasSegmentOffset = true;
+            }
+        }
+        free (pszColumnName);
+    }
+    delete pRow;
+    delete pStmt;
+
+    if (!bHasSegmentId) {
+        sql = (String) "ALTER TABLE " + SQLMessageHeaderStorage::TABLE_NAME + " ADD COLUMN "
+            + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + " INT;";
+        if ((*_pDB)->execute (sql) < 0) {
+            return -3;
+        }
+    }
+    if (!bHasSegmentOffset) {
+        sql = (String) "ALTER TABLE " + SQLMessageHeaderStorage::TABLE_NAME + " ADD COLUMN "
+            + SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET + " INT;";
+        if ((*_pDB)->execute (sql) < 0) {
+            return -4;
+        }
+    }
+
+    // Used by the compaction
+    sql = (String) "CREATE INDEX IF NOT EXISTS segmentIdIdx ON " + SQLMessageHeaderStorage::TABLE_NAME
+        + " (" + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + ");";
+    if ((*_pDB)->execute (sql) < 0) {
+        return -5;
+    }
+    return 0;
+}
+
 int SQLMessageStorage::insertIntoDataCacheBind (PreparedStatement *pStmt, Message *pMsg)
 {
     if (SQLMessageHeaderStorage::insertIntoDataCacheBind (pStmt, pMsg) < 0) {
         return -1;
     }
 
-    return pStmt->bind (SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER + 1,
-                        pMsg->getData(), pMsg->getMessageHeader()->getFragmentLength());
+    const void *pData = pMsg->getData();
+    const uint32 ui32Len = pMsg->getMessageHeader()->getFragmentLength();
+    uint32 ui32SegmentId = 0;
+    uint32 ui32Offset = 0;
+    if ((_pPayloadStore != NULL) && (pData != NULL) && (ui32Len > 0) &&
+        (_pPayloadStore->append (pData, ui32Len, ui32SegmentId, ui32Offset) == 0) &&
+        (_bUseTransactionTimer || (_pPayloadStore->sync() == 0))) {
+        // Without the transaction timer the insert is committed right away,
+        // hence the data is synced first, and it is stored in the database if
+        // it can't be.
+        // If the insert fails, the appended data is never referenced, and
+        // it is eventually reclaimed by the compaction
+        if (pStmt->bindNull (SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER + 1) < 0 ||
+            pStmt->bind (SQLMessageHeaderStorage::FIELD_SEGMENT_ID_COLUMN_NUMBER + 1, ui32SegmentId) < 0 ||
+            pStmt->bind (SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET_COLUMN_NUMBER + 1, ui32Offset) < 0) {
+            return -2;
+        }
+        return 0;
+    }
+
+    if (pStmt->bind (SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER + 1, pData, ui32Len) < 0 ||
+        pStmt->bindNull (SQLMessageHeaderStorage::FIELD_SEGMENT_ID_COLUMN_NUMBER + 1) < 0 ||
+        pStmt->bindNull (SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET_COLUMN_NUMBER + 1) < 0) {
+        return -3;
+    }
+    return 0;
+}
+
+int SQLMessageStorage::getPayload (Row *pRow, uint8 ui8DataColumn, uint32 ui32Len, void **ppData)
+{
+    *ppData = NULL;
+    uint32 ui32SegmentId = 0;
+    if (pRow->getValue (ui8DataColumn + 1, ui32SegmentId) < 0) {
+        return -1;
+    }
+    if (ui32SegmentId == 0) {
+        // The data is stored in the database
+        int iLen;
+        return pRow->getValue (ui8DataColumn, ppData, iLen);
+    }
+
+    uint32 ui32Offset = 0;
+    if (pRow->getValue (ui8DataColumn + 2, ui32Offset) < 0) {
+        return -2;
+    }
+    if (_pPayloadStore == NULL) {
+        checkAndLogMsg ("SQLMessageStorage::getPayload", Logger::L_Warning,
+                        "the data is stored in segment %u, but the payload segments are not available\n",
+                        ui32SegmentId);
+        return -3;
+    }
+    *ppData = _pPayloadStore->copy (ui32SegmentId, ui32Offset, ui32Len);
+    return (*ppData == NULL ? -4 : 0);
 }
 
 void * SQLMessageStorage::getData (const char *pszKey)
 {
-    const char *pszMethodName = "SQLMessageStorage::getData";
-    if (pszKey == NULL) {
+    PayloadView view;
+    if (getDataView (pszKey, view) < 0) {
         return NULL;
     }
+    return view.detach();
+}
+
+int SQLMessageStorage::getDataView (const char *pszKey, PayloadView &view)
+{
+    const char *pszMethodName = "SQLMessageStorage::getDataView";
+    view.release();
+    if (pszKey == NULL) {
+        return -1;
+    }
 
     _m.lock (228);
     if (_pGetData == NULL) {
-        String sql = (String) "SELECT " + SQLMessageHeaderStorage::FIELD_DATA
+        String sql = (String) "SELECT " + SQLMessageHeaderStorage::FIELD_DATA + ", "
+                   + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + ", "
+                   + SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET + ", "
+                   + SQLMessageHeaderStorage::FIELD_FRAGMENT_LENGTH
                    + " FROM  " + SQLMessageHeaderStorage::TABLE_NAME + " WHERE "
                    + SQLMessageHeaderStorage::FIELD_GROUP_NAME + " = ?1 AND "
                    + SQLMessageHeaderStorage::FIELD_SENDER_ID + " = ?2 AND "
@@ -195,14 +370,14 @@ void * SQLMessageStorage::getData (const char *pszKey)
             checkAndLogMsg (pszMethodName, Logger::L_SevereError,
                             "failed to prepare statement. %s\n", (const char *)sql);
             _m.unlock (228);
-            return NULL;
+            return -2;
         }
     }
 
     DArray2<NOMADSUtil::String> tokens (6);
     if (convertKeyToField (pszKey, tokens) != 0) {
         _m.unlock (228);
-        return NULL;
+        return -3;
     }
 
     if (_pGetData->bind (1, tokens[MSG_ID_GROUP]) < 0 ||
@@ -215,37 +390,56 @@ void * SQLMessageStorage::getData (const char *pszKey)
                         "Error when binding values.\n");
         _pGetData->reset();
         _m.unlock (228);
-        return NULL;
+        return -4;
     }
 
     Row *pRow = _pGetData->getRow();
     if (pRow == NULL) {
-        checkAndLogMsg ("SQLMessageStorage::getData", memoryExhausted);
+        checkAndLogMsg (pszMethodName, memoryExhausted);
         _pGetData->reset();
         _m.unlock (228);
-        return NULL;
+        return -5;
     }
 
-    void *pRet = NULL;
-    int iLen;
+    int rc = -6;
     for (unsigned short i = 0; _pGetData->next (pRow); i++) {
         if (i > 0) {
             checkAndLogMsg (pszMethodName, Logger::L_SevereError,
                             "Message is not uniquely identified.\n");
         }
         assert (i == 0);
-        if (pRow->getValue (0, &pRet, iLen) < 0) {
+        uint32 ui32SegmentId = 0;
+        uint32 ui32Offset = 0;
+        uint32 ui32Len = 0;
+        if (pRow->getValue (1, ui32SegmentId) < 0 || pRow->getValue (2, ui32Offset) < 0 ||
+            pRow->getValue (3, ui32Len) < 0) {
             checkAndLogMsg (pszMethodName, Logger::L_SevereError,
                             "pRow->getValue returned an error.\n");
             break;
         }
+        if (ui32SegmentId > 0) {
+            rc = (_pPayloadStore == NULL ? -7 : _pPayloadStore->getView (ui32SegmentId, ui32Offset, ui32Len, view));
+        }
+        else {
+            // The data is stored in the database
+            void *pData = NULL;
+            int iLen;
+            if (pRow->getValue (0, &pData, iLen) < 0) {
+                checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                                "pRow->getValue returned an error.\n");
+                break;
+            }
+            view.setOwned (pData, (uint32) iLen);
+            rc = (pData == NULL ? -8 : 0);
+        }
+        break;
     }
 
     delete pRow;
     _pGetData->reset();
     _m.unlock (228);
 
-    return pRet;
+    return rc;
 }
 
 Message * SQLMessageStorage::getMessage (const char *pszKey)
@@ -339,7 +533,6 @@ Message * SQLMessageStorage::getMessage (const char *pszKey)
 
     void *pData = NULL;
     MessageHeader *pMI = NULL;
-    int iLen;
     for (unsigned short i = 0; pQuery->next (pRow); i++) {
         if (i > 0) {
             checkAndLogMsg (pszMethodName, Logger::L_SevereError,
@@ -350,7 +543,9 @@ Message * SQLMessageStorage::getMessage (const char *pszKey)
         }
 
         pMI = getMessageInfo (pRow);
-        if (pRow->getValue (SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER, &pData, iLen) < 0) {
+        if ((pMI == NULL) ||
+            (getPayload (pRow, SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER,
+                         pMI->getFragmentLength(), &pData) < 0)) {
             checkAndLogMsg (pszMethodName, Logger::L_SevereError,
                             "pRow->getValue returned an error.\n");
             break;
@@ -514,9 +709,8 @@ PtrLList<Message> * SQLMessageStorage::getMessages (PreparedStatement *pStmt, ui
             continue;
         }
         void *pData = NULL;
-        int iLen;
-        int rc = pRow->getValue (SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER,
-                                 &pData, iLen);
+        int rc = getPayload (pRow, SQLMessageHeaderStorage::FIELD_DATA_COLUMN_NUMBER,
+                             pMH->getFragmentLength(), &pData);
         if (rc < 0) {
             delete pMH;
             continue;
@@ -538,6 +732,192 @@ PtrLList<Message> * SQLMessageStorage::getMessages (PreparedStatement *pStmt, ui
     return pRet;
 }
 
+//------------------------------------------------------------------------------
+// Payload compaction
+//------------------------------------------------------------------------------
+
+int SQLMessageStorage::compactPayloads (void)
+{
+    const char *pszMethodName = "SQLMessageStorage::compactPayloads";
+    _m.lock (233);
+    if (_pPayloadStore == NULL) {
+        // The storage is being deleted
+        _m.unlock (233);
+        return 0;
+    }
+    DArray2<uint32> segmentIds;
+    DArray2<uint32> usedBytes;
+    const unsigned int uiSealedSegments = _pPayloadStore->getSealedSegments (segmentIds, usedBytes);
+    if (uiSealedSegments == 0) {
+        _m.unlock (233);
+        return 0;
+    }
+
+    // Compute the live data in each segment
+    String sql = (String) "SELECT " + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + ", "
+               + "SUM (" + SQLMessageHeaderStorage::FIELD_FRAGMENT_LENGTH + ") FROM "
+               + SQLMessageHeaderStorage::TABLE_NAME + " WHERE "
+               + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + " > 0 GROUP BY "
+               + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + ";";
+    PreparedStatement *pStmt = (*_pDB)->prepare (sql);
+    if (pStmt == NULL) {
+        checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                        "failed to prepare statement: %s\n", sql.c_str());
+        _m.unlock (233);
+        return -1;
+    }
+    Row *pRow = pStmt->getRow();
+    if (pRow == NULL) {
+        checkAndLogMsg (pszMethodName, memoryExhausted);
+        delete pStmt;
+        _m.unlock (233);
+        return -2;
+    }
+    UInt32Hashtable<uint32> liveBytes (true);
+    while (pStmt->next (pRow)) {
+        uint32 ui32SegmentId = 0;
+        uint32 ui32LiveBytes = 0;
+        if (pRow->getValue (0, ui32SegmentId) == 0 && pRow->getValue (1, ui32LiveBytes) == 0) {
+            liveBytes.put (ui32SegmentId, new uint32 (ui32LiveBytes));
+        }
+    }
+    delete pRow;
+    delete pStmt;
+
+    DArray2<uint32> retiredSegmentIds;
+    unsigned int uiRetiredSegments = 0;
+    for (unsigned int i = 0; i < uiSealedSegments; i++) {
+        const uint32 *pui32LiveBytes = liveBytes.get (segmentIds[i]);
+        const uint32 ui32LiveBytes = (pui32LiveBytes == NULL ? 0 : *pui32LiveBytes);
+        if (ui32LiveBytes == 0) {
+            retiredSegmentIds[uiRetiredSegments++] = segmentIds[i];
+        }
+        else if (((uint64) ui32LiveBytes * 100U) < ((uint64) usedBytes[i] * COMPACTION_THRESHOLD)) {
+            if (relocatePayloads (segmentIds[i]) == 0) {
+                retiredSegmentIds[uiRetiredSegments++] = segmentIds[i];
+            }
+        }
+    }
+
+    if (uiRetiredSegments > 0) {
+        // The segments can be removed only after the relocated data and the
+        // new locators have been made durable
+        _pPayloadStore->sync();
+        if (_bUseTransactionTimer) {
+            if ((*_pDB)->endTransaction (true) < 0) {
+                checkAndLogMsg (pszMethodName, Logger::L_MildError,
+                                "can't commit; the segments will be removed later\n");
+                uiRetiredSegments = 0;
+            }
+            if ((*_pDB)->beginTransaction() < 0) {
+                checkAndLogMsg (pszMethodName, Logger::L_SevereError, "can't begin transaction\n");
+            }
+        }
+        for (unsigned int i = 0; i < uiRetiredSegments; i++) {
+            _pPayloadStore->removeSegment (retiredSegmentIds[i]);
+        }
+        checkAndLogMsg (pszMethodName, Logger::L_Info, "removed %u out of %u sealed segments\n",
+                        uiRetiredSegments, uiSealedSegments);
+    }
+    _m.unlock (233);
+    return (int) uiRetiredSegments;
+}
+
+int SQLMessageStorage::relocatePayloads (uint32 ui32SegmentId)
+{
+    const char *pszMethodName = "SQLMessageStorage::relocatePayloads";
+    if (_pGetSegmentRecords == NULL) {
+        String sql = (String) "SELECT rowid, " + SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET + ", "
+                   + SQLMessageHeaderStorage::FIELD_FRAGMENT_LENGTH + " FROM "
+                   + SQLMessageHeaderStorage::TABLE_NAME + " WHERE "
+                   + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + " = ?1;";
+        _pGetSegmentRecords = (*_pDB)->prepare (sql);
+        if (_pGetSegmentRecords == NULL) {
+            checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                            "failed to prepare statement: %s\n", sql.c_str());
+            return -1;
+        }
+    }
+    if (_pRelocatePayload == NULL) {
+        String sql = (String) "UPDATE " + SQLMessageHeaderStorage::TABLE_NAME + " SET "
+                   + SQLMessageHeaderStorage::FIELD_SEGMENT_ID + " = ?1, "
+                   + SQLMessageHeaderStorage::FIELD_SEGMENT_OFFSET + " = ?2 WHERE rowid = ?3;";
+        _pRelocatePayload = (*_pDB)->prepare (sql);
+        if (_pRelocatePayload == NULL) {
+            checkAndLogMsg (pszMethodName, Logger::L_SevereError,
+                            "failed to prepare statement: %s\n", sql.c_str());
+            return -2;
+        }
+    }
+
+    // Read the locators first, the rows are updated afterwards
+    if (_pGetSegmentRecords->bind (1, ui32SegmentId) < 0) {
+        checkAndLogMsg (pszMethodName, bindingError);
+        _pGetSegmentRecords->reset();
+        return -3;
+    }
+    Row *pRow = _pGetSegmentRecords->getRow();
+    if (pRow == NULL) {
+        checkAndLogMsg (pszMethodName, memoryExhausted);
+        _pGetSegmentRecords->reset();
+        return -4;
+    }
+    DArray2<int64> rowIds;
+    DArray2<uint32> offsets;
+    DArray2<uint32> lengths;
+    unsigned int uiRecords = 0;
+    while (_pGetSegmentRecords->next (pRow)) {
+        if (pRow->getValue (0, rowIds[uiRecords]) < 0 ||
+            pRow->getValue (1, offsets[uiRecords]) < 0 ||
+            pRow->getValue (2, lengths[uiRecords]) < 0) {
+            delete pRow;
+            _pGetSegmentRecords->reset();
+            return -5;
+        }
+        uiRecords++;
+    }
+    delete pRow;
+    _pGetSegmentRecords->reset();
+
+    DArray2<uint32> newSegmentIds;
+    DArray2<uint32> newOffsets;
+    for (unsigned int i = 0; i < uiRecords; i++) {
+        PayloadView view;
+        if (_pPayloadStore->getView (ui32SegmentId, offsets[i], lengths[i], view) < 0 ||
+            _pPayloadStore->append (view.getData(), view.getLength(), newSegmentIds[i], newOffsets[i]) < 0) {
+            checkAndLogMsg (pszMethodName, Logger::L_MildError,
+                            "could not move record %u:%u\n", ui32SegmentId, offsets[i]);
+            return -6;
+        }
+        view.release();
+    }
+
+    // Without the transaction timer each update is committed right away, so
+    // the copies must be durable before the locators are pointed at them
+    if (!_bUseTransactionTimer && (_pPayloadStore->sync() < 0)) {
+        checkAndLogMsg (pszMethodName, Logger::L_MildError,
+                        "could not sync the records moved out of segment %u\n", ui32SegmentId);
+        return -6;
+    }
+
+    for (unsigned int i = 0; i < uiRecords; i++) {
+        if (_pRelocatePayload->bind (1, newSegmentIds[i]) < 0 ||
+            _pRelocatePayload->bind (2, newOffsets[i]) < 0 ||
+            _pRelocatePayload->bind (3, rowIds[i]) < 0 ||
+            _pRelocatePayload->update() < 0) {
+            checkAndLogMsg (pszMethodName, Logger::L_MildError,
+                            "could not update the locator of record %u:%u\n", ui32SegmentId, offsets[i]);
+            _pRelocatePayload->reset();
+            return -7;
+        }
+        _pRelocatePayload->reset();
+    }
+
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "moved %u records out of segment %u\n",
+                    uiRecords, ui32SegmentId);
+    return 0;
+}
+
 //------------------------------------------------------------------------------
 // CommitThread
 //------------------------------------------------------------------------------
@@ -576,6 +956,11 @@ void SQLMessageStorage::CommitThread::run()
         checkAndLogMsg (pszMethodName, Logger::L_Info,
                         "Committing database\n");
 
+        // Flush the payloads before committing their locators
+        if (parent->_pPayloadStore != NULL) {
+            parent->_pPayloadStore->sync();
+        }
+
         do {
             if ((s = (*pDB)->endTransaction (true)) < 0) {
                 checkAndLogMsg (pszMethodName, Logger::L_SevereError,
@@ -608,6 +993,11 @@ void SQLMessageStorage::CommitThread::run()
     }
 
     // Commit before terminating!
+    parent->_m.lock (232);
+    if (parent->_pPayloadStore != NULL) {
+        parent->_pPayloadStore->sync();
+    }
+    parent->_m.unlock (232);
     if ((s = (*pDB)->endTransaction (true)) < 0) {
         checkAndLogMsg (pszMethodName, Logger::L_SevereError,
                         "Can't commit - error %d, retrying\n", s);
@@ -615,3 +1005,52 @@ void SQLMessageStorage::CommitThread::run()
 
     terminating();
 }
+
+//------------------------------------------------------------------------------
+// CompactionThread
+//------------------------------------------------------------------------------
+
+SQLMessageStorage::CompactionThread::CompactionThread (SQLMessageStorage *parent)
+    : _cv (&_m)
+{
+    this->parent = parent;
+}
+
+SQLMessageStorage::CompactionThread::~CompactionThread()
+{
+    // empty
+}
+
+// This thread reclaims the space of the payload segments that only contain
+// the data of messages that have been deleted from the cache (for instance
+// because they expired), and it moves the data that is still live out of the
+// segments that are mostly dead.
+void SQLMessageStorage::CompactionThread::run()
+{
+    const char *pszMethodName = "SQLMessageStorage::CompactionThread::run";
+    setName (pszMethodName);
+
+    started();
+
+    _m.lock();
+    while (!terminationRequested()) {
+        _cv.wait (COMPACTION_INTERVAL);
+        if (terminationRequested()) {
+            break;
+        }
+        _m.unlock();
+        parent->compactPayloads();
+        _m.lock();
+    }
+    _m.unlock();
+
+    terminating();
+}
+
+void SQLMessageStorage::CompactionThread::requestTermination (void)
+{
+    _m.lock();
+    ManageableThread::requestTermination();
+    _cv.notifyAll();
+    _m.unlock();
+}
@@ -19,6 +19,11 @@
  * Implementation of StorageInterface to store
  * both the MessageHeader part and the data part
  * of a message in a database.
+ *
+ * When the database is stored on disk, the data part is appended to the
+ * memory-mapped segments of a PayloadSegmentStore, and the database only
+ * stores its locator.  Segments that do not contain live data anymore are
+ * reclaimed by the compaction thread.
  */
 
 #ifndef INCL_SQL_MESSAGE_STORAGE_H
@@ -26,13 +31,17 @@
 
 #include "SQLMessageHeaderStorage.h"
 
+#include "ConditionVariable.h"
 #include "FTypes.h"
 #include "PtrLList.h"
 #include "ManageableThread.h"
+#include "Mutex.h"
 
 namespace IHMC_ACI
 {
     class DisServiceDataCacheQuery;
+    class PayloadSegmentStore;
+    class PayloadView;
 
     class SQLMessageStorage : public SQLMessageHeaderStorage
     {
@@ -48,6 +57,14 @@ namespace IHMC_ACI
              */
             void * getData (const char *pszKey);
 
+            /**
+             * Sets view to the data matching the key.  When the data is
+             * stored in a segment, the view points into the mapped segment
+             * and no copy is made.
+             * Returns 0 if successful, a negative number otherwise.
+             */
+            int getDataView (const char *pszKey, PayloadView &view);
+
             /**
              * Returns the Message matching the key from the table specified by
              * the parameter
@@ -76,6 +93,7 @@ namespace IHMC_ACI
 
             NOMADSUtil::String getCreateTableSQLStatement (void);
             NOMADSUtil::String getInsertIntoTableSQLStatement (void);
+            int upgradeTable (void);
 
             /*
              * Insert the MessageInfo fields into the default data cache
@@ -85,6 +103,21 @@ namespace IHMC_ACI
         private:
             NOMADSUtil::PtrLList<Message> * getMessages (IHMC_MISC::PreparedStatement *pStmt, uint16 ui16LimitElements = 0);
 
+            /*
+             * Reads the data of the message in pRow.  The data column is
+             * expected to be followed by the segment id and the segment
+             * offset columns.
+             */
+            int getPayload (IHMC_MISC::Row *pRow, uint8 ui8DataColumn, uint32 ui32Len, void **ppData);
+
+            /*
+             * Removes the sealed segments that do not contain live data, and
+             * moves the live data out of the segments that are mostly dead.
+             * Returns the number of removed segments.
+             */
+            int compactPayloads (void);
+            int relocatePayloads (uint32 ui32SegmentId);
+
             class CommitThread: public NOMADSUtil::ManageableThread
             {
                 public:
@@ -96,15 +129,38 @@ namespace IHMC_ACI
                     SQLMessageStorage *parent;
             };
 
+            class CompactionThread: public NOMADSUtil::ManageableThread
+            {
+                public:
+                    CompactionThread (SQLMessageStorage *parent);
+                    virtual ~CompactionThread (void);
+
+                    virtual void run (void);
+
+                    // Also wakes the thread up if it is waiting for the next compaction
+                    virtual void requestTermination (void);
+
+                    SQLMessageStorage *parent;
+
+                private:
+                    NOMADSUtil::Mutex _m;
+                    NOMADSUtil::ConditionVariable _cv;
+            };
+
             CommitThread *_pCommitThread;
+            CompactionThread *_pCompactionThread;
             bool _bUseTransactionTimer;
 
+            PayloadSegmentStore *_pPayloadStore;
+
             DisServiceDataCacheQuery *_pDSDCQuery;
             IHMC_MISC::PreparedStatement *_pGetData;
             IHMC_MISC::PreparedStatement *_pGetFullyQualifiedMsg;    // Used to retrieve <GroupName>:<OriginatorNodeId>:<MsgSeqId>:<ChunkId>:<FragmentOffset>:<FragmentLength>
             IHMC_MISC::PreparedStatement *_pGetMsg;                  // Used to retrieve <GroupName>:<OriginatorNodeId>:<MsgSeqId>:<ChunkId>
             IHMC_MISC::PreparedStatement *_pGetComplChunksPrepStmt;
             IHMC_MISC::PreparedStatement *_pGetComplAnnotationsPrepStmt;
+            IHMC_MISC::PreparedStatement *_pGetSegmentRecords;
+            IHMC_MISC::PreparedStatement *_pRelocatePayload;
     };
 }
 
@@ -29,6 +29,7 @@
 #include "NodeInfo.h"
 #include "PropertyStoreInterface.h"
 #include "RequestsState.h"
+#include "SharedBuffer.h"
 #include "TransmissionHistoryInterface.h"
 
 #include "Logger.h"
@@ -377,7 +378,7 @@ int MessagingService::broadcastDataMessage (MessageHeader *pMH, const char *pszT
         return -4;
     }
 
-    const void *pData = _pDataCacheInterface->getData (pMH->getMsgId());
+    SharedBuffer *pData = _pDataCacheInterface->getSharedData (pMH->getMsgId());
     if (pData == NULL) {
         checkAndLogMsg ("MessagingService::sendMessage", Logger::L_Warning,
                         "Can not send message %s; pData could not be found/instantiated\n",
@@ -385,7 +386,7 @@ int MessagingService::broadcastDataMessage (MessageHeader *pMH, const char *pszT
         return -3;
     }
 
-    Message msg (pMH, pData);
+    Message msg (pMH, pData->getData());
     DisServiceDataMsg dsMsg (getDisService()->getNodeId(), &msg);
     if (pszTargetNodeId != NULL) {
         dsMsg.setTargetNodeId (pszTargetNodeId);
@@ -395,7 +396,7 @@ int MessagingService::broadcastDataMessage (MessageHeader *pMH, const char *pszT
     }
 
     int rc = broadcastDataMessage (&dsMsg, pszLogMsg, NULL, NULL, pszHints);
-    _pDataCacheInterface->release (pMH->getMsgId(), (void*)pData);
+    pData->release();
 
     return rc;
 }
@@ -0,0 +1,135 @@
+/*
+ * SharedBuffer.cpp
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "SharedBuffer.h"
+
+#include "DisServiceDefs.h"
+
+#include "Logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace IHMC_ACI;
+using namespace NOMADSUtil;
+
+namespace IHMC_ACI
+{
+    // Buffer allocated by malloc()
+    class HeapSharedBuffer : public SharedBuffer
+    {
+        public:
+            HeapSharedBuffer (void *pData, uint32 ui32Len);
+
+        protected:
+            ~HeapSharedBuffer (void);
+
+        private:
+            void *_pOwnedData;
+    };
+}
+
+HeapSharedBuffer::HeapSharedBuffer (void *pData, uint32 ui32Len)
+    : _pOwnedData (pData)
+{
+    setData (pData, ui32Len);
+}
+
+HeapSharedBuffer::~HeapSharedBuffer (void)
+{
+    free (_pOwnedData);
+    _pOwnedData = NULL;
+}
+
+//------------------------------------------------------------------------------
+// SharedBuffer
+//------------------------------------------------------------------------------
+
+SharedBuffer::SharedBuffer (void)
+    : _ui32RefCount (1U),
+      _pData (NULL),
+      _ui32Len (0U)
+{
+}
+
+SharedBuffer::~SharedBuffer (void)
+{
+}
+
+SharedBuffer * SharedBuffer::copyOf (const void *pData, uint32 ui32Len)
+{
+    if ((pData == NULL) && (ui32Len > 0)) {
+        return NULL;
+    }
+    // Allocate at least one byte, so that empty payloads are not NULL
+    void *pCopy = malloc (ui32Len > 0 ? ui32Len : 1U);
+    if (pCopy == NULL) {
+        checkAndLogMsg ("SharedBuffer::copyOf", memoryExhausted);
+        return NULL;
+    }
+    if (ui32Len > 0) {
+        memcpy (pCopy, pData, ui32Len);
+    }
+    return new HeapSharedBuffer (pCopy, ui32Len);
+}
+
+SharedBuffer * SharedBuffer::adopt (void *pData, uint32 ui32Len)
+{
+    if (pData == NULL) {
+        return NULL;
+    }
+    return new HeapSharedBuffer (pData, ui32Len);
+}
+
+void * SharedBuffer::copy (void) const
+{
+    void *pCopy = malloc (_ui32Len > 0 ? _ui32Len : 1U);
+    if (pCopy == NULL) {
+        checkAndLogMsg ("SharedBuffer::copy", memoryExhausted);
+        return NULL;
+    }
+    if (_ui32Len > 0) {
+        memcpy (pCopy, _pData, _ui32Len);
+    }
+    return pCopy;
+}
+
+SharedBuffer * SharedBuffer::retain (void)
+{
+    _m.lock();
+    _ui32RefCount++;
+    _m.unlock();
+    return this;
+}
+
+void SharedBuffer::release (void)
+{
+    _m.lock();
+    const bool bDelete = (--_ui32RefCount == 0);
+    _m.unlock();
+    if (bDelete) {
+        delete this;
+    }
+}
+
+void SharedBuffer::setData (const void *pData, uint32 ui32Len)
+{
+    _pData = pData;
+    _ui32Len = ui32Len;
+}
@@ -0,0 +1,106 @@
+/*
+ * SharedBuffer.h
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Immutable, reference-counted buffer.
+ *
+ * The data cache stores the payloads of the messages in SharedBuffers and
+ * hands out references to them, instead of a copy of the payload, to the
+ * components that only need to read it (listener notifications, replication,
+ * replies to data requests).  A buffer is deallocated when the last
+ * reference is released, therefore the data stays valid even if the message
+ * is removed from the cache while a reference is being held.
+ */
+
+#ifndef INCL_SHARED_BUFFER_H
+#define INCL_SHARED_BUFFER_H
+
+#include "FTypes.h"
+#include "Mutex.h"
+
+namespace IHMC_ACI
+{
+    class SharedBuffer
+    {
+        public:
+            /*
+             * Returns a buffer that contains a copy of pData, or NULL if the
+             * memory could not be allocated.  The returned buffer has one
+             * reference.
+             */
+            static SharedBuffer * copyOf (const void *pData, uint32 ui32Len);
+
+            /*
+             * Returns a buffer that takes the ownership of pData, that must
+             * have been allocated by malloc().  pData is deallocated by calling
+             * free() when the last reference is released.  The returned buffer
+             * has one reference.
+             */
+            static SharedBuffer * adopt (void *pData, uint32 ui32Len);
+
+            const void * getData (void) const;
+            uint32 getLength (void) const;
+
+            /*
+             * Returns a copy of the data, that must be deallocated by the
+             * caller by calling free(), or NULL if the memory could not be
+             * allocated.
+             */
+            void * copy (void) const;
+
+            /*
+             * Adds a reference to the buffer and returns the buffer itself.
+             */
+            SharedBuffer * retain (void);
+
+            /*
+             * Removes a reference to the buffer.  The buffer is deleted when
+             * the last reference is released, therefore it must not be
+             * accessed after calling release().
+             */
+            void release (void);
+
+        protected:
+            SharedBuffer (void);
+            virtual ~SharedBuffer (void);
+
+            // Must be called by the subclasses before the buffer is handed out
+            void setData (const void *pData, uint32 ui32Len);
+
+        private:
+            // Buffers can not be copied
+            SharedBuffer (const SharedBuffer &);
+            SharedBuffer & operator = (const SharedBuffer &);
+
+            uint32 _ui32RefCount;
+            const void *_pData;
+            uint32 _ui32Len;
+            NOMADSUtil::Mutex _m;
+    };
+
+    inline const void * SharedBuffer::getData (void) const
+    {
+        return _pData;
+    }
+
+    inline uint32 SharedBuffer::getLength (void) const
+    {
+        return _ui32Len;
+    }
+}
+
+#endif  // INCL_SHARED_BUFFER_H
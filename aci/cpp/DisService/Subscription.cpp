@@ -24,26 +24,14 @@
 #include "History.h"
 #include "Message.h"
 #include "MessageInfo.h"
+#include "XPathPredicate.h"
 
 #include "BufferWriter.h"
 #include "NLFLib.h"
 #include "Writer.h"
 
-#ifdef _MSC_VER
-    #pragma warning(push)
-    #pragma warning(disable: 4267)
-#endif
-
-#include "xpath_static.h"
-#include "tinyxml.h"
-
-#ifdef _MSC_VER
-    #pragma warning(pop)
-#endif
-
 using namespace IHMC_ACI;
 using namespace NOMADSUtil;
-using namespace TinyXPath;
 
 #define checkAndLogMsg if (pLogger) pLogger->logMsg
 
@@ -64,6 +52,11 @@ uint8 Subscription::getSubscriptionType (void) const
     return _ui8SubscriptionType;
 }
 
+bool Subscription::matches (const Message *pMessage, XMLMessageDocument &doc)
+{
+    return matches (pMessage);
+}
+
 bool Subscription::requireFullMessage (void)
 {
     return _bRequireFullMessage;
@@ -431,15 +424,18 @@ GroupPredicateSubscription::GroupPredicateSubscription (const char *pszPredicate
                                                         bool bGrpReliable, bool bMsgReliable, bool bSequenced)
     : _ui8PredicateType (ui8PredicateType),
       _predicate (pszPredicate),
+      _pXPathPredicate (NULL),
       _parameters (ui8Priority, bGrpReliable, (bGrpReliable ? true : bMsgReliable), bSequenced)
 {
     _ui8SubscriptionType = Subscription::GROUP_PREDICATE_SUBSCRIPTION;
     _bRequireFullMessage = true;
     _pHistory = NULL;
+    compilePredicate();
 }
 
 GroupPredicateSubscription::~GroupPredicateSubscription (void)
 {
+    delete _pXPathPredicate;
 }
 
 int GroupPredicateSubscription::addHistory (History *pHistory, uint16 ui16Tag)
@@ -570,58 +566,35 @@ bool GroupPredicateSubscription::matches (uint16 ui16Tag)
 }
 
 bool GroupPredicateSubscription::matches (const Message *pMessage)
+{
+    XMLMessageDocument doc (pMessage);
+    return matches (pMessage, doc);
+}
+
+bool GroupPredicateSubscription::matches (const Message *pMessage, XMLMessageDocument &doc)
 {
     if (_bRequireFullMessage && pMessage->getMessageInfo()->getTotalMessageLength() != pMessage->getMessageInfo()->getFragmentLength()) {
-        printf ("Received a fragment for a full message subscription (keeping the fragment)\n");
+        checkAndLogMsg ("GroupPredicateSubscription::matches", Logger::L_MediumDetailDebug,
+                        "received a fragment for a full message subscription (keeping the fragment)\n");
         return true;
     }
-
-    if (_ui8PredicateType == 0) {    //to change with the constant
-
-        //simple subscriptions (group or group/tag) not found
-
-        TiXmlElement * XEp_main;
-        TiXmlDocument * XDp_doc;
-        XDp_doc = new TiXmlDocument ("Doc title");
-        const uint32 ui32Length = pMessage->getMessageInfo()->getTotalMessageLength() + 1U;
-
-        char* pXmlDoc = (char*)malloc(ui32Length*sizeof(char));
-
-        memcpy(pXmlDoc, pMessage->getData(), pMessage->getMessageInfo()->getTotalMessageLength());
-        pXmlDoc [pMessage->getMessageInfo()->getTotalMessageLength()] = '\0';
-
-        printf("XDp_doc: %s\n", XDp_doc -> Parse (pXmlDoc));
-
-        printf("RECEIVED DATA: (%d/%d bytes)***********************************\n",pMessage->getMessageInfo()->getFragmentLength(), pMessage->getMessageInfo()->getTotalMessageLength());
-        printf("%s\n",pXmlDoc);
-        printf("END RECEIVED DATA: ***********************************\n");
-
-        //printf("Data: %s\n",(char*)pMessage->getData());
-        if( (XDp_doc -> Parse (pXmlDoc)) == NULL) { //data parsed
-            XEp_main = XDp_doc -> RootElement ();
-            if (XEp_main != NULL) {
-                TIXML_STRING out = TinyXPath::S_xpath_string (XEp_main, _predicate);
-                bool result = TinyXPath::o_xpath_bool(XEp_main, _predicate);
-                printf("xpath result: %s %d\n", out.c_str(), result);
-
-                free(XEp_main);
-
-                if (result) {
-                    free(XDp_doc);
-                    return true;
-                }
-            }
-            else {
-                printf("Received non-XML data\n");
-            }
-        }
-        else {
-            printf("Received non-XML data\n");
-        }
-        free(XDp_doc);
+    if ((_ui8PredicateType != XPATH_PREDICATE) || (_pXPathPredicate == NULL)) {
+        return false;
+    }
+    const TiXmlElement *pRoot = doc.getRootElement();
+    if (pRoot == NULL) {
+        return false;
     }
+    return _pXPathPredicate->matches (pRoot);
+}
 
-    return false;
+void GroupPredicateSubscription::compilePredicate (void)
+{
+    delete _pXPathPredicate;
+    _pXPathPredicate = NULL;
+    if ((_ui8PredicateType == XPATH_PREDICATE) && (_predicate.length() > 0)) {
+        _pXPathPredicate = new XPathPredicate (_predicate);
+    }
 }
 
 /*
@@ -744,6 +717,7 @@ int GroupPredicateSubscription::read (Reader *pReader, uint32 ui32MaxSize)
     _ui8PredicateType = ui8PredicateType;
     _predicate = pszBuf;
     free (pszBuf);
+    compilePredicate();
 
     return 0;
 }
@@ -38,6 +38,8 @@ namespace NOMADSUtil
 namespace IHMC_ACI
 {
     class Message;
+    class XMLMessageDocument;
+    class XPathPredicate;
 
     class Subscription
     {
@@ -86,6 +88,14 @@ namespace IHMC_ACI
             virtual bool matches (uint16 ui16Tag)=0;
             virtual bool matches (const Message *pMessage)=0;
 
+            /**
+             * Same as matches (pMessage), but the subscriptions that need to
+             * inspect the message's content use the parse of pMessage's data
+             * cached by doc, so that the data is parsed at most once, no
+             * matter how many subscriptions are checked against it.
+             */
+            virtual bool matches (const Message *pMessage, XMLMessageDocument &doc);
+
             /**
              * The passed Subscription is modified so that it includes the
              * Subscription which calls the merge function.
@@ -226,6 +236,7 @@ namespace IHMC_ACI
 
             bool matches (uint16 ui16Tag);
             bool matches (const Message *pMessage);
+            bool matches (const Message *pMessage, XMLMessageDocument &doc);
             bool merge (Subscription *pSubscription);
 
             int setPriority (uint8 ui8Priority);
@@ -239,9 +250,16 @@ namespace IHMC_ACI
 
             int printInfo (void);
 
+            static const uint8 XPATH_PREDICATE = 0;
+
+        private:
+            // Decodes _predicate, if it is an XPath predicate
+            void compilePredicate (void);
+
         private:
             uint8 _ui8PredicateType;
             NOMADSUtil::String _predicate;
+            XPathPredicate *_pXPathPredicate;
 
             History *_pHistory;
             Parameters _parameters;
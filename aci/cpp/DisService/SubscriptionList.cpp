@@ -25,6 +25,7 @@
 #include "MessageInfo.h"
 
 #include "Subscription.h"
+#include "XPathPredicate.h"
 
 #include "LList.h"
 #include "Logger.h"
@@ -229,12 +230,18 @@ bool SubscriptionList::hasSubscription (Message *pMessage)
 }
 
 bool SubscriptionList::hasSubscriptionWild (Message *pMessage)
+{
+    XMLMessageDocument doc (pMessage);
+    return hasSubscriptionWild (pMessage, doc);
+}
+
+bool SubscriptionList::hasSubscriptionWild (Message *pMessage, XMLMessageDocument &doc)
 {
     const char * pszGroupName = pMessage->getMessageInfo()->getGroupName();
     for (StringHashtable<Subscription>::Iterator i = _subscriptions.getAllElements(); !i.end(); i.nextElement()) {
         // for each subscription matching the group name
         if (wildcardStringCompare(pszGroupName, i.getKey()) || wildcardStringCompare(i.getKey(), pszGroupName)) {
-            if ((i.getValue())->matches (pMessage)) {
+            if ((i.getValue())->matches (pMessage, doc)) {
                 // if there's 1 or more matching the whole subscription return true
                 return true;
             }
@@ -113,6 +113,13 @@ namespace IHMC_ACI
             bool hasSubscription (Message *pMessage);
             bool hasSubscriptionWild (Message *pMessage);
 
+            /**
+             * Same as hasSubscriptionWild (pMessage), but the predicate
+             * subscriptions are evaluated against the parse of the message
+             * cached by doc, that can be shared with other subscription lists.
+             */
+            bool hasSubscriptionWild (Message *pMessage, XMLMessageDocument &doc);
+
             bool isGroupSubscription (const char *pszGroupName);
             bool isGroupTagSubscription (const char *pszGroupName);
             bool isGroupPredicateSubscription (const char *pszGroupName);
@@ -30,6 +30,7 @@
 #include "MessageInfo.h"
 #include "MessageReassembler.h"
 #include "SessionId.h"
+#include "SharedBuffer.h"
 #include "SubscriptionState.h"
 #include "WorldState.h"
 
@@ -397,20 +398,20 @@ int TransmissionServiceListener::messageArrivedInternal (const String sessionId,
             }
             else {
                 // FRAGMENT
-                void *pCachedData = NULL;
+                SharedBuffer *pCachedData = NULL;
                 char *pszTmp = pMH->getIdForCompleteMsg();
                 String completeMsgId (pszTmp);
                 if (pszTmp != NULL) {
                     free (pszTmp);
                 }
                 if (bHasCompleteMsg) {
-                    pCachedData = (void*) _pDCI->getData (completeMsgId);
+                    pCachedData = _pDCI->getSharedData (completeMsgId);
                 }
                 if (pCachedData != NULL) {
                     free ((void*) pMessage->getData());  // The message has not been inserted into the message
                                                          // reassembler therefore pData can be safely deallocated
                     void *pDataCopy = malloc (pMH->getTotalMessageLength());
-                    memcpy (pDataCopy, pCachedData, pMH->getTotalMessageLength());
+                    memcpy (pDataCopy, pCachedData->getData(), pMH->getTotalMessageLength());
                     MessageHeader *pMHCompleteMessage = pMH->clone();
                     pMHCompleteMessage->setFragmentOffset (0);
                     pMHCompleteMessage->setFragmentLength (pMHCompleteMessage->getTotalMessageLength());
@@ -419,7 +420,7 @@ int TransmissionServiceListener::messageArrivedInternal (const String sessionId,
                                                                    pMH->getTag(), pMH->getTotalMessageLength());
                     deliverCompleteMessage (pNewMessage, !bIsTarget);
 
-                    _pDCI->release (completeMsgId, pCachedData);
+                    pCachedData->release();
                 }
                 else if (MessageReassemblerUtils::loadOpportunisticallyCachedFragments (_pMsgReassembler, _pDCI, pMH, !bIsTarget)) {
                     free ((void*) pMessage->getData());  // The message has not been inserted into the message
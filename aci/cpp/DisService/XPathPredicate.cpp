@@ -0,0 +1,222 @@
+/*
+ * XPathPredicate.cpp
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "XPathPredicate.h"
+
+#include "DisServiceDefs.h"
+#include "Message.h"
+#include "MessageInfo.h"
+
+#include "Logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable: 4267)
+#endif
+
+#include "xpath_processor.h"
+#include "tinyxml.h"
+
+#ifdef _MSC_VER
+    #pragma warning(pop)
+#endif
+
+using namespace IHMC_ACI;
+using namespace NOMADSUtil;
+using namespace TinyXPath;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+//------------------------------------------------------------------------------
+// XMLMessageDocument
+//------------------------------------------------------------------------------
+
+XMLMessageDocument::XMLMessageDocument (const Message *pMessage)
+    : _bParsed (false),
+      _pMessage (pMessage),
+      _pDoc (NULL)
+{
+}
+
+XMLMessageDocument::~XMLMessageDocument (void)
+{
+    delete _pDoc;
+}
+
+const TiXmlElement * XMLMessageDocument::getRootElement (void)
+{
+    const char *pszMethodName = "XMLMessageDocument::getRootElement";
+    if (_bParsed) {
+        return (_pDoc == NULL ? NULL : _pDoc->RootElement());
+    }
+    _bParsed = true;
+    if ((_pMessage == NULL) || (_pMessage->getData() == NULL)) {
+        return NULL;
+    }
+
+    // TinyXML requires a NULL-terminated buffer
+    const uint32 ui32Len = _pMessage->getMessageInfo()->getFragmentLength();
+    char *pszXmlDoc = (char *) malloc (ui32Len + 1U);
+    if (pszXmlDoc == NULL) {
+        checkAndLogMsg (pszMethodName, memoryExhausted);
+        return NULL;
+    }
+    memcpy (pszXmlDoc, _pMessage->getData(), ui32Len);
+    pszXmlDoc[ui32Len] = '\0';
+
+    _pDoc = new TiXmlDocument();
+    _pDoc->Parse (pszXmlDoc);
+    free (pszXmlDoc);
+    if (_pDoc->Error() || (_pDoc->RootElement() == NULL)) {
+        checkAndLogMsg (pszMethodName, Logger::L_MediumDetailDebug,
+                        "received non-XML data (%u bytes)\n", ui32Len);
+        delete _pDoc;
+        _pDoc = NULL;
+        return NULL;
+    }
+    return _pDoc->RootElement();
+}
+
+//------------------------------------------------------------------------------
+// XPathPredicate::Processor
+//------------------------------------------------------------------------------
+
+namespace IHMC_ACI
+{
+    // xpath_processor decodes the expression into its action store every time
+    // it is computed, and then executes the action store on the source tree.
+    // The action store is only read during the execution, therefore it can be
+    // decoded once and executed on different trees, provided that the state
+    // of the previous execution is reset.
+    class XPathPredicate::Processor : public xpath_processor
+    {
+        public:
+            explicit Processor (const char *pszPredicate);
+
+            bool isValid (void) const;
+            bool evaluate (const TiXmlElement *pRoot);
+
+        private:
+            void reset (const TiXmlNode *pBase);
+
+            bool _bValid;
+    };
+}
+
+XPathPredicate::Processor::Processor (const char *pszPredicate)
+    : xpath_processor (NULL, pszPredicate),
+      _bValid (false)
+{
+    #if !defined (ANDROID) //No support for -fexceptions on ANDROID
+    try {
+    #endif
+        v_evaluate();
+        _bValid = (as_action_store.i_get_size() > 0);
+    #if !defined (ANDROID)
+    }
+    catch (syntax_error) {
+        _bValid = false;
+    }
+    catch (syntax_overflow) {
+        _bValid = false;
+    }
+    #endif
+}
+
+bool XPathPredicate::Processor::isValid (void) const
+{
+    return _bValid;
+}
+
+bool XPathPredicate::Processor::evaluate (const TiXmlElement *pRoot)
+{
+    if ((!_bValid) || (pRoot == NULL) || (pRoot->Parent() == NULL)) {
+        return false;
+    }
+    reset (pRoot);
+    bool bResult = false;
+    #if !defined (ANDROID) //No support for -fexceptions on ANDROID
+    try {
+    #endif
+        v_execute_stack();
+        if (xs_stack.u_get_size() == 1) {
+            bResult = xs_stack.erp_top()->o_get_bool();
+            e_error = e_no_error;
+        }
+        else {
+            e_error = e_error_stack;
+        }
+    #if !defined (ANDROID)
+    }
+    catch (execution_error) {
+        e_error = e_error_execution;
+    }
+    #endif
+    reset (NULL);
+    return bResult;
+}
+
+void XPathPredicate::Processor::reset (const TiXmlNode *pBase)
+{
+    if (xs_stack.u_get_size() > 0) {
+        xs_stack.v_pop (xs_stack.u_get_size());
+    }
+    XNp_base = pBase;
+    XNp_base_parent = (pBase == NULL ? NULL : pBase->Parent());
+    XEp_context = (pBase == NULL ? NULL : pBase->ToElement());
+    o_is_context_by_name = false;
+    er_result = expression_result (pBase);
+    er_result.v_set_root (pBase);
+    xs_stack.v_set_root (pBase);
+}
+
+//------------------------------------------------------------------------------
+// XPathPredicate
+//------------------------------------------------------------------------------
+
+XPathPredicate::XPathPredicate (const char *pszPredicate)
+    : _pProcessor (new Processor (pszPredicate == NULL ? "" : pszPredicate))
+{
+    if (!_pProcessor->isValid()) {
+        checkAndLogMsg ("XPathPredicate::XPathPredicate", Logger::L_Warning,
+                        "could not decode XPath predicate <%s>\n",
+                        pszPredicate == NULL ? "" : pszPredicate);
+    }
+}
+
+XPathPredicate::~XPathPredicate (void)
+{
+    delete _pProcessor;
+}
+
+bool XPathPredicate::isValid (void) const
+{
+    return _pProcessor->isValid();
+}
+
+bool XPathPredicate::matches (const TiXmlElement *pRoot)
+{
+    _m.lock();
+    const bool bMatch = _pProcessor->evaluate (pRoot);
+    _m.unlock();
+    return bMatch;
+}
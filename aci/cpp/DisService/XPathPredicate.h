@@ -0,0 +1,88 @@
+/*
+ * XPathPredicate.h
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Support classes for GroupPredicateSubscription.
+ *
+ * XPathPredicate decodes an XPath expression once, when the subscription is
+ * created, and then evaluates the decoded expression against any number of
+ * documents.
+ *
+ * XMLMessageDocument wraps a message and parses its data the first time the
+ * document is requested, so that all the predicate subscriptions that have
+ * to be checked against the same message share a single parse.
+ */
+
+#ifndef INCL_XPATH_PREDICATE_H
+#define INCL_XPATH_PREDICATE_H
+
+#include "Mutex.h"
+
+class TiXmlDocument;
+class TiXmlElement;
+
+namespace IHMC_ACI
+{
+    class Message;
+
+    class XMLMessageDocument
+    {
+        public:
+            explicit XMLMessageDocument (const Message *pMessage);
+            ~XMLMessageDocument (void);
+
+            /*
+             * Returns the root element of the message's data, or NULL if the
+             * data is not a well-formed XML document.  The data is parsed the
+             * first time the method is called.
+             */
+            const TiXmlElement * getRootElement (void);
+
+        private:
+            bool _bParsed;
+            const Message *_pMessage;
+            TiXmlDocument *_pDoc;
+    };
+
+    class XPathPredicate
+    {
+        public:
+            explicit XPathPredicate (const char *pszPredicate);
+            ~XPathPredicate (void);
+
+            /*
+             * Returns true if the predicate was successfully decoded.
+             * Invalid predicates never match.
+             */
+            bool isValid (void) const;
+
+            /*
+             * Evaluates the predicate on the root element of the document,
+             * and converts the result to a boolean, as specified by the XPath
+             * boolean() function.
+             */
+            bool matches (const TiXmlElement *pRoot);
+
+        private:
+            class Processor;
+
+            Processor *_pProcessor;
+            NOMADSUtil::Mutex _m;
+    };
+}
+
+#endif  // INCL_XPATH_PREDICATE_H
@@ -128,6 +128,7 @@ LOCAL_SRC_FILES := AckController.cpp \
     NodeId.cpp \
     NMSHelper.cpp \
     NodeInfo.cpp \
+    PayloadSegmentStore.cpp \
     PeerState.cpp \
     PersistentDataCache.cpp \
     PropertyStoreInterface.cpp \
@@ -140,6 +141,7 @@ LOCAL_SRC_FILES := AckController.cpp \
     RequestsState.cpp \
     SessionId.cpp \
     Services.cpp \
+    SharedBuffer.cpp \
     SQLMessageHeaderStorage.cpp \
     SQLMessageStorage.cpp \
     SQLPropertyStore.cpp \
@@ -163,7 +165,8 @@ LOCAL_SRC_FILES := AckController.cpp \
     Utils.cpp \
     WorldState.cpp \
     WorldStateForwardingController.cpp \
-    XLayerWrapper.cpp
+    XLayerWrapper.cpp \
+    XPathPredicate.cpp
 
 # OLD: MessagePropagationServiceInterface.cpp MessagePropagationServiceListener.cpp
 # DisService Proxy sources: DisseminationServiceProxy.cpp DisseminationServiceProxyAdaptor.cpp    
@@ -0,0 +1,167 @@
+/*
+ * PredicateSubscriptionBenchmark.cpp
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Measures the time needed to match M XML messages against N XPath predicate
+ * subscriptions.  The subscriptions are matched against a message sharing a
+ * single parse of the message, as LocalNodeInfo does, and, for comparison,
+ * by parsing the message and decoding the predicate once per subscription,
+ * which is how GroupPredicateSubscription used to match messages.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "NLFLib.h"
+
+#include "Message.h"
+#include "MessageInfo.h"
+#include "Subscription.h"
+#include "XPathPredicate.h"
+
+#include "tinyxml.h"
+#include "xpath_static.h"
+
+using namespace IHMC_ACI;
+
+static const unsigned int MESSAGES = 2000;
+static const unsigned int SENSOR_TYPES = 16;
+
+static std::string generateMessage (unsigned int uiIndex)
+{
+    char szMsg[512];
+    snprintf (szMsg, sizeof (szMsg),
+              "<?xml version=\"1.0\"?>"
+              "<track id=\"%u\">"
+                  "<sensor type=\"type%u\" confidence=\"%u\"/>"
+                  "<position lat=\"%u.5\" lon=\"%u.25\"/>"
+                  "<affiliation>%s</affiliation>"
+                  "<description>track reported by node %u</description>"
+              "</track>",
+              uiIndex, uiIndex % SENSOR_TYPES, uiIndex % 100, 30 + (uiIndex % 20),
+              60 + (uiIndex % 30), ((uiIndex % 3) == 0 ? "hostile" : "friend"), uiIndex % 7);
+    return std::string (szMsg);
+}
+
+static std::string generatePredicate (unsigned int uiIndex)
+{
+    char szPredicate[256];
+    switch (uiIndex % 3) {
+        case 0:
+            snprintf (szPredicate, sizeof (szPredicate), "/track/sensor[@type='type%u']",
+                      uiIndex % SENSOR_TYPES);
+            break;
+        case 1:
+            snprintf (szPredicate, sizeof (szPredicate),
+                      "/track/affiliation = 'hostile' and /track/sensor/@confidence > %u", uiIndex % 100);
+            break;
+        default:
+            snprintf (szPredicate, sizeof (szPredicate),
+                      "/track/position/@lat > %u and contains(/track/description, 'node %u')",
+                      30 + (uiIndex % 20), uiIndex % 7);
+            break;
+    }
+    return std::string (szPredicate);
+}
+
+static unsigned int matchShared (std::vector<Subscription *> &subscriptions, std::vector<Message *> &messages)
+{
+    unsigned int uiMatches = 0;
+    for (unsigned int i = 0; i < messages.size(); i++) {
+        XMLMessageDocument doc (messages[i]);
+        for (unsigned int j = 0; j < subscriptions.size(); j++) {
+            if (subscriptions[j]->matches (messages[i], doc)) {
+                uiMatches++;
+            }
+        }
+    }
+    return uiMatches;
+}
+
+static unsigned int matchPerSubscription (std::vector<std::string> &predicates, std::vector<std::string> &payloads)
+{
+    unsigned int uiMatches = 0;
+    for (unsigned int i = 0; i < payloads.size(); i++) {
+        for (unsigned int j = 0; j < predicates.size(); j++) {
+            TiXmlDocument doc;
+            doc.Parse (payloads[i].c_str());
+            const TiXmlElement *pRoot = doc.RootElement();
+            if ((pRoot != NULL) && TinyXPath::o_xpath_bool (pRoot, predicates[j].c_str())) {
+                uiMatches++;
+            }
+        }
+    }
+    return uiMatches;
+}
+
+int main (int argc, char *argv[])
+{
+    static const unsigned int SUBSCRIPTIONS[] = {1, 10, 50, 100};
+
+    std::vector<std::string> payloads;
+    std::vector<MessageInfo *> msgInfos;
+    std::vector<Message *> messages;
+    for (unsigned int i = 0; i < MESSAGES; i++) {
+        payloads.push_back (generateMessage (i));
+        const uint32 ui32Len = (uint32) payloads[i].length();
+        msgInfos.push_back (new MessageInfo ("bench.xml", "node", i, NULL, NULL, 0, 0, 0, "text/xml",
+                                             NULL, ui32Len, ui32Len, 0));
+        messages.push_back (new Message (msgInfos[i], payloads[i].c_str()));
+    }
+
+    printf ("%14s %10s %20s %24s %10s\n", "Subscriptions", "Messages", "Shared parse (ms)",
+            "Per-subscription (ms)", "Matches");
+    for (unsigned int s = 0; s < sizeof (SUBSCRIPTIONS) / sizeof (unsigned int); s++) {
+        std::vector<std::string> predicates;
+        std::vector<Subscription *> subscriptions;
+        for (unsigned int i = 0; i < SUBSCRIPTIONS[s]; i++) {
+            predicates.push_back (generatePredicate (i));
+            subscriptions.push_back (new GroupPredicateSubscription (predicates[i].c_str()));
+        }
+
+        int64 i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+        const unsigned int uiSharedMatches = matchShared (subscriptions, messages);
+        const int64 i64SharedTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+
+        i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+        const unsigned int uiMatches = matchPerSubscription (predicates, payloads);
+        const int64 i64PerSubscriptionTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+
+        if (uiSharedMatches != uiMatches) {
+            printf ("ERROR: %u matches with the shared parse, %u with the per-subscription parse\n",
+                    uiSharedMatches, uiMatches);
+            return 1;
+        }
+        printf ("%14u %10u %20lld %24lld %10u\n", SUBSCRIPTIONS[s], MESSAGES, (long long) i64SharedTime,
+                (long long) i64PerSubscriptionTime, uiMatches);
+
+        for (unsigned int i = 0; i < subscriptions.size(); i++) {
+            delete subscriptions[i];
+        }
+    }
+
+    for (unsigned int i = 0; i < MESSAGES; i++) {
+        delete messages[i];
+        delete msgInfos[i];
+    }
+
+    return 0;
+}
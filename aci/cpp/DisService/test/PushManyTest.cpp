@@ -0,0 +1,268 @@
+/*
+ * PushManyTest.cpp
+ *
+ * This file is part of the IHMC DisService Library/Component
+ * Copyright (c) 2006-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Pushes, over a shared memory channel, a batch of messages that is larger
+ * than the request ring, and checks that DisseminationServiceProxy::pushMany()
+ * splits it into requests that fit, so that every message is pushed.
+ * The proxy server is played by the test, that accepts the connections of
+ * the proxy and serves the RPC_PUSH_MANY requests.
+ * Returns 0 if successful, a negative number otherwise.
+ */
+
+#include "DisseminationServiceProxy.h"
+
+#include "InetAddr.h"
+#include "PipelinedRpc.h"
+#include "Reader.h"
+#include "ShmRpcChannel.h"
+#include "SimpleCommHelper2.h"
+#include "TCPSocket.h"
+#include "Writer.h"
+
+#include <atomic>
+#include <thread>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace IHMC_ACI;
+using namespace NOMADSUtil;
+
+namespace PUSH_MANY_TEST
+{
+    static const char * const GROUP_NAME = "PushManyTest";
+    static const unsigned int MESSAGES = 24;
+    // The batch takes about 24MB, while the request ring takes 16MB and
+    // each request at most half of it
+    static const uint32 MESSAGE_LEN = 1024U * 1024U;
+
+    struct Server
+    {
+        Server (void)
+            : pCommHelper (NULL), pCallbackCommHelper (NULL), pRpcServer (NULL),
+              uiRequests (0U), uiMessages (0U), bCorruptData (false) {}
+
+        SimpleCommHelper2 *pCommHelper;
+        SimpleCommHelper2 *pCallbackCommHelper;
+        PipelinedRpcServer *pRpcServer;
+        std::atomic<unsigned int> uiRequests;
+        std::atomic<unsigned int> uiMessages;
+        std::atomic<bool> bCorruptData;
+    };
+
+    SimpleCommHelper2 * acceptCommHelper (TCPSocket *pServerSocket)
+    {
+        TCPSocket *pSocket = static_cast<TCPSocket *> (pServerSocket->accept());
+        if (pSocket == NULL) {
+            return NULL;
+        }
+        pSocket->bufferingMode (false);
+        SimpleCommHelper2 *pch = new SimpleCommHelper2();
+        if (pch->init (pSocket) != 0) {
+            delete pch;
+            delete pSocket;
+            return NULL;
+        }
+        pch->setDeleteUnderlyingSocket (true);
+        return pch;
+    }
+
+    // Replies to each message with its object id, after checking its data
+    int pushManyInvoked (void *pSvc, uint16 ui16Method, Reader *pRequest, Writer *pResponse)
+    {
+        Server *pServer = static_cast<Server *> (pSvc);
+        char *pszGroupName = NULL;
+        uint32 ui32Count = 0U;
+        if ((ui16Method != DisseminationServiceProxy::RPC_PUSH_MANY) ||
+            (pRequest->readString (&pszGroupName) < 0) || (pRequest->read32 (&ui32Count) < 0) ||
+            (pResponse->write32 (&ui32Count) < 0)) {
+            free (pszGroupName);
+            return -1;
+        }
+        free (pszGroupName);
+        pServer->uiRequests++;
+        for (uint32 i = 0; i < ui32Count; i++) {
+            char *pszObjectId = NULL;
+            char *pszInstanceId = NULL;
+            char *pszMimeType = NULL;
+            uint32 ui32MetadataLength = 0U;
+            uint32 ui32Length = 0U;
+            int64 i64ExpirationTime = 0;
+            uint16 ui16HistoryWindow = 0U;
+            uint16 ui16Tag = 0U;
+            uint8 ui8Priority = 0U;
+            const void *pData = NULL;
+            int rc = 0;
+            if ((pRequest->readString (&pszObjectId) < 0) || (pRequest->readString (&pszInstanceId) < 0) ||
+                (pRequest->readString (&pszMimeType) < 0) || (pRequest->read32 (&ui32MetadataLength) < 0) ||
+                (ui32MetadataLength != 0U) || (pRequest->read32 (&ui32Length) < 0) ||
+                (NULL == (pData = PipelinedRpc::readInPlace (pRequest, ui32Length))) ||
+                (pRequest->read64 (&i64ExpirationTime) < 0) || (pRequest->read16 (&ui16HistoryWindow) < 0) ||
+                (pRequest->read16 (&ui16Tag) < 0) || (pRequest->read8 (&ui8Priority) < 0)) {
+                rc = -2;
+            }
+            else {
+                // The data of each message is filled with its tag
+                const uint8 *pui8Data = static_cast<const uint8 *> (pData);
+                if ((ui32Length != MESSAGE_LEN) || (pui8Data[0] != (uint8) ui16Tag) ||
+                    (pui8Data[ui32Length - 1] != (uint8) ui16Tag)) {
+                    pServer->bCorruptData = true;
+                }
+                int32 i32Rc = 0;
+                if ((pResponse->write32 (&i32Rc) < 0) || (pResponse->writeString (pszObjectId) < 0)) {
+                    rc = -3;
+                }
+                pServer->uiMessages++;
+            }
+            free (pszObjectId);
+            free (pszInstanceId);
+            free (pszMimeType);
+            if (rc < 0) {
+                return rc;
+            }
+        }
+        return 0;
+    }
+
+    // Registers the proxy, its callback connection, and its shared memory
+    // channel, in the order in which DisseminationServiceProxy::tryConnect()
+    // opens them
+    void acceptProxy (TCPSocket *pServerSocket, Server *pServer)
+    {
+        pServer->pCommHelper = acceptCommHelper (pServerSocket);
+        pServer->pCallbackCommHelper = acceptCommHelper (pServerSocket);
+        if ((pServer->pCommHelper == NULL) || (pServer->pCallbackCommHelper == NULL)) {
+            return;
+        }
+        SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+        pServer->pCommHelper->receiveLine (error);
+        if (error == SimpleCommHelper2::None) {
+            pServer->pCommHelper->sendLine (error, "OK 1");
+        }
+        if (error == SimpleCommHelper2::None) {
+            pServer->pCallbackCommHelper->receiveLine (error);
+        }
+        if (error == SimpleCommHelper2::None) {
+            pServer->pCallbackCommHelper->sendLine (error, "OK");
+        }
+        if (error != SimpleCommHelper2::None) {
+            return;
+        }
+
+        SimpleCommHelper2 *pRpcCommHelper = acceptCommHelper (pServerSocket);
+        if (pRpcCommHelper == NULL) {
+            return;
+        }
+        ShmRpcChannel *pChannel = NULL;
+        const char **ppszBuf = pRpcCommHelper->receiveParsedSpecific ("1 1", error);
+        if ((error == SimpleCommHelper2::None) && (0 == strcmp (ppszBuf[0], ShmRpcChannel::REGISTER_PROXY_SHM.c_str()))) {
+            pChannel = ShmRpcChannel::accept (pRpcCommHelper);
+        }
+        if (pChannel == NULL) {
+            delete pRpcCommHelper;
+            return;
+        }
+        pRpcCommHelper->sendLine (error, "OK");
+        pServer->pRpcServer = new PipelinedRpcServer (pChannel, &pushManyInvoked, pServer);
+        pServer->pRpcServer->start();
+    }
+
+    void closeServer (Server *pServer)
+    {
+        if (pServer->pRpcServer != NULL) {
+            pServer->pRpcServer->requestTerminationAndWait();
+            delete pServer->pRpcServer;
+        }
+        delete pServer->pCallbackCommHelper;
+        delete pServer->pCommHelper;
+    }
+}
+
+using namespace PUSH_MANY_TEST;
+
+int main (int argc, char *argv[])
+{
+    TCPSocket serverSocket;
+    if (serverSocket.setupToReceive (0, 3, InetAddr ("127.0.0.1").getIPAddress()) != 0) {
+        printf ("could not set up the server socket\n");
+        return -1;
+    }
+    Server server;
+    std::thread acceptor (acceptProxy, &serverSocket, &server);
+    DisseminationServiceProxy *pProxy = new DisseminationServiceProxy (1);
+    const int rcInit = pProxy->init ("127.0.0.1", serverSocket.getLocalPort(), false, true, true);
+    acceptor.join();
+    if ((rcInit != 0) || (server.pRpcServer == NULL)) {
+        printf ("could not connect the proxy over a shared memory channel; rc = %d\n", rcInit);
+        closeServer (&server);
+        delete pProxy;
+        return -2;
+    }
+
+    char *pData = (char *) malloc (MESSAGES * MESSAGE_LEN);
+    if (pData == NULL) {
+        printf ("could not allocate the data\n");
+        return -3;
+    }
+    char objectIds[MESSAGES][32];
+    DisseminationServiceProxy::PushMessage messages[MESSAGES];
+    for (unsigned int i = 0; i < MESSAGES; i++) {
+        snprintf (objectIds[i], sizeof (objectIds[i]), "object-%u", i);
+        memset (pData + i * MESSAGE_LEN, (int) i, MESSAGE_LEN);
+        DisseminationServiceProxy::PushMessage &msg = messages[i];
+        memset (&msg, 0, sizeof (msg));
+        msg.pszObjectId = objectIds[i];
+        msg.pszInstanceId = "1";
+        msg.pszMimeType = "application/octet-stream";
+        msg.pData = pData + i * MESSAGE_LEN;
+        msg.ui32Length = MESSAGE_LEN;
+        msg.ui16Tag = (uint16) i;
+    }
+
+    int rc = pProxy->pushMany (GROUP_NAME, messages, MESSAGES);
+    printf ("pushMany of %u messages of %u bytes returned %d after %u requests\n",
+            MESSAGES, (unsigned int) MESSAGE_LEN, rc, (unsigned int) server.uiRequests);
+    if (rc != 0) {
+        rc = -4;
+    }
+    else if ((server.uiMessages != MESSAGES) || server.bCorruptData) {
+        printf ("the server received %u messages, %s\n", (unsigned int) server.uiMessages,
+                (server.bCorruptData ? "some of which corrupt" : "none of which corrupt"));
+        rc = -5;
+    }
+    else if (server.uiRequests < 2) {
+        printf ("the batch was not split\n");
+        rc = -6;
+    }
+    for (unsigned int i = 0; i < MESSAGES; i++) {
+        if ((messages[i].rc != 0) || (messages[i].pszId == NULL) || (0 != strcmp (messages[i].pszId, objectIds[i]))) {
+            printf ("message %u was not pushed; rc = %d\n", i, messages[i].rc);
+            rc = -7;
+        }
+        free (messages[i].pszId);
+    }
+
+    closeServer (&server);
+    delete pProxy;
+    free (pData);
+    if (rc == 0) {
+        printf ("PushManyTest passed\n");
+    }
+    return rc;
+}
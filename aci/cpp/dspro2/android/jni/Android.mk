@@ -149,6 +149,7 @@ awareness/NodeContextManager.cpp \
 awareness/NonClassifyingLocalNodeContext.cpp \
 awareness/PeerNodeContext.cpp \
 awareness/PositionUpdater.cpp \
+awareness/RoutingTable.cpp \
 awareness/Targets.cpp \
 awareness/Topology.cpp \
 awareness/Versions.cpp \
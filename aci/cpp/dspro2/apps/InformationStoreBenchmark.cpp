@@ -0,0 +1,180 @@
+/*
+ * InformationStoreBenchmark.cpp
+ *
+ * This file is part of the IHMC DSPro Library/Component
+ * Copyright (c) 2008-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Measures the latency of InformationStore::getAllMetadataInArea() as the
+ * number of stored metadata grows.  Metadata with small bounding-boxes are
+ * scattered over a square region (a fraction of them without bounding-box),
+ * and after each batch of insertions a set of random areas is queried.
+ */
+
+#include "InformationStore.h"
+#include "MetaData.h"
+#include "MetadataConfigurationImpl.h"
+
+#include "GeoUtils.h"
+#include "Logger.h"
+#include "NLFLib.h"
+#include "StrClass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace IHMC_ACI;
+using namespace IHMC_VOI;
+using namespace NOMADSUtil;
+
+namespace BENCHMARK
+{
+    // Region in which the metadata are scattered
+    static const float REGION_MIN_LAT = 40.0f;
+    static const float REGION_MIN_LONG = -90.0f;
+    static const float REGION_SIZE = 2.0f;
+
+    // Side of the bounding-boxes of the metadata, and of the queried areas
+    static const float METADATA_SIZE = 0.01f;
+    static const float AREA_SIZE = 0.05f;
+
+    // One metadata every NO_BOUNDING_BOX_RATIO does not have a bounding-box
+    static const unsigned int NO_BOUNDING_BOX_RATIO = 50;
+
+    struct Options
+    {
+        Options (void);
+
+        uint32 ui32MaxMetadata;
+        uint32 ui32Queries;
+    };
+
+    Options::Options (void)
+        : ui32MaxMetadata (100000), ui32Queries (200)
+    {
+    }
+
+    float randomCoordinate (float fMin, float fSize)
+    {
+        return fMin + (fSize * (float) rand() / (float) RAND_MAX);
+    }
+
+    void setCoordinate (MetaData &metadata, const char *pszFieldName, float fValue)
+    {
+        char szValue[32];
+        snprintf (szValue, sizeof (szValue), "%f", fValue);
+        metadata.setFieldValue (pszFieldName, szValue);
+    }
+
+    int insertMetadata (InformationStore &infoStore, uint32 ui32Index)
+    {
+        char szId[64];
+        snprintf (szId, sizeof (szId), "bench.group:node:%u", (unsigned int) ui32Index);
+        MetaData metadata;
+        metadata.setFieldValue (MetadataInterface::MESSAGE_ID, szId);
+        metadata.setFieldValue (MetadataInterface::REFERS_TO, szId);
+        if ((ui32Index % NO_BOUNDING_BOX_RATIO) != 0) {
+            const float fLat = randomCoordinate (REGION_MIN_LAT, REGION_SIZE - METADATA_SIZE);
+            const float fLong = randomCoordinate (REGION_MIN_LONG, REGION_SIZE - METADATA_SIZE);
+            setCoordinate (metadata, MetadataInterface::LEFT_UPPER_LATITUDE, fLat + METADATA_SIZE);
+            setCoordinate (metadata, MetadataInterface::RIGHT_LOWER_LATITUDE, fLat);
+            setCoordinate (metadata, MetadataInterface::LEFT_UPPER_LONGITUDE, fLong);
+            setCoordinate (metadata, MetadataInterface::RIGHT_LOWER_LONGITUDE, fLong + METADATA_SIZE);
+        }
+        return infoStore.insert (&metadata);
+    }
+
+    // Runs the queries and returns the average number of metadata returned
+    double queryAreas (InformationStore &infoStore, uint32 ui32Queries)
+    {
+        uint64 ui64Matches = 0U;
+        for (uint32 i = 0; i < ui32Queries; i++) {
+            const float fLat = randomCoordinate (REGION_MIN_LAT, REGION_SIZE - AREA_SIZE);
+            const float fLong = randomCoordinate (REGION_MIN_LONG, REGION_SIZE - AREA_SIZE);
+            const BoundingBox area (fLat + AREA_SIZE, fLong, fLat, fLong + AREA_SIZE);
+            MetadataList *pMetadataList = infoStore.getAllMetadataInArea (nullptr, nullptr, area, false);
+            if (pMetadataList != nullptr) {
+                MetadataInterface *pNext = pMetadataList->getFirst();
+                for (MetadataInterface *pCurr; (pCurr = pNext) != nullptr;) {
+                    pNext = pMetadataList->getNext();
+                    delete pMetadataList->remove (pCurr);
+                    ui64Matches++;
+                }
+                delete pMetadataList;
+            }
+        }
+        return (double) ui64Matches / ui32Queries;
+    }
+
+    void printUsageAndExit (const char *pszProgName)
+    {
+        fprintf (stderr, "Usage: %s [-n <max number of metadata>] [-q <queries per dataset size>]\n", pszProgName);
+        exit (-1);
+    }
+}
+
+using namespace BENCHMARK;
+
+int main (int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        if ((i + 1) >= argc) {
+            printUsageAndExit (argv[0]);
+        }
+        const uint32 ui32Value = atoui32 (argv[++i]);
+        if (0 == strcmp (argv[i-1], "-n")) {
+            opts.ui32MaxMetadata = ui32Value;
+        }
+        else if (0 == strcmp (argv[i-1], "-q")) {
+            opts.ui32Queries = ui32Value;
+        }
+        else {
+            printUsageAndExit (argv[0]);
+        }
+    }
+    if ((opts.ui32MaxMetadata == 0) || (opts.ui32Queries == 0)) {
+        printUsageAndExit (argv[0]);
+    }
+
+    srand (1);
+    MetadataConfigurationImpl *pMetadataConf = MetadataConfigurationImpl::getConfiguration();
+    InformationStore infoStore (nullptr, "bench.group");
+    if ((pMetadataConf == nullptr) || (infoStore.init (pMetadataConf) != 0)) {
+        fprintf (stderr, "failed to initialize the InformationStore\n");
+        return -2;
+    }
+
+    printf ("%12s %16s %16s\n", "metadata", "matches/query", "ms/query");
+    uint32 ui32Stored = 0;
+    for (uint32 ui32DatasetSize = 1000; ui32Stored < opts.ui32MaxMetadata; ui32DatasetSize *= 2) {
+        if (ui32DatasetSize > opts.ui32MaxMetadata) {
+            ui32DatasetSize = opts.ui32MaxMetadata;
+        }
+        for (; ui32Stored < ui32DatasetSize; ui32Stored++) {
+            if (insertMetadata (infoStore, ui32Stored) != 0) {
+                fprintf (stderr, "failed to insert metadata %u\n", (unsigned int) ui32Stored);
+                return -3;
+            }
+        }
+        const int64 i64Start = getTimeInMilliseconds();
+        const double dMatches = queryAreas (infoStore, opts.ui32Queries);
+        const int64 i64ElapsedTime = getTimeInMilliseconds() - i64Start;
+        printf ("%12u %16.1f %16.3f\n", (unsigned int) ui32Stored, dMatches,
+                (double) i64ElapsedTime / opts.ui32Queries);
+    }
+
+    return 0;
+}
@@ -0,0 +1,602 @@
+/*
+ * ProxyRpcBenchmark.cpp
+ *
+ * This file is part of the IHMC DSPro Library/Component
+ * Copyright (c) 2008-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Measures the number of addMessage calls per second that a proxy can make
+ * on a loopback connection with:
+ * - the text protocol: each call sends a command line followed by its
+ *   arguments, and waits for the "OK" line and for the message id;
+ * - the pipelined RPC connection, one call at a time;
+ * - the pipelined RPC connection, with a window of calls in flight;
+ * - the pipelined RPC connection, with the messages batched in RPC_ADD_MESSAGES
+ *   requests;
+ * - the same three modes, with the frames exchanged through shared memory
+ *   (ShmRpcChannel) instead of the loopback connection, on Linux.
+ * The servers only parse the requests and reply with a message id, therefore
+ * the results measure the cost of the protocols, not the one of DSPro.
+ */
+
+#include "DSProProxyUnmarshaller.h"
+
+#include "BufferReader.h"
+#include "InetAddr.h"
+#include "ManageableThread.h"
+#include "NLFLib.h"
+#include "PipelinedRpc.h"
+#include "ShmRpcChannel.h"
+#include "SimpleCommHelper2.h"
+#include "TCPSocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+using namespace IHMC_ACI;
+using namespace NOMADSUtil;
+
+namespace BENCHMARK
+{
+    static const char *GROUP_NAME = "benchmark";
+    static const char *JSON_METADATA = "{\"Data_Format\":\"application/octet-stream\",\"Left_Upper_Latitude\":1.0}";
+
+    struct Options
+    {
+        Options (void);
+
+        uint32 ui32Calls;
+        uint32 ui32DataLen;
+        uint32 ui32Window;      // calls in flight in the pipelined run
+        uint32 ui32Batch;       // messages per RPC_ADD_MESSAGES request
+        uint16 ui16Port;
+    };
+
+    Options::Options (void)
+        : ui32Calls (20000), ui32DataLen (256), ui32Window (64), ui32Batch (32), ui16Port (56799)
+    {
+    }
+
+    double elapsedSeconds (std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+    }
+
+    int makeMessageId (uint32 ui32SeqId, char *pszBuf, size_t len)
+    {
+        return snprintf (pszBuf, len, "benchmark-node.%s.%u", GROUP_NAME, (unsigned int) ui32SeqId);
+    }
+
+    SimpleCommHelper2 * newCommHelper (TCPSocket *pSocket)
+    {
+        pSocket->bufferingMode (false);
+        SimpleCommHelper2 *pch = new SimpleCommHelper2();
+        if (pch->init (pSocket) != 0) {
+            delete pch;
+            delete pSocket;
+            return nullptr;
+        }
+        pch->setDeleteUnderlyingSocket (true);
+        return pch;
+    }
+
+    // Returns the client side of a new loopback connection, and sets ppServer
+    // to the server side
+    SimpleCommHelper2 * connect (TCPSocket &serverSocket, uint16 ui16Port, SimpleCommHelper2 **ppServer)
+    {
+        TCPSocket *pClientSocket = new TCPSocket();
+        if (pClientSocket->connect ("127.0.0.1", ui16Port) != 0) {
+            delete pClientSocket;
+            return nullptr;
+        }
+        TCPSocket *pServerSocket = static_cast<TCPSocket *>(serverSocket.accept());
+        if (pServerSocket == nullptr) {
+            delete pClientSocket;
+            return nullptr;
+        }
+        *ppServer = newCommHelper (pServerSocket);
+        SimpleCommHelper2 *pClient = newCommHelper (pClientSocket);
+        if ((*ppServer == nullptr) || (pClient == nullptr)) {
+            delete *ppServer;
+            delete pClient;
+            return nullptr;
+        }
+        return pClient;
+    }
+
+    //-------------------------------------------------------------------------
+    // Text protocol
+    //-------------------------------------------------------------------------
+
+    // Serves addMessage commands as the proxy server does
+    class TextServer : public ManageableThread
+    {
+        public:
+            TextServer (SimpleCommHelper2 *pCommHelper, uint32 ui32MaxDataLen);
+            ~TextServer (void);
+
+            void run (void);
+
+        private:
+            SimpleCommHelper2 *_pCommHelper;
+            std::vector<char> _buf;
+    };
+
+    TextServer::TextServer (SimpleCommHelper2 *pCommHelper, uint32 ui32MaxDataLen)
+        : _pCommHelper (pCommHelper), _buf (ui32MaxDataLen + 1024U)
+    {
+    }
+
+    TextServer::~TextServer (void)
+    {
+        delete _pCommHelper;
+    }
+
+    void TextServer::run (void)
+    {
+        started();
+        SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+        for (uint32 ui32SeqId = 1; !terminationRequested(); ui32SeqId++) {
+            _pCommHelper->receiveMatch (error, "addMessage");
+            for (unsigned int i = 0; (i < 5) && (error == SimpleCommHelper2::None); i++) {
+                // group, object id, instance id, metadata and data
+                _pCommHelper->receiveBlock (&_buf[0], (uint32) _buf.size(), error);
+            }
+            int64 i64ExpirationTime = 0;
+            if ((error != SimpleCommHelper2::None) || (_pCommHelper->getReaderRef()->read64 (&i64ExpirationTime) < 0)) {
+                break;
+            }
+            char szId[64];
+            makeMessageId (ui32SeqId, szId, sizeof (szId));
+            _pCommHelper->sendLine (error, "OK");
+            if (error == SimpleCommHelper2::None) {
+                _pCommHelper->sendLine (error, szId);
+            }
+            if (error != SimpleCommHelper2::None) {
+                break;
+            }
+        }
+        terminating();
+    }
+
+    int textAddMessage (SimpleCommHelper2 *pCommHelper, const void *pData, uint32 ui32DataLen)
+    {
+        SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+        pCommHelper->sendLine (error, "addMessage");
+        if (error == SimpleCommHelper2::None) {
+            pCommHelper->sendStringBlock (GROUP_NAME, error);
+        }
+        if (error == SimpleCommHelper2::None) {
+            pCommHelper->sendStringBlock ("object", error);
+        }
+        if (error == SimpleCommHelper2::None) {
+            pCommHelper->sendStringBlock ("instance", error);
+        }
+        if (error == SimpleCommHelper2::None) {
+            pCommHelper->sendStringBlock (JSON_METADATA, error);
+        }
+        if (error == SimpleCommHelper2::None) {
+            pCommHelper->sendBlock (pData, ui32DataLen, error);
+        }
+        int64 i64ExpirationTime = 0;
+        if ((error != SimpleCommHelper2::None) || (pCommHelper->getWriterRef()->write64 (&i64ExpirationTime) < 0)) {
+            return -1;
+        }
+        pCommHelper->receiveMatch (error, "OK");
+        if (error == SimpleCommHelper2::None) {
+            pCommHelper->receiveLine (error);
+        }
+        return (error == SimpleCommHelper2::None ? 0 : -2);
+    }
+
+    //-------------------------------------------------------------------------
+    // Pipelined RPC
+    //-------------------------------------------------------------------------
+
+    int readMessage (Reader *pReader)
+    {
+        for (unsigned int i = 0; i < 3; i++) {
+            // object id, instance id and metadata
+            char *pszField = nullptr;
+            if (pReader->readString (&pszField) < 0) {
+                return -1;
+            }
+            free (pszField);
+        }
+        uint32 ui32DataLen = 0;
+        if ((pReader->read32 (&ui32DataLen) < 0) || (ui32DataLen > PipelinedRpc::MAX_PAYLOAD_LEN)) {
+            return -2;
+        }
+        int64 i64ExpirationTime = 0;
+        if (((ui32DataLen > 0) && (PipelinedRpc::readInPlace (pReader, ui32DataLen) == nullptr)) ||
+            (pReader->read64 (&i64ExpirationTime) < 0)) {
+            return -3;
+        }
+        return 0;
+    }
+
+    // Parses the requests as DSProProxyUnmarshaller::rpcMethodInvoked() does,
+    // without adding the messages to DSPro
+    int rpcMethodInvoked (void *pSeqId, uint16 ui16Method, Reader *pRequest, Writer *pResponse)
+    {
+        uint32 &ui32SeqId = *static_cast<uint32 *>(pSeqId);
+        char *pszGroupName = nullptr;
+        if ((pRequest->readString (&pszGroupName) < 0) || (pszGroupName == nullptr)) {
+            return -1;
+        }
+        free (pszGroupName);
+        char szId[64];
+        switch (ui16Method) {
+            case DSProProxyUnmarshaller::RPC_ADD_MESSAGE:
+                if (readMessage (pRequest) < 0) {
+                    return -2;
+                }
+                makeMessageId (++ui32SeqId, szId, sizeof (szId));
+                return pResponse->writeString (szId);
+
+            case DSProProxyUnmarshaller::RPC_ADD_MESSAGES:
+            {
+                uint32 ui32Count = 0;
+                if ((pRequest->read32 (&ui32Count) < 0) || (pResponse->write32 (&ui32Count) < 0)) {
+                    return -2;
+                }
+                for (uint32 i = 0; i < ui32Count; i++) {
+                    int32 i32Rc = 0;
+                    if (readMessage (pRequest) < 0) {
+                        return -2;
+                    }
+                    makeMessageId (++ui32SeqId, szId, sizeof (szId));
+                    if ((pResponse->write32 (&i32Rc) < 0) || (pResponse->writeString (szId) < 0)) {
+                        return -3;
+                    }
+                }
+                return 0;
+            }
+
+            default:
+                return -1;
+        }
+    }
+
+    // The messages are marshalled directly into the frames, as DSProProxy does
+    struct AddMessagesArgs
+    {
+        const void *pData;
+        uint32 ui32DataLen;
+        uint32 ui32Count;
+    };
+
+    int marshalAddMessage (const void *pArg, Writer *pWriter)
+    {
+        const AddMessagesArgs *pArgs = static_cast<const AddMessagesArgs *> (pArg);
+        if (pWriter->writeString (GROUP_NAME) < 0) {
+            return -1;
+        }
+        return DSProProxyUnmarshaller::writeMessage (pWriter, "object", "instance", JSON_METADATA,
+                                                     pArgs->pData, pArgs->ui32DataLen, 0);
+    }
+
+    int marshalAddMessages (const void *pArg, Writer *pWriter)
+    {
+        const AddMessagesArgs *pArgs = static_cast<const AddMessagesArgs *> (pArg);
+        uint32 ui32Count = pArgs->ui32Count;
+        if ((pWriter->writeString (GROUP_NAME) < 0) || (pWriter->write32 (&ui32Count) < 0)) {
+            return -1;
+        }
+        for (uint32 i = 0; i < ui32Count; i++) {
+            if (DSProProxyUnmarshaller::writeMessage (pWriter, "object", "instance", JSON_METADATA,
+                                                      pArgs->pData, pArgs->ui32DataLen, 0) < 0) {
+                return -2;
+            }
+        }
+        return 0;
+    }
+
+    int readMessageId (BufferReader *pResponse)
+    {
+        char *pszId = nullptr;
+        const int rc = ((pResponse->readString (&pszId) < 0) || (pszId == nullptr) ? -1 : 0);
+        free (pszId);
+        delete pResponse;
+        return rc;
+    }
+
+    int rpcAddMessage (PipelinedRpcClient *pClient, const void *pData, uint32 ui32DataLen)
+    {
+        const AddMessagesArgs args = { pData, ui32DataLen, 1U };
+        BufferReader *pResponse = nullptr;
+        if (pClient->call (DSProProxyUnmarshaller::RPC_ADD_MESSAGE, &marshalAddMessage, &args, &pResponse) < 0) {
+            return -1;
+        }
+        return readMessageId (pResponse);
+    }
+
+    int rpcAddMessagesPipelined (PipelinedRpcClient *pClient, const void *pData, uint32 ui32DataLen,
+                                 uint32 ui32Calls, uint32 ui32Window)
+    {
+        const AddMessagesArgs args = { pData, ui32DataLen, 1U };
+        std::deque<uint32> inFlight;
+        for (uint32 i = 0; (i < ui32Calls) || !inFlight.empty();) {
+            if ((i < ui32Calls) && (inFlight.size() < ui32Window)) {
+                const uint32 ui32RequestId = pClient->send (DSProProxyUnmarshaller::RPC_ADD_MESSAGE, &marshalAddMessage, &args);
+                if (ui32RequestId == 0) {
+                    return -1;
+                }
+                inFlight.push_back (ui32RequestId);
+                i++;
+                continue;
+            }
+            BufferReader *pResponse = nullptr;
+            if ((pClient->wait (inFlight.front(), &pResponse) < 0) || (readMessageId (pResponse) < 0)) {
+                return -2;
+            }
+            inFlight.pop_front();
+        }
+        return 0;
+    }
+
+    int rpcAddMessagesBatched (PipelinedRpcClient *pClient, const void *pData, uint32 ui32DataLen,
+                               uint32 ui32Calls, uint32 ui32Batch)
+    {
+        for (uint32 i = 0; i < ui32Calls; i += ui32Batch) {
+            const AddMessagesArgs args = { pData, ui32DataLen, minimum (ui32Batch, ui32Calls - i) };
+            BufferReader *pResponse = nullptr;
+            if (pClient->call (DSProProxyUnmarshaller::RPC_ADD_MESSAGES, &marshalAddMessages, &args, &pResponse) < 0) {
+                return -2;
+            }
+            uint32 ui32Replies = 0;
+            int rc = ((pResponse->read32 (&ui32Replies) < 0) || (ui32Replies != args.ui32Count) ? -3 : 0);
+            for (uint32 j = 0; (j < ui32Replies) && (rc == 0); j++) {
+                int32 i32Rc = 0;
+                char *pszId = nullptr;
+                if ((pResponse->read32 (&i32Rc) < 0) || (pResponse->readString (&pszId) < 0) || (i32Rc != 0)) {
+                    rc = -3;
+                }
+                free (pszId);
+            }
+            delete pResponse;
+            if (rc < 0) {
+                return rc;
+            }
+        }
+        return 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // Shared memory
+    //-------------------------------------------------------------------------
+
+    // Server side of the negotiation, that runs while the client offers the
+    // channel
+    class ShmAcceptor : public ManageableThread
+    {
+        public:
+            explicit ShmAcceptor (SimpleCommHelper2 *pCommHelper);
+
+            void run (void);
+
+            ShmRpcChannel *_pChannel;
+
+        private:
+            SimpleCommHelper2 *_pCommHelper;
+    };
+
+    ShmAcceptor::ShmAcceptor (SimpleCommHelper2 *pCommHelper)
+        : _pChannel (nullptr), _pCommHelper (pCommHelper)
+    {
+    }
+
+    void ShmAcceptor::run (void)
+    {
+        started();
+        SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+        const char **ppszBuf = _pCommHelper->receiveParsedSpecific ("1 1", error);
+        if ((error == SimpleCommHelper2::None) && (0 == strcmp (ppszBuf[0], ShmRpcChannel::REGISTER_PROXY_SHM.c_str()))) {
+            _pChannel = ShmRpcChannel::accept (_pCommHelper);
+        }
+        if (_pChannel != nullptr) {
+            _pCommHelper->sendLine (error, "OK");
+        }
+        else {
+            delete _pCommHelper;
+        }
+        terminating();
+    }
+
+    void printResult (const char *pszMode, uint32 ui32Calls, double dSeconds, double dBaselineRate)
+    {
+        const double dRate = ui32Calls / (dSeconds > 0.0 ? dSeconds : 1e-9);
+        printf ("%-24s | %8u | %9.3f | %10.0f | %7.1fx\n", pszMode, (unsigned int) ui32Calls, dSeconds, dRate,
+                (dBaselineRate > 0.0 ? dRate / dBaselineRate : 1.0));
+    }
+
+    // Runs the three RPC modes on pClient
+    int runRpc (const char *pszTransport, PipelinedRpcClient *pClient, const std::vector<char> &data,
+                const Options &opts, double dTextRate)
+    {
+        char szMode[32];
+        int rc = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32 i = 0; (i < opts.ui32Calls) && (rc == 0); i++) {
+            rc = rpcAddMessage (pClient, &data[0], opts.ui32DataLen);
+        }
+        double dSeconds = elapsedSeconds (start);
+        if (rc == 0) {
+            snprintf (szMode, sizeof (szMode), "%s, one at a time", pszTransport);
+            printResult (szMode, opts.ui32Calls, dSeconds, dTextRate);
+
+            start = std::chrono::steady_clock::now();
+            rc = rpcAddMessagesPipelined (pClient, &data[0], opts.ui32DataLen, opts.ui32Calls, opts.ui32Window);
+            dSeconds = elapsedSeconds (start);
+        }
+        if (rc == 0) {
+            snprintf (szMode, sizeof (szMode), "%s, pipelined", pszTransport);
+            printResult (szMode, opts.ui32Calls, dSeconds, dTextRate);
+
+            start = std::chrono::steady_clock::now();
+            rc = rpcAddMessagesBatched (pClient, &data[0], opts.ui32DataLen, opts.ui32Calls, opts.ui32Batch);
+            dSeconds = elapsedSeconds (start);
+        }
+        if (rc == 0) {
+            snprintf (szMode, sizeof (szMode), "%s, batched", pszTransport);
+            printResult (szMode, opts.ui32Calls, dSeconds, dTextRate);
+        }
+        return rc;
+    }
+}
+
+using namespace BENCHMARK;
+
+void printUsageAndExit (const char *pszProgName)
+{
+    fprintf (stderr, "usage: %s [-c <calls>] [-l <data length>] [-w <window>] [-b <batch>] [-p <port>]\n", pszProgName);
+    exit (-1);
+}
+
+int main (int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        if ((i + 1) >= argc) {
+            printUsageAndExit (argv[0]);
+        }
+        const char *pszValue = argv[++i];
+        if (0 == strcmp (argv[i-1], "-c")) {
+            opts.ui32Calls = atoui32 (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-l")) {
+            opts.ui32DataLen = atoui32 (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-w")) {
+            opts.ui32Window = atoui32 (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-b")) {
+            opts.ui32Batch = atoui32 (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-p")) {
+            opts.ui16Port = (uint16) atoui32 (pszValue);
+        }
+        else {
+            printUsageAndExit (argv[0]);
+        }
+    }
+    if ((opts.ui32Calls == 0) || (opts.ui32DataLen == 0) || (opts.ui32Window == 0) || (opts.ui32Batch == 0) ||
+        (opts.ui16Port == 0)) {
+        printUsageAndExit (argv[0]);
+    }
+
+    TCPSocket serverSocket;
+    if (serverSocket.setupToReceive (opts.ui16Port, 5, InetAddr ("127.0.0.1").getIPAddress()) != 0) {
+        fprintf (stderr, "could not listen on port %u\n", (unsigned int) opts.ui16Port);
+        return -1;
+    }
+    std::vector<char> data (opts.ui32DataLen, 'x');
+
+    // Text protocol
+    SimpleCommHelper2 *pTextServerCommHelper = nullptr;
+    SimpleCommHelper2 *pTextClient = connect (serverSocket, opts.ui16Port, &pTextServerCommHelper);
+    if (pTextClient == nullptr) {
+        fprintf (stderr, "could not open the text connection\n");
+        return -2;
+    }
+    TextServer *pTextServer = new TextServer (pTextServerCommHelper, opts.ui32DataLen);
+    pTextServer->start();
+
+    // Pipelined RPC
+    uint32 ui32SeqId = 0;
+    SimpleCommHelper2 *pRpcServerCommHelper = nullptr;
+    SimpleCommHelper2 *pRpcClientCommHelper = connect (serverSocket, opts.ui16Port, &pRpcServerCommHelper);
+    if (pRpcClientCommHelper == nullptr) {
+        fprintf (stderr, "could not open the RPC connection\n");
+        return -2;
+    }
+    PipelinedRpcServer *pRpcServer = new PipelinedRpcServer (pRpcServerCommHelper, &rpcMethodInvoked, &ui32SeqId);
+    pRpcServer->start();
+    PipelinedRpcClient *pRpcClient = new PipelinedRpcClient (pRpcClientCommHelper);
+    pRpcClient->start();
+
+    // Shared memory, if available
+    uint32 ui32ShmSeqId = 0;
+    PipelinedRpcServer *pShmServer = nullptr;
+    PipelinedRpcClient *pShmClient = nullptr;
+    SimpleCommHelper2 *pShmServerCommHelper = nullptr;
+    SimpleCommHelper2 *pShmClientCommHelper = connect (serverSocket, opts.ui16Port, &pShmServerCommHelper);
+    if (pShmClientCommHelper != nullptr) {
+        ShmAcceptor acceptor (pShmServerCommHelper);
+        acceptor.start();
+        ShmRpcChannel *pShmClientChannel = ShmRpcChannel::offer (pShmClientCommHelper, 1);
+        acceptor.requestTerminationAndWait();
+        if ((pShmClientChannel != nullptr) && (acceptor._pChannel != nullptr)) {
+            pShmServer = new PipelinedRpcServer (acceptor._pChannel, &rpcMethodInvoked, &ui32ShmSeqId);
+            pShmServer->start();
+            pShmClient = new PipelinedRpcClient (pShmClientChannel);
+            pShmClient->start();
+        }
+        else {
+            delete pShmClientChannel;
+            delete acceptor._pChannel;
+            if (pShmClientChannel == nullptr) {
+                delete pShmClientCommHelper;
+            }
+        }
+    }
+
+    printf ("%u addMessage calls, %u bytes of data, window of %u calls, batches of %u messages\n",
+            (unsigned int) opts.ui32Calls, (unsigned int) opts.ui32DataLen, (unsigned int) opts.ui32Window,
+            (unsigned int) opts.ui32Batch);
+    printf ("%-24s | %8s | %9s | %10s | %8s\n", "protocol", "calls", "seconds", "calls/s", "speedup");
+
+    int rc = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; (i < opts.ui32Calls) && (rc == 0); i++) {
+        rc = textAddMessage (pTextClient, &data[0], opts.ui32DataLen);
+    }
+    const double dSeconds = elapsedSeconds (start);
+    const double dTextRate = opts.ui32Calls / (dSeconds > 0.0 ? dSeconds : 1e-9);
+    if (rc == 0) {
+        printResult ("text", opts.ui32Calls, dSeconds, dTextRate);
+        rc = runRpc ("rpc", pRpcClient, data, opts, dTextRate);
+    }
+    if ((rc == 0) && (pShmClient != nullptr)) {
+        rc = runRpc ("shm", pShmClient, data, opts, dTextRate);
+    }
+    else if (rc == 0) {
+        printf ("shared memory not available\n");
+    }
+    if (rc != 0) {
+        fprintf (stderr, "a call failed; rc = %d\n", rc);
+    }
+
+    // Closing the client side of the connections makes the servers terminate
+    delete pRpcClient;
+    pRpcServer->requestTerminationAndWait();
+    delete pRpcServer;
+    delete pShmClient;
+    if (pShmServer != nullptr) {
+        pShmServer->requestTerminationAndWait();
+        delete pShmServer;
+    }
+    SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+    pTextClient->closeConnection (error);
+    delete pTextClient;
+    pTextServer->requestTerminationAndWait();
+    delete pTextServer;
+
+    return (rc == 0 ? 0 : -3);
+}
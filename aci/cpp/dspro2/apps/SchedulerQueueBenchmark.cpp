@@ -0,0 +1,328 @@
+/*
+ * SchedulerQueueBenchmark.cpp
+ *
+ * This file is part of the IHMC DSPro Library/Component
+ * Copyright (c) 2008-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Compares the sorted SetUniquePtrLList that used to back the per-peer queues
+ * of the Scheduler with the IndexedPtrHeap that backs them now.  The messages
+ * are spread over the peer queues with random (primary, secondary) indexes,
+ * then re-ranked as in a new pre-staging session: the replaceable messages
+ * (primary index below a threshold, as with ReplaceLowPriorityPolicy) are
+ * removed, and all the messages are inserted again with new indexes.
+ * Finally, the queues are drained a session at a time, as Scheduler::sendInternal()
+ * does, checking that each message is sent once and in order of rank.
+ */
+
+#include "IndexedPtrHeap.h"
+#include "NLFLib.h"
+#include "SetUniquePtrLList.h"
+#include "StrClass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace NOMADSUtil;
+
+namespace BENCHMARK
+{
+    static const float MAX_INDEX = 10.0f;
+    static const float REPLACEABLE_THRESHOLD = 5.0f;
+
+    struct Options
+    {
+        Options (void);
+
+        uint32 ui32Messages;
+        uint32 ui32Peers;
+        uint32 ui32MaxNMsgPerSession;
+    };
+
+    Options::Options (void)
+        : ui32Messages (100000), ui32Peers (50), ui32MaxNMsgPerSession (5)
+    {
+    }
+
+    // Same ordering and equality as Scheduler::BiIndexMsgIDWrapper
+    struct Msg
+    {
+        Msg (const char *pszMsgId, float fIndex1, float fIndex2);
+
+        bool operator > (const Msg &rhsMsg) const;
+        bool operator < (const Msg &rhsMsg) const;
+        bool operator == (const Msg &rhsMsg) const;
+
+        String msgId;
+        float fIndex1;
+        float fIndex2;
+    };
+
+    Msg::Msg (const char *pszMsgId, float fIndex1, float fIndex2)
+        : msgId (pszMsgId), fIndex1 (fIndex1), fIndex2 (fIndex2)
+    {
+    }
+
+    bool Msg::operator > (const Msg &rhsMsg) const
+    {
+        return (fIndex1 > rhsMsg.fIndex1) || ((fIndex1 == rhsMsg.fIndex1) && (fIndex2 > rhsMsg.fIndex2));
+    }
+
+    bool Msg::operator < (const Msg &rhsMsg) const
+    {
+        return (fIndex1 < rhsMsg.fIndex1) || ((fIndex1 == rhsMsg.fIndex1) && (fIndex2 < rhsMsg.fIndex2));
+    }
+
+    bool Msg::operator == (const Msg &rhsMsg) const
+    {
+        return ((msgId == rhsMsg.msgId) != 0);
+    }
+
+    // Same ordering as Scheduler::QueueRank
+    struct Rank
+    {
+        bool operator < (const Rank &rhsRank) const;
+
+        float fIndex1;
+        float fIndex2;
+        uint64 ui64Seq;
+    };
+
+    bool Rank::operator < (const Rank &rhsRank) const
+    {
+        if (fIndex1 != rhsRank.fIndex1) {
+            return (fIndex1 < rhsRank.fIndex1);
+        }
+        if (fIndex2 != rhsRank.fIndex2) {
+            return (fIndex2 < rhsRank.fIndex2);
+        }
+        return (ui64Seq > rhsRank.ui64Seq);
+    }
+
+    bool isReplaceable (const Msg *pMsg)
+    {
+        return (pMsg->fIndex1 < REPLACEABLE_THRESHOLD);
+    }
+
+    class ListQueue
+    {
+        public:
+            ListQueue (void) : _msgs (true) {}
+            ~ListQueue (void) { removeIf (true); }
+
+            Msg * insert (Msg *pMsg) { return _msgs.insertUnique (pMsg); }
+            Msg * removeFirst (void) { return _msgs.isEmpty() ? nullptr : _msgs.remove (_msgs.getFirst()); }
+            void removeReplaceable (void) { removeIf (false); }
+
+        private:
+            void removeIf (bool bAll)
+            {
+                Msg *pCurr, *pNext;
+                pNext = _msgs.getFirst();
+                while ((pCurr = pNext) != nullptr) {
+                    pNext = _msgs.getNext();
+                    if (bAll || isReplaceable (pCurr)) {
+                        delete _msgs.remove (pCurr);
+                    }
+                }
+            }
+
+        private:
+            SetUniquePtrLList<Msg> _msgs;
+    };
+
+    class HeapQueue
+    {
+        public:
+            HeapQueue (void) : _ui64NextSeq (0) {}
+            ~HeapQueue (void) { _msgs.removeAll (true); }
+
+            Msg * insert (Msg *pMsg)
+            {
+                const Rank rank = { pMsg->fIndex1, pMsg->fIndex2, _ui64NextSeq++ };
+                Rank enqueuedRank;
+                if (_msgs.getPriority (pMsg->msgId.c_str(), enqueuedRank) && !(enqueuedRank < rank)) {
+                    return pMsg;
+                }
+                return _msgs.insertOrReplace (pMsg->msgId.c_str(), rank, pMsg);
+            }
+            Msg * removeFirst (void) { return _msgs.removeFirst(); }
+            void removeReplaceable (void) { _msgs.removeIf (isReplaceable, true); }
+
+        private:
+            uint64 _ui64NextSeq;
+            IndexedPtrHeap<Msg, Rank> _msgs;
+    };
+
+    struct Results
+    {
+        Results (void);
+
+        int64 i64RankTime;
+        int64 i64ReRankTime;
+        int64 i64DrainTime;
+        uint32 ui32Sent;
+        uint32 ui32Duplicates;
+        uint32 ui32OutOfOrder;
+    };
+
+    Results::Results (void)
+        : i64RankTime (0), i64ReRankTime (0), i64DrainTime (0),
+          ui32Sent (0), ui32Duplicates (0), ui32OutOfOrder (0)
+    {
+    }
+
+    float randomIndex (void)
+    {
+        // Few distinct values, so that messages with the same indexes are common
+        return (float) (rand() % 100) * (MAX_INDEX / 100.0f);
+    }
+
+    template <class Queue>
+    void enqueue (std::vector<Queue *> &queues, const Options &opts)
+    {
+        char szId[32];
+        for (uint32 i = 0; i < opts.ui32Messages; i++) {
+            snprintf (szId, sizeof (szId), "bench.group:node:%u", (unsigned int) i);
+            Msg *pMsg = new Msg (szId, randomIndex(), randomIndex());
+            delete queues[i % opts.ui32Peers]->insert (pMsg);
+        }
+    }
+
+    template <class Queue>
+    void run (const Options &opts, Results &results)
+    {
+        std::vector<Queue *> queues;
+        for (uint32 i = 0; i < opts.ui32Peers; i++) {
+            queues.push_back (new Queue());
+        }
+
+        srand (1);
+        int64 i64Start = getTimeInMilliseconds();
+        enqueue (queues, opts);
+        results.i64RankTime = getTimeInMilliseconds() - i64Start;
+
+        i64Start = getTimeInMilliseconds();
+        for (uint32 i = 0; i < opts.ui32Peers; i++) {
+            queues[i]->removeReplaceable();
+        }
+        enqueue (queues, opts);
+        results.i64ReRankTime = getTimeInMilliseconds() - i64Start;
+
+        // Peer and message, in the order they are sent
+        std::vector<std::pair<uint32, Msg *> > sent;
+        sent.reserve (2 * opts.ui32Messages);
+        i64Start = getTimeInMilliseconds();
+        for (bool bAllEmptyQueues = false; !bAllEmptyQueues;) {
+            bAllEmptyQueues = true;
+            for (uint32 i = 0; i < opts.ui32Peers; i++) {
+                Msg *pMsg = nullptr;
+                for (uint32 j = 0; (j < opts.ui32MaxNMsgPerSession) && ((pMsg = queues[i]->removeFirst()) != nullptr); j++) {
+                    sent.push_back (std::make_pair (i, pMsg));
+                }
+                if (pMsg != nullptr) {
+                    bAllEmptyQueues = false;
+                }
+            }
+        }
+        results.i64DrainTime = getTimeInMilliseconds() - i64Start;
+
+        std::unordered_set<std::string> sentIds;
+        std::vector<Msg> lastSent (opts.ui32Peers, Msg ("", MAX_INDEX, MAX_INDEX));
+        for (size_t i = 0; i < sent.size(); i++) {
+            Msg *pMsg = sent[i].second;
+            if (!sentIds.insert (pMsg->msgId.c_str()).second) {
+                results.ui32Duplicates++;
+            }
+            if (*pMsg > lastSent[sent[i].first]) {
+                results.ui32OutOfOrder++;
+            }
+            lastSent[sent[i].first] = *pMsg;
+            delete pMsg;
+        }
+        results.ui32Sent = (uint32) sent.size();
+
+        for (uint32 i = 0; i < opts.ui32Peers; i++) {
+            delete queues[i];
+        }
+    }
+
+    void printResults (const char *pszPhase, int64 i64ListTime, int64 i64HeapTime)
+    {
+        printf ("%-8s | %10lld | %10lld | %6.1fx\n", pszPhase, (long long) i64ListTime, (long long) i64HeapTime,
+                (double) i64ListTime / (double) (i64HeapTime > 0 ? i64HeapTime : 1));
+    }
+
+    void printUsageAndExit (const char *pszProgName)
+    {
+        fprintf (stderr, "Usage: %s [-n <number of messages>] [-p <number of peers>] "
+                 "[-s <max number of messages per session>]\n", pszProgName);
+        exit (-1);
+    }
+}
+
+using namespace BENCHMARK;
+
+int main (int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        if ((i + 1) >= argc) {
+            printUsageAndExit (argv[0]);
+        }
+        const uint32 ui32Value = atoui32 (argv[++i]);
+        if (0 == strcmp (argv[i-1], "-n")) {
+            opts.ui32Messages = ui32Value;
+        }
+        else if (0 == strcmp (argv[i-1], "-p")) {
+            opts.ui32Peers = ui32Value;
+        }
+        else if (0 == strcmp (argv[i-1], "-s")) {
+            opts.ui32MaxNMsgPerSession = ui32Value;
+        }
+        else {
+            printUsageAndExit (argv[0]);
+        }
+    }
+    if ((opts.ui32Messages == 0) || (opts.ui32Peers == 0) || (opts.ui32MaxNMsgPerSession == 0)) {
+        printUsageAndExit (argv[0]);
+    }
+
+    Results list, heap;
+    run<ListQueue> (opts, list);
+    run<HeapQueue> (opts, heap);
+
+    printf ("%u messages, %u peers, %u messages per session\n", (unsigned int) opts.ui32Messages,
+            (unsigned int) opts.ui32Peers, (unsigned int) opts.ui32MaxNMsgPerSession);
+    printf ("%-8s | %10s | %10s | %7s\n", "phase", "list ms", "heap ms", "speedup");
+    printResults ("rank", list.i64RankTime, heap.i64RankTime);
+    printResults ("re-rank", list.i64ReRankTime, heap.i64ReRankTime);
+    printResults ("drain", list.i64DrainTime, heap.i64DrainTime);
+    printf ("\n%-8s | %10s | %10s\n", "", "list", "heap");
+    printf ("%-8s | %10u | %10u\n", "sent", (unsigned int) list.ui32Sent, (unsigned int) heap.ui32Sent);
+    printf ("%-8s | %10u | %10u\n", "dupl.", (unsigned int) list.ui32Duplicates, (unsigned int) heap.ui32Duplicates);
+    printf ("%-8s | %10u | %10u\n", "unsorted", (unsigned int) list.ui32OutOfOrder, (unsigned int) heap.ui32OutOfOrder);
+
+    if ((heap.ui32Duplicates > 0) || (heap.ui32OutOfOrder > 0)) {
+        fprintf (stderr, "the heap sent duplicate messages or messages out of order\n");
+        return -2;
+    }
+    return 0;
+}
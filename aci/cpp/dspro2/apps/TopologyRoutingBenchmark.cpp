@@ -0,0 +1,456 @@
+/*
+ * TopologyRoutingBenchmark.cpp
+ *
+ * This file is part of the IHMC DSPro Library/Component
+ * Copyright (c) 2008-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Compares the cost of finding the next hop toward a node with a shortest path
+ * search on the topology graph, as Topology::getNextHopAsTarget() used to do,
+ * with a lookup in the next-hop table that Topology keeps now.
+ * The topologies are synthetic MANETs: the nodes are placed at random in a
+ * unit square, and two nodes are neighbors if they are within radio range.
+ * At each step of the churn, some nodes move and the neighbor sets that
+ * changed are reported to the Topology as DSPro does: the links of the local
+ * node through addLink() and removeLink(), and those of the other nodes
+ * through replaceAllLinksForPeer().  After each step, the incrementally
+ * updated routes are checked against a shortest path search and against
+ * routes recomputed from scratch.
+ */
+
+#include "Topology.h"
+
+#include "NLFLib.h"
+#include "PtrLList.h"
+#include "StrClass.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace IHMC_ACI;
+using namespace NOMADSUtil;
+
+namespace BENCHMARK
+{
+    static const AdaptorId ADAPTOR_ID = 1;
+    static const uint32 NETWORK_SIZES[] = { 50, 100, 200, 500 };
+    static const double PI = 3.14159265358979323846;
+
+    struct Options
+    {
+        Options (void);
+
+        uint32 ui32Nodes;       // 0 runs all the NETWORK_SIZES
+        uint32 ui32Steps;
+        uint32 ui32Queries;     // shortest path searches per step
+        float fDegree;          // average number of neighbors
+        float fMovers;          // fraction of the nodes that move at each step
+    };
+
+    Options::Options (void)
+        : ui32Nodes (0), ui32Steps (50), ui32Queries (10), fDegree (8.0f), fMovers (0.05f)
+    {
+    }
+
+    struct Results
+    {
+        Results (void);
+
+        double dLinkChanges;
+        double dUpdateTime;         // all in microseconds
+        double dRebuildTime;
+        double dSearchTime;
+        double dLookupTime;
+        double dTargetsTime;
+        uint32 ui32Searches;
+        uint32 ui32Lookups;
+        uint32 ui32Unreachable;
+        uint32 ui32Mismatches;
+    };
+
+    Results::Results (void)
+        : dLinkChanges (0.0), dUpdateTime (0.0), dRebuildTime (0.0), dSearchTime (0.0),
+          dLookupTime (0.0), dTargetsTime (0.0), ui32Searches (0), ui32Lookups (0),
+          ui32Unreachable (0), ui32Mismatches (0)
+    {
+    }
+
+    double elapsedMicroseconds (std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro> (std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Gives access to the graph and to the next-hop table of the Topology
+    class BenchmarkTopology : public Topology
+    {
+        public:
+            explicit BenchmarkTopology (const char *pszNodeId);
+
+            // Returns the number of hops to pszDstPeerId, or a negative value if
+            // it is unreachable, and sets nextHop.  The next hop is found as
+            // getNextHopAsTarget() did before the next-hop table.
+            int searchNextHop (const char *pszDstPeerId, String &nextHop);
+
+            int getHopCount (const char *pszDstPeerId);
+            const char * getNextHop (const char *pszDstPeerId);
+            void updateRoutes (void);
+    };
+
+    BenchmarkTopology::BenchmarkTopology (const char *pszNodeId)
+        : Topology (pszNodeId)
+    {
+    }
+
+    int BenchmarkTopology::searchNextHop (const char *pszDstPeerId, String &nextHop)
+    {
+        _m.lock();
+        int iHops = -1;
+        if (_graph.hasNeighbor (_nodeId, pszDstPeerId)) {
+            nextHop = pszDstPeerId;
+            iHops = 1;
+        }
+        else if (_graph.hasVertex (pszDstPeerId)) {
+            PtrLList<const char> path;
+            _graph.getShortestPath (_nodeId, pszDstPeerId, &path, false);
+            // The path is [_nodeId, ..., pszDstPeerId], or just [pszDstPeerId] if it is unreachable
+            const char *pszFirst = path.getFirst();
+            if ((pszFirst != nullptr) && (_nodeId == pszFirst)) {
+                nextHop = path.getNext();
+                iHops = path.getCount() - 1;
+            }
+            for (const char *pszHop; (pszHop = path.removeFirst()) != nullptr;) {
+                free ((void *) pszHop);
+            }
+        }
+        _m.unlock();
+        return iHops;
+    }
+
+    int BenchmarkTopology::getHopCount (const char *pszDstPeerId)
+    {
+        _m.lock();
+        int iHops = _routes.getHopCount (pszDstPeerId);
+        _m.unlock();
+        return iHops;
+    }
+
+    const char * BenchmarkTopology::getNextHop (const char *pszDstPeerId)
+    {
+        _m.lock();
+        const char *pszNextHop = _routes.getNextHop (pszDstPeerId);
+        _m.unlock();
+        return pszNextHop;
+    }
+
+    void BenchmarkTopology::updateRoutes (void)
+    {
+        _m.lock();
+        _routes.updateRoutes();
+        _m.unlock();
+    }
+
+    class Network
+    {
+        public:
+            Network (uint32 ui32Nodes, float fDegree);
+
+            // Moves ui32Movers random nodes, and returns the nodes whose neighbors changed
+            std::vector<uint32> move (uint32 ui32Movers);
+
+            const char * getNodeId (uint32 ui32Node) const;
+            const std::vector<uint32> & getNeighbors (uint32 ui32Node) const;
+            uint32 getCount (void) const;
+
+        private:
+            std::vector<uint32> computeNeighbors (uint32 ui32Node) const;
+
+        private:
+            const float _fRange;
+            std::vector<float> _x;
+            std::vector<float> _y;
+            std::vector<String> _nodeIds;
+            std::vector<std::vector<uint32> > _neighbors;
+    };
+
+    float randomCoordinate (void)
+    {
+        return (float) rand() / (float) RAND_MAX;
+    }
+
+    Network::Network (uint32 ui32Nodes, float fDegree)
+        : _fRange ((float) sqrt (fDegree / (PI * ui32Nodes))), _x (ui32Nodes), _y (ui32Nodes),
+          _nodeIds (ui32Nodes), _neighbors (ui32Nodes)
+    {
+        char szId[32];
+        for (uint32 i = 0; i < ui32Nodes; i++) {
+            snprintf (szId, sizeof (szId), "node%u", (unsigned int) i);
+            _nodeIds[i] = szId;
+            _x[i] = randomCoordinate();
+            _y[i] = randomCoordinate();
+        }
+        // The local node starts at the center, so that most of the network is reachable
+        _x[0] = 0.5f;
+        _y[0] = 0.5f;
+        for (uint32 i = 0; i < ui32Nodes; i++) {
+            _neighbors[i] = computeNeighbors (i);
+        }
+    }
+
+    std::vector<uint32> Network::move (uint32 ui32Movers)
+    {
+        for (uint32 i = 0; i < ui32Movers; i++) {
+            // Random waypoint-like steps of up to half the radio range
+            const uint32 ui32Node = (uint32) rand() % getCount();
+            const double dAngle = 2.0 * PI * randomCoordinate();
+            const float fDistance = 0.5f * _fRange * randomCoordinate();
+            _x[ui32Node] = std::min (1.0f, std::max (0.0f, _x[ui32Node] + fDistance * (float) cos (dAngle)));
+            _y[ui32Node] = std::min (1.0f, std::max (0.0f, _y[ui32Node] + fDistance * (float) sin (dAngle)));
+        }
+        std::vector<uint32> changed;
+        for (uint32 i = 0; i < getCount(); i++) {
+            std::vector<uint32> neighbors (computeNeighbors (i));
+            if (neighbors != _neighbors[i]) {
+                _neighbors[i].swap (neighbors);
+                changed.push_back (i);
+            }
+        }
+        return changed;
+    }
+
+    const char * Network::getNodeId (uint32 ui32Node) const
+    {
+        return _nodeIds[ui32Node].c_str();
+    }
+
+    const std::vector<uint32> & Network::getNeighbors (uint32 ui32Node) const
+    {
+        return _neighbors[ui32Node];
+    }
+
+    uint32 Network::getCount (void) const
+    {
+        return (uint32) _nodeIds.size();
+    }
+
+    std::vector<uint32> Network::computeNeighbors (uint32 ui32Node) const
+    {
+        std::vector<uint32> neighbors;
+        for (uint32 i = 0; i < getCount(); i++) {
+            const float fDx = _x[i] - _x[ui32Node];
+            const float fDy = _y[i] - _y[ui32Node];
+            if ((i != ui32Node) && ((fDx * fDx + fDy * fDy) <= (_fRange * _fRange))) {
+                neighbors.push_back (i);
+            }
+        }
+        return neighbors;
+    }
+
+    // Reports the neighbors of ui32Node to the topology, and returns the number of links that changed.
+    // Node 0 is the local node.
+    uint32 reportNeighbors (BenchmarkTopology &topology, const Network &network, uint32 ui32Node,
+                            const std::vector<uint32> &prevNeighbors)
+    {
+        const std::vector<uint32> &neighbors = network.getNeighbors (ui32Node);
+        std::vector<uint32> added, removed;
+        std::set_difference (neighbors.begin(), neighbors.end(), prevNeighbors.begin(), prevNeighbors.end(),
+                             std::back_inserter (added));
+        std::set_difference (prevNeighbors.begin(), prevNeighbors.end(), neighbors.begin(), neighbors.end(),
+                             std::back_inserter (removed));
+        if (ui32Node == 0) {
+            for (size_t i = 0; i < added.size(); i++) {
+                topology.addLink (network.getNodeId (added[i]), Topology::DEFAULT_INTERFACE, ADAPTOR_ID, UNKNOWN);
+            }
+            for (size_t i = 0; i < removed.size(); i++) {
+                topology.removeLink (network.getNodeId (removed[i]), ADAPTOR_ID);
+            }
+        }
+        else {
+            // replaceAllLinksForPeer() takes ownership of the elements of the list
+            PtrLList<String> neighborIds;
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                neighborIds.append (new String (network.getNodeId (neighbors[i])));
+            }
+            topology.replaceAllLinksForPeer (network.getNodeId (ui32Node), ADAPTOR_ID, neighborIds);
+        }
+        return (uint32) (added.size() + removed.size());
+    }
+
+    void run (uint32 ui32Nodes, const Options &opts, Results &results)
+    {
+        srand (ui32Nodes);
+        Network network (ui32Nodes, opts.fDegree);
+        BenchmarkTopology topology (network.getNodeId (0));
+        const std::vector<uint32> noNeighbors;
+        for (uint32 i = 0; i < ui32Nodes; i++) {
+            reportNeighbors (topology, network, i, noNeighbors);
+        }
+
+        const uint32 ui32Movers = std::max (1U, (uint32) (opts.fMovers * ui32Nodes));
+        uint32 ui32LinkChanges = 0;
+        for (uint32 ui32Step = 0; ui32Step < opts.ui32Steps; ui32Step++) {
+            std::vector<std::vector<uint32> > prevNeighbors (ui32Nodes);
+            for (uint32 i = 0; i < ui32Nodes; i++) {
+                prevNeighbors[i] = network.getNeighbors (i);
+            }
+            const std::vector<uint32> changed (network.move (ui32Movers));
+
+            // The local node reports its own links last: DSPro removes
+            // the nodes that have no links left when a neighbor is lost
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = changed.size(); i > 0; i--) {
+                ui32LinkChanges += reportNeighbors (topology, network, changed[i - 1], prevNeighbors[changed[i - 1]]);
+            }
+            results.dUpdateTime += elapsedMicroseconds (start);
+
+            // Table lookups, for all the destinations
+            start = std::chrono::steady_clock::now();
+            uint32 ui32Reachable = 0;
+            for (uint32 i = 1; i < ui32Nodes; i++) {
+                ui32Reachable += (topology.getNextHop (network.getNodeId (i)) != nullptr ? 1 : 0);
+            }
+            results.dLookupTime += elapsedMicroseconds (start);
+            results.ui32Lookups += ui32Nodes - 1;
+            results.ui32Unreachable += ui32Nodes - 1 - ui32Reachable;
+
+            start = std::chrono::steady_clock::now();
+            for (uint32 i = 1; i < ui32Nodes; i++) {
+                delete topology.getNextHopAsTarget (network.getNodeId (i));
+            }
+            results.dTargetsTime += elapsedMicroseconds (start);
+
+            // Shortest path searches, for a sample of the destinations
+            std::vector<int> hopCounts (opts.ui32Queries);
+            std::vector<String> destinations (opts.ui32Queries);
+            for (uint32 i = 0; i < opts.ui32Queries; i++) {
+                destinations[i] = network.getNodeId (1 + (uint32) rand() % (ui32Nodes - 1));
+            }
+            start = std::chrono::steady_clock::now();
+            for (uint32 i = 0; i < opts.ui32Queries; i++) {
+                String nextHop;
+                hopCounts[i] = topology.searchNextHop (destinations[i], nextHop);
+            }
+            results.dSearchTime += elapsedMicroseconds (start);
+            results.ui32Searches += opts.ui32Queries;
+
+            // Ties between equally short routes may be broken differently,
+            // so the routes are compared by hop count
+            std::vector<int> incrementalHopCounts (ui32Nodes);
+            for (uint32 i = 0; i < ui32Nodes; i++) {
+                incrementalHopCounts[i] = topology.getHopCount (network.getNodeId (i));
+            }
+            for (uint32 i = 0; i < opts.ui32Queries; i++) {
+                if (hopCounts[i] != topology.getHopCount (destinations[i])) {
+                    fprintf (stderr, "step %u: %d hops to %s instead of %d\n", (unsigned int) ui32Step,
+                             topology.getHopCount (destinations[i]), destinations[i].c_str(), hopCounts[i]);
+                    results.ui32Mismatches++;
+                }
+            }
+            start = std::chrono::steady_clock::now();
+            topology.updateRoutes();
+            results.dRebuildTime += elapsedMicroseconds (start);
+            for (uint32 i = 0; i < ui32Nodes; i++) {
+                if (incrementalHopCounts[i] != topology.getHopCount (network.getNodeId (i))) {
+                    fprintf (stderr, "step %u: %d hops to %s instead of %d after recomputing the routes\n",
+                             (unsigned int) ui32Step, incrementalHopCounts[i], network.getNodeId (i),
+                             topology.getHopCount (network.getNodeId (i)));
+                    results.ui32Mismatches++;
+                }
+            }
+        }
+        results.dLinkChanges = (double) ui32LinkChanges / opts.ui32Steps;
+        results.dUpdateTime /= opts.ui32Steps;
+        results.dRebuildTime /= opts.ui32Steps;
+    }
+
+    void printUsageAndExit (const char *pszProgName)
+    {
+        fprintf (stderr, "Usage: %s [-n <number of nodes>] [-s <number of steps>] "
+                 "[-q <shortest path searches per step>] [-d <average degree>] "
+                 "[-m <fraction of moving nodes per step>]\n", pszProgName);
+        exit (-1);
+    }
+}
+
+using namespace BENCHMARK;
+
+int main (int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        if ((i + 1) >= argc) {
+            printUsageAndExit (argv[0]);
+        }
+        const char *pszValue = argv[++i];
+        if (0 == strcmp (argv[i-1], "-n")) {
+            opts.ui32Nodes = atoui32 (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-s")) {
+            opts.ui32Steps = atoui32 (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-q")) {
+            opts.ui32Queries = atoui32 (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-d")) {
+            opts.fDegree = (float) atof (pszValue);
+        }
+        else if (0 == strcmp (argv[i-1], "-m")) {
+            opts.fMovers = (float) atof (pszValue);
+        }
+        else {
+            printUsageAndExit (argv[0]);
+        }
+    }
+    if (((opts.ui32Nodes > 0) && (opts.ui32Nodes < 2)) || (opts.ui32Steps == 0) || (opts.fDegree <= 0.0f) ||
+        (opts.fMovers < 0.0f) || (opts.fMovers > 1.0f)) {
+        printUsageAndExit (argv[0]);
+    }
+
+    std::vector<uint32> sizes;
+    if (opts.ui32Nodes > 0) {
+        sizes.push_back (opts.ui32Nodes);
+    }
+    else {
+        sizes.assign (NETWORK_SIZES, NETWORK_SIZES + sizeof (NETWORK_SIZES) / sizeof (NETWORK_SIZES[0]));
+    }
+
+    printf ("%u steps, average degree %.1f, %.0f%% of the nodes moving at each step\n",
+            (unsigned int) opts.ui32Steps, opts.fDegree, opts.fMovers * 100.0f);
+    printf ("%5s | %8s | %10s | %10s | %11s | %10s | %10s | %9s | %8s\n", "nodes", "changes", "update us",
+            "rebuild us", "unreachable", "search us", "lookup us", "target us", "speedup");
+    uint32 ui32Mismatches = 0;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        Results results;
+        run (sizes[i], opts, results);
+        const double dSearchTime = (results.ui32Searches > 0 ? results.dSearchTime / results.ui32Searches : 0.0);
+        const double dLookupTime = results.dLookupTime / results.ui32Lookups;
+        printf ("%5u | %8.1f | %10.1f | %10.1f | %10.1f%% | %10.2f | %10.3f | %9.2f | %7.0fx\n",
+                (unsigned int) sizes[i], results.dLinkChanges, results.dUpdateTime, results.dRebuildTime,
+                (100.0 * results.ui32Unreachable) / results.ui32Lookups, dSearchTime, dLookupTime,
+                results.dTargetsTime / results.ui32Lookups, dSearchTime / (dLookupTime > 0.0 ? dLookupTime : 1.0));
+        ui32Mismatches += results.ui32Mismatches;
+    }
+
+    if (ui32Mismatches > 0) {
+        fprintf (stderr, "%u routes of the next-hop table do not have the shortest hop count\n",
+                 (unsigned int) ui32Mismatches);
+        return -2;
+    }
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * RoutingTable.cpp
+ *
+ * This file is part of the IHMC DSPro Library/Component
+ * Copyright (c) 2008-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "RoutingTable.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+using namespace IHMC_ACI;
+
+namespace ROUTING_TABLE
+{
+    bool removeNode (std::vector<uint32> &nodes, uint32 ui32Node)
+    {
+        std::vector<uint32>::iterator it = std::find (nodes.begin(), nodes.end(), ui32Node);
+        if (it == nodes.end()) {
+            return false;
+        }
+        *it = nodes.back();
+        nodes.pop_back();
+        return true;
+    }
+}
+
+using namespace ROUTING_TABLE;
+
+const uint32 RoutingTable::LOCAL_NODE;
+const uint32 RoutingTable::NO_NODE;
+const uint32 RoutingTable::NO_ROUTE;
+
+RoutingTable::RoutingTable (const char *pszLocalNodeId)
+{
+    intern (pszLocalNodeId);
+    _hopCount[LOCAL_NODE] = 0;
+}
+
+RoutingTable::~RoutingTable (void)
+{
+}
+
+void RoutingTable::addLink (const char *pszSrcNodeId, const char *pszDstNodeId, bool bUpdateRoutes)
+{
+    if ((pszSrcNodeId == nullptr) || (pszDstNodeId == nullptr)) {
+        return;
+    }
+    const uint32 ui32Src = intern (pszSrcNodeId);
+    const uint32 ui32Dst = intern (pszDstNodeId);
+    if ((ui32Src == ui32Dst) ||
+        (std::find (_outLinks[ui32Src].begin(), _outLinks[ui32Src].end(), ui32Dst) != _outLinks[ui32Src].end())) {
+        return;
+    }
+    _outLinks[ui32Src].push_back (ui32Dst);
+    _inLinks[ui32Dst].push_back (ui32Src);
+
+    if (bUpdateRoutes && (_hopCount[ui32Src] != NO_ROUTE) && (_hopCount[ui32Src] + 1 < _hopCount[ui32Dst])) {
+        // The new link shortens the route to ui32Dst, and to all the nodes reached through it
+        _hopCount[ui32Dst] = _hopCount[ui32Src] + 1;
+        setRoute (ui32Dst, ui32Src);
+        std::vector<uint32> queue (1, ui32Dst);
+        propagateShorterRoutes (queue);
+    }
+}
+
+void RoutingTable::removeLink (const char *pszSrcNodeId, const char *pszDstNodeId)
+{
+    const uint32 ui32Src = lookup (pszSrcNodeId);
+    const uint32 ui32Dst = lookup (pszDstNodeId);
+    if ((ui32Src == NO_NODE) || (ui32Dst == NO_NODE) || !removeNode (_outLinks[ui32Src], ui32Dst)) {
+        return;
+    }
+    removeNode (_inLinks[ui32Dst], ui32Src);
+    if (_parent[ui32Dst] != ui32Src) {
+        // Not a link of the shortest path tree: no route used it
+        return;
+    }
+
+    // Only the routes to the subtree rooted at ui32Dst used the link
+    std::vector<uint32> subtree (1, ui32Dst);
+    for (size_t i = 0; i < subtree.size(); i++) {
+        const uint32 ui32Node = subtree[i];
+        const std::vector<uint32> &outLinks = _outLinks[ui32Node];
+        for (size_t j = 0; j < outLinks.size(); j++) {
+            if (_parent[outLinks[j]] == ui32Node) {
+                subtree.push_back (outLinks[j]);
+            }
+        }
+        _hopCount[ui32Node] = NO_ROUTE;
+        _parent[ui32Node] = NO_NODE;
+        _nextHop[ui32Node] = NO_NODE;
+    }
+
+    // Reconnect each node of the subtree through its closest in-neighbor
+    // outside of the subtree, then settle the subtree in order of hop count
+    typedef std::pair<uint32, uint32> Candidate;  // (hop count, node)
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > candidates;
+    for (size_t i = 0; i < subtree.size(); i++) {
+        const uint32 ui32Node = subtree[i];
+        const std::vector<uint32> &inLinks = _inLinks[ui32Node];
+        for (size_t j = 0; j < inLinks.size(); j++) {
+            const uint32 ui32InNode = inLinks[j];
+            if ((_hopCount[ui32InNode] != NO_ROUTE) && (_hopCount[ui32InNode] + 1 < _hopCount[ui32Node])) {
+                _hopCount[ui32Node] = _hopCount[ui32InNode] + 1;
+                _parent[ui32Node] = ui32InNode;
+            }
+        }
+        if (_hopCount[ui32Node] != NO_ROUTE) {
+            candidates.push (Candidate (_hopCount[ui32Node], ui32Node));
+        }
+    }
+    while (!candidates.empty()) {
+        const Candidate candidate = candidates.top();
+        candidates.pop();
+        const uint32 ui32Node = candidate.second;
+        if (candidate.first != _hopCount[ui32Node]) {
+            // Stale entry, the node was settled with a shorter route
+            continue;
+        }
+        setRoute (ui32Node, _parent[ui32Node]);
+        const std::vector<uint32> &outLinks = _outLinks[ui32Node];
+        for (size_t j = 0; j < outLinks.size(); j++) {
+            const uint32 ui32OutNode = outLinks[j];
+            if (candidate.first + 1 < _hopCount[ui32OutNode]) {
+                // Can only be a node of the subtree: the routes to all the others did not change
+                _hopCount[ui32OutNode] = candidate.first + 1;
+                _parent[ui32OutNode] = ui32Node;
+                candidates.push (Candidate (_hopCount[ui32OutNode], ui32OutNode));
+            }
+        }
+    }
+}
+
+void RoutingTable::removeAllLinksFromNode (const char *pszNodeId)
+{
+    const uint32 ui32Node = lookup (pszNodeId);
+    if (ui32Node == NO_NODE) {
+        return;
+    }
+    const std::vector<uint32> outLinks (_outLinks[ui32Node]);
+    for (size_t i = 0; i < outLinks.size(); i++) {
+        removeLink (pszNodeId, _nodeIds[outLinks[i]].c_str());
+    }
+}
+
+void RoutingTable::removeAllLinks (void)
+{
+    for (size_t i = 0; i < _nodeIds.size(); i++) {
+        _outLinks[i].clear();
+        _inLinks[i].clear();
+    }
+    updateRoutes();
+}
+
+void RoutingTable::updateRoutes (void)
+{
+    std::fill (_hopCount.begin(), _hopCount.end(), NO_ROUTE);
+    std::fill (_parent.begin(), _parent.end(), NO_NODE);
+    std::fill (_nextHop.begin(), _nextHop.end(), NO_NODE);
+    _hopCount[LOCAL_NODE] = 0;
+    std::vector<uint32> queue (1, LOCAL_NODE);
+    propagateShorterRoutes (queue);
+}
+
+const char * RoutingTable::getNextHop (const char *pszDstNodeId) const
+{
+    const uint32 ui32Dst = lookup (pszDstNodeId);
+    if ((ui32Dst == NO_NODE) || (_nextHop[ui32Dst] == NO_NODE)) {
+        return nullptr;
+    }
+    return _nodeIds[_nextHop[ui32Dst]].c_str();
+}
+
+int RoutingTable::getHopCount (const char *pszDstNodeId) const
+{
+    const uint32 ui32Dst = lookup (pszDstNodeId);
+    if ((ui32Dst == NO_NODE) || (_hopCount[ui32Dst] == NO_ROUTE)) {
+        return -1;
+    }
+    return (int) _hopCount[ui32Dst];
+}
+
+bool RoutingTable::isOnShortestRoute (const char *pszNodeId, const char *pszDstNodeId) const
+{
+    const uint32 ui32Node = lookup (pszNodeId);
+    const uint32 ui32Dst = lookup (pszDstNodeId);
+    if ((ui32Node == NO_NODE) || (ui32Dst == NO_NODE)) {
+        return false;
+    }
+    if (ui32Node == ui32Dst) {
+        return true;
+    }
+    if (_hopCount[ui32Dst] == NO_ROUTE) {
+        return false;
+    }
+    for (uint32 ui32Hop = ui32Dst; ui32Hop != NO_NODE; ui32Hop = _parent[ui32Hop]) {
+        if (ui32Hop == ui32Node) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32 RoutingTable::intern (const char *pszNodeId)
+{
+    std::pair<std::unordered_map<std::string, uint32>::iterator, bool> res =
+        _ids.insert (std::make_pair (std::string (pszNodeId), (uint32) _nodeIds.size()));
+    if (res.second) {
+        _nodeIds.push_back (res.first->first);
+        _outLinks.push_back (std::vector<uint32>());
+        _inLinks.push_back (std::vector<uint32>());
+        _hopCount.push_back (NO_ROUTE);
+        _parent.push_back (NO_NODE);
+        _nextHop.push_back (NO_NODE);
+    }
+    return res.first->second;
+}
+
+uint32 RoutingTable::lookup (const char *pszNodeId) const
+{
+    if (pszNodeId == nullptr) {
+        return NO_NODE;
+    }
+    std::unordered_map<std::string, uint32>::const_iterator it = _ids.find (pszNodeId);
+    return (it == _ids.end() ? NO_NODE : it->second);
+}
+
+void RoutingTable::setRoute (uint32 ui32Node, uint32 ui32Parent)
+{
+    _parent[ui32Node] = ui32Parent;
+    _nextHop[ui32Node] = (ui32Parent == LOCAL_NODE ? ui32Node : _nextHop[ui32Parent]);
+}
+
+void RoutingTable::propagateShorterRoutes (std::vector<uint32> &queue)
+{
+    // Breadth-first: the nodes are dequeued in order of hop count
+    for (size_t i = 0; i < queue.size(); i++) {
+        const uint32 ui32Node = queue[i];
+        const std::vector<uint32> &outLinks = _outLinks[ui32Node];
+        for (size_t j = 0; j < outLinks.size(); j++) {
+            const uint32 ui32OutNode = outLinks[j];
+            if (_hopCount[ui32Node] + 1 < _hopCount[ui32OutNode]) {
+                _hopCount[ui32OutNode] = _hopCount[ui32Node] + 1;
+                setRoute (ui32OutNode, ui32Node);
+                queue.push_back (ui32OutNode);
+            }
+        }
+    }
+}
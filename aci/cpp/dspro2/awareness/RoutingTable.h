@@ -0,0 +1,93 @@
+/*
+ * RoutingTable.h
+ *
+ * This file is part of the IHMC DSPro Library/Component
+ * Copyright (c) 2008-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Shortest (minimum hop count) routes from the local node to every other
+ * node of a directed topology.
+ * Node IDs are interned to integers, and the table keeps a breadth-first
+ * shortest path tree rooted at the local node, as arrays indexed by node:
+ * the hop count, the parent in the tree, and the first hop of the route.
+ * The tree is repaired incrementally when a link is added or removed: an
+ * added link can only shorten routes, and those are propagated from its
+ * destination; a removed link only affects the subtree below it, if it was
+ * a tree link at all, and only that subtree is recomputed.
+ *
+ * RoutingTable is not thread-safe.
+ */
+
+#ifndef INCL_ROUTING_TABLE_H
+#define INCL_ROUTING_TABLE_H
+
+#include "FTypes.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace IHMC_ACI
+{
+    class RoutingTable
+    {
+        public:
+            explicit RoutingTable (const char *pszLocalNodeId);
+            ~RoutingTable (void);
+
+            // Adding a link that is already in the table has no effect.  If bUpdateRoutes
+            // is false, the routes are not updated until updateRoutes() is called.
+            void addLink (const char *pszSrcNodeId, const char *pszDstNodeId, bool bUpdateRoutes = true);
+            void removeLink (const char *pszSrcNodeId, const char *pszDstNodeId);
+            void removeAllLinksFromNode (const char *pszNodeId);
+            void removeAllLinks (void);
+
+            // Recomputes all the routes from scratch
+            void updateRoutes (void);
+
+            // Returns the first hop on a shortest route to pszDstNodeId, or
+            // nullptr if pszDstNodeId is unreachable or it is the local node.
+            const char * getNextHop (const char *pszDstNodeId) const;
+
+            // Returns the number of hops to pszDstNodeId, or a negative
+            // value if pszDstNodeId is unreachable
+            int getHopCount (const char *pszDstNodeId) const;
+
+            // Returns true if pszNodeId is either the local node, pszDstNodeId, or an
+            // intermediate hop of the route to pszDstNodeId.  If pszDstNodeId is not
+            // reachable, only pszDstNodeId itself is on its route.
+            bool isOnShortestRoute (const char *pszNodeId, const char *pszDstNodeId) const;
+
+        private:
+            static const uint32 LOCAL_NODE = 0U;   // the local node is interned first
+            static const uint32 NO_NODE = 0xFFFFFFFFU;
+            static const uint32 NO_ROUTE = 0xFFFFFFFFU;
+
+            uint32 intern (const char *pszNodeId);
+            uint32 lookup (const char *pszNodeId) const;
+            void setRoute (uint32 ui32Node, uint32 ui32Parent);
+            void propagateShorterRoutes (std::vector<uint32> &queue);
+
+        private:
+            std::unordered_map<std::string, uint32> _ids;
+            std::vector<std::string> _nodeIds;
+            std::vector<std::vector<uint32> > _outLinks;
+            std::vector<std::vector<uint32> > _inLinks;
+            std::vector<uint32> _hopCount;
+            std::vector<uint32> _parent;
+            std::vector<uint32> _nextHop;
+    };
+}
+
+#endif // INCL_ROUTING_TABLE_H
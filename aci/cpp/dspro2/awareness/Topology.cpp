@@ -59,6 +59,7 @@ Topology::Topology (const char *pszNodeId)
       _pNodeContextMgr (nullptr),
       //_graph (true,   // bDeleteElements=true,
       //        false), // bDirected
+      _routes (pszNodeId),
       _availableInterfaces (true, // bCaseSensitiveKeys
                             true, // bCloneKeys
                             true) // bDeleteKeys
@@ -140,6 +141,7 @@ int Topology::addLink (const char *pszDstPeerId, const char *pszInterface,
         pEdgeInfo->stats[0].i64LastMsgRcvdTime = getTimeInMilliseconds();
         pEdgeInfo->stats[0].type = type;
         _graph.addEdge (_nodeId, pszDstPeerId, pszInterface, pEdgeInfo);
+        _routes.addLink (_nodeId, pszDstPeerId);
 
         int rc = notifyNewNeighbor (pszDstPeerId);
         if (rc != 0) {
@@ -166,6 +168,7 @@ int Topology::addLink (const char *pszDstPeerId, const char *pszInterface,
         pEdgeInfo->stats[0].i64LastMsgRcvdTime = getTimeInMilliseconds();
         pEdgeInfo->stats[0].type = type;
         _graph.addEdge (_nodeId, pszDstPeerId, pszInterface, pEdgeInfo);
+        _routes.addLink (_nodeId, pszDstPeerId);
 
         int rc = notifyLinkChanges (pszDstPeerId);
         _m.unlock();
@@ -279,6 +282,7 @@ int Topology::addLinkInternal (const char *pszSrcPeerId, const char *pszDstPeerI
         pEdgeInfo->stats[0].type = type;
 
         int rc = _graph.addEdge (pszSrcPeerId, pszDstPeerId, pszInterface, pEdgeInfo);
+        _routes.addLink (pszSrcPeerId, pszDstPeerId);
         return rc;
     }
 
@@ -338,6 +342,7 @@ int Topology::removeAllLinksFromPeer (const char *pszPeerId)
 
     _m.lock();
     _graph.removeAllEdgesFromVertex (pszPeerId);
+    _routes.removeAllLinksFromNode (pszPeerId);
     _m.unlock();
     return 0;
 }
@@ -354,13 +359,27 @@ int Topology::replaceAllLinksForPeer (const char *pszPeerId, AdaptorId adaptorId
                     "removing all edges from peer %s\n", pszPeerId);
 
     _m.lock();
+    PtrLList<String> prevNeighbors;
+    _graph.getNeighborsList (pszPeerId, &prevNeighbors);
     _graph.removeAllEdgesFromVertex (pszPeerId);
+    StringHashset currNeighbors;
     String *pNext = neighbors.getFirst();
     for (String *pCurr; (pCurr = pNext) != nullptr;) {
         pNext = neighbors.getNext();
         addLinkInternal (pszPeerId, pCurr->c_str(), DEFAULT_INTERFACE, adaptorId, UNKNOWN);
+        currNeighbors.put (pCurr->c_str());
         delete neighbors.remove (pCurr);
     }
+    // Links that are still there were not removed from the routes, so that
+    // only the routes through the links that disappeared need to be updated
+    pNext = prevNeighbors.getFirst();
+    for (String *pCurr; (pCurr = pNext) != nullptr;) {
+        pNext = prevNeighbors.getNext();
+        if (!currNeighbors.containsKey (pCurr->c_str())) {
+            _routes.removeLink (pszPeerId, pCurr->c_str());
+        }
+        delete prevNeighbors.remove (pCurr);
+    }
     _m.unlock();
     return 0;
 }
@@ -440,11 +459,15 @@ int Topology::removeLink (const char *pszDstPeerId, const char *pszInterface, Ad
     int rc = 0;
     if (uiAdaptorCounts == 0) {
         rc = _graph.removeEdge (_nodeId, pszDstPeerId, pszInterface);
+        if (!_graph.hasNeighbor (_nodeId, pszDstPeerId)) {
+            _routes.removeLink (_nodeId, pszDstPeerId);
+        }
         PtrLList<Edge<EdgeInfo> > *pEdges = _graph.getEdgeList (pszDstPeerId);
         if ((pEdges == nullptr) || (pEdges->getFirst() == nullptr)) {
             checkAndLogMsg ("Topology::removeLink", Logger::L_Info, "removed link %s to peer %s. "
                             "It was the only link. Removing peer.\n", pszInterface, pszDstPeerId);
             _graph.deleteElements (_nodeId, _TOPOLOGY_SIZE);
+            rebuildRoutes();
             rc = notifyLinkChanges (pszDstPeerId);
         }
         delete pEdges;
@@ -546,6 +569,7 @@ int Topology::topologyRequestArrived (const char * pszSenderNodeId, const void *
 
     _graph.deletePartitions (_nodeId);
     _graph.deleteElements (_nodeId, _TOPOLOGY_SIZE);
+    rebuildRoutes();
     pUpdates = _graph.getVertexKeys(); // check if the graph is now complete
     bFlag = true;
     char *pszUpNode = (char *) pUpdates->getFirst();
@@ -713,6 +737,7 @@ int Topology::topologyReplyArrived (const char *pszSenderNodeId, const void *pBu
     }
     _graph.deletePartitions (_nodeId);
     _graph.deleteElements (_nodeId, _TOPOLOGY_SIZE);
+    rebuildRoutes();
     pUpdates = _graph.getVertexKeys(); // check if the graph is now complete
     flag = true;
     char *pszUpNode = (char *) pUpdates->getFirst();
@@ -906,16 +931,9 @@ bool Topology::isOnShortestRoute (const char *pszNodeId, const char *pszDstPeerI
         Targets::deallocateTargets (ppTargets);
     }
     else if (_graph.hasVertex (pszDstPeerId)) {
-        PtrLList<const char> path;
-        _graph.getShortestPath (_nodeId, pszDstPeerId, &path, false);
-        for (const char *pszCurr = path.getFirst(); pszCurr != nullptr; pszCurr = path.getNext()) {
-            if (strcmp (pszNodeId, pszCurr) == 0) {
-                _m.unlock();
-                path.removeAll (true);
-                return true;
-            }
-        }
-        path.removeAll (true);
+        const bool bOnRoute = _routes.isOnShortestRoute (pszNodeId, pszDstPeerId);
+        _m.unlock();
+        return bOnRoute;
     }
 
     _m.unlock();
@@ -1205,29 +1223,14 @@ Targets * Topology::getNextHopAsTarget (const char *pszDstPeerId)
 
 Targets * Topology::getNextHopAsTargetInternal (const char *pszDstPeerId)
 {
-    Targets **ppTargets = nullptr;
-    if (_graph.hasNeighbor (_nodeId, pszDstPeerId)) {
-        PtrLList<Edge<EdgeInfo> > edgeList;
-        _graph.getEdgeList (_nodeId, pszDstPeerId, &edgeList);
-        ppTargets = getNodesAsTargets (&edgeList);
-    }
-    else if (_graph.hasVertex (pszDstPeerId)) {
-        PtrLList<Edge<EdgeInfo> > edgeList;
-        PtrLList<const char> path;
-        _graph.getShortestPath (_nodeId, pszDstPeerId, &path, false);
-        // Get the next hop
-        const char *pszCurr = path.getFirst();
-        // Find the first peer that it's not myself
-        while ((pszCurr != nullptr) && (strcmp (_nodeId, pszCurr) == 0)) {
-            pszCurr = path.getNext();
-        }
-        path.removeAll (true);
-        if (pszCurr == nullptr) {
-            return nullptr;
-        }
-        _graph.getEdgeList (_nodeId, pszCurr, &edgeList);
-        ppTargets = getNodesAsTargets (&edgeList);
+    // The next hop toward a neighbor is the neighbor itself
+    const char *pszNextHop = _routes.getNextHop (pszDstPeerId);
+    if (pszNextHop == nullptr) {
+        return nullptr;
     }
+    PtrLList<Edge<EdgeInfo> > edgeList;
+    _graph.getEdgeList (_nodeId, pszNextHop, &edgeList);
+    Targets **ppTargets = getNodesAsTargets (&edgeList);
 
     // Sanity check
     if (ppTargets != nullptr) {
@@ -1241,6 +1244,25 @@ Targets * Topology::getNextHopAsTargetInternal (const char *pszDstPeerId)
     return nullptr;
 }
 
+void Topology::rebuildRoutes (void)
+{
+    _routes.removeAllLinks();
+    PtrLList<const char> *pVertexKeys = _graph.getVertexKeys();
+    if (pVertexKeys != nullptr) {
+        for (const char *pszKey = pVertexKeys->getFirst(); pszKey != nullptr; pszKey = pVertexKeys->getNext()) {
+            PtrLList<Edge<EdgeInfo> > *pEdges = _graph.getEdgeList (pszKey);
+            if (pEdges != nullptr) {
+                for (Edge<EdgeInfo> *pEdge = pEdges->getFirst(); pEdge != nullptr; pEdge = pEdges->getNext()) {
+                    _routes.addLink (pszKey, pEdge->_pszDstVertexKey, false);
+                }
+                delete pEdges;
+            }
+        }
+        delete pVertexKeys;
+    }
+    _routes.updateRoutes();
+}
+
 Targets ** Topology::getForwardingTargets (const char *pszCurrPeerId,
                                            const char *pszPrevPeerId)
 {
@@ -1476,7 +1498,7 @@ Targets ** Topology::getNodesAsTargets (PtrLList<Edge<Topology::EdgeInfo> > *pEd
         }
     }
     free (pppEdgeTable);
-    delete pTableCount;
+    delete[] pTableCount;
 
     return ppTargets;
 }
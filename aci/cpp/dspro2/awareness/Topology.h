@@ -24,6 +24,7 @@
 
 #include "CommAdaptor.h"
 #include "NodeIdSet.h"
+#include "RoutingTable.h"
 #include "Targets.h"
 
 #include "DArray2.h"
@@ -152,6 +153,8 @@ namespace IHMC_ACI
             CommAdaptorManager *_pAdaptorMgr;
             NodeContextManager *_pNodeContextMgr;
             NOMADSUtil::HTGraph<NodeInfo, EdgeInfo> _graph;
+            // Next hops toward the nodes in _graph, kept in sync with its links
+            RoutingTable _routes;
             NOMADSUtil::Mutex _m;
             NOMADSUtil::StringHashset _availableInterfaces;
 
@@ -166,6 +169,9 @@ namespace IHMC_ACI
             Targets ** getForwardingTargetsInternal (const char *pszCurrPeerId, const char *pszPrevPeerId);
             Targets ** getNodesAsTargets (NOMADSUtil::PtrLList<NOMADSUtil::Edge<EdgeInfo> > *pEdgeList);
             Targets * getNextHopAsTargetInternal (const char *pszDstPeerId);
+            // Reloads all the links of _graph in _routes, after changes of the
+            // graph that can not be tracked link by link (e.g., pruned vertices)
+            void rebuildRoutes (void);
     };
 
     class StaticTopology : public Topology
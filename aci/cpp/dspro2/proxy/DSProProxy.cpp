@@ -29,7 +29,9 @@
 #include "Listener.h"
 
 #include "AVList.h"
+#include "BufferReader.h"
 #include "Logger.h"
+#include "PipelinedRpc.h"
 #include "PtrLList.h"
 
 #ifdef WIN32
@@ -200,14 +202,59 @@ namespace IHMC_ACI_DSPRO_PROXY
 
         return 0;
     }
+
+    // Marshallers of the pipelined RPC requests, that write the data of the
+    // messages directly into the frames
+    struct RpcAddMessageArgs
+    {
+        const char *pszGroupName;
+        DSProProxy::Message msg;
+    };
+
+    int marshalAddMessage (const void *pArg, Writer *pWriter)
+    {
+        const RpcAddMessageArgs *pArgs = static_cast<const RpcAddMessageArgs *> (pArg);
+        const DSProProxy::Message &msg = pArgs->msg;
+        if ((pWriter->writeString (pArgs->pszGroupName) < 0) ||
+            (DSProProxyUnmarshaller::writeMessage (pWriter, msg.pszObjectId, msg.pszInstanceId, msg.pszJsonMetadata,
+                                                   msg.pData, msg.ui32DataLen, msg.i64ExpirationTime) < 0)) {
+            return -1;
+        }
+        return 0;
+    }
+
+    struct RpcAddMessagesArgs
+    {
+        const char *pszGroupName;
+        const DSProProxy::Message *pMessages;
+        uint32 ui32Count;
+    };
+
+    int marshalAddMessages (const void *pArg, Writer *pWriter)
+    {
+        const RpcAddMessagesArgs *pArgs = static_cast<const RpcAddMessagesArgs *> (pArg);
+        uint32 ui32Count = pArgs->ui32Count;
+        if ((pWriter->writeString (pArgs->pszGroupName) < 0) || (pWriter->write32 (&ui32Count) < 0)) {
+            return -1;
+        }
+        for (uint32 i = 0; i < ui32Count; i++) {
+            const DSProProxy::Message &msg = pArgs->pMessages[i];
+            if (DSProProxyUnmarshaller::writeMessage (pWriter, msg.pszObjectId, msg.pszInstanceId, msg.pszJsonMetadata,
+                                                      msg.pData, msg.ui32DataLen, msg.i64ExpirationTime) < 0) {
+                return -2;
+            }
+        }
+        return 0;
+    }
 }
 
 using namespace IHMC_ACI_DSPRO_PROXY;
 
-DSProProxy::DSProProxy (uint16 ui16DesiredApplicationId, bool bUseBackgroundReconnect)
+DSProProxy::DSProProxy (uint16 ui16DesiredApplicationId, bool bUseBackgroundReconnect, bool bUsePipelinedRpc,
+                        bool bUseSharedMemory)
     : Stub (ui16DesiredApplicationId, &DSProProxyUnmarshaller::methodArrived,
             DSProProxyUnmarshaller::SERVICE, DSProProxyUnmarshaller::VERSION,
-            bUseBackgroundReconnect),
+            bUseBackgroundReconnect, bUsePipelinedRpc, bUseSharedMemory),
       _dSProListeners (false),
       _matchmakingLogListeners (false),
       _searchListeners (false)
@@ -856,12 +903,135 @@ int DSProProxy::addMessage (const char* pszGroupName, const char* pszObjectId, c
     if ((pszGroupName == nullptr) || (pszJsonMetadata == nullptr) || (pData == nullptr) || (ui32DataLen == 0)) {
         return -1;
     }
+    const uint32 ui32RequestId = addMessageAsync (pszGroupName, pszObjectId, pszInstanceId, pszJsonMetadata,
+                                                  pData, ui32DataLen, i64ExpirationTime);
+    if (ui32RequestId != 0U) {
+        return waitForAddedMessage (ui32RequestId, ppszId);
+    }
+    // The pipelined RPC connection may not be open, or the message may not
+    // fit in the shared memory ring: use the text protocol
+    synchronized (&_stubMutex);
     XMLMetadataWriterFn writeMetadata (pszJsonMetadata);
     return addOrChunkAndAddMessage (DSProProxyUnmarshaller::ADD_MESSAGE, _pCommHelper,
                                     pszObjectId, pszInstanceId, pszGroupName, &writeMetadata, pData, ui32DataLen,
                                     nullptr, i64ExpirationTime, ppszId);
 }
 
+int DSProProxy::addMessages (const char *pszGroupName, Message *pMessages, unsigned int uiCount)
+{
+    if ((pszGroupName == nullptr) || ((pMessages == nullptr) && (uiCount > 0))) {
+        return -1;
+    }
+    for (unsigned int i = 0; i < uiCount; i++) {
+        pMessages[i].rc = -1;
+        pMessages[i].pszId = nullptr;
+    }
+    PipelinedRpcClient *pRpcClient = getRpcClient();
+    if ((pRpcClient == nullptr) || !pRpcClient->isConnected()) {
+        if (pRpcClient != nullptr) {
+            pRpcClient->release();
+        }
+        addMessagesOneAtATime (pszGroupName, pMessages, uiCount);
+        return 0;
+    }
+
+    RpcAddMessagesArgs args;
+    args.pszGroupName = pszGroupName;
+    args.pMessages = pMessages;
+    args.ui32Count = uiCount;
+    const uint32 ui32Count = uiCount;
+    BufferReader *pResponse = nullptr;
+    // The reference keeps the client alive, without holding _stubMutex while waiting
+    int rc = pRpcClient->call (DSProProxyUnmarshaller::RPC_ADD_MESSAGES, &marshalAddMessages, &args, &pResponse);
+    pRpcClient->release();
+    if (rc == -4) {
+        // The batch does not fit in a request: split it in two.  A single
+        // message that does not fit either is sent by addMessage(), that
+        // falls back to the text protocol
+        if (uiCount == 1) {
+            addMessagesOneAtATime (pszGroupName, pMessages, uiCount);
+            return 0;
+        }
+        const unsigned int uiFirstHalf = uiCount / 2;
+        const int rcFirstHalf = addMessages (pszGroupName, pMessages, uiFirstHalf);
+        const int rcSecondHalf = addMessages (pszGroupName, pMessages + uiFirstHalf, uiCount - uiFirstHalf);
+        return (rcFirstHalf < 0 ? rcFirstHalf : rcSecondHalf);
+    }
+    if (rc < 0) {
+        return -3;
+    }
+    uint32 ui32Replies = 0U;
+    rc = ((pResponse->read32 (&ui32Replies) < 0) || (ui32Replies != ui32Count) ? -4 : 0);
+    for (unsigned int i = 0; (i < uiCount) && (rc == 0); i++) {
+        int32 i32Rc = 0;
+        if ((pResponse->read32 (&i32Rc) < 0) || (pResponse->readString (&pMessages[i].pszId) < 0)) {
+            rc = -4;
+        }
+        else {
+            pMessages[i].rc = i32Rc;
+        }
+    }
+    delete pResponse;
+    return rc;
+}
+
+void DSProProxy::addMessagesOneAtATime (const char *pszGroupName, Message *pMessages, unsigned int uiCount)
+{
+    for (unsigned int i = 0; i < uiCount; i++) {
+        Message &msg = pMessages[i];
+        msg.rc = addMessage (pszGroupName, msg.pszObjectId, msg.pszInstanceId, msg.pszJsonMetadata,
+                             msg.pData, msg.ui32DataLen, msg.i64ExpirationTime, &msg.pszId);
+    }
+}
+
+uint32 DSProProxy::addMessageAsync (const char *pszGroupName, const char *pszObjectId, const char *pszInstanceId,
+                                    const char *pszJsonMetadata, const void *pData, uint32 ui32DataLen,
+                                    int64 i64ExpirationTime)
+{
+    if ((pszGroupName == nullptr) || (pszJsonMetadata == nullptr) || (pData == nullptr) || (ui32DataLen == 0)) {
+        return 0U;
+    }
+    PipelinedRpcClient *pRpcClient = getRpcClient();
+    if (pRpcClient == nullptr) {
+        return 0U;
+    }
+    RpcAddMessageArgs args;
+    args.pszGroupName = pszGroupName;
+    args.msg.pszObjectId = pszObjectId;
+    args.msg.pszInstanceId = pszInstanceId;
+    args.msg.pszJsonMetadata = pszJsonMetadata;
+    args.msg.pData = pData;
+    args.msg.ui32DataLen = ui32DataLen;
+    args.msg.i64ExpirationTime = i64ExpirationTime;
+    const uint32 ui32RequestId = pRpcClient->send (DSProProxyUnmarshaller::RPC_ADD_MESSAGE, &marshalAddMessage, &args);
+    pRpcClient->release();
+    return ui32RequestId;
+}
+
+int DSProProxy::waitForAddedMessage (uint32 ui32RequestId, char **ppszId)
+{
+    PipelinedRpcClient *pRpcClient = getRpcClient();
+    if (pRpcClient == nullptr) {
+        return -1;
+    }
+    BufferReader *pResponse = nullptr;
+    const int rcWait = pRpcClient->wait (ui32RequestId, &pResponse);
+    pRpcClient->release();
+    if (rcWait < 0) {
+        return -2;
+    }
+    char *pszId = nullptr;
+    const int rc = (pResponse->readString (&pszId) < 0 ? -3 : 0);
+    delete pResponse;
+    if (ppszId != nullptr) {
+        *ppszId = pszId;
+    }
+    else {
+        free (pszId);
+    }
+    return rc;
+}
+
 int DSProProxy::addMessage (const char* pszGroupName, const char* pszObjectId, const char* pszInstanceId, AVList* pMetadataAttrList,
                             const void* pData, uint32 ui32DataLen, int64 i64ExpirationTime, char** ppszId)
 {
@@ -49,7 +49,13 @@ namespace IHMC_ACI
     class DSProProxy : public NOMADSUtil::Stub, public DSProInterface
     {
         public:
-            explicit DSProProxy (uint16 ui16DesiredApplicationId, bool bUseBackgroundReconnect = false);
+            // If bUsePipelinedRpc is set, addMessage() (with JSON metadata), addMessages(),
+            // and addMessageAsync() use the pipelined binary protocol, that must be
+            // supported by the proxy server.
+            // If bUseSharedMemory is also set, a proxy server running on the same host
+            // receives these calls through shared memory instead of the TCP connection
+            explicit DSProProxy (uint16 ui16DesiredApplicationId, bool bUseBackgroundReconnect = false,
+                                 bool bUsePipelinedRpc = false, bool bUseSharedMemory = false);
             virtual ~DSProProxy (void);
 
             int subscribe (const char *pszGroupName, uint8 ui8Priority, bool bGroupReliable, bool bMsgReliable, bool bSequenced);
@@ -131,6 +137,43 @@ namespace IHMC_ACI
             int volatileSearchReply (const char* pszQueryId, const void* pReply, uint16 ui162ReplyLen);
             int addMessage (const char* pszGroupName, const char* pszObjectId, const char* pszInstanceId, const char* pszJsonMetadata, const void* pData, uint32 ui32DataLen, int64 i64ExpirationTime, char** ppszId);
             int addMessage (const char* pszGroupName, const char* pszObjectId, const char* pszInstanceId, NOMADSUtil::AVList* pMetadataAttrList, const void* pData, uint32 ui32DataLen, int64 i64ExpirationTime, char** ppszId);
+
+            struct Message
+            {
+                const char *pszObjectId;
+                const char *pszInstanceId;
+                const char *pszJsonMetadata;
+                const void *pData;
+                uint32 ui32DataLen;
+                int64 i64ExpirationTime;
+
+                // Set by addMessages(): the result of the addition, and the ID
+                // assigned to the message (it must be deallocated by the caller)
+                int rc;
+                char *pszId;
+            };
+
+            /**
+             * Adds uiCount messages to pszGroupName.  With the pipelined binary
+             * protocol, all the messages are sent in a single request, otherwise
+             * addMessage() is invoked for each of them.  A batch that is too large
+             * for the connection (a shared memory channel only takes requests up
+             * to half of its ring) is split into smaller requests.
+             * Returns 0 if the request was executed (the result of each message is
+             * set in its rc field), or a negative number otherwise.
+             */
+            int addMessages (const char *pszGroupName, Message *pMessages, unsigned int uiCount);
+
+            /**
+             * Sends a message without waiting for the reply, that is retrieved by
+             * passing the returned request ID to waitForAddedMessage().
+             * Returns 0 if the message could not be sent, or if the pipelined binary
+             * protocol is not available.
+             */
+            uint32 addMessageAsync (const char *pszGroupName, const char *pszObjectId, const char *pszInstanceId,
+                                    const char *pszJsonMetadata, const void *pData, uint32 ui32DataLen,
+                                    int64 i64ExpirationTime);
+            int waitForAddedMessage (uint32 ui32RequestId, char **ppszId);
             int chunkAndAddMessage (const char* pszGroupName, const char* pszObjectId, const char* pszInstanceId, const char* pszJsonMetadata, const void* pData, uint32 ui32DataLen, const char* pszDataMimeType, int64 i64ExpirationTime, char** ppszId);
             int chunkAndAddMessage (const char* pszGroupName, const char* pszObjectId, const char* pszInstanceId, NOMADSUtil::AVList *pMetadataAttrList, const void* pData, uint32 ui32DataLen, const char* pszDataMimeType, int64 i64ExpirationTime, char** ppszId);
             int disseminateMessage (const char* pszGroupName, const char* pszObjectId, const char* pszInstanceId, const void *pData, uint32 ui32DataLen, int64 i64ExpirationTime, char **ppszId);
@@ -176,6 +219,9 @@ namespace IHMC_ACI
                                             uint16 ui162ReplyLen, const char *pszMatchingNodeId);
 
         private:
+            // Adds the messages of an addMessages() request one at a time
+            void addMessagesOneAtATime (const char *pszGroupName, Message *pMessages, unsigned int uiCount);
+
             NOMADSUtil::UInt32Hashtable<DSProListener> _dSProListeners;
             NOMADSUtil::UInt32Hashtable<MatchmakingLogListener> _matchmakingLogListeners;
             NOMADSUtil::UInt32Hashtable<SearchListener> _searchListeners;
@@ -36,6 +36,7 @@
 #include "BufferReader.h"
 #include "Json.h"
 #include "Logger.h"
+#include "PipelinedRpc.h"
 #include "Writer.h"
 #include "ConfigManager.h"
 #include "ControlMessageNotifier.h"
@@ -147,6 +148,7 @@ DSProProxyAdaptor::DSProProxyAdaptor (DSProProxyServer *pDSPProxyServer)
     _pDisSvcProProxyServer = pDSPProxyServer;
     _pCommHelper = nullptr;
     _pCallbackCommHelper = nullptr;
+    _pRpcServer = nullptr;
     _ui16ClientID = 0;
     _bListenerProRegistered = false;
     _bMatchmakingLogListenerRegistered = false;
@@ -191,6 +193,11 @@ DSProProxyAdaptor::~DSProProxyAdaptor (void)
     _pDisSvcProProxyServer->_proxies.remove (szId);
 
     // Close connections
+    if (_pRpcServer != nullptr) {
+        // Waits for the request being served, if any
+        delete _pRpcServer;
+        _pRpcServer = nullptr;
+    }
     if (_pCommHelper != nullptr) {
         CommHelperError error;
         _pCommHelper->closeConnection (error);
@@ -234,6 +241,15 @@ void DSProProxyAdaptor::setCallbackCommHelper (SimpleCommHelper2 *pCommHelper)
     _pCallbackCommHelper = pCommHelper;
 }
 
+void DSProProxyAdaptor::setRpcChannel (RpcChannel *pChannel)
+{
+    if (_pRpcServer != nullptr) {
+        delete _pRpcServer;
+    }
+    _pRpcServer = new PipelinedRpcServer (pChannel, &DSProProxyUnmarshaller::rpcMethodInvoked, _pDSPro);
+    _pRpcServer->start();
+}
+
 void DSProProxyAdaptor::run (void)
 {
     started();
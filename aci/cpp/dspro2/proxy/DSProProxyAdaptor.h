@@ -35,6 +35,8 @@
 namespace NOMADSUtil
 {
     class Logger;
+    class PipelinedRpcServer;
+    class RpcChannel;
     class Reader;
 }
 
@@ -64,6 +66,10 @@ namespace IHMC_ACI
 
             void setCallbackCommHelper (NOMADSUtil::SimpleCommHelper2 *pCommHelper);
 
+            // Serves the pipelined binary protocol on pChannel, in addition
+            // to the text protocol served by run()
+            void setRpcChannel (NOMADSUtil::RpcChannel *pChannel);
+
             uint16 getClientID (void);
 
             void run (void);
@@ -228,6 +234,7 @@ namespace IHMC_ACI
             DSProProxyServer *_pDisSvcProProxyServer;
             NOMADSUtil::SimpleCommHelper2 *_pCommHelper;
             NOMADSUtil::SimpleCommHelper2 *_pCallbackCommHelper;
+            NOMADSUtil::PipelinedRpcServer *_pRpcServer;
             uint16 _ui16ClientID;
             uint16 _ui16PathRegisteredCbackClientId;
             uint16 _ui16CtrlMsgCbackClientId;
@@ -26,6 +26,8 @@
 
 #include "SimpleCommHelper2.h"
 #include "Logger.h"
+#include "PipelinedRpc.h"
+#include "ShmRpcChannel.h"
 #include "TCPSocket.h"
 
 using namespace NOMADSUtil;
@@ -177,6 +179,16 @@ void DSPProxyServerConnHandler::run()
             else if (0 == stricmp (ppszBuf[0], "RegisterProxyCallback")) {
                 error = doRegisterProxyCallback (_pCommHelper, atoi (ppszBuf[1]));
             }
+            else if (0 == stricmp (ppszBuf[0], PipelinedRpc::REGISTER_PROXY_RPC.c_str())) {
+                error = doRegisterProxyRpc (_pCommHelper, atoi (ppszBuf[1]));
+            }
+            else if (0 == stricmp (ppszBuf[0], ShmRpcChannel::REGISTER_PROXY_SHM.c_str())) {
+                error = doRegisterProxyShm (_pCommHelper, atoi (ppszBuf[1]));
+            }
+            else {
+                checkAndLogMsg (pszMethodName, Logger::L_Warning, "unknown registration command <%s>.\n", ppszBuf[0]);
+                error = SimpleCommHelper2::ProtocolError;
+            }
         }
 
         switch (error) {
@@ -292,3 +304,59 @@ CommHelperError DSPProxyServerConnHandler::doRegisterProxyCallback (SimpleCommHe
     return error;
 }
 
+CommHelperError DSPProxyServerConnHandler::doRegisterProxyRpc (SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationId)
+{
+    char szProxyId[10];
+    sprintf (szProxyId, "%d", ui16ApplicationId);
+    CommHelperError error = SimpleCommHelper2::None;
+
+    DSProProxyAdaptor *pAdaptor = _pDisSvcProProxyServer->_proxies.get (szProxyId);
+
+    if (pAdaptor != nullptr) {
+        pCommHelper->sendLine (error, "OK");
+        if (error == SimpleCommHelper2::None) {
+            // From now on, the connection carries binary frames
+            pAdaptor->setRpcChannel (new TCPRpcChannel (pCommHelper));
+        }
+    }
+    else {
+        checkAndLogMsg ("DSPProxyServerConnHandler::doRegisterProxyRpc", Logger::L_MildError,
+                        "did not find proxy with id %d to register an RPC handler\n", (int) ui16ApplicationId);
+        pCommHelper->sendLine (error, "ERROR: proxy with id %d not found", ui16ApplicationId);
+        // The connection is closed by the caller
+        error = SimpleCommHelper2::ProtocolError;
+    }
+
+    return error;
+}
+
+CommHelperError DSPProxyServerConnHandler::doRegisterProxyShm (SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationId)
+{
+    char szProxyId[10];
+    sprintf (szProxyId, "%d", ui16ApplicationId);
+    CommHelperError error = SimpleCommHelper2::None;
+
+    DSProProxyAdaptor *pAdaptor = _pDisSvcProProxyServer->_proxies.get (szProxyId);
+    ShmRpcChannel *pChannel = (pAdaptor == nullptr ? nullptr : ShmRpcChannel::accept (pCommHelper));
+
+    if (pChannel != nullptr) {
+        // From now on, pCommHelper belongs to the channel
+        pCommHelper->sendLine (error, "OK");
+        if (error == SimpleCommHelper2::None) {
+            pAdaptor->setRpcChannel (pChannel);
+        }
+        else {
+            delete pChannel;
+            error = SimpleCommHelper2::None;
+        }
+    }
+    else {
+        checkAndLogMsg ("DSPProxyServerConnHandler::doRegisterProxyShm", Logger::L_Info,
+                        "could not open a shared memory channel for proxy with id %d\n", (int) ui16ApplicationId);
+        // The client falls back on the TCP connection
+        pCommHelper->sendLine (error, "ERROR: shared memory not available for proxy with id %d", ui16ApplicationId);
+        error = SimpleCommHelper2::ProtocolError;
+    }
+
+    return error;
+}
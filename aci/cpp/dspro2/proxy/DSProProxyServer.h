@@ -91,6 +91,8 @@ namespace IHMC_ACI
             CommHelperError doHandshake (NOMADSUtil::SimpleCommHelper2 *pCommHelper, bool bStrict);
             CommHelperError doRegisterProxy (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
             CommHelperError doRegisterProxyCallback (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
+            CommHelperError doRegisterProxyRpc (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
+            CommHelperError doRegisterProxyShm (NOMADSUtil::SimpleCommHelper2 *pCommHelper, uint16 ui16ApplicationID);
 
         private:
             const bool _bStrictHandshake;
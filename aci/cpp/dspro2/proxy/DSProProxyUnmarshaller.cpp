@@ -20,10 +20,12 @@
  */
 
 #include "DSProProxyUnmarshaller.h"
+#include "DSPro.h"
 #include "DSProProxy.h"
 #include "NodePath.h"
 
 #include <DArray2.h>
+#include "PipelinedRpc.h"
 
 using namespace IHMC_ACI;
 using namespace IHMC_VOI;
@@ -110,6 +112,113 @@ namespace IHMC_ACI_DSPRO_PROXY_UNMARSHALLER
         return false;
     }
 
+    //-------------------------------------------------------------------------
+    // Pipelined RPC
+    //-------------------------------------------------------------------------
+
+    struct RpcMessage
+    {
+        RpcMessage (void)
+            : pszObjectId (nullptr), pszInstanceId (nullptr), pszJsonMetadata (nullptr),
+              pData (nullptr), ui32DataLen (0U), i64ExpirationTime (0) {}
+
+        ~RpcMessage (void)
+        {
+            free (pszObjectId);
+            free (pszInstanceId);
+            free (pszJsonMetadata);
+        }
+
+        // Reads the fields written by DSProProxyUnmarshaller::writeMessage().
+        // The data is not copied: pData points into the request frame
+        int read (Reader * pReader)
+        {
+            if ((pReader->readString (&pszObjectId) < 0) || (pReader->readString (&pszInstanceId) < 0) ||
+                (pReader->readString (&pszJsonMetadata) < 0)) {
+                return -1;
+            }
+            if ((pReader->read32 (&ui32DataLen) < 0) || (ui32DataLen > PipelinedRpc::MAX_PAYLOAD_LEN)) {
+                return -2;
+            }
+            if ((ui32DataLen > 0) && (nullptr == (pData = PipelinedRpc::readInPlace (pReader, ui32DataLen)))) {
+                return -3;
+            }
+            if (pReader->read64 (&i64ExpirationTime) < 0) {
+                return -4;
+            }
+            return 0;
+        }
+
+        int add (DSPro * pDSPro, const char * pszGroupName, char ** ppszId)
+        {
+            *ppszId = nullptr;
+            if ((pszJsonMetadata == nullptr) || (pData == nullptr)) {
+                return -1;
+            }
+            const int rc = pDSPro->addMessage (pszGroupName, pszObjectId, pszInstanceId, pszJsonMetadata,
+                                               pData, ui32DataLen, i64ExpirationTime, ppszId);
+            return ((rc == 0) && (*ppszId == nullptr) ? -2 : rc);
+        }
+
+        char *pszObjectId;
+        char *pszInstanceId;
+        char *pszJsonMetadata;
+        const void *pData;
+        uint32 ui32DataLen;
+        int64 i64ExpirationTime;
+    };
+
+    int doRpcAddMessage (DSPro * pDSPro, Reader * pRequest, Writer * pResponse)
+    {
+        char *pszGroupName = nullptr;
+        RpcMessage msg;
+        if ((pRequest->readString (&pszGroupName) < 0) || (pszGroupName == nullptr) || (msg.read (pRequest) < 0)) {
+            free (pszGroupName);
+            return -1;
+        }
+        char *pszId = nullptr;
+        int rc = msg.add (pDSPro, pszGroupName, &pszId);
+        if ((rc == 0) && (pResponse->writeString (pszId) < 0)) {
+            rc = -3;
+        }
+        free (pszGroupName);
+        free (pszId);
+        return (rc == 0 ? 0 : -2);
+    }
+
+    int doRpcAddMessages (DSPro * pDSPro, Reader * pRequest, Writer * pResponse)
+    {
+        char *pszGroupName = nullptr;
+        uint32 ui32Count = 0U;
+        if ((pRequest->readString (&pszGroupName) < 0) || (pszGroupName == nullptr) ||
+            (pRequest->read32 (&ui32Count) < 0)) {
+            free (pszGroupName);
+            return -1;
+        }
+        // Each message succeeds or fails independently: the status of each one is
+        // returned along with its id
+        if (pResponse->write32 (&ui32Count) < 0) {
+            free (pszGroupName);
+            return -2;
+        }
+        int rc = 0;
+        for (uint32 i = 0; (i < ui32Count) && (rc == 0); i++) {
+            RpcMessage msg;
+            if (msg.read (pRequest) < 0) {
+                rc = -1;
+                break;
+            }
+            char *pszId = nullptr;
+            int32 i32Rc = msg.add (pDSPro, pszGroupName, &pszId);
+            if ((pResponse->write32 (&i32Rc) < 0) || (pResponse->writeString (pszId) < 0)) {
+                rc = -2;
+            }
+            free (pszId);
+        }
+        free (pszGroupName);
+        return rc;
+    }
+
     //-------------------------------------------------------------------------
     // Callbacks
     //-------------------------------------------------------------------------
@@ -399,6 +508,40 @@ bool DSProProxyUnmarshaller::methodArrived (uint16 ui16ClientId, const NOMADSUti
     return doMethodArrived (ui16ClientId, methodName, static_cast<DSProProxy *> (pDSProProxy), pCommHelper);
 }
 
+int DSProProxyUnmarshaller::rpcMethodInvoked (void * pDSPro, uint16 ui16Method, Reader * pRequest, Writer * pResponse)
+{
+    switch (ui16Method) {
+        case RPC_PING:
+            return 0;
+
+        case RPC_ADD_MESSAGE:
+            return doRpcAddMessage (static_cast<DSPro *>(pDSPro), pRequest, pResponse);
+
+        case RPC_ADD_MESSAGES:
+            return doRpcAddMessages (static_cast<DSPro *>(pDSPro), pRequest, pResponse);
+
+        default:
+            return -1;
+    }
+}
+
+int DSProProxyUnmarshaller::writeMessage (Writer * pWriter, const char * pszObjectId, const char * pszInstanceId,
+                                          const char * pszJsonMetadata, const void * pData, uint32 ui32DataLen,
+                                          int64 i64ExpirationTime)
+{
+    if ((pWriter->writeString (pszObjectId) < 0) || (pWriter->writeString (pszInstanceId) < 0) ||
+        (pWriter->writeString (pszJsonMetadata) < 0)) {
+        return -1;
+    }
+    if ((pWriter->write32 (&ui32DataLen) < 0) || ((ui32DataLen > 0) && (pWriter->writeBytes (pData, ui32DataLen) < 0))) {
+        return -2;
+    }
+    if (pWriter->write64 (&i64ExpirationTime) < 0) {
+        return -3;
+    }
+    return 0;
+}
+
 NodePath * DSProProxyUnmarshaller::readNodePath (Reader * pReader)
 {
     if (pReader == nullptr) {
@@ -107,6 +107,11 @@ namespace IHMC_ACI
             static const NOMADSUtil::String SEARCH_REPLY_ARRIVED;
             static const NOMADSUtil::String VOLATILE_SEARCH_REPLY_ARRIVED;
 
+            // Methods of the pipelined binary protocol (see PipelinedRpc.h)
+            static const uint16 RPC_PING = 0x01;
+            static const uint16 RPC_ADD_MESSAGE = 0x02;
+            static const uint16 RPC_ADD_MESSAGES = 0x03;
+
             static bool methodInvoked (uint16 ui16ClientId, const NOMADSUtil::String & methodName,
                                        void * pDSPro, NOMADSUtil::SimpleCommHelper2 * pCommHelper,
                                        NOMADSUtil::SimpleCommHelper2::Error & error);
@@ -114,6 +119,15 @@ namespace IHMC_ACI
             static bool methodArrived (uint16 ui16ClientId, const NOMADSUtil::String & methodName,
                                        NOMADSUtil::Stub * pDSProProxy, NOMADSUtil::SimpleCommHelper2 * pCommHelper);
 
+            static int rpcMethodInvoked (void * pDSPro, uint16 ui16Method, NOMADSUtil::Reader * pRequest,
+                                         NOMADSUtil::Writer * pResponse);
+
+            // Writes the arguments of addMessage() that follow the group name, in the
+            // format expected by RPC_ADD_MESSAGE and RPC_ADD_MESSAGES
+            static int writeMessage (NOMADSUtil::Writer * pWriter, const char * pszObjectId, const char * pszInstanceId,
+                                     const char * pszJsonMetadata, const void * pData, uint32 ui32DataLen,
+                                     int64 i64ExpirationTime);
+
             static IHMC_VOI::NodePath * readNodePath (NOMADSUtil::Reader * pReader);
             static int write (IHMC_VOI::NodePath * pPath, NOMADSUtil::Writer * pWriter);
     };
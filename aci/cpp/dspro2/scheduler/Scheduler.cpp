@@ -381,8 +381,8 @@ void Scheduler::startNewPreStagingForPeer (const char *pszTargetNodeId, Ranks *p
         // only removes relatively unimportant messages. Look at SchedulerPolicies
         // for more information on how the importance is evaluated), therefore,
         // it must be ensured not to add duplicate elements.
-        // SetUniquePtrLList does not add duplicates to the list and
-        // AUTOMATICALLY DEALLOCATES DUPLICATE ENTRIES.
+        // PeerQueue::insert() keeps only the copy of a message with the
+        // higher indexes and returns the other one, which must be deallocated.
         //
         // Furthermore, this queue is in the hashtable
         // containing all the queues, therefore it has to be locked
@@ -466,6 +466,12 @@ void Scheduler::startNewPreStaging (Rank *pRank, PeerQueue *pPeerQueue, unsigned
                                 "to the queue for target node %s\n", *pSession, uiMsgSessionIndex, pRank->_msgId.c_str(),
                                 pMsgdIdWr->getFirstIndex(), (const char *) pRank->_targetId);
             }
+            else if (pReturnedMsgdIdWr != pMsgdIdWr) {
+                checkAndLogMsg (pszMethodName, Logger::L_Info, "%d) element %d with message ID %s and rank %f for target "
+                                "node %s replaced the copy with rank %f that was already contained in the queue\n", *pSession,
+                                uiMsgSessionIndex, pRank->_msgId.c_str(), pMsgdIdWr->getFirstIndex(),
+                                (const char *) pRank->_targetId, pReturnedMsgdIdWr->getFirstIndex());
+            }
             else {
                 checkAndLogMsg (pszMethodName, Logger::L_Info, "%d) element %d with message ID %s and rank %f for target "
                                 "node %s was not added to the queue because already contained\n", *pSession, uiMsgSessionIndex,
@@ -865,11 +871,9 @@ void Scheduler::sendInternal (void)
                 DArray2<ChunkIds> requestsToServeChunkFilters;
 
                 // Get message to replicate
-                MsgIDWrapper *pCurr, *pNext;
-                pNext = pPeerQueue->_msgIDs.getFirst();
-                for (unsigned int i = 0; (i < _uiMaxNMsgPerSession) && (pCurr = pNext) != nullptr; i++) {
-                    pNext = pPeerQueue->_msgIDs.getNext();
-                    pPeerQueue->_msgIDs.remove (pCurr);
+                unsigned int uiNMsgs = 0;
+                for (MsgIDWrapper *pCurr; (uiNMsgs < _uiMaxNMsgPerSession) && ((pCurr = pPeerQueue->removeFirst()) != nullptr); uiNMsgs++) {
+                    const unsigned int i = uiNMsgs;
                     pMsgProps[i].msgId = pCurr->_msgId;
                     pMsgProps[i].rankObjInfo = pCurr->_rankObjInfo;
                     pMsgProps[i].matchingNodeIds = pCurr->_matchingNodeIds;
@@ -891,14 +895,14 @@ void Scheduler::sendInternal (void)
                     delete pPeerQueue->_requestedMsgIDs.remove (requestsToServe[i]);
                 }
 
-                pPeerQueue->unlock();
-
-                if (pNext != nullptr) {
+                if (!pPeerQueue->isEmpty()) {
                     bAllEmptyQueues = false;
                 }
 
+                pPeerQueue->unlock();
+
                 // Replicate the messages identified by pMsgProps[i].matchingNodeIds
-                for (unsigned int i = 0; i < _uiMaxNMsgPerSession; i++) {
+                for (unsigned int i = 0; i < uiNMsgs; i++) {
                     if (pMsgProps[i].msgId.length() > 0) {
                         NodeIdSet matchedNodes (pMsgProps[i].matchingNodeIds);
                         Targets **ppTargets = _pTopology->getNextHopsAsTarget (matchedNodes);
@@ -1013,10 +1017,18 @@ void Scheduler::addToCurrentPreStagingInternal (const char *pszTargetPeerNodeID,
 
         MsgIDWrapper *pReturnedMsgdIdWr = pPeerQueue->insert (pMsgdIdWr);
         if (pReturnedMsgdIdWr != nullptr) {
-            checkAndLogMsg ("Scheduler::addToCurrentPreStagingInternal", Logger::L_Info,
-                            "message %s for target node %s was not added to the scheduler "
-                            "because already scheduled for delivery\n",
-                            pReturnedMsgdIdWr->_msgId.c_str(), pszTargetPeerNodeID);
+            if (pReturnedMsgdIdWr == pMsgdIdWr) {
+                checkAndLogMsg ("Scheduler::addToCurrentPreStagingInternal", Logger::L_Info,
+                                "message %s for target node %s was not added to the scheduler "
+                                "because already scheduled for delivery\n",
+                                pReturnedMsgdIdWr->_msgId.c_str(), pszTargetPeerNodeID);
+            }
+            else {
+                checkAndLogMsg ("Scheduler::addToCurrentPreStagingInternal", Logger::L_Info,
+                                "message %s for target node %s was already scheduled for delivery "
+                                "with a lower rank, that was replaced\n",
+                                pMsgdIdWr->_msgId.c_str(), pszTargetPeerNodeID);
+            }
             delete pReturnedMsgdIdWr;
             pReturnedMsgdIdWr = nullptr;
         }
@@ -1068,7 +1080,7 @@ void Scheduler::checkIndexes (float &fPrimaryIndex, float &fSecondaryIndex)
 
 Scheduler::PeerQueue::PeerQueue (const QueueReplacementPolicy *pReplacementPolicy)
     : _m (MutexId::SchedulerPeerQueue_m, LOG_MUTEX),
-      _msgIDs (true), // descendingOrder
+      _ui64NextSeq (0),
       _requestedMsgIDs (true, // bCaseSensitiveKeys
                         true, // bCloneKeys
                         true) // bDeleteKeys
@@ -1082,26 +1094,33 @@ Scheduler::PeerQueue::~PeerQueue()
     removeAll();
 }
 
+Scheduler::MsgIDWrapper * Scheduler::PeerQueue::insert (MsgIDWrapper *pMsgIDWr)
+{
+    QueueRank rank;
+    rank.fPrimaryIndex = pMsgIDWr->getFirstIndex();
+    rank.fSecondaryIndex = (pMsgIDWr->_type == MsgIDWrapper::BiIndex ?
+                            static_cast<BiIndexMsgIDWrapper *>(pMsgIDWr)->_fIndex2 : INDEX_UNSET);
+    rank.ui64Seq = _ui64NextSeq++;
+
+    QueueRank enqueuedRank;
+    if (_msgIDs.getPriority (pMsgIDWr->_msgId.c_str(), enqueuedRank) && !(enqueuedRank < rank)) {
+        // The enqueued copy has the same or higher indexes
+        return pMsgIDWr;
+    }
+    return _msgIDs.insertOrReplace (pMsgIDWr->_msgId.c_str(), rank, pMsgIDWr);
+}
+
 void Scheduler::PeerQueue::removeAll()
 {
-    MsgIDWrapper *pCurr, *pNext;
-    pNext = _msgIDs.getFirst();
-    while ((pCurr = pNext) != nullptr) {
-        pNext = _msgIDs.getNext();
-        delete _msgIDs.remove (pCurr);
-    }
+    _msgIDs.removeAll (true);
 }
 
 void Scheduler::PeerQueue::removeReplaceable()
 {
-    MsgIDWrapper *pCurr, *pNext;
-    pNext = _msgIDs.getFirst();
-    while ((pCurr = pNext) != nullptr) {
-        pNext = _msgIDs.getNext();
-        if (((QueueReplacementPolicy *)_pReplacementPolicy)->isReplaceable (pCurr)) {
-            delete _msgIDs.remove (pCurr);
-        }
-    }
+    QueueReplacementPolicy *pReplacementPolicy = (QueueReplacementPolicy *) _pReplacementPolicy;
+    _msgIDs.removeIf ([pReplacementPolicy] (MsgIDWrapper *pMsgIDWr) {
+        return pReplacementPolicy->isReplaceable (pMsgIDWr);
+    }, true);
 }
 
 bool Scheduler::BiIndexMsgIDWrapper::operator > (const MsgIDWrapper &rhsMsgWr) const
@@ -1148,16 +1167,13 @@ bool Scheduler::BiIndexMsgIDWrapper::operator < (const MsgIDWrapper &rhsMsgWr) c
 
 void Scheduler::PeerQueue::display (FILE *pFileOut)
 {
-    MsgIDWrapper *pWr = _msgIDs.getFirst();
-    bool bFirstEl = true;
-    while (pWr != nullptr) {
-        if (!bFirstEl) {
+    // The messages are listed in heap order, only the first one is the next to be sent
+    for (unsigned int i = 0; i < _msgIDs.getCount(); i++) {
+        if (i > 0) {
             fprintf (pFileOut, ", ");
-            bFirstEl = false;
         }
-        fprintf (pFileOut, "%s", pWr->_msgId.c_str());
+        fprintf (pFileOut, "%s", _msgIDs.getAt (i)->_msgId.c_str());
         fflush (pFileOut);
-        pWr= _msgIDs.getNext();
     }
     fprintf (pFileOut, "\n");
 }
@@ -27,10 +27,10 @@
 #include "Rank.h"
 #include "SchedulerCache.h"
 
+#include "IndexedPtrHeap.h"
 #include "IterableStringHashtable.h"
 #include "LoggingMutex.h"
 #include "ManageableThread.h"
-#include "SetUniquePtrLList.h"
 #include "StringHashset.h"
 #include "LList.h"
 
@@ -210,6 +210,20 @@ namespace IHMC_ACI
                 const float _fIndex2;
             };
 
+            /**
+             * Position of a message in a PeerQueue: messages with higher
+             * indexes come first, and messages with the same indexes are
+             * sent in the order they were enqueued.
+             * The secondary index of MonoIndex messages is INDEX_UNSET.
+             */
+            struct QueueRank {
+                bool operator < (const QueueRank &rhsRank) const;
+
+                float fPrimaryIndex;
+                float fSecondaryIndex;
+                uint64 ui64Seq;
+            };
+
             struct PeerQueue {
                 PeerQueue (const QueueReplacementPolicy *pReplacementPolicy);
                 virtual ~PeerQueue (void);
@@ -217,9 +231,14 @@ namespace IHMC_ACI
                 void display (FILE *pFileOut);
 
                 /**
-                 * Returns the element, if it was not added, nullptr otherwise
+                 * Each message is enqueued at most once.  If the queue already
+                 * contains a message with the same ID, only the copy with the
+                 * higher indexes is kept.
+                 * Returns the element that is not in the queue after the call
+                 * (either pMsgIDWr or the copy it replaced), nullptr otherwise.
                  */
                 MsgIDWrapper * insert (MsgIDWrapper *pMsgIDWr);
+                MsgIDWrapper * removeFirst (void);
                 int getCount (void);
                 bool isEmpty (void);
                 void removeAll (void);
@@ -233,7 +252,8 @@ namespace IHMC_ACI
                 bool _bLocked;
                 NOMADSUtil::LoggingMutex _m;
                 const QueueReplacementPolicy *_pReplacementPolicy;
-                NOMADSUtil::SetUniquePtrLList<MsgIDWrapper> _msgIDs;
+                uint64 _ui64NextSeq;
+                NOMADSUtil::IndexedPtrHeap<MsgIDWrapper, QueueRank> _msgIDs;
                 NOMADSUtil::StringHashtable<ChunkIds> _requestedMsgIDs;
             };
 
@@ -313,19 +333,19 @@ namespace IHMC_ACI
     // PeerQueue
     //==========================================================================
 
-    inline Scheduler::MsgIDWrapper * Scheduler::PeerQueue::insert (MsgIDWrapper *pMsgIDWr)
+    inline Scheduler::MsgIDWrapper * Scheduler::PeerQueue::removeFirst (void)
     {
-        return _msgIDs.insertUnique (pMsgIDWr);
+        return _msgIDs.removeFirst();
     }
 
     inline int Scheduler::PeerQueue::getCount (void)
     {
-        return _msgIDs.getCount();
+        return (int) _msgIDs.getCount();
     }
 
     inline bool Scheduler::PeerQueue::isEmpty (void)
     {
-        return _msgIDs.getFirst() == nullptr;
+        return _msgIDs.isEmpty();
     }
 
     inline void Scheduler::PeerQueue::lock (void)
@@ -354,6 +374,22 @@ namespace IHMC_ACI
         return _bLocked;
     }
 
+    //==========================================================================
+    // QueueRank
+    //==========================================================================
+
+    inline bool Scheduler::QueueRank::operator < (const QueueRank &rhsRank) const
+    {
+        if (fPrimaryIndex != rhsRank.fPrimaryIndex) {
+            return (fPrimaryIndex < rhsRank.fPrimaryIndex);
+        }
+        if (fSecondaryIndex != rhsRank.fSecondaryIndex) {
+            return (fSecondaryIndex < rhsRank.fSecondaryIndex);
+        }
+        // The message that was enqueued later ranks lower
+        return (ui64Seq > rhsRank.ui64Seq);
+    }
+
     //==========================================================================
     // MsgIDWrapper
     //==========================================================================
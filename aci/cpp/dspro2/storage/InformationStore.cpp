@@ -252,6 +252,7 @@ namespace INFORMATION_STORE
 InformationStore::InformationStore (DataStore *pDataCache, const char *pszDSProGroupName)
     : _dbName (DEFAULT_DATABASE_NAME),
       _tableName (DEFAULT_METADATA_TABLE_NAME),
+      _bSpatialIndex (false),
       _primaryKey (MetadataInterface::MESSAGE_ID),
       _uiAllColumnsCount (0),
       _pSQL3DB (nullptr),
@@ -662,37 +663,63 @@ MetadataList * InformationStore::getAllMetadataInArea (MatchmakingQualifiers *pM
                                                        const char **ppszMessageIdFilters,
                                                        const BoundingBox &area, bool bEmptyPedigree)
 {
-    const float fMaxLat = area._leftUpperLatitude;
-    const float fMinLat = area._rightLowerLatitude;
-    const float fMaxLong = area._rightLowerLongitude;
-    const float fMinLong = area._leftUpperLongitude;
-
-    String sql = "SELECT ";
-    sql += INFORMATION_STORE::JSON_BLOB;
-    sql += " FROM ";
-
-    if (pMatchmakingQualifiers != nullptr &&
-        pMatchmakingQualifiers->_qualifiers.getFirst() != nullptr) {
-        sql += "(";
-        sql += toSqlStatement (pMatchmakingQualifiers);
-        sql +=  ")";
+    String from (" FROM ");
+    const bool bSubquery = (pMatchmakingQualifiers != nullptr) &&
+                           (pMatchmakingQualifiers->_qualifiers.getFirst() != nullptr);
+    if (bSubquery) {
+        char *pszSubquery = toSqlStatement (pMatchmakingQualifiers);
+        from += "(";
+        from += pszSubquery;
+        from +=  ")";
+        free (pszSubquery);
     }
     else {
-        sql += _tableName;
+        from += _tableName;
     }
 
+    // Conditions that do not depend on the bounding-box
+    String filters;
     if ((ppszMessageIdFilters != nullptr) && (ppszMessageIdFilters[0] != nullptr)) {
-        sql += (String) " WHERE " + MetadataInterface::MESSAGE_ID + " NOT IN (";
+        filters += (String) MetadataInterface::MESSAGE_ID + " NOT IN (";
         for (int i = 0; ppszMessageIdFilters[i] != nullptr; i++) {
             if (i > 0) {
-                sql += ", ";
+                filters += ", ";
             }
-            sql += (String) "'" + ppszMessageIdFilters[i] + "'";
+            filters += (String) "'" + ppszMessageIdFilters[i] + "'";
         }
-        sql += ")";
+        filters += ") AND ";
+    }
+    if (bEmptyPedigree) {
+        filters += (String) "(" + MetadataInterface::PEDIGREE + " IS NULL OR " + MetadataInterface::PEDIGREE + " = '') AND ";
     }
-    sql += (((ppszMessageIdFilters != nullptr) && (ppszMessageIdFilters[0] != nullptr)) ? " AND " : " WHERE ");
 
+    // Metadata that do not have a bounding-box match any area
+    const String noBoundingBox ((String) "(" + MetadataInterface::LEFT_UPPER_LATITUDE + " IS NULL AND "
+                                + MetadataInterface::RIGHT_LOWER_LATITUDE + " IS NULL AND "
+                                + MetadataInterface::RIGHT_LOWER_LONGITUDE + " IS NULL AND "
+                                + MetadataInterface::LEFT_UPPER_LONGITUDE + " IS NULL)");
+    const String areaConstraint (getAreaConstraint (area, bSubquery));
+
+    String sql = (String) "SELECT " + INFORMATION_STORE::JSON_BLOB + from + " WHERE " + filters;
+    if (_bSpatialIndex) {
+        // The R*Tree lookup and the metadata without a bounding-box are
+        // selected separately, so that each can be served by an index
+        sql += areaConstraint + " UNION ALL SELECT " + INFORMATION_STORE::JSON_BLOB + from
+            +  " WHERE " + filters + noBoundingBox;
+    }
+    else {
+        sql += (String) "(" + areaConstraint + " OR " + noBoundingBox + ")";
+    }
+    sql += ";";
+
+    _m.lock (1021);
+    MetadataList *pMetadataList = getAllMetadata (sql, 1);
+    _m.unlock (1021);
+    return pMetadataList;
+}
+
+String InformationStore::getAreaConstraint (const BoundingBox &area, bool bSubquery) const
+{
     // Metadata's bounding-box
     const char *pszMetaMaxLat = MetadataInterface::LEFT_UPPER_LATITUDE;
     const char *pszMetaMinLat = MetadataInterface::RIGHT_LOWER_LATITUDE;
@@ -702,70 +729,37 @@ MetadataList * InformationStore::getAllMetadataInArea (MatchmakingQualifiers *pM
     // Area's bounding-box
     static const uint8 ui8BufLen = 20;
     char pszMaxLat[ui8BufLen];
-    DSLib::floatToString (pszMaxLat, ui8BufLen, fMaxLat);
+    DSLib::floatToString (pszMaxLat, ui8BufLen, area._leftUpperLatitude);
     char pszMinLat[ui8BufLen];
-    DSLib::floatToString (pszMinLat, ui8BufLen, fMinLat);
+    DSLib::floatToString (pszMinLat, ui8BufLen, area._rightLowerLatitude);
     char pszMaxLong[ui8BufLen];
-    DSLib::floatToString (pszMaxLong, ui8BufLen, fMaxLong);
+    DSLib::floatToString (pszMaxLong, ui8BufLen, area._rightLowerLongitude);
     char pszMinLong[ui8BufLen];
-    DSLib::floatToString (pszMinLong, ui8BufLen, fMinLong);
-
-    sql += (String) " ("
-                // At least one corner of the metadata's bounding-box
-                // is included in the path's bounding-box
-            +   "(((" + pszMetaMinLat + " BETWEEN " + pszMinLat + " AND " + pszMaxLat + ") OR "
-            +       "(" + pszMetaMaxLat + " BETWEEN " + pszMinLat + " AND " + pszMaxLat + "))"
-            +                                                         " AND "
-            +       "((" + pszMetaMinLong + " BETWEEN " + pszMinLong + " AND " + pszMaxLong + ") OR "
-            +       "(" + pszMetaMaxLong + " BETWEEN " + pszMinLong + " AND " + pszMaxLong + ")))"
-            +                                                            " OR "
-                    // The metadata's bounding-box includes, or partially
-                    // includes, the path's bounding-box (1)
-            +       "((" + pszMetaMinLat + " <= " + pszMinLat + " AND " +  pszMetaMaxLat + " >= " + pszMaxLat + ") AND "
-            +       "    ("
-            +                 // Partial overlapping
-            +                 "("
-            +                     "(" + pszMetaMinLong + " BETWEEN " + pszMinLong + " AND " + pszMaxLong + ") OR "
-            +                     "(" + pszMetaMaxLong + " BETWEEN " + pszMinLong + " AND " + pszMaxLong + ")"
-            +                 ")" +                            " OR "
-            +                 // Total overlapping
-            +                 "(" + pszMetaMinLong + " <= " + pszMinLong + " AND " +  pszMetaMaxLong + " >= " + pszMaxLong + ")"
-            +              ") "
-            +           ")"
-            +                                                        " OR "
-                       // The metadata's bounding-box includes, or partially
-                       // includes, the path's bounding-box (2)
-            +          "((" + pszMetaMinLong + " <= " + pszMinLong + " AND " +  pszMetaMaxLong + " >= " + pszMaxLong + ") AND "
-            +          "    ("
-            +                 // Partial overlapping
-            +                 "("
-            +                     "(" + pszMetaMinLat + " BETWEEN " + pszMinLat + " AND " + pszMaxLat + ") OR "
-            +                     "(" + pszMetaMaxLat + " BETWEEN " + pszMinLat + " AND " + pszMaxLat + ")"
-            +                 ")" +                            " OR "
-            +                 // Total overlapping
-            +                 "(" + pszMetaMinLat + " <= " + pszMinLat + " AND " +  pszMetaMaxLat + " >= " + pszMaxLat + ")"
-            +              ") "
-            +          ")"
-            +                                                            " OR "
-                     "(" + MetadataInterface::LEFT_UPPER_LATITUDE + " IS NULL AND " + MetadataInterface::RIGHT_LOWER_LATITUDE + " IS NULL AND "
-            +              MetadataInterface::RIGHT_LOWER_LONGITUDE + " IS NULL AND " + MetadataInterface::LEFT_UPPER_LONGITUDE + " IS NULL)" +
-
-            +        ")";
-
-    if (bEmptyPedigree) {
-        sql += " AND (";
-        sql += MetadataInterface::PEDIGREE;
-        sql += " + IS NULL OR ";
-        sql += MetadataInterface::PEDIGREE;
-        sql += " = '')";
-    }
-
-    sql += ";";
-
-    _m.lock (1021);
-    MetadataList *pMetadataList = getAllMetadata (sql, 1);
-    _m.unlock (1021);
-    return pMetadataList;
+    DSLib::floatToString (pszMinLong, ui8BufLen, area._leftUpperLongitude);
+
+    // Two rectangles intersect iff they overlap on both axes.  The corners
+    // may be stored swapped, therefore they are normalized by min() and max().
+    const String intersection ((String) "(min(" + pszMetaMinLat + ", " + pszMetaMaxLat + ") <= " + pszMaxLat
+                               + " AND max(" + pszMetaMinLat + ", " + pszMetaMaxLat + ") >= " + pszMinLat
+                               + " AND min(" + pszMetaMinLong + ", " + pszMetaMaxLong + ") <= " + pszMaxLong
+                               + " AND max(" + pszMetaMinLong + ", " + pszMetaMaxLong + ") >= " + pszMinLong + ")");
+    if (!_bSpatialIndex) {
+        return intersection;
+    }
+
+    // The R*Tree stores 32-bit floats rounded outwards, thus it returns a
+    // superset of the intersecting bounding-boxes: the exact intersection
+    // is checked on the candidates
+    String candidates ((String) "SELECT id FROM " + _spatialIndexName
+                       + " WHERE minLat <= " + pszMaxLat + " AND maxLat >= " + pszMinLat
+                       + " AND minLong <= " + pszMaxLong + " AND maxLong >= " + pszMinLong);
+    if (bSubquery) {
+        // The rows of the sub-query do not carry the rowid of the metadata table
+        candidates = (String) "SELECT " + MetadataInterface::MESSAGE_ID + " FROM " + _tableName
+                   + " WHERE rowid IN (" + candidates + ")";
+        return (String) MetadataInterface::MESSAGE_ID + " IN (" + candidates + ") AND " + intersection;
+    }
+    return (String) "rowid IN (" + candidates + ") AND " + intersection;
 }
 
 MetadataList * InformationStore::getAllMetadata (const char **ppszMessageIdFilters, bool bExclusiveFilter)
@@ -1175,6 +1169,7 @@ int InformationStore::init (MetadataConfigurationImpl *pMetadataConf,
     if (pszMetadataTableName != nullptr) {
         _tableName = pszMetadataTableName;
     }
+    _spatialIndexName = _tableName + "_RTree";
 
     // Set ALL
     uint16 metadataFieldsNumber = 0;
@@ -1292,6 +1287,8 @@ int InformationStore::openDataBase (MetadataConfigurationImpl *pMetadataConf)
             return _errorCode;
     }
 
+    createSpatialIndexes();
+
     String tryInsert = "INSERT INTO ";
     tryInsert += _tableName;
     tryInsert += " ( ";
@@ -1529,43 +1526,74 @@ void InformationStore::clear (void)
     _m.unlock (1027);
 }
 
-void InformationStore::createSpatialIndexes()
+void InformationStore::createSpatialIndexes (void)
 {
     const char *pszMethodName = "InformationStore::createSpatialIndexes";
     String sql;
-    char *pszErrMsg;
-    int rc;
-
-    sql = (String) "CREATE INDEX IF NOT EXISTS LeftUpperLat_Idx ON " + _tableName
-        +          "(" + MetaData::LEFT_UPPER_LATITUDE + ");";
-    if ((rc = sqlite3_exec (_pSQL3DB, sql, nullptr, nullptr, &pszErrMsg)) != SQLITE_OK) {
-        checkAndLogMsg (pszMethodName, Logger::L_Warning,
-                        "Could not create index = <%s>\n", (const char *) sql);
-        return;
-    }
-
-    sql = (String) "CREATE INDEX IF NOT EXISTS LeftUpperLong_Idx ON "
-        +          _tableName + "(" + MetaData::LEFT_UPPER_LONGITUDE + ");";
-    if ((rc = sqlite3_exec (_pSQL3DB, sql, nullptr, nullptr, &pszErrMsg)) != SQLITE_OK) {
-        checkAndLogMsg (pszMethodName, Logger::L_Warning,
-                        "Could not create index = <%s>\n", (const char *) sql);
-        return;
-    }
+    char *pszErrMsg = nullptr;
 
-    sql = (String) "CREATE INDEX IF NOT EXISTS RightLowerLat_Idx ON "
-        +          _tableName + "(" + MetaData::RIGHT_LOWER_LATITUDE + ");";
-    if ((rc = sqlite3_exec (_pSQL3DB, sql, nullptr, nullptr, &pszErrMsg)) != SQLITE_OK) {
-        checkAndLogMsg (pszMethodName, Logger::L_Warning,
-                        "Could not create index = <%s>\n", (const char *) sql);
-        return;
+    // Single-column indexes: they serve the selection of the metadata
+    // without a bounding-box, and the area queries if the R*Tree is missing
+    const char * const apszCorners[] = {
+        MetaData::LEFT_UPPER_LATITUDE, MetaData::LEFT_UPPER_LONGITUDE,
+        MetaData::RIGHT_LOWER_LATITUDE, MetaData::RIGHT_LOWER_LONGITUDE
+    };
+    const char * const apszIndexNames[] = {
+        "LeftUpperLat_Idx", "LeftUpperLong_Idx", "RightLowerLat_Idx", "RightLowerLong_Idx"
+    };
+    for (unsigned int i = 0; i < 4; i++) {
+        sql = (String) "CREATE INDEX IF NOT EXISTS " + apszIndexNames[i] + " ON " + _tableName
+            +          "(" + apszCorners[i] + ");";
+        if (sqlite3_exec (_pSQL3DB, sql, nullptr, nullptr, &pszErrMsg) != SQLITE_OK) {
+            checkAndLogMsg (pszMethodName, Logger::L_Warning, "Could not create index = <%s>: %s\n",
+                            (const char *) sql, pszErrMsg == nullptr ? "" : pszErrMsg);
+            sqlite3_free (pszErrMsg);
+            pszErrMsg = nullptr;
+        }
     }
 
-    sql = (String) "CREATE INDEX IF NOT EXISTS RightLowerLong_Idx ON "
-        +          _tableName + "(" + MetaData::RIGHT_LOWER_LONGITUDE + ");";
-
-    if ((rc = sqlite3_exec (_pSQL3DB, sql, nullptr, nullptr, &pszErrMsg)) != SQLITE_OK) {
-        checkAndLogMsg (pszMethodName, Logger::L_Warning,
-                        "Could not create index = <%s>\n", (const char *) sql);
-        return;
+    // R*Tree on the metadata's bounding-box.  Its ids are the rowids of the
+    // metadata table; the triggers keep it in sync with insertions, updates
+    // and deletions (including the ones performed by clear()), thus it only
+    // contains the metadata that have a complete bounding-box.
+    const String notNull ((String) "NEW." + MetaData::LEFT_UPPER_LATITUDE + " IS NOT NULL AND "
+                          + "NEW." + MetaData::RIGHT_LOWER_LATITUDE + " IS NOT NULL AND "
+                          + "NEW." + MetaData::LEFT_UPPER_LONGITUDE + " IS NOT NULL AND "
+                          + "NEW." + MetaData::RIGHT_LOWER_LONGITUDE + " IS NOT NULL");
+    const String newBoundingBox ((String) "NEW.rowid, "
+                                 + "min(NEW." + MetaData::LEFT_UPPER_LATITUDE + ", NEW." + MetaData::RIGHT_LOWER_LATITUDE + "), "
+                                 + "max(NEW." + MetaData::LEFT_UPPER_LATITUDE + ", NEW." + MetaData::RIGHT_LOWER_LATITUDE + "), "
+                                 + "min(NEW." + MetaData::LEFT_UPPER_LONGITUDE + ", NEW." + MetaData::RIGHT_LOWER_LONGITUDE + "), "
+                                 + "max(NEW." + MetaData::LEFT_UPPER_LONGITUDE + ", NEW." + MetaData::RIGHT_LOWER_LONGITUDE + ")");
+    String backfill ((String) "INSERT OR REPLACE INTO " + _spatialIndexName + " SELECT " + newBoundingBox
+                     + " FROM " + _tableName + " AS NEW WHERE " + notNull + ";");
+
+    const String statements[] = {
+        (String) "CREATE VIRTUAL TABLE IF NOT EXISTS " + _spatialIndexName
+            + " USING rtree(id, minLat, maxLat, minLong, maxLong);",
+        (String) "CREATE TRIGGER IF NOT EXISTS " + _spatialIndexName + "_Insert AFTER INSERT ON " + _tableName
+            + " WHEN " + notNull + " BEGIN INSERT OR REPLACE INTO " + _spatialIndexName
+            + " VALUES (" + newBoundingBox + "); END;",
+        (String) "CREATE TRIGGER IF NOT EXISTS " + _spatialIndexName + "_Update AFTER UPDATE OF "
+            + MetaData::LEFT_UPPER_LATITUDE + ", " + MetaData::RIGHT_LOWER_LATITUDE + ", "
+            + MetaData::LEFT_UPPER_LONGITUDE + ", " + MetaData::RIGHT_LOWER_LONGITUDE + " ON " + _tableName
+            + " BEGIN DELETE FROM " + _spatialIndexName + " WHERE id = OLD.rowid;"
+            + " INSERT INTO " + _spatialIndexName + " SELECT " + newBoundingBox + " WHERE " + notNull + "; END;",
+        (String) "CREATE TRIGGER IF NOT EXISTS " + _spatialIndexName + "_Delete AFTER DELETE ON " + _tableName
+            + " BEGIN DELETE FROM " + _spatialIndexName + " WHERE id = OLD.rowid; END;",
+        backfill
+    };
+    for (unsigned int i = 0; i < (sizeof (statements) / sizeof (String)); i++) {
+        if (sqlite3_exec (_pSQL3DB, statements[i], nullptr, nullptr, &pszErrMsg) != SQLITE_OK) {
+            checkAndLogMsg (pszMethodName, Logger::L_Warning, "Could not create the R*Tree spatial index: "
+                            "query <%s> failed: %s.  Area queries will not use it.\n",
+                            (const char *) statements[i], pszErrMsg == nullptr ? "" : pszErrMsg);
+            sqlite3_free (pszErrMsg);
+            _bSpatialIndex = false;
+            return;
+        }
     }
+    _bSpatialIndex = true;
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "created R*Tree spatial index %s\n",
+                    _spatialIndexName.c_str());
 }
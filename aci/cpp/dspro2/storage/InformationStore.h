@@ -166,12 +166,29 @@ namespace IHMC_ACI
              */
             NOMADSUtil::PtrLList<const char> * extractMessageIDsFromDBBase (const char *pszGroupName, const char *pszSQL);
 
+            /*
+             * Creates the indexes used by getAllMetadataInArea(): an R*Tree
+             * on the metadata's bounding-box (kept in sync with the metadata
+             * table by triggers), and single-column indexes on the corners.
+             * If the R*Tree can not be created, _bSpatialIndex is left false
+             * and the area queries are run against the metadata table only.
+             */
             void createSpatialIndexes (void);
+
+            /*
+             * Returns the SQL condition that is satisfied by the rows whose
+             * bounding-box intersects the given area (not including the rows
+             * that have no bounding-box).
+             */
+            NOMADSUtil::String getAreaConstraint (const NOMADSUtil::BoundingBox &area, bool bSubquery) const;
+
             int openDataBase (MetadataConfigurationImpl *pMetadataConf);
 
         private:
             NOMADSUtil::String _dbName;
             NOMADSUtil::String _tableName;
+            NOMADSUtil::String _spatialIndexName;      // R*Tree on the metadata's bounding-box
+            bool _bSpatialIndex;
             const NOMADSUtil::String _primaryKey;
             NOMADSUtil::String _allColumns;                // all the fields in the table
             unsigned int _uiAllColumnsCount;
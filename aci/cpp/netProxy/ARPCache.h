@@ -41,7 +41,8 @@ namespace ACMNetProxy
         ARPCache (void);
 
         void insert (uint32 ui32IPAddr, const NOMADSUtil::EtherMACAddr & pMACAddr);
-        const NOMADSUtil::EtherMACAddr & lookup (uint32 ui32IPAddr) const;
+        // Returns a copy, made while holding the lock, since the entry can be updated by another thread
+        NOMADSUtil::EtherMACAddr lookup (uint32 ui32IPAddr) const;
 
 
     private:
@@ -53,7 +54,7 @@ namespace ACMNetProxy
 
     inline ARPCache::ARPCache (void) { }
 
-    inline const NOMADSUtil::EtherMACAddr & ARPCache::lookup (uint32 ui32IPAddr) const
+    inline NOMADSUtil::EtherMACAddr ARPCache::lookup (uint32 ui32IPAddr) const
     {
         std::lock_guard<std::mutex> lg{_mtx};
         return (_umARPCache.count (ui32IPAddr) == 1) ?
@@ -82,6 +82,8 @@ namespace ACMNetProxy
 
         bool hasCachedPacketsWithDestination (uint32 ui32DestIPAddr);
         std::deque<ARPTableMissPacket> & lookup (uint32 ui32DestIPAddr);
+        // Removes the packets with the specified destination from the cache and returns those that have not expired
+        std::deque<ARPTableMissPacket> extract (uint32 ui32DestIPAddr);
         bool hasPacketInCache (uint32 ui32DestIPAddr, uint8 * const pui8Buf, uint16 ui16PacketLen) const;
         void insert (uint32 ui32DestIPAddr, NetworkInterface * const pNI, uint8 * const pui8Buf, uint16 ui16PacketLen);
         void remove (uint32 ui32DestIPAddr);
@@ -167,6 +169,24 @@ namespace ACMNetProxy
         return _umPacketsCache[ui32DestIPAddr];
     }
 
+    inline std::deque<ARPTableMissPacket> ARPTableMissCache::extract (uint32 ui32DestIPAddr)
+    {
+        std::lock_guard<std::mutex> lg{_mtx};
+
+        std::deque<ARPTableMissPacket> deqPackets;
+        if (!isEmpty() && (_umPacketsCache.count (ui32DestIPAddr) > 0)) {
+            _uiCachedPackets -= removeExpiredEntries (ui32DestIPAddr, _i64ExpirationTimeInMilliseconds);
+            auto it = _umPacketsCache.find (ui32DestIPAddr);
+            if (it != _umPacketsCache.end()) {
+                _uiCachedPackets -= it->second.size();
+                deqPackets = std::move (it->second);
+                _umPacketsCache.erase (it);
+            }
+        }
+
+        return deqPackets;
+    }
+
     inline void ARPTableMissCache::insert (uint32 ui32DestIPAddr, NetworkInterface * const pNI, uint8 * const pui8Buf, uint16 ui16PacketLen)
     {
         std::lock_guard<std::mutex> lg{_mtx};
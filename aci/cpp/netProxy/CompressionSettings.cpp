@@ -36,6 +36,12 @@ namespace ACMNetProxy
         else if (sCompressionTypeName == "lzma") {
             _fCompressionType = CompressionType::PMC_LZMACompressedData;
         }
+        else if (sCompressionTypeName == "lz4") {
+            _fCompressionType = CompressionType::PMC_LZ4CompressedData;
+        }
+        else if (sCompressionTypeName == "zstd") {
+            _fCompressionType = CompressionType::PMC_ZstdCompressedData;
+        }
     #endif
         else {
             _fCompressionType = CompressionType::PMC_UncompressedData;
@@ -54,6 +60,12 @@ namespace ACMNetProxy
         if (_fCompressionType == CompressionType::PMC_LZMACompressedData) {
             return "lzma";
         }
+        if (_fCompressionType == CompressionType::PMC_LZ4CompressedData) {
+            return "lz4";
+        }
+        if (_fCompressionType == CompressionType::PMC_ZstdCompressedData) {
+            return "zstd";
+        }
 
         return nullptr;
     }
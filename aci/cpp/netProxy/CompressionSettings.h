@@ -57,7 +57,7 @@ namespace ACMNetProxy
         static const int DEFAULT_COMPRESSION_LEVEL = 1;
         static const int MAX_COMPRESSION_LEVEL = 9;
         static const uint8 MAX_COMPRESSION_TYPE_AND_LEVEL =
-            static_cast<uint8> (static_cast<int> (CompressionType::PMC_LZMACompressedData) |
+            static_cast<uint8> (static_cast<int> (CompressionType::PMC_ZstdCompressedData) |
                                 CompressionSettings::MAX_COMPRESSION_LEVEL);
 
         static const CompressionSettings DefaultNOCompressionSetting;
@@ -136,7 +136,8 @@ namespace ACMNetProxy
     {
         ci_string sCompressionTypeName (pSpecifiedCompressionName);
         return (sCompressionTypeName == "none") || (sCompressionTypeName == "plain") ||
-               (sCompressionTypeName == "zlib") || (sCompressionTypeName == "lzma");
+               (sCompressionTypeName == "zlib") || (sCompressionTypeName == "lzma") ||
+               (sCompressionTypeName == "lz4") || (sCompressionTypeName == "zstd");
     }
 
     inline bool CompressionSettings::isSpecifiedCompressionLevelCorrect (const int iSpecifiedCompressionLevel)
@@ -1936,6 +1936,25 @@ namespace ACMNetProxy
                                 NetProxyApplicationParameters::TRANSPARENT_GATEWAY_MODE ? "not be decremented" : "be decremented by one");
             }
         }
+        // Host Mode
+        else if (hasValue ("TAPInterfaceQueues")) {
+            // Number of queues of the TUN/TAP interface, each of which is read by a separate thread
+            const uint32 ui32TAPInterfaceQueues = getValueAsUInt32 ("TAPInterfaceQueues");
+            if ((ui32TAPInterfaceQueues > 0) && (ui32TAPInterfaceQueues <= NetProxyApplicationParameters::MAX_TAP_INTERFACE_QUEUES)) {
+                NetProxyApplicationParameters::TAP_INTERFACE_QUEUES = static_cast<uint8> (ui32TAPInterfaceQueues);
+                checkAndLogMsg ("ConfigurationManager::processMainConfigFile", NOMADSUtil::Logger::L_Info,
+                                "the TUN/TAP interface will be configured with %hhu queues\n",
+                                NetProxyApplicationParameters::TAP_INTERFACE_QUEUES);
+            }
+            else {
+                NetProxyApplicationParameters::TAP_INTERFACE_QUEUES = NetProxyApplicationParameters::DEFAULT_TAP_INTERFACE_QUEUES;
+                checkAndLogMsg ("ConfigurationManager::processMainConfigFile", NOMADSUtil::Logger::L_Warning,
+                                "invalid value %u for the TAPInterfaceQueues option (it must be between 1 and %hhu); "
+                                "using the default value of %hhu queues\n", ui32TAPInterfaceQueues,
+                                NetProxyApplicationParameters::MAX_TAP_INTERFACE_QUEUES,
+                                NetProxyApplicationParameters::TAP_INTERFACE_QUEUES);
+            }
+        }
 
         // Connectors: Mockets, TCP, UDP
         if (!NetProxyApplicationParameters::LEVEL2_TUNNEL_MODE) {
@@ -2325,6 +2344,20 @@ namespace ACMNetProxy
                             "value of %u bytes\n", NetworkConfigurationSettings::DEFAULT_UDP_CONNECTION_BUFFER_SIZE);
         }
 
+        // Pre-trained Zstandard dictionaries; they must match those configured on the remote NetProxies
+        if (hasValue ("ZstdTCPDictionaryFile")) {
+            NetworkConfigurationSettings::ZSTD_TCP_DICTIONARY_FILE = nullprtToEmptyString (getValue ("ZstdTCPDictionaryFile"));
+            checkAndLogMsg ("ConfigurationManager::processMainConfigFile", NOMADSUtil::Logger::L_Info,
+                            "TCP streams compressed with Zstandard will use the dictionary in file <%s>\n",
+                            NetworkConfigurationSettings::ZSTD_TCP_DICTIONARY_FILE.c_str());
+        }
+        if (hasValue ("ZstdUDPDictionaryFile")) {
+            NetworkConfigurationSettings::ZSTD_UDP_DICTIONARY_FILE = nullprtToEmptyString (getValue ("ZstdUDPDictionaryFile"));
+            checkAndLogMsg ("ConfigurationManager::processMainConfigFile", NOMADSUtil::Logger::L_Info,
+                            "UDP datagrams compressed with Zstandard will use the dictionary in file <%s>\n",
+                            NetworkConfigurationSettings::ZSTD_UDP_DICTIONARY_FILE.c_str());
+        }
+
         // NetSensor
         if (hasValue ("ActivateNetSensor")) {
             NetProxyApplicationParameters::ACTIVATE_NETSENSOR = getValueAsBool ("ActivateNetSensor");
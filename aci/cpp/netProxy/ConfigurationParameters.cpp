@@ -33,6 +33,8 @@ namespace ACMNetProxy
     uint16 NetworkConfigurationSettings::MULTIPLE_UDP_DATAGRAMS_PACKET_THRESHOLD = NetworkConfigurationSettings::DEFAULT_MULTIPLE_UDP_DATAGRAMS_PACKET_THRESHOLD;
     uint32 NetworkConfigurationSettings::UDP_CONNECTION_THROUGHPUT_LIMIT_IN_BPS = NetworkConfigurationSettings::DEFAULT_UDP_CONNECTION_THROUGHPUT_LIMIT_IN_BPS;
     uint32 NetworkConfigurationSettings::UDP_CONNECTION_BUFFER_SIZE = NetworkConfigurationSettings::DEFAULT_UDP_CONNECTION_BUFFER_SIZE;
+    std::string NetworkConfigurationSettings::ZSTD_TCP_DICTIONARY_FILE;
+    std::string NetworkConfigurationSettings::ZSTD_UDP_DICTIONARY_FILE;
 
     uint32 NetworkConfigurationSettings::VIRTUAL_CONN_ESTABLISHMENT_TIMEOUT = NetworkConfigurationSettings::DEFAULT_VIRTUAL_CONN_ESTABLISHMENT_TIMEOUT;
 
@@ -43,6 +45,7 @@ namespace ACMNetProxy
     bool NetProxyApplicationParameters::TRANSPARENT_GATEWAY_MODE = NetProxyApplicationParameters::DEFAULT_TRANSPARENT_GATEWAY_MODE;
     bool NetProxyApplicationParameters::LEVEL2_TUNNEL_MODE = NetProxyApplicationParameters::DEFAULT_LEVEL2_TUNNEL_MODE;
     uint64 NetProxyApplicationParameters::UI64_STARTUP_TIME_IN_MILLISECONDS = 0U;
+    uint8 NetProxyApplicationParameters::TAP_INTERFACE_QUEUES = NetProxyApplicationParameters::DEFAULT_TAP_INTERFACE_QUEUES;
 
     bool NetProxyApplicationParameters::ENABLE_PRIORITIZATION_MECHANISM = NetProxyApplicationParameters::DEFAULT_ENABLE_PRIORITIZATION_MECHANISM;
 
@@ -87,6 +87,8 @@ namespace ACMNetProxy
         extern uint16 MULTIPLE_UDP_DATAGRAMS_PACKET_THRESHOLD;
         extern uint32 UDP_CONNECTION_THROUGHPUT_LIMIT_IN_BPS;
         extern uint32 UDP_CONNECTION_BUFFER_SIZE;
+        extern std::string ZSTD_TCP_DICTIONARY_FILE;                                                        // Path to the pre-trained Zstandard dictionary used to compress TCP streams (no dictionary if empty)
+        extern std::string ZSTD_UDP_DICTIONARY_FILE;                                                        // Path to the pre-trained Zstandard dictionary used to compress UDP datagrams (no dictionary if empty)
 
         extern uint32 VIRTUAL_CONN_ESTABLISHMENT_TIMEOUT;
     };
@@ -129,6 +131,8 @@ namespace ACMNetProxy
         // TAP Interface configuration values
         constexpr uint16 TAP_INTERFACE_DEFAULT_MTU = 1500U;                                                 // Deafult value of the MTU of the Virtual TAP interface
         constexpr uint32 TAP_INTERFACE_READ_TIMEOUT = 500U;                                                 // Timeout for the call to WaitForSingleObject() on the TAP handle
+        constexpr uint8 DEFAULT_TAP_INTERFACE_QUEUES = 1U;                                                  // Default number of queues (and of receiver threads) of the TUN/TAP interface
+        constexpr uint8 MAX_TAP_INTERFACE_QUEUES = 16U;                                                     // Max number of queues of a multi-queue TUN/TAP interface
         // First 4 bytes of the MAC Address of the virtual TAP interface
         constexpr uint8 VIRT_MAC_ADDR_BYTE1 = 0x02;
         constexpr uint8 VIRT_MAC_ADDR_BYTE2 = 0x0A;
@@ -152,7 +156,7 @@ namespace ACMNetProxy
                 "";
             #endif
 
-        constexpr uint8 WRITE_PACKET_BUFFERS = 3U;                                                          // Number of buffers available to write on the TUN/TAP (or libpcap internal) interface
+        constexpr uint16 WRITE_PACKET_BUFFERS = 256U;                                                       // Number of buffers available to write on the TUN/TAP (or libpcap internal) interface
 
         // Default port numbers and timeouts for Mocket, TCP, and UDP servers
         constexpr uint16 DEFAULT_MOCKET_SERVER_PORT = 8751U;
@@ -171,6 +175,7 @@ namespace ACMNetProxy
         extern bool TRANSPARENT_GATEWAY_MODE;                                                               // When false, the TTL field of IP packets forwarded from the internal to the external network is decremented by 1
         extern bool LEVEL2_TUNNEL_MODE;                                                                     // True if the NetProxy runs in level 2 tunnel mode
         extern uint64 UI64_STARTUP_TIME_IN_MILLISECONDS;                                                    // Timestamp at startup
+        extern uint8 TAP_INTERFACE_QUEUES;                                                                  // Number of queues of the TUN/TAP interface, each served by a separate receiver thread
 
         extern bool ENABLE_PRIORITIZATION_MECHANISM;                                                        // Enables the use of the prioritization mechanism in the RTT
 
@@ -21,6 +21,8 @@
 #include "CompressionSettings.h"
 #include "ZLibConnectorReader.h"
 #include "LzmaConnectorReader.h"
+#include "Lz4ConnectorReader.h"
+#include "ZstdConnectorReader.h"
 
 
 namespace ACMNetProxy
@@ -36,6 +38,10 @@ namespace ACMNetProxy
         #if !defined (ANDROID)
             case CompressionType::PMC_LZMACompressedData:
                 return new LzmaConnectorReader{compressionSettings};
+            case CompressionType::PMC_LZ4CompressedData:
+                return new Lz4ConnectorReader{compressionSettings};
+            case CompressionType::PMC_ZstdCompressedData:
+                return new ZstdConnectorReader{compressionSettings};
         #endif
         }
 
@@ -70,6 +76,22 @@ namespace ACMNetProxy
                 _pUDPLzmaConnectorReader->lockConnectorReader();
                 return _pUDPLzmaConnectorReader;
             }
+        case CompressionType::PMC_LZ4CompressedData:
+            {
+                if (!_pUDPLz4ConnectorReader) {
+                    _pUDPLz4ConnectorReader = new Lz4ConnectorReader{compressionSettings};
+                }
+                _pUDPLz4ConnectorReader->lockConnectorReader();
+                return _pUDPLz4ConnectorReader;
+            }
+        case CompressionType::PMC_ZstdCompressedData:
+            {
+                if (!_pUDPZstdConnectorReader) {
+                    _pUDPZstdConnectorReader = new ZstdConnectorReader{compressionSettings, true};
+                }
+                _pUDPZstdConnectorReader->lockConnectorReader();
+                return _pUDPZstdConnectorReader;
+            }
         #endif
         }
 
@@ -87,4 +109,6 @@ namespace ACMNetProxy
     ConnectorReader * ConnectorReader::_pUDPConnectorReader = nullptr;
     ZLibConnectorReader * ConnectorReader::_pUDPZLibConnectorReader = nullptr;
     LzmaConnectorReader * ConnectorReader::_pUDPLzmaConnectorReader = nullptr;
+    Lz4ConnectorReader * ConnectorReader::_pUDPLz4ConnectorReader = nullptr;
+    ZstdConnectorReader * ConnectorReader::_pUDPZstdConnectorReader = nullptr;
 }
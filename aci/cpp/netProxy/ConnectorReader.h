@@ -34,6 +34,8 @@ namespace ACMNetProxy
 {
     class ZLibConnectorReader;
     class LzmaConnectorReader;
+    class Lz4ConnectorReader;
+    class ZstdConnectorReader;
 
 
     class ConnectorReader
@@ -67,6 +69,8 @@ namespace ACMNetProxy
         static ConnectorReader * _pUDPConnectorReader;
         static ZLibConnectorReader * _pUDPZLibConnectorReader;
         static LzmaConnectorReader * _pUDPLzmaConnectorReader;
+        static Lz4ConnectorReader * _pUDPLz4ConnectorReader;
+        static ZstdConnectorReader * _pUDPZstdConnectorReader;
     };
 
 
@@ -21,11 +21,13 @@
 #include "CompressionSettings.h"
 #include "LzmaConnectorWriter.h"
 #include "ZLibConnectorWriter.h"
+#include "Lz4ConnectorWriter.h"
+#include "ZstdConnectorWriter.h"
 
 
 namespace ACMNetProxy
 {
-    ConnectorWriter * ConnectorWriter::connectorWriterFactory (const CompressionSettings & compressionSettings)
+    ConnectorWriter * ConnectorWriter::connectorWriterFactory (const CompressionSettings & compressionSettings, bool bUDPDatagrams)
     {
         switch (compressionSettings.getCompressionType()) {
         case CompressionType::PMC_UncompressedData:
@@ -35,6 +37,10 @@ namespace ACMNetProxy
         #if !defined (ANDROID)
             case CompressionType::PMC_LZMACompressedData:
                 return new LzmaConnectorWriter{compressionSettings};
+            case CompressionType::PMC_LZ4CompressedData:
+                return new Lz4ConnectorWriter{compressionSettings, bUDPDatagrams};
+            case CompressionType::PMC_ZstdCompressedData:
+                return new ZstdConnectorWriter{compressionSettings, bUDPDatagrams};
         #endif
         }
 
@@ -45,7 +51,7 @@ namespace ACMNetProxy
     {
         auto *&pConnectorWriter = _UDPConnectorWriters[compressionSettings.getCompressionTypeAndLevel()];
         if (!pConnectorWriter) {
-            pConnectorWriter = ConnectorWriter::connectorWriterFactory (compressionSettings);
+            pConnectorWriter = ConnectorWriter::connectorWriterFactory (compressionSettings, true);
         }
         pConnectorWriter->lockConnectorWriter();
 
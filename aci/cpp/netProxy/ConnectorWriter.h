@@ -52,7 +52,8 @@ namespace ACMNetProxy
         virtual int writeData (const unsigned char * pSrc, unsigned int uiSrcLen, unsigned char ** pDest, unsigned int & uiDestLen, bool bLocalFlush = true);
         virtual int writeDataAndResetWriter (const unsigned char * pSrc, unsigned int uiSrcLen, unsigned char ** pDest, unsigned int & uiDestLen);
 
-        static ConnectorWriter * connectorWriterFactory (const CompressionSettings & compressionSettings);
+        // bUDPDatagrams selects writers optimized for compressing each datagram independently
+        static ConnectorWriter * connectorWriterFactory (const CompressionSettings & compressionSettings, bool bUDPDatagrams = false);
         static ConnectorWriter * const getAndLockUPDConnectorWriter (const CompressionSettings & compressionSettings);
 
 
@@ -0,0 +1,106 @@
+/*
+ * Lz4ConnectorReader.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include <cstdlib>
+
+#include "Logger.h"
+
+#include "Lz4ConnectorReader.h"
+
+
+#define checkAndLogMsg(_f_name_, _log_level_, ...) \
+    if (NOMADSUtil::pLogger && (NOMADSUtil::pLogger->getDebugLevel() >= _log_level_)) \
+        NOMADSUtil::pLogger->logMsg (_f_name_, _log_level_, __VA_ARGS__)
+
+namespace ACMNetProxy
+{
+    Lz4ConnectorReader::Lz4ConnectorReader (const CompressionSettings & compressionSettings, unsigned int ulOutBufSize) :
+        ConnectorReader{compressionSettings}, _pOutputBuffer{nullptr}, _ulOutBufSize{ulOutBufSize}, _pDCtx{nullptr}
+    {
+        if ((_ulOutBufSize == 0) ||
+            (nullptr == (_pOutputBuffer = static_cast<unsigned char *> (malloc (_ulOutBufSize))))) {
+            // throw a c++ exception here
+        }
+        if (LZ4F_isError (LZ4F_createDecompressionContext (&_pDCtx, LZ4F_VERSION))) {
+            // throw a c++ exception here
+        }
+    }
+
+    Lz4ConnectorReader::~Lz4ConnectorReader (void)
+    {
+        LZ4F_freeDecompressionContext (_pDCtx);
+        _pDCtx = nullptr;
+        free (_pOutputBuffer);
+        _pOutputBuffer = nullptr;
+    }
+
+    int Lz4ConnectorReader::receiveTCPDataProxyMessage (const uint8 * const ui8SrcData, uint16 ui16SrcLen, uint8 ** pDest, uint32 & ui32DestLen)
+    {
+        size_t stSrcPos = 0;
+        *pDest = nullptr;
+        ui32DestLen = 0;
+
+        // The decompression context buffers incomplete blocks and frame headers across calls
+        while (true) {
+            size_t stDstSize = _ulOutBufSize - ui32DestLen;
+            size_t stSrcSize = ui16SrcLen - stSrcPos;
+            const size_t rc = LZ4F_decompress (_pDCtx, _pOutputBuffer + ui32DestLen, &stDstSize,
+                                               ui8SrcData + stSrcPos, &stSrcSize, nullptr);
+            if (LZ4F_isError (rc)) {
+                checkAndLogMsg ("Lz4ConnectorReader::receiveTCPDataProxyMessage", NOMADSUtil::Logger::L_MildError,
+                                "LZ4F_decompress() returned with error <%s>\n", LZ4F_getErrorName (rc));
+                ui32DestLen = 0;
+                return -1;
+            }
+            stSrcPos += stSrcSize;
+            ui32DestLen += static_cast<uint32> (stDstSize);
+
+            if (ui32DestLen == _ulOutBufSize) {
+                // The decoder might hold more data than what fits in the output buffer
+                auto * const pNewOutputBuffer = static_cast<unsigned char *> (realloc (_pOutputBuffer, 2 * _ulOutBufSize));
+                if (!pNewOutputBuffer) {
+                    checkAndLogMsg ("Lz4ConnectorReader::receiveTCPDataProxyMessage", NOMADSUtil::Logger::L_MildError,
+                                    "error reallocating memory for _pOutputBuffer; impossible to increase size from %u to %u bytes\n",
+                                    _ulOutBufSize, 2 * _ulOutBufSize);
+                    ui32DestLen = 0;
+                    return -2;
+                }
+                _pOutputBuffer = pNewOutputBuffer;
+                _ulOutBufSize *= 2;
+            }
+            else if (stSrcPos == ui16SrcLen) {
+                break;
+            }
+        }
+
+        if (ui32DestLen > 0) {
+            *pDest = _pOutputBuffer;
+        }
+
+        return 0;
+    }
+
+    int Lz4ConnectorReader::resetConnectorReader (void)
+    {
+        LZ4F_resetDecompressionContext (_pDCtx);
+
+        return 0;
+    }
+
+}
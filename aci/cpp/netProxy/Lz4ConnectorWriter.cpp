@@ -0,0 +1,224 @@
+/*
+ * Lz4ConnectorWriter.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "Logger.h"
+
+#include "Lz4ConnectorWriter.h"
+
+
+#define checkAndLogMsg(_f_name_, _log_level_, ...) \
+    if (NOMADSUtil::pLogger && (NOMADSUtil::pLogger->getDebugLevel() >= _log_level_)) \
+        NOMADSUtil::pLogger->logMsg (_f_name_, _log_level_, __VA_ARGS__)
+
+namespace ACMNetProxy
+{
+    Lz4ConnectorWriter::Lz4ConnectorWriter (const CompressionSettings & compressionSettings, bool bUDPDatagrams, unsigned long ulOutBufSize) :
+        ConnectorWriter{compressionSettings}, _pOutputBuffer{nullptr}, _ulOutBufSize{ulOutBufSize},
+        _bFrameStarted{false}, _pCCtx{nullptr}
+    {
+        if ((_ulOutBufSize == 0) ||
+            ((_pOutputBuffer = static_cast<unsigned char *> (malloc (_ulOutBufSize))) == nullptr)) {
+            // throw C++ exception here
+        }
+        if (LZ4F_isError (LZ4F_createCompressionContext (&_pCCtx, LZ4F_VERSION))) {
+            // Throw C++ exception here
+        }
+
+        memset (&_lz4Preferences, 0, sizeof (_lz4Preferences));
+        _lz4Preferences.frameInfo.blockSizeID = LZ4F_max64KB;
+        // Blocks of a TCP stream can reference previous blocks; datagrams are always compressed independently
+        _lz4Preferences.frameInfo.blockMode = bUDPDatagrams ? LZ4F_blockIndependent : LZ4F_blockLinked;
+        _lz4Preferences.frameInfo.contentChecksumFlag = LZ4F_noContentChecksum;
+        _lz4Preferences.compressionLevel = getCompressionLevel();
+        _lz4Preferences.autoFlush = 0;
+    }
+
+    Lz4ConnectorWriter::~Lz4ConnectorWriter (void)
+    {
+        LZ4F_freeCompressionContext (_pCCtx);
+        _pCCtx = nullptr;
+        free (_pOutputBuffer);
+        _pOutputBuffer = nullptr;
+    }
+
+    int Lz4ConnectorWriter::flush (unsigned char **pDest, unsigned int &uiDestLen)
+    {
+        *pDest = nullptr;
+        uiDestLen = 0;
+        if (_bFlushed) {
+            return 0;
+        }
+
+        // Close the current frame; the next call to writeData() will open a new one
+        if (_bFrameStarted && (0 != endFrame (uiDestLen))) {
+            checkAndLogMsg ("Lz4ConnectorWriter::flush", NOMADSUtil::Logger::L_MildError,
+                            "impossible to terminate the current LZ4 frame\n");
+            uiDestLen = 0;
+            return -1;
+        }
+
+        _bFlushed = true;
+        if (uiDestLen > 0) {
+            *pDest = _pOutputBuffer;
+        }
+
+        return 0;
+    }
+
+    int Lz4ConnectorWriter::writeData (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen, bool bLocalFlush)
+    {
+        *pDest = nullptr;
+        uiDestLen = 0;
+        _bFlushed = false;
+
+        if (!_bFrameStarted && (0 != beginFrame (uiDestLen))) {
+            uiDestLen = 0;
+            return -1;
+        }
+        if ((uiSrcLen > 0) && (0 != compressData (pSrc, uiSrcLen, uiDestLen))) {
+            uiDestLen = 0;
+            return -2;
+        }
+        if (bLocalFlush) {
+            if (0 != reserveOutputBufferSpace (LZ4F_compressBound (0, &_lz4Preferences), uiDestLen)) {
+                uiDestLen = 0;
+                return -3;
+            }
+            const size_t rc = LZ4F_flush (_pCCtx, _pOutputBuffer + uiDestLen, _ulOutBufSize - uiDestLen, nullptr);
+            if (LZ4F_isError (rc)) {
+                checkAndLogMsg ("Lz4ConnectorWriter::writeData", NOMADSUtil::Logger::L_MildError,
+                                "LZ4F_flush() returned with error <%s>\n", LZ4F_getErrorName (rc));
+                uiDestLen = 0;
+                return -4;
+            }
+            uiDestLen += static_cast<unsigned int> (rc);
+        }
+
+        if (uiDestLen > 0) {
+            *pDest = _pOutputBuffer;
+        }
+
+        return 0;
+    }
+
+    int Lz4ConnectorWriter::writeDataAndResetWriter (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen)
+    {
+        *pDest = nullptr;
+        uiDestLen = 0;
+        // LZ4F_compressBegin() resets the compression context, discarding any incomplete frame
+        _bFrameStarted = false;
+        if (!pSrc || (uiSrcLen == 0)) {
+            return 0;
+        }
+
+        // Each datagram is compressed into a self-contained frame
+        if ((0 != beginFrame (uiDestLen)) || (0 != compressData (pSrc, uiSrcLen, uiDestLen)) ||
+            (0 != endFrame (uiDestLen))) {
+            checkAndLogMsg ("Lz4ConnectorWriter::writeDataAndResetWriter", NOMADSUtil::Logger::L_MildError,
+                            "impossible to compress a datagram of %u bytes\n", uiSrcLen);
+            _bFrameStarted = false;
+            uiDestLen = 0;
+            return -1;
+        }
+
+        _bFlushed = true;
+        *pDest = _pOutputBuffer;
+
+        return 0;
+    }
+
+    int Lz4ConnectorWriter::beginFrame (unsigned int &uiDestLen)
+    {
+        if (0 != reserveOutputBufferSpace (LZ4F_HEADER_SIZE_MAX, uiDestLen)) {
+            return -1;
+        }
+        const size_t rc = LZ4F_compressBegin (_pCCtx, _pOutputBuffer + uiDestLen, _ulOutBufSize - uiDestLen, &_lz4Preferences);
+        if (LZ4F_isError (rc)) {
+            checkAndLogMsg ("Lz4ConnectorWriter::beginFrame", NOMADSUtil::Logger::L_MildError,
+                            "LZ4F_compressBegin() returned with error <%s>\n", LZ4F_getErrorName (rc));
+            return -2;
+        }
+        uiDestLen += static_cast<unsigned int> (rc);
+        _bFrameStarted = true;
+
+        return 0;
+    }
+
+    int Lz4ConnectorWriter::compressData (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned int &uiDestLen)
+    {
+        if (0 != reserveOutputBufferSpace (LZ4F_compressBound (uiSrcLen, &_lz4Preferences), uiDestLen)) {
+            return -1;
+        }
+        const size_t rc = LZ4F_compressUpdate (_pCCtx, _pOutputBuffer + uiDestLen, _ulOutBufSize - uiDestLen,
+                                               pSrc, uiSrcLen, nullptr);
+        if (LZ4F_isError (rc)) {
+            checkAndLogMsg ("Lz4ConnectorWriter::compressData", NOMADSUtil::Logger::L_MildError,
+                            "LZ4F_compressUpdate() returned with error <%s>\n", LZ4F_getErrorName (rc));
+            return -2;
+        }
+        uiDestLen += static_cast<unsigned int> (rc);
+
+        return 0;
+    }
+
+    int Lz4ConnectorWriter::endFrame (unsigned int &uiDestLen)
+    {
+        if (0 != reserveOutputBufferSpace (LZ4F_compressBound (0, &_lz4Preferences), uiDestLen)) {
+            return -1;
+        }
+        const size_t rc = LZ4F_compressEnd (_pCCtx, _pOutputBuffer + uiDestLen, _ulOutBufSize - uiDestLen, nullptr);
+        if (LZ4F_isError (rc)) {
+            checkAndLogMsg ("Lz4ConnectorWriter::endFrame", NOMADSUtil::Logger::L_MildError,
+                            "LZ4F_compressEnd() returned with error <%s>\n", LZ4F_getErrorName (rc));
+            return -2;
+        }
+        uiDestLen += static_cast<unsigned int> (rc);
+        _bFrameStarted = false;
+
+        return 0;
+    }
+
+    // LZ4F functions fail if the output buffer cannot hold the worst-case output, so space is reserved upfront
+    int Lz4ConnectorWriter::reserveOutputBufferSpace (size_t stRequiredBytes, unsigned int uiDestLen)
+    {
+        unsigned long ulNewOutBufSize = _ulOutBufSize;
+        while ((ulNewOutBufSize - uiDestLen) < stRequiredBytes) {
+            ulNewOutBufSize *= 2;
+        }
+        if (ulNewOutBufSize == _ulOutBufSize) {
+            return 0;
+        }
+
+        auto * const pNewOutputBuffer = static_cast<unsigned char *> (realloc (_pOutputBuffer, ulNewOutBufSize));
+        if (!pNewOutputBuffer) {
+            checkAndLogMsg ("Lz4ConnectorWriter::reserveOutputBufferSpace", NOMADSUtil::Logger::L_MildError,
+                            "error trying to realloc %lu (previously %lu) bytes\n",
+                            ulNewOutBufSize, _ulOutBufSize);
+            return -1;
+        }
+        _pOutputBuffer = pNewOutputBuffer;
+        _ulOutBufSize = ulNewOutBufSize;
+
+        return 0;
+    }
+
+}
@@ -0,0 +1,87 @@
+#ifndef INCL_LZ4_CONNECTOR_WRITER_H
+#define INCL_LZ4_CONNECTOR_WRITER_H
+
+/*
+ * Lz4ConnectorWriter.h
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * ConnectorWriter compresses data using the LZ4 frame format.
+ * Compression levels 1 and 2 select the fast LZ4 compressor, which is meant
+ * for high-rate links; levels from 3 to 9 select the slower LZ4HC compressor.
+ */
+
+#include "lz4frame.h"
+
+#include "Mutex.h"
+#include "ConnectorWriter.h"
+
+
+namespace ACMNetProxy
+{
+    class Lz4ConnectorWriter : public ConnectorWriter
+    {
+    public:
+        Lz4ConnectorWriter (const CompressionSettings & compressionSettings, bool bUDPDatagrams = false, unsigned long ulOutBufSize = 2048);
+        virtual ~Lz4ConnectorWriter (void);
+
+        virtual const CompressionType getCompressionFlag (void) const;
+        using ConnectorWriter::getCompressionLevel;
+        using ConnectorWriter::getCompressionName;
+        using ConnectorWriter::getCompressionSetting;
+        using ConnectorWriter::isFlushed;
+
+        virtual int lockConnectorWriter (void);
+        virtual int unlockConnectorWriter (void);
+        virtual int flush (unsigned char **pDest, unsigned int &uiDestLen);
+        virtual int writeData (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen, bool bLocalFlush = true);
+        virtual int writeDataAndResetWriter (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen);
+
+
+    private:
+        int beginFrame (unsigned int &uiDestLen);
+        int compressData (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned int &uiDestLen);
+        int endFrame (unsigned int &uiDestLen);
+        int reserveOutputBufferSpace (size_t stRequiredBytes, unsigned int uiDestLen);
+
+        unsigned char * _pOutputBuffer;
+        unsigned long _ulOutBufSize;
+        bool _bFrameStarted;
+        LZ4F_preferences_t _lz4Preferences;
+        LZ4F_cctx * _pCCtx;
+
+        NOMADSUtil::Mutex _mtx;
+    };
+
+
+    inline const CompressionType Lz4ConnectorWriter::getCompressionFlag (void) const
+    {
+        return CompressionType::PMC_LZ4CompressedData;
+    }
+
+    inline int Lz4ConnectorWriter::lockConnectorWriter (void)
+    {
+        return _mtx.lock();
+    }
+
+    inline int Lz4ConnectorWriter::unlockConnectorWriter (void)
+    {
+        return _mtx.unlock();
+    }
+
+}
+
+#endif // INCL_LZ4_CONNECTOR_WRITER_H
@@ -147,7 +147,8 @@ namespace ACMNetProxy
 
         resetDecompStream();
 
-        if (LZMA_OK != lzma_stream_decoder (&_lzmaDecompStream, lzma_easy_decoder_memusage (getCompressionLevel()), DECODER_FLAGS)) {
+        // The UDP reader is shared by all compression levels, so the memory limit must allow decoding any of them
+        if (LZMA_OK != lzma_stream_decoder (&_lzmaDecompStream, lzma_easy_decoder_memusage (CompressionSettings::MAX_COMPRESSION_LEVEL), DECODER_FLAGS)) {
             // throw a c++ exception here
         }
     }
@@ -158,7 +159,7 @@ namespace ACMNetProxy
 
         resetDecompStream();
 
-        if (LZMA_OK != lzma_stream_decoder (&_lzmaDecompStream, lzma_easy_decoder_memusage (getCompressionLevel()), DECODER_FLAGS)) {
+        if (LZMA_OK != lzma_stream_decoder (&_lzmaDecompStream, lzma_easy_decoder_memusage (CompressionSettings::MAX_COMPRESSION_LEVEL), DECODER_FLAGS)) {
             return -1;
         }
 
@@ -69,7 +69,11 @@ namespace ACMNetProxy
         virtual int setIPv4DefaultGatewayAddress (uint32 ui32IPv4DefaultGatewayAddress);
         virtual int setMTU (uint16 ui16MTU);
 
+        // Returns the number of queues that can be read concurrently by different threads
+        virtual uint8 getNumberOfQueues (void) const;
+
         virtual int readPacket (const uint8 ** pui8Buf, uint16 & ui16PacketLen) = 0;
+        virtual int readPacketFromQueue (uint8 ui8Queue, const uint8 ** pui8Buf, uint16 & ui16PacketLen);
         virtual int writePacket (const uint8 * const pui8Buf, uint16 ui16PacketLen) = 0;
 
         static std::string getDeviceNameFromUserFriendlyName (const char * const pcUserFriendlyInterfaceName);
@@ -106,6 +110,22 @@ namespace ACMNetProxy
         _bIsTerminationRequested = true;
     }
 
+    inline uint8 NetworkInterface::getNumberOfQueues (void) const
+    {
+        return 1;
+    }
+
+    inline int NetworkInterface::readPacketFromQueue (uint8 ui8Queue, const uint8 ** pui8Buf, uint16 & ui16PacketLen)
+    {
+        if (ui8Queue != 0) {
+            *pui8Buf = nullptr;
+            ui16PacketLen = 0;
+            return -1;
+        }
+
+        return readPacket (pui8Buf, ui16PacketLen);
+    }
+
     inline NetworkInterface::Type NetworkInterface::getType (void) const
     {
         return _tType;
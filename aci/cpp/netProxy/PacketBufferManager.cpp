@@ -17,6 +17,8 @@
  * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
  */
 
+#include <thread>
+
 #include "Logger.h"
 
 #include "PacketBufferManager.h"
@@ -28,31 +30,103 @@
 
 namespace ACMNetProxy
 {
+    PacketBufferManager::PacketBufferManager (void) :
+        _upcTAPBufs{new char[NetProxyApplicationParameters::WRITE_PACKET_BUFFERS * NetProxyApplicationParameters::ETHERNET_MAX_MFS]},
+        _upaui32NextFreeBuffer{new std::atomic<uint32>[NetProxyApplicationParameters::WRITE_PACKET_BUFFERS]},
+        _aui64FreeBuffersHead{1U}
+    {
+        // Initially, all buffers are in the stack, in order
+        for (uint32 ui32 = 1; ui32 < NetProxyApplicationParameters::WRITE_PACKET_BUFFERS; ++ui32) {
+            _upaui32NextFreeBuffer[ui32 - 1] = ui32 + 1;
+        }
+        _upaui32NextFreeBuffer[NetProxyApplicationParameters::WRITE_PACKET_BUFFERS - 1] = UI32_NO_BUFFER;
+    }
+
+    PacketBufferManager::~PacketBufferManager (void)
+    {
+        // The buffer cached by the calling thread must not be returned to this instance when the thread terminates
+        if (_threadCache.pPacketBufferManager == this) {
+            _threadCache.pPacketBufferManager = nullptr;
+            _threadCache.ui32Buffer = UI32_NO_BUFFER;
+        }
+    }
+
     char * const PacketBufferManager::getAndLockWriteBuf (void)
     {
-        for (int i = 0; i < NetProxyApplicationParameters::WRITE_PACKET_BUFFERS; i++) {
-            if (_amtxTAPBuf[i].try_lock()) {
-                return _cTAPBuf[i];
+        uint32 ui32Buffer;
+        if ((_threadCache.pPacketBufferManager == this) && (_threadCache.ui32Buffer != UI32_NO_BUFFER)) {
+            ui32Buffer = _threadCache.ui32Buffer;
+            _threadCache.ui32Buffer = UI32_NO_BUFFER;
+        }
+        else if ((ui32Buffer = popFreeBuffer()) == UI32_NO_BUFFER) {
+            checkAndLogMsg ("PacketBufferManager::getAndLockWriteBuf", NOMADSUtil::Logger::L_Warning,
+                            "could not find a free buffer; waiting for one to be freed\n");
+            while ((ui32Buffer = popFreeBuffer()) == UI32_NO_BUFFER) {
+                std::this_thread::yield();
             }
         }
 
-        checkAndLogMsg ("PacketBufferManager::getWriteBuf", NOMADSUtil::Logger::L_Warning,
-                        "could not find a free buffer; waiting for one to be freed\n");
-
-        _amtxTAPBuf[0].lock();
-        return _cTAPBuf[0];
+        return _upcTAPBufs.get() + ((ui32Buffer - 1) * NetProxyApplicationParameters::ETHERNET_MAX_MFS);
     }
 
     int PacketBufferManager::findAndUnlockWriteBuf (const void * const pui8Buf) const
     {
-        for (int i = 0; i < NetProxyApplicationParameters::WRITE_PACKET_BUFFERS; i++) {
-            if ((const void * const) _cTAPBuf[i] == pui8Buf) {
-                _amtxTAPBuf[i].unlock();
-                return 0;
+        const uintptr_t uipBuf = reinterpret_cast<uintptr_t> (pui8Buf);
+        const uintptr_t uipTAPBufs = reinterpret_cast<uintptr_t> (_upcTAPBufs.get());
+        if ((uipBuf < uipTAPBufs) ||
+            (uipBuf >= (uipTAPBufs + NetProxyApplicationParameters::WRITE_PACKET_BUFFERS * NetProxyApplicationParameters::ETHERNET_MAX_MFS)) ||
+            (((uipBuf - uipTAPBufs) % NetProxyApplicationParameters::ETHERNET_MAX_MFS) != 0)) {
+            return -1;
+        }
+
+        const uint32 ui32Buffer = static_cast<uint32> ((uipBuf - uipTAPBufs) / NetProxyApplicationParameters::ETHERNET_MAX_MFS) + 1;
+        if (_threadCache.ui32Buffer == UI32_NO_BUFFER) {
+            _threadCache.pPacketBufferManager = this;
+            _threadCache.ui32Buffer = ui32Buffer;
+        }
+        else {
+            pushFreeBuffer (ui32Buffer);
+        }
+
+        return 0;
+    }
+
+    uint32 PacketBufferManager::popFreeBuffer (void) const
+    {
+        uint64 ui64Head = _aui64FreeBuffersHead.load (std::memory_order_acquire);
+        while (true) {
+            const uint32 ui32Buffer = static_cast<uint32> (ui64Head);
+            if (ui32Buffer == UI32_NO_BUFFER) {
+                return UI32_NO_BUFFER;
+            }
+
+            // The value read might be stale if another thread pops the same buffer concurrently; the counter makes the CAS fail in that case
+            const uint64 ui64NewHead = (((ui64Head >> 32) + 1) << 32) |
+                _upaui32NextFreeBuffer[ui32Buffer - 1].load (std::memory_order_relaxed);
+            if (_aui64FreeBuffersHead.compare_exchange_weak (ui64Head, ui64NewHead, std::memory_order_acquire,
+                                                             std::memory_order_acquire)) {
+                return ui32Buffer;
             }
         }
+    }
 
-        return -1;
+    void PacketBufferManager::pushFreeBuffer (uint32 ui32Buffer) const
+    {
+        uint64 ui64Head = _aui64FreeBuffersHead.load (std::memory_order_relaxed);
+        do {
+            _upaui32NextFreeBuffer[ui32Buffer - 1].store (static_cast<uint32> (ui64Head), std::memory_order_relaxed);
+        } while (!_aui64FreeBuffersHead.compare_exchange_weak (ui64Head, (((ui64Head >> 32) + 1) << 32) | ui32Buffer,
+                                                               std::memory_order_release, std::memory_order_relaxed));
     }
 
+    PacketBufferManager::ThreadCache::~ThreadCache (void)
+    {
+        if (pPacketBufferManager && (ui32Buffer != UI32_NO_BUFFER)) {
+            pPacketBufferManager->pushFreeBuffer (ui32Buffer);
+        }
+    }
+
+
+    thread_local PacketBufferManager::ThreadCache PacketBufferManager::_threadCache{nullptr, PacketBufferManager::UI32_NO_BUFFER};
+    constexpr uint32 PacketBufferManager::UI32_NO_BUFFER;
 }
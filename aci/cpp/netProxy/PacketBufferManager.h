@@ -19,12 +19,23 @@
  * Alternative licenses that allow for use within commercial products may be
  * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
  *
- * Class that provides the functions to manage an array
- * of memory buffers with mutually exclusive access.
+ * Class that provides the functions to manage a pool of memory
+ * buffers with mutually exclusive access.
+ * Free buffers are kept in a lock-free stack shared by all threads;
+ * in addition, each thread caches the last buffer it released, so
+ * that the common case of a thread that acquires and releases one
+ * buffer at a time does not touch any shared state. The buffer
+ * cached by a thread is returned to the shared stack when the thread
+ * terminates, so the PacketBufferManager must outlive all threads
+ * that use it.
+ * The memory of the pool is reserved upfront, but the operating
+ * system only commits the pages of the buffers that are used.
  */
 
-#include <array>
-#include <mutex>
+#include <atomic>
+#include <memory>
+
+#include "FTypes.h"
 
 #include "ConfigurationParameters.h"
 
@@ -35,6 +46,7 @@ namespace ACMNetProxy
     {
     public:
         PacketBufferManager (void);
+        ~PacketBufferManager (void);
         PacketBufferManager (const PacketBufferManager & rhPBM) = delete;
         PacketBufferManager & operator = (const PacketBufferManager & rhPBM) = delete;
 
@@ -43,15 +55,28 @@ namespace ACMNetProxy
 
 
     private:
-        char _cTAPBuf[NetProxyApplicationParameters::WRITE_PACKET_BUFFERS][NetProxyApplicationParameters::ETHERNET_MAX_MFS];
+        // Buffers are identified by their index + 1, so that 0 means no buffer
+        static constexpr uint32 UI32_NO_BUFFER = 0U;
 
-        mutable std::array<std::mutex, NetProxyApplicationParameters::WRITE_PACKET_BUFFERS> _amtxTAPBuf;
-    };
+        struct ThreadCache
+        {
+            ~ThreadCache (void);
+
+            const PacketBufferManager * pPacketBufferManager;
+            uint32 ui32Buffer;
+        };
 
+        uint32 popFreeBuffer (void) const;
+        void pushFreeBuffer (uint32 ui32Buffer) const;
 
-    inline PacketBufferManager::PacketBufferManager (void) :
-        _cTAPBuf{}, _amtxTAPBuf{}
-    { }
+
+        std::unique_ptr<char[]> _upcTAPBufs;
+        std::unique_ptr<std::atomic<uint32>[]> _upaui32NextFreeBuffer;
+        // The lower 32 bits hold the buffer at the top of the stack, the upper 32 bits a counter that prevents the ABA problem
+        mutable std::atomic<uint64> _aui64FreeBuffersHead;
+
+        static thread_local ThreadCache _threadCache;
+    };
 }
 
 #endif   // #ifndef INCL_PACKET_BUFFER_MANAGER_H
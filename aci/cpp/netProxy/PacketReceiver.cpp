@@ -38,6 +38,7 @@ namespace ACMNetProxy
         std::swap (_sThreadName, packetReceiver._sThreadName);
         std::swap (_spNetworkInterface, packetReceiver._spNetworkInterface);
         std::swap (_fPacketHandler, packetReceiver._fPacketHandler);
+        std::swap (_ui8Queue, packetReceiver._ui8Queue);
 
         return *this;
     }
@@ -84,9 +85,10 @@ namespace ACMNetProxy
 
         _bRunning = true;
         while (!terminationRequested()) {
-            if ((rc = _spNetworkInterface->readPacket (&pui8Buf, ui16PacketLen)) != 0) {
+            if ((rc = _spNetworkInterface->readPacketFromQueue (_ui8Queue, &pui8Buf, ui16PacketLen)) != 0) {
                 checkAndLogMsg ("PacketReceiver::run", NOMADSUtil::Logger::L_MildError,
-                                "readPacket() on thread %s failed with rc = %d\n", _sThreadName.c_str(), rc);
+                                "readPacketFromQueue() of queue %hhu on thread %s failed with rc = %d\n",
+                                _ui8Queue, _sThreadName.c_str(), rc);
             }
             else if (pui8Buf && (ui16PacketLen > 0)) {
                 if ((rc = _fPacketHandler (const_cast<uint8 *> (pui8Buf), ui16PacketLen, _spNetworkInterface.get())) < 0) {
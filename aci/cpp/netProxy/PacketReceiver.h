@@ -22,7 +22,9 @@
 * Thread that listens for new incoming packets on a newtork interface.
 * Each received packet is dispatched to a handling function.
 * The references to the network interface and handling function are
-* passed in as parameters to the constructor.
+* passed in as parameters to the constructor, together with the queue
+* of the interface that the thread reads, in case of interfaces that
+* support multiple queues.
 */
 
 #include <string>
@@ -48,12 +50,14 @@ namespace ACMNetProxy
     public:
         PacketReceiver (void);
         PacketReceiver (const std::string & sThreadName, std::shared_ptr<NetworkInterface> spNetworkInterface,
-                        const std::function<int(uint8 * const, uint16, NetworkInterface * const)> & fPacketHandler);
+                        const std::function<int(uint8 * const, uint16, NetworkInterface * const)> & fPacketHandler,
+                        uint8 ui8Queue = 0);
         PacketReceiver (PacketReceiver && packetReceiver);
 
         PacketReceiver & operator = (PacketReceiver && packetReceiver);
 
         const std::string & getThreadName (void) const;
+        uint8 getQueue (void) const;
         bool isRunning (void) const;
         bool terminationRequested (void) const;
 
@@ -72,6 +76,7 @@ namespace ACMNetProxy
         std::string _sThreadName;
         std::shared_ptr<NetworkInterface> _spNetworkInterface;
         std::function<int(uint8 * const, uint16, NetworkInterface * const)> _fPacketHandler;
+        uint8 _ui8Queue;
 
         mutable bool _bJoined;
         mutable std::mutex _mtx;
@@ -80,13 +85,14 @@ namespace ACMNetProxy
 
     inline PacketReceiver::PacketReceiver (void) :
         _bRunning{false}, _bTerminationRequested{false}, _pThread{nullptr}, _sThreadName{""},
-        _spNetworkInterface{nullptr}, _fPacketHandler{}, _bJoined{false}
+        _spNetworkInterface{nullptr}, _fPacketHandler{}, _ui8Queue{0}, _bJoined{false}
     { }
 
     inline PacketReceiver::PacketReceiver (const std::string & sThreadName, std::shared_ptr<NetworkInterface> spNetworkInterface,
-                                           const std::function<int(uint8 * const, uint16, NetworkInterface * const)> & fPacketHandler) :
+                                           const std::function<int(uint8 * const, uint16, NetworkInterface * const)> & fPacketHandler,
+                                           uint8 ui8Queue) :
         _bRunning{false}, _bTerminationRequested{false}, _pThread{nullptr}, _sThreadName{sThreadName},
-        _spNetworkInterface{spNetworkInterface}, _fPacketHandler{fPacketHandler}, _bJoined{false}
+        _spNetworkInterface{spNetworkInterface}, _fPacketHandler{fPacketHandler}, _ui8Queue{ui8Queue}, _bJoined{false}
     {
         if (_spNetworkInterface == nullptr) {
             throw new std::invalid_argument {"pNetworkInteface is NULL"};
@@ -95,7 +101,7 @@ namespace ACMNetProxy
 
     inline PacketReceiver::PacketReceiver (PacketReceiver && packetReceiver) :
         _bRunning{false}, _bTerminationRequested{false}, _pThread{std::move (packetReceiver._pThread)}, _sThreadName{""},
-        _spNetworkInterface{nullptr}, _fPacketHandler{nullptr}, _bJoined{packetReceiver._bJoined}
+        _spNetworkInterface{nullptr}, _fPacketHandler{nullptr}, _ui8Queue{packetReceiver._ui8Queue}, _bJoined{packetReceiver._bJoined}
     {
         _bRunning.exchange (packetReceiver._bRunning);
         std::swap (_sThreadName, packetReceiver._sThreadName);
@@ -108,6 +114,11 @@ namespace ACMNetProxy
         return _sThreadName;
     }
 
+    inline uint8 PacketReceiver::getQueue (void) const
+    {
+        return _ui8Queue;
+    }
+
     inline bool PacketReceiver::isRunning(void) const
     {
         return _bRunning;
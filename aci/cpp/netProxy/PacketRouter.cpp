@@ -31,6 +31,7 @@
 #include "FTypes.h"
 #include "SequentialArithmetic.h"
 #include "net/NetUtils.h"
+#include "net/InternetChecksum.h"
 #include "InetAddr.h"
 #include "NetSensor.h"
 #include "Logger.h"
@@ -215,10 +216,17 @@ namespace ACMNetProxy
             [this] (uint8 * const ui8Packet, uint16 ui16PacketLen, NetworkInterface * const pNI) {
                 return handlePacketFromInternalInterface (ui8Packet, ui16PacketLen, pNI);
         };
-        _internalPacketReceiverThread = PacketReceiver{"Internal PacketReceiver Thread", PacketRouter::_spInternalInterface,
-                                                       fInternalInterfacePacketHandler};
-        if (0 != _internalPacketReceiverThread.start()) {
-            return -2;
+        // One thread for each queue of the internal interface; the PacketReceiver instances must not be moved once started
+        const uint8 ui8InternalInterfaceQueues = _spInternalInterface->getNumberOfQueues();
+        _vInternalPacketReceiverThreads.reserve (ui8InternalInterfaceQueues);
+        for (uint8 ui8Queue = 0; ui8Queue < ui8InternalInterfaceQueues; ++ui8Queue) {
+            _vInternalPacketReceiverThreads.emplace_back ((ui8InternalInterfaceQueues > 1) ?
+                                                          ("Internal PacketReceiver Thread (queue " + std::to_string (ui8Queue) + ")") :
+                                                          std::string{"Internal PacketReceiver Thread"},
+                                                          PacketRouter::_spInternalInterface, fInternalInterfacePacketHandler, ui8Queue);
+            if (0 != _vInternalPacketReceiverThreads.back().start()) {
+                return -2;
+            }
         }
 
         if (NetProxyApplicationParameters::LEVEL2_TUNNEL_MODE) {
@@ -288,8 +296,13 @@ namespace ACMNetProxy
     int PacketRouter::joinThreads (void)
     {
         int rc;
-        if (0 != _internalPacketReceiverThread.join()) {
-            return -1;
+        for (auto & prInternalInterfaceThread : _vInternalPacketReceiverThreads) {
+            if (0 != (rc = prInternalInterfaceThread.join())) {
+                checkAndLogMsg ("PacketRouter::joinThreads", NOMADSUtil::Logger::L_Warning,
+                                "error while trying to join() internalPacketReceiverThread with name %s; "
+                                "rc = %d\n", prInternalInterfaceThread.getThreadName().c_str(), rc);
+                return -1;
+            }
         }
 
         if (NetProxyApplicationParameters::LEVEL2_TUNNEL_MODE) {
@@ -346,8 +359,10 @@ namespace ACMNetProxy
         }
         _bTerminationRequested = true;
 
-        // Terminate the internal receiver thread
-        _internalPacketReceiverThread.requestTermination();
+        // Terminate the internal receiver threads
+        for (auto & prInternalInterfaceThread : _vInternalPacketReceiverThreads) {
+            prInternalInterfaceThread.requestTermination();
+        }
         if (_spInternalInterface) {
             _spInternalInterface->requestTermination();
         }
@@ -489,7 +504,8 @@ namespace ACMNetProxy
     int PacketRouter::handlePacketFromInternalInterface (uint8 * const pPacket, uint16 ui16PacketLen,
                                                          NetworkInterface * const pReceivingNetworkInterface)
     {
-        static int rc = 0;
+        // Invoked concurrently by the PacketReceiver threads of all the queues of the internal interface
+        int rc = 0;
         NOMADSUtil::EtherFrameHeader * const pEthHeader = reinterpret_cast<NOMADSUtil::EtherFrameHeader *> (pPacket);
         ntoh (pEthHeader);
 
@@ -896,8 +912,11 @@ namespace ACMNetProxy
                 if (!NetProxyApplicationParameters::TRANSPARENT_GATEWAY_MODE) {
                     // Non-transparent Gateway Mode
                     if (pIPHeader->ui8TTL > 1) {
-                        // Decrement the TTL
+                        // Decrement the TTL and update the header checksum (stored in host byte order) incrementally
+                        const uint16 ui16OldTTLAndProto = (static_cast<uint16> (pIPHeader->ui8TTL) << 8) | pIPHeader->ui8Proto;
                         --(pIPHeader->ui8TTL);
+                        pIPHeader->ui16CRC = NOMADSUtil::InternetChecksum::update (pIPHeader->ui16CRC, ui16OldTTLAndProto,
+                                                                                    static_cast<uint16> (ui16OldTTLAndProto - 0x0100));
                         checkAndLogMsg ("PacketRouter::handlePacketFromInternalInterface", NOMADSUtil::Logger::L_HighDetailDebug,
                                         "received an IPv4 packet (IPv4 protocol type: %hhu - source: %s - destination: %s) of %hu "
                                         "bytes long; the value of the TTL field was decremented to %hhu\n", pIPHeader->ui8Proto,
@@ -927,15 +946,15 @@ namespace ACMNetProxy
                 if (isMACAddrBroadcast (pEthHeader->dest) || isMACAddrMulticast (pEthHeader->dest)) {
                     // Received a packet with a broadcast or a Multicast Ethernet address
                     if ((isMACAddrBroadcast (pEthHeader->dest) &&
-                        (_umInterfacesBroadcastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()].size() > 0)) ||
+                        (getPacketForwardingRules (_umInterfacesBroadcastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName()).size() > 0)) ||
                         (isMACAddrMulticast (pEthHeader->dest) &&
-                        (_umInterfacesMulticastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()].size() > 0))) {
+                        (getPacketForwardingRules (_umInterfacesMulticastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName()).size() > 0))) {
 
                         // Check if broadcast traffic belongs to the same network of the internal interfaces
                         std::unordered_set<std::shared_ptr<NetworkInterface>> usTargetInterfaces;
                         if (isMACAddrBroadcast (pEthHeader->dest)) {
                             const auto & usBroadcastForwardingInterfaces =
-                                _umInterfacesBroadcastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()];
+                                getPacketForwardingRules (_umInterfacesBroadcastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName());
                             for (const auto & spNI : usBroadcastForwardingInterfaces) {
                                 if (ui32DestAddr == 0xFFFFFFFFU) {
                                     usTargetInterfaces.insert (spNI);
@@ -947,13 +966,12 @@ namespace ACMNetProxy
                             }
                         }
                         else {
-                            usTargetInterfaces = _umInterfacesMulticastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()];
+                            usTargetInterfaces = getPacketForwardingRules (_umInterfacesMulticastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName());
                         }
 
                         // Forward multicast/broadcast packets on all external interfaces
                         pIPHeader->srcAddr.ui32Addr = ntohl (ui32SrcAddr);
                         pIPHeader->destAddr.ui32Addr = ntohl (ui32DestAddr);
-                        pIPHeader->computeChecksum();
                         pIPHeader->hton();
                         hton (pEthHeader);
                         if (0 != (rc = sendPacketToHost (usTargetInterfaces, pPacket, ui16PacketLen))) {
@@ -1023,7 +1041,6 @@ namespace ACMNetProxy
 
                     pIPHeader->srcAddr.ui32Addr = ntohl (ui32SrcAddr);
                     pIPHeader->destAddr.ui32Addr = ntohl (ui32DestAddr);
-                    pIPHeader->computeChecksum();
                     pIPHeader->hton();
                     hton (pEthHeader);
                     /* Find the external network whose netmask is the longest prefix match for the current destination address.
@@ -1269,7 +1286,6 @@ namespace ACMNetProxy
                         pUDPHeader->hton();
                         pIPHeader->srcAddr.ui32Addr = ntohl (ui32SrcAddr);
                         pIPHeader->destAddr.ui32Addr = ntohl (ui32DestAddr);
-                        pIPHeader->computeChecksum();
                         pIPHeader->hton();
                         hton (pEthHeader);
                         if (0 != (rc = sendPacketToHost (spSelectedNetworkInterface.get(), pPacket, ui16PacketLen))) {
@@ -1535,7 +1551,6 @@ namespace ACMNetProxy
                     pTCPHeader->hton();
                     pIPHeader->srcAddr.ui32Addr = ntohl (ui32SrcAddr);
                     pIPHeader->destAddr.ui32Addr = ntohl (ui32DestAddr);
-                    pIPHeader->computeChecksum();
                     pIPHeader->hton();
                     hton (pEthHeader);
                     if (0 != (rc = sendPacketToHost (spSelectedNetworkInterface.get(), pPacket, ui16PacketLen))) {
@@ -1989,8 +2004,11 @@ namespace ACMNetProxy
             if (!NetProxyApplicationParameters::TRANSPARENT_GATEWAY_MODE) {
                 // Non-transparent Gateway Mode
                 if (pIPHeader->ui8TTL > 1) {
-                    // Decrement the TTL
+                    // Decrement the TTL and update the header checksum (stored in host byte order) incrementally
+                    const uint16 ui16OldTTLAndProto = (static_cast<uint16> (pIPHeader->ui8TTL) << 8) | pIPHeader->ui8Proto;
                     --(pIPHeader->ui8TTL);
+                    pIPHeader->ui16CRC = NOMADSUtil::InternetChecksum::update (pIPHeader->ui16CRC, ui16OldTTLAndProto,
+                                                                                static_cast<uint16> (ui16OldTTLAndProto - 0x0100));
                     checkAndLogMsg ("PacketRouter::handlePacketFromExternalInterface", NOMADSUtil::Logger::L_HighDetailDebug,
                                     "received an IPv4 packet (IPv4 protocol type: %hhu - source: %s - destination: %s) "
                                     "of %hu bytes long; the value of the TTL field was decremented to %hhu;\n",
@@ -2009,15 +2027,15 @@ namespace ACMNetProxy
             }
 
             if ((isMACAddrBroadcast (pEthHeader->dest) &&
-                (_umInterfacesBroadcastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()].size() > 0)) ||
+                (getPacketForwardingRules (_umInterfacesBroadcastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName()).size() > 0)) ||
                 (isMACAddrMulticast (pEthHeader->dest) &&
-                (_umInterfacesMulticastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()].size() > 0))) {
+                (getPacketForwardingRules (_umInterfacesMulticastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName()).size() > 0))) {
 
                 // Check if broadcast traffic belongs to the same network of the internal interfaces
                 std::unordered_set<std::shared_ptr<NetworkInterface>> usTargetInterfaces{};
                 if (isMACAddrBroadcast (pEthHeader->dest)) {
                     const auto & usBroadcastForwardingInterfaces =
-                        _umInterfacesBroadcastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()];
+                        getPacketForwardingRules (_umInterfacesBroadcastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName());
                     for (const auto & spNI : usBroadcastForwardingInterfaces) {
                         if (ui32DestAddr == 0xFFFFFFFFU) {
                             usTargetInterfaces.insert (spNI);
@@ -2029,13 +2047,12 @@ namespace ACMNetProxy
                     }
                 }
                 else {
-                    usTargetInterfaces = _umInterfacesMulticastPacketsForwardingRules[pReceivingNetworkInterface->getUserFriendlyInterfaceName()];
+                    usTargetInterfaces = getPacketForwardingRules (_umInterfacesMulticastPacketsForwardingRules, pReceivingNetworkInterface->getUserFriendlyInterfaceName());
                 }
 
                 // Forward multicast/broadcast packets onto the internal network
                 pIPHeader->srcAddr.ui32Addr = ntohl (ui32SrcAddr);
                 pIPHeader->destAddr.ui32Addr = ntohl (ui32DestAddr);
-                pIPHeader->computeChecksum();
                 pIPHeader->hton();
                 hton (pEthHeader);
                 if (0 != (rc = sendPacketToHost (usTargetInterfaces, pPacket, ui16PacketLen))) {
@@ -2058,7 +2075,6 @@ namespace ACMNetProxy
                 // The destination MAC address does not belong to any node in the external network --> forward the packet
                 pIPHeader->srcAddr.ui32Addr = ntohl (ui32SrcAddr);
                 pIPHeader->destAddr.ui32Addr = ntohl (ui32DestAddr);
-                pIPHeader->computeChecksum();
                 pIPHeader->hton();
                 hton (pEthHeader);
                 if (0 != (rc = sendPacketToHost (_spInternalInterface.get(), pPacket, ui16PacketLen))) {
@@ -2780,6 +2796,8 @@ namespace ACMNetProxy
         // It might be necessary to split UDP Packet at the level of the IP protocol
         uint16 ui16WrittenBytes = 0;
         while (ui16WrittenBytes < pUDPPacket->ui16Len) {
+            const uint16 ui16PreviousTLen = pIPHeader->ui16TLen;
+            const uint16 ui16PreviousFlagsAndFragOff = pIPHeader->ui16FlagsAndFragOff;
             if ((pUDPPacket->ui16Len - ui16WrittenBytes) > MAX_UDP_PACKET_LENGTH) {
                 pIPHeader->ui16TLen = ((MAX_UDP_PACKET_LENGTH / 8) * 8) + sizeof(NOMADSUtil::IPHeader);
                 pIPHeader->ui16FlagsAndFragOff = IP_MF_FLAG_FILTER | (((ui16WrittenBytes / 8) & IP_OFFSET_FILTER));
@@ -2788,7 +2806,15 @@ namespace ACMNetProxy
                 pIPHeader->ui16TLen = (pUDPPacket->ui16Len - ui16WrittenBytes) + sizeof(NOMADSUtil::IPHeader);
                 pIPHeader->ui16FlagsAndFragOff = ((ui16WrittenBytes / 8) & IP_OFFSET_FILTER);
             }
-            pIPHeader->computeChecksum();
+            if (ui16WrittenBytes == 0) {
+                pIPHeader->computeChecksum();
+            }
+            else {
+                // Only the total length and the fragment offset differ from the previous fragment
+                pIPHeader->ui16CRC = NOMADSUtil::InternetChecksum::update (pIPHeader->ui16CRC, ui16PreviousTLen, pIPHeader->ui16TLen);
+                pIPHeader->ui16CRC = NOMADSUtil::InternetChecksum::update (pIPHeader->ui16CRC, ui16PreviousFlagsAndFragOff,
+                                                                           pIPHeader->ui16FlagsAndFragOff);
+            }
             memcpy (pUDPHeader, reinterpret_cast<const uint8 *> (pUDPPacket) + ui16WrittenBytes, pIPHeader->ui16TLen - sizeof(NOMADSUtil::IPHeader));
             if (ui16WrittenBytes == 0) {
                 // Set the checksum field of the UDP header to zero to avoid the UDP checksum check at the receiver
@@ -3201,7 +3227,7 @@ namespace ACMNetProxy
 
         std::shared_ptr<NetworkInterface> spInternalNetworkInterface {NetProxyApplicationParameters::GATEWAY_MODE ?
             static_cast<NetworkInterface *> (PCapInterface::getPCapInterface (NetProxyApplicationParameters::NID_INTERNAL_INTERFACE.sInterfaceName.c_str())) :
-            static_cast<NetworkInterface *> (TapInterface::createAndInitTAPInterface())};
+            static_cast<NetworkInterface *> (TapInterface::createAndInitTAPInterface (NetProxyApplicationParameters::TAP_INTERFACE_QUEUES))};
         if (!spInternalNetworkInterface) {
             checkAndLogMsg ("PacketRouter::setupNetworkInterfaces", NOMADSUtil::Logger::L_SevereError,
                             "an invalid (nullptr) handler returned from the call to %s\n",
@@ -3257,8 +3283,9 @@ namespace ACMNetProxy
             return 0;
         }
 
-        auto & rdeqCachedPackets = _ARPTableMissCache.lookup (ui32DestinationIPAddress);
-        for (auto & rATMP : rdeqCachedPackets) {
+        // The packets are taken out of the cache, so that they are sent only once if the MAC address is received on more queues
+        auto deqCachedPackets = _ARPTableMissCache.extract (ui32DestinationIPAddress);
+        for (auto & rATMP : deqCachedPackets) {
             if (0 != (rc = wrapEthernetIPFrameAndSendToHost (rATMP.getNetworkInterface(), rATMP.getPacket(), rATMP.getPacketLen()))) {
                 checkAndLogMsg ("PacketRouter::sendCachedPacketsToDestination", NOMADSUtil::Logger::L_MildError,
                                 "failed trying to resend a cached packet to host with IP %s; "
@@ -3268,7 +3295,6 @@ namespace ACMNetProxy
             }
             ++counter;
         }
-        _ARPTableMissCache.remove (ui32DestinationIPAddress);
 
         return counter;
     }
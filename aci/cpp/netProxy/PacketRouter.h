@@ -118,6 +118,10 @@ namespace ACMNetProxy
         void addMACToIntHostsSet (const NOMADSUtil::EtherMACAddr & macAddr);
         void addMACToExtHostsSet (const NOMADSUtil::EtherMACAddr & macAddr);
         void updateMulticastBroadcastPacketForwardingRulesForNID (const NetworkInterfaceDescriptor & nid);
+        // Unlike operator[], it never inserts into umRules, that the PacketReceiver threads read concurrently
+        static const std::unordered_set<std::shared_ptr<NetworkInterface>> & getPacketForwardingRules (
+            const std::unordered_map<std::string, std::unordered_set<std::shared_ptr<NetworkInterface>>> & umRules,
+            const std::string & sInterfaceName);
 
         // The following method is useful whenever a new Connection has been established, to reduce latency in case there are enqued packets/requests
         void wakeUpAutoConnectionAndRemoteTransmitterThreads (void);
@@ -235,8 +239,8 @@ namespace ACMNetProxy
             static IHMC_ACI::DisseminationService * const _pDisService;
         #endif
 
-        // Handles receiving data from host's virtual interface (in host mode) or from the internal network (in gateway mode)
-        PacketReceiver _internalPacketReceiverThread;
+        // Handle receiving data from host's virtual interface (in host mode, one for each queue) or from the internal network (in gateway mode)
+        std::vector<PacketReceiver> _vInternalPacketReceiverThreads;
         // Keeps track of all handlers that receive data from an external interface (in gateway mode)
         std::vector<PacketReceiver> _vExternalPacketReceiverThreads;
         // Handles storing, buffering, wrapping, and subsequent forwarding of received UDP datagram packets
@@ -358,6 +362,16 @@ namespace ACMNetProxy
         _usExternalHosts.emplace (etherMACAddrTouint64 (macAddr));
     }
 
+    inline const std::unordered_set<std::shared_ptr<NetworkInterface>> & PacketRouter::getPacketForwardingRules (
+        const std::unordered_map<std::string, std::unordered_set<std::shared_ptr<NetworkInterface>>> & umRules,
+        const std::string & sInterfaceName)
+    {
+        static const std::unordered_set<std::shared_ptr<NetworkInterface>> usNoRules{};
+
+        const auto cit = umRules.find (sInterfaceName);
+        return (cit != umRules.cend()) ? cit->second : usNoRules;
+    }
+
     inline MutexCounter<uint16> * const PacketRouter::getMutexCounter (void)
     {
         static MutexCounter<uint16>
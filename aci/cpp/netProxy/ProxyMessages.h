@@ -62,7 +62,9 @@ namespace ACMNetProxy
     {
         PMC_UncompressedData = 0x00,            //0000 0000
         PMC_ZLibCompressedData = 0x10,          //0001 0000
-        PMC_LZMACompressedData = 0x20           //0010 0000
+        PMC_LZMACompressedData = 0x20,          //0010 0000
+        PMC_LZ4CompressedData = 0x30,           //0011 0000
+        PMC_ZstdCompressedData = 0x40           //0100 0000
     };
 
 
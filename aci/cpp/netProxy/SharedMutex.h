@@ -0,0 +1,180 @@
+#ifndef INCL_SHARED_MUTEX_H
+#define INCL_SHARED_MUTEX_H
+
+/*
+ * SharedMutex.h
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * SharedMutex is a readers-writer lock for data structures that are read
+ * far more often than they are modified, which is not available in C++11.
+ * Acquiring and releasing the lock in shared mode only costs one atomic
+ * increment and one atomic decrement of a counter that is selected by the
+ * calling thread among READER_COUNTERS counters, each in its own cache line,
+ * so that readers running on different cores neither contend on a mutex nor
+ * on the same cache line. Writers are serialized by a mutex and wait (yielding
+ * the CPU) until all readers have left the critical section; readers that
+ * arrive while a writer holds or is acquiring the lock wait for it to finish.
+ * Critical sections, in both modes, are expected to be short.
+ * The class meets the Lockable requirements, so that std::lock_guard and
+ * std::unique_lock can be used to acquire the lock in exclusive mode;
+ * SharedLockGuard acquires the lock in shared mode.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+
+namespace ACMNetProxy
+{
+    class SharedMutex
+    {
+    public:
+        SharedMutex (void);
+        explicit SharedMutex (const SharedMutex & rSharedMutex) = delete;
+
+        void lock (void);
+        bool try_lock (void);
+        void unlock (void);
+
+        void lock_shared (void);
+        void unlock_shared (void);
+
+        static const unsigned int READER_COUNTERS = 16;
+
+
+    private:
+        struct alignas(64) ReaderCounter
+        {
+            std::atomic<int> aiReaders;
+        };
+
+        static unsigned int getReaderCounterIndex (void);
+        bool areThereReaders (void) const;
+
+        ReaderCounter _readerCounters[READER_COUNTERS];
+        std::atomic<bool> _abWriter;
+        std::mutex _mtxWriters;
+    };
+
+
+    class SharedLockGuard
+    {
+    public:
+        explicit SharedLockGuard (SharedMutex & rSharedMutex);
+        explicit SharedLockGuard (const SharedLockGuard & rSharedLockGuard) = delete;
+        ~SharedLockGuard (void);
+
+
+    private:
+        SharedMutex & _rSharedMutex;
+    };
+
+
+    inline SharedMutex::SharedMutex (void) :
+        _abWriter{false}
+    {
+        for (auto & rReaderCounter : _readerCounters) {
+            rReaderCounter.aiReaders = 0;
+        }
+    }
+
+    inline unsigned int SharedMutex::getReaderCounterIndex (void)
+    {
+        // Threads are assigned to the counters in a round-robin fashion the first time they acquire any SharedMutex
+        static std::atomic<unsigned int> aNextIndex{0};
+        static thread_local const unsigned int uiIndex = aNextIndex++ % READER_COUNTERS;
+
+        return uiIndex;
+    }
+
+    inline bool SharedMutex::areThereReaders (void) const
+    {
+        for (const auto & rReaderCounter : _readerCounters) {
+            if (rReaderCounter.aiReaders.load() != 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    inline void SharedMutex::lock (void)
+    {
+        _mtxWriters.lock();
+        _abWriter = true;
+        while (areThereReaders()) {
+            std::this_thread::yield();
+        }
+    }
+
+    inline bool SharedMutex::try_lock (void)
+    {
+        if (!_mtxWriters.try_lock()) {
+            return false;
+        }
+        _abWriter = true;
+        if (areThereReaders()) {
+            _abWriter = false;
+            _mtxWriters.unlock();
+            return false;
+        }
+
+        return true;
+    }
+
+    inline void SharedMutex::unlock (void)
+    {
+        _abWriter = false;
+        _mtxWriters.unlock();
+    }
+
+    inline void SharedMutex::lock_shared (void)
+    {
+        std::atomic<int> & raiReaders = _readerCounters[getReaderCounterIndex()].aiReaders;
+        while (true) {
+            ++raiReaders;
+            if (!_abWriter.load()) {
+                return;
+            }
+
+            // A writer holds the lock or is waiting for the readers to leave
+            --raiReaders;
+            while (_abWriter.load()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    inline void SharedMutex::unlock_shared (void)
+    {
+        --_readerCounters[getReaderCounterIndex()].aiReaders;
+    }
+
+    inline SharedLockGuard::SharedLockGuard (SharedMutex & rSharedMutex) :
+        _rSharedMutex{rSharedMutex}
+    {
+        _rSharedMutex.lock_shared();
+    }
+
+    inline SharedLockGuard::~SharedLockGuard (void)
+    {
+        _rSharedMutex.unlock_shared();
+    }
+}
+
+#endif      // INCL_SHARED_MUTEX_H
@@ -37,7 +37,7 @@ namespace ACMNetProxy
             return nullptr;
         }
 
-        std::lock_guard<std::mutex> lg{_mtx};
+        SharedLockGuard slg{_smtx};
         if (static_cast<long> (ui16LocalID - 1) <= _entries.getHighestIndex()) {
             Entry *pEntry = &_entries.get (ui16LocalID - 1);
             if (pEntry && (pEntry->ui16ID == ui16LocalID)) {
@@ -55,7 +55,7 @@ namespace ACMNetProxy
             return nullptr;
         }
 
-        std::lock_guard<std::mutex> lg{_mtx};
+        SharedLockGuard slg{_smtx};
         if (static_cast<long> (ui16LocalID - 1) <= _entries.getHighestIndex()) {
             Entry *pEntry = &_entries.get (ui16LocalID - 1);
             if (pEntry && (pEntry->ui16ID == ui16LocalID) &&
@@ -73,60 +73,73 @@ namespace ACMNetProxy
     {
         Entry * pEntry = nullptr;
 
-        std::lock_guard<std::mutex> lg{_mtx};
-        // See if there is an entry for the specified parameters
-        for (long i = 0; i <= _entries.getHighestIndex(); ++i) {
-            pEntry = &_entries.get (i);
-            if (pEntry && (pEntry->ui32LocalIP == ui32LocalIP) && (pEntry->ui16LocalPort == ui16LocalPort) &&
-                (pEntry->ui32RemoteIP == ui32RemoteIP) && (pEntry->ui16RemotePort == ui16RemotePort)) {
+        {
+            // See if there is an entry for the specified parameters
+            SharedLockGuard slg{_smtx};
+            const long lPos = findRecord (ui32LocalIP, ui16LocalPort, ui32RemoteIP, ui16RemotePort);
+            if (lPos >= 0) {
+                pEntry = &_entries.get (_index[lPos].lSlot);
+                if (matches (pEntry, _index[lPos])) {
+                    // Found the entry
+                    return pEntry;
+                }
+            }
+        }
+
+        std::lock_guard<SharedMutex> lg{_smtx};
+        // Look for the entry again, since another thread might have added it in the meantime
+        const long lPos = findRecord (ui32LocalIP, ui16LocalPort, ui32RemoteIP, ui16RemotePort);
+        if (lPos >= 0) {
+            pEntry = &_entries.get (_index[lPos].lSlot);
+            if (matches (pEntry, _index[lPos])) {
                 // Found the entry
                 return pEntry;
             }
+
+            // The entry was cleared after the record was added to the index
+            removeRecord (_index[lPos].lSlot);
         }
 
         // No entry exists for the specified parameters - return an unused one
-        for (long i = 0; i <= _entries.getHighestIndex(); ++i) {
-            pEntry = &_entries.get (i);
-            if (!pEntry || (pEntry->localState == TCTLS_LISTEN)) {
-                if (!pEntry) {
-                    // Allocate new Entry
-                    pEntry = &_entries[i];
-                }
-                else {
-                    // Clear the Entry
-                    pEntry->clear();
-                }
-                pEntry->ui16ID = static_cast<uint16> (i + 1);
-                pEntry->ui32LocalIP = ui32LocalIP;
-                pEntry->ui16LocalPort = ui16LocalPort;
-                pEntry->ui32RemoteIP = ui32RemoteIP;
-                pEntry->ui16RemotePort = ui16RemotePort;
-                pEntry->assignedPriority = uint32AssignedPriority;
-                return pEntry;
+        long lIndex = getFreeSlot();
+        if (lIndex >= 0) {
+            pEntry = &_entries.get (lIndex);
+            if (!pEntry) {
+                // Allocate new Entry
+                pEntry = &_entries[lIndex];
+            }
+            else {
+                // Clear the Entry
+                pEntry->clear();
             }
+            removeRecord (lIndex);
         }
-
-        // No unused entries - create a new one if we can
-        const long lNewIndex = (_entries.getHighestIndex() >= 0) ? (_entries.getHighestIndex() + 1) : 0;
-        if (lNewIndex > 65534) {
-            // Can't use this because it would cause a problem with the ui16ID field
-            checkAndLogMsg ("TCPConnTable::getEntry", NOMADSUtil::Logger::L_MildError,
-                            "no slots available in the TCP Connection Table\n");
-            return nullptr;
+        else {
+            // No unused entries - create a new one if we can
+            lIndex = (_entries.getHighestIndex() >= 0) ? (_entries.getHighestIndex() + 1) : 0;
+            if (lIndex > 65534) {
+                // Can't use this because it would cause a problem with the ui16ID field
+                checkAndLogMsg ("TCPConnTable::getEntry", NOMADSUtil::Logger::L_MildError,
+                                "no slots available in the TCP Connection Table\n");
+                return nullptr;
+            }
+            pEntry = &_entries[lIndex];
+            ++_ui32AppendedSlotsSinceScan;
         }
-        pEntry = &_entries[lNewIndex];
-        pEntry->ui16ID = static_cast<uint16> (lNewIndex + 1);
+        pEntry->ui16ID = static_cast<uint16> (lIndex + 1);
         pEntry->ui32LocalIP = ui32LocalIP;
         pEntry->ui16LocalPort = ui16LocalPort;
         pEntry->ui32RemoteIP = ui32RemoteIP;
         pEntry->ui16RemotePort = ui16RemotePort;
         pEntry->assignedPriority = uint32AssignedPriority;
+        addRecord (lIndex);
 
         return pEntry;
     }
 
     void TCPConnTable::resetGet (void)
     {
+        SharedLockGuard slg{_smtx};
         ++_ui32FirstIndex %= (_entries.size() > 0) ? _entries.size() : 1;
         _ui32NextIndex = _ui32FirstIndex;
         _bIsCounterReset = true;
@@ -134,6 +147,7 @@ namespace ACMNetProxy
 
     Entry * const TCPConnTable::getNextEntry (void)
     {
+        SharedLockGuard slg{_smtx};
         if (_entries.getHighestIndex() < 0) {
             return nullptr;
         }
@@ -200,6 +214,7 @@ namespace ACMNetProxy
     {
         uint16 returnVal = 0;
         const Entry * pEntry;
+        SharedLockGuard slg{_smtx};
         for (long i = 0; i <= _entries.getHighestIndex(); ++i) {
             pEntry = &_entries.get (i);
             if (pEntry && (pEntry->localState != TCTLS_LISTEN) &&
@@ -213,7 +228,7 @@ namespace ACMNetProxy
 
     void TCPConnTable::removeUnusedEntries (void)
     {
-        const Entry * pEntry = nullptr;
+        std::lock_guard<SharedMutex> lg{_smtx};
         long i = NetProxyApplicationParameters::TCP_CONN_TABLE_ENTRIES_POOL_SIZE + 1,
             lastActiveEntry = NetProxyApplicationParameters::TCP_CONN_TABLE_ENTRIES_POOL_SIZE;
         while (i <= _entries.getHighestIndex()) {
@@ -223,6 +238,7 @@ namespace ACMNetProxy
                 if (ul.owns_lock()) {
                     if ((pEntry->localState == TCTLS_LISTEN) && (pEntry->remoteState == TCTRS_Unknown)) {
                         ul.unlock();
+                        removeRecord (i);
                         _entries.clear (i);
                     }
                     else {
@@ -239,7 +255,130 @@ namespace ACMNetProxy
 
         if (lastActiveEntry < _entries.getHighestIndex()) {
             _entries.trimSize (lastActiveEntry + 1);
+            if (_recordPositions.size() > static_cast<unsigned long> (lastActiveEntry + 1)) {
+                _recordPositions.resize (lastActiveEntry + 1);
+            }
+            if ((_index.size() > UI32_MIN_INDEX_SIZE) && ((_ui32UsedIndexRecords * 8) < _index.size())) {
+                // Shrink the index as well
+                rebuildIndex (UI32_MIN_INDEX_SIZE);
+            }
+        }
+    }
+
+    long TCPConnTable::findRecord (uint32 ui32LocalIP, uint16 ui16LocalPort, uint32 ui32RemoteIP, uint16 ui16RemotePort) const
+    {
+        const uint32 ui32Mask = static_cast<uint32> (_index.size()) - 1;
+        // The index always contains empty records, so the loop terminates
+        for (uint32 ui32Pos = hash (ui32LocalIP, ui16LocalPort, ui32RemoteIP, ui16RemotePort) & ui32Mask; ;
+             ui32Pos = (ui32Pos + 1) & ui32Mask) {
+            const IndexRecord & rIndexRecord = _index[ui32Pos];
+            if (rIndexRecord.lSlot == L_EMPTY_RECORD) {
+                return -1;
+            }
+            if ((rIndexRecord.lSlot != L_DELETED_RECORD) && (rIndexRecord.ui32LocalIP == ui32LocalIP) &&
+                (rIndexRecord.ui16LocalPort == ui16LocalPort) && (rIndexRecord.ui32RemoteIP == ui32RemoteIP) &&
+                (rIndexRecord.ui16RemotePort == ui16RemotePort)) {
+                return static_cast<long> (ui32Pos);
+            }
+        }
+    }
+
+    void TCPConnTable::addRecord (long lSlot)
+    {
+        if (((_ui32UsedIndexRecords + 1) * 4) > (_index.size() * 3)) {
+            // Keep the load factor of the index (including deleted records) below 3/4
+            rebuildIndex (static_cast<uint32> (_index.size()));
+        }
+        if (_recordPositions.size() <= static_cast<unsigned long> (lSlot)) {
+            _recordPositions.resize (lSlot + 1, -1);
+        }
+
+        const Entry & rEntry = _entries.get (lSlot);
+        const uint32 ui32Mask = static_cast<uint32> (_index.size()) - 1;
+        uint32 ui32Pos = hash (rEntry.ui32LocalIP, rEntry.ui16LocalPort, rEntry.ui32RemoteIP, rEntry.ui16RemotePort) & ui32Mask;
+        while (_index[ui32Pos].lSlot >= 0) {
+            ui32Pos = (ui32Pos + 1) & ui32Mask;
+        }
+        if (_index[ui32Pos].lSlot == L_EMPTY_RECORD) {
+            ++_ui32UsedIndexRecords;
+        }
+        _index[ui32Pos] = IndexRecord{rEntry.ui32LocalIP, rEntry.ui32RemoteIP, rEntry.ui16LocalPort, rEntry.ui16RemotePort, lSlot};
+        _recordPositions[lSlot] = static_cast<long> (ui32Pos);
+    }
+
+    void TCPConnTable::removeRecord (long lSlot)
+    {
+        if ((static_cast<unsigned long> (lSlot) < _recordPositions.size()) && (_recordPositions[lSlot] >= 0)) {
+            _index[_recordPositions[lSlot]].lSlot = L_DELETED_RECORD;
+            _recordPositions[lSlot] = -1;
+        }
+    }
+
+    void TCPConnTable::rebuildIndex (uint32 ui32Size)
+    {
+        uint32 ui32LiveRecords = 0;
+        for (const auto lPos : _recordPositions) {
+            if (lPos >= 0) {
+                ++ui32LiveRecords;
+            }
+        }
+        // Double the size of the index until it is at most half full
+        ui32Size = std::max (ui32Size, UI32_MIN_INDEX_SIZE);
+        while ((ui32LiveRecords * 2) > ui32Size) {
+            ui32Size *= 2;
+        }
+
+        std::vector<IndexRecord> oldIndex (ui32Size, IndexRecord{0, 0, 0, 0, L_EMPTY_RECORD});
+        oldIndex.swap (_index);
+        _ui32UsedIndexRecords = 0;
+        const uint32 ui32Mask = ui32Size - 1;
+        for (long lSlot = 0; lSlot < static_cast<long> (_recordPositions.size()); ++lSlot) {
+            if (_recordPositions[lSlot] < 0) {
+                continue;
+            }
+
+            const IndexRecord & rIndexRecord = oldIndex[_recordPositions[lSlot]];
+            uint32 ui32Pos = hash (rIndexRecord.ui32LocalIP, rIndexRecord.ui16LocalPort,
+                                   rIndexRecord.ui32RemoteIP, rIndexRecord.ui16RemotePort) & ui32Mask;
+            while (_index[ui32Pos].lSlot != L_EMPTY_RECORD) {
+                ui32Pos = (ui32Pos + 1) & ui32Mask;
+            }
+            _index[ui32Pos] = rIndexRecord;
+            _recordPositions[lSlot] = static_cast<long> (ui32Pos);
+            ++_ui32UsedIndexRecords;
+        }
+    }
+
+    long TCPConnTable::getFreeSlot (void)
+    {
+        while (true) {
+            while (!_freeSlots.empty()) {
+                const long lSlot = _freeSlots.back();
+                _freeSlots.pop_back();
+                if ((lSlot <= _entries.getHighestIndex()) && isFree (&_entries.get (lSlot))) {
+                    return lSlot;
+                }
+            }
+
+            /* Entries are released by other components, so free slots can only be found by scanning the table.
+             * To keep the cost of adding entries constant on average when the table is full of active connections,
+             * the table is only scanned again after it has grown by 1/8 of its size (or when it cannot grow anymore). */
+            if ((_ui32AppendedSlotsSinceScan < (_entries.size() / 8)) && (_entries.getHighestIndex() < 65534)) {
+                return -1;
+            }
+            _ui32AppendedSlotsSinceScan = 0;
+            for (long i = _entries.getHighestIndex(); i >= 0; --i) {
+                if (isFree (&_entries.get (i))) {
+                    _freeSlots.push_back (i);
+                }
+            }
+            if (_freeSlots.empty()) {
+                return -1;
+            }
         }
     }
 
+    const long TCPConnTable::L_EMPTY_RECORD;
+    const long TCPConnTable::L_DELETED_RECORD;
+    const uint32 TCPConnTable::UI32_MIN_INDEX_SIZE;
 }
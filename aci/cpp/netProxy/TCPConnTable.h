@@ -21,13 +21,25 @@
  *
  * Data structure that maintains all the information about
  * the TCP connections that the NetProxy is remapping.
+ * Entries are found by their 4-tuple with an open-addressing hash index,
+ * and unused entries are reused through a list of free slots, so that
+ * the cost of looking up the Entry of each TCP segment does not depend
+ * on the number of connections in the table.
+ * The mutex returned by getMutexRef() serializes the threads that iterate
+ * over the table or that need to update several entries atomically.
+ * Lookups do not acquire that mutex: the structure of the table is
+ * protected by a readers-writer lock, which lookups and iterations acquire
+ * in shared mode and which is only acquired in exclusive mode to add or
+ * remove entries.
  */
 
 #include <mutex>
+#include <vector>
 
 #include "NPDArray2.h"
 
 #include "Entry.h"
+#include "SharedMutex.h"
 #include "Utilities.h"
 
 
@@ -66,6 +78,34 @@ namespace ACMNetProxy
 
 
     private:
+        // Element of the hash index: the 4-tuple of a connection and the position of its Entry in _entries
+        struct IndexRecord
+        {
+            uint32 ui32LocalIP;
+            uint32 ui32RemoteIP;
+            uint16 ui16LocalPort;
+            uint16 ui16RemotePort;
+            long lSlot;
+        };
+
+        // Values of IndexRecord::lSlot for records that do not refer to any Entry
+        static const long L_EMPTY_RECORD = -1;
+        static const long L_DELETED_RECORD = -2;
+
+        static const uint32 UI32_MIN_INDEX_SIZE = 64U;
+
+        static uint32 hash (uint32 ui32LocalIP, uint16 ui16LocalPort, uint32 ui32RemoteIP, uint16 ui16RemotePort);
+        static bool isFree (const Entry * const pEntry);
+        static bool matches (const Entry * const pEntry, const IndexRecord & rIndexRecord);
+
+        // Requires the caller to hold _smtx
+        long findRecord (uint32 ui32LocalIP, uint16 ui16LocalPort, uint32 ui32RemoteIP, uint16 ui16RemotePort) const;
+        // Require the caller to hold _smtx in exclusive mode
+        void addRecord (long lSlot);
+        void removeRecord (long lSlot);
+        void rebuildIndex (uint32 ui32Size);
+        long getFreeSlot (void);
+
         uint32 _ui32FirstIndex;
         uint32 _ui32NextIndex;
         bool _bIsCounterReset;
@@ -76,7 +116,18 @@ namespace ACMNetProxy
 
         NPDArray2<Entry> _entries;
 
+        // Hash index of the entries by 4-tuple (linear probing; the size is a power of 2)
+        std::vector<IndexRecord> _index;
+        uint32 _ui32UsedIndexRecords;                   // Includes deleted records
+        std::vector<long> _recordPositions;             // Position in _index of the record of each slot, or -1
+
+        // Slots that were found free, in decreasing order; they are checked again before being reused,
+        // since entries are cleared by other components without notifying the table
+        std::vector<long> _freeSlots;
+        uint32 _ui32AppendedSlotsSinceScan;
+
         mutable std::mutex _mtx;
+        mutable SharedMutex _smtx;
     };
 
 
@@ -113,21 +164,56 @@ namespace ACMNetProxy
     inline void TCPConnTable::clearTable (void)
     {
         std::lock_guard<std::mutex> lg{_mtx};
+        std::lock_guard<SharedMutex> lgStructure{_smtx};
 
         for (long i = 0; i <= _entries.getHighestIndex(); i++) {
             _entries.clear (i);
         }
+        _recordPositions.assign (_recordPositions.size(), -1);
+        rebuildIndex (UI32_MIN_INDEX_SIZE);
+        _freeSlots.clear();
+        for (long i = _entries.getHighestIndex(); i >= 0; i--) {
+            _freeSlots.push_back (i);
+        }
+        _ui32AppendedSlotsSinceScan = 0;
     }
 
     inline TCPConnTable::TCPConnTable (void) :
         _ui32FirstIndex{0}, _ui32NextIndex{0}, _bIsCounterReset{true},
-        _ui32HighestKnownPriority{0}, _ui32NewHighestPriority{0}
+        _ui32HighestKnownPriority{0}, _ui32NewHighestPriority{0},
+        _index(UI32_MIN_INDEX_SIZE, IndexRecord{0, 0, 0, 0, L_EMPTY_RECORD}),
+        _ui32UsedIndexRecords{0}, _ui32AppendedSlotsSinceScan{0}
     { }
 
     inline std::mutex & TCPConnTable::getMutexRef (void) const
     {
         return _mtx;
     }
+
+    inline uint32 TCPConnTable::hash (uint32 ui32LocalIP, uint16 ui16LocalPort, uint32 ui32RemoteIP, uint16 ui16RemotePort)
+    {
+        // Finalizer of MurmurHash3 applied to the 4-tuple, so that flows that only differ in the ports spread across the index
+        uint64 ui64Key = ((static_cast<uint64> (ui32LocalIP) << 32) | ui32RemoteIP) ^
+            ((static_cast<uint64> ((static_cast<uint32> (ui16LocalPort) << 16) | ui16RemotePort)) * 0x9E3779B97F4A7C15ULL);
+        ui64Key ^= ui64Key >> 33;
+        ui64Key *= 0xFF51AFD7ED558CCDULL;
+        ui64Key ^= ui64Key >> 33;
+        ui64Key *= 0xC4CEB9FE1A85EC53ULL;
+        ui64Key ^= ui64Key >> 33;
+
+        return static_cast<uint32> (ui64Key);
+    }
+
+    inline bool TCPConnTable::isFree (const Entry * const pEntry)
+    {
+        return !pEntry || (pEntry->localState == TCTLS_LISTEN);
+    }
+
+    inline bool TCPConnTable::matches (const Entry * const pEntry, const IndexRecord & rIndexRecord)
+    {
+        return pEntry && (pEntry->ui32LocalIP == rIndexRecord.ui32LocalIP) && (pEntry->ui16LocalPort == rIndexRecord.ui16LocalPort) &&
+            (pEntry->ui32RemoteIP == rIndexRecord.ui32RemoteIP) && (pEntry->ui16RemotePort == rIndexRecord.ui16RemotePort);
+    }
 }
 
 #endif   // #ifndef INCL_TCP_CONN_TABLE_H
@@ -49,7 +49,7 @@ namespace ACMNetProxy
     int TCPManager::handleTCPPacketFromHost (const uint8 * const pPacket, uint16 ui16PacketLen, LocalTCPTransmitterThread & rLocalTCPTransmitterThread,
                                              RemoteTCPTransmitterThread & rRemoteTCPTransmitterThread)
     {
-        static int rc;
+        int rc;
 
         // Assumptions: pPacket does not include EtherFrameHeader (points to IPHeader); pPacket is in host byte order
         const auto * const pIPHeader = reinterpret_cast<const NOMADSUtil::IPHeader *> (pPacket);
@@ -47,7 +47,7 @@ namespace ACMNetProxy
 {
     TapInterface::TapInterface (void) :
         NetworkInterface{Type::T_Tap, "TUN/TAP Interface", "TUN/TAP Interface"},
-        _bInitDone{false}
+        _bInitDone{false}, _ui8Queues{0}, _upTAPQueues{}
     {
         #if defined (WIN32)
             _hInterface = nullptr;
@@ -55,8 +55,6 @@ namespace ACMNetProxy
             _oWrite.hEvent = nullptr;
         #elif defined (LINUX)
             _sInterfaceName = "tap0";
-            tvTimeout.tv_sec = 0;
-            tvTimeout.tv_usec = 0;
         #endif
     }
 
@@ -72,20 +70,45 @@ namespace ACMNetProxy
         CloseHandle (_oWrite.hEvent);
         _oWrite.hEvent = nullptr;
         #elif defined (LINUX)
-        close (_fdTAP);
-        _fdTAP = -1;
+        for (uint8 ui8Queue = 0; ui8Queue < _ui8Queues; ++ui8Queue) {
+            if (_upTAPQueues[ui8Queue].fdTAP >= 0) {
+                close (_upTAPQueues[ui8Queue].fdTAP);
+                _upTAPQueues[ui8Queue].fdTAP = -1;
+            }
+        }
         #endif
     }
 
-    int TapInterface::init (void)
+    int TapInterface::init (uint8 ui8Queues)
     {
-        std::lock_guard<std::mutex> lg (_mtxWrite);
+        std::lock_guard<std::mutex> lg (_mtxInit);
 
         if (_bInitDone) {
             return 0;
         }
         _bInitDone = true;
 
+        if (ui8Queues == 0) {
+            ui8Queues = 1;
+        }
+        #if defined (WIN32)
+            if (ui8Queues > 1) {
+                checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_Warning,
+                                "multi-queue TUN/TAP interfaces are not supported on Windows; "
+                                "using a single queue instead of %hhu\n", ui8Queues);
+                ui8Queues = 1;
+            }
+        #elif !defined (IFF_MULTI_QUEUE)
+            if (ui8Queues > 1) {
+                checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_Warning,
+                                "multi-queue TUN/TAP interfaces are not supported by this system; "
+                                "using a single queue instead of %hhu\n", ui8Queues);
+                ui8Queues = 1;
+            }
+        #endif
+        _upTAPQueues.reset (new TAPQueue[ui8Queues]);
+        _ui8Queues = ui8Queues;
+
         #if defined (WIN32)
             const char * WIN32_NETWORK_ADAPTERS_REG_KEY = "SYSTEM\\CurrentControlSet\\Control\\Class\\{4D36E972-E325-11CE-BFC1-08002BE10318}";
             const char * WIN32_NETWORK_ADAPTERS_NAMES_REG_KEY = "SYSTEM\\CurrentControlSet\\Control\\Network\\{4D36E972-E325-11CE-BFC1-08002BE10318}";
@@ -334,34 +357,29 @@ namespace ACMNetProxy
             }
 
         #elif defined (LINUX)
-            #if defined (ANDROID)
-                const char * const TAP_DEVICE_PATH = "/dev/tun";
-            #else
-                const char * const TAP_DEVICE_PATH = "/dev/net/tun";
-            #endif
             struct ifreq ifr;
             int err = 0, sock_fd;
 
-            if ((_fdTAP = open (TAP_DEVICE_PATH, O_RDWR)) < 0 ) {
-                checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_SevereError,
-                                "Attempt to open TUN/TAP device failed with error %d\n", _fdTAP);
-                return -1;
+            // The first queue determines the name of the interface, which is then used to attach the other queues
+            const bool bMultiQueue = _ui8Queues > 1;
+            if ((err = openQueue (_upTAPQueues[0], bMultiQueue)) < 0) {
+                return err;
             }
-            //FD_SET (_fdTAP, &fdSet);
-            memset (&ifr, 0, sizeof(ifr));
-            strncpy (ifr.ifr_name, _sInterfaceName.c_str(), _sInterfaceName.length());
-            ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
-            if ((err = ioctl (_fdTAP, TUNSETIFF, (void *) &ifr)) < 0 ) {
-                checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_SevereError,
-                                "Attempt to apply settings to TUN/TAP device failed with error %d\n", err);
-                close (_fdTAP);
-                return -2;
-            }
-
-            _sInterfaceName = ifr.ifr_name;
+            const int fdTAP = _upTAPQueues[0].fdTAP;
             printf ("TUN/TAP interface name: %s\n", _sInterfaceName.c_str());
+            for (uint8 ui8Queue = 1; ui8Queue < _ui8Queues; ++ui8Queue) {
+                if ((err = openQueue (_upTAPQueues[ui8Queue], bMultiQueue)) < 0) {
+                    checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_SevereError,
+                                    "failed to attach queue %hhu to the multi-queue TUN/TAP interface %s; rc = %d\n",
+                                    ui8Queue, _sInterfaceName.c_str(), err);
+                    return err;
+                }
+            }
+            if (bMultiQueue) {
+                printf ("\t\tQueues: %hhu\n", _ui8Queues);
+            }
 
-            if ((err = ioctl (_fdTAP, TUNSETPERSIST, 1)) < 0) {
+            if ((err = ioctl (fdTAP, TUNSETPERSIST, 1)) < 0) {
                 checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_MildError,
                                 "Attempt to turn persitence on on TUN/TAP device failed with error %d\n", err);
                 return -3;
@@ -373,7 +391,7 @@ namespace ACMNetProxy
             // MAC Address
             memset (&ifr, 0, sizeof(ifr));
             strncpy (ifr.ifr_name, _sInterfaceName.c_str(), _sInterfaceName.length());
-            if ((err = ioctl (_fdTAP, SIOCGIFHWADDR, (void *) &ifr)) < 0) {
+            if ((err = ioctl (fdTAP, SIOCGIFHWADDR, (void *) &ifr)) < 0) {
                 checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_SevereError,
                                 "could not retrieve TUN/TAP interface MAC address; rc = %d\n", errno);
                 perror("ioctl");
@@ -437,23 +455,66 @@ namespace ACMNetProxy
                 close (sock_fd);
             }
 
-            tvTimeout.tv_sec = NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT / 1000;
-            tvTimeout.tv_usec = (NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT % 1000) * 1000;
             checkAndLogMsg ("TapInterface::init", NOMADSUtil::Logger::L_Info,
-                            "select() on the TUN/TAP interface will use a timeout of %ld.%04ld sec\n",
-                            tvTimeout.tv_sec, tvTimeout.tv_usec);
+                            "select() on the TUN/TAP interface will use a timeout of %u.%03u sec\n",
+                            NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT / 1000,
+                            NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT % 1000);
+        #endif
+
+        return 0;
+    }
+
+    #if defined (LINUX)
+    int TapInterface::openQueue (TAPQueue & rTAPQueue, bool bMultiQueue)
+    {
+        #if defined (ANDROID)
+            const char * const TAP_DEVICE_PATH = "/dev/tun";
+        #else
+            const char * const TAP_DEVICE_PATH = "/dev/net/tun";
         #endif
+        struct ifreq ifr;
+        int err = 0;
+
+        if ((rTAPQueue.fdTAP = open (TAP_DEVICE_PATH, O_RDWR)) < 0) {
+            checkAndLogMsg ("TapInterface::openQueue", NOMADSUtil::Logger::L_SevereError,
+                            "Attempt to open TUN/TAP device failed with error %d\n", errno);
+            return -1;
+        }
+        memset (&ifr, 0, sizeof(ifr));
+        strncpy (ifr.ifr_name, _sInterfaceName.c_str(), sizeof(ifr.ifr_name) - 1);
+        ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+        #if defined (IFF_MULTI_QUEUE)
+            if (bMultiQueue) {
+                ifr.ifr_flags |= IFF_MULTI_QUEUE;
+            }
+        #endif
+        if ((err = ioctl (rTAPQueue.fdTAP, TUNSETIFF, (void *) &ifr)) < 0) {
+            checkAndLogMsg ("TapInterface::openQueue", NOMADSUtil::Logger::L_SevereError,
+                            "Attempt to apply settings to TUN/TAP device failed with error %d\n", errno);
+            close (rTAPQueue.fdTAP);
+            rTAPQueue.fdTAP = -1;
+            return -2;
+        }
+        _sInterfaceName = ifr.ifr_name;
 
         return 0;
     }
+    #endif
 
-    int TapInterface::readPacket (const uint8 ** pui8Buf, uint16 & ui16PacketLen)
+    int TapInterface::readPacketFromQueue (uint8 ui8Queue, const uint8 ** pui8Buf, uint16 & ui16PacketLen)
     {
         static const uint16 UI16BUFFER_SIZE = NetProxyApplicationParameters::ETHERNET_MAX_MFS;
 
+        if (ui8Queue >= _ui8Queues) {
+            *pui8Buf = nullptr;
+            ui16PacketLen = 0;
+            return -4;
+        }
+        TAPQueue & rTAPQueue = _upTAPQueues[ui8Queue];
+
         #if defined (WIN32)
         DWORD dwBytesRead = 0, dwWaitForSingleObjectRet = 0;
-        if (!ReadFile (_hInterface, ui8Buf, UI16BUFFER_SIZE, &dwBytesRead, &_oRead)) {
+        if (!ReadFile (_hInterface, rTAPQueue.ui8Buf, UI16BUFFER_SIZE, &dwBytesRead, &_oRead)) {
             if (GetLastError() != ERROR_IO_PENDING) {
                 checkAndLogMsg ("TapInterface::readPacket", NOMADSUtil::Logger::L_MildError,
                                 "ReadFile failed with error %d\n", GetLastError());
@@ -493,18 +554,19 @@ namespace ACMNetProxy
 
         #elif defined (LINUX)
         int rc;
-        FD_SET (_fdTAP, &fdSet);
-        tvTimeout.tv_sec = NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT / 1000;
-        tvTimeout.tv_usec = (NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT % 1000) * 1000;
-        while (0 == (rc = select (_fdTAP + 1, &fdSet, nullptr, nullptr, &tvTimeout))) {
+        FD_ZERO (&rTAPQueue.fdSet);
+        FD_SET (rTAPQueue.fdTAP, &rTAPQueue.fdSet);
+        rTAPQueue.tvTimeout.tv_sec = NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT / 1000;
+        rTAPQueue.tvTimeout.tv_usec = (NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT % 1000) * 1000;
+        while (0 == (rc = select (rTAPQueue.fdTAP + 1, &rTAPQueue.fdSet, nullptr, nullptr, &rTAPQueue.tvTimeout))) {
             if (_bIsTerminationRequested) {
                 *pui8Buf = nullptr;
                 ui16PacketLen = 0;
                 return 0;
             }
-            FD_SET (_fdTAP, &fdSet);
-            tvTimeout.tv_sec = NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT / 1000;
-            tvTimeout.tv_usec = (NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT % 1000) * 1000;
+            FD_SET (rTAPQueue.fdTAP, &rTAPQueue.fdSet);
+            rTAPQueue.tvTimeout.tv_sec = NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT / 1000;
+            rTAPQueue.tvTimeout.tv_usec = (NetProxyApplicationParameters::TAP_INTERFACE_READ_TIMEOUT % 1000) * 1000;
         }
         if (rc < 0) {
             *pui8Buf = nullptr;
@@ -512,7 +574,7 @@ namespace ACMNetProxy
             return rc;
         }
 
-        int64 dwBytesRead = read (_fdTAP, ui8Buf, UI16BUFFER_SIZE);
+        int64 dwBytesRead = read (rTAPQueue.fdTAP, rTAPQueue.ui8Buf, UI16BUFFER_SIZE);
         if ((dwBytesRead < 0) && !_bIsTerminationRequested) {
             checkAndLogMsg ("TapInterface::readPacket", NOMADSUtil::Logger::L_MildError,
                             "read() failed with error %d\n", errno);
@@ -522,14 +584,15 @@ namespace ACMNetProxy
         }
         #endif
 
-        *pui8Buf = ui8Buf;
+        *pui8Buf = rTAPQueue.ui8Buf;
         ui16PacketLen = dwBytesRead;
         return 0;
     }
 
     int TapInterface::writePacket (const uint8 * const pui8Buf, uint16 ui16PacketLen)
     {
-        std::lock_guard<std::mutex> lg (_mtxWrite);
+        TAPQueue & rTAPQueue = _upTAPQueues[(_ui8Queues > 1) ? (getFlowHash (pui8Buf, ui16PacketLen) % _ui8Queues) : 0];
+        std::lock_guard<std::mutex> lg (rTAPQueue.mtxWrite);
 
         #if defined (WIN32)
         DWORD dwBytesWritten = 0;
@@ -551,7 +614,7 @@ namespace ACMNetProxy
                             "correctly written %d bytes to the TUN/TAP interface\n", dwBytesWritten);
 
         #elif defined (LINUX)
-        int64 dwBytesWritten = write (_fdTAP, pui8Buf, ui16PacketLen);
+        int64 dwBytesWritten = write (rTAPQueue.fdTAP, pui8Buf, ui16PacketLen);
             if (dwBytesWritten < 0) {
                 checkAndLogMsg ("TapInterface::writePacket", NOMADSUtil::Logger::L_MildError,
                                 "write() failed with error %d\n", errno);
@@ -571,4 +634,52 @@ namespace ACMNetProxy
         return (int) dwBytesWritten;
     }
 
+    uint32 TapInterface::getFlowHash (const uint8 * const pui8Buf, uint16 ui16PacketLen)
+    {
+        static const uint16 UI16_ETHERNET_HEADER_LEN = 14U;
+        static const uint16 UI16_VLAN_TAG_LEN = 4U;
+
+        // The hash is computed on the raw bytes, so it does not depend on the byte order of the headers
+        uint16 ui16Offset = UI16_ETHERNET_HEADER_LEN;
+        if (ui16PacketLen < ui16Offset) {
+            return 0;
+        }
+        uint16 ui16EtherType = (static_cast<uint16> (pui8Buf[12]) << 8) | pui8Buf[13];
+        if ((ui16EtherType == 0x8100U) && (ui16PacketLen >= (ui16Offset + UI16_VLAN_TAG_LEN))) {
+            ui16EtherType = (static_cast<uint16> (pui8Buf[16]) << 8) | pui8Buf[17];
+            ui16Offset += UI16_VLAN_TAG_LEN;
+        }
+        if ((ui16EtherType != 0x0800U) || (ui16PacketLen < (ui16Offset + NetworkConfigurationSettings::MIN_IP_HEADER_SIZE))) {
+            // Non-IPv4 traffic (e.g., ARP) is always written to the first queue
+            return 0;
+        }
+
+        const uint8 * const pui8IPHeader = pui8Buf + ui16Offset;
+        const uint16 ui16IPHeaderLen = (pui8IPHeader[0] & 0x0FU) * 4U;
+        const uint8 ui8Protocol = pui8IPHeader[9];
+        uint32 ui32SrcAddr, ui32DestAddr;
+        memcpy (&ui32SrcAddr, pui8IPHeader + 12, sizeof(uint32));
+        memcpy (&ui32DestAddr, pui8IPHeader + 16, sizeof(uint32));
+
+        // The source and destination are combined symmetrically, so that both directions of a flow map to the same queue
+        uint32 ui32Hash = (ui32SrcAddr ^ ui32DestAddr) + ui8Protocol;
+        const bool bFragment = ((pui8IPHeader[6] & 0x3FU) != 0) || (pui8IPHeader[7] != 0);
+        if (((ui8Protocol == 6) || (ui8Protocol == 17)) && !bFragment &&
+            (ui16PacketLen >= (ui16Offset + ui16IPHeaderLen + 4U))) {
+            uint16 ui16SrcPort, ui16DestPort;
+            memcpy (&ui16SrcPort, pui8IPHeader + ui16IPHeaderLen, sizeof(uint16));
+            memcpy (&ui16DestPort, pui8IPHeader + ui16IPHeaderLen + 2, sizeof(uint16));
+            ui32Hash ^= static_cast<uint32> (ui16SrcPort ^ ui16DestPort) << 16;
+        }
+
+        // Final mix of MurmurHash3
+        ui32Hash ^= ui32Hash >> 16;
+        ui32Hash *= 0x85EBCA6BU;
+        ui32Hash ^= ui32Hash >> 13;
+        ui32Hash *= 0xC2B2AE35U;
+        ui32Hash ^= ui32Hash >> 16;
+
+        return ui32Hash;
+    }
+
 }
@@ -20,8 +20,16 @@
  * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
  *
  * The TAPInterface class manages the access to the TUN/TAP Driver.
+ * On Linux, the TUN/TAP interface can be created with multiple queues
+ * (IFF_MULTI_QUEUE), each with its own file descriptor, so that packets
+ * can be read by one thread per queue. Packets are written to the queue
+ * selected by the hash of the 5-tuple of the flow they belong to; the
+ * kernel steers the packets of the same flow that are read from the
+ * interface to the queue last used to write them, so that all packets
+ * of a flow are handled by the same thread and in order.
  */
 
+#include <memory>
 #include <mutex>
 
 #include "FTypes.h"
@@ -48,31 +56,49 @@ namespace ACMNetProxy
         TapInterface (const TapInterface & rCopy) = delete;
         virtual ~TapInterface (void);
 
-        static TapInterface * const createAndInitTAPInterface (void);
+        static TapInterface * const createAndInitTAPInterface (uint8 ui8Queues = NetProxyApplicationParameters::DEFAULT_TAP_INTERFACE_QUEUES);
 
         void requestTermination (void);
 
+        uint8 getNumberOfQueues (void) const;
+
         int readPacket (const uint8 ** pui8Buf, uint16 & ui16PacketLen);
+        int readPacketFromQueue (uint8 ui8Queue, const uint8 ** pui8Buf, uint16 & ui16PacketLen);
         int writePacket (const uint8 * const pui8Buf, uint16 ui16PacketLen);
 
 
     private:
+        struct TAPQueue
+        {
+            #if defined (LINUX)
+                int fdTAP = -1;
+                fd_set fdSet;
+                struct timeval tvTimeout;
+            #endif
+
+            std::mutex mtxWrite;
+            uint8 ui8Buf[NetProxyApplicationParameters::ETHERNET_MAX_MFS];
+        };
+
+
         explicit TapInterface (void);
 
-        int init (void);
+        int init (uint8 ui8Queues);
+        #if defined (LINUX)
+            int openQueue (TAPQueue & rTAPQueue, bool bMultiQueue);
+        #endif
+
+        static uint32 getFlowHash (const uint8 * const pui8Buf, uint16 ui16PacketLen);
 
         bool _bInitDone;
         #if defined (WIN32)
             HANDLE _hInterface;
             OVERLAPPED _oRead, _oWrite;
-        #elif defined (LINUX)
-            int _fdTAP;
-            fd_set fdSet;
-            struct timeval tvTimeout;
         #endif
 
-        std::mutex _mtxWrite;
-        uint8 ui8Buf[NetProxyApplicationParameters::ETHERNET_MAX_MFS];
+        uint8 _ui8Queues;
+        std::unique_ptr<TAPQueue[]> _upTAPQueues;
+        std::mutex _mtxInit;
     };
 
 
@@ -81,10 +107,20 @@ namespace ACMNetProxy
         NetworkInterface::requestTermination();
     }
 
-    inline TapInterface * const TapInterface::createAndInitTAPInterface (void)
+    inline uint8 TapInterface::getNumberOfQueues (void) const
+    {
+        return _ui8Queues;
+    }
+
+    inline int TapInterface::readPacket (const uint8 ** pui8Buf, uint16 & ui16PacketLen)
+    {
+        return readPacketFromQueue (0, pui8Buf, ui16PacketLen);
+    }
+
+    inline TapInterface * const TapInterface::createAndInitTAPInterface (uint8 ui8Queues)
     {
         auto * const pTAPInterface = new TapInterface;
-        if (pTAPInterface->init() != 0) {
+        if (pTAPInterface->init (ui8Queues) != 0) {
             delete pTAPInterface;
             return nullptr;
         }
@@ -0,0 +1,112 @@
+/*
+ * ZstdConnectorReader.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include <cstdlib>
+
+#include "Logger.h"
+
+#include "ZstdConnectorReader.h"
+#include "ZstdDictionaries.h"
+
+
+#define checkAndLogMsg(_f_name_, _log_level_, ...) \
+    if (NOMADSUtil::pLogger && (NOMADSUtil::pLogger->getDebugLevel() >= _log_level_)) \
+        NOMADSUtil::pLogger->logMsg (_f_name_, _log_level_, __VA_ARGS__)
+
+namespace ACMNetProxy
+{
+    ZstdConnectorReader::ZstdConnectorReader (const CompressionSettings & compressionSettings, bool bUDPDatagrams,
+                                              unsigned int ulOutBufSize) :
+        ConnectorReader{compressionSettings}, _pOutputBuffer{nullptr}, _ulOutBufSize{ulOutBufSize},
+        _pDCtx{ZSTD_createDCtx()}
+    {
+        if ((_ulOutBufSize == 0) ||
+            (nullptr == (_pOutputBuffer = static_cast<unsigned char *> (malloc (_ulOutBufSize))))) {
+            // throw a c++ exception here
+        }
+        if (!_pDCtx) {
+            // throw a c++ exception here
+        }
+        if (const auto * const pDDict = ZstdDictionaries::getDecompressionDictionary (bUDPDatagrams)) {
+            // Referencing the dictionary survives session resets
+            ZSTD_DCtx_refDDict (_pDCtx, pDDict);
+        }
+    }
+
+    ZstdConnectorReader::~ZstdConnectorReader (void)
+    {
+        ZSTD_freeDCtx (_pDCtx);
+        _pDCtx = nullptr;
+        free (_pOutputBuffer);
+        _pOutputBuffer = nullptr;
+    }
+
+    int ZstdConnectorReader::receiveTCPDataProxyMessage (const uint8 * const ui8SrcData, uint16 ui16SrcLen, uint8 ** pDest, uint32 & ui32DestLen)
+    {
+        ZSTD_inBuffer zstdInBuf{ui8SrcData, ui16SrcLen, 0};
+        *pDest = nullptr;
+        ui32DestLen = 0;
+
+        while (true) {
+            ZSTD_outBuffer zstdOutBuf{_pOutputBuffer, _ulOutBufSize, ui32DestLen};
+            const size_t rc = ZSTD_decompressStream (_pDCtx, &zstdOutBuf, &zstdInBuf);
+            if (ZSTD_isError (rc)) {
+                checkAndLogMsg ("ZstdConnectorReader::receiveTCPDataProxyMessage", NOMADSUtil::Logger::L_MildError,
+                                "ZSTD_decompressStream() returned with error <%s>\n", ZSTD_getErrorName (rc));
+                ui32DestLen = 0;
+                return -1;
+            }
+            ui32DestLen = static_cast<uint32> (zstdOutBuf.pos);
+
+            if (zstdOutBuf.pos == zstdOutBuf.size) {
+                // The decoder might hold more data than what fits in the output buffer
+                auto * const pNewOutputBuffer = static_cast<unsigned char *> (realloc (_pOutputBuffer, 2 * _ulOutBufSize));
+                if (!pNewOutputBuffer) {
+                    checkAndLogMsg ("ZstdConnectorReader::receiveTCPDataProxyMessage", NOMADSUtil::Logger::L_MildError,
+                                    "error reallocating memory for _pOutputBuffer; impossible to increase size from %u to %u bytes\n",
+                                    _ulOutBufSize, 2 * _ulOutBufSize);
+                    ui32DestLen = 0;
+                    return -2;
+                }
+                _pOutputBuffer = pNewOutputBuffer;
+                _ulOutBufSize *= 2;
+            }
+            else if (zstdInBuf.pos == zstdInBuf.size) {
+                // All input was consumed and everything that could be decoded was flushed
+                break;
+            }
+        }
+
+        if (ui32DestLen > 0) {
+            *pDest = _pOutputBuffer;
+        }
+
+        return 0;
+    }
+
+    int ZstdConnectorReader::resetConnectorReader (void)
+    {
+        if (ZSTD_isError (ZSTD_DCtx_reset (_pDCtx, ZSTD_reset_session_only))) {
+            return -1;
+        }
+
+        return 0;
+    }
+
+}
@@ -0,0 +1,91 @@
+#ifndef INCL_ZSTD_CONNECTOR_READER_H
+#define INCL_ZSTD_CONNECTOR_READER_H
+
+/*
+ * ZstdConnectorReader.h
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * ConnectorReader decompresses data compressed using the Zstandard library.
+ * The decompression context buffers incomplete blocks internally, so
+ * compressed data can be passed in chunks of any size.
+ */
+
+#include <mutex>
+
+#include "zstd.h"
+
+#include "ConnectorReader.h"
+
+
+namespace ACMNetProxy
+{
+    class ZstdConnectorReader : public ConnectorReader
+    {
+    public:
+        virtual ~ZstdConnectorReader (void);
+
+        virtual const CompressionType getCompressionFlag (void) const;
+
+        virtual int receiveTCPDataProxyMessage (const uint8 * const ui8SrcData, uint16 ui16SrcLen, uint8 ** pDest, uint32 & ui32DestLen);
+        virtual int resetAndUnlockConnectorReader (void);
+
+
+    private:
+        friend class ConnectorReader;
+
+        ZstdConnectorReader (const CompressionSettings & compressionSettings, bool bUDPDatagrams = false,
+                             unsigned int ulOutBufSize = 4096U);
+
+        virtual void lockConnectorReader (void) const;
+        virtual void unlockConnectorReader (void) const;
+        virtual int resetConnectorReader (void);
+
+        unsigned char * _pOutputBuffer;
+        unsigned int _ulOutBufSize;
+        ZSTD_DCtx * _pDCtx;
+
+        mutable std::mutex _mtx;
+    };
+
+
+    inline const CompressionType ZstdConnectorReader::getCompressionFlag (void) const
+    {
+        return CompressionType::PMC_ZstdCompressedData;
+    }
+
+    inline int ZstdConnectorReader::resetAndUnlockConnectorReader (void)
+    {
+        if (0 != resetConnectorReader()) {
+            return -1;
+        }
+        _mtx.unlock();
+
+        return 0;
+    }
+
+    inline void ZstdConnectorReader::lockConnectorReader (void) const
+    {
+        _mtx.lock();
+    }
+
+    inline void ZstdConnectorReader::unlockConnectorReader (void) const
+    {
+        _mtx.unlock();
+    }
+}
+
+#endif // INCL_ZSTD_CONNECTOR_READER_H
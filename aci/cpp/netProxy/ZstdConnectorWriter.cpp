@@ -0,0 +1,170 @@
+/*
+ * ZstdConnectorWriter.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include <cstdlib>
+
+#include "Logger.h"
+
+#include "ZstdConnectorWriter.h"
+#include "ZstdDictionaries.h"
+
+
+#define checkAndLogMsg(_f_name_, _log_level_, ...) \
+    if (NOMADSUtil::pLogger && (NOMADSUtil::pLogger->getDebugLevel() >= _log_level_)) \
+        NOMADSUtil::pLogger->logMsg (_f_name_, _log_level_, __VA_ARGS__)
+
+namespace ACMNetProxy
+{
+    ZstdConnectorWriter::ZstdConnectorWriter (const CompressionSettings & compressionSettings, bool bUDPDatagrams, unsigned long ulOutBufSize) :
+        ConnectorWriter{compressionSettings}, _pOutputBuffer{nullptr}, _ulOutBufSize{ulOutBufSize},
+        _bUDPDatagrams{bUDPDatagrams}, _pCCtx{ZSTD_createCCtx()}
+    {
+        if (_ulOutBufSize == 0) {
+            _ulOutBufSize = ZSTD_CStreamOutSize();
+        }
+        if ((_pOutputBuffer = static_cast<unsigned char *> (malloc (_ulOutBufSize))) == nullptr) {
+            // throw C++ exception here
+        }
+        if (!_pCCtx) {
+            // Throw C++ exception here
+        }
+        resetCompStream();
+    }
+
+    ZstdConnectorWriter::~ZstdConnectorWriter (void)
+    {
+        ZSTD_freeCCtx (_pCCtx);
+        _pCCtx = nullptr;
+        free (_pOutputBuffer);
+        _pOutputBuffer = nullptr;
+    }
+
+    int ZstdConnectorWriter::flush (unsigned char **pDest, unsigned int &uiDestLen)
+    {
+        if (_bFlushed) {
+            *pDest = nullptr;
+            uiDestLen = 0;
+            return 0;
+        }
+
+        // Close the current frame; the next call to writeData() will automatically open a new one
+        if (0 != compressStream (nullptr, 0, ZSTD_e_end, pDest, uiDestLen)) {
+            checkAndLogMsg ("ZstdConnectorWriter::flush", NOMADSUtil::Logger::L_MildError,
+                            "impossible to terminate the current Zstandard frame\n");
+            return -1;
+        }
+        _bFlushed = true;
+
+        return 0;
+    }
+
+    int ZstdConnectorWriter::writeData (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen, bool bLocalFlush)
+    {
+        _bFlushed = false;
+        if (0 != compressStream (pSrc, uiSrcLen, bLocalFlush ? ZSTD_e_flush : ZSTD_e_continue, pDest, uiDestLen)) {
+            checkAndLogMsg ("ZstdConnectorWriter::writeData", NOMADSUtil::Logger::L_MildError,
+                            "impossible to compress %u bytes of data (local flush %s)\n", uiSrcLen,
+                            bLocalFlush ? "ON" : "OFF");
+            return -1;
+        }
+
+        return 0;
+    }
+
+    int ZstdConnectorWriter::writeDataAndResetWriter (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen)
+    {
+        *pDest = nullptr;
+        uiDestLen = 0;
+        if (!pSrc || (uiSrcLen == 0)) {
+            ZSTD_CCtx_reset (_pCCtx, ZSTD_reset_session_only);
+            return 0;
+        }
+
+        // Each datagram is compressed into a self-contained frame
+        ZSTD_CCtx_reset (_pCCtx, ZSTD_reset_session_only);
+        if (0 != compressStream (pSrc, uiSrcLen, ZSTD_e_end, pDest, uiDestLen)) {
+            checkAndLogMsg ("ZstdConnectorWriter::writeDataAndResetWriter", NOMADSUtil::Logger::L_MildError,
+                            "impossible to compress a datagram of %u bytes\n", uiSrcLen);
+            ZSTD_CCtx_reset (_pCCtx, ZSTD_reset_session_only);
+            return -1;
+        }
+        _bFlushed = true;
+
+        return 0;
+    }
+
+    int ZstdConnectorWriter::compressStream (const unsigned char *pSrc, unsigned int uiSrcLen, ZSTD_EndDirective zstdEndOp,
+                                             unsigned char **pDest, unsigned int &uiDestLen)
+    {
+        ZSTD_inBuffer zstdInBuf{pSrc, pSrc ? uiSrcLen : 0, 0};
+        size_t stRemaining = 0;
+        *pDest = nullptr;
+        uiDestLen = 0;
+
+        do {
+            ZSTD_outBuffer zstdOutBuf{_pOutputBuffer, _ulOutBufSize, uiDestLen};
+            stRemaining = ZSTD_compressStream2 (_pCCtx, &zstdOutBuf, &zstdInBuf, zstdEndOp);
+            if (ZSTD_isError (stRemaining)) {
+                checkAndLogMsg ("ZstdConnectorWriter::compressStream", NOMADSUtil::Logger::L_MildError,
+                                "ZSTD_compressStream2() returned with error <%s>\n", ZSTD_getErrorName (stRemaining));
+                uiDestLen = 0;
+                return -1;
+            }
+            uiDestLen = static_cast<unsigned int> (zstdOutBuf.pos);
+
+            if (zstdOutBuf.pos == zstdOutBuf.size) {
+                auto * const pNewOutputBuffer = static_cast<unsigned char *> (realloc (_pOutputBuffer, 2 * _ulOutBufSize));
+                if (!pNewOutputBuffer) {
+                    checkAndLogMsg ("ZstdConnectorWriter::compressStream", NOMADSUtil::Logger::L_MildError,
+                                    "error trying to realloc %lu (previously %lu) bytes\n",
+                                    2 * _ulOutBufSize, _ulOutBufSize);
+                    uiDestLen = 0;
+                    return -2;
+                }
+                _pOutputBuffer = pNewOutputBuffer;
+                _ulOutBufSize *= 2;
+                // With a full output buffer, there could still be data to flush regardless of the directive
+                stRemaining = 1;
+            }
+        } while ((zstdInBuf.pos < zstdInBuf.size) || ((zstdEndOp != ZSTD_e_continue) && (stRemaining > 0)));
+
+        if (uiDestLen > 0) {
+            *pDest = _pOutputBuffer;
+        }
+
+        return 0;
+    }
+
+    void ZstdConnectorWriter::resetCompStream (void)
+    {
+        ZSTD_CCtx_reset (_pCCtx, ZSTD_reset_session_and_parameters);
+        if (const auto * const pCDict = ZstdDictionaries::getCompressionDictionary (_bUDPDatagrams, getCompressionLevel())) {
+            // The compression level is embedded in the digested dictionary
+            ZSTD_CCtx_refCDict (_pCCtx, pCDict);
+        }
+        else {
+            ZSTD_CCtx_setParameter (_pCCtx, ZSTD_c_compressionLevel, getCompressionLevel());
+        }
+        if (_bUDPDatagrams) {
+            // Datagrams are small: omitting the content size from the frame header saves a few bytes each
+            ZSTD_CCtx_setParameter (_pCCtx, ZSTD_c_contentSizeFlag, 0);
+        }
+    }
+
+}
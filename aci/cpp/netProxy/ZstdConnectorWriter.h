@@ -0,0 +1,86 @@
+#ifndef INCL_ZSTD_CONNECTOR_WRITER_H
+#define INCL_ZSTD_CONNECTOR_WRITER_H
+
+/*
+ * ZstdConnectorWriter.h
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * ConnectorWriter compresses data using the Zstandard library.
+ * The compression level is passed to Zstandard as is; if a pre-trained
+ * dictionary is configured for the type of traffic handled by the writer
+ * (TCP streams or UDP datagrams), it is referenced by the compression context.
+ */
+
+#include "zstd.h"
+
+#include "Mutex.h"
+#include "ConnectorWriter.h"
+
+
+namespace ACMNetProxy
+{
+    class ZstdConnectorWriter : public ConnectorWriter
+    {
+    public:
+        ZstdConnectorWriter (const CompressionSettings & compressionSettings, bool bUDPDatagrams = false, unsigned long ulOutBufSize = 2048);
+        virtual ~ZstdConnectorWriter (void);
+
+        virtual const CompressionType getCompressionFlag (void) const;
+        using ConnectorWriter::getCompressionLevel;
+        using ConnectorWriter::getCompressionName;
+        using ConnectorWriter::getCompressionSetting;
+        using ConnectorWriter::isFlushed;
+
+        virtual int lockConnectorWriter (void);
+        virtual int unlockConnectorWriter (void);
+        virtual int flush (unsigned char **pDest, unsigned int &uiDestLen);
+        virtual int writeData (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen, bool bLocalFlush = true);
+        virtual int writeDataAndResetWriter (const unsigned char *pSrc, unsigned int uiSrcLen, unsigned char **pDest, unsigned int &uiDestLen);
+
+
+    private:
+        int compressStream (const unsigned char *pSrc, unsigned int uiSrcLen, ZSTD_EndDirective zstdEndOp,
+                            unsigned char **pDest, unsigned int &uiDestLen);
+        void resetCompStream (void);
+
+        unsigned char * _pOutputBuffer;
+        unsigned long _ulOutBufSize;
+        const bool _bUDPDatagrams;
+        ZSTD_CCtx * _pCCtx;
+
+        NOMADSUtil::Mutex _mtx;
+    };
+
+
+    inline const CompressionType ZstdConnectorWriter::getCompressionFlag (void) const
+    {
+        return CompressionType::PMC_ZstdCompressedData;
+    }
+
+    inline int ZstdConnectorWriter::lockConnectorWriter (void)
+    {
+        return _mtx.lock();
+    }
+
+    inline int ZstdConnectorWriter::unlockConnectorWriter (void)
+    {
+        return _mtx.unlock();
+    }
+
+}
+
+#endif // INCL_ZSTD_CONNECTOR_WRITER_H
@@ -0,0 +1,120 @@
+/*
+ * ZstdDictionaries.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include <fstream>
+#include <iterator>
+
+#include "Logger.h"
+
+#include "ZstdDictionaries.h"
+#include "ConfigurationParameters.h"
+
+
+#define checkAndLogMsg(_f_name_, _log_level_, ...) \
+    if (NOMADSUtil::pLogger && (NOMADSUtil::pLogger->getDebugLevel() >= _log_level_)) \
+        NOMADSUtil::pLogger->logMsg (_f_name_, _log_level_, __VA_ARGS__)
+
+namespace ACMNetProxy
+{
+    const ZSTD_CDict * ZstdDictionaries::getCompressionDictionary (bool bUDPDatagrams, int iCompressionLevel)
+    {
+        std::lock_guard<std::mutex> lg{_mtx};
+        auto * const pZstdDictionary = loadDictionaryFile (bUDPDatagrams);
+        if (!pZstdDictionary) {
+            return nullptr;
+        }
+
+        if ((iCompressionLevel < 0) || (iCompressionLevel > CompressionSettings::MAX_COMPRESSION_LEVEL)) {
+            iCompressionLevel = CompressionSettings::DEFAULT_COMPRESSION_LEVEL;
+        }
+        auto *& pCDict = pZstdDictionary->apCDicts[iCompressionLevel];
+        if (!pCDict) {
+            // Digesting the dictionary is expensive, so each (dictionary, level) pair is digested only once
+            pCDict = ZSTD_createCDict (pZstdDictionary->sDictionary.data(), pZstdDictionary->sDictionary.size(), iCompressionLevel);
+            if (!pCDict) {
+                checkAndLogMsg ("ZstdDictionaries::getCompressionDictionary", NOMADSUtil::Logger::L_MildError,
+                                "ZSTD_createCDict() failed for the dictionary in file <%s> with compression level %d\n",
+                                getDictionaryFilePath (bUDPDatagrams).c_str(), iCompressionLevel);
+            }
+        }
+
+        return pCDict;
+    }
+
+    const ZSTD_DDict * ZstdDictionaries::getDecompressionDictionary (bool bUDPDatagrams)
+    {
+        std::lock_guard<std::mutex> lg{_mtx};
+        auto * const pZstdDictionary = loadDictionaryFile (bUDPDatagrams);
+        if (!pZstdDictionary) {
+            return nullptr;
+        }
+
+        if (!pZstdDictionary->pDDict) {
+            pZstdDictionary->pDDict = ZSTD_createDDict (pZstdDictionary->sDictionary.data(), pZstdDictionary->sDictionary.size());
+            if (!pZstdDictionary->pDDict) {
+                checkAndLogMsg ("ZstdDictionaries::getDecompressionDictionary", NOMADSUtil::Logger::L_MildError,
+                                "ZSTD_createDDict() failed for the dictionary in file <%s>\n",
+                                getDictionaryFilePath (bUDPDatagrams).c_str());
+            }
+        }
+
+        return pZstdDictionary->pDDict;
+    }
+
+    // Must be invoked with _mtx locked; returns nullptr if no dictionary is available
+    ZstdDictionaries::ZstdDictionary * ZstdDictionaries::loadDictionaryFile (bool bUDPDatagrams)
+    {
+        const auto & sDictionaryFilePath = getDictionaryFilePath (bUDPDatagrams);
+        if (sDictionaryFilePath.empty()) {
+            return nullptr;
+        }
+
+        auto & zstdDictionary = _umDictionaries[sDictionaryFilePath];
+        if (zstdDictionary.bLoaded) {
+            return zstdDictionary.sDictionary.empty() ? nullptr : &zstdDictionary;
+        }
+        zstdDictionary.bLoaded = true;
+
+        std::ifstream ifs{sDictionaryFilePath, std::ios::in | std::ios::binary};
+        if (!ifs) {
+            checkAndLogMsg ("ZstdDictionaries::loadDictionaryFile", NOMADSUtil::Logger::L_MildError,
+                            "impossible to open the Zstandard dictionary file <%s>; %s payloads "
+                            "will be compressed without a dictionary\n", sDictionaryFilePath.c_str(),
+                            bUDPDatagrams ? "UDP" : "TCP");
+            return nullptr;
+        }
+        zstdDictionary.sDictionary.assign (std::istreambuf_iterator<char>{ifs}, std::istreambuf_iterator<char>{});
+        checkAndLogMsg ("ZstdDictionaries::loadDictionaryFile", NOMADSUtil::Logger::L_Info,
+                        "loaded Zstandard dictionary with ID %u (%u bytes) from file <%s>\n",
+                        ZSTD_getDictID_fromDict (zstdDictionary.sDictionary.data(), zstdDictionary.sDictionary.size()),
+                        static_cast<unsigned int> (zstdDictionary.sDictionary.size()), sDictionaryFilePath.c_str());
+
+        return zstdDictionary.sDictionary.empty() ? nullptr : &zstdDictionary;
+    }
+
+    const std::string & ZstdDictionaries::getDictionaryFilePath (bool bUDPDatagrams)
+    {
+        return bUDPDatagrams ? NetworkConfigurationSettings::ZSTD_UDP_DICTIONARY_FILE :
+            NetworkConfigurationSettings::ZSTD_TCP_DICTIONARY_FILE;
+    }
+
+
+    std::mutex ZstdDictionaries::_mtx;
+    std::unordered_map<std::string, ZstdDictionaries::ZstdDictionary> ZstdDictionaries::_umDictionaries;
+}
@@ -0,0 +1,75 @@
+#ifndef INCL_ZSTD_DICTIONARIES_H
+#define INCL_ZSTD_DICTIONARIES_H
+
+/*
+ * ZstdDictionaries.h
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Loads the pre-trained Zstandard dictionaries specified in the configuration
+ * and shares their digested form among all Zstd ConnectorReaders and Writers.
+ * Dictionaries are loaded lazily the first time they are requested; a
+ * nullptr is returned if no dictionary was configured or if loading failed.
+ * The dictionary file is read when the reader or writer is created, so
+ * changing the configured path only affects new readers and writers.
+ */
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "zstd.h"
+
+#include "CompressionSettings.h"
+
+
+namespace ACMNetProxy
+{
+    class ZstdDictionaries
+    {
+    public:
+        static const ZSTD_CDict * getCompressionDictionary (bool bUDPDatagrams, int iCompressionLevel);
+        static const ZSTD_DDict * getDecompressionDictionary (bool bUDPDatagrams);
+
+
+    private:
+        struct ZstdDictionary
+        {
+            ZstdDictionary (void);
+
+            bool bLoaded;
+            std::string sDictionary;
+            ZSTD_CDict * apCDicts[CompressionSettings::MAX_COMPRESSION_LEVEL + 1];
+            ZSTD_DDict * pDDict;
+        };
+
+        ZstdDictionaries (void) = delete;
+
+        static ZstdDictionary * loadDictionaryFile (bool bUDPDatagrams);
+
+        static const std::string & getDictionaryFilePath (bool bUDPDatagrams);
+
+        static std::mutex _mtx;
+        static std::unordered_map<std::string, ZstdDictionary> _umDictionaries;
+    };
+
+
+    inline ZstdDictionaries::ZstdDictionary::ZstdDictionary (void) :
+        bLoaded{false}, apCDicts{}, pDDict{nullptr}
+    { }
+}
+
+#endif  // INCL_ZSTD_DICTIONARIES_H
@@ -60,6 +60,11 @@ ZLibConnectorWriter.cpp
 #main.cpp \
 #LzmaConnectorReader.cpp \
 #LzmaConnectorWriter.cpp \
+#Lz4ConnectorReader.cpp \
+#Lz4ConnectorWriter.cpp \
+#ZstdConnectorReader.cpp \
+#ZstdConnectorWriter.cpp \
+#ZstdDictionaries.cpp \
 
 
 LOCAL_MODULE    := netproxy
@@ -0,0 +1,200 @@
+/*
+ * ChecksumBenchmark.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Measures the throughput of the Internet checksum kernels for the packet sizes that the
+ * NetProxy typically handles, compared with the 16-bit loop that IPHeader::computeChecksum()
+ * used before the kernels were introduced, and checks that all kernels return the same
+ * checksum for any length and alignment of the buffer.
+ * It then compares the cost of recomputing the IP header checksum after decrementing the TTL
+ * with the cost of updating it incrementally, as the PacketRouter does when forwarding packets.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "net/InternetChecksum.h"
+#include "net/NetworkHeaders.h"
+
+
+using namespace NOMADSUtil;
+
+static const uint32 BYTES_PER_MEASUREMENT = 256U * 1024U * 1024U;
+static const uint32 HEADER_UPDATES = 20000000U;
+static const uint16 PACKET_SIZES[] = {40, 64, 128, 256, 576, 1024, 1500, 4096, 9000, 65535};
+
+static volatile uint32 ui32Sink;
+
+static uint16 legacyChecksum (const void * pBuf, uint16 ui16BufLen)
+{
+    uint32 ui32Sum = 0;
+    const auto * pui8ChecksumData = reinterpret_cast<const uint8 *> (pBuf);
+    while (ui16BufLen > 1) {
+        ui32Sum += *reinterpret_cast<const uint16 *> (pui8ChecksumData);
+        pui8ChecksumData += 2;
+        ui16BufLen -= 2;
+    }
+    if (ui16BufLen > 0) {
+        ui32Sum += *pui8ChecksumData;
+    }
+    while (ui32Sum >> 16) {
+        ui32Sum = (ui32Sum & 0xFFFF) + (ui32Sum >> 16);
+    }
+
+    return static_cast<uint16> (~ui32Sum);
+}
+
+static uint16 kernelChecksum (InternetChecksum::Kernel kernel, const void * pBuf, uint16 ui16BufLen)
+{
+    return static_cast<uint16> (~InternetChecksum::fold (InternetChecksum::partialSum (kernel, pBuf, ui16BufLen)));
+}
+
+static double elapsedSeconds (std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+}
+
+// Returns the throughput in MB/s; kernel < 0 selects the legacy loop
+static double measureThroughput (int kernel, const uint8 * pui8Buf, uint16 ui16PacketSize)
+{
+    const uint32 ui32Iterations = BYTES_PER_MEASUREMENT / ui16PacketSize;
+    uint32 ui32Acc = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < ui32Iterations; ++i) {
+        ui32Acc += (kernel < 0) ? legacyChecksum (pui8Buf, ui16PacketSize) :
+            kernelChecksum (static_cast<InternetChecksum::Kernel> (kernel), pui8Buf, ui16PacketSize);
+    }
+    const double dSeconds = elapsedSeconds (start);
+    ui32Sink = ui32Acc;
+
+    return (static_cast<double> (ui32Iterations) * ui16PacketSize) / (dSeconds * 1024 * 1024);
+}
+
+static int checkKernels (const std::vector<InternetChecksum::Kernel> & vKernels, const uint8 * pui8Buf)
+{
+    for (uint16 ui16Offset = 0; ui16Offset < 32; ++ui16Offset) {
+        for (uint32 ui32Len = 0; ui32Len <= 2048; ++ui32Len) {
+            const uint16 ui16Expected = legacyChecksum (pui8Buf + ui16Offset, static_cast<uint16> (ui32Len));
+            for (const auto kernel : vKernels) {
+                const uint16 ui16Checksum = kernelChecksum (kernel, pui8Buf + ui16Offset, static_cast<uint16> (ui32Len));
+                if (ui16Checksum != ui16Expected) {
+                    fprintf (stderr, "%s kernel returned 0x%04hx instead of 0x%04hx for %u bytes at offset %hu\n",
+                             InternetChecksum::getKernelName (kernel), ui16Checksum, ui16Expected, ui32Len, ui16Offset);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+// Decrements the TTL of the header (in host byte order) HEADER_UPDATES times, and checks that the incremental update matches the full recomputation
+static int measureHeaderUpdate (void)
+{
+    IPHeader ipHeader;
+    memset (&ipHeader, 0, sizeof(IPHeader));
+    ipHeader.ui8VerAndHdrLen = 0x45;
+    ipHeader.ui16TLen = 1500;
+    ipHeader.ui16Ident = 0x1234;
+    ipHeader.ui8Proto = IP_PROTO_TCP;
+    ipHeader.srcAddr.ui32Addr = 0x0A000001U;
+    ipHeader.destAddr.ui32Addr = 0xC0A80001U;
+
+    ipHeader.ui8TTL = 255;
+    ipHeader.computeChecksum();
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < HEADER_UPDATES; ++i) {
+        if (--ipHeader.ui8TTL == 0) {
+            ipHeader.ui8TTL = 255;
+        }
+        ipHeader.computeChecksum();
+    }
+    const double dFullSeconds = elapsedSeconds (start);
+    const uint16 ui16FullChecksum = ipHeader.ui16CRC;
+
+    ipHeader.ui8TTL = 255;
+    ipHeader.computeChecksum();
+    start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < HEADER_UPDATES; ++i) {
+        const uint16 ui16OldTTLAndProto = (static_cast<uint16> (ipHeader.ui8TTL) << 8) | ipHeader.ui8Proto;
+        if (--ipHeader.ui8TTL == 0) {
+            ipHeader.ui8TTL = 255;
+        }
+        const uint16 ui16NewTTLAndProto = (static_cast<uint16> (ipHeader.ui8TTL) << 8) | ipHeader.ui8Proto;
+        ipHeader.ui16CRC = InternetChecksum::update (ipHeader.ui16CRC, ui16OldTTLAndProto, ui16NewTTLAndProto);
+    }
+    const double dIncrementalSeconds = elapsedSeconds (start);
+    const uint16 ui16IncrementalChecksum = ipHeader.ui16CRC;
+
+    printf ("\nIP header checksum after a TTL decrement: full %.1f ns - incremental %.1f ns\n",
+            (dFullSeconds * 1e9) / HEADER_UPDATES, (dIncrementalSeconds * 1e9) / HEADER_UPDATES);
+    ipHeader.computeChecksum();
+    if ((ui16IncrementalChecksum != ui16FullChecksum) || (ui16IncrementalChecksum != ipHeader.ui16CRC)) {
+        fprintf (stderr, "incremental checksum 0x%04hx does not match the full checksum 0x%04hx\n",
+                 ui16IncrementalChecksum, ipHeader.ui16CRC);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main (int argc, char ** ppszArgv)
+{
+    // Room for the largest packet at any of the offsets used to check the kernels
+    std::vector<uint8> vBuf (65536U + 64U);
+    srand (1);
+    for (auto & ui8Byte : vBuf) {
+        ui8Byte = static_cast<uint8> (rand());
+    }
+
+    std::vector<InternetChecksum::Kernel> vKernels;
+    for (const auto kernel : {InternetChecksum::K_Scalar, InternetChecksum::K_SSE2, InternetChecksum::K_AVX2}) {
+        if (InternetChecksum::isKernelSupported (kernel)) {
+            vKernels.push_back (kernel);
+        }
+    }
+    if (checkKernels (vKernels, vBuf.data()) < 0) {
+        return -1;
+    }
+
+    printf ("Best kernel on this CPU: %s\n\n", InternetChecksum::getKernelName (InternetChecksum::getBestKernel()));
+    printf ("%7s | %12s", "bytes", "legacy MB/s");
+    for (const auto kernel : vKernels) {
+        printf (" | %7s MB/s", InternetChecksum::getKernelName (kernel));
+    }
+    printf (" | speedup\n");
+    for (const auto ui16PacketSize : PACKET_SIZES) {
+        // Packets start right after the 14 bytes of the Ethernet header, so they are never 16-byte aligned
+        const uint8 * pui8Packet = vBuf.data() + 14;
+        const double dLegacy = measureThroughput (-1, pui8Packet, ui16PacketSize);
+        double dBest = dLegacy;
+        printf ("%7hu | %12.0f", ui16PacketSize, dLegacy);
+        for (const auto kernel : vKernels) {
+            const double dThroughput = measureThroughput (kernel, pui8Packet, ui16PacketSize);
+            dBest = (dThroughput > dBest) ? dThroughput : dBest;
+            printf (" | %12.0f", dThroughput);
+        }
+        printf (" | %6.2fx\n", dBest / dLegacy);
+    }
+
+    return measureHeaderUpdate();
+}
@@ -0,0 +1,390 @@
+/*
+ * CompressionBenchmark.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Replays a set of payloads through every ConnectorWriter/ConnectorReader pair and reports
+ * the compression and decompression throughput in MB/s and the compression ratio.
+ * Each codec is measured in UDP mode, where every payload is compressed independently as
+ * the UDP connectors do, and in TCP mode, where the payloads form the stream of a connection
+ * that is flushed after each payload as the TCPManager does.
+ *
+ * Usage: CompressionBenchmark [-p payloadFile] [-d dictionaryFile | -t dictionaryFile] [-m MB]
+ *   -p  file with one hex-encoded payload per line, like the output of
+ *       "tshark -r capture.pcap -T fields -e udp.payload"; without it, a synthetic
+ *       mix of HTTP, JSON telemetry, and binary payloads is generated
+ *   -d  pre-trained Zstandard dictionary used by the zstd codecs
+ *   -t  trains a Zstandard dictionary on the first half of the payloads, saves it to the
+ *       specified file, and uses it for the zstd codecs
+ *   -m  minimum amount of data, in MB, replayed through each codec (default 8)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "zdict.h"
+
+#include "NLFLib.h"
+
+#include "ConfigurationParameters.h"
+#include "CompressionSettings.h"
+#include "ConnectorReader.h"
+#include "ConnectorWriter.h"
+
+
+using namespace ACMNetProxy;
+
+static const char * const HTTP_PATHS[] = {"/index.html", "/api/v1/tracks", "/api/v1/status", "/img/map_tile.png", "/login"};
+static const char * const UNIT_NAMES[] = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot"};
+
+struct CodecDescriptor
+{
+    const char * pszName;
+    uint8 ui8Level;
+};
+
+struct Results
+{
+    double dCompressionMBps;
+    double dDecompressionMBps;
+    double dRatio;
+};
+
+static uint32 nextRandom (uint32 & ui32State)
+{
+    // Xorshift, to generate the same payloads at every run
+    ui32State ^= ui32State << 13;
+    ui32State ^= ui32State >> 17;
+    ui32State ^= ui32State << 5;
+
+    return ui32State;
+}
+
+static std::vector<std::string> generatePayloads (void)
+{
+    std::vector<std::string> payloads;
+    uint32 ui32Rand = 2463534242U;
+    char szBuf[2048];
+    for (unsigned int ui = 0; ui < 4000; ++ui) {
+        const uint32 ui32Type = nextRandom (ui32Rand) % 10;
+        if (ui32Type < 4) {
+            // Small JSON telemetry messages, as exchanged by tracking applications over UDP
+            snprintf (szBuf, sizeof (szBuf), "{\"unit\":\"%s-%u\",\"seq\":%u,\"lat\":%.6f,\"lon\":%.6f,\"alt\":%u,"
+                      "\"speed\":%.1f,\"heading\":%u,\"status\":\"%s\",\"battery\":%u}",
+                      UNIT_NAMES[nextRandom (ui32Rand) % 6], nextRandom (ui32Rand) % 32, ui,
+                      30.0 + (nextRandom (ui32Rand) % 100000) / 100000.0, -87.0 - (nextRandom (ui32Rand) % 100000) / 100000.0,
+                      nextRandom (ui32Rand) % 500, (nextRandom (ui32Rand) % 300) / 10.0, nextRandom (ui32Rand) % 360,
+                      (nextRandom (ui32Rand) % 8) ? "nominal" : "degraded", nextRandom (ui32Rand) % 100);
+            payloads.emplace_back (szBuf);
+        }
+        else if (ui32Type < 8) {
+            // HTTP requests and responses
+            const char * const pszPath = HTTP_PATHS[nextRandom (ui32Rand) % 5];
+            if (ui32Type < 6) {
+                snprintf (szBuf, sizeof (szBuf), "GET %s?id=%u HTTP/1.1\r\nHost: 10.0.%u.%u:8080\r\n"
+                          "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:60.0) Gecko/20100101 Firefox/60.0\r\n"
+                          "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+                          "Accept-Language: en-US,en;q=0.5\r\nAccept-Encoding: identity\r\n"
+                          "Cookie: session=%08x%08x\r\nConnection: keep-alive\r\n\r\n",
+                          pszPath, nextRandom (ui32Rand) % 100000, nextRandom (ui32Rand) % 4, nextRandom (ui32Rand) % 254,
+                          nextRandom (ui32Rand), nextRandom (ui32Rand));
+            }
+            else {
+                snprintf (szBuf, sizeof (szBuf), "HTTP/1.1 200 OK\r\nServer: nginx/1.14.0\r\nDate: Mon, %02u Jul 2018 %02u:%02u:%02u GMT\r\n"
+                          "Content-Type: application/json\r\nContent-Length: %u\r\nConnection: keep-alive\r\n"
+                          "Cache-Control: no-cache\r\n\r\n{\"path\":\"%s\",\"tracks\":[{\"id\":%u,\"state\":\"active\"},"
+                          "{\"id\":%u,\"state\":\"active\"},{\"id\":%u,\"state\":\"lost\"}]}",
+                          1 + nextRandom (ui32Rand) % 28, nextRandom (ui32Rand) % 24, nextRandom (ui32Rand) % 60,
+                          nextRandom (ui32Rand) % 60, 100 + nextRandom (ui32Rand) % 900, pszPath,
+                          nextRandom (ui32Rand) % 1000, nextRandom (ui32Rand) % 1000, nextRandom (ui32Rand) % 1000);
+            }
+            payloads.emplace_back (szBuf);
+        }
+        else {
+            // Already compressed or encrypted content
+            std::string sPayload (256 + nextRandom (ui32Rand) % 768, '\0');
+            for (auto & c : sPayload) {
+                c = static_cast<char> (nextRandom (ui32Rand));
+            }
+            payloads.push_back (sPayload);
+        }
+    }
+
+    return payloads;
+}
+
+static int hexValue (char c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+static std::vector<std::string> loadPayloads (const char * pszPayloadFile)
+{
+    std::vector<std::string> payloads;
+    std::ifstream ifs{pszPayloadFile};
+    std::string sLine;
+    while (std::getline (ifs, sLine)) {
+        std::string sPayload;
+        int iHigh = -1;
+        for (const char c : sLine) {
+            // Separators, like the colons printed by older versions of tshark, are skipped
+            const int iValue = hexValue (c);
+            if (iValue < 0) {
+                continue;
+            }
+            if (iHigh < 0) {
+                iHigh = iValue;
+            }
+            else {
+                sPayload.push_back (static_cast<char> ((iHigh << 4) | iValue));
+                iHigh = -1;
+            }
+        }
+        if (!sPayload.empty()) {
+            // Payloads are carried by ProxyMessages, which have a 16 bits length field
+            payloads.push_back (sPayload.substr (0, 65535));
+        }
+    }
+
+    return payloads;
+}
+
+static int trainDictionary (const std::vector<std::string> & payloads, const char * pszDictionaryFile)
+{
+    std::string sSamples;
+    std::vector<size_t> vSampleSizes;
+    for (size_t i = 0; i < (payloads.size() / 2); ++i) {
+        sSamples += payloads[i];
+        vSampleSizes.push_back (payloads[i].size());
+    }
+
+    std::string sDictionary (16384, '\0');
+    const size_t stDictionarySize = ZDICT_trainFromBuffer (&sDictionary[0], sDictionary.size(), sSamples.data(),
+                                                           vSampleSizes.data(), static_cast<unsigned int> (vSampleSizes.size()));
+    if (ZDICT_isError (stDictionarySize)) {
+        printf ("ERROR: impossible to train the dictionary: %s\n", ZDICT_getErrorName (stDictionarySize));
+        return -1;
+    }
+
+    std::ofstream ofs{pszDictionaryFile, std::ios::out | std::ios::binary};
+    ofs.write (sDictionary.data(), stDictionarySize);
+    if (!ofs) {
+        printf ("ERROR: impossible to write the dictionary to file %s\n", pszDictionaryFile);
+        return -2;
+    }
+    printf ("Trained a %u bytes dictionary on %u payloads and saved it to %s\n",
+            static_cast<unsigned int> (stDictionarySize), static_cast<unsigned int> (vSampleSizes.size()), pszDictionaryFile);
+
+    return 0;
+}
+
+static double toMBps (uint64 ui64Bytes, int64 i64ElapsedTime)
+{
+    return (ui64Bytes / (1024.0 * 1024.0)) / (((i64ElapsedTime > 0) ? i64ElapsedTime : 1) / 1000.0);
+}
+
+// Compresses every payload independently and decompresses it with the shared UDP ConnectorReader
+static Results measureUDPMode (const CompressionSettings & compressionSettings, const std::vector<std::string> & payloads,
+                               unsigned int uiIterations)
+{
+    std::vector<std::string> compressedPayloads;
+    compressedPayloads.reserve (payloads.size() * uiIterations);
+    uint64 ui64InputBytes = 0, ui64CompressedBytes = 0;
+
+    ConnectorWriter * const pConnectorWriter = ConnectorWriter::connectorWriterFactory (compressionSettings, true);
+    int64 i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+    for (unsigned int uiIteration = 0; uiIteration < uiIterations; ++uiIteration) {
+        for (const auto & sPayload : payloads) {
+            unsigned char * pDest = nullptr;
+            unsigned int uiDestLen = 0;
+            if (0 != pConnectorWriter->writeDataAndResetWriter (reinterpret_cast<const unsigned char *> (sPayload.data()),
+                                                                sPayload.size(), &pDest, uiDestLen)) {
+                printf ("ERROR: %s failed to compress a datagram\n", compressionSettings.getCompressionTypeAsString());
+                exit (1);
+            }
+            compressedPayloads.emplace_back (reinterpret_cast<const char *> (pDest), uiDestLen);
+            ui64InputBytes += sPayload.size();
+            ui64CompressedBytes += uiDestLen;
+        }
+    }
+    const int64 i64CompressionTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+    delete pConnectorWriter;
+
+    size_t stPayload = 0;
+    i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+    for (const auto & sCompressedPayload : compressedPayloads) {
+        uint8 * pDest = nullptr;
+        uint32 ui32DestLen = 0;
+        ConnectorReader * const pConnectorReader = ConnectorReader::getAndLockUDPConnectorReader (compressionSettings);
+        const int rc = pConnectorReader->receiveTCPDataProxyMessage (reinterpret_cast<const uint8 *> (sCompressedPayload.data()),
+                                                                     static_cast<uint16> (sCompressedPayload.size()), &pDest, ui32DestLen);
+        const std::string & sPayload = payloads[stPayload++ % payloads.size()];
+        if ((rc != 0) || (ui32DestLen != sPayload.size()) || (memcmp (pDest, sPayload.data(), ui32DestLen) != 0)) {
+            printf ("ERROR: %s failed to decompress datagram %u\n", compressionSettings.getCompressionTypeAsString(),
+                    static_cast<unsigned int> (stPayload - 1));
+            exit (1);
+        }
+        pConnectorReader->resetAndUnlockConnectorReader();
+    }
+    const int64 i64DecompressionTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+
+    return Results{toMBps (ui64InputBytes, i64CompressionTime), toMBps (ui64InputBytes, i64DecompressionTime),
+                   static_cast<double> (ui64InputBytes) / ui64CompressedBytes};
+}
+
+// Compresses the payloads of each iteration as the stream of a separate connection, flushing after each
+// payload, and decompresses it in TCPData-sized chunks
+static Results measureTCPMode (const CompressionSettings & compressionSettings, const std::vector<std::string> & payloads,
+                               unsigned int uiIterations)
+{
+    std::vector<std::string> streams (uiIterations);
+    uint64 ui64InputBytes = 0, ui64CompressedBytes = 0;
+
+    int64 i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+    for (auto & sStream : streams) {
+        ConnectorWriter * const pConnectorWriter = ConnectorWriter::connectorWriterFactory (compressionSettings);
+        unsigned char * pDest = nullptr;
+        unsigned int uiDestLen = 0;
+        for (const auto & sPayload : payloads) {
+            if (0 != pConnectorWriter->writeData (reinterpret_cast<const unsigned char *> (sPayload.data()),
+                                                  sPayload.size(), &pDest, uiDestLen, true)) {
+                printf ("ERROR: %s failed to compress the stream\n", compressionSettings.getCompressionTypeAsString());
+                exit (1);
+            }
+            sStream.append (reinterpret_cast<const char *> (pDest), uiDestLen);
+            ui64InputBytes += sPayload.size();
+        }
+        pConnectorWriter->flush (&pDest, uiDestLen);
+        sStream.append (reinterpret_cast<const char *> (pDest), uiDestLen);
+        ui64CompressedBytes += sStream.size();
+        delete pConnectorWriter;
+    }
+    const int64 i64CompressionTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+
+    std::string sExpected, sDecompressed;
+    for (const auto & sPayload : payloads) {
+        sExpected += sPayload;
+    }
+    sDecompressed.reserve (sExpected.size());
+    i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+    for (const auto & sStream : streams) {
+        ConnectorReader * const pConnectorReader = ConnectorReader::inizializeConnectorReader (compressionSettings);
+        sDecompressed.clear();
+        for (size_t stOffset = 0; stOffset < sStream.size(); stOffset += NetworkConfigurationSettings::DEFAULT_MAX_TCP_DATA_PROXY_MESSAGE_PAYLOAD_SIZE) {
+            const size_t stChunkSize = std::min<size_t> (NetworkConfigurationSettings::DEFAULT_MAX_TCP_DATA_PROXY_MESSAGE_PAYLOAD_SIZE,
+                                                         sStream.size() - stOffset);
+            uint8 * pDest = nullptr;
+            uint32 ui32DestLen = 0;
+            if (0 != pConnectorReader->receiveTCPDataProxyMessage (reinterpret_cast<const uint8 *> (sStream.data() + stOffset),
+                                                                   static_cast<uint16> (stChunkSize), &pDest, ui32DestLen)) {
+                printf ("ERROR: %s failed to decompress the stream\n", compressionSettings.getCompressionTypeAsString());
+                exit (1);
+            }
+            sDecompressed.append (reinterpret_cast<const char *> (pDest), ui32DestLen);
+        }
+        delete pConnectorReader;
+        if (sDecompressed != sExpected) {
+            printf ("ERROR: %s decompressed %u bytes that do not match the %u bytes of the original stream\n",
+                    compressionSettings.getCompressionTypeAsString(), static_cast<unsigned int> (sDecompressed.size()),
+                    static_cast<unsigned int> (sExpected.size()));
+            exit (1);
+        }
+    }
+    const int64 i64DecompressionTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+
+    return Results{toMBps (ui64InputBytes, i64CompressionTime), toMBps (ui64InputBytes, i64DecompressionTime),
+                   static_cast<double> (ui64InputBytes) / ui64CompressedBytes};
+}
+
+int main (int argc, char *argv[])
+{
+    static const CodecDescriptor CODECS[] = {{"none", 0}, {"zlib", 1}, {"zlib", 6}, {"lzma", 1}, {"lzma", 6},
+                                             {"lz4", 1}, {"lz4", 9}, {"zstd", 1}, {"zstd", 3}, {"zstd", 9}};
+
+    const char * pszPayloadFile = nullptr;
+    const char * pszDictionaryFile = nullptr;
+    const char * pszTrainedDictionaryFile = nullptr;
+    unsigned int uiMinMB = 8;
+    for (int i = 1; i < argc - 1; i += 2) {
+        if (0 == strcmp (argv[i], "-p")) {
+            pszPayloadFile = argv[i + 1];
+        }
+        else if (0 == strcmp (argv[i], "-d")) {
+            pszDictionaryFile = argv[i + 1];
+        }
+        else if (0 == strcmp (argv[i], "-t")) {
+            pszTrainedDictionaryFile = argv[i + 1];
+        }
+        else if (0 == strcmp (argv[i], "-m")) {
+            uiMinMB = static_cast<unsigned int> (atoi (argv[i + 1]));
+        }
+    }
+
+    const std::vector<std::string> payloads = pszPayloadFile ? loadPayloads (pszPayloadFile) : generatePayloads();
+    uint64 ui64PayloadBytes = 0;
+    for (const auto & sPayload : payloads) {
+        ui64PayloadBytes += sPayload.size();
+    }
+    if (ui64PayloadBytes == 0) {
+        printf ("ERROR: no payloads to replay\n");
+        return 1;
+    }
+    const unsigned int uiIterations = static_cast<unsigned int> (((uiMinMB * 1024ULL * 1024ULL) + ui64PayloadBytes - 1) / ui64PayloadBytes);
+    printf ("Replaying %u payloads (%llu bytes, average size %llu bytes) %u times through each codec\n",
+            static_cast<unsigned int> (payloads.size()), static_cast<unsigned long long> (ui64PayloadBytes),
+            static_cast<unsigned long long> (ui64PayloadBytes / payloads.size()), uiIterations);
+
+    if (pszTrainedDictionaryFile) {
+        if (0 != trainDictionary (payloads, pszTrainedDictionaryFile)) {
+            return 1;
+        }
+        pszDictionaryFile = pszTrainedDictionaryFile;
+    }
+    if (pszDictionaryFile) {
+        NetworkConfigurationSettings::ZSTD_TCP_DICTIONARY_FILE = pszDictionaryFile;
+        NetworkConfigurationSettings::ZSTD_UDP_DICTIONARY_FILE = pszDictionaryFile;
+        printf ("The zstd codecs use the dictionary in file %s\n", pszDictionaryFile);
+    }
+
+    printf ("\n%6s %6s %6s %16s %16s %8s\n", "Codec", "Level", "Mode", "Compress (MB/s)", "Decompress (MB/s)", "Ratio");
+    for (const auto & rCodec : CODECS) {
+        const CompressionSettings compressionSettings{rCodec.pszName, static_cast<int8> (rCodec.ui8Level)};
+        const Results udpResults = measureUDPMode (compressionSettings, payloads, uiIterations);
+        printf ("%6s %6u %6s %16.1f %16.1f %8.3f\n", rCodec.pszName, rCodec.ui8Level, "UDP",
+                udpResults.dCompressionMBps, udpResults.dDecompressionMBps, udpResults.dRatio);
+        const Results tcpResults = measureTCPMode (compressionSettings, payloads, uiIterations);
+        printf ("%6s %6u %6s %16.1f %16.1f %8.3f\n", rCodec.pszName, rCodec.ui8Level, "TCP",
+                tcpResults.dCompressionMBps, tcpResults.dDecompressionMBps, tcpResults.dRatio);
+    }
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * TCPConnTableBenchmark.cpp
+ *
+ * This file is part of the IHMC NetProxy Library/Component
+ * Copyright (c) 2010-2018 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Measures the throughput of the 4-tuple lookups in the TCPConnTable with 100, 1k and 10k
+ * concurrent flows, with one lookup thread and with several lookup threads running while
+ * another thread iterates over the table holding its mutex, as the LocalTCPTransmitter does.
+ * The throughput of a linear scan of the entries under one mutex, which is how lookups were
+ * performed before the hash index was introduced, is reported for comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "NLFLib.h"
+
+#include "Entry.h"
+#include "TCPConnTable.h"
+
+
+using namespace ACMNetProxy;
+
+static const unsigned int LOOKUPS_PER_THREAD = 2000000;
+static const unsigned int LINEAR_SCAN_LOOKUPS = 200000;
+static const unsigned int LOOKUP_THREADS = 4;
+
+struct FourTuple
+{
+    uint32 ui32LocalIP;
+    uint16 ui16LocalPort;
+    uint32 ui32RemoteIP;
+    uint16 ui16RemotePort;
+};
+
+static std::vector<FourTuple> generateFlows (unsigned int uiFlows)
+{
+    std::vector<FourTuple> flows;
+    flows.reserve (uiFlows);
+    for (unsigned int ui = 0; ui < uiFlows; ++ui) {
+        // Few local hosts talking to few remote hosts, as seen by a NetProxy that serves a subnetwork
+        flows.push_back (FourTuple{0x0A000001U + (ui % 16), static_cast<uint16> (32768 + (ui / 16)),
+                                   0xC0A80001U + (ui % 7), static_cast<uint16> ((ui % 3) ? 80 : 443)});
+    }
+
+    return flows;
+}
+
+// Returns the number of lookups per second performed by each of uiThreads threads
+static double measureLookups (TCPConnTable & rTCPConnTable, const std::vector<FourTuple> & flows,
+                              unsigned int uiThreads, bool bIterate)
+{
+    std::atomic<bool> abStop{false};
+    std::atomic<unsigned int> aFailures{0};
+    std::thread iterator;
+    if (bIterate) {
+        iterator = std::thread{[&rTCPConnTable, &abStop] () {
+            while (!abStop) {
+                std::lock_guard<std::mutex> lg{rTCPConnTable.getMutexRef()};
+                rTCPConnTable.resetGet();
+                while (rTCPConnTable.getNextActiveLocalEntry() != nullptr) { }
+            }
+        }};
+    }
+
+    std::vector<std::thread> lookupThreads;
+    const int64 i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+    for (unsigned int uiThread = 0; uiThread < uiThreads; ++uiThread) {
+        lookupThreads.emplace_back ([&rTCPConnTable, &flows, &aFailures, uiThread] () {
+            uint32 ui32Rand = 2463534242U + uiThread;
+            for (unsigned int ui = 0; ui < LOOKUPS_PER_THREAD; ++ui) {
+                // Xorshift, to pick the flows in random order
+                ui32Rand ^= ui32Rand << 13;
+                ui32Rand ^= ui32Rand >> 17;
+                ui32Rand ^= ui32Rand << 5;
+                const FourTuple & rFlow = flows[ui32Rand % flows.size()];
+                const Entry * const pEntry = rTCPConnTable.getEntry (rFlow.ui32LocalIP, rFlow.ui16LocalPort,
+                                                                     rFlow.ui32RemoteIP, rFlow.ui16RemotePort);
+                if (!pEntry || (pEntry->ui16LocalPort != rFlow.ui16LocalPort)) {
+                    ++aFailures;
+                }
+            }
+        });
+    }
+    for (auto & rThread : lookupThreads) {
+        rThread.join();
+    }
+    const int64 i64ElapsedTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+    abStop = true;
+    if (bIterate) {
+        iterator.join();
+    }
+
+    if (aFailures > 0) {
+        printf ("ERROR: %u lookups returned the wrong entry\n", aFailures.load());
+        exit (1);
+    }
+
+    return (LOOKUPS_PER_THREAD * 1000.0) / ((i64ElapsedTime > 0) ? i64ElapsedTime : 1);
+}
+
+// Returns the number of lookups per second performed with a linear scan of the entries under one mutex
+static double measureLinearScan (const std::vector<Entry *> & entries, const std::vector<FourTuple> & flows)
+{
+    std::mutex mtx;
+    unsigned int uiFailures = 0;
+    uint32 ui32Rand = 2463534242U;
+    const int64 i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+    for (unsigned int ui = 0; ui < LINEAR_SCAN_LOOKUPS; ++ui) {
+        ui32Rand ^= ui32Rand << 13;
+        ui32Rand ^= ui32Rand >> 17;
+        ui32Rand ^= ui32Rand << 5;
+        const FourTuple & rFlow = flows[ui32Rand % flows.size()];
+        const Entry * pFound = nullptr;
+        std::lock_guard<std::mutex> lg{mtx};
+        for (const auto * const pEntry : entries) {
+            if ((pEntry->ui32LocalIP == rFlow.ui32LocalIP) && (pEntry->ui16LocalPort == rFlow.ui16LocalPort) &&
+                (pEntry->ui32RemoteIP == rFlow.ui32RemoteIP) && (pEntry->ui16RemotePort == rFlow.ui16RemotePort)) {
+                pFound = pEntry;
+                break;
+            }
+        }
+        if (!pFound) {
+            ++uiFailures;
+        }
+    }
+    const int64 i64ElapsedTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+    if (uiFailures > 0) {
+        printf ("ERROR: %u linear scans did not find the entry\n", uiFailures);
+        exit (1);
+    }
+
+    return (LINEAR_SCAN_LOOKUPS * 1000.0) / ((i64ElapsedTime > 0) ? i64ElapsedTime : 1);
+}
+
+int main (int argc, char *argv[])
+{
+    static const unsigned int FLOWS[] = {100, 1000, 10000};
+
+    printf ("%8s %18s %18s %24s %18s\n", "Flows", "Linear (lk/s)", "1 thread (lk/s)",
+            "4 threads+iter (lk/s/th)", "Entries added/s");
+    for (const auto uiFlows : FLOWS) {
+        TCPConnTable tcpConnTable;
+        const std::vector<FourTuple> flows = generateFlows (uiFlows);
+
+        // Add the flows to the table; the entries are marked as established, so that they are not reused
+        std::vector<Entry *> entries;
+        const int64 i64StartTime = NOMADSUtil::getTimeInMilliseconds();
+        for (const auto & rFlow : flows) {
+            Entry * const pEntry = tcpConnTable.getEntry (rFlow.ui32LocalIP, rFlow.ui16LocalPort,
+                                                          rFlow.ui32RemoteIP, rFlow.ui16RemotePort);
+            if (!pEntry) {
+                printf ("ERROR: failed to add a flow to the table\n");
+                return 1;
+            }
+            pEntry->localState = TCTLS_ESTABLISHED;
+            entries.push_back (pEntry);
+        }
+        const int64 i64InsertTime = NOMADSUtil::getTimeInMilliseconds() - i64StartTime;
+        if (tcpConnTable.getEntriesNum() != uiFlows) {
+            printf ("ERROR: the table contains %u entries instead of %u\n", tcpConnTable.getEntriesNum(), uiFlows);
+            return 1;
+        }
+
+        const double dLinear = measureLinearScan (entries, flows);
+        const double dSingle = measureLookups (tcpConnTable, flows, 1, false);
+        const double dConcurrent = measureLookups (tcpConnTable, flows, LOOKUP_THREADS, true);
+        printf ("%8u %18.0f %18.0f %24.0f %18.0f\n", uiFlows, dLinear, dSingle, dConcurrent,
+                (uiFlows * 1000.0) / ((i64InsertTime > 0) ? i64InsertTime : 1));
+    }
+
+    return 0;
+}
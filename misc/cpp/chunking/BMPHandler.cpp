@@ -24,6 +24,7 @@
 #include "NLFLib.h"
 
 #include <assert.h>
+#include <string.h>
 
 using namespace IHMC_MISC;
 using namespace NOMADSUtil;
@@ -44,6 +45,49 @@ namespace IHMC_MISC
             static uint8 computeYOffset (uint8 ui8ChunkId, uint8 ui8TotalNoOfChunks);
             static uint8 computeChunkIdForOffset (uint8 ui8XOffset, uint8 ui8YOffset, uint8 ui8TotalNoOfChunks);
     };
+
+    static const unsigned int BYTES_PER_PIXEL = 3;    // Only 24 bits/pixel images are supported
+    static const unsigned int MAX_X_INCREMENT = 4;
+
+    // Distributes the pixels of the source line among the XINCR destination lines,
+    // so that apDstLines[k] receives pixels k, k + XINCR, k + 2*XINCR, ... of the
+    // source line.  ui32Groups groups of XINCR pixels are copied.
+    // The stride is a compile-time constant and the loop has no branches, so that
+    // it can be unrolled and vectorized by the compiler.
+    template <unsigned int XINCR>
+    void decimateLine (const uint8 *pSrcLine, uint8 * const *apDstLines, uint32 ui32Groups)
+    {
+        uint8 *apDst[XINCR];
+        for (unsigned int k = 0; k < XINCR; k++) {
+            apDst[k] = apDstLines[k];
+        }
+        for (uint32 ui32Group = 0; ui32Group < ui32Groups; ui32Group++) {
+            const uint8 *pSrc = pSrcLine + (ui32Group * XINCR * BYTES_PER_PIXEL);
+            const uint32 ui32DstIdx = ui32Group * BYTES_PER_PIXEL;
+            for (unsigned int k = 0; k < XINCR; k++) {
+                apDst[k][ui32DstIdx + 0] = pSrc[(k * BYTES_PER_PIXEL) + 0];
+                apDst[k][ui32DstIdx + 1] = pSrc[(k * BYTES_PER_PIXEL) + 1];
+                apDst[k][ui32DstIdx + 2] = pSrc[(k * BYTES_PER_PIXEL) + 2];
+            }
+        }
+    }
+
+    void decimateLine (uint8 ui8XIncr, const uint8 *pSrcLine, uint8 * const *apDstLines, uint32 ui32Groups)
+    {
+        switch (ui8XIncr) {
+            case 1:
+                decimateLine<1> (pSrcLine, apDstLines, ui32Groups);
+                break;
+            case 2:
+                decimateLine<2> (pSrcLine, apDstLines, ui32Groups);
+                break;
+            case 4:
+                decimateLine<4> (pSrcLine, apDstLines, ui32Groups);
+                break;
+            default:
+                assert (false);
+        }
+    }
 }
 
 uint8 BMPHandler::computeXIncrement (uint8 ui8TotalNoOfChunks)
@@ -166,6 +210,84 @@ BMPImage * BMPChunker::fragmentBMP (BMPImage *pSourceImage, uint8 ui8DesiredChun
     return pChunkedImage;
 }
 
+int BMPChunker::fragmentBMP (const BMPImage *pSourceImage, uint8 ui8TotalNoOfChunks, BMPImage **ppChunks)
+{
+    const char *pszMethodName = "BMPChunker::fragmentBMP";
+    if (pSourceImage == NULL) {
+        checkAndLogMsg (pszMethodName, nullSrcImgErrMsg);
+        return -1;
+    }
+    if (ppChunks == NULL) {
+        checkAndLogMsg (pszMethodName, Logger::L_MildError, "chunk array is null\n");
+        return -2;
+    }
+    if (pSourceImage->getBitsPerPixel() != 24) {
+        checkAndLogMsg (pszMethodName, wrongBitsPerPixErrMsg ((int)pSourceImage->getBitsPerPixel()));
+        return -3;
+    }
+    const uint8 ui8XIncr = BMPHandler::computeXIncrement (ui8TotalNoOfChunks);
+    const uint8 ui8YIncr = BMPHandler::computeYIncrement (ui8TotalNoOfChunks);
+    if ((ui8XIncr == 0) || (ui8YIncr == 0) || (ui8XIncr > MAX_X_INCREMENT)) {
+        checkAndLogMsg (pszMethodName, Logger::L_MildError,
+                        "cannot handle chunking BMP into %d chunks\n",
+                        (int) ui8TotalNoOfChunks);
+        return -4;
+    }
+
+    const uint32 ui32SrcWidth = pSourceImage->getWidth();
+    const uint32 ui32SrcHeight = pSourceImage->getHeight();
+    const uint32 ui32NewWidth = ceiling ((ui32SrcWidth / ui8XIncr), ui8XIncr);
+    const uint32 ui32NewHeight = ceiling ((ui32SrcHeight / ui8YIncr), ui8YIncr);
+    for (uint8 i = 0; i < ui8TotalNoOfChunks; i++) {
+        ppChunks[i] = NULL;
+    }
+    for (uint8 i = 0; i < ui8TotalNoOfChunks; i++) {
+        int rc;
+        ppChunks[i] = new BMPImage (true);
+        if (0 != (rc = ppChunks[i]->initNewImage (ui32NewWidth, ui32NewHeight, pSourceImage->getBitsPerPixel()))) {
+            checkAndLogMsg (pszMethodName, faildToInitBitmapErrMsg, ui32NewWidth, ui32NewHeight,
+                            (int) pSourceImage->getBitsPerPixel(), rc);
+            for (uint8 j = 0; j <= i; j++) {
+                delete ppChunks[j];
+                ppChunks[j] = NULL;
+            }
+            return -5;
+        }
+    }
+
+    // Columns and lines of the chunks that correspond to a pixel of the source
+    // image (the chunks may be larger because of the rounding of their size)
+    const uint32 ui32Cols = minimum (ui32NewWidth, (ui32SrcWidth + ui8XIncr - 1) / ui8XIncr);
+    const uint32 ui32Lines = minimum (ui32NewHeight, (ui32SrcHeight + ui8YIncr - 1) / ui8YIncr);
+    // Columns for which all the ui8XIncr source pixels fall in the source image
+    const uint32 ui32FullGroups = minimum (ui32Cols, ui32SrcWidth / ui8XIncr);
+
+    // Each line of the source image is read once, in order, and its pixels are
+    // distributed among the chunks that have the same y offset
+    uint8 *apDstLines[MAX_X_INCREMENT];
+    for (uint32 ui32Line = 0; ui32Line < ui32Lines; ui32Line++) {
+        for (uint8 ui8YOff = 0; ui8YOff < ui8YIncr; ui8YOff++) {
+            const uint32 ui32SrcY = minimum ((ui32Line * ui8YIncr) + ui8YOff, ui32SrcHeight - 1);
+            const uint8 *pSrcLine = pSourceImage->getLinePtr (ui32SrcY);
+            for (uint8 ui8XOff = 0; ui8XOff < ui8XIncr; ui8XOff++) {
+                const uint8 ui8ChunkId = BMPHandler::computeChunkIdForOffset (ui8XOff, ui8YOff, ui8TotalNoOfChunks);
+                apDstLines[ui8XOff] = ppChunks[ui8ChunkId - 1]->getLinePtr (ui32Line);
+            }
+            decimateLine (ui8XIncr, pSrcLine, apDstLines, ui32FullGroups);
+
+            // Pixels past the right edge of the source image are replaced by the last pixel of the line
+            for (uint32 ui32Col = ui32FullGroups; ui32Col < ui32Cols; ui32Col++) {
+                for (uint8 ui8XOff = 0; ui8XOff < ui8XIncr; ui8XOff++) {
+                    const uint32 ui32SrcX = minimum ((ui32Col * ui8XIncr) + ui8XOff, ui32SrcWidth - 1);
+                    memcpy (apDstLines[ui8XOff] + (ui32Col * BYTES_PER_PIXEL),
+                            pSrcLine + (ui32SrcX * BYTES_PER_PIXEL), BYTES_PER_PIXEL);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
 BMPImage * BMPChunker::extractFromBMP (BMPImage *pSourceImage, uint32 ui32StartX, uint32 ui32EndX, uint32 ui32StartY, uint32 ui32EndY)
 {
     if (pSourceImage == NULL) {
@@ -34,6 +34,17 @@ namespace IHMC_MISC
     {
         public:
             static NOMADSUtil::BMPImage * fragmentBMP (NOMADSUtil::BMPImage *pSourceImage, uint8 ui8DesiredChunkId, uint8 ui8TotalNoOfChunks);
+
+            // Creates all the ui8TotalNoOfChunks chunks of the image in a single, row-major,
+            // pass over the source image.  The chunk with id i is stored in ppChunks[i-1],
+            // therefore ppChunks must have room for ui8TotalNoOfChunks elements.
+            // The chunks are the same returned by fragmentBMP(pSourceImage, i, ui8TotalNoOfChunks),
+            // except for the pixels that map past the right or top edge of the source image,
+            // that are left undefined by fragmentBMP() and are set to the nearest source pixel here.
+            // Returns 0 if successful or a negative number in case of error, in which case
+            // no chunk is returned.
+            static int fragmentBMP (const NOMADSUtil::BMPImage *pSourceImage, uint8 ui8TotalNoOfChunks,
+                                    NOMADSUtil::BMPImage **ppChunks);
             static NOMADSUtil::BMPImage * extractFromBMP (NOMADSUtil::BMPImage *pSourceImage, uint32 ui32StartX, uint32 ui32EndX, uint32 ui32StartY, uint32 ui32EndY);
     };
 
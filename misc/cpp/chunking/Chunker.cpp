@@ -34,14 +34,21 @@
 #include "FFMPEGReader.h"
 
 #include "BufferReader.h"
+#include "ConditionVariable.h"
 #include "FileUtils.h"
 #include "Logger.h"
+#include "Mutex.h"
+#include "ThreadPool.h"
 #include "Writer.h"
 
 #include <stdlib.h>
 #include <limits.h>
 #include "MimeUtils.h"
 
+#if defined (UNIX)
+    #include <unistd.h>
+#endif
+
 #define encodingErrMsg Logger::L_MildError, "failed to encode BMP chunk into %s.\n"
 #define decodingErrMsg Logger::L_MildError, "failed to decode %s chunk into BMP.\n"
 
@@ -81,6 +88,141 @@ namespace IHMC_MISC
         return 0;
     }
 
+    // Encodes one chunk of an image
+    class ChunkEncoder : public Runnable
+    {
+        public:
+            ChunkEncoder (void);
+            int run (void);
+
+            BMPImage *pBMPChunk;
+            Chunker::Type outputChunkType;
+            uint8 ui8ChunkCompressionQuality;
+            BufferReader *pReader;
+    };
+
+    // Waits for the encoders that were enqueued in the pool
+    class ChunkEncoderMonitor : public ThreadPoolMonitor
+    {
+        public:
+            explicit ChunkEncoderMonitor (unsigned int uiEnqueued);
+            void runFinished (Runnable *pRunnable, int iRunRC);
+            void waitForAll (void);
+
+        private:
+            unsigned int _uiRunning;
+            Mutex _m;
+            ConditionVariable _cv;
+    };
+
+    // Pool of threads that encode the chunks, shared by all the callers of
+    // Chunker.  The workers live as long as the process.
+    class ChunkEncodingPool
+    {
+        public:
+            static ChunkEncodingPool * getInstance (void);
+            void enqueue (ChunkEncoder *pEncoder, ChunkEncoderMonitor *pMonitor);
+
+        private:
+            explicit ChunkEncodingPool (int iNumWorkers);
+
+            ThreadPool _pool;
+    };
+
+    ChunkEncoder::ChunkEncoder (void)
+        : pBMPChunk (NULL),
+          outputChunkType (Chunker::UNSUPPORTED),
+          ui8ChunkCompressionQuality (0),
+          pReader (NULL)
+    {
+    }
+
+    int ChunkEncoder::run (void)
+    {
+        pReader = ImageCodec::encode (pBMPChunk, outputChunkType, ui8ChunkCompressionQuality);
+        return (pReader == NULL ? -1 : 0);
+    }
+
+    ChunkEncoderMonitor::ChunkEncoderMonitor (unsigned int uiEnqueued)
+        : _uiRunning (uiEnqueued),
+          _cv (&_m)
+    {
+    }
+
+    void ChunkEncoderMonitor::runFinished (Runnable *pRunnable, int iRunRC)
+    {
+        _m.lock();
+        _uiRunning--;
+        if (_uiRunning == 0) {
+            _cv.notifyAll();
+        }
+        _m.unlock();
+    }
+
+    void ChunkEncoderMonitor::waitForAll (void)
+    {
+        _m.lock();
+        while (_uiRunning > 0) {
+            _cv.wait();
+        }
+        _m.unlock();
+    }
+
+    ChunkEncodingPool::ChunkEncodingPool (int iNumWorkers)
+        : _pool (iNumWorkers)
+    {
+    }
+
+    ChunkEncodingPool * ChunkEncodingPool::getInstance (void)
+    {
+        // Never deleted, so that the workers are not terminated while
+        // other static objects are being destroyed
+        static ChunkEncodingPool *pInstance = NULL;
+        static Mutex m;
+        m.lock();
+        if (pInstance == NULL) {
+            int iNumWorkers = 4;
+            #if defined (UNIX)
+                const long lCPUs = sysconf (_SC_NPROCESSORS_ONLN);
+                if (lCPUs > 0) {
+                    iNumWorkers = (int) lCPUs;
+                }
+            #endif
+            pInstance = new ChunkEncodingPool (iNumWorkers);
+        }
+        m.unlock();
+        return pInstance;
+    }
+
+    void ChunkEncodingPool::enqueue (ChunkEncoder *pEncoder, ChunkEncoderMonitor *pMonitor)
+    {
+        _pool.enqueue (pEncoder, false, pMonitor);
+    }
+
+    // Encodes the chunks in parallel; the calling thread encodes one of them
+    void encodeChunks (ChunkEncoder *pEncoders, uint8 ui8NoOfChunks)
+    {
+        if (ui8NoOfChunks == 0) {
+            return;
+        }
+        if (pEncoders[0].outputChunkType == Chunker::JPEG2000) {
+            // Jasper is not thread-safe
+            for (uint8 i = 0; i < ui8NoOfChunks; i++) {
+                pEncoders[i].run();
+            }
+            return;
+        }
+        ChunkEncoderMonitor monitor (ui8NoOfChunks - 1);
+        if (ui8NoOfChunks > 1) {
+            ChunkEncodingPool *pPool = ChunkEncodingPool::getInstance();
+            for (uint8 i = 1; i < ui8NoOfChunks; i++) {
+                pPool->enqueue (&pEncoders[i], &monitor);
+            }
+        }
+        pEncoders[0].run();
+        monitor.waitForAll();
+    }
+
     int roundUpToMultiple (int numToRound, int multiple=4)
     {
         if (multiple == 0)
@@ -163,29 +305,48 @@ Fragments * Chunker::fragmentBuffer (const void *pBuf, uint32 ui32Len, Type inpu
         if (pBMPImage == NULL) {
             return NULL;
         }
-        pFragments = new PtrLList<Fragment>();
-        for (uint8 ui8CurrentChunk = 1; ui8CurrentChunk <= ui8NoOfChunks; ui8CurrentChunk++) {
-            BMPImage *pBMPChunk = BMPChunker::fragmentBMP (pBMPImage, ui8CurrentChunk, ui8NoOfChunks);
-            if (pBMPChunk == NULL) {
-                checkAndLogMsg ("Chunker::fragmentBuffer", Logger::L_MildError,
-                                "failed to fragment BMP to create chunk %d of %d\n",
-                                static_cast<int>(ui8CurrentChunk), static_cast<int>(ui8NoOfChunks));
-                delete pFragments;
-                delete pBMPImage;
-                return NULL;
-            }
+        // All the chunks are created in a single pass over the image, and then
+        // they are encoded in parallel
+        BMPImage **ppBMPChunks = new BMPImage*[ui8NoOfChunks];
+        int rc = BMPChunker::fragmentBMP (pBMPImage, ui8NoOfChunks, ppBMPChunks);
+        delete pBMPImage;
+        if (rc < 0) {
+            checkAndLogMsg ("Chunker::fragmentBuffer", Logger::L_MildError,
+                            "failed to fragment BMP into %d chunks; rc = %d\n",
+                            static_cast<int>(ui8NoOfChunks), rc);
+            delete[] ppBMPChunks;
+            return NULL;
+        }
 
-            BufferReader *pReader = ImageCodec::encode (pBMPChunk, outputChunkType, ui8ChunkCompressionQuality);
-            if (pReader == NULL) {
-                delete pFragments;
-                delete pBMPImage;
-                delete pBMPChunk;
-                return NULL;
+        ChunkEncoder *pEncoders = new ChunkEncoder[ui8NoOfChunks];
+        for (uint8 i = 0; i < ui8NoOfChunks; i++) {
+            pEncoders[i].pBMPChunk = ppBMPChunks[i];
+            pEncoders[i].outputChunkType = outputChunkType;
+            pEncoders[i].ui8ChunkCompressionQuality = ui8ChunkCompressionQuality;
+        }
+        encodeChunks (pEncoders, ui8NoOfChunks);
+
+        bool bEncoded = true;
+        for (uint8 i = 0; i < ui8NoOfChunks; i++) {
+            delete ppBMPChunks[i];
+            if (pEncoders[i].pReader == NULL) {
+                bEncoded = false;
             }
-            delete pBMPChunk;
-            pFragments->append (toFragment (pReader, inputObjectType, ui8CurrentChunk, ui8NoOfChunks, outputChunkType));
         }
-        delete pBMPImage;
+        delete[] ppBMPChunks;
+
+        pFragments = (bEncoded ? new PtrLList<Fragment>() : NULL);
+        for (uint8 i = 0; i < ui8NoOfChunks; i++) {
+            if (pFragments != NULL) {
+                const uint8 ui8CurrentChunk = i + 1;
+                pFragments->append (toFragment (pEncoders[i].pReader, inputObjectType, ui8CurrentChunk,
+                                                ui8NoOfChunks, outputChunkType));
+            }
+            else {
+                delete pEncoders[i].pReader;
+            }
+        }
+        delete[] pEncoders;
     }
     else if (VideoCodec::supports (inputObjectType)) {
         if (V_MPEG) {
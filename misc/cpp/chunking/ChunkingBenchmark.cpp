@@ -0,0 +1,219 @@
+/*
+ * ChunkingBenchmark.cpp
+ *
+ * This file is part of the IHMC Misc Library
+ * Copyright (c) 2010-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Compares the serial chunking of images (one pass over the source image
+ * for each chunk, and chunks encoded one after the other) with the single
+ * pass decimation and the parallel encoding of Chunker::fragmentBuffer().
+ * For each image size and number of chunks it prints the time spent
+ * fragmenting the BMP, and the time spent fragmenting and encoding the
+ * chunks into JPEG.  It also checks that both paths produce the same chunks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BMPHandler.h"
+#include "Chunker.h"
+#include "ImageCodec.h"
+
+#include "BMPImage.h"
+#include "BufferReader.h"
+#include "Logger.h"
+#include "NLFLib.h"
+
+using namespace IHMC_MISC;
+using namespace NOMADSUtil;
+
+namespace IHMC_MISC_TEST
+{
+    static const uint8 JPEG_QUALITY = 90;
+
+    BMPImage * createImage (uint32 ui32Width, uint32 ui32Height)
+    {
+        BMPImage *pImage = new BMPImage (true);
+        if (pImage->initNewImage (ui32Width, ui32Height, 24) != 0) {
+            delete pImage;
+            return NULL;
+        }
+        srand (ui32Width ^ ui32Height);
+        for (uint32 y = 0; y < ui32Height; y++) {
+            uint8 *pLine = pImage->getLinePtr (y);
+            for (uint32 x = 0; x < ui32Width * 3; x++) {
+                // Gradient with some noise, so that the encoders have some work to do
+                pLine[x] = (uint8) ((x + y + (rand() % 16)) & 0xFF);
+            }
+        }
+        return pImage;
+    }
+
+    bool sameChunks (BMPImage *pSourceImage, BMPImage **ppChunks, uint8 ui8NoOfChunks)
+    {
+        for (uint8 i = 0; i < ui8NoOfChunks; i++) {
+            BMPImage *pChunk = BMPChunker::fragmentBMP (pSourceImage, i + 1, ui8NoOfChunks);
+            if (pChunk == NULL) {
+                return false;
+            }
+            bool bSame = (pChunk->getWidth() == ppChunks[i]->getWidth()) &&
+                         (pChunk->getHeight() == ppChunks[i]->getHeight());
+            for (uint32 y = 0; bSame && (y < pChunk->getHeight()); y++) {
+                bSame = (0 == memcmp (pChunk->getLinePtr (y), ppChunks[i]->getLinePtr (y), pChunk->getWidth() * 3));
+            }
+            delete pChunk;
+            if (!bSame) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int64 fragmentSerially (BMPImage *pSourceImage, uint8 ui8NoOfChunks, bool bEncode)
+    {
+        const int64 i64Start = getTimeInMilliseconds();
+        for (uint8 ui8ChunkId = 1; ui8ChunkId <= ui8NoOfChunks; ui8ChunkId++) {
+            BMPImage *pChunk = BMPChunker::fragmentBMP (pSourceImage, ui8ChunkId, ui8NoOfChunks);
+            if (pChunk == NULL) {
+                return -1;
+            }
+            if (bEncode) {
+                delete ImageCodec::encode (pChunk, Chunker::JPEG, JPEG_QUALITY);
+            }
+            delete pChunk;
+        }
+        return getTimeInMilliseconds() - i64Start;
+    }
+
+    int64 fragmentInSinglePass (BMPImage *pSourceImage, uint8 ui8NoOfChunks, bool bCheck)
+    {
+        BMPImage **ppChunks = new BMPImage*[ui8NoOfChunks];
+        const int64 i64Start = getTimeInMilliseconds();
+        if (BMPChunker::fragmentBMP (pSourceImage, ui8NoOfChunks, ppChunks) < 0) {
+            delete[] ppChunks;
+            return -1;
+        }
+        int64 i64Elapsed = getTimeInMilliseconds() - i64Start;
+        if (bCheck && !sameChunks (pSourceImage, ppChunks, ui8NoOfChunks)) {
+            fprintf (stderr, "the chunks created in a single pass differ from the ones created serially\n");
+            i64Elapsed = -1;
+        }
+        for (uint8 i = 0; i < ui8NoOfChunks; i++) {
+            delete ppChunks[i];
+        }
+        delete[] ppChunks;
+        return i64Elapsed;
+    }
+
+    int64 fragmentBuffer (const BufferReader *pBMPBuf, uint8 ui8NoOfChunks)
+    {
+        const int64 i64Start = getTimeInMilliseconds();
+        Chunker::Fragments *pFragments = Chunker::fragmentBuffer (pBMPBuf->getBuffer(), pBMPBuf->getBufferLength(), Chunker::BMP,
+                                                                  ui8NoOfChunks, Chunker::JPEG, JPEG_QUALITY);
+        const int64 i64Elapsed = getTimeInMilliseconds() - i64Start;
+        if (pFragments == NULL) {
+            return -1;
+        }
+        Chunker::Fragment *pFragment;
+        while ((pFragment = pFragments->removeFirst()) != NULL) {
+            delete pFragment->pReader;
+            delete pFragment;
+        }
+        delete pFragments;
+        return i64Elapsed;
+    }
+
+    int64 decodeAndFragmentSerially (const BufferReader *pBMPBuf, uint8 ui8NoOfChunks)
+    {
+        // Same steps as fragmentBuffer() used to perform
+        const int64 i64Start = getTimeInMilliseconds();
+        BMPImage *pImage = ImageCodec::decode (pBMPBuf->getBuffer(), pBMPBuf->getBufferLength(), Chunker::BMP);
+        if (pImage == NULL) {
+            return -1;
+        }
+        const int64 i64Fragmented = fragmentSerially (pImage, ui8NoOfChunks, true);
+        delete pImage;
+        if (i64Fragmented < 0) {
+            return -1;
+        }
+        return getTimeInMilliseconds() - i64Start;
+    }
+}
+
+using namespace IHMC_MISC_TEST;
+
+int main (int argc, char *argv[])
+{
+    pLogger = new Logger();
+    pLogger->enableScreenOutput();
+    pLogger->setDebugLevel (Logger::L_MildError);
+
+    unsigned int uiIterations = 3;
+    if (argc > 1) {
+        uiIterations = atoui32 (argv[1]);
+    }
+    if (uiIterations == 0) {
+        fprintf (stderr, "usage: %s [<iterations>]\n", argv[0]);
+        return -1;
+    }
+
+    // Widths and heights are multiples of 16, so that the chunks created by
+    // the two paths can be compared pixel by pixel
+    static const uint32 SIZES[][2] = { { 640, 480 }, { 1280, 960 }, { 2560, 1920 }, { 5120, 3840 } };
+    static const uint8 CHUNKS[] = { 2, 4, 8, 16 };
+
+    printf ("%-11s %6s | %12s %12s %7s | %12s %12s %7s\n", "image", "chunks",
+            "bmp serial", "bmp 1-pass", "speedup", "jpeg serial", "jpeg new", "speedup");
+    for (unsigned int i = 0; i < sizeof (SIZES) / sizeof (SIZES[0]); i++) {
+        BMPImage *pImage = createImage (SIZES[i][0], SIZES[i][1]);
+        if (pImage == NULL) {
+            fprintf (stderr, "failed to create a %ux%u image\n", SIZES[i][0], SIZES[i][1]);
+            return -2;
+        }
+        BufferReader *pBMPBuf = ImageCodec::encode (pImage, Chunker::BMP, 100);
+        if (pBMPBuf == NULL) {
+            fprintf (stderr, "failed to encode a %ux%u image into BMP\n", SIZES[i][0], SIZES[i][1]);
+            return -3;
+        }
+        for (unsigned int j = 0; j < sizeof (CHUNKS); j++) {
+            int64 i64Serial = 0, i64SinglePass = 0, i64EncodedSerial = 0, i64EncodedNew = 0;
+            for (unsigned int k = 0; k < uiIterations; k++) {
+                const int64 i64SerialRun = fragmentSerially (pImage, CHUNKS[j], false);
+                const int64 i64SinglePassRun = fragmentInSinglePass (pImage, CHUNKS[j], k == 0);
+                const int64 i64EncodedSerialRun = decodeAndFragmentSerially (pBMPBuf, CHUNKS[j]);
+                const int64 i64EncodedNewRun = fragmentBuffer (pBMPBuf, CHUNKS[j]);
+                if ((i64SerialRun < 0) || (i64SinglePassRun < 0) || (i64EncodedSerialRun < 0) || (i64EncodedNewRun < 0)) {
+                    fprintf (stderr, "failed to fragment a %ux%u image into %d chunks\n",
+                             SIZES[i][0], SIZES[i][1], (int) CHUNKS[j]);
+                    return -4;
+                }
+                i64Serial += i64SerialRun;
+                i64SinglePass += i64SinglePassRun;
+                i64EncodedSerial += i64EncodedSerialRun;
+                i64EncodedNew += i64EncodedNewRun;
+            }
+            printf ("%5ux%-5u %6d | %10.1fms %10.1fms %6.2fx | %10.1fms %10.1fms %6.2fx\n",
+                    SIZES[i][0], SIZES[i][1], (int) CHUNKS[j],
+                    (double) i64Serial / uiIterations, (double) i64SinglePass / uiIterations,
+                    (double) i64Serial / (i64SinglePass > 0 ? i64SinglePass : 1),
+                    (double) i64EncodedSerial / uiIterations, (double) i64EncodedNew / uiIterations,
+                    (double) i64EncodedSerial / (i64EncodedNew > 0 ? i64EncodedNew : 1));
+        }
+        delete pBMPBuf;
+        delete pImage;
+    }
+    return 0;
+}
@@ -229,6 +229,16 @@ void * BMPImage::relinquishImage (void)
     return _img.relinquishImage();
 }
 
+uint8 * BMPImage::getLinePtr (unsigned int uiLine)
+{
+    return _img.getLinePtr (uiLine);
+}
+
+const uint8 * BMPImage::getLinePtr (unsigned int uiLine) const
+{
+    return _img.getLinePtr (uiLine);
+}
+
 int BMPImage::setPixel (uint32 ui32X, uint32 ui32Y, uint8 ui8Red, uint8 ui8Green, uint8 ui8Blue)
 {
     return _img.setPixel (ui32X, ui32Y, ui8Red, ui8Green, ui8Blue);
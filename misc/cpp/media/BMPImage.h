@@ -78,6 +78,12 @@ namespace NOMADSUtil
             // NOTE: The caller is then responsible for deallocating the memory
             void * relinquishImage (void);
 
+            // Returns a pointer to the first byte of the specified line of the image
+            // array, or NULL if the line does not exist.  Lines are getLineSize() bytes
+            // apart, and they follow the same order as the y coordinate of getPixel()
+            uint8 * getLinePtr (unsigned int uiLine);
+            const uint8 * getLinePtr (unsigned int uiLine) const;
+
             // Set the pixel value based on the specified red, green, and blue components
             // NOTE: Following the BitMap specification, this method assumes that the 0 coordinate
             //       is at the bottom left of the image, not the top left
@@ -0,0 +1,132 @@
+#ifndef NETSENSOR_FrameBuffer__INCLUDED
+#define NETSENSOR_FrameBuffer__INCLUDED
+/*
+* FrameBuffer.h
+* This file is part of the IHMC NetSensor Library/Component
+* Copyright (c) 2010-2017 IHMC.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 3 (GPLv3) as published by the Free Software Foundation.
+*
+* U.S. Government agencies and organizations may redistribute
+* and/or modify this program under terms equivalent to
+* "Government Purpose Rights" as defined by DFARS
+* 252.227-7014(a)(12) (February 2014).
+*
+* Alternative licenses that allow for use within commercial products may be
+* available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+*
+* Reference-counted memory that holds one or more captured frames.
+* NetSensorPackets point into a FrameBuffer instead of carrying a copy of
+* the frame, so that they can be enqueued and copied without copying the
+* frame itself.  The memory is recycled when the last reference is released:
+* heap buffers are deallocated, while the blocks of a capture ring are
+* handed back to the kernel.
+*/
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FTypes.h"
+
+namespace IHMC_NETSENSOR
+{
+    class FrameBuffer
+    {
+    public:
+        void retain(void);
+
+        // The buffer, and every frame in it, must not be accessed after
+        // the last reference has been released
+        void release(void);
+
+    protected:
+        FrameBuffer(void);
+        virtual ~FrameBuffer(void);
+
+        // Resets the reference count to one, before the buffer is reused
+        void resetReferences(void);
+
+        // Invoked when the last reference is released
+        virtual void recycle(void) = 0;
+
+    private:
+        // FrameBuffers can not be copied
+        FrameBuffer(const FrameBuffer &);
+        FrameBuffer & operator = (const FrameBuffer &);
+
+        std::atomic<uint32> _ui32RefCount;
+    };
+
+
+    // FrameBuffer that holds a copy of a single frame
+    class HeapFrameBuffer : public FrameBuffer
+    {
+    public:
+        // Returns nullptr if the memory could not be allocated
+        static HeapFrameBuffer * copyOf(const uint8 *pui8Frame, uint32 ui32Len);
+
+        uint8 * getData(void);
+
+    protected:
+        void recycle(void);
+
+    private:
+        explicit HeapFrameBuffer(uint8 *pui8Data);
+        ~HeapFrameBuffer(void);
+
+        uint8 *_pui8Data;
+    };
+
+
+    inline FrameBuffer::FrameBuffer(void) : _ui32RefCount(1U) { }
+
+    inline FrameBuffer::~FrameBuffer(void) { }
+
+    inline void FrameBuffer::retain(void)
+    {
+        _ui32RefCount.fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    inline void FrameBuffer::release(void)
+    {
+        if (_ui32RefCount.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+            recycle();
+        }
+    }
+
+    inline void FrameBuffer::resetReferences(void)
+    {
+        _ui32RefCount.store(1U, std::memory_order_relaxed);
+    }
+
+    inline HeapFrameBuffer::HeapFrameBuffer(uint8 *pui8Data) : _pui8Data(pui8Data) { }
+
+    inline HeapFrameBuffer::~HeapFrameBuffer(void)
+    {
+        free(_pui8Data);
+        _pui8Data = nullptr;
+    }
+
+    inline HeapFrameBuffer * HeapFrameBuffer::copyOf(const uint8 *pui8Frame, uint32 ui32Len)
+    {
+        auto pui8Data = static_cast<uint8 *>(malloc(ui32Len > 0 ? ui32Len : 1U));
+        if (pui8Data == nullptr) {
+            return nullptr;
+        }
+        memcpy(pui8Data, pui8Frame, ui32Len);
+        return new HeapFrameBuffer(pui8Data);
+    }
+
+    inline uint8 * HeapFrameBuffer::getData(void)
+    {
+        return _pui8Data;
+    }
+
+    inline void HeapFrameBuffer::recycle(void)
+    {
+        delete this;
+    }
+}
+#endif
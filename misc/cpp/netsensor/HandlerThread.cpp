@@ -382,7 +382,6 @@ void HandlerThread::populateTrafficTables (const NetSensorPacket & p)
 
     auto const pEthHeader = (EtherFrameHeader*)p.ui8Buf;
     pEthHeader->ntoh();
-    NOMADSUtil::String tmpProtocol;
 
     if (pEthHeader->ui16EtherType != ET_IP) {
         checkAndLogMsg (pszMethodName, Logger::L_HighDetailDebug, "EtherType not supported: %d\n", pEthHeader->ui16EtherType);
@@ -405,43 +404,31 @@ void HandlerThread::populateTrafficTables (const NetSensorPacket & p)
         pUDPHeader->hton();
         uint16SrcPort   = pUDPHeader->ui16SPort;
         uint16DestPort  = pUDPHeader->ui16DPort;
-        tmpProtocol = "UDP";
         break;
     case IP_PROTO_TCP:
         pTCPHeader = (TCPHeader*)(((uint8*)pIPHeader) + ui16IPHeaderLen);
         pTCPHeader->hton();
         uint16SrcPort   = pTCPHeader->ui16SPort;
         uint16DestPort  = pTCPHeader->ui16DPort;
-        tmpProtocol     = "TCP";
         break;
     case IP_PROTO_ICMP:
         pICMPHeader = (ICMPHeader*)(((uint8*)pIPHeader) + ui16IPHeaderLen);
         pICMPHeader->hton();
         uint16SrcPort = 0;
         uint16DestPort = 0;
-        tmpProtocol = "ICMP";
         break;
     case IP_PROTO_IGMP:
         uint16SrcPort   = 0;
         uint16DestPort  = 0;
-        tmpProtocol     = "IGMP";
         break;
     default:
         checkAndLogMsg (pszMethodName, Logger::L_MediumDetailDebug, "IP protocol %d unsupported, ignoring packet\n", uint8Protocol);
         return;
     }
 
-    char tmpSP[8];
-    convertIntToString (uint16SrcPort, tmpSP);
-    char tmpDP[8];
-    convertIntToString (uint16DestPort, tmpDP);
-
     MicroflowId microflowId;
-    microflowId.sSA             = InetAddr (ui32SrcAddr).getIPAsString();
-    microflowId.sDA             = InetAddr (ui32DestAddr).getIPAsString();
-    microflowId.sSP             = tmpSP;
-    microflowId.sDP             = tmpDP;
-    microflowId.sProtocol       = tmpProtocol;
+    microflowId.key             = MicroflowKey (ui32SrcAddr, ui32DestAddr, uint16SrcPort,
+                                                uint16DestPort, uint8Protocol);
     microflowId.ui32Size        = ui16PacketLen;
     microflowId.i64CurrTime     = i64CurrTime;
     microflowId.classification  = getClassification (
@@ -47,8 +47,10 @@
 #include "topology.pb.h"
 
 #include "InterfaceMonitor.h"
+#include "NetSensorConstants.h"
 #include "NetSensorUtilities.h"
 #include "PCapInterface.h"
+#include "TPacketV3Interface.h"
 #include "NetSensorPacket.h"
 #include "NetSensorPacketQueue.h"
 
@@ -58,6 +60,36 @@ using namespace netsensor;
 
 namespace IHMC_NETSENSOR
 {
+InterfaceMonitor::~InterfaceMonitor(void)
+{
+    for (auto pCaptureThread : _captureThreads) {
+        pCaptureThread->requestTerminationAndWait();
+        delete pCaptureThread;
+    }
+    _captureThreads.clear();
+    delete _pNetInterface;
+    _pNetInterface = nullptr;
+    _pTPacketV3Interface = nullptr;
+}
+
+void InterfaceMonitor::requestTermination(void)
+{
+    for (auto pCaptureThread : _captureThreads) {
+        pCaptureThread->requestTermination();
+    }
+    _pNetInterface->requestTermination();
+    ManageableThread::requestTermination();
+}
+
+void InterfaceMonitor::requestTerminationAndWait(void)
+{
+    for (auto pCaptureThread : _captureThreads) {
+        pCaptureThread->requestTerminationAndWait();
+    }
+    _pNetInterface->requestTermination();
+    ManageableThread::requestTerminationAndWait();
+}
+
 int InterfaceMonitor::initLive (
     const NOMADSUtil::String & sInterfaceName,
     bool isInternal, 
@@ -69,8 +101,15 @@ int InterfaceMonitor::initLive (
     _sInterfaceName = sInterfaceName;
     checkAndLogMsg (pszMethodName, Logger::L_Info, "Creating new LIVE IMT for: %s\n", sInterfaceName.c_str());
 
+    if (_bUseTPacketV3 && (initTPacketV3() < 0)) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "TPACKET_V3 capture not available for <%s>, "
+            "falling back on pcap\n", sInterfaceName.c_str());
+    }
+
     int msValidity = 1;
-    _pNetInterface = PCapInterface::getPCapInterface (sInterfaceName, msValidity);
+    if (_pNetInterface == nullptr) {
+        _pNetInterface = PCapInterface::getPCapInterface (sInterfaceName, msValidity);
+    }
     if (_pNetInterface == nullptr) {
         checkAndLogMsg (pszMethodName, Logger::L_SevereError, "_pNetInterface for <%s> NULL\n",  
             sInterfaceName.c_str());
@@ -216,6 +255,37 @@ int InterfaceMonitor::initLive (
     return 0;
 }
 
+int InterfaceMonitor::initTPacketV3 (void)
+{
+#if defined (LINUX)
+    auto pszMethodName = "InterfaceMonitor::initTPacketV3";
+    // The kernel spreads the packets among the rings of the group by flow hash
+    const uint16 ui16FanoutGroupId = (_ui8CaptureThreads > 1) ? TPacketV3Interface::newFanoutGroupId() : 0;
+    std::vector<TPacketV3Interface *> interfaces;
+    for (uint8 i = 0; i < _ui8CaptureThreads; i++) {
+        auto pInterface = TPacketV3Interface::getTPacketV3Interface (_sInterfaceName, ui16FanoutGroupId);
+        if (pInterface == nullptr) {
+            for (auto pOpenedInterface : interfaces) {
+                delete pOpenedInterface;
+            }
+            return -1;
+        }
+        interfaces.push_back (pInterface);
+    }
+
+    _pTPacketV3Interface = interfaces[0];
+    _pNetInterface = _pTPacketV3Interface;
+    for (size_t i = 1; i < interfaces.size(); i++) {
+        _captureThreads.push_back (new CaptureThread (this, interfaces[i]));
+    }
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "capturing <%s> through TPACKET_V3 with %d thread(s)\n",
+        _sInterfaceName.c_str(), (int) _ui8CaptureThreads);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
 int InterfaceMonitor::initReplay (
     const NOMADSUtil::String & sInterfaceName,
     const NOMADSUtil::String & sReplayFile,
@@ -268,29 +338,66 @@ void InterfaceMonitor::fillNetworkInfo(const char* pcInterfaceName,
                                 getIPAsString());
 }
 
+void InterfaceMonitor::getCaptureStatistics(CaptureStatistics & stats)
+{
+    stats.ui64Captured      = _ui64Captured.load();
+    stats.ui64QueueDrops    = _ui64QueueDrops.load();
+    stats.ui64KernelPackets = 0;
+    stats.ui64KernelDrops   = 0;
+    stats.ui8CaptureThreads = static_cast<uint8>(_captureThreads.size() + 1);
+    stats.bTPacketV3        = _pTPacketV3Interface != nullptr;
+#if defined (LINUX)
+    if (_pTPacketV3Interface != nullptr) {
+        uint64 ui64Packets, ui64Drops;
+        _pTPacketV3Interface->getStatistics(ui64Packets, ui64Drops);
+        stats.ui64KernelPackets += ui64Packets;
+        stats.ui64KernelDrops += ui64Drops;
+        for (auto pCaptureThread : _captureThreads) {
+            pCaptureThread->getInterface()->getStatistics(ui64Packets, ui64Drops);
+            stats.ui64KernelPackets += ui64Packets;
+            stats.ui64KernelDrops += ui64Drops;
+        }
+    }
+#endif
+}
+
 void InterfaceMonitor::run(void)
 {
     started();
     static const char* meName = "InterfaceMonitor::run";
     checkAndLogMsg(meName, Logger::L_Info, "IMT for Interface %s started\n",
 		_sInterfaceName.c_str());
-    int received;
-    NetSensorPacket packet;
-    while (!terminationRequested() && !_pNetInterface->terminationRequested()) {
-        if (isRunning()) {
-            received = _pNetInterface->readPacket(packet.ui8Buf, sizeof(packet.ui8Buf),
-                                                  &packet.int64RcvTimeStamp);
-            if (received > 0) {
-                /*
-                if (pEthHeader->ui16EtherType == 0xDD86)
-                {
-                printf("IPv6!\n");
+    if (_pTPacketV3Interface != nullptr) {
+        for (auto pCaptureThread : _captureThreads) {
+            pCaptureThread->start();
+        }
+        captureFrames(_pTPacketV3Interface);
+    }
+    else {
+        int received;
+        uint8 ui8Buf[C_MAX_CAPTURED_FRAME_SIZE];
+        NetSensorPacket packet;
+        packet.sMonitoredInterface = _sInterfaceName;
+        while (!terminationRequested() && !_pNetInterface->terminationRequested()) {
+            if (isRunning()) {
+                received = _pNetInterface->readPacket(ui8Buf, sizeof(ui8Buf),
+                                                      &packet.int64RcvTimeStamp);
+                if (received > 0) {
+                    /*
+                    if (pEthHeader->ui16EtherType == 0xDD86)
+                    {
+                    printf("IPv6!\n");
+                    }
+                    */
+                    if (packet.copyFrame(ui8Buf, received) < 0) {
+                        checkAndLogMsg(meName, Logger::L_SevereError, "could not allocate a packet of %d bytes\n",
+                                       received);
+                        continue;
+                    }
+                    packet.int64RcvTimeStamp    = getTimeInMilliseconds();
+                    _ui64Captured++;
+                    enqueue(packet);
                 }
-                */
-                packet.received = received;
-                packet.sMonitoredInterface  = _sInterfaceName;
-                packet.int64RcvTimeStamp    = getTimeInMilliseconds();
-                enqueue(packet);
             }
         }
     }
@@ -298,6 +405,34 @@ void InterfaceMonitor::run(void)
     setTerminatingResultCode(0);
 }
 
+void InterfaceMonitor::captureFrames(TPacketV3Interface *pInterface)
+{
+#if defined (LINUX)
+    static const char* meName = "InterfaceMonitor::captureFrames";
+    NetSensorPacket packet;
+    packet.sMonitoredInterface = _sInterfaceName;
+    uint8 *pui8Frame;
+    FrameBuffer *pFrameBuffer;
+    int64 i64RcvTimeStampUs;
+    while (!pInterface->terminationRequested()) {
+        int received = pInterface->nextFrame(&pui8Frame, &i64RcvTimeStampUs, &pFrameBuffer);
+        if (received > 0) {
+            packet.setFrame(pui8Frame, received, pFrameBuffer);
+            packet.int64RcvTimeStamp = i64RcvTimeStampUs / 1000;
+            _ui64Captured++;
+            enqueueOrDrop(packet);
+            // Do not hold the block while waiting for the next frame
+            packet.releaseFrame();
+        }
+        else if (received < 0) {
+            checkAndLogMsg(meName, Logger::L_SevereError, "capture of interface %s failed; rc = %d\n",
+                           _sInterfaceName.c_str(), received);
+            break;
+        }
+    }
+#endif
+}
+
 void InterfaceMonitor::enqueue(const NetSensorPacket & p)
 {
     static const char* meName = "InterfaceMonitor::enqueue";
@@ -315,4 +450,53 @@ void InterfaceMonitor::enqueue(const NetSensorPacket & p)
     }
 }
 
+void InterfaceMonitor::enqueueOrDrop(const NetSensorPacket & p)
+{
+    // Waiting for room in the queue would keep the blocks of the ring from
+    // going back to the kernel, which would then drop the packets anyway
+    if (!pQueue->enqueue(p)) {
+        _ui64QueueDrops++;
+    }
+    if (_bRttDetection && !pRttQueue->enqueue(p)) {
+        _ui64QueueDrops++;
+    }
+}
+
+#if defined (LINUX)
+InterfaceMonitor::CaptureThread::CaptureThread(InterfaceMonitor *pMonitor, TPacketV3Interface *pInterface) :
+    _pMonitor(pMonitor), _pInterface(pInterface) { }
+
+InterfaceMonitor::CaptureThread::~CaptureThread(void)
+{
+    delete _pInterface;
+    _pInterface = nullptr;
+}
+
+TPacketV3Interface * InterfaceMonitor::CaptureThread::getInterface(void)
+{
+    return _pInterface;
+}
+
+void InterfaceMonitor::CaptureThread::run(void)
+{
+    started();
+    _pMonitor->captureFrames(_pInterface);
+    terminating();
+    setTerminatingResultCode(0);
+}
+
+void InterfaceMonitor::CaptureThread::requestTermination(void)
+{
+    _pInterface->requestTermination();
+    ManageableThread::requestTermination();
+}
+
+void InterfaceMonitor::CaptureThread::requestTerminationAndWait(void)
+{
+    _pInterface->requestTermination();
+    ManageableThread::requestTerminationAndWait();
+}
+#endif
+
+
 }
@@ -20,9 +20,15 @@
 *
 * Each InterfaceMonitor is linked to a specific network interface and it uses
 * pcap to retrieve packets from the network and then proceeds in enqueuing
-* the packets in the packet queue
+* the packets in the packet queue.
+* On Linux, live interfaces can be captured through TPACKET_V3 rings instead:
+* the packets are enqueued without being copied, and the interface can be
+* served by several capture threads that share a fanout group.
 *
 */
+#include <atomic>
+#include <vector>
+
 #include "Logger.h"
 #include "FTypes.h"
 #include "StrClass.h"
@@ -36,13 +42,28 @@ namespace IHMC_NETSENSOR
 {
     class NetSensorPacket;
     class NetSensorPacketQueue;
+    class TPacketV3Interface;
+
+    struct CaptureStatistics
+    {
+        uint64 ui64Captured;        // Packets read by the capture threads
+        uint64 ui64QueueDrops;      // Packets dropped because the packet queue was full
+        uint64 ui64KernelPackets;   // Packets received by the kernel (TPACKET_V3 only)
+        uint64 ui64KernelDrops;     // Packets dropped by the kernel because the ring was full (TPACKET_V3 only)
+        uint8  ui8CaptureThreads;
+        bool   bTPacketV3;
+    };
 
     class InterfaceMonitor : public NOMADSUtil::ManageableThread
     {
     public:
         InterfaceMonitor(void);
         ~InterfaceMonitor(void);
-        
+
+        // Must be called before initLive().  If the TPACKET_V3 ring can not
+        // be set up, initLive() falls back on pcap with a single thread.
+        void setCaptureOptions(bool bUseTPacketV3, uint8 ui8CaptureThreads);
+
         int initLive (
             const NOMADSUtil::String & sInterfaceName,
             bool isInternal = false, 
@@ -59,13 +80,37 @@ namespace IHMC_NETSENSOR
         // The client will be responsable for deleting the InterfaceInfo object returned
         InterfaceInfo * getInterfaceInfoCopy(void);
 
+        void getCaptureStatistics(CaptureStatistics & stats);
+
         void run(void);
 
         virtual void requestTermination         (void);
         virtual void requestTerminationAndWait  (void);
 
     private:
+        // Serves one of the rings of the interface, when it is captured by
+        // more than one thread
+        class CaptureThread : public NOMADSUtil::ManageableThread
+        {
+        public:
+            CaptureThread(InterfaceMonitor *pMonitor, TPacketV3Interface *pInterface);
+            ~CaptureThread(void);
+
+            TPacketV3Interface * getInterface(void);
+
+            void run(void);
+            void requestTermination(void);
+            void requestTerminationAndWait(void);
+
+        private:
+            InterfaceMonitor   *_pMonitor;
+            TPacketV3Interface *_pInterface;
+        };
+
+        int initTPacketV3(void);
+        void captureFrames(TPacketV3Interface *pInterface);
         void enqueue(const NetSensorPacket & packet);
+        void enqueueOrDrop(const NetSensorPacket & packet);
     //<--------------------------------------------------------------------------->
 
     public:
@@ -82,7 +127,13 @@ namespace IHMC_NETSENSOR
 
     private:
         NetworkInterface           *_pNetInterface;
+        TPacketV3Interface         *_pTPacketV3Interface;
+        std::vector<CaptureThread *> _captureThreads;
         NOMADSUtil::String          _sInterfaceName;
+        bool                        _bUseTPacketV3;
+        uint8                       _ui8CaptureThreads;
+        std::atomic<uint64>         _ui64Captured;
+        std::atomic<uint64>         _ui64QueueDrops;
     };
 
 
@@ -90,24 +141,13 @@ namespace IHMC_NETSENSOR
         _ui32IPAddr(0), _ui32Netmask(0), _ui32GwIPAddr(0), _bRttDetection(false),
         _emacInterfaceMAC{0}, pszExternalMACAddr(nullptr),
         pIPv4IPAddr(nullptr), pQueue(nullptr), pRttQueue(nullptr),
-        _pNetInterface(nullptr), _sInterfaceName("") { }
-
-    inline InterfaceMonitor::~InterfaceMonitor(void)
-    {
-        delete _pNetInterface;
-        _pNetInterface = nullptr;
-    }
-
-    inline void InterfaceMonitor::requestTermination(void)
-    {
-        _pNetInterface->requestTermination();
-        ManageableThread::requestTermination();
-    }
+        _pNetInterface(nullptr), _pTPacketV3Interface(nullptr), _sInterfaceName(""),
+        _bUseTPacketV3(false), _ui8CaptureThreads(1), _ui64Captured(0), _ui64QueueDrops(0) { }
 
-    inline void InterfaceMonitor::requestTerminationAndWait(void)
+    inline void InterfaceMonitor::setCaptureOptions(bool bUseTPacketV3, uint8 ui8CaptureThreads)
     {
-        _pNetInterface->requestTermination();
-        ManageableThread::requestTerminationAndWait();
+        _bUseTPacketV3 = bUseTPacketV3;
+        _ui8CaptureThreads = ui8CaptureThreads > 0 ? ui8CaptureThreads : 1;
     }
 
 }
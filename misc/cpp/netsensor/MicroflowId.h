@@ -17,22 +17,103 @@
 * Alternative licenses that allow for use within commercial products may be
 * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
 */
-#include"StrClass.h"
+#include"FTypes.h"
+#include"NetworkHeaders.h"
 #include"TrafficElement.h"
+#include<stddef.h>
 namespace IHMC_NETSENSOR
 {
+    /*
+    * Binary 5-tuple that identifies a microflow.  Addresses are stored as
+    * they appear in the IP header, ports in host byte order.
+    */
+    class MicroflowKey
+    {
+    public:
+        MicroflowKey(void);
+        MicroflowKey(uint32 ui32SrcAddr, uint32 ui32DstAddr, uint16 ui16SrcPort,
+                     uint16 ui16DstPort, uint8 ui8Protocol);
+
+        bool operator == (const MicroflowKey & rhs) const;
+        uint64 hash(void) const;
+
+        // Returns the name used in the traffic stats for the IP protocol
+        const char * getProtocolName(void) const;
+
+        uint32 ui32SrcAddr;
+        uint32 ui32DstAddr;
+        uint16 ui16SrcPort;
+        uint16 ui16DstPort;
+        uint8 ui8Protocol;
+    };
+
+    struct MicroflowKeyHash
+    {
+        size_t operator () (const MicroflowKey & key) const;
+    };
+
     class MicroflowId
     {
     public:
         MicroflowId(void);
-        NOMADSUtil::String sSA;
-        NOMADSUtil::String sDA;
-        NOMADSUtil::String sSP;
-        NOMADSUtil::String sDP;
-        NOMADSUtil::String sProtocol;
+        MicroflowKey key;
         TrafficElement::Classification classification;
         uint32 ui32Size;
         int64 i64CurrTime;
     };
-   inline MicroflowId::MicroflowId(void) {}
-}
\ No newline at end of file
+
+    inline MicroflowKey::MicroflowKey(void)
+        : ui32SrcAddr(0), ui32DstAddr(0), ui16SrcPort(0), ui16DstPort(0), ui8Protocol(0) {}
+
+    inline MicroflowKey::MicroflowKey(uint32 ui32SAddr, uint32 ui32DAddr, uint16 ui16SPort,
+                                      uint16 ui16DPort, uint8 ui8Proto)
+        : ui32SrcAddr(ui32SAddr), ui32DstAddr(ui32DAddr), ui16SrcPort(ui16SPort),
+          ui16DstPort(ui16DPort), ui8Protocol(ui8Proto) {}
+
+    inline bool MicroflowKey::operator == (const MicroflowKey & rhs) const
+    {
+        return (ui32SrcAddr == rhs.ui32SrcAddr) && (ui32DstAddr == rhs.ui32DstAddr) &&
+               (ui16SrcPort == rhs.ui16SrcPort) && (ui16DstPort == rhs.ui16DstPort) &&
+               (ui8Protocol == rhs.ui8Protocol);
+    }
+
+    inline uint64 MicroflowKey::hash(void) const
+    {
+        // The 5-tuple fits in two words, that are mixed with the
+        // finalizer of MurmurHash3
+        uint64 ui64H = ((static_cast<uint64>(ui32SrcAddr) << 32) | ui32DstAddr) ^
+                       (((static_cast<uint64>(ui16SrcPort) << 32) | (static_cast<uint64>(ui16DstPort) << 16) |
+                          ui8Protocol) * 0x9E3779B97F4A7C15ULL);
+        ui64H ^= ui64H >> 33;
+        ui64H *= 0xFF51AFD7ED558CCDULL;
+        ui64H ^= ui64H >> 33;
+        ui64H *= 0xC4CEB9FE1A85EC53ULL;
+        ui64H ^= ui64H >> 33;
+        return ui64H;
+    }
+
+    inline const char * MicroflowKey::getProtocolName(void) const
+    {
+        switch (ui8Protocol)
+        {
+        case NOMADSUtil::IP_PROTO_UDP:
+            return "UDP";
+        case NOMADSUtil::IP_PROTO_TCP:
+            return "TCP";
+        case NOMADSUtil::IP_PROTO_ICMP:
+            return "ICMP";
+        case NOMADSUtil::IP_PROTO_IGMP:
+            return "IGMP";
+        default:
+            return "";
+        }
+    }
+
+    inline size_t MicroflowKeyHash::operator () (const MicroflowKey & key) const
+    {
+        return static_cast<size_t>(key.hash());
+    }
+
+    inline MicroflowId::MicroflowId(void)
+        : classification(TrafficElement::OBS), ui32Size(0), i64CurrTime(0) {}
+}
@@ -16,201 +16,59 @@
 * Alternative licenses that allow for use within commercial products may be
 * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
 *
-* This Class impelemnts a five levels hash map that will contain
-* stats identified by source ip, dest ip, protocol, source port, dest port
+* This Class contains the stats of the microflows seen on an interface,
+* identified by source ip, dest ip, protocol, source port, dest port
 */
 
 #include "MicroflowNestedHashTable.h"
-#include <forward_list>
-#include <tuple>
-#include "PtrLList.h"
-#include <list>
+#include "InetAddr.h"
 
 using namespace netsensor;
 using namespace NOMADSUtil;
 namespace IHMC_NETSENSOR
 {
-MicroflowNestedHashTable::MicroflowNestedHashTable()
-	: _microflowTable (true, true, true, true)
+MicroflowNestedHashTable::MicroflowNestedHashTable (uint32 ui32msResolution)
+	: _ui32msResolution (ui32msResolution)
 {
-
 }
 
 MicroflowNestedHashTable::~MicroflowNestedHashTable (void)
 {
-
+	for (uint32 i = 0; i < C_STRIPES_NUMBER; i++) {
+		for (auto iter : _stripes[i].microflows) {
+			delete iter.second;
+		}
+		_stripes[i].microflows.clear();
+	}
 }
 
 uint32 MicroflowNestedHashTable::cleanTable2 (const uint32 ui32CleaningNumber) 
 {
-	std::forward_list <String> list;
-	bool bKeepCleaning = true;
 	uint32 cleaningCounter = 0;
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		int64 currentTime = getTimeInMilliseconds();
-		for (auto i = _microflowTable.getAllElements(); (!i.end() && bKeepCleaning); i.nextElement()) {
-			auto tEl = i.getValue();
+	int64 currentTime = getTimeInMilliseconds();
+	for (uint32 i = 0; (i < C_STRIPES_NUMBER) && (cleaningCounter < ui32CleaningNumber); i++) {
+		Stripe & stripe = _stripes[i];
+		if ((stripe.m.lock() != Mutex::RC_Ok)) {
+			continue;
+		}
+		for (auto iter = stripe.microflows.begin(); (iter != stripe.microflows.end()) && (cleaningCounter < ui32CleaningNumber);) {
+			auto tEl = iter->second;
 			tEl->tiaPackets.expireOldEntries();
 			tEl->tiaTraffic.expireOldEntries();
 			int64 expiredT = tEl->i64TimeOfLastChange + C_ENTRY_TIME_VALIDITY;
 			if (currentTime > expiredT || ((tEl->tiaTraffic.getAverage() == 0))) {
-				list.emplace_front (i.getKey());
+				delete tEl;
+				iter = stripe.microflows.erase (iter);
 				cleaningCounter++;
-				bKeepCleaning = cleaningCounter < ui32CleaningNumber;
 			}
-		}
-		for (auto iter = list.begin(); iter != list.end(); iter++) {
-			delete _microflowTable.remove (*iter);
-		}
-		_pTMutex.unlock();
-		return cleaningCounter;
-	}
-	return cleaningCounter;
-}
-
-/*
-uint32 MicroflowNestedHashTable::cleanTable (const uint32 ui32CleaningNumber)
-{
-	std::forward_list <std::tuple <String, String, String, String, String>> list;
-	bool bKeepCleaning = true;
-
-	uint32 cleaningCounter = 0;
-
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		int64 currentTime = getTimeInMilliseconds();
-
-		for (auto v = _microflowNestedHashTable.getAllElements(); (!v.end() && bKeepCleaning); v.nextElement()) {
-			auto l4 = v.getValue();
-
-			for (auto iv = l4->getAllElements(); (!iv.end() && bKeepCleaning); iv.nextElement()) {
-				auto l3 = iv.getValue();
-
-				for (auto iii = l3->getAllElements(); (!iii.end() && bKeepCleaning); iii.nextElement()) {
-					auto l2 = iii.getValue();
-
-					for (auto ii = l2->getAllElements(); (!ii.end() && bKeepCleaning); ii.nextElement()) {
-						auto l1 = ii.getValue();
-
-						for (auto i = l1->getAllElements(); (!i.end() && bKeepCleaning); i.nextElement()) {
-							TrafficElement* tel = i.getValue();
-							tel->tiaPackets.expireOldEntries();
-							tel->tiaTraffic.expireOldEntries();
-
-							int64 expiredT = tel->i64TimeOfLastChange +
-								C_ENTRY_TIME_VALIDITY;
-
-							if (currentTime > expiredT ||
-								((tel->tiaTraffic.getAverage() == 0))) {
-								list.emplace_front(i.getKey(), ii.getKey(), iii.getKey(), iv.getKey(), v.getKey());
-								cleaningCounter++;
-								(cleaningCounter < ui32CleaningNumber) ?
-									bKeepCleaning = true :
-									bKeepCleaning = false;
-							}
-						}
-					}
-				}
-			}
-		}
-		for (auto iter = list.begin(); iter != list.end(); iter++) {
-			auto  iv = _microflowNestedHashTable.get(std::get<4>(*iter));
-			auto iii = iv->get(std::get<3>(*iter));
-			auto   ii = iii->get(std::get<2>(*iter));
-			auto   i = ii->get(std::get<1>(*iter));
-
-			delete i->remove(std::get<0>(*iter));
-			if (i->getCount() == 0) {
-				delete ii->remove(std::get<1>(*iter));
-				if (ii->getCount() == 0) {
-					delete iii->remove(std::get<2>(*iter));
-					if (iii->getCount() == 0) {
-						delete iv->remove(std::get<3>(*iter));
-						if (iv->getCount() == 0) {
-							delete _microflowNestedHashTable.remove(std::get<4>(*iter));
-						}
-					}
-				}
+			else {
+				++iter;
 			}
 		}
-		_pTMutex.unlock();
-		return cleaningCounter;
-	}
-}
-
-void MicroflowNestedHashTable::fillTrafficProto (TrafficByInterface* pT)
-{
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		for (auto v = _microflowNestedHashTable.getAllElements(); !v.end(); v.nextElement()) {
-
-			uint32 ui32SrcAddr = InetAddr(v.getKey()).getIPAddress();
-
-			ui32SrcAddr = convertIpToHostOrder(ui32SrcAddr);
-
-			auto l4 = v.getValue();
-			for (auto iv = l4->getAllElements(); !iv.end(); iv.nextElement()) {
-				uint32 ui32DstAddr = InetAddr(iv.getKey()).getIPAddress();
-
-				ui32DstAddr = convertIpToHostOrder(ui32DstAddr);
-
-				bool bAddIt = false;
-				Microflow *pMw = new Microflow();
-
-				//Microflow *pMw = pT->add_microflows();
-
-				pMw->set_ipsrc(ui32SrcAddr);
-				pMw->set_ipdst(ui32DstAddr);
-				auto l3 = iv.getValue();
-
-				for (auto iii = l3->getAllElements(); !iii.end(); iii.nextElement()) {
-					auto l2 = iii.getValue();
-
-					for (auto ii = l2->getAllElements(); !ii.end(); ii.nextElement()) {
-						auto l1 = ii.getValue();
-
-						for (auto i = l1->getAllElements(); !i.end(); i.nextElement()) {
-							TrafficElement* tel = i.getValue();
-							Stat *st = pMw->add_stats();
-							st->set_stattype(TRAFFIC_AVERAGE);
-							st->set_protocol(iii.getKey());
-							char*end;
-							uint32 ui32SPort = strtol(ii.getKey(), &end, 10);
-							uint32 ui32dPort = strtol(i.getKey(), &end, 10);
-							st->set_srcport(ui32SPort);
-							st->set_dstport(ui32dPort);
-							TrafficElement *te = i.getValue();
-
-							if (te->tiaTraffic.getAverage() > 0) {
-								Average *avg = st->add_averages();
-								bAddIt = true;
-								switch (te->classification)
-								{
-								case TrafficElement::SNT:
-									avg->set_sent(te->tiaTraffic.getAverage());
-									break;
-								case TrafficElement::RCV:
-									avg->set_received(te->tiaTraffic.getAverage());
-									break;
-								case TrafficElement::OBS:
-									avg->set_observed(te->tiaTraffic.getAverage());
-									break;
-								}
-								avg->set_resolution(te->resolution);
-							}
-						}
-					}
-				}
-
-				if (bAddIt) {
-					Microflow *pNewM = pT->add_microflows();
-					pNewM->CopyFrom(*pMw);
-				}
-				delete pMw;
-			}
-		}
-		_pTMutex.unlock();
+		stripe.m.unlock();
 	}
+	return cleaningCounter;
 }
-*/
 
 void MicroflowNestedHashTable::divideByID (std::map<std::string, std::list<StaticTrafficElement>> &m, TrafficElement *pEl) 
 {
@@ -284,87 +142,84 @@ void MicroflowNestedHashTable::fillFromList (std::list<StaticTrafficElement> &li
 void MicroflowNestedHashTable::fillTrafficProto (TrafficByInterface* pT)
 {
 	std::map<std::string, std::list<StaticTrafficElement>> m;
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		for (auto i = _microflowTable.getAllElements(); !i.end(); i.nextElement()) {	
-			divideByID (m, i.getValue());
-		}	
-		_pTMutex.unlock();
-		bool init = false;
-		for (auto i : m) {
-			fillFromList (i.second, pT);
+	for (uint32 i = 0; i < C_STRIPES_NUMBER; i++) {
+		Stripe & stripe = _stripes[i];
+		if ((stripe.m.lock() == Mutex::RC_Ok)) {
+			for (auto iter : stripe.microflows) {
+				divideByID (m, iter.second);
+			}
+			stripe.m.unlock();
 		}
 	}
+	for (auto i : m) {
+		fillFromList (i.second, pT);
+	}
 	m.clear();
 }
 
-TrafficElement* MicroflowNestedHashTable::get (String entryID)
+TrafficElement * MicroflowNestedHashTable::newTrafficElement (const MicroflowId & microflowId)
 {
-	TrafficElement* tEl = nullptr;
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		tEl = _microflowTable.get(entryID);
-	}
-	_pTMutex.unlock();
-	return tEl;
+	// The string representation is only needed to report the stats,
+	// therefore it is built once, when the microflow is first seen
+	char szPort[8];
+	auto pTrafficElement = new TrafficElement (_ui32msResolution);
+	pTrafficElement->classification = microflowId.classification;
+	pTrafficElement->srcAddr		= InetAddr (microflowId.key.ui32SrcAddr).getIPAsString();
+	pTrafficElement->dstAddr		= InetAddr (microflowId.key.ui32DstAddr).getIPAsString();
+	pTrafficElement->protocol		= microflowId.key.getProtocolName();
+	convertIntToString (microflowId.key.ui16SrcPort, szPort);
+	pTrafficElement->srcPort		= szPort;
+	convertIntToString (microflowId.key.ui16DstPort, szPort);
+	pTrafficElement->dstPort		= szPort;
+	return pTrafficElement;
 }
 
-/*
-TrafficElement* MicroflowNestedHashTable::get (
-	const char* sSA,
-	const char* sDA,
-	const char* sProtocol,
-	const char* sSP,
-	const char* sDP)
+void MicroflowNestedHashTable::update (const MicroflowId & microflowId)
 {
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		auto l4 = _microflowNestedHashTable.get(sSA);
-		if (l4 != NULL) {
-			auto l3 = l4->get(sDA);
-			if (l3 != NULL) {
-				auto l2 = l3->get(sProtocol);
-				if (l2 != NULL) {
-					auto l1 = l2->get(sSP);
-					if (l1 != NULL) {
-						_pTMutex.unlock();
-						return l1->get(sDP);
-					}
-				}
-			}
-		}
-		_pTMutex.unlock();
+	Stripe & stripe = getStripe (microflowId.key);
+	if ((stripe.m.lock() != Mutex::RC_Ok)) {
+		return;
+	}
+	TrafficElement *& pTrafficElement = stripe.microflows[microflowId.key];
+	if (pTrafficElement == nullptr) {
+		pTrafficElement = newTrafficElement (microflowId);
 	}
-	return NULL;
+	pTrafficElement->i64TimeOfLastChange = microflowId.i64CurrTime;
+	pTrafficElement->tiaPackets.add (1);
+	pTrafficElement->tiaTraffic.getAverage();
+	pTrafficElement->tiaTraffic.add (microflowId.ui32Size);
+	stripe.m.unlock();
 }
-*/
 
-void MicroflowNestedHashTable::put (String entryID, TrafficElement* t)
+uint32 MicroflowNestedHashTable::getCount (void)
 {
-	TrafficElement* tEl = nullptr;
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		tEl = _microflowTable.get (entryID);
-		if (tEl == nullptr) {
-			_microflowTable.put (entryID, t);
-		}
-		else {
-			_microflowTable.remove (entryID);
-			_microflowTable.put (entryID, t);
+	uint32 ui32Count = 0;
+	for (uint32 i = 0; i < C_STRIPES_NUMBER; i++) {
+		if ((_stripes[i].m.lock() == Mutex::RC_Ok)) {
+			ui32Count += static_cast<uint32>(_stripes[i].microflows.size());
+			_stripes[i].m.unlock();
 		}
-		_pTMutex.unlock();
 	}
+	return ui32Count;
 }
 
 void MicroflowNestedHashTable::print (void)
 {
 	int64 i64CurTime = getTimeInMilliseconds();
-	if ((_pTMutex.lock() == Mutex::RC_Ok)) {
-		for (auto i = _microflowTable.getAllElements(); !i.end(); i.nextElement()) {
-			auto tel = i.getValue();
-			printf ("%43s: %.1f, last update: %llums\n",
-				i.getKey(),
-				tel->tiaTraffic.getAverage(), 
-				i64CurTime - tel->i64TimeOfLastChange);
+	for (uint32 i = 0; i < C_STRIPES_NUMBER; i++) {
+		Stripe & stripe = _stripes[i];
+		if ((stripe.m.lock() == Mutex::RC_Ok)) {
+			for (auto iter : stripe.microflows) {
+				auto tel = iter.second;
+				String id = tel->srcAddr + ":" + tel->dstAddr + ":" + tel->protocol + ":" + tel->srcPort + ":" + tel->dstPort;
+				printf ("%43s: %.1f, last update: %llums\n",
+					id.c_str(),
+					tel->tiaTraffic.getAverage(), 
+					i64CurTime - tel->i64TimeOfLastChange);
+			}
+			stripe.m.unlock();
 		}
 	}
-	_pTMutex.unlock();
 }
 
 }
\ No newline at end of file
@@ -19,49 +19,76 @@
 * Alternative licenses that allow for use within commercial products may be
 * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
 *
-* This Class impelemnts a five levels hash map that will contain
-* stats identified by source ip, dest ip, protocol, source port, dest port
+* This Class contains the stats of the microflows seen on an interface,
+* identified by source ip, dest ip, protocol, source port, dest port.
+*
+* The microflows are indexed by their binary MicroflowKey and split among
+* C_STRIPES_NUMBER stripes, each one protected by its own mutex, so that
+* the handler thread only contends with the cleaning and reporting of the
+* stripe that contains the microflow it is updating.
 */
-#include"StringHashtable.h"
 #include"TrafficElement.h"
 #include"MicroflowId.h"
+#include"Mutex.h"
 #include"NLFLib.h"
 #include"NetSensorConstants.h"
 #include"traffic.pb.h"
 #include"NetSensorUtilities.h"
 #include <list>
+#include <map>
+#include <unordered_map>
 namespace IHMC_NETSENSOR
 {
 class MicroflowNestedHashTable
 {
 public:
-	MicroflowNestedHashTable (void);
+	MicroflowNestedHashTable (uint32 ui32msResolution);
 	~MicroflowNestedHashTable (void);
 
 	/*
 	* ui32CleaningNumber : Maximum number of cleanings to perform
 	*  Returns : Number of entries removed.
 	*/
-	// uint32 cleanTable (const uint32 ui32CleaningNumber);
 	uint32 cleanTable2 (const uint32 ui32CleaningNumber);
 
 	void fillTrafficProto (netsensor::TrafficByInterface* pT);
 
-	TrafficElement* get(NOMADSUtil::String entryID);
-
+	/*
+	* Adds the packet described by microflowId to the stats of its
+	* microflow, creating the microflow if needed.
+	*/
+	void update (const MicroflowId & microflowId);
 
-	void put (NOMADSUtil::String entryID, TrafficElement* t);
+	uint32 getCount (void);
 
 	void print (void);
 
 private:
+	typedef std::unordered_map<MicroflowKey, TrafficElement*, MicroflowKeyHash> MicroflowMap;
+
+	struct Stripe
+	{
+		MicroflowMap microflows;
+		NOMADSUtil::Mutex m;
+	};
+
+	Stripe & getStripe (const MicroflowKey & key);
+	TrafficElement * newTrafficElement (const MicroflowId & microflowId);
+
 	void divideByID		(std::map<std::string, std::list<StaticTrafficElement>> &m, TrafficElement *pEl);
 	void fillFromList	(std::list<StaticTrafficElement> &list, netsensor::TrafficByInterface* pT);
 	void fillAvg		(netsensor::Average* pAvg, StaticTrafficElement pEl);
 	bool fillStat		(netsensor::Stat* pStat, StaticTrafficElement pEl);
-	//sip,dip,prot,sp,dp
-	NOMADSUtil::StringHashtable<TrafficElement> _microflowTable;
-	NOMADSUtil::Mutex _pTMutex;
+
+	static const uint32 C_STRIPES_NUMBER = 16;
+	Stripe _stripes[C_STRIPES_NUMBER];
+	const uint32 _ui32msResolution;
 };
+
+inline MicroflowNestedHashTable::Stripe & MicroflowNestedHashTable::getStripe (const MicroflowKey & key)
+{
+	// Use the high bits, the low ones select the bucket within the stripe
+	return _stripes[(key.hash() >> 48) % C_STRIPES_NUMBER];
+}
 }
 #endif
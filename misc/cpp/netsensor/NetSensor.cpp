@@ -212,6 +212,7 @@ namespace IHMC_NETSENSOR
         int rc = 0;
 
         auto pInterfaceMonitor = new InterfaceMonitor();
+        pInterfaceMonitor->setCaptureOptions (_pNCM->useTPacketV3, _pNCM->ui8CaptureThreads);
         if ((rc = pInterfaceMonitor->initLive (
             sInterfaceName, 
             false, 
@@ -353,6 +354,9 @@ namespace IHMC_NETSENSOR
         else if ((sUserInput == "10") || (sUserInput == "printIWDumps")) {
             return UserInput::PRINT_IW_DUMPS;
         }
+        else if ((sUserInput == "11") || (sUserInput == "captureStats")) {
+            return UserInput::PRINT_CAPTURE_STATS;
+        }
         else if ((sUserInput == "0") || (sUserInput == "about")) {
             return UserInput::PRINT_ABOUT;
         }
@@ -662,7 +666,7 @@ namespace IHMC_NETSENSOR
         case UserInput::LAUNCH_DIAGNOSTIC:
             printf("\n\nStarting diagnostic service:\n\n");
             _pHThread->startDiagnostic();
-            //_pMonitorThreadsMap
+            printCaptureStatistics();
             //_pms
             printHelp();
             break;
@@ -680,6 +684,11 @@ namespace IHMC_NETSENSOR
         case UserInput::PRINT_IW_DUMPS:
             printIWDumps();
             break;
+
+        case UserInput::PRINT_CAPTURE_STATS:
+            printCaptureStatistics();
+            printHelp();
+            break;
         }
         
     }
@@ -1035,6 +1044,7 @@ namespace IHMC_NETSENSOR
         printf(".            8. diag          <-- Launch diagnostic                       .\n");
         printf("|            9. help          <-- Print help menu                         |\n");
         printf("|            10. printIWDumps <-- Print IWDumps                           |\n");
+        printf(".            11. captureStats <-- Print capture and queue statistics      .\n");
         printf(".            0. about         <-- Software Info                           .\n");
         printf("  ________________________________________________________________________\n");
     }
@@ -1268,4 +1278,24 @@ namespace IHMC_NETSENSOR
     {
         _pIWDumpManager->printDumps();
     }
+
+    void NetSensor::printCaptureStatistics (void)
+    {
+        printf ("\nCapture statistics:\n");
+        for (auto i = _pMonitorThreadsMap.getAllElements(); !i.end(); i.nextElement()) {
+            CaptureStatistics stats;
+            i.getValue()->getCaptureStatistics (stats);
+            printf ("    %s (%s, %d thread(s)): captured %llu, dropped by the queue %llu",
+                i.getKey(), stats.bTPacketV3 ? "TPACKET_V3" : "pcap", (int) stats.ui8CaptureThreads,
+                (unsigned long long) stats.ui64Captured, (unsigned long long) stats.ui64QueueDrops);
+            if (stats.bTPacketV3) {
+                printf (", received by the kernel %llu, dropped by the kernel %llu",
+                    (unsigned long long) stats.ui64KernelPackets, (unsigned long long) stats.ui64KernelDrops);
+            }
+            printf ("\n");
+        }
+        printf ("Packet queue: depth %u/%u, max depth %u, rejected enqueues %llu\n",
+            _pPQ->getDepth(), _pPQ->getCapacity(), _pPQ->getMaxDepth(),
+            (unsigned long long) _pPQ->getRejectedCount());
+    }
 }
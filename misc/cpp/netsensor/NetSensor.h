@@ -83,7 +83,8 @@ enum class UserInput
     LAUNCH_DIAGNOSTIC = 7,
     PRINT_HELP = 8,
     PRINT_ABOUT = 9,
-    PRINT_IW_DUMPS = 10
+    PRINT_IW_DUMPS = 10,
+    PRINT_CAPTURE_STATS = 11
 };
     
 class NetSensor : public NOMADSUtil::ManageableThread
@@ -160,6 +161,7 @@ public:
     *       behavior of netsensor.
     *    PRINT_ABOUT: To print information about copyrights and author.
     *    PRINT_CONFIG: To print list of active configurations.
+    *    PRINT_CAPTURE_STATS: To print the capture and packet queue statistics.
     */
     void passUserInput (const UserInput command);
 
@@ -224,6 +226,7 @@ private:
 
     void printConfig (void);
     void printIWDumps (void);
+    void printCaptureStatistics (void);
     void nextStatus (void);
     void netSensorStateMachine (void);
     void printAbout (void);
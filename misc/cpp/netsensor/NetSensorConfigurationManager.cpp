@@ -46,6 +46,8 @@ NetSensorConfigurationManager::NetSensorConfigurationManager(void)
     nproxyTopActive = DEFAULT_TOPOLOGY_NETPROXY_ACTIVE;
     icmpRTTActive   = DEFAULT_RTT_ICMP_ACTIVE;
     ignoreMulticast = DEFAULT_TRAFFIC_MULTICAST_IGNORE;
+    useTPacketV3    = DEFAULT_CAPTURE_TPACKET_V3_ACTIVE;
+    ui8CaptureThreads = DEFAULT_CAPTURE_THREADS;
 
     ui32ForcedInterfaceAddr = DEFAULT_NOT_ACTIVE;
     ui32ForcedNetmask       = DEFAULT_NOT_ACTIVE;
@@ -155,6 +157,11 @@ int NetSensorConfigurationManager::populateConfigurations(void)
         return -7;
     }
 
+    rc = setCaptureOptions();
+    if (rc != 0) {
+        return -8;
+    }
+
     return 0;
 }
 
@@ -186,6 +193,8 @@ void NetSensorConfigurationManager::printConfigurationReport(void)
     checkAndLogMsg (pszMethodName, Logger::L_Info, "\tStore external nodes for topology set to: %d\n", storeExternalNodes);
     checkAndLogMsg (pszMethodName, Logger::L_Info, "\tUse compression for protobuf stream: %d\n", useProtobufCompression);
     checkAndLogMsg (pszMethodName, Logger::L_Info, "\tCalculate TCP RTT: %d\n", calculateTCPRTT);
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "\tCapture through TPACKET_V3: %d\n", useTPacketV3);
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "\tCapture threads per interface: %d\n", (int) ui8CaptureThreads);
     if (ui32ForcedInterfaceAddr != 0) {
         checkAndLogMsg (pszMethodName, Logger::L_Info, "\tForced Sensor Address: %d\n", 
             InetAddr (ui32ForcedInterfaceAddr).getIPAsString());
@@ -377,4 +386,22 @@ int NetSensorConfigurationManager::setExternalTopologyNodeStorage (void)
     }
     return 0;
 }
+
+int NetSensorConfigurationManager::setCaptureOptions (void)
+{
+    if (_cfg.hasValue(C_CAPTURE_TPACKET_V3_CONF_KEY)) {
+        useTPacketV3 = _cfg.getValueAsBool(C_CAPTURE_TPACKET_V3_CONF_KEY);
+    }
+    if (_cfg.hasValue(C_CAPTURE_THREADS_CONF_KEY)) {
+        const uint32 ui32CaptureThreads = _cfg.getValueAsUInt32(C_CAPTURE_THREADS_CONF_KEY);
+        if ((ui32CaptureThreads == 0) || (ui32CaptureThreads > 255)) {
+            checkAndLogMsg("NetSensorConfigurationManager::setCaptureOptions()",
+                Logger::L_Warning, "; %s must be between 1 and 255, it is %u\n",
+                C_CAPTURE_THREADS_CONF_KEY, ui32CaptureThreads);
+            return -1;
+        }
+        ui8CaptureThreads = static_cast<uint8>(ui32CaptureThreads);
+    }
+    return 0;
+}
 }
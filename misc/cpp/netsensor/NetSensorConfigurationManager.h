@@ -51,6 +51,7 @@ private:
 	int setRTTDetectionOptions(void);
 	int setMulticastDetection(void);
     int setExternalTopologyNodeStorage(void);
+    int setCaptureOptions(void);
 //<--------------------------------------------------------------------------->
 
 public:
@@ -74,6 +75,9 @@ public:
     bool storeExternalNodes;
     bool useProtobufCompression;
     bool useForcedInterfaces;
+    // Capture live interfaces through TPACKET_V3 rings (Linux only)
+    bool useTPacketV3;
+    uint8 ui8CaptureThreads;
 
     uint32 ui32ForcedInterfaceAddr;
     uint32 ui32ForcedNetmask;
@@ -27,6 +27,7 @@ namespace IHMC_NETSENSOR
 {
 const uint32 C_VERSION = 2;
 const uint32 C_PACKET_MAX_SIZE = 1400;
+const uint16 C_MAX_CAPTURED_FRAME_SIZE = 9038U;
 
 // Configuration File
 const char * const  C_VERSION_CONF_KEY               = "netsensor.version";
@@ -43,6 +44,8 @@ const char * const  C_NETPROXY_CONF_KEY              = "netsensor.topology.netpr
 const char * const  C_EXTERNAL_TOP_CONF_KEY          = "netsensor.topology.externals.active";
 const char * const  C_IGNORE_MULTICAST_CONF_KEY      = "netsensor.traffc.ignore.multicast";
 const char * const  C_ICMP_CONF_KEY                  = "netsensor.rtt.detection.icmp.active";
+const char * const  C_CAPTURE_TPACKET_V3_CONF_KEY    = "netsensor.capture.tpacketv3.active";
+const char * const  C_CAPTURE_THREADS_CONF_KEY       = "netsensor.capture.threads";
 
 const char * const  C_EXTERNAL_TOPOLOGY_UNKNOWN = "Unknown";
 
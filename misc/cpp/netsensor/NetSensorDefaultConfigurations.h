@@ -41,5 +41,7 @@ namespace IHMC_NETSENSOR
     static const bool     DEFAULT_OUTPUT_COMPRESSION_ACTIVE = false;
     static const bool     DEFAULT_TCP_RTT_CALCULATION_ACTIVE = false;
     static const uint32   DEFAULT_NOT_ACTIVE = 0;
+    static const bool     DEFAULT_CAPTURE_TPACKET_V3_ACTIVE = true;
+    static const uint8    DEFAULT_CAPTURE_THREADS = 1;
 }
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "FTypes.h"
 #include"StrClass.h"
 
+#include "FrameBuffer.h"
 #include "InterfaceMonitor.h"
 
 namespace IHMC_NETSENSOR
@@ -19,10 +20,19 @@ namespace IHMC_NETSENSOR
         NetSensorPacket & operator = (const NetSensorPacket &p);
 
     private:
-        friend void InterfaceMonitor::run(void);
+        friend class InterfaceMonitor;
         friend class HandlerThread;
 
-        uint8               ui8Buf[9038U];
+        // Makes the packet point to pui8Frame, that must be contained in
+        // pFrameBuffer.  The packet takes the reference held by the caller.
+        void setFrame(uint8 *pui8Frame, uint32 ui32Len, FrameBuffer *pFrameBuffer);
+        // Returns a negative value if the memory could not be allocated
+        int copyFrame(const uint8 *pui8Frame, uint32 ui32Len);
+        void releaseFrame(void);
+
+        // Copies of a packet share the frame, they do not copy it
+        uint8              *ui8Buf;
+        FrameBuffer        *pFrameBuffer;
         int64               int64RcvTimeStamp;
         int                 classification;
         uint32              received;
@@ -32,27 +42,68 @@ namespace IHMC_NETSENSOR
     static const NetSensorPacket EMPTY_PACKET{ };
 
 
-    inline NetSensorPacket::NetSensorPacket() : int64RcvTimeStamp(0), classification(0), received(0), sMonitoredInterface("") { }
+    inline NetSensorPacket::NetSensorPacket() :
+        ui8Buf(nullptr), pFrameBuffer(nullptr), int64RcvTimeStamp(0), classification(0),
+        received(0), sMonitoredInterface("") { }
+
     inline NetSensorPacket::NetSensorPacket(const NetSensorPacket &p) :
-        int64RcvTimeStamp(p.int64RcvTimeStamp), classification(p.classification), received(p.received),
-        sMonitoredInterface(p.sMonitoredInterface)
+        ui8Buf(p.ui8Buf), pFrameBuffer(p.pFrameBuffer), int64RcvTimeStamp(p.int64RcvTimeStamp),
+        classification(p.classification), received(p.received), sMonitoredInterface(p.sMonitoredInterface)
     {
-        memcpy (ui8Buf, p.ui8Buf, p.received);
+        if (pFrameBuffer != nullptr) {
+            pFrameBuffer->retain();
+        }
     }
 
-    inline NetSensorPacket::~NetSensorPacket(void) { }
+    inline NetSensorPacket::~NetSensorPacket(void)
+    {
+        releaseFrame();
+    }
 
     inline NetSensorPacket & NetSensorPacket::operator = (const NetSensorPacket &p)
     {
+        if (p.pFrameBuffer != nullptr) {
+            p.pFrameBuffer->retain();
+        }
+        releaseFrame();
+        ui8Buf = p.ui8Buf;
+        pFrameBuffer = p.pFrameBuffer;
         int64RcvTimeStamp = p.int64RcvTimeStamp;
         classification = p.classification;
         received = p.received;
         sMonitoredInterface = p.sMonitoredInterface;
-        memcpy (ui8Buf, p.ui8Buf, p.received);
 
         return (*this);
     }
 
+    inline void NetSensorPacket::setFrame(uint8 *pui8Frame, uint32 ui32Len, FrameBuffer *pFrameBuffer)
+    {
+        releaseFrame();
+        ui8Buf = pui8Frame;
+        received = ui32Len;
+        this->pFrameBuffer = pFrameBuffer;
+    }
+
+    inline int NetSensorPacket::copyFrame(const uint8 *pui8Frame, uint32 ui32Len)
+    {
+        auto pHeapFrameBuffer = HeapFrameBuffer::copyOf(pui8Frame, ui32Len);
+        if (pHeapFrameBuffer == nullptr) {
+            return -1;
+        }
+        setFrame(pHeapFrameBuffer->getData(), ui32Len, pHeapFrameBuffer);
+        return 0;
+    }
+
+    inline void NetSensorPacket::releaseFrame(void)
+    {
+        if (pFrameBuffer != nullptr) {
+            pFrameBuffer->release();
+            pFrameBuffer = nullptr;
+        }
+        ui8Buf = nullptr;
+        received = 0;
+    }
+
     inline int64 NetSensorPacket::getTime(void)
     {
         return int64RcvTimeStamp;
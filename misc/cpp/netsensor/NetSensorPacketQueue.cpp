@@ -21,7 +21,8 @@
 using namespace NOMADSUtil;
 namespace IHMC_NETSENSOR
 {
-NetSensorPacketQueue::NetSensorPacketQueue (const uint32 queueMaxSize)
+NetSensorPacketQueue::NetSensorPacketQueue (const uint32 queueMaxSize) :
+    _uint32Size (0), _ui32MaxDepth (0), _ui64Rejected (0), _cv (&_mutex)
 {
     _uint32QueueMaxSize = queueMaxSize;
 }
@@ -31,10 +32,15 @@ bool NetSensorPacketQueue::enqueue (const NetSensorPacket& p)
     if (_mutex.lock() == Mutex::RC_Ok) {
         if ((_uint32Size = _pPQueue.size()) < _uint32QueueMaxSize) {
             _pPQueue.enqueue (p);
+            if (++_uint32Size > _ui32MaxDepth) {
+                _ui32MaxDepth = _uint32Size;
+            }
+            _cv.notify();
             _mutex.unlock();
             return true;
         }
         else {
+            _ui64Rejected++;
             _mutex.unlock();
             return false;
         }
@@ -44,19 +50,13 @@ bool NetSensorPacketQueue::enqueue (const NetSensorPacket& p)
 
 void NetSensorPacketQueue::dequeue (NetSensorPacket& p)
 {
-    bool bRcvdSomething = false;
-    while (!bRcvdSomething) {
-        if (_mutex.lock() == Mutex::RC_Ok) {
-            bRcvdSomething = _pPQueue.size() > 0;
-            _mutex.unlock();
-        }
-        if (!bRcvdSomething) { 
-            sleepForMilliseconds (50); 
-        }  
-    }
-
+    // Release the previous frame before waiting, so that it can be recycled
+    p = EMPTY_PACKET;
     if (_mutex.lock() == Mutex::RC_Ok) {
-        if (_pPQueue.dequeue (p) != 0) { 
+        while (_pPQueue.size() <= 0) {
+            _cv.wait (50);
+        }
+        if (_pPQueue.dequeue (p) != 0) {
             p = EMPTY_PACKET;
         }
         _mutex.unlock();
@@ -73,4 +73,34 @@ bool NetSensorPacketQueue::mutexTest(void)
         return false;
     }
 }
-}
\ No newline at end of file
+
+uint32 NetSensorPacketQueue::getDepth (void)
+{
+    uint32 ui32Depth = 0;
+    if (_mutex.lock() == Mutex::RC_Ok) {
+        ui32Depth = _pPQueue.size();
+        _mutex.unlock();
+    }
+    return ui32Depth;
+}
+
+uint32 NetSensorPacketQueue::getMaxDepth (void)
+{
+    uint32 ui32MaxDepth = 0;
+    if (_mutex.lock() == Mutex::RC_Ok) {
+        ui32MaxDepth = _ui32MaxDepth;
+        _mutex.unlock();
+    }
+    return ui32MaxDepth;
+}
+
+uint64 NetSensorPacketQueue::getRejectedCount (void)
+{
+    uint64 ui64Rejected = 0;
+    if (_mutex.lock() == Mutex::RC_Ok) {
+        ui64Rejected = _ui64Rejected;
+        _mutex.unlock();
+    }
+    return ui64Rejected;
+}
+}
@@ -22,6 +22,7 @@
 #include "NetSensorPacket.h"
 #include "Queue.h"
 #include "Mutex.h"
+#include "ConditionVariable.h"
 #include "NLFLib.h"
 
 namespace IHMC_NETSENSOR
@@ -34,12 +35,27 @@ public:
     void dequeue (NetSensorPacket& p);
     bool mutexTest(void);
     bool enqueue (const NetSensorPacket& packet);
+
+    uint32 getCapacity (void) const;
+    uint32 getDepth (void);
+    // Largest number of packets that has been queued at the same time
+    uint32 getMaxDepth (void);
+    // Number of packets that could not be enqueued because the queue was full
+    uint64 getRejectedCount (void);
 //<--------------------------------------------------------------------------->
 private:
     uint32 _uint32Size;
     uint32 _uint32QueueMaxSize;
+    uint32 _ui32MaxDepth;
+    uint64 _ui64Rejected;
     NOMADSUtil::Queue<NetSensorPacket> _pPQueue;
     NOMADSUtil::Mutex _mutex;
+    NOMADSUtil::ConditionVariable _cv;
 };
+
+inline uint32 NetSensorPacketQueue::getCapacity (void) const
+{
+    return _uint32QueueMaxSize;
+}
 }
 #endif
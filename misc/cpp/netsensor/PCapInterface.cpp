@@ -210,7 +210,7 @@ namespace IHMC_NETSENSOR
             if (rc > 0) {
                 *tus = pPacketHeader->ts.tv_usec +
                     (static_cast<int64> (pPacketHeader->ts.tv_sec) * 1000000);
-                if (_m == Mode::M_OFFLINE) {
+                if ((_m == Mode::M_OFFLINE) && _bReplayPacing) {
                     static const int64 i64FirstPacketReplayTime = getTimeInNanos();
                     static const int64 i64FirstPacketTime = *tus;
 
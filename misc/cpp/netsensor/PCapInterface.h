@@ -58,6 +58,10 @@ public:
 
     int readPacket(uint8 *pui8Buf, uint16 ui16BufSize, int64 *tus);
 
+    // In REPLAY MODE, return the packets as fast as they are read instead
+    // of following the timestamps of the pcap file
+    void disableReplayPacing(void);
+
 private:
     PCapInterface(const NOMADSUtil::String & sAdapterName);
     PCapInterface(const NOMADSUtil::String & sAdapterName,
@@ -82,11 +86,13 @@ private:
     NOMADSUtil::String  _sPcapFile;
     pcap_t             *_pPCapHandle;
     const Mode          _m;
+    bool                _bReplayPacing;
 };
 
 
 inline PCapInterface::PCapInterface(const NOMADSUtil::String & sAdapterName) :
-    NetworkInterface(), _sPcapFile(""), _pPCapHandle(nullptr), _m{Mode::M_LIVE}
+    NetworkInterface(), _sPcapFile(""), _pPCapHandle(nullptr), _m{Mode::M_LIVE},
+    _bReplayPacing(true)
 {
     _sAdapterName = sAdapterName;
 }
@@ -97,11 +103,17 @@ inline PCapInterface::PCapInterface(const NOMADSUtil::String & sAdapterName,
                                     uint32 ui32GwIPAddr,
                                     NOMADSUtil::EtherMACAddr emacInterfaceMAC) :
     NetworkInterface(ui32IPAddr, ui32Netmask, ui32GwIPAddr, emacInterfaceMAC),
-    _sPcapFile(sPcapFile), _pPCapHandle(nullptr), _m{Mode::M_OFFLINE}
+    _sPcapFile(sPcapFile), _pPCapHandle(nullptr), _m{Mode::M_OFFLINE},
+    _bReplayPacing(true)
 {
     _sAdapterName = sAdapterName;
 }
 
+inline void PCapInterface::disableReplayPacing(void)
+{
+    _bReplayPacing = false;
+}
+
 inline PCapInterface::~PCapInterface(void)
 {
     requestTermination();
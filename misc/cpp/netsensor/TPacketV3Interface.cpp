@@ -0,0 +1,443 @@
+/*
+* TPacketV3Interface.cpp
+* This file is part of the IHMC NetSensor Library/Component
+* Copyright (c) 2010-2017 IHMC.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 3 (GPLv3) as published by the Free Software Foundation.
+*
+* U.S. Government agencies and organizations may redistribute
+* and/or modify this program under terms equivalent to
+* "Government Purpose Rights" as defined by DFARS
+* 252.227-7014(a)(12) (February 2014).
+*
+* Alternative licenses that allow for use within commercial products may be
+* available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+*/
+#if defined (LINUX)
+
+#include <atomic>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#include "Logger.h"
+
+#include "FrameBuffer.h"
+#include "TPacketV3Interface.h"
+
+using namespace NOMADSUtil;
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+namespace IHMC_NETSENSOR
+{
+    static const int C_POLL_TIMEOUT_MS = 100;
+
+    // Block of the ring.  It is checked out by the capture thread when the
+    // kernel marks it as ready, and it is handed back to the kernel when the
+    // last reference to it is released.
+    class TPacketV3Block : public FrameBuffer
+    {
+    public:
+        TPacketV3Block(void);
+
+        void init(TPacketV3Ring *pRing, tpacket_block_desc *pDesc);
+
+        // Returns true if the kernel filled the block and the frames of
+        // the previous fill are not referenced anymore
+        bool isReady(void) const;
+        void checkOut(void);
+
+        tpacket_block_desc * getDescriptor(void) const;
+
+    protected:
+        void recycle(void);
+
+    private:
+        TPacketV3Ring *_pRing;
+        tpacket_block_desc *_pDesc;
+        std::atomic_bool _bCheckedOut;
+    };
+
+    // The memory mapped ring.  It is deallocated when both the interface
+    // and every checked out block have released it, therefore the frames
+    // that are still queued stay valid after the interface is deleted.
+    class TPacketV3Ring
+    {
+    public:
+        TPacketV3Ring(int iSocket, uint8 *pui8Map, size_t mapLen, uint32 ui32BlockSize,
+                      uint32 ui32BlockCount);
+
+        void retain(void);
+        void release(void);
+
+        int getSocket(void) const;
+        uint32 getBlockCount(void) const;
+        TPacketV3Block * getBlock(uint32 ui32Index);
+
+    private:
+        ~TPacketV3Ring(void);
+
+        std::atomic<uint32> _ui32RefCount;
+        const int _iSocket;
+        uint8 * const _pui8Map;
+        const size_t _mapLen;
+        const uint32 _ui32BlockCount;
+        TPacketV3Block *_pBlocks;
+    };
+
+
+    TPacketV3Block::TPacketV3Block(void) :
+        _pRing(nullptr), _pDesc(nullptr), _bCheckedOut(false) { }
+
+    void TPacketV3Block::init(TPacketV3Ring *pRing, tpacket_block_desc *pDesc)
+    {
+        _pRing = pRing;
+        _pDesc = pDesc;
+    }
+
+    bool TPacketV3Block::isReady(void) const
+    {
+        if (_bCheckedOut.load(std::memory_order_acquire)) {
+            return false;
+        }
+        return (__atomic_load_n(&_pDesc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) != 0;
+    }
+
+    void TPacketV3Block::checkOut(void)
+    {
+        _bCheckedOut.store(true, std::memory_order_relaxed);
+        resetReferences();
+        _pRing->retain();
+    }
+
+    tpacket_block_desc * TPacketV3Block::getDescriptor(void) const
+    {
+        return _pDesc;
+    }
+
+    void TPacketV3Block::recycle(void)
+    {
+        // The block must belong to the kernel before it can be checked out again
+        __atomic_store_n(&_pDesc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        _bCheckedOut.store(false, std::memory_order_release);
+        _pRing->release();
+    }
+
+    TPacketV3Ring::TPacketV3Ring(int iSocket, uint8 *pui8Map, size_t mapLen,
+                                 uint32 ui32BlockSize, uint32 ui32BlockCount) :
+        _ui32RefCount(1U), _iSocket(iSocket), _pui8Map(pui8Map), _mapLen(mapLen),
+        _ui32BlockCount(ui32BlockCount), _pBlocks(new TPacketV3Block[ui32BlockCount])
+    {
+        for (uint32 i = 0; i < ui32BlockCount; i++) {
+            _pBlocks[i].init(this, reinterpret_cast<tpacket_block_desc *>(pui8Map + (i * ui32BlockSize)));
+        }
+    }
+
+    TPacketV3Ring::~TPacketV3Ring(void)
+    {
+        delete[] _pBlocks;
+        munmap(_pui8Map, _mapLen);
+        close(_iSocket);
+    }
+
+    void TPacketV3Ring::retain(void)
+    {
+        _ui32RefCount.fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    void TPacketV3Ring::release(void)
+    {
+        if (_ui32RefCount.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+            delete this;
+        }
+    }
+
+    int TPacketV3Ring::getSocket(void) const
+    {
+        return _iSocket;
+    }
+
+    uint32 TPacketV3Ring::getBlockCount(void) const
+    {
+        return _ui32BlockCount;
+    }
+
+    TPacketV3Block * TPacketV3Ring::getBlock(uint32 ui32Index)
+    {
+        return &_pBlocks[ui32Index];
+    }
+
+    //<--------------------------------------------------------------------------->
+
+    TPacketV3Interface::TPacketV3Interface(const NOMADSUtil::String & sAdapterName) :
+        NetworkInterface(), _pRing(nullptr), _pCurrentBlock(nullptr), _pui8NextFrame(nullptr),
+        _ui32CurrentBlock(0), _ui32FramesLeft(0), _ui64Packets(0), _ui64Drops(0)
+    {
+        _sAdapterName = sAdapterName;
+    }
+
+    TPacketV3Interface::~TPacketV3Interface(void)
+    {
+        requestTermination();
+        releaseCurrentBlock();
+        if (_pRing != nullptr) {
+            _pRing->release();
+            _pRing = nullptr;
+        }
+    }
+
+    TPacketV3Interface * const TPacketV3Interface::getTPacketV3Interface(const char * const pszDevice,
+                                                                        uint16 ui16FanoutGroupId,
+                                                                        uint32 ui32BlockSize,
+                                                                        uint32 ui32BlockCount)
+    {
+        String sDeviceName(NetworkInterface::getDeviceNameFromUserFriendlyName(pszDevice));
+        if (sDeviceName.length() <= 0) {
+            checkAndLogMsg("TPacketV3Interface::getTPacketV3Interface", Logger::L_MildError,
+                           "Device query for device name failed %s\n", pszDevice);
+            return nullptr;
+        }
+
+        int rc;
+        TPacketV3Interface *pInterface = new TPacketV3Interface(sDeviceName);
+        if (0 != (rc = pInterface->init(ui16FanoutGroupId, ui32BlockSize, ui32BlockCount))) {
+            checkAndLogMsg("TPacketV3Interface::getTPacketV3Interface", Logger::L_MildError,
+                           "failed to initialize TPacketV3Interface for %s; rc = %d\n",
+                           sDeviceName.c_str(), rc);
+            delete pInterface;
+            return nullptr;
+        }
+
+        return pInterface;
+    }
+
+    uint16 TPacketV3Interface::newFanoutGroupId(void)
+    {
+        // Fanout groups are shared by every process on the host
+        static std::atomic<uint16> ui16NextGroupId(static_cast<uint16>(getpid()));
+        uint16 ui16GroupId;
+        while ((ui16GroupId = ui16NextGroupId.fetch_add(1U)) == 0);
+        return ui16GroupId;
+    }
+
+    int TPacketV3Interface::init(uint16 ui16FanoutGroupId, uint32 ui32BlockSize, uint32 ui32BlockCount)
+    {
+        auto pszMethodName = "TPacketV3Interface::init";
+        const unsigned int uiIfIndex = if_nametoindex(_sAdapterName);
+        if (uiIfIndex == 0) {
+            checkAndLogMsg(pszMethodName, Logger::L_MildError,
+                           "could not find interface %s\n", _sAdapterName.c_str());
+            return -1;
+        }
+
+        int iSocket = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+        if (iSocket < 0) {
+            checkAndLogMsg(pszMethodName, Logger::L_MildError,
+                           "socket() failed with error %s\n", strerror(errno));
+            return -2;
+        }
+
+        int iVersion = TPACKET_V3;
+        if (setsockopt(iSocket, SOL_PACKET, PACKET_VERSION, &iVersion, sizeof(iVersion)) < 0) {
+            checkAndLogMsg(pszMethodName, Logger::L_MildError,
+                           "could not select TPACKET_V3: %s\n", strerror(errno));
+            close(iSocket);
+            return -3;
+        }
+
+        tpacket_req3 req;
+        memset(&req, 0, sizeof(req));
+        req.tp_block_size = ui32BlockSize;
+        req.tp_block_nr = ui32BlockCount;
+        req.tp_frame_size = TPACKET_ALIGNMENT << 7;
+        req.tp_frame_nr = (ui32BlockSize / req.tp_frame_size) * ui32BlockCount;
+        req.tp_retire_blk_tov = DEFAULT_BLOCK_TIMEOUT_MS;
+        req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+        if (setsockopt(iSocket, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+            checkAndLogMsg(pszMethodName, Logger::L_MildError,
+                           "could not set up a ring of %u blocks of %u bytes: %s\n",
+                           ui32BlockCount, ui32BlockSize, strerror(errno));
+            close(iSocket);
+            return -4;
+        }
+
+        const size_t mapLen = static_cast<size_t>(ui32BlockSize) * ui32BlockCount;
+        void *pMap = mmap(nullptr, mapLen, PROT_READ | PROT_WRITE, MAP_SHARED, iSocket, 0);
+        if (pMap == MAP_FAILED) {
+            checkAndLogMsg(pszMethodName, Logger::L_MildError,
+                           "mmap() of the ring failed with error %s\n", strerror(errno));
+            close(iSocket);
+            return -5;
+        }
+        // From now on the socket is closed by the ring
+        _pRing = new TPacketV3Ring(iSocket, static_cast<uint8 *>(pMap), mapLen,
+                                   ui32BlockSize, ui32BlockCount);
+
+        sockaddr_ll sll;
+        memset(&sll, 0, sizeof(sll));
+        sll.sll_family = AF_PACKET;
+        sll.sll_protocol = htons(ETH_P_ALL);
+        sll.sll_ifindex = uiIfIndex;
+        if (bind(iSocket, reinterpret_cast<sockaddr *>(&sll), sizeof(sll)) < 0) {
+            checkAndLogMsg(pszMethodName, Logger::L_MildError,
+                           "bind() to %s failed with error %s\n", _sAdapterName.c_str(), strerror(errno));
+            return -6;
+        }
+
+        packet_mreq mreq;
+        memset(&mreq, 0, sizeof(mreq));
+        mreq.mr_ifindex = uiIfIndex;
+        mreq.mr_type = PACKET_MR_PROMISC;
+        if (setsockopt(iSocket, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            checkAndLogMsg(pszMethodName, Logger::L_Warning,
+                           "could not set %s in promiscuous mode: %s\n", _sAdapterName.c_str(), strerror(errno));
+        }
+
+        if (ui16FanoutGroupId != 0) {
+            int iFanout = ui16FanoutGroupId | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+            if (setsockopt(iSocket, SOL_PACKET, PACKET_FANOUT, &iFanout, sizeof(iFanout)) < 0) {
+                checkAndLogMsg(pszMethodName, Logger::L_MildError,
+                               "could not join fanout group %hu: %s\n", ui16FanoutGroupId, strerror(errno));
+                return -7;
+            }
+        }
+
+        const uint8 * const pszMACAddr = NetworkInterface::getMACAddrForDevice(_sAdapterName);
+        if (pszMACAddr) {
+            memcpy(static_cast<void*> (NetworkInterface::_aui8MACAddr), pszMACAddr, 6);
+            NetworkInterface::_bMACAddrFound = true;
+            delete[] pszMACAddr;
+        }
+        else {
+            checkAndLogMsg(pszMethodName, Logger::L_Warning, "Device query for MAC address failed\n");
+        }
+
+        retrieveAndSetIPv4Addr(iSocket);
+        IPv4Addr ipv4DefGW = NetworkInterface::getDefaultGatewayForInterface(_sAdapterName);
+        if (ipv4DefGW.ui32Addr) {
+            _bDefaultGatewayFound = true;
+            _ipv4DefaultGateway = ipv4DefGW;
+        }
+        return 0;
+    }
+
+    void TPacketV3Interface::retrieveAndSetIPv4Addr(int iSocket)
+    {
+        ifreq ifReq;
+        memset(&ifReq, 0, sizeof(ifReq));
+        strncpy(ifReq.ifr_name, _sAdapterName.c_str(), IFNAMSIZ - 1);
+        ifReq.ifr_addr.sa_family = AF_INET;
+
+        // SIOCGIFADDR and SIOCGIFNETMASK require an AF_INET socket
+        int iInetSocket = socket(AF_INET, SOCK_DGRAM, 0);
+        if (iInetSocket < 0) {
+            return;
+        }
+        if (ioctl(iInetSocket, SIOCGIFADDR, &ifReq) == 0) {
+            _ipv4Addr.ui32Addr = reinterpret_cast<sockaddr_in *>(&ifReq.ifr_addr)->sin_addr.s_addr;
+            _bIPAddrFound = true;
+        }
+        if (ioctl(iInetSocket, SIOCGIFNETMASK, &ifReq) == 0) {
+            _ipv4Netmask.ui32Addr = reinterpret_cast<sockaddr_in *>(&ifReq.ifr_netmask)->sin_addr.s_addr;
+            _bNetmaskFound = true;
+        }
+        close(iInetSocket);
+    }
+
+    int TPacketV3Interface::readPacket(uint8 *pui8Buf, uint16 ui16BufSize, int64 *tus)
+    {
+        uint8 *pui8Frame;
+        FrameBuffer *pFrameBuffer;
+        int rc = nextFrame(&pui8Frame, tus, &pFrameBuffer);
+        if (rc <= 0) {
+            return rc;
+        }
+        const uint32 ui32PacketSize = ui16BufSize < rc ? ui16BufSize : rc;
+        memcpy(pui8Buf, pui8Frame, ui32PacketSize);
+        pFrameBuffer->release();
+        return ui32PacketSize;
+    }
+
+    int TPacketV3Interface::nextFrame(uint8 **ppui8Frame, int64 *tus, FrameBuffer **ppFrameBuffer)
+    {
+        while (true) {
+            if (_ui32FramesLeft > 0) {
+                auto pHeader = reinterpret_cast<tpacket3_hdr *>(_pui8NextFrame);
+                *ppui8Frame = _pui8NextFrame + pHeader->tp_mac;
+                *tus = (static_cast<int64> (pHeader->tp_sec) * 1000000) + (pHeader->tp_nsec / 1000);
+                _pui8NextFrame += pHeader->tp_next_offset;
+                _ui32FramesLeft--;
+                _pCurrentBlock->retain();
+                *ppFrameBuffer = _pCurrentBlock;
+                return static_cast<int>(pHeader->tp_snaplen);
+            }
+
+            // Done with the current block: it goes back to the kernel as soon
+            // as the frames that are still queued are released
+            releaseCurrentBlock();
+            if (terminationRequested()) {
+                return 0;
+            }
+
+            TPacketV3Block *pBlock = _pRing->getBlock(_ui32CurrentBlock);
+            if (!pBlock->isReady()) {
+                pollfd pfd;
+                pfd.fd = _pRing->getSocket();
+                pfd.events = POLLIN | POLLERR;
+                pfd.revents = 0;
+                if ((poll(&pfd, 1, C_POLL_TIMEOUT_MS) < 0) && (errno != EINTR)) {
+                    checkAndLogMsg("TPacketV3Interface::nextFrame", Logger::L_MildError,
+                                   "poll() failed with error %s\n", strerror(errno));
+                    return -1;
+                }
+                continue;
+            }
+
+            pBlock->checkOut();
+            const tpacket_block_desc * const pDesc = pBlock->getDescriptor();
+            _pCurrentBlock = pBlock;
+            _ui32FramesLeft = pDesc->hdr.bh1.num_pkts;
+            _pui8NextFrame = reinterpret_cast<uint8 *>(pBlock->getDescriptor()) + pDesc->hdr.bh1.offset_to_first_pkt;
+            _ui32CurrentBlock = (_ui32CurrentBlock + 1) % _pRing->getBlockCount();
+        }
+    }
+
+    void TPacketV3Interface::releaseCurrentBlock(void)
+    {
+        if (_pCurrentBlock != nullptr) {
+            _pCurrentBlock->release();
+            _pCurrentBlock = nullptr;
+            _pui8NextFrame = nullptr;
+            _ui32FramesLeft = 0;
+        }
+    }
+
+    void TPacketV3Interface::getStatistics(uint64 & ui64Packets, uint64 & ui64Drops)
+    {
+        tpacket_stats_v3 stats;
+        socklen_t len = sizeof(stats);
+        memset(&stats, 0, sizeof(stats));
+        _mStats.lock();
+        // The kernel resets its counters every time they are read
+        if ((_pRing != nullptr) && (getsockopt(_pRing->getSocket(), SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0)) {
+            _ui64Packets += stats.tp_packets;
+            _ui64Drops += stats.tp_drops;
+        }
+        ui64Packets = _ui64Packets;
+        ui64Drops = _ui64Drops;
+        _mStats.unlock();
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef NETSENSOR_TPacketV3Interface__INCLUDED
+#define NETSENSOR_TPacketV3Interface__INCLUDED
+/*
+* TPacketV3Interface.h
+* This file is part of the IHMC NetSensor Library/Component
+* Copyright (c) 2010-2017 IHMC.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 3 (GPLv3) as published by the Free Software Foundation.
+*
+* U.S. Government agencies and organizations may redistribute
+* and/or modify this program under terms equivalent to
+* "Government Purpose Rights" as defined by DFARS
+* 252.227-7014(a)(12) (February 2014).
+*
+* Alternative licenses that allow for use within commercial products may be
+* available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+*
+* Class that captures the packets of a network interface through an
+* AF_PACKET socket and a TPACKET_V3 receive ring shared with the kernel
+* (Linux only).
+*
+* The kernel fills the ring one block at a time.  nextFrame() returns a
+* pointer to a frame in the ring together with a reference to the block
+* that contains it, and the block is handed back to the kernel once the
+* capture thread has moved past it and every reference has been released.
+* Several TPacketV3Interfaces can be opened on the same device with the same
+* fanout group id: the kernel then spreads the packets among them by flow
+* hash, so that each one can be served by a different capture thread.
+*/
+#if defined (LINUX)
+
+#include "FTypes.h"
+#include "Mutex.h"
+#include "NetworkInterface.h"
+
+namespace IHMC_NETSENSOR
+{
+    class FrameBuffer;
+    class TPacketV3Block;
+    class TPacketV3Ring;
+
+    class TPacketV3Interface : public NetworkInterface
+    {
+    public:
+        static const uint32 DEFAULT_BLOCK_SIZE = 1U << 20;
+        static const uint32 DEFAULT_BLOCK_COUNT = 16;
+        static const uint32 DEFAULT_BLOCK_TIMEOUT_MS = 10;
+
+        // Returns nullptr if the ring could not be set up (for instance, if
+        // the process does not have the CAP_NET_RAW capability).
+        // If ui16FanoutGroupId is 0, the socket does not join any fanout group.
+        static TPacketV3Interface * const getTPacketV3Interface(const char * const pszDevice,
+                                                                uint16 ui16FanoutGroupId,
+                                                                uint32 ui32BlockSize = DEFAULT_BLOCK_SIZE,
+                                                                uint32 ui32BlockCount = DEFAULT_BLOCK_COUNT);
+
+        // Returns a fanout group id that is not used by other groups of this process
+        static uint16 newFanoutGroupId(void);
+
+        virtual ~TPacketV3Interface(void);
+
+        // Copies the next frame into pui8Buf
+        int readPacket(uint8 *pui8Buf, uint16 ui16BufSize, int64 *tus);
+
+        // Returns the length of the next frame and sets *ppui8Frame to point
+        // to it, without copying it.  The frame stays valid until the caller
+        // releases *ppFrameBuffer.
+        // Returns 0 if termination was requested, and a negative value in
+        // case of error.
+        int nextFrame(uint8 **ppui8Frame, int64 *tus, FrameBuffer **ppFrameBuffer);
+
+        // Number of packets received and dropped by the kernel since the
+        // interface was opened
+        void getStatistics(uint64 & ui64Packets, uint64 & ui64Drops);
+
+    private:
+        explicit TPacketV3Interface(const NOMADSUtil::String & sAdapterName);
+
+        int init(uint16 ui16FanoutGroupId, uint32 ui32BlockSize, uint32 ui32BlockCount);
+        void retrieveAndSetIPv4Addr(int iSocket);
+        void releaseCurrentBlock(void);
+
+    //<--------------------------------------------------------------------------->
+    private:
+        TPacketV3Ring  *_pRing;
+        TPacketV3Block *_pCurrentBlock;
+        uint8          *_pui8NextFrame;
+        uint32          _ui32CurrentBlock;
+        uint32          _ui32FramesLeft;
+        uint64          _ui64Packets;
+        uint64          _ui64Drops;
+        NOMADSUtil::Mutex _mStats;
+    };
+}
+
+#endif
+#endif
@@ -18,6 +18,8 @@
 */
 #include"TrafficTable.h"
 
+#include <vector>
+
 #define checkAndLogMsg if (pLogger) pLogger->logMsg
 
 using namespace NOMADSUtil;
@@ -28,43 +30,28 @@ void TrafficTable::cleanTable (uint32 ui32CleaningNumber)
 {
     auto pszMethodName = "TrafficTable::cleanTable";
     uint32 ui32CleaningCounter = 0;
+    std::vector<MicroflowNestedHashTable *> containers;
     if ((_pTMutex.lock() == NOMADSUtil::Mutex::RC_Ok)) {
-        if (_trafficTablesContainer.getCount() > 0) {
-            for (auto i = _trafficTablesContainer.getAllElements(); !i.end() && (ui32CleaningCounter < ui32CleaningNumber); i.nextElement()) {
-                auto pValue = i.getValue();
-                if (pValue != NULL) {
-                    ui32CleaningCounter += pValue->cleanTable2 (ui32CleaningNumber - ui32CleaningCounter);
-                }
+        for (auto i = _trafficTablesContainer.getAllElements(); !i.end(); i.nextElement()) {
+            auto pValue = i.getValue();
+            if (pValue != NULL) {
+                containers.push_back (pValue);
             }
         }
         _pTMutex.unlock();
     }
-}
-
-TrafficElement* TrafficTable::getNewTrafficElementIfNull (
-    MicroflowNestedHashTable* pTrafficElementsContainer,
-    const MicroflowId& microflowId)
-{
-	NOMADSUtil::String id = microflowId.sSA + ":" + microflowId.sDA + ":" + microflowId.sProtocol + ":" + microflowId.sSP + ":" + microflowId.sDP;
-    auto pTrafficElement = pTrafficElementsContainer->get (id);
-    if (pTrafficElement == nullptr) {
-        pTrafficElement = new TrafficElement (_uint32msResolution);
-        pTrafficElement->classification = microflowId.classification;
-		pTrafficElement->srcAddr		= microflowId.sSA;
-		pTrafficElement->dstAddr		= microflowId.sDA;
-		pTrafficElement->protocol		= microflowId.sProtocol;
-		pTrafficElement->srcPort		= microflowId.sSP;
-		pTrafficElement->dstPort		= microflowId.sDP;
-        pTrafficElementsContainer->put (id, pTrafficElement);
+    // The per-interface tables are never removed, so they can be cleaned
+    // without holding the mutex
+    for (auto iter = containers.begin(); (iter != containers.end()) && (ui32CleaningCounter < ui32CleaningNumber); iter++) {
+        ui32CleaningCounter += (*iter)->cleanTable2 (ui32CleaningNumber - ui32CleaningCounter);
     }
-    return pTrafficElement;
 }
 
 MicroflowNestedHashTable * TrafficTable::getTrafficElementsContainer (const char * pszInterfaceName)
 {
     auto pTrafficElementsContainer = _trafficTablesContainer.get (pszInterfaceName);
     if (pTrafficElementsContainer == NULL) {
-        pTrafficElementsContainer = new MicroflowNestedHashTable();
+        pTrafficElementsContainer = new MicroflowNestedHashTable (_uint32msResolution);
         _trafficTablesContainer.put (pszInterfaceName, pTrafficElementsContainer);
     }
     return pTrafficElementsContainer;
@@ -79,12 +66,8 @@ bool TrafficTable::lockedPut (const char * interfaceName, const MicroflowId & mi
     }
 
     auto pTrafficElementsContainer = getTrafficElementsContainer (interfaceName);
-    auto pTrafficElement = getNewTrafficElementIfNull (pTrafficElementsContainer, microflowId);
-    pTrafficElement->i64TimeOfLastChange = microflowId.i64CurrTime;
-    pTrafficElement->tiaPackets.add (1);
-    pTrafficElement->tiaTraffic.getAverage();
-    pTrafficElement->tiaTraffic.add (microflowId.ui32Size);
     _pTMutex.unlock();
+    pTrafficElementsContainer->update (microflowId);
     return true;
 }
 }
\ No newline at end of file
@@ -19,7 +19,9 @@
 * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
 *
 * This is the main traffic container, each element is indexed by 
-* interface name
+* interface name.  The mutex only protects the lookup of the per-interface
+* tables, that are never removed; the microflows are protected by the
+* striped locks of MicroflowNestedHashTable.
 *
 */
 
@@ -46,9 +48,6 @@ public:
     void printContent (void);
     TrafficTable (uint32 timeInterval);
 private:
-    TrafficElement * getNewTrafficElementIfNull(
-        MicroflowNestedHashTable * pTrafficElementsContainer,
-        const MicroflowId & microflowId);
     MicroflowNestedHashTable * getTrafficElementsContainer (const char * pszInterfaceName);
 //<--------------------------------------------------------------------------->
 private:
@@ -66,11 +65,11 @@ inline void TrafficTable::fillTrafficProtoObject (
     if ((_pTMutex.lock() == NOMADSUtil::Mutex::RC_Ok)) {
         //printf("Interface name: %s\n", pcIname);
         auto pMFWT = _trafficTablesContainer.get (pszIname);
+        _pTMutex.unlock();
         if (pMFWT != nullptr) {
             pMFWT->fillTrafficProto (pT);
             pT->set_monitoringinterface (pszInterfaceAddr);
         }
-        _pTMutex.unlock();
     }
 }
 
@@ -0,0 +1,242 @@
+/*
+* TrafficTableBenchmark.cpp
+* This file is part of the IHMC NetSensor Library/Component
+* Copyright (c) 2010-2017 IHMC.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* version 3 (GPLv3) as published by the Free Software Foundation.
+*
+* U.S. Government agencies and organizations may redistribute
+* and/or modify this program under terms equivalent to
+* "Government Purpose Rights" as defined by DFARS
+* 252.227-7014(a)(12) (February 2014).
+*
+* Alternative licenses that allow for use within commercial products may be
+* available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+*
+* Measures how many packets per second can be accounted in the traffic
+* tables.  The packets are read from a pcap file through the REPLAY MODE
+* of PCapInterface (without pacing), and then fed to the tables by one or
+* more threads, each one replaying a slice of the file.
+* The binary microflow keys and the striped TrafficTable are compared with
+* the string keys and the single mutex used by the previous implementation.
+*/
+
+#include "Logger.h"
+#include "MicroflowId.h"
+#include "Mutex.h"
+#include "NLFLib.h"
+#include "NetSensorUtilities.h"
+#include "NetworkHeaders.h"
+#include "PCapInterface.h"
+#include "StringHashtable.h"
+#include "TrafficElement.h"
+#include "TrafficTable.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+using namespace NOMADSUtil;
+using namespace IHMC_NETSENSOR;
+
+namespace IHMC_NETSENSOR_BENCHMARK
+{
+    const char * const C_INTERFACE_NAME = "replay";
+    const uint16 C_MAX_PACKET_SIZE = 9038U;
+
+    typedef std::vector<std::vector<uint8>> Packets;
+
+    // Traffic table keyed by "sa:da:protocol:sp:dp", as it used to be
+    class StringKeyTrafficTable
+    {
+    public:
+        StringKeyTrafficTable(void);
+        ~StringKeyTrafficTable(void);
+        void put(const MicroflowId & microflowId);
+
+    private:
+        StringHashtable<TrafficElement> _microflowTable;
+        Mutex _m;
+    };
+
+    StringKeyTrafficTable::StringKeyTrafficTable(void)
+        : _microflowTable(true, true, true, true)
+    {
+    }
+
+    StringKeyTrafficTable::~StringKeyTrafficTable(void)
+    {
+    }
+
+    void StringKeyTrafficTable::put(const MicroflowId & microflowId)
+    {
+        char tmpSP[8];
+        convertIntToString(microflowId.key.ui16SrcPort, tmpSP);
+        char tmpDP[8];
+        convertIntToString(microflowId.key.ui16DstPort, tmpDP);
+        const String sSA = InetAddr(microflowId.key.ui32SrcAddr).getIPAsString();
+        const String sDA = InetAddr(microflowId.key.ui32DstAddr).getIPAsString();
+        const String sProtocol = microflowId.key.getProtocolName();
+        const String id = sSA + ":" + sDA + ":" + sProtocol + ":" + tmpSP + ":" + tmpDP;
+
+        _m.lock();
+        auto pTrafficElement = _microflowTable.get(id);
+        if (pTrafficElement == nullptr) {
+            pTrafficElement = new TrafficElement(1000);
+            pTrafficElement->classification = microflowId.classification;
+            pTrafficElement->srcAddr = sSA;
+            pTrafficElement->dstAddr = sDA;
+            pTrafficElement->protocol = sProtocol;
+            pTrafficElement->srcPort = tmpSP;
+            pTrafficElement->dstPort = tmpDP;
+            _microflowTable.put(id, pTrafficElement);
+        }
+        pTrafficElement->i64TimeOfLastChange = microflowId.i64CurrTime;
+        pTrafficElement->tiaPackets.add(1);
+        pTrafficElement->tiaTraffic.getAverage();
+        pTrafficElement->tiaTraffic.add(microflowId.ui32Size);
+        _m.unlock();
+    }
+
+    // Same parsing done by HandlerThread::populateTrafficTables(), without
+    // converting the headers in place, so that the packets can be replayed
+    bool parse(const std::vector<uint8> & packet, MicroflowId & microflowId)
+    {
+        const uint32 ui32EthLen = sizeof(EtherFrameHeader);
+        if (packet.size() < ui32EthLen + 20) {
+            return false;
+        }
+        const uint8 *pui8Buf = packet.data();
+        if (((pui8Buf[12] << 8) | pui8Buf[13]) != ET_IP) {
+            return false;
+        }
+        const uint8 *pIP = pui8Buf + ui32EthLen;
+        const uint32 ui32IPHeaderLen = (pIP[0] & 0x0F) * 4;
+        uint16 ui16SrcPort = 0;
+        uint16 ui16DstPort = 0;
+        switch (pIP[9])
+        {
+        case IP_PROTO_UDP:
+        case IP_PROTO_TCP:
+            if (packet.size() < ui32EthLen + ui32IPHeaderLen + 4) {
+                return false;
+            }
+            ui16SrcPort = (pIP[ui32IPHeaderLen] << 8) | pIP[ui32IPHeaderLen + 1];
+            ui16DstPort = (pIP[ui32IPHeaderLen + 2] << 8) | pIP[ui32IPHeaderLen + 3];
+            break;
+        case IP_PROTO_ICMP:
+        case IP_PROTO_IGMP:
+            break;
+        default:
+            return false;
+        }
+        uint32 ui32SrcAddr, ui32DstAddr;
+        memcpy(&ui32SrcAddr, pIP + 12, sizeof(uint32));
+        memcpy(&ui32DstAddr, pIP + 16, sizeof(uint32));
+        microflowId.key = MicroflowKey(ui32SrcAddr, ui32DstAddr, ui16SrcPort, ui16DstPort, pIP[9]);
+        microflowId.ui32Size = static_cast<uint32>(packet.size());
+        microflowId.i64CurrTime = getTimeInMilliseconds();
+        return true;
+    }
+
+    int loadPackets(const char *pszPcapFile, Packets & packets)
+    {
+        EtherMACAddr emac;
+        memset(&emac, 0, sizeof(emac));
+        PCapInterface *pPCapInterface = PCapInterface::getPCapInterface(C_INTERFACE_NAME, pszPcapFile,
+                                                                        0, 0, 0, emac);
+        if (pPCapInterface == nullptr) {
+            return -1;
+        }
+        pPCapInterface->disableReplayPacing();
+        uint8 ui8Buf[C_MAX_PACKET_SIZE];
+        int64 i64TimeStamp;
+        int rc;
+        while ((rc = pPCapInterface->readPacket(ui8Buf, C_MAX_PACKET_SIZE, &i64TimeStamp)) > 0) {
+            packets.push_back(std::vector<uint8>(ui8Buf, ui8Buf + rc));
+        }
+        delete pPCapInterface;
+        return (rc < 0) ? -2 : 0;
+    }
+
+    template <class Fn> double replay(const Packets & packets, unsigned int uiThreads,
+                                      unsigned int uiIterations, Fn put)
+    {
+        std::vector<std::thread> threads;
+        const size_t slice = (packets.size() + uiThreads - 1) / uiThreads;
+        int64 i64Start = getTimeInMilliseconds();
+        for (unsigned int t = 0; t < uiThreads; t++) {
+            threads.push_back(std::thread([&packets, &put, t, slice, uiIterations]() {
+                const size_t end = minimum(static_cast<uint64>((t + 1) * slice),
+                                           static_cast<uint64>(packets.size()));
+                MicroflowId microflowId;
+                for (unsigned int i = 0; i < uiIterations; i++) {
+                    for (size_t j = t * slice; j < end; j++) {
+                        if (parse(packets[j], microflowId)) {
+                            put(microflowId);
+                        }
+                    }
+                }
+            }));
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        int64 i64Elapsed = getTimeInMilliseconds() - i64Start;
+        if (i64Elapsed <= 0) {
+            i64Elapsed = 1;
+        }
+        return (static_cast<double>(packets.size()) * uiIterations * 1000.0) / i64Elapsed;
+    }
+}
+
+using namespace IHMC_NETSENSOR_BENCHMARK;
+
+int main(int argc, char * argv[])
+{
+    pLogger = new Logger();
+    pLogger->enableScreenOutput();
+    pLogger->setDebugLevel(Logger::L_MildError);
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <pcapFile> [<maxThreads> [<iterations>]]\n", argv[0]);
+        return -1;
+    }
+    const unsigned int uiMaxThreads = (argc > 2) ? atoui32(argv[2]) : 4;
+    const unsigned int uiIterations = (argc > 3) ? atoui32(argv[3]) : 10;
+    if ((uiMaxThreads == 0) || (uiIterations == 0)) {
+        fprintf(stderr, "the number of threads and iterations must be greater than 0\n");
+        return -2;
+    }
+
+    Packets packets;
+    if (loadPackets(argv[1], packets) < 0) {
+        fprintf(stderr, "failed to replay %s\n", argv[1]);
+        return -3;
+    }
+    if (packets.empty()) {
+        fprintf(stderr, "%s does not contain any packet\n", argv[1]);
+        return -4;
+    }
+    printf("%u packets, %u iterations\n", static_cast<unsigned int>(packets.size()), uiIterations);
+    printf("%7s | %14s | %14s | %7s\n", "threads", "string pps", "binary pps", "speedup");
+
+    for (unsigned int uiThreads = 1; uiThreads <= uiMaxThreads; uiThreads *= 2) {
+        StringKeyTrafficTable stringKeyTable;
+        const double dStringPPS = replay(packets, uiThreads, uiIterations, [&stringKeyTable](const MicroflowId & microflowId) {
+            stringKeyTable.put(microflowId);
+        });
+
+        TrafficTable trafficTable(1000);
+        const double dBinaryPPS = replay(packets, uiThreads, uiIterations, [&trafficTable](const MicroflowId & microflowId) {
+            trafficTable.lockedPut(C_INTERFACE_NAME, microflowId);
+        });
+
+        printf("%7u | %14.0f | %14.0f | %6.2fx\n", uiThreads, dStringPPS, dBinaryPPS, dBinaryPPS / dStringPPS);
+    }
+    return 0;
+}
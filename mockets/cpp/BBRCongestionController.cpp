@@ -0,0 +1,320 @@
+/*
+ * BBRCongestionController.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "BBRCongestionController.h"
+
+#include "Logger.h"
+#include "NLFLib.h"
+#include "Transmitter.h"
+
+
+using namespace NOMADSUtil;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+// 2/ln(2): the smallest gain that allows the sending rate to double every round trip during startup
+static const float HIGH_GAIN = 2.885f;
+static const float DRAIN_GAIN = 1.0f / 2.885f;
+static const float CWND_GAIN = 2.0f;
+static const float FULL_BANDWIDTH_GROWTH = 1.25f;
+
+// Gains used in turn (one per round trip) while probing for more bandwidth
+static const float PACING_GAIN_CYCLE[BBRCongestionController::PACING_GAIN_CYCLE_LENGTH] = {1.25f, 0.75f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+
+BBRCongestionController::BBRCongestionController (Mocket *pMocket)
+{
+    _pMocket = pMocket;
+    _ui16MTU = _pMocket->getMTU();
+
+    int64 i64CurrTime = getTimeInMilliseconds();
+    _mode = M_Startup;
+    resetBandwidthFilter();
+    _ui32MinRTT = 0;
+    _i64MinRTTTimestamp = i64CurrTime;
+    _ui32ProbeRTTMinRTT = 0;
+    _i64ProbeRTTDoneTime = 0;
+    _ui8CyclePhase = 0;
+    _ui32CongestionWindowSize = 0;
+    _ui32PacingRate = 0;
+    updateControlParameters();
+
+    checkAndLogMsg ("BBRCongestionController::BBRCongestionController", Logger::L_MediumDetailDebug,
+                    "created a new instance of BBRCongestionController\n");
+}
+
+BBRCongestionController::~BBRCongestionController (void)
+{
+}
+
+void BBRCongestionController::update (void)
+{
+    _m.lock();
+    updateMode (getTimeInMilliseconds());
+    updateControlParameters();
+    _m.unlock();
+}
+
+void BBRCongestionController::addDeliveryRateSample (const DeliveryRateSample &sample)
+{
+    _m.lock();
+    // The round ends when a packet sent after the start of the round is acknowledged,
+    // that is, when the packet was sent after _ui64NextRoundDelivered bytes had been delivered
+    bool bNewRound = false;
+    if (sample.ui64PriorDelivered >= _ui64NextRoundDelivered) {
+        _ui64NextRoundDelivered = sample.ui64Delivered;
+        startNewRound();
+        bNewRound = true;
+    }
+
+    uint32 *pui32RoundMax = &_aui32RoundMaxBandwidth[_ui32RoundCount % BTLBW_FILTER_ROUNDS];
+    if (sample.ui32DeliveryRate > *pui32RoundMax) {
+        *pui32RoundMax = sample.ui32DeliveryRate;
+    }
+    _ui32BottleneckBandwidth = 0;
+    for (uint8 ui8 = 0; ui8 < BTLBW_FILTER_ROUNDS; ui8++) {
+        if (_aui32RoundMaxBandwidth[ui8] > _ui32BottleneckBandwidth) {
+            _ui32BottleneckBandwidth = _aui32RoundMaxBandwidth[ui8];
+        }
+    }
+
+    if (bNewRound) {
+        checkFullBandwidth();
+        if (_mode == M_ProbeBW) {
+            // Each gain of the cycle is used for one round trip
+            _ui8CyclePhase = (_ui8CyclePhase + 1) % PACING_GAIN_CYCLE_LENGTH;
+        }
+    }
+    _m.unlock();
+}
+
+uint32 BBRCongestionController::adaptToCongestionWindow (uint32 ui32SpaceAvailable)
+{
+    _m.lock();
+    // While probing the RTT few (or no) acknowledgements are received, so the end of
+    // the probe must also be checked when the transmitter is about to send
+    if (_mode == M_ProbeRTT) {
+        updateMode (getTimeInMilliseconds());
+        updateControlParameters();
+    }
+    uint32 ui32CongestionWindowSize = _ui32CongestionWindowSize;
+    _m.unlock();
+    return NOMADSUtil::minimum (ui32SpaceAvailable, ui32CongestionWindowSize);
+}
+
+void BBRCongestionController::reactToLosses (uint8 ui8Code)
+{
+    // Losses are not interpreted as a sign of congestion - the model is updated by the
+    // bandwidth and RTT samples. However, repeated timeouts (code 0) suggest that the path
+    // has changed, so the bandwidth model is discarded and rebuilt starting from scratch.
+    if (ui8Code != 0) {
+        return;
+    }
+    _m.lock();
+    checkAndLogMsg ("BBRCongestionController::reactToLosses", Logger::L_LowDetailDebug,
+                    "repeated timeouts - resetting the bandwidth model (bottleneck bandwidth was %u B/s)\n",
+                    _ui32BottleneckBandwidth);
+    resetBandwidthFilter();
+    _mode = M_Startup;
+    updateControlParameters();
+    _m.unlock();
+}
+
+void BBRCongestionController::addRTTSample (uint32 ui32RTT)
+{
+    if (ui32RTT == 0) {
+        ui32RTT = 1;
+    }
+    _m.lock();
+    if (_mode == M_ProbeRTT) {
+        if ((_ui32ProbeRTTMinRTT == 0) || (ui32RTT < _ui32ProbeRTTMinRTT)) {
+            _ui32ProbeRTTMinRTT = ui32RTT;
+        }
+    }
+    if ((_ui32MinRTT == 0) || (ui32RTT <= _ui32MinRTT)) {
+        _ui32MinRTT = ui32RTT;
+        _i64MinRTTTimestamp = getTimeInMilliseconds();
+    }
+    _m.unlock();
+}
+
+uint32 BBRCongestionController::getRoundTripTime (void)
+{
+    // The receiver delays the SAcks by up to the SAck transmit timeout, so the window
+    // must also cover the data sent while waiting for the acknowledgement
+    uint32 ui32RTT = (_ui32MinRTT == 0) ? _pMocket->getInitialAssumedRTT() : _ui32MinRTT;
+    return ui32RTT + _pMocket->getSAckTransmitTimeout();
+}
+
+void BBRCongestionController::startNewRound (void)
+{
+    _ui32RoundCount++;
+    _aui32RoundMaxBandwidth[_ui32RoundCount % BTLBW_FILTER_ROUNDS] = 0;
+}
+
+uint32 BBRCongestionController::getBandwidthDelayProduct (void)
+{
+    return (uint32) (((uint64) _ui32BottleneckBandwidth * getRoundTripTime()) / 1000);
+}
+
+uint32 BBRCongestionController::getBytesInFlight (void)
+{
+    return _pMocket->getTransmitter()->getUnacknowledgedDataSize();
+}
+
+void BBRCongestionController::checkFullBandwidth (void)
+{
+    // The pipe is considered full when the bottleneck bandwidth
+    // does not grow by 25% for FULL_BANDWIDTH_ROUNDS rounds
+    if ((_bFullBandwidthReached) || (_ui32BottleneckBandwidth == 0)) {
+        return;
+    }
+    if (_ui32BottleneckBandwidth >= (uint32) (_ui32FullBandwidth * FULL_BANDWIDTH_GROWTH)) {
+        _ui32FullBandwidth = _ui32BottleneckBandwidth;
+        _ui8FullBandwidthRounds = 0;
+        return;
+    }
+    _ui8FullBandwidthRounds++;
+    if (_ui8FullBandwidthRounds >= FULL_BANDWIDTH_ROUNDS) {
+        _bFullBandwidthReached = true;
+        checkAndLogMsg ("BBRCongestionController::checkFullBandwidth", Logger::L_LowDetailDebug,
+                        "bottleneck bandwidth of %u B/s reached\n", _ui32BottleneckBandwidth);
+    }
+}
+
+void BBRCongestionController::updateMode (int64 i64CurrTime)
+{
+    switch (_mode) {
+        case M_Startup:
+            if (_bFullBandwidthReached) {
+                _mode = M_Drain;
+            }
+            break;
+
+        case M_Drain:
+            if (getBytesInFlight() <= getBandwidthDelayProduct()) {
+                enterProbeBW (i64CurrTime);
+            }
+            break;
+
+        case M_ProbeBW:
+            // The phase of the gain cycle is advanced at the start of each round
+            break;
+
+        case M_ProbeRTT:
+            if ((_i64ProbeRTTDoneTime == 0) && (getBytesInFlight() <= (uint32) (MIN_CWND_SEGMENTS * _ui16MTU))) {
+                _i64ProbeRTTDoneTime = i64CurrTime + NOMADSUtil::maximum (PROBE_RTT_DURATION, getRoundTripTime());
+            }
+            else if ((_i64ProbeRTTDoneTime != 0) && (i64CurrTime >= _i64ProbeRTTDoneTime)) {
+                // The minimum RTT observed while probing replaces the old one, which may be stale
+                if (_ui32ProbeRTTMinRTT != 0) {
+                    _ui32MinRTT = _ui32ProbeRTTMinRTT;
+                }
+                _i64MinRTTTimestamp = i64CurrTime;
+                if (_bFullBandwidthReached) {
+                    enterProbeBW (i64CurrTime);
+                }
+                else {
+                    _mode = M_Startup;
+                }
+            }
+            return;
+    }
+
+    if ((i64CurrTime - _i64MinRTTTimestamp) > (int64) MIN_RTT_FILTER_LENGTH) {
+        // The minimum RTT has not been refreshed in a while - drain the queues
+        // along the path to measure the round-trip propagation time again
+        checkAndLogMsg ("BBRCongestionController::updateMode", Logger::L_MediumDetailDebug,
+                        "minimum RTT of %u ms expired - probing RTT\n", _ui32MinRTT);
+        _mode = M_ProbeRTT;
+        _ui32ProbeRTTMinRTT = 0;
+        _i64ProbeRTTDoneTime = 0;
+    }
+}
+
+void BBRCongestionController::enterProbeBW (int64 i64CurrTime)
+{
+    _mode = M_ProbeBW;
+    // Start from a random phase other than the one that drains the queue
+    _ui8CyclePhase = (uint8) ((rand() % (PACING_GAIN_CYCLE_LENGTH - 1)) + 2) % PACING_GAIN_CYCLE_LENGTH;
+}
+
+void BBRCongestionController::updateControlParameters (void)
+{
+    switch (_mode) {
+        case M_Startup:
+            _fPacingGain = HIGH_GAIN;
+            _fCwndGain = HIGH_GAIN;
+            break;
+
+        case M_Drain:
+            _fPacingGain = DRAIN_GAIN;
+            _fCwndGain = HIGH_GAIN;
+            break;
+
+        case M_ProbeBW:
+            _fPacingGain = PACING_GAIN_CYCLE[_ui8CyclePhase];
+            _fCwndGain = CWND_GAIN;
+            break;
+
+        case M_ProbeRTT:
+            _fPacingGain = 1.0f;
+            _fCwndGain = 1.0f;
+            break;
+    }
+
+    const uint32 ui32MinCongestionWindowSize = MIN_CWND_SEGMENTS * _ui16MTU;
+    if (_ui32BottleneckBandwidth == 0) {
+        // No bandwidth estimate yet - send the initial window at a high rate
+        _ui32CongestionWindowSize = INITIAL_CWND_SEGMENTS * _ui16MTU;
+        _ui32PacingRate = (uint32) (_fPacingGain * _ui32CongestionWindowSize * 1000 / getRoundTripTime());
+    }
+    else {
+        _ui32CongestionWindowSize = (uint32) (_fCwndGain * getBandwidthDelayProduct());
+        if ((_mode == M_Startup) && (_ui32CongestionWindowSize < (uint32) (INITIAL_CWND_SEGMENTS * _ui16MTU))) {
+            _ui32CongestionWindowSize = INITIAL_CWND_SEGMENTS * _ui16MTU;
+        }
+        _ui32PacingRate = (uint32) (_fPacingGain * _ui32BottleneckBandwidth);
+    }
+    if ((_mode == M_ProbeRTT) || (_ui32CongestionWindowSize < ui32MinCongestionWindowSize)) {
+        _ui32CongestionWindowSize = ui32MinCongestionWindowSize;
+    }
+    if (_ui32PacingRate == 0) {
+        // A rate limit of 0 would disable pacing altogether
+        _ui32PacingRate = 1;
+    }
+
+    Transmitter *pTransmitter = _pMocket->getTransmitter();
+    if (pTransmitter->getTransmitRateLimit() != _ui32PacingRate) {
+        pTransmitter->setTransmitRateLimit (_ui32PacingRate);
+    }
+    updateStatistics (_ui32CongestionWindowSize, _ui32PacingRate, _ui32MinRTT);
+}
+
+void BBRCongestionController::resetBandwidthFilter (void)
+{
+    for (uint8 ui8 = 0; ui8 < BTLBW_FILTER_ROUNDS; ui8++) {
+        _aui32RoundMaxBandwidth[ui8] = 0;
+    }
+    _ui32BottleneckBandwidth = 0;
+    _ui32RoundCount = 0;
+    _ui64NextRoundDelivered = 0;
+    _ui32FullBandwidth = 0;
+    _ui8FullBandwidthRounds = 0;
+    _bFullBandwidthReached = false;
+}
@@ -0,0 +1,112 @@
+#ifndef INCL_BBR_CONGESTION_CONTROLLER_H
+#define INCL_BBR_CONGESTION_CONTROLLER_H
+
+/*
+ * BBRCongestionController.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Delivery-rate based congestion control, modeled after BBR.
+ * The controller keeps a model of the path made of the bottleneck bandwidth
+ * (the maximum of the delivery rate samples computed by the Transmitter for
+ * each SAck over the last BTLBW_FILTER_ROUNDS round trips) and of the round-trip
+ * propagation time (the minimum RTT sample over the last MIN_RTT_FILTER_LENGTH
+ * milliseconds).
+ * A round trip ends when a packet sent after the start of the round is
+ * acknowledged, which is detected by comparing the delivered count of the
+ * samples (see DeliveryRateEstimator).
+ * The transmit rate limit of the Transmitter is used to pace the packets at
+ * a multiple of the bottleneck bandwidth, while the congestion window is set
+ * to a multiple of the bandwidth-delay product.
+ * Packet losses are not used as a congestion signal, so the sending rate does
+ * not collapse on links that lose packets for reasons other than congestion.
+ */
+
+#include "CongestionControl.h"
+#include "FTypes.h"
+#include "Mocket.h"
+#include "Mutex.h"
+
+
+class BBRCongestionController : public CongestionControl
+{
+    public:
+        BBRCongestionController (Mocket *pMocket);
+        ~BBRCongestionController (void);
+
+        void update (void);
+        uint32 adaptToCongestionWindow (uint32 ui32SpaceAvailable);
+        void reactToLosses (uint8 ui8Code);
+        void addRTTSample (uint32 ui32RTT);
+        void addDeliveryRateSample (const DeliveryRateSample &sample);
+
+        static const uint8 BTLBW_FILTER_ROUNDS = 10;
+        static const uint32 MIN_RTT_FILTER_LENGTH = 10000;  // Milliseconds
+        static const uint32 PROBE_RTT_DURATION = 200;       // Milliseconds
+        static const uint8 INITIAL_CWND_SEGMENTS = 10;
+        static const uint8 MIN_CWND_SEGMENTS = 4;
+        static const uint8 FULL_BANDWIDTH_ROUNDS = 3;
+        static const uint8 PACING_GAIN_CYCLE_LENGTH = 8;
+
+    private:
+        enum Mode {
+            M_Startup,
+            M_Drain,
+            M_ProbeBW,
+            M_ProbeRTT
+        };
+
+        uint32 getRoundTripTime (void);
+        void startNewRound (void);
+        uint32 getBandwidthDelayProduct (void);
+        uint32 getBytesInFlight (void);
+        void checkFullBandwidth (void);
+        void updateMode (int64 i64CurrTime);
+        void enterProbeBW (int64 i64CurrTime);
+        void updateControlParameters (void);
+        void resetBandwidthFilter (void);
+
+    private:
+        NOMADSUtil::Mutex _m;
+        Mode _mode;
+        uint16 _ui16MTU;
+
+        // Windowed maximum of the bandwidth estimates (in bytes per second)
+        uint32 _aui32RoundMaxBandwidth[BTLBW_FILTER_ROUNDS];
+        uint32 _ui32BottleneckBandwidth;
+        uint32 _ui32RoundCount;
+        uint64 _ui64NextRoundDelivered;         // Delivered count at which the current round ends
+
+        // Windowed minimum of the RTT samples (in milliseconds)
+        uint32 _ui32MinRTT;
+        int64 _i64MinRTTTimestamp;
+        uint32 _ui32ProbeRTTMinRTT;
+        int64 _i64ProbeRTTDoneTime;
+
+        // Detection of the bottleneck bandwidth during startup
+        uint32 _ui32FullBandwidth;
+        uint8 _ui8FullBandwidthRounds;
+        bool _bFullBandwidthReached;
+
+        uint8 _ui8CyclePhase;
+
+        float _fPacingGain;
+        float _fCwndGain;
+        uint32 _ui32CongestionWindowSize;
+        uint32 _ui32PacingRate;
+};
+
+#endif   // #ifndef INCL_BBR_CONGESTION_CONTROLLER_H
@@ -23,3 +23,44 @@
 CommInterface::~CommInterface (void)
 {
 }
+
+int CommInterface::getLocalSocket (void)
+{
+    return -1;
+}
+
+bool CommInterface::isBatchIOSupported (void)
+{
+    return false;
+}
+
+int CommInterface::enableTransmitTime (void)
+{
+    return -1;
+}
+
+int CommInterface::sendBatch (Datagram *pDatagrams, uint16 ui16Count, const char *pszHints)
+{
+    int iSent = 0;
+    for (uint16 ui16 = 0; ui16 < ui16Count; ui16++) {
+        int rc = sendTo (&pDatagrams[ui16].remoteAddr, pDatagrams[ui16].pBuf, pDatagrams[ui16].iBufSize, pszHints);
+        if (rc < 0) {
+            return (iSent > 0) ? iSent : rc;
+        }
+        iSent++;
+    }
+    return iSent;
+}
+
+int CommInterface::receiveBatch (Datagram *pDatagrams, uint16 ui16Count)
+{
+    if (ui16Count == 0) {
+        return 0;
+    }
+    int rc = receive (pDatagrams[0].pBuf, pDatagrams[0].iBufSize, &pDatagrams[0].remoteAddr);
+    if (rc <= 0) {
+        return rc;
+    }
+    pDatagrams[0].iDataSize = rc;
+    return 1;
+}
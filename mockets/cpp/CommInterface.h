@@ -27,6 +27,19 @@
 class CommInterface
 {
     public:
+        // Describes one datagram for sendBatch() and receiveBatch()
+        struct Datagram
+        {
+            Datagram (void);
+
+            void *pBuf;
+            int iBufSize;       // For sendBatch(), the size of the datagram; for receiveBatch(), the size of the buffer
+            int iDataSize;      // Set by receiveBatch() to the size of the received datagram
+            int64 i64TransmitTime;  // For sendBatch(), the monotonic time (in nanoseconds) at which the datagram should
+                                    // leave the host, or 0 to send it right away - see enableTransmitTime()
+            NOMADSUtil::InetAddr remoteAddr;
+        };
+
         virtual ~CommInterface (void);
 
         virtual CommInterface * newInstance (void) = 0;
@@ -43,6 +56,39 @@ class CommInterface
         virtual int receive (void *pBuf, int iBufSize, NOMADSUtil::InetAddr *pRemoteAddr) = 0;
         virtual int getLastError (void) = 0;
         virtual int isRecoverableSocketError (void) = 0;
+
+        // Returns the file descriptor of the underlying socket, or a negative value if the
+        // CommInterface is not backed by a socket that can be polled directly
+        virtual int getLocalSocket (void);
+
+        // Returns true if sendBatch() and receiveBatch() move several datagrams with a single system call
+        virtual bool isBatchIOSupported (void);
+
+        // Asks the kernel to hold each datagram passed to sendBatch() until its transmit time (SO_TXTIME)
+        // The transmit times are only honored if the interface uses a scheduler that supports them (e.g., fq)
+        // Returns 0 if successful or a negative value if transmit times are not supported
+        // The default implementation returns -1
+        virtual int enableTransmitTime (void);
+
+        // Sends ui16Count datagrams
+        // Returns the number of datagrams that were sent, which may be less than ui16Count if an error occurred
+        // after sending some of them, or a negative value if no datagram could be sent
+        // The default implementation invokes sendTo() once for each datagram
+        virtual int sendBatch (Datagram *pDatagrams, uint16 ui16Count, const char *pszHints = nullptr);
+
+        // Receives up to ui16Count datagrams
+        // Waits (subject to the receive timeout) for the first datagram, and then returns the datagrams that are already available
+        // Returns the number of datagrams received, 0 if the receive timed out, or a negative value in case of error
+        // The default implementation invokes receive() once
+        virtual int receiveBatch (Datagram *pDatagrams, uint16 ui16Count);
 };
 
+inline CommInterface::Datagram::Datagram (void)
+{
+    pBuf = nullptr;
+    iBufSize = 0;
+    iDataSize = 0;
+    i64TransmitTime = 0;
+}
+
 #endif   // #ifndef INCL_COMM_INTERFACE_H
@@ -20,7 +20,9 @@
  * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
  */
 
+#include "DeliveryRateEstimator.h"
 #include "Mocket.h"
+#include "MocketStats.h"
 
 
 class CongestionControl
@@ -28,11 +30,23 @@ class CongestionControl
     public :
         CongestionControl (void);
         CongestionControl (Mocket *pMocket);
+        virtual ~CongestionControl (void);
         virtual void update (void) =0;
         virtual uint32 adaptToCongestionWindow (uint32 ui32SpaceAvailable);
         virtual void reactToLosses (uint8 ui8Code);
 
+        // Invoked by the Transmitter for each new RTT sample (in milliseconds), obtained
+        // either from a timestamp acknowledgement or from the minimum ack time of a SAck
+        virtual void addRTTSample (uint32 ui32RTT);
+
+        // Invoked by the Transmitter, before update(), when a SAck acknowledges new packets
+        virtual void addDeliveryRateSample (const DeliveryRateSample &sample);
+
     protected:
+        // Exports the state of the congestion control mechanism through MocketStats
+        // The pacing rate is in bytes per second, the congestion window in bytes, and the minimum RTT in milliseconds
+        void updateStatistics (uint32 ui32CongestionWindowSize, uint32 ui32PacingRate, uint32 ui32MinRTT);
+
         Mocket *_pMocket;
 
 };
@@ -47,6 +61,10 @@ inline CongestionControl::CongestionControl (Mocket *pMocket)
     _pMocket = pMocket;
 }
 
+inline CongestionControl::~CongestionControl (void)
+{
+}
+
 inline uint32 CongestionControl::adaptToCongestionWindow (uint32 ui32SpaceAvailable)
 {
     return ui32SpaceAvailable;
@@ -57,4 +75,22 @@ inline void CongestionControl::reactToLosses (uint8 ui8Code)
     return;
 }
 
+inline void CongestionControl::addRTTSample (uint32 ui32RTT)
+{
+    return;
+}
+
+inline void CongestionControl::addDeliveryRateSample (const DeliveryRateSample &sample)
+{
+    return;
+}
+
+inline void CongestionControl::updateStatistics (uint32 ui32CongestionWindowSize, uint32 ui32PacingRate, uint32 ui32MinRTT)
+{
+    MocketStats *pStats = _pMocket->getStatistics();
+    pStats->_ui32CongestionWindowSize = ui32CongestionWindowSize;
+    pStats->_ui32PacingRate = ui32PacingRate;
+    pStats->_ui32MinRTT = ui32MinRTT;
+}
+
 #endif    /* _CONGESTION_CONTROL_H */
@@ -0,0 +1,188 @@
+/*
+ * CubicCongestionController.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "CubicCongestionController.h"
+
+#include "Logger.h"
+#include "NLFLib.h"
+#include "Transmitter.h"
+
+#include <math.h>
+
+
+using namespace NOMADSUtil;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+// Multiplicative decrease factor and scaling constant of the cubic function (RFC 8312)
+static const double CUBIC_BETA = 0.7;
+static const double CUBIC_C = 0.4;
+
+CubicCongestionController::CubicCongestionController (Mocket *pMocket)
+{
+    _pMocket = pMocket;
+    _ui16MTU = _pMocket->getMTU();
+
+    _ui32CongestionWindowSize = INITIAL_CWND_SEGMENTS * _ui16MTU;
+    _ui32SlowStartThreshold = 0xFFFFFFFFUL;
+    _dWMax = 0.0;
+    _dWLastMax = 0.0;
+    _dK = 0.0;
+    _dWEst = 0.0;
+    _i64EpochStart = 0;
+    _i64LastReductionTime = 0;
+    _ui32MinRTT = 0;
+
+    exportState();
+    checkAndLogMsg ("CubicCongestionController::CubicCongestionController", Logger::L_MediumDetailDebug,
+                    "created a new instance of CubicCongestionController\n");
+}
+
+CubicCongestionController::~CubicCongestionController (void)
+{
+}
+
+void CubicCongestionController::update (void)
+{
+    uint16 ui16AcknowledgedPackets = _pMocket->getTransmitter()->getNumberOfAcknowledgedPackets();
+    if (ui16AcknowledgedPackets == 0) {
+        return;
+    }
+    _m.lock();
+    if (_ui32CongestionWindowSize < _ui32SlowStartThreshold) {
+        // Slow start: increase the window by 1 MTU for every acknowledged packet
+        _ui32CongestionWindowSize += ui16AcknowledgedPackets * _ui16MTU;
+    }
+    else {
+        int64 i64CurrTime = getTimeInMilliseconds();
+        double dCwnd = ((double) _ui32CongestionWindowSize) / _ui16MTU;
+        if (_i64EpochStart == 0) {
+            _i64EpochStart = i64CurrTime;
+            if (dCwnd < _dWMax) {
+                _dK = pow ((_dWMax - dCwnd) / CUBIC_C, 1.0 / 3.0);
+            }
+            else {
+                _dK = 0.0;
+                _dWMax = dCwnd;
+            }
+            _dWEst = dCwnd;
+        }
+
+        // Target window one RTT from now
+        double dRTT = _pMocket->getStatistics()->getEstimatedRTT();
+        if (dRTT < 1.0) {
+            dRTT = 1.0;
+        }
+        double dT = ((double) (i64CurrTime - _i64EpochStart) + dRTT) / 1000.0;
+        double dTarget = CUBIC_C * pow (dT - _dK, 3.0) + _dWMax;
+
+        // Window that a standard AIMD controller would have reached (TCP-friendly region)
+        _dWEst += (3.0 * (1.0 - CUBIC_BETA) / (1.0 + CUBIC_BETA)) * ui16AcknowledgedPackets / dCwnd;
+        if (dTarget < _dWEst) {
+            dTarget = _dWEst;
+        }
+        if (dTarget > 1.5 * dCwnd) {
+            dTarget = 1.5 * dCwnd;
+        }
+
+        double dIncrement;
+        if (dTarget > dCwnd) {
+            dIncrement = ui16AcknowledgedPackets * (dTarget - dCwnd) / dCwnd;
+        }
+        else {
+            dIncrement = ui16AcknowledgedPackets / (100.0 * dCwnd);
+        }
+        _ui32CongestionWindowSize += (uint32) (dIncrement * _ui16MTU);
+    }
+    if (_ui32CongestionWindowSize > MAX_CWND_SIZE) {
+        _ui32CongestionWindowSize = MAX_CWND_SIZE;
+    }
+    exportState();
+    _m.unlock();
+}
+
+uint32 CubicCongestionController::adaptToCongestionWindow (uint32 ui32SpaceAvailable)
+{
+    return NOMADSUtil::minimum (ui32SpaceAvailable, _ui32CongestionWindowSize);
+}
+
+void CubicCongestionController::reactToLosses (uint8 ui8Code)
+{
+    _m.lock();
+    int64 i64CurrTime = getTimeInMilliseconds();
+    if (ui8Code == 0) {
+        // Repeated timeouts: the window is reduced and slow start begins again
+        reduceCongestionWindow();
+        _ui32CongestionWindowSize = MIN_CWND_SEGMENTS * _ui16MTU;
+        _i64LastReductionTime = i64CurrTime;
+    }
+    else if ((i64CurrTime - _i64LastReductionTime) > (int64) _pMocket->getStatistics()->getEstimatedRTT()) {
+        // Reduce the window at most once per RTT, since the losses in the same window are likely to be caused by the same congestion event
+        reduceCongestionWindow();
+        _i64LastReductionTime = i64CurrTime;
+    }
+    exportState();
+    _m.unlock();
+}
+
+void CubicCongestionController::addRTTSample (uint32 ui32RTT)
+{
+    if (ui32RTT == 0) {
+        ui32RTT = 1;
+    }
+    _m.lock();
+    if ((_ui32MinRTT == 0) || (ui32RTT < _ui32MinRTT)) {
+        _ui32MinRTT = ui32RTT;
+    }
+    _m.unlock();
+}
+
+void CubicCongestionController::reduceCongestionWindow (void)
+{
+    double dCwnd = ((double) _ui32CongestionWindowSize) / _ui16MTU;
+    // Fast convergence: release bandwidth to new flows if the window did not recover to the previous maximum
+    if (dCwnd < _dWLastMax) {
+        _dWLastMax = dCwnd;
+        _dWMax = dCwnd * (1.0 + CUBIC_BETA) / 2.0;
+    }
+    else {
+        _dWLastMax = dCwnd;
+        _dWMax = dCwnd;
+    }
+    _ui32CongestionWindowSize = (uint32) (_ui32CongestionWindowSize * CUBIC_BETA);
+    if (_ui32CongestionWindowSize < (uint32) (MIN_CWND_SEGMENTS * _ui16MTU)) {
+        _ui32CongestionWindowSize = MIN_CWND_SEGMENTS * _ui16MTU;
+    }
+    _ui32SlowStartThreshold = _ui32CongestionWindowSize;
+    _i64EpochStart = 0;
+    checkAndLogMsg ("CubicCongestionController::reduceCongestionWindow", Logger::L_MediumDetailDebug,
+                    "congestion window reduced to %u bytes; W_max is %.2f segments\n",
+                    _ui32CongestionWindowSize, _dWMax);
+}
+
+void CubicCongestionController::exportState (void)
+{
+    // CUBIC does not pace: report the rate implied by the window and the smoothed RTT
+    float fRTT = _pMocket->getStatistics()->getEstimatedRTT();
+    uint32 ui32PacingRate = 0;
+    if (fRTT >= 1.0f) {
+        ui32PacingRate = (uint32) (_ui32CongestionWindowSize * 1000.0f / fRTT);
+    }
+    updateStatistics (_ui32CongestionWindowSize, ui32PacingRate, _ui32MinRTT);
+}
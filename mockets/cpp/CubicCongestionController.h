@@ -0,0 +1,72 @@
+#ifndef INCL_CUBIC_CONGESTION_CONTROLLER_H
+#define INCL_CUBIC_CONGESTION_CONTROLLER_H
+
+/*
+ * CubicCongestionController.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Window-based congestion control following CUBIC (RFC 8312).
+ * After a loss, the congestion window grows as a cubic function of the time
+ * elapsed since the last reduction, centered on the window size at which the
+ * loss occurred, so that growth does not depend on the RTT of the connection.
+ * The window never grows slower than the one of a standard AIMD controller.
+ */
+
+#include "CongestionControl.h"
+#include "FTypes.h"
+#include "Mocket.h"
+#include "Mutex.h"
+
+
+class CubicCongestionController : public CongestionControl
+{
+    public:
+        CubicCongestionController (Mocket *pMocket);
+        ~CubicCongestionController (void);
+
+        void update (void);
+        uint32 adaptToCongestionWindow (uint32 ui32SpaceAvailable);
+        void reactToLosses (uint8 ui8Code);
+        void addRTTSample (uint32 ui32RTT);
+
+        static const uint8 INITIAL_CWND_SEGMENTS = 10;
+        static const uint8 MIN_CWND_SEGMENTS = 2;
+        static const uint32 MAX_CWND_SIZE = 0x40000000UL;
+
+    private:
+        void reduceCongestionWindow (void);
+        void exportState (void);
+
+    private:
+        NOMADSUtil::Mutex _m;
+        uint16 _ui16MTU;
+
+        uint32 _ui32CongestionWindowSize;   // Bytes
+        uint32 _ui32SlowStartThreshold;     // Bytes
+
+        // Parameters of the cubic function, in segments and seconds
+        double _dWMax;
+        double _dWLastMax;
+        double _dK;
+        double _dWEst;
+        int64 _i64EpochStart;               // 0 until the first acknowledgement after a reduction
+
+        int64 _i64LastReductionTime;
+        uint32 _ui32MinRTT;
+};
+
+#endif   // #ifndef INCL_CUBIC_CONGESTION_CONTROLLER_H
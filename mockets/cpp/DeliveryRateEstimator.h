@@ -0,0 +1,159 @@
+#ifndef INCL_DELIVERY_RATE_ESTIMATOR_H
+#define INCL_DELIVERY_RATE_ESTIMATOR_H
+
+/*
+ * DeliveryRateEstimator.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Computes a delivery rate sample for each SAck received, as done by the
+ * rate sampling of the Linux TCP stack.
+ * The estimator counts the bytes delivered (acknowledged) to the remote side.
+ * Each time a reliable packet is transmitted, the current count and the time
+ * at which it was last updated are stored in its PacketWrapper. When a SAck
+ * acknowledges some packets, the rate is the number of bytes delivered since
+ * the most recently sent of those packets was transmitted, divided by the
+ * longer of the time it took to send them and the time it took to acknowledge
+ * them (which filters out the effect of acknowledgements that are compressed
+ * or delayed).
+ * The delivered count at the time the packet was sent is also used by the
+ * congestion controllers to count round trips.
+ * All the times are monotonic times in microseconds.
+ */
+
+#include "Packet.h"
+#include "PacketWrapper.h"
+
+#include "FTypes.h"
+#include "Mutex.h"
+#include "NLFLib.h"
+
+
+struct DeliveryRateSample
+{
+    uint32 ui32DeliveryRate;        // Bytes per second
+    uint64 ui64Delivered;           // Bytes delivered since the connection was established
+    uint64 ui64PriorDelivered;      // Bytes that had been delivered when the sampled packet was sent
+    int64 i64Interval;              // Length of the sampling interval in microseconds
+};
+
+class DeliveryRateEstimator
+{
+    public:
+        DeliveryRateEstimator (void);
+
+        // Records the current delivery state in pWrapper, which is being (re)transmitted
+        // ui32BytesInFlight is the number of bytes that are still unacknowledged, not including pWrapper
+        void packetSent (PacketWrapper *pWrapper, uint32 ui32BytesInFlight);
+
+        // Invoked by the UnacknowledgedPacketQueue for each packet that is acknowledged
+        void packetAcknowledged (PacketWrapper *pWrapper);
+
+        // Computes the delivery rate sample of the packets acknowledged since the last invocation
+        // Returns true if a valid sample is available
+        bool getSample (DeliveryRateSample &sample);
+
+        static int64 getCurrentTime (void);
+
+    private:
+        NOMADSUtil::Mutex _m;
+        uint64 _ui64Delivered;
+        int64 _i64DeliveredTime;        // Time at which _ui64Delivered was last updated
+        int64 _i64FirstSentTime;        // Send time of the first packet of the current flight
+
+        // Delivery state of the most recently sent packet acknowledged since the last sample
+        bool _bHaveSample;
+        uint64 _ui64PriorDelivered;
+        int64 _i64PriorDeliveredTime;
+        int64 _i64PriorSentTime;
+        int64 _i64SendElapsed;
+};
+
+inline DeliveryRateEstimator::DeliveryRateEstimator (void)
+{
+    _ui64Delivered = 0;
+    _i64DeliveredTime = 0;
+    _i64FirstSentTime = 0;
+    _bHaveSample = false;
+    _ui64PriorDelivered = 0;
+    _i64PriorDeliveredTime = 0;
+    _i64PriorSentTime = 0;
+    _i64SendElapsed = 0;
+}
+
+inline void DeliveryRateEstimator::packetSent (PacketWrapper *pWrapper, uint32 ui32BytesInFlight)
+{
+    int64 i64CurrTime = getCurrentTime();
+    _m.lock();
+    if ((ui32BytesInFlight == 0) || (_i64DeliveredTime == 0)) {
+        // Start of a new flight after an idle period: the time spent idle must not be counted
+        _i64FirstSentTime = i64CurrTime;
+        _i64DeliveredTime = i64CurrTime;
+    }
+    pWrapper->setDeliveryState (_ui64Delivered, _i64DeliveredTime, _i64FirstSentTime, i64CurrTime);
+    _m.unlock();
+}
+
+inline void DeliveryRateEstimator::packetAcknowledged (PacketWrapper *pWrapper)
+{
+    if (pWrapper->getSentTime() == 0) {
+        // The packet was not sent through packetSent()
+        return;
+    }
+    int64 i64CurrTime = getCurrentTime();
+    _m.lock();
+    _ui64Delivered += pWrapper->getPacket()->getPacketSize();
+    _i64DeliveredTime = i64CurrTime;
+    if ((!_bHaveSample) || (pWrapper->getSentTime() > _i64PriorSentTime) ||
+        ((pWrapper->getSentTime() == _i64PriorSentTime) && (pWrapper->getDelivered() > _ui64PriorDelivered))) {
+        _bHaveSample = true;
+        _ui64PriorDelivered = pWrapper->getDelivered();
+        _i64PriorDeliveredTime = pWrapper->getDeliveredTime();
+        _i64PriorSentTime = pWrapper->getSentTime();
+        _i64SendElapsed = pWrapper->getSentTime() - pWrapper->getFirstSentTime();
+        // The next flight starts with the packets sent after this one
+        _i64FirstSentTime = pWrapper->getSentTime();
+    }
+    _m.unlock();
+}
+
+inline bool DeliveryRateEstimator::getSample (DeliveryRateSample &sample)
+{
+    _m.lock();
+    if (!_bHaveSample) {
+        _m.unlock();
+        return false;
+    }
+    _bHaveSample = false;
+    int64 i64AckElapsed = _i64DeliveredTime - _i64PriorDeliveredTime;
+    sample.i64Interval = (_i64SendElapsed > i64AckElapsed) ? _i64SendElapsed : i64AckElapsed;
+    sample.ui64Delivered = _ui64Delivered;
+    sample.ui64PriorDelivered = _ui64PriorDelivered;
+    sample.ui32DeliveryRate = 0;
+    if (sample.i64Interval > 0) {
+        uint64 ui64Rate = (_ui64Delivered - _ui64PriorDelivered) * 1000000 / (uint64) sample.i64Interval;
+        sample.ui32DeliveryRate = (ui64Rate > 0xFFFFFFFFUL) ? 0xFFFFFFFFUL : (uint32) ui64Rate;
+    }
+    _m.unlock();
+    return true;
+}
+
+inline int64 DeliveryRateEstimator::getCurrentTime (void)
+{
+    return NOMADSUtil::getMonotonicTimeInNanoseconds() / 1000;
+}
+
+#endif   // #ifndef INCL_DELIVERY_RATE_ESTIMATOR_H
@@ -0,0 +1,323 @@
+/*
+ * FECDecoder.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "FECDecoder.h"
+
+#include "FECEncoder.h"
+#include "Mocket.h"
+#include "Packet.h"
+#include "PacketPool.h"
+#include "PacketProcessor.h"
+
+#include "EndianHelper.h"
+#include "Logger.h"
+#include "SequentialArithmetic.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+using namespace NOMADSUtil;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+FECDecoder::FECDecoder (PacketProcessor *pPacketProcessor, PacketPool *pPool, uint32 ui32NextTSN)
+{
+    _pPacketProcessor = pPacketProcessor;
+    _pPool = pPool;
+    _ui32NextTSN = ui32NextTSN;
+    for (uint16 ui16 = 0; ui16 < WINDOW_SIZE; ui16++) {
+        _sourceSymbols[ui16].ui32TSN = 0;
+        _sourceSymbols[ui16].ui16Len = 0;
+        _sourceSymbols[ui16].pBuf = nullptr;
+    }
+    _bBlockOpen = false;
+    _ui32BlockBaseTSN = 0;
+    _ui8BlockSourcePackets = 0;
+    _ui8BlockRepairPackets = 0;
+    _ui8ReceivedRepairPackets = 0;
+    _ui16RepairSymbolLen = 0;
+    for (uint8 ui8 = 0; ui8 < ReedSolomonCode::MAX_REPAIR_SYMBOLS; ui8++) {
+        _repairSymbols[ui8].ui32TSN = 0;
+        _repairSymbols[ui8].ui16Len = 0;
+        _repairSymbols[ui8].pBuf = nullptr;
+    }
+    _ui32ExpectedPackets = 0;
+    _ui32LostPackets = 0;
+}
+
+FECDecoder::~FECDecoder (void)
+{
+    for (uint16 ui16 = 0; ui16 < WINDOW_SIZE; ui16++) {
+        releaseSymbol (&_sourceSymbols[ui16]);
+    }
+    for (uint8 ui8 = 0; ui8 < ReedSolomonCode::MAX_REPAIR_SYMBOLS; ui8++) {
+        releaseSymbol (&_repairSymbols[ui8]);
+    }
+}
+
+void FECDecoder::addSourcePacket (Packet *pPacket)
+{
+    uint32 ui32TSN = pPacket->getSequenceNum();
+    if (SequentialArithmetic::lessThan (ui32TSN, _ui32NextTSN)) {
+        // The block of this packet has already been decided
+        return;
+    }
+    if (!SequentialArithmetic::lessThan (ui32TSN, _ui32NextTSN + WINDOW_SIZE)) {
+        // The repair packets for the oldest packets in the window did not arrive - make room for this one
+        uint32 ui32NewNextTSN = ui32TSN - WINDOW_SIZE + 1;
+        if (_bBlockOpen && SequentialArithmetic::lessThan (_ui32BlockBaseTSN, ui32NewNextTSN)) {
+            tryToDecodeBlock (true);
+        }
+        advanceTo (ui32NewNextTSN);
+    }
+    const char *pBuf = pPacket->getPacket();
+    uint16 ui16BodyLen = FECEncoder::getSourceBodyLength (pBuf, pPacket->getPacketSize());
+    if (ui16BodyLen == 0) {
+        return;
+    }
+    uint8 *pSymbolBuf = allocateSymbol (getSourceSymbol (ui32TSN), ui32TSN, FECEncoder::SOURCE_SYMBOL_HEADER_SIZE + ui16BodyLen);
+    if (pSymbolBuf == nullptr) {
+        return;
+    }
+    *((uint16*)(pSymbolBuf + 0)) = *((const uint16*)(pBuf + 0));     // Flags, already in network byte order
+    *((uint16*)(pSymbolBuf + 2)) = EndianHelper::htons (ui16BodyLen);
+    memcpy (pSymbolBuf + FECEncoder::SOURCE_SYMBOL_HEADER_SIZE, pBuf + Packet::HEADER_SIZE, ui16BodyLen);
+    if (_bBlockOpen && SequentialArithmetic::greaterThanOrEqual (ui32TSN, _ui32BlockBaseTSN) &&
+        SequentialArithmetic::lessThan (ui32TSN, _ui32BlockBaseTSN + _ui8BlockSourcePackets)) {
+        // This packet arrived after some of the repair packets of its block
+        tryToDecodeBlock (false);
+    }
+}
+
+int FECDecoder::processRepairChunk (FECRepairChunkAccessor repairChunkAccessor)
+{
+    uint32 ui32BaseTSN = repairChunkAccessor.getBaseTSN();
+    uint8 ui8SourcePackets = repairChunkAccessor.getSourcePacketCount();
+    uint8 ui8RepairPackets = repairChunkAccessor.getRepairPacketCount();
+    uint8 ui8RepairIndex = repairChunkAccessor.getRepairIndex();
+    uint16 ui16Len = repairChunkAccessor.getDataLength();
+    if ((ui8SourcePackets == 0) || (ui8SourcePackets > ReedSolomonCode::MAX_SOURCE_SYMBOLS) ||
+        (ui8RepairPackets == 0) || (ui8RepairPackets > ReedSolomonCode::MAX_REPAIR_SYMBOLS) ||
+        (ui8RepairIndex >= ui8RepairPackets) || (ui16Len <= FECEncoder::SOURCE_SYMBOL_HEADER_SIZE) ||
+        (ui16Len > Mocket::MAXIMUM_MTU)) {
+        checkAndLogMsg ("FECDecoder::processRepairChunk", Logger::L_MildError,
+                        "received an invalid repair chunk for the block starting at %lu\n", ui32BaseTSN);
+        return -1;
+    }
+    if (SequentialArithmetic::lessThanOrEqual (ui32BaseTSN + ui8SourcePackets, _ui32NextTSN)) {
+        // The block has already been decided
+        return 0;
+    }
+    if (_bBlockOpen && (ui32BaseTSN != _ui32BlockBaseTSN)) {
+        if (SequentialArithmetic::lessThan (ui32BaseTSN, _ui32BlockBaseTSN)) {
+            // Late repair packet for an older block
+            return 0;
+        }
+        // The remaining repair packets of the current block were lost
+        tryToDecodeBlock (true);
+    }
+    if (!_bBlockOpen) {
+        if (SequentialArithmetic::lessThan (_ui32NextTSN, ui32BaseTSN)) {
+            // All the repair packets of the previous blocks were lost
+            advanceTo (ui32BaseTSN);
+        }
+        _bBlockOpen = true;
+        _ui32BlockBaseTSN = ui32BaseTSN;
+        _ui8BlockSourcePackets = ui8SourcePackets;
+        _ui8BlockRepairPackets = ui8RepairPackets;
+        _ui8ReceivedRepairPackets = 0;
+        _ui16RepairSymbolLen = ui16Len;
+    }
+    else if ((ui8SourcePackets != _ui8BlockSourcePackets) || (ui8RepairPackets != _ui8BlockRepairPackets) ||
+             (ui16Len != _ui16RepairSymbolLen)) {
+        checkAndLogMsg ("FECDecoder::processRepairChunk", Logger::L_MildError,
+                        "repair chunk %d for the block starting at %lu does not match the previous ones\n",
+                        (int) ui8RepairIndex, ui32BaseTSN);
+        return -2;
+    }
+    Symbol *pSymbol = &_repairSymbols[ui8RepairIndex];
+    if (pSymbol->pBuf == nullptr) {
+        uint8 *pSymbolBuf = allocateSymbol (pSymbol, ui32BaseTSN, ui16Len);
+        if (pSymbolBuf == nullptr) {
+            return -3;
+        }
+        memcpy (pSymbolBuf, repairChunkAccessor.getData(), ui16Len);
+        _ui8ReceivedRepairPackets++;
+    }
+    // The repair packets are sent in order, so give up after the last one
+    tryToDecodeBlock (ui8RepairIndex == (_ui8BlockRepairPackets - 1));
+    return 0;
+}
+
+FECDecoder::Symbol * FECDecoder::getSourceSymbol (uint32 ui32TSN)
+{
+    return &_sourceSymbols[ui32TSN % WINDOW_SIZE];
+}
+
+uint8 * FECDecoder::allocateSymbol (Symbol *pSymbol, uint32 ui32TSN, uint16 ui16Len)
+{
+    if ((pSymbol->pBuf != nullptr) && (pSymbol->ui16Len < ui16Len)) {
+        releaseSymbol (pSymbol);
+    }
+    if (pSymbol->pBuf == nullptr) {
+        if (nullptr == (pSymbol->pBuf = (uint8*) PacketPool::allocate (_pPool, ui16Len))) {
+            return nullptr;
+        }
+    }
+    pSymbol->ui32TSN = ui32TSN;
+    pSymbol->ui16Len = ui16Len;
+    return pSymbol->pBuf;
+}
+
+void FECDecoder::releaseSymbol (Symbol *pSymbol)
+{
+    if (pSymbol->pBuf != nullptr) {
+        PacketPool::release (pSymbol->pBuf);
+        pSymbol->pBuf = nullptr;
+    }
+    pSymbol->ui16Len = 0;
+}
+
+void FECDecoder::tryToDecodeBlock (bool bGiveUp)
+{
+    if (!_bBlockOpen) {
+        return;
+    }
+    uint8 aui8Missing[ReedSolomonCode::MAX_SOURCE_SYMBOLS];
+    uint8 ui8Missing = 0;
+    for (uint8 ui8 = 0; ui8 < _ui8BlockSourcePackets; ui8++) {
+        uint32 ui32TSN = _ui32BlockBaseTSN + ui8;
+        Symbol *pSymbol = getSourceSymbol (ui32TSN);
+        if ((pSymbol->pBuf == nullptr) || (pSymbol->ui32TSN != ui32TSN) || SequentialArithmetic::lessThan (ui32TSN, _ui32NextTSN)) {
+            aui8Missing[ui8Missing++] = ui8;
+        }
+    }
+    if (ui8Missing == 0) {
+        closeBlock();
+        return;
+    }
+    if (ui8Missing <= _ui8ReceivedRepairPackets) {
+        uint8 ui8Recovered = decodeBlock (aui8Missing, ui8Missing);
+        _ui32LostPackets += ui8Recovered;
+        closeBlock();
+        return;
+    }
+    if (bGiveUp) {
+        checkAndLogMsg ("FECDecoder::tryToDecodeBlock", Logger::L_MediumDetailDebug,
+                        "cannot recover the block starting at %lu; %d packets missing, %d repair packets received\n",
+                        _ui32BlockBaseTSN, (int) ui8Missing, (int) _ui8ReceivedRepairPackets);
+        closeBlock();
+    }
+}
+
+uint8 FECDecoder::decodeBlock (const uint8 *pui8Missing, uint8 ui8Missing)
+{
+    uint32 ui32Len = _ui16RepairSymbolLen;
+    uint8 *pMatrix = (uint8*) malloc (ui8Missing * ui8Missing);
+    uint8 **ppRows = (uint8**) malloc (ui8Missing * sizeof (uint8*));
+    if ((pMatrix == nullptr) || (ppRows == nullptr)) {
+        free (pMatrix);
+        free (ppRows);
+        return 0;
+    }
+
+    // Use the first ui8Missing repair symbols that were received, and subtract the known source symbols from them
+    uint8 ui8Row = 0;
+    for (uint8 ui8RepairIndex = 0; (ui8RepairIndex < _ui8BlockRepairPackets) && (ui8Row < ui8Missing); ui8RepairIndex++) {
+        Symbol *pRepair = &_repairSymbols[ui8RepairIndex];
+        if (pRepair->pBuf == nullptr) {
+            continue;
+        }
+        uint8 ui8MissingIndex = 0;
+        for (uint8 ui8 = 0; ui8 < _ui8BlockSourcePackets; ui8++) {
+            uint8 ui8Coefficient = ReedSolomonCode::getCoefficient (ui8RepairIndex, ui8);
+            if ((ui8MissingIndex < ui8Missing) && (pui8Missing[ui8MissingIndex] == ui8)) {
+                pMatrix[ui8Row * ui8Missing + ui8MissingIndex] = ui8Coefficient;
+                ui8MissingIndex++;
+            }
+            else {
+                Symbol *pSource = getSourceSymbol (_ui32BlockBaseTSN + ui8);
+                uint32 ui32SourceLen = (pSource->ui16Len < ui32Len) ? pSource->ui16Len : ui32Len;
+                ReedSolomonCode::multiplyAndAdd (pRepair->pBuf, pSource->pBuf, ui32SourceLen, ui8Coefficient);
+            }
+        }
+        ppRows[ui8Row++] = pRepair->pBuf;
+    }
+    uint8 ui8Recovered = 0;
+    if (0 != ReedSolomonCode::solve (pMatrix, ppRows, ui8Missing, ui32Len)) {
+        checkAndLogMsg ("FECDecoder::decodeBlock", Logger::L_MildError,
+                        "failed to decode the block starting at %lu\n", _ui32BlockBaseTSN);
+    }
+    else {
+        for (uint8 ui8 = 0; ui8 < ui8Missing; ui8++) {
+            uint32 ui32TSN = _ui32BlockBaseTSN + pui8Missing[ui8];
+            if (SequentialArithmetic::lessThan (ui32TSN, _ui32NextTSN)) {
+                // Lost before the decoder was started
+                continue;
+            }
+            const uint8 *pSymbol = ppRows[ui8];
+            uint16 ui16BodyLen = EndianHelper::ntohs (*((const uint16*)(pSymbol + 2)));
+            if ((ui16BodyLen == 0) || (((uint32) (FECEncoder::SOURCE_SYMBOL_HEADER_SIZE + ui16BodyLen)) > ui32Len)) {
+                checkAndLogMsg ("FECDecoder::decodeBlock", Logger::L_MildError,
+                                "rebuilt packet %lu has an invalid length of %d\n", ui32TSN, (int) ui16BodyLen);
+                continue;
+            }
+            if (0 != _pPacketProcessor->fecPacketRecovered (ui32TSN, pSymbol, ui16BodyLen)) {
+                continue;
+            }
+            // Keep the symbol, so that advanceTo() does not report the packet as lost
+            uint16 ui16SymbolLen = FECEncoder::SOURCE_SYMBOL_HEADER_SIZE + ui16BodyLen;
+            uint8 *pSymbolBuf = allocateSymbol (getSourceSymbol (ui32TSN), ui32TSN, ui16SymbolLen);
+            if (pSymbolBuf != nullptr) {
+                memcpy (pSymbolBuf, pSymbol, ui16SymbolLen);
+            }
+            ui8Recovered++;
+        }
+    }
+    free (pMatrix);
+    free (ppRows);
+    return ui8Recovered;
+}
+
+void FECDecoder::closeBlock (void)
+{
+    advanceTo (_ui32BlockBaseTSN + _ui8BlockSourcePackets);
+    for (uint8 ui8 = 0; ui8 < _ui8BlockRepairPackets; ui8++) {
+        releaseSymbol (&_repairSymbols[ui8]);
+    }
+    _bBlockOpen = false;
+    _ui8ReceivedRepairPackets = 0;
+}
+
+void FECDecoder::advanceTo (uint32 ui32TSN)
+{
+    while (SequentialArithmetic::lessThan (_ui32NextTSN, ui32TSN)) {
+        Symbol *pSymbol = getSourceSymbol (_ui32NextTSN);
+        _ui32ExpectedPackets++;
+        if ((pSymbol->pBuf != nullptr) && (pSymbol->ui32TSN == _ui32NextTSN)) {
+            releaseSymbol (pSymbol);
+        }
+        else {
+            _ui32LostPackets++;
+            _pPacketProcessor->fecPacketUnrecoverable (_ui32NextTSN);
+        }
+        _ui32NextTSN++;
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef INCL_FEC_DECODER_H
+#define INCL_FEC_DECODER_H
+
+/*
+ * FECDecoder.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * FECDecoder
+ *
+ * Used by the PacketProcessor to rebuild lost unreliable sequenced packets from the
+ * FEC repair packets sent by the remote Transmitter (see FECEncoder).
+ * The decoder keeps a copy of the source symbols of the last WINDOW_SIZE packets
+ * and of the repair symbols of the block being decoded.
+ * A block is decided as soon as all its packets have been received, enough repair
+ * packets have been received to rebuild the missing ones, the last repair packet of
+ * the block has been received, or a repair packet for a later block arrives.
+ * Lost packets that can not be rebuilt are reported to the PacketProcessor, so that
+ * the packets that follow them can be delivered without waiting for the unreliable
+ * sequenced delivery timeout.
+ *
+ * NOTE: The decoder is not thread safe; the PacketProcessor serializes the calls
+ */
+
+#include "PacketAccessors.h"
+#include "ReedSolomonCode.h"
+
+#include "FTypes.h"
+
+class Packet;
+class PacketPool;
+class PacketProcessor;
+
+class FECDecoder
+{
+    public:
+        // ui32NextTSN is the TSN of the first unreliable sequenced packet that has not been delivered yet
+        FECDecoder (PacketProcessor *pPacketProcessor, PacketPool *pPool, uint32 ui32NextTSN);
+        ~FECDecoder (void);
+
+        // Records the source symbol of an unreliable sequenced packet that has been received
+        void addSourcePacket (Packet *pPacket);
+
+        // Processes a repair chunk, rebuilding the lost packets of its block if possible
+        // Returns 0 if successful or a negative value if the chunk is not valid
+        int processRepairChunk (FECRepairChunkAccessor repairChunkAccessor);
+
+        // Cumulative number of packets in the blocks that have been decided, and of the ones
+        // that were lost (before being rebuilt) - used as feedback for the remote Transmitter
+        uint32 getExpectedPacketCount (void);
+        uint32 getLostPacketCount (void);
+
+        static const uint16 WINDOW_SIZE = 256;
+
+    private:
+        struct Symbol
+        {
+            uint32 ui32TSN;
+            uint16 ui16Len;
+            uint8 *pBuf;        // nullptr if the symbol is not available; allocated from the PacketPool
+        };
+
+        Symbol * getSourceSymbol (uint32 ui32TSN);
+        // Returns the buffer of pSymbol, (re)allocated to hold ui16Len bytes, or nullptr if the memory could not be allocated
+        uint8 * allocateSymbol (Symbol *pSymbol, uint32 ui32TSN, uint16 ui16Len);
+        void releaseSymbol (Symbol *pSymbol);
+
+        // Decodes the current block if enough symbols are available
+        // If the block can not be decoded yet and bGiveUp is true, the missing packets are reported as lost
+        void tryToDecodeBlock (bool bGiveUp);
+
+        // Rebuilds the ui8Missing source symbols listed in pui8Missing
+        // Returns the number of packets that were rebuilt
+        uint8 decodeBlock (const uint8 *pui8Missing, uint8 ui8Missing);
+
+        void closeBlock (void);
+
+        // Decides all the packets up to ui32TSN (excluded)
+        // The packets that have not been received are reported to the PacketProcessor as lost
+        void advanceTo (uint32 ui32TSN);
+
+    private:
+        PacketProcessor *_pPacketProcessor;
+        PacketPool *_pPool;
+        uint32 _ui32NextTSN;                    // All the packets before this TSN have been decided
+        Symbol _sourceSymbols[WINDOW_SIZE];     // Indexed by TSN modulo WINDOW_SIZE
+
+        bool _bBlockOpen;
+        uint32 _ui32BlockBaseTSN;
+        uint8 _ui8BlockSourcePackets;
+        uint8 _ui8BlockRepairPackets;
+        uint8 _ui8ReceivedRepairPackets;
+        uint16 _ui16RepairSymbolLen;
+        Symbol _repairSymbols[ReedSolomonCode::MAX_REPAIR_SYMBOLS];
+
+        uint32 _ui32ExpectedPackets;
+        uint32 _ui32LostPackets;
+};
+
+inline uint32 FECDecoder::getExpectedPacketCount (void)
+{
+    return _ui32ExpectedPackets;
+}
+
+inline uint32 FECDecoder::getLostPacketCount (void)
+{
+    return _ui32LostPackets;
+}
+
+#endif   // #ifndef INCL_FEC_DECODER_H
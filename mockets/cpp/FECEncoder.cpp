@@ -0,0 +1,159 @@
+/*
+ * FECEncoder.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "FECEncoder.h"
+
+#include "Mocket.h"
+#include "Packet.h"
+#include "ReedSolomonCode.h"
+
+#include "EndianHelper.h"
+#include "Logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+using namespace NOMADSUtil;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+FECEncoder::FECEncoder (uint8 ui8SourcePackets, uint8 ui8RepairPackets)
+{
+    _ui8SourcePackets = ui8SourcePackets;
+    _ui8RepairPackets = ui8RepairPackets;
+    // Adaptive FEC may raise the number of repair packets up to the number of source packets
+    _ui8MaxRepairPackets = (ui8RepairPackets > ui8SourcePackets) ? ui8RepairPackets : ui8SourcePackets;
+    _pRepairBuf = (uint8*) malloc (_ui8MaxRepairPackets * Mocket::MAXIMUM_MTU);
+    _pSymbolBuf = (uint8*) malloc (Mocket::MAXIMUM_MTU);
+    startNewBlock();
+}
+
+FECEncoder::~FECEncoder (void)
+{
+    if (_pRepairBuf) {
+        free (_pRepairBuf);
+        _pRepairBuf = nullptr;
+    }
+    if (_pSymbolBuf) {
+        free (_pSymbolBuf);
+        _pSymbolBuf = nullptr;
+    }
+}
+
+void FECEncoder::setRepairPacketCount (uint8 ui8RepairPackets)
+{
+    if (ui8RepairPackets == 0) {
+        ui8RepairPackets = 1;
+    }
+    if (ui8RepairPackets > _ui8MaxRepairPackets) {
+        ui8RepairPackets = _ui8MaxRepairPackets;
+    }
+    _ui8RepairPackets = ui8RepairPackets;
+}
+
+bool FECEncoder::addSourcePacket (Packet *pPacket, int64 i64CurrTime)
+{
+    if ((_pRepairBuf == nullptr) || (_pSymbolBuf == nullptr)) {
+        return false;
+    }
+    const char *pBuf = pPacket->getPacket();
+    uint16 ui16BodyLen = getSourceBodyLength (pBuf, pPacket->getPacketSize());
+    if (ui16BodyLen == 0) {
+        checkAndLogMsg ("FECEncoder::addSourcePacket", Logger::L_Warning,
+                        "packet %lu does not have a data chunk\n", pPacket->getSequenceNum());
+        return false;
+    }
+    if ((_ui8BlockSourcePackets > 0) && (pPacket->getSequenceNum() != (_ui32BlockBaseTSN + _ui8BlockSourcePackets))) {
+        // Should not happen since the TSNs are assigned by the transmitter in the same order
+        checkAndLogMsg ("FECEncoder::addSourcePacket", Logger::L_Warning,
+                        "packet %lu does not follow the last packet in the block; discarding the block that starts at %lu\n",
+                        pPacket->getSequenceNum(), _ui32BlockBaseTSN);
+        startNewBlock();
+    }
+    if (_ui8BlockSourcePackets == 0) {
+        _ui32BlockBaseTSN = pPacket->getSequenceNum();
+        _ui8BlockRepairPackets = _ui8RepairPackets;
+        _i64BlockStartTime = i64CurrTime;
+    }
+
+    // Build the source symbol
+    uint16 ui16Len = SOURCE_SYMBOL_HEADER_SIZE + ui16BodyLen;
+    *((uint16*)(_pSymbolBuf + 0)) = *((const uint16*)(pBuf + 0));      // Flags, already in network byte order
+    *((uint16*)(_pSymbolBuf + 2)) = EndianHelper::htons (ui16BodyLen);
+    memcpy (_pSymbolBuf + SOURCE_SYMBOL_HEADER_SIZE, pBuf + Packet::HEADER_SIZE, ui16BodyLen);
+
+    // Add it to the repair symbols
+    for (uint8 ui8 = 0; ui8 < _ui8BlockRepairPackets; ui8++) {
+        uint8 *pRepair = _pRepairBuf + (ui8 * Mocket::MAXIMUM_MTU);
+        if (ui16Len > _ui16SymbolLen) {
+            memset (pRepair + _ui16SymbolLen, 0, ui16Len - _ui16SymbolLen);
+        }
+        ReedSolomonCode::multiplyAndAdd (pRepair, _pSymbolBuf, ui16Len,
+                                         ReedSolomonCode::getCoefficient (ui8, _ui8BlockSourcePackets));
+    }
+    if (ui16Len > _ui16SymbolLen) {
+        _ui16SymbolLen = ui16Len;
+    }
+    _ui8BlockSourcePackets++;
+    return (_ui8BlockSourcePackets >= _ui8SourcePackets);
+}
+
+int FECEncoder::addRepairChunk (Packet *pPacket, uint8 ui8RepairIndex)
+{
+    if ((_ui8BlockSourcePackets == 0) || (ui8RepairIndex >= _ui8BlockRepairPackets)) {
+        return -1;
+    }
+    if (pPacket->addFECRepairChunk (_ui32BlockBaseTSN, _ui8BlockSourcePackets, _ui8BlockRepairPackets, ui8RepairIndex,
+                                    (const char*) (_pRepairBuf + (ui8RepairIndex * Mocket::MAXIMUM_MTU)), _ui16SymbolLen)) {
+        return -2;
+    }
+    return 0;
+}
+
+void FECEncoder::startNewBlock (void)
+{
+    _ui32BlockBaseTSN = 0;
+    _ui8BlockSourcePackets = 0;
+    _ui8BlockRepairPackets = 0;
+    _i64BlockStartTime = 0;
+    _ui16SymbolLen = 0;
+}
+
+uint16 FECEncoder::getSourceBodyLength (const char *pPacket, uint16 ui16PacketSize)
+{
+    uint16 ui16Offset = Packet::HEADER_SIZE;
+    if (ui16PacketSize < ui16Offset) {
+        return 0;
+    }
+    uint16 ui16Flags = EndianHelper::ntohs (*((const uint16*)(pPacket + 0)));
+    if (ui16Flags & Packet::HEADER_FLAG_DELIVERY_PREREQUISITES) {
+        ui16Offset += Packet::DELIVERY_PREREQUISITES_SIZE;
+    }
+    if ((ui16Offset + Packet::DATA_CHUNK_HEADER_SIZE) > ui16PacketSize) {
+        return 0;
+    }
+    uint16 ui16ChunkType = EndianHelper::ntohs (*((const uint16*)(pPacket + ui16Offset + 0)));
+    uint16 ui16ChunkSize = EndianHelper::ntohs (*((const uint16*)(pPacket + ui16Offset + 2)));
+    if ((ui16ChunkType != Packet::CT_Data) || (ui16ChunkSize < Packet::DATA_CHUNK_HEADER_SIZE) ||
+        ((ui16Offset + ui16ChunkSize) > ui16PacketSize)) {
+        return 0;
+    }
+    return (ui16Offset + ui16ChunkSize) - Packet::HEADER_SIZE;
+}
@@ -0,0 +1,123 @@
+#ifndef INCL_FEC_ENCODER_H
+#define INCL_FEC_ENCODER_H
+
+/*
+ * FECEncoder.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * FECEncoder
+ *
+ * Used by the Transmitter to compute the repair packets of a block of consecutive
+ * unreliable sequenced packets (see ReedSolomonCode).
+ * The source symbol of a packet is made of the header flags, the length of the body,
+ * and the body of the packet, which goes from the end of the header to the end of
+ * the data chunk (delivery prerequisites included, piggyback chunks excluded).
+ * Symbols shorter than the longest one in the block are padded with zeros.
+ * The repair symbols are updated as soon as each packet is added, so the packets
+ * do not need to be kept until the end of the block.
+ */
+
+#include "FTypes.h"
+
+class Packet;
+
+class FECEncoder
+{
+    public:
+        FECEncoder (uint8 ui8SourcePackets, uint8 ui8RepairPackets);
+        ~FECEncoder (void);
+
+        // Sets the number of repair packets that will be sent for the blocks started from now on
+        // The value must be between 1 and the number of source packets in a block
+        void setRepairPacketCount (uint8 ui8RepairPackets);
+        uint8 getRepairPacketCount (void);
+
+        uint8 getSourcePacketCount (void);
+
+        // Adds pPacket to the current block; the packet must be the unreliable sequenced packet
+        // that follows the previous one added to the block
+        // Returns true if the block is complete, in which case the repair packets should be sent
+        // and startNewBlock() should be invoked
+        bool addSourcePacket (Packet *pPacket, int64 i64CurrTime);
+
+        // Returns the number of packets added to the current block
+        uint8 getBlockSourcePacketCount (void);
+
+        // Returns the number of repair packets for the current block
+        uint8 getBlockRepairPacketCount (void);
+
+        // Returns the time at which the first packet was added to the current block
+        int64 getBlockStartTime (void);
+
+        // Adds the repair chunk ui8RepairIndex of the current block to pPacket
+        // Returns 0 if successful or a negative value in case of error
+        int addRepairChunk (Packet *pPacket, uint8 ui8RepairIndex);
+
+        void startNewBlock (void);
+
+        // Returns the length of the body of the source symbol of the packet (see above),
+        // or 0 if the packet does not have a data chunk
+        static uint16 getSourceBodyLength (const char *pPacket, uint16 ui16PacketSize);
+
+        // Size of the header of a source symbol - 2 bytes for the flags and 2 bytes for the length of the body
+        static const uint16 SOURCE_SYMBOL_HEADER_SIZE = 4;
+
+        // Number of bytes by which a repair packet is larger than the largest packet of its block
+        // (the header of the repair chunk plus the header of the source symbol)
+        static const uint16 REPAIR_PACKET_OVERHEAD = 16;
+
+    private:
+        uint8 _ui8SourcePackets;
+        uint8 _ui8RepairPackets;
+        uint8 _ui8MaxRepairPackets;             // Number of repair symbols for which _pRepairBuf has room
+
+        uint32 _ui32BlockBaseTSN;
+        uint8 _ui8BlockSourcePackets;
+        uint8 _ui8BlockRepairPackets;
+        int64 _i64BlockStartTime;
+        uint16 _ui16SymbolLen;                  // Length of the longest source symbol in the current block
+
+        uint8 *_pRepairBuf;                     // Repair symbols of the current block, Mocket::MAXIMUM_MTU bytes each
+        uint8 *_pSymbolBuf;                     // Source symbol being added
+};
+
+inline uint8 FECEncoder::getSourcePacketCount (void)
+{
+    return _ui8SourcePackets;
+}
+
+inline uint8 FECEncoder::getRepairPacketCount (void)
+{
+    return _ui8RepairPackets;
+}
+
+inline uint8 FECEncoder::getBlockSourcePacketCount (void)
+{
+    return _ui8BlockSourcePackets;
+}
+
+inline uint8 FECEncoder::getBlockRepairPacketCount (void)
+{
+    return _ui8BlockRepairPackets;
+}
+
+inline int64 FECEncoder::getBlockStartTime (void)
+{
+    return _i64BlockStartTime;
+}
+
+#endif   // #ifndef INCL_FEC_ENCODER_H
@@ -21,10 +21,13 @@
 
 #include "ACKManager.h"
 #include "MessageSender.h"
+#include "MocketMultiplexer.h"
 #include "MocketStatusNotifier.h"
 #include "Packet.h"
+#include "PacketPool.h"
 #include "PacketProcessor.h"
 #include "Receiver.h"
+#include "ReedSolomonCode.h"
 #include "Transmitter.h"
 #include "UDPCommInterface.h"
 #include "DTLSCommInterface.h"
@@ -70,7 +73,10 @@ Mocket::Mocket(
 
     _pPacketProcessor = nullptr;
     _pReceiver = nullptr;
+    _pMultiplexer = nullptr;
     _pTransmitter = nullptr;
+    _pPacketPool = new PacketPool();
+    _stats._pPacketPool = _pPacketPool;
 
     // Initialize default settings
     _ui16MTU = DEFAULT_MTU;
@@ -104,6 +110,13 @@ Mocket::Mocket(
     _ui32TransmitRateLimit = DEFAULT_TRANSMIT_RATE_LIMIT;
     _bUsingFastRetransmit = false;
     _bUseReceiverSideBandwidthEstimation = false;
+    _bUsePacing = false;
+    _bUseKernelPacing = false;
+    _bUseFEC = false;
+    _bUseAdaptiveFEC = false;
+    _ui8FECSourcePackets = DEFAULT_FEC_SOURCE_PACKETS;
+    _ui8FECRepairPackets = DEFAULT_FEC_REPAIR_PACKETS;
+    _ui32FECBlockTimeout = DEFAULT_FEC_BLOCK_TIMEOUT;
     _bMocketAlreadyBound = false;
     _pPeerUnreachableWarningCallbackFn = nullptr;
     _pPeerUnreachableCallbackArg = nullptr;
@@ -182,7 +195,10 @@ Mocket::Mocket (
     _bDeleteCIWhenDone = bDeleteCIWhenDone;
     _pPacketProcessor = nullptr;
     _pReceiver = nullptr;
+    _pMultiplexer = nullptr;
     _pTransmitter = nullptr;
+    _pPacketPool = new PacketPool();
+    _stats._pPacketPool = _pPacketPool;
     _ui16MTU = DEFAULT_MTU;
     _ui32ConnectTimeout = DEFAULT_CONNECT_TIMEOUT;
     _ui32UDPReceiveConnectionTimeout = DEFAULT_UDP_RECEIVE_CONNECTION_TIMEOUT;
@@ -217,6 +233,13 @@ Mocket::Mocket (
     _ui32TransmitRateLimit = DEFAULT_TRANSMIT_RATE_LIMIT;
     _bUsingFastRetransmit = false;
     _bUseReceiverSideBandwidthEstimation = false;
+    _bUsePacing = false;
+    _bUseKernelPacing = false;
+    _bUseFEC = false;
+    _bUseAdaptiveFEC = false;
+    _ui8FECSourcePackets = DEFAULT_FEC_SOURCE_PACKETS;
+    _ui8FECRepairPackets = DEFAULT_FEC_REPAIR_PACKETS;
+    _ui32FECBlockTimeout = DEFAULT_FEC_BLOCK_TIMEOUT;
     _bMocketAlreadyBound = true;
     _pPeerUnreachableWarningCallbackFn = nullptr;
     _pPeerUnreachableCallbackArg = nullptr;
@@ -295,6 +318,11 @@ Mocket::~Mocket (void)
     delete _pMocketStatusNotifier;
     _pMocketStatusNotifier = nullptr;
 
+    // The pool is deleted once any packets that are still around have been released
+    _stats._pPacketPool = nullptr;
+    _pPacketPool->close();
+    _pPacketPool = nullptr;
+
     if (_bDeleteCIWhenDone) {
         delete _pCommInterface;
     }
@@ -445,6 +473,61 @@ int Mocket::initParamsFromConfigFile (const char *pszConfigFile)
         checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
                         "set use receiver side bandwidth estimation to %s\n", _bUseReceiverSideBandwidthEstimation ? "true" : "false");
     }
+    if (cm.hasValue ("UsePacing")) {
+        _bUsePacing = cm.getValueAsBool ("UsePacing");
+        checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
+                        "set use pacing to %s\n", _bUsePacing ? "true" : "false");
+    }
+    if (cm.hasValue ("UseKernelPacing")) {
+        _bUseKernelPacing = cm.getValueAsBool ("UseKernelPacing");
+        if (_bUseKernelPacing) {
+            // Kernel pacing falls back to pacing in the transmitter when SO_TXTIME is not available
+            _bUsePacing = true;
+        }
+        checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
+                        "set use kernel pacing to %s\n", _bUseKernelPacing ? "true" : "false");
+    }
+    if (cm.hasValue ("UseForwardErrorCorrection")) {
+        _bUseFEC = cm.getValueAsBool ("UseForwardErrorCorrection");
+        checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
+                        "set use forward error correction to %s\n", _bUseFEC ? "true" : "false");
+    }
+    if (cm.hasValue ("FECSourcePackets")) {
+        int i = cm.getValueAsInt ("FECSourcePackets");
+        if ((i > 0) && (i <= ReedSolomonCode::MAX_SOURCE_SYMBOLS)) {
+            _ui8FECSourcePackets = (uint8) i;
+            checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
+                            "set FEC source packets to %d\n", (int) _ui8FECSourcePackets);
+        }
+        else {
+            checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_Warning,
+                            "ignoring FEC source packets setting of %d; must be between 1 and %d\n",
+                            i, (int) ReedSolomonCode::MAX_SOURCE_SYMBOLS);
+        }
+    }
+    if (cm.hasValue ("FECRepairPackets")) {
+        int i = cm.getValueAsInt ("FECRepairPackets");
+        if ((i > 0) && (i <= ReedSolomonCode::MAX_REPAIR_SYMBOLS)) {
+            _ui8FECRepairPackets = (uint8) i;
+            checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
+                            "set FEC repair packets to %d\n", (int) _ui8FECRepairPackets);
+        }
+        else {
+            checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_Warning,
+                            "ignoring FEC repair packets setting of %d; must be between 1 and %d\n",
+                            i, (int) ReedSolomonCode::MAX_REPAIR_SYMBOLS);
+        }
+    }
+    if (cm.hasValue ("UseAdaptiveFEC")) {
+        _bUseAdaptiveFEC = cm.getValueAsBool ("UseAdaptiveFEC");
+        checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
+                        "set use adaptive FEC to %s\n", _bUseAdaptiveFEC ? "true" : "false");
+    }
+    if (cm.hasValue ("FECBlockTimeout")) {
+        _ui32FECBlockTimeout = (uint32) cm.getValueAsInt ("FECBlockTimeout");
+        checkAndLogMsg ("Mocket::initParamsFromConfigFile", Logger::L_LowDetailDebug,
+                        "set FEC block timeout to %lu\n", _ui32FECBlockTimeout);
+    }
     if (cm.hasValue ("DisableKeepAlive")) {
         bool temp = cm.getValueAsBool ("DisableKeepAlive");
         if (temp) {
@@ -1655,6 +1738,25 @@ int Mocket::setTransmitRateLimit (uint32 ui32TransmitRateLimit)
     return _pTransmitter->setTransmitRateLimit (ui32TransmitRateLimit);
 }
 
+// Must be called before connect()
+int Mocket::enableForwardErrorCorrection (uint8 ui8SourcePackets, uint8 ui8RepairPackets, bool bAdaptive)
+{
+    if (_pTransmitter != nullptr) {
+        return -1;
+    }
+    if ((ui8SourcePackets == 0) || (ui8SourcePackets > ReedSolomonCode::MAX_SOURCE_SYMBOLS)) {
+        return -2;
+    }
+    if ((ui8RepairPackets == 0) || (ui8RepairPackets > ReedSolomonCode::MAX_REPAIR_SYMBOLS)) {
+        return -3;
+    }
+    _bUseFEC = true;
+    _ui8FECSourcePackets = ui8SourcePackets;
+    _ui8FECRepairPackets = ui8RepairPackets;
+    _bUseAdaptiveFEC = bAdaptive;
+    return 0;
+}
+
 int Mocket::suspend (uint32 ui32FlushDataTimeout, uint32 ui32SuspendTimeout)
 {
 #ifdef MOCKETS_NO_CRYPTO
@@ -2057,17 +2159,26 @@ void Mocket::setLocalAddr(const char *pszLocalAddr)
 void Mocket::startThreads(void)
 {
     int res = 0;
-    _pPacketProcessor->start();
-    res = _pPacketProcessor->setPriority(10);
-    if (res < 0) {
-        checkAndLogMsg ("Mocket::startThreads", Logger::L_MildError,
-                        "failed to set PacketProcessor thread priority; res = %d\n", res);
+    if (_pMultiplexer) {
+        // Shared socket mode - the multiplexer drives the Receiver and the PacketProcessor
+        if (0 != (res = _pMultiplexer->registerMocket (this))) {
+            checkAndLogMsg ("Mocket::startThreads", Logger::L_MildError,
+                            "failed to register with the multiplexer; res = %d\n", res);
+        }
     }
-    _pReceiver->start();
-    res = _pReceiver->setPriority(10);
-    if (res < 0) {
-        checkAndLogMsg ("Mocket::startThreads", Logger::L_MildError,
-                        "failed to set Receiver thread priority; res = %d\n", res);
+    else {
+        _pPacketProcessor->start();
+        res = _pPacketProcessor->setPriority(10);
+        if (res < 0) {
+            checkAndLogMsg ("Mocket::startThreads", Logger::L_MildError,
+                            "failed to set PacketProcessor thread priority; res = %d\n", res);
+        }
+        _pReceiver->start();
+        res = _pReceiver->setPriority(10);
+        if (res < 0) {
+            checkAndLogMsg ("Mocket::startThreads", Logger::L_MildError,
+                            "failed to set Receiver thread priority; res = %d\n", res);
+        }
     }
     _pTransmitter->start();
     res = _pTransmitter->setPriority(8);
@@ -51,8 +51,10 @@ namespace NOMADSUtil
 
 class CommInterface;
 class MessageSender;
+class MocketMultiplexer;
 class MocketPolicyUpdateListener;
 class MocketStatusNotifier;
+class PacketPool;
 class PacketProcessor;
 class Receiver;
 class Transmitter;
@@ -194,6 +196,15 @@ class Mocket
         // Returns the current setting for cross sequencing
         bool isCrossSequencingEnabled (void);
 
+        // Enables forward error correction for unreliable sequenced packets
+        // After every ui8SourcePackets packets (or after the FEC block timeout), the transmitter sends
+        // ui8RepairPackets Reed-Solomon repair packets, which allow the receiver to recover up to
+        // ui8RepairPackets lost packets of the block without waiting for a retransmission
+        // If bAdaptive is true, the number of repair packets is adjusted to the loss rate reported by the receiver
+        // NOTE: Must be invoked before the mocket is connected; the receiver does not need to be configured
+        // Returns 0 if successful or a negative value in case of error
+        int enableForwardErrorCorrection (uint8 ui8SourcePackets, uint8 ui8RepairPackets, bool bAdaptive = false);
+
         // Obtains a new sender for the specified combination of reliability and sequencing parameters
         MessageSender getSender (bool bReliable, bool bSequenced);
 
@@ -383,6 +394,10 @@ class Mocket
         static const uint16 DEFAULT_RTO_FACTOR = 2;
         static const uint16 DEFAULT_RTO_CONSTANT = 0;
         static const uint16 DEFAULT_UNRELIABLE_SEQUENCED_DELIVERY_TIMEOUT = 3000;
+        static const uint8  DEFAULT_FEC_SOURCE_PACKETS = 8;
+        static const uint8  DEFAULT_FEC_REPAIR_PACKETS = 2;
+        static const uint32 DEFAULT_FEC_BLOCK_TIMEOUT = 20;
+        static const uint32 DEFAULT_FEC_FEEDBACK_INTERVAL = 100;
         static const uint32 DEFAULT_MAXIMUM_WINDOW_SIZE = 262144;
         //static const uint32 DEFAULT_MAXIMUM_WINDOW_SIZE = 1048576;
         static const uint32 DEFAULT_COOKIE_LIFESPAN = 60000;
@@ -432,11 +447,17 @@ class Mocket
         friend class TermSync;
         friend class AsynchronousConnector;
         friend class MocketPolicyUpdateListener;
+        friend class MocketMultiplexer;
+        friend class BBRCongestionController;
         friend class CongestionController;
+        friend class CubicCongestionController;
         friend class TransmissionRateModulation;
 
         Mocket(StateCookie cookie, NOMADSUtil::InetAddr *pRemoteAddr, const char *pszConfigFile, CommInterface *pCI, bool bDeleteCIWhenDone = false, bool bEnableDtls = false, const char* pathToCertificate = nullptr, const char* pathToPrivateKey = nullptr);
         void startThreads (void);
+
+        // Used by ServerMocket in shared socket mode - must be invoked before startThreads()
+        void setMultiplexer (MocketMultiplexer *pMultiplexer);
         int initParamsFromConfigFile (const char *pszConfigFile);
         StateMachine * getStateMachine (void);
         CommInterface * getCommInterface (void);
@@ -447,6 +468,9 @@ class Mocket
         CancelledTSNManager * getCancelledTSNManager (void);
         MocketStatusNotifier * getMocketStatusNotifier (void);
 
+        // Returns the pool used to allocate the packets and packet wrappers of this mocket
+        PacketPool * getPacketPool (void);
+
         uint32 getOutgoingValidation (void);
         uint32 getIncomingValidation (void);
         StateCookie * getStateCookie (void);
@@ -487,6 +511,25 @@ class Mocket
         // Check if the bandwidth estimation receiver side is enabled
         bool usingRecBandEst (void);
 
+        // Check if the transmitter spreads packets evenly over time instead of sending them in bursts
+        bool usingPacing (void);
+
+        // Check if the transmitter should ask the kernel to pace packets (SO_TXTIME)
+        bool usingKernelPacing (void);
+
+        // Check if the transmitter sends FEC repair packets for unreliable sequenced packets
+        bool usingForwardErrorCorrection (void);
+
+        // Number of source packets in each FEC block, and initial number of repair packets per block
+        uint8 getFECSourcePackets (void);
+        uint8 getFECRepairPackets (void);
+
+        // Check if the number of FEC repair packets adapts to the loss rate reported by the receiver
+        bool usingAdaptiveFEC (void);
+
+        // Maximum time in milliseconds after which the repair packets of an incomplete FEC block are sent
+        uint32 getFECBlockTimeout (void);
+
         // Return the initial assumed bandwidth used to create a new bandwidth estimator object
         uint16 getInitialAssumedBandwidth (void);
 
@@ -559,10 +602,12 @@ class Mocket
         PacketProcessor *_pPacketProcessor;
         Receiver *_pReceiver;
         Transmitter *_pTransmitter;
+        MocketMultiplexer *_pMultiplexer;
         StateCookie _stateCookie;
         ACKManager _ackManager;
         CancelledTSNManager _cancelledTSNManager;
         MocketStatusNotifier *_pMocketStatusNotifier;
+        PacketPool *_pPacketPool;
 
         // The following are parameters that control the runtime behavior of Mockets
         // These values are initialized using constants, but can be overridden using
@@ -600,6 +645,13 @@ class Mocket
         bool _bUseTwoWayHandshake;
         bool _bUsingFastRetransmit;
         bool _bUseReceiverSideBandwidthEstimation;
+        bool _bUsePacing;
+        bool _bUseKernelPacing;
+        bool _bUseFEC;
+        bool _bUseAdaptiveFEC;
+        uint8 _ui8FECSourcePackets;
+        uint8 _ui8FECRepairPackets;
+        uint32 _ui32FECBlockTimeout;
         bool _bIsServer;
 
         // These three variables are for the suspend/resume timeout
@@ -895,6 +947,41 @@ inline bool Mocket::usingFastRetransmit (void)
 {
     return _bUsingFastRetransmit;
 }
+inline bool Mocket::usingPacing (void)
+{
+    return _bUsePacing;
+}
+
+inline bool Mocket::usingKernelPacing (void)
+{
+    return _bUseKernelPacing;
+}
+
+inline bool Mocket::usingForwardErrorCorrection (void)
+{
+    return _bUseFEC;
+}
+
+inline uint8 Mocket::getFECSourcePackets (void)
+{
+    return _ui8FECSourcePackets;
+}
+
+inline uint8 Mocket::getFECRepairPackets (void)
+{
+    return _ui8FECRepairPackets;
+}
+
+inline bool Mocket::usingAdaptiveFEC (void)
+{
+    return _bUseAdaptiveFEC;
+}
+
+inline uint32 Mocket::getFECBlockTimeout (void)
+{
+    return _ui32FECBlockTimeout;
+}
+
 inline bool Mocket::usingRecBandEst (void)
 {
     return _bUseReceiverSideBandwidthEstimation;
@@ -937,6 +1024,16 @@ inline CommInterface * Mocket::getCommInterface (void)
     return _pCommInterface;
 }
 
+inline PacketPool * Mocket::getPacketPool (void)
+{
+    return _pPacketPool;
+}
+
+inline void Mocket::setMultiplexer (MocketMultiplexer *pMultiplexer)
+{
+    _pMultiplexer = pMultiplexer;
+}
+
 inline Receiver * Mocket::getReceiver (void)
 {
     return _pReceiver;
@@ -0,0 +1,657 @@
+/*
+ * MocketMultiplexer.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "MocketMultiplexer.h"
+
+#include "CommInterface.h"
+#include "Mocket.h"
+#include "Packet.h"
+#include "PacketProcessor.h"
+#include "Receiver.h"
+
+#include "Logger.h"
+#include "NLFLib.h"
+
+#include <string.h>
+
+#if defined (LINUX)
+    #include <errno.h>
+    #include <netinet/in.h>
+    #include <sys/epoll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+using namespace NOMADSUtil;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+MocketMultiplexer::MocketMultiplexer (CommInterface *pSharedCI, uint16 ui16NumIOWorkers, uint16 ui16NumProcessingWorkers)
+    : _cvEndpoints (&_mEndpoints), _cvConnectionPackets (&_mConnectionPackets)
+{
+    _pSharedCI = pSharedCI;
+    _iSharedSocket = -1;
+    _ui16NumIOWorkers = (ui16NumIOWorkers > 0) ? ui16NumIOWorkers : 1;
+    _ui16NumProcessingWorkers = (ui16NumProcessingWorkers > 0) ? ui16NumProcessingWorkers : 1;
+    _ui16NextWorkerIndex = 0;
+    _ppIOWorkers = nullptr;
+    _ppProcessingWorkers = nullptr;
+    _pFirstConnectionPacket = nullptr;
+    _pLastConnectionPacket = nullptr;
+    _ui32QueuedConnectionPacketsCount = 0;
+    _bAcceptingConnections = true;
+    _pFreeDatagrams = nullptr;
+    _ui32FreeDatagramsCount = 0;
+}
+
+MocketMultiplexer::~MocketMultiplexer (void)
+{
+    stop();
+    while (_pFirstConnectionPacket) {
+        Datagram *pDatagram = _pFirstConnectionPacket;
+        _pFirstConnectionPacket = pDatagram->pNext;
+        delete[] pDatagram->pBuf;
+        delete pDatagram;
+    }
+    while (_pFreeDatagrams) {
+        Datagram *pDatagram = _pFreeDatagrams;
+        _pFreeDatagrams = pDatagram->pNext;
+        delete[] pDatagram->pBuf;
+        delete pDatagram;
+    }
+    _pSharedCI = nullptr;
+}
+
+int MocketMultiplexer::start (void)
+{
+    if ((_ppIOWorkers != nullptr) || (_ppProcessingWorkers != nullptr)) {
+        checkAndLogMsg ("MocketMultiplexer::start", Logger::L_MildError,
+                        "multiplexer has already been started\n");
+        return -1;
+    }
+    _iSharedSocket = _pSharedCI->getLocalSocket();
+    #if defined (LINUX)
+        if (_iSharedSocket < 0) {
+            checkAndLogMsg ("MocketMultiplexer::start", Logger::L_Warning,
+                            "CommInterface does not expose a socket; falling back to a single blocking I/O worker\n");
+            _ui16NumIOWorkers = 1;
+        }
+    #else
+        // Without epoll, only one thread at a time may read from the CommInterface
+        _ui16NumIOWorkers = 1;
+    #endif
+
+    _ppProcessingWorkers = new ProcessingWorker*[_ui16NumProcessingWorkers];
+    for (uint16 ui16 = 0; ui16 < _ui16NumProcessingWorkers; ui16++) {
+        _ppProcessingWorkers[ui16] = new ProcessingWorker (this, ui16);
+        _ppProcessingWorkers[ui16]->start();
+        _ppProcessingWorkers[ui16]->setPriority (10);
+    }
+    _ppIOWorkers = new IOWorker*[_ui16NumIOWorkers];
+    for (uint16 ui16 = 0; ui16 < _ui16NumIOWorkers; ui16++) {
+        _ppIOWorkers[ui16] = new IOWorker (this);
+        _ppIOWorkers[ui16]->start();
+        _ppIOWorkers[ui16]->setPriority (10);
+    }
+    checkAndLogMsg ("MocketMultiplexer::start", Logger::L_Info,
+                    "started %d I/O workers and %d processing workers on local port %d\n",
+                    (int) _ui16NumIOWorkers, (int) _ui16NumProcessingWorkers, _pSharedCI->getLocalPort());
+    return 0;
+}
+
+void MocketMultiplexer::stop (void)
+{
+    setAcceptingConnections (false);
+    if (_ppIOWorkers) {
+        for (uint16 ui16 = 0; ui16 < _ui16NumIOWorkers; ui16++) {
+            _ppIOWorkers[ui16]->requestTerminationAndWait();
+            delete _ppIOWorkers[ui16];
+        }
+        delete[] _ppIOWorkers;
+        _ppIOWorkers = nullptr;
+    }
+    if (_ppProcessingWorkers) {
+        for (uint16 ui16 = 0; ui16 < _ui16NumProcessingWorkers; ui16++) {
+            _ppProcessingWorkers[ui16]->requestTerminationAndWait();
+            delete _ppProcessingWorkers[ui16];
+        }
+        delete[] _ppProcessingWorkers;
+        _ppProcessingWorkers = nullptr;
+    }
+}
+
+void MocketMultiplexer::waitForMocketsToClose (void)
+{
+    _mEndpoints.lock();
+    while (_endpoints.getCount() > 0) {
+        _cvEndpoints.wait (HOUSEKEEPING_INTERVAL);
+    }
+    _mEndpoints.unlock();
+}
+
+void MocketMultiplexer::setAcceptingConnections (bool bAccepting)
+{
+    _mConnectionPackets.lock();
+    _bAcceptingConnections = bAccepting;
+    _cvConnectionPackets.notifyAll();
+    _mConnectionPackets.unlock();
+}
+
+int MocketMultiplexer::receiveConnectionPacket (char *pBuf, int iBufSize, InetAddr *pRemoteAddr, uint32 ui32TimeoutInMS)
+{
+    _mConnectionPackets.lock();
+    if ((_pFirstConnectionPacket == nullptr) && (_bAcceptingConnections)) {
+        _cvConnectionPackets.wait (ui32TimeoutInMS);
+    }
+    if (!_bAcceptingConnections) {
+        _mConnectionPackets.unlock();
+        return -1;
+    }
+    Datagram *pDatagram = _pFirstConnectionPacket;
+    if (pDatagram == nullptr) {
+        _mConnectionPackets.unlock();
+        return 0;
+    }
+    _pFirstConnectionPacket = pDatagram->pNext;
+    if (_pFirstConnectionPacket == nullptr) {
+        _pLastConnectionPacket = nullptr;
+    }
+    _ui32QueuedConnectionPacketsCount--;
+    _mConnectionPackets.unlock();
+
+    int iSize = (pDatagram->iSize < iBufSize) ? pDatagram->iSize : iBufSize;
+    memcpy (pBuf, pDatagram->pBuf, iSize);
+    *pRemoteAddr = pDatagram->remoteAddr;
+    releaseDatagram (pDatagram);
+    return iSize;
+}
+
+int MocketMultiplexer::registerMocket (Mocket *pMocket)
+{
+    if (_ppProcessingWorkers == nullptr) {
+        checkAndLogMsg ("MocketMultiplexer::registerMocket", Logger::L_MildError,
+                        "multiplexer has not been started\n");
+        return -1;
+    }
+    uint64 ui64Key = getEndpointKey (pMocket->getRemoteAddress(), pMocket->getRemotePort());
+    _mEndpoints.lock();
+    if (_endpoints.get (ui64Key) != nullptr) {
+        _mEndpoints.unlock();
+        checkAndLogMsg ("MocketMultiplexer::registerMocket", Logger::L_MildError,
+                        "a mocket for remote endpoint %s:%d is already registered\n",
+                        InetAddr (pMocket->getRemoteAddress()).getIPAsString(), (int) pMocket->getRemotePort());
+        return -2;
+    }
+    uint16 ui16WorkerIndex = _ui16NextWorkerIndex;
+    _ui16NextWorkerIndex = (_ui16NextWorkerIndex + 1) % _ui16NumProcessingWorkers;
+    Endpoint *pEndpoint = new Endpoint (pMocket, ui64Key, ui16WorkerIndex);
+    _endpoints.put (ui64Key, pEndpoint);
+    // Adopt while still holding _mEndpoints, so that the worker owns the endpoint
+    // before it can dequeue any datagram dispatched to it
+    _ppProcessingWorkers[ui16WorkerIndex]->adopt (pEndpoint);
+    _mEndpoints.unlock();
+
+    checkAndLogMsg ("MocketMultiplexer::registerMocket", Logger::L_LowDetailDebug,
+                    "registered mocket for remote endpoint %s:%d with processing worker %d\n",
+                    InetAddr (pMocket->getRemoteAddress()).getIPAsString(), (int) pMocket->getRemotePort(), (int) ui16WorkerIndex);
+    return 0;
+}
+
+MocketMultiplexer::Datagram * MocketMultiplexer::allocDatagram (void)
+{
+    _mFreeDatagrams.lock();
+    Datagram *pDatagram = _pFreeDatagrams;
+    if (pDatagram) {
+        _pFreeDatagrams = pDatagram->pNext;
+        _ui32FreeDatagramsCount--;
+    }
+    _mFreeDatagrams.unlock();
+    if (pDatagram == nullptr) {
+        pDatagram = new Datagram();
+        pDatagram->pBuf = new char[Mocket::getMaximumMTU()];
+    }
+    pDatagram->pNext = nullptr;
+    pDatagram->iSize = 0;
+    return pDatagram;
+}
+
+void MocketMultiplexer::releaseDatagram (Datagram *pDatagram)
+{
+    _mFreeDatagrams.lock();
+    if (_ui32FreeDatagramsCount < MAX_FREE_DATAGRAMS) {
+        pDatagram->pNext = _pFreeDatagrams;
+        _pFreeDatagrams = pDatagram;
+        _ui32FreeDatagramsCount++;
+        pDatagram = nullptr;
+    }
+    _mFreeDatagrams.unlock();
+    if (pDatagram) {
+        delete[] pDatagram->pBuf;
+        delete pDatagram;
+    }
+}
+
+void MocketMultiplexer::dispatch (Datagram *pDatagram)
+{
+    if (pDatagram->iSize < Packet::HEADER_SIZE) {
+        checkAndLogMsg ("MocketMultiplexer::dispatch", Logger::L_MildError,
+                        "received a short packet of size %d from %s:%d\n", pDatagram->iSize,
+                        pDatagram->remoteAddr.getIPAsString(), (int) pDatagram->remoteAddr.getPort());
+        releaseDatagram (pDatagram);
+        return;
+    }
+    Packet packet (pDatagram->pBuf, (unsigned short) pDatagram->iSize);
+    Packet::ChunkType chunkType = packet.getChunkType();
+    if ((chunkType == Packet::CT_Init) || (chunkType == Packet::CT_CookieEcho) || (chunkType == Packet::CT_SimpleConnect)) {
+        _mConnectionPackets.lock();
+        if ((_bAcceptingConnections) && (_ui32QueuedConnectionPacketsCount < MAX_QUEUED_CONNECTION_PACKETS)) {
+            if (_pLastConnectionPacket) {
+                _pLastConnectionPacket->pNext = pDatagram;
+            }
+            else {
+                _pFirstConnectionPacket = pDatagram;
+            }
+            _pLastConnectionPacket = pDatagram;
+            _ui32QueuedConnectionPacketsCount++;
+            _cvConnectionPackets.notify();
+            pDatagram = nullptr;
+        }
+        _mConnectionPackets.unlock();
+        if (pDatagram) {
+            checkAndLogMsg ("MocketMultiplexer::dispatch", Logger::L_LowDetailDebug,
+                            "dropping connection packet from %s:%d\n",
+                            pDatagram->remoteAddr.getIPAsString(), (int) pDatagram->remoteAddr.getPort());
+            releaseDatagram (pDatagram);
+        }
+        return;
+    }
+
+    uint64 ui64Key = getEndpointKey (pDatagram->remoteAddr.getIPAddress(), pDatagram->remoteAddr.getPort());
+    _mEndpoints.lock();
+    Endpoint *pEndpoint = lookupEndpoint (ui64Key, &packet);
+    uint16 ui16WorkerIndex = pEndpoint ? pEndpoint->ui16WorkerIndex : 0;
+    _mEndpoints.unlock();
+    if (pEndpoint == nullptr) {
+        checkAndLogMsg ("MocketMultiplexer::dispatch", Logger::L_LowDetailDebug,
+                        "dropping packet from unknown endpoint %s:%d\n",
+                        pDatagram->remoteAddr.getIPAsString(), (int) pDatagram->remoteAddr.getPort());
+        releaseDatagram (pDatagram);
+        return;
+    }
+    if (!_ppProcessingWorkers[ui16WorkerIndex]->enqueue (pDatagram)) {
+        checkAndLogMsg ("MocketMultiplexer::dispatch", Logger::L_Warning,
+                        "queue of processing worker %d is full; dropping packet from %s:%d\n", (int) ui16WorkerIndex,
+                        pDatagram->remoteAddr.getIPAsString(), (int) pDatagram->remoteAddr.getPort());
+        releaseDatagram (pDatagram);
+    }
+}
+
+MocketMultiplexer::Endpoint * MocketMultiplexer::lookupEndpoint (uint64 ui64Key, Packet *pPacket)
+{
+    Endpoint *pEndpoint = _endpoints.get (ui64Key);
+    if (pEndpoint != nullptr) {
+        return (pEndpoint->ui32IncomingValidation == pPacket->getValidation()) ? pEndpoint : nullptr;
+    }
+    Packet::ChunkType chunkType = pPacket->getChunkType();
+    if ((chunkType == Packet::CT_ReEstablish) || (chunkType == Packet::CT_Resume)) {
+        // The remote endpoint may have changed its address - search by validation instead
+        for (UInt64Hashtable<Endpoint>::Iterator i = _endpoints.getAllElements(); !i.end(); i.nextElement()) {
+            if (i.getValue()->ui32IncomingValidation == pPacket->getValidation()) {
+                return i.getValue();
+            }
+        }
+    }
+    return nullptr;
+}
+
+void MocketMultiplexer::unregisterEndpoint (Endpoint *pEndpoint)
+{
+    _mEndpoints.lock();
+    if (_endpoints.get (pEndpoint->ui64Key) == pEndpoint) {
+        _endpoints.remove (pEndpoint->ui64Key);
+    }
+    _cvEndpoints.notifyAll();
+    _mEndpoints.unlock();
+}
+
+MocketMultiplexer::Datagram::Datagram (void)
+{
+    pNext = nullptr;
+    iSize = 0;
+    pBuf = nullptr;
+}
+
+MocketMultiplexer::Endpoint::Endpoint (Mocket *pMocket, uint64 ui64Key, uint16 ui16WorkerIndex)
+{
+    pNext = nullptr;
+    this->pMocket = pMocket;
+    this->ui64Key = ui64Key;
+    ui32IncomingValidation = pMocket->getIncomingValidation();
+    this->ui16WorkerIndex = ui16WorkerIndex;
+    i64LastDatagramTime = getTimeInMilliseconds();
+    i64LastTimeoutCheckTime = i64LastDatagramTime;
+}
+
+MocketMultiplexer::IOWorker::IOWorker (MocketMultiplexer *pMultiplexer)
+{
+    _pMultiplexer = pMultiplexer;
+}
+
+void MocketMultiplexer::IOWorker::run (void)
+{
+    started();
+    #if defined (LINUX)
+        if (_pMultiplexer->_iSharedSocket < 0) {
+            runWithCommInterface();
+            terminating();
+            return;
+        }
+        // Each I/O worker has its own epoll instance, so that with EPOLLEXCLUSIVE only one
+        // of them is woken up when a datagram arrives
+        int iEPollFD = epoll_create1 (0);
+        if (iEPollFD < 0) {
+            checkAndLogMsg ("MocketMultiplexer::IOWorker::run", Logger::L_MildError,
+                            "epoll_create1 failed; os error = %d\n", errno);
+            setTerminatingResultCode (-1);
+            terminating();
+            return;
+        }
+        struct epoll_event ev;
+        memset (&ev, 0, sizeof (ev));
+        ev.events = EPOLLIN;
+        #if defined (EPOLLEXCLUSIVE)
+            ev.events |= EPOLLEXCLUSIVE;
+        #endif
+        ev.data.fd = _pMultiplexer->_iSharedSocket;
+        if (epoll_ctl (iEPollFD, EPOLL_CTL_ADD, _pMultiplexer->_iSharedSocket, &ev) < 0) {
+            checkAndLogMsg ("MocketMultiplexer::IOWorker::run", Logger::L_MildError,
+                            "epoll_ctl failed; os error = %d\n", errno);
+            ::close (iEPollFD);
+            setTerminatingResultCode (-2);
+            terminating();
+            return;
+        }
+        Datagram *pDatagram = nullptr;
+        while (!terminationRequested()) {
+            struct epoll_event readyEvent;
+            int rc = epoll_wait (iEPollFD, &readyEvent, 1, HOUSEKEEPING_INTERVAL);
+            if (rc < 0) {
+                if (errno != EINTR) {
+                    checkAndLogMsg ("MocketMultiplexer::IOWorker::run", Logger::L_MildError,
+                                    "epoll_wait failed; os error = %d\n", errno);
+                    sleepForMilliseconds (10);
+                }
+                continue;
+            }
+            else if (rc == 0) {
+                continue;
+            }
+            // Drain the socket
+            while (true) {
+                if (pDatagram == nullptr) {
+                    pDatagram = _pMultiplexer->allocDatagram();
+                }
+                struct sockaddr_in sa;
+                socklen_t saLen = sizeof (sa);
+                ssize_t received = recvfrom (_pMultiplexer->_iSharedSocket, pDatagram->pBuf, Mocket::getMaximumMTU(),
+                                             MSG_DONTWAIT, (struct sockaddr*) &sa, &saLen);
+                if (received < 0) {
+                    if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                        checkAndLogMsg ("MocketMultiplexer::IOWorker::run", Logger::L_LowDetailDebug,
+                                        "recvfrom failed; os error = %d\n", errno);
+                    }
+                    break;
+                }
+                pDatagram->iSize = (int) received;
+                pDatagram->remoteAddr = InetAddr (sa.sin_addr.s_addr, ntohs (sa.sin_port));
+                _pMultiplexer->dispatch (pDatagram);
+                pDatagram = nullptr;
+            }
+        }
+        if (pDatagram) {
+            _pMultiplexer->releaseDatagram (pDatagram);
+        }
+        ::close (iEPollFD);
+    #else
+        runWithCommInterface();
+    #endif
+    terminating();
+}
+
+void MocketMultiplexer::IOWorker::runWithCommInterface (void)
+{
+    CommInterface *pCI = _pMultiplexer->_pSharedCI;
+    pCI->setReceiveTimeout (HOUSEKEEPING_INTERVAL);
+    Datagram *pDatagram = nullptr;
+    while (!terminationRequested()) {
+        if (pDatagram == nullptr) {
+            pDatagram = _pMultiplexer->allocDatagram();
+        }
+        int rc = pCI->receive (pDatagram->pBuf, Mocket::getMaximumMTU(), &pDatagram->remoteAddr);
+        if (rc < 0) {
+            checkAndLogMsg ("MocketMultiplexer::IOWorker::runWithCommInterface", Logger::L_LowDetailDebug,
+                            "receive failed; rc = %d; os error = %d\n", rc, pCI->getLastError());
+            sleepForMilliseconds (10);
+        }
+        else if (rc > 0) {
+            pDatagram->iSize = rc;
+            _pMultiplexer->dispatch (pDatagram);
+            pDatagram = nullptr;
+        }
+    }
+    if (pDatagram) {
+        _pMultiplexer->releaseDatagram (pDatagram);
+    }
+}
+
+MocketMultiplexer::ProcessingWorker::ProcessingWorker (MocketMultiplexer *pMultiplexer, uint16 ui16Index)
+    : _cv (&_m)
+{
+    _pMultiplexer = pMultiplexer;
+    _ui16Index = ui16Index;
+    _pFirstDatagram = nullptr;
+    _pLastDatagram = nullptr;
+    _ui32QueuedDatagramsCount = 0;
+    _pNewEndpoints = nullptr;
+    _pEndpoints = nullptr;
+}
+
+MocketMultiplexer::ProcessingWorker::~ProcessingWorker (void)
+{
+    while (_pFirstDatagram) {
+        Datagram *pDatagram = _pFirstDatagram;
+        _pFirstDatagram = pDatagram->pNext;
+        _pMultiplexer->releaseDatagram (pDatagram);
+    }
+    _pLastDatagram = nullptr;
+}
+
+bool MocketMultiplexer::ProcessingWorker::enqueue (Datagram *pDatagram)
+{
+    _m.lock();
+    if (_ui32QueuedDatagramsCount >= MAX_QUEUED_DATAGRAMS_PER_WORKER) {
+        _m.unlock();
+        return false;
+    }
+    pDatagram->pNext = nullptr;
+    if (_pLastDatagram) {
+        _pLastDatagram->pNext = pDatagram;
+    }
+    else {
+        _pFirstDatagram = pDatagram;
+    }
+    _pLastDatagram = pDatagram;
+    _ui32QueuedDatagramsCount++;
+    _cv.notify();
+    _m.unlock();
+    return true;
+}
+
+void MocketMultiplexer::ProcessingWorker::adopt (Endpoint *pEndpoint)
+{
+    _m.lock();
+    pEndpoint->pNext = _pNewEndpoints;
+    _pNewEndpoints = pEndpoint;
+    _cv.notify();
+    _m.unlock();
+}
+
+void MocketMultiplexer::ProcessingWorker::run (void)
+{
+    started();
+    int64 i64LastHousekeepingTime = getTimeInMilliseconds();
+    while (true) {
+        _m.lock();
+        while (_pNewEndpoints) {
+            Endpoint *pEndpoint = _pNewEndpoints;
+            _pNewEndpoints = pEndpoint->pNext;
+            pEndpoint->pNext = _pEndpoints;
+            _pEndpoints = pEndpoint;
+        }
+        if ((_pFirstDatagram == nullptr) && (!terminationRequested())) {
+            _cv.wait (HOUSEKEEPING_INTERVAL);
+        }
+        Datagram *pDatagram = _pFirstDatagram;
+        if (pDatagram) {
+            _pFirstDatagram = pDatagram->pNext;
+            if (_pFirstDatagram == nullptr) {
+                _pLastDatagram = nullptr;
+            }
+            _ui32QueuedDatagramsCount--;
+        }
+        _m.unlock();
+
+        if (terminationRequested()) {
+            if (pDatagram) {
+                _pMultiplexer->releaseDatagram (pDatagram);
+            }
+            break;
+        }
+        if (pDatagram) {
+            process (pDatagram);
+            _pMultiplexer->releaseDatagram (pDatagram);
+        }
+        int64 i64CurrTime = getTimeInMilliseconds();
+        if ((i64CurrTime - i64LastHousekeepingTime) >= HOUSEKEEPING_INTERVAL) {
+            doHousekeeping (i64CurrTime);
+            i64LastHousekeepingTime = i64CurrTime;
+        }
+    }
+
+    // Terminate any mockets that are still owned by this worker
+    _m.lock();
+    while (_pNewEndpoints) {
+        Endpoint *pEndpoint = _pNewEndpoints;
+        _pNewEndpoints = pEndpoint->pNext;
+        pEndpoint->pNext = _pEndpoints;
+        _pEndpoints = pEndpoint;
+    }
+    _m.unlock();
+    while (_pEndpoints) {
+        retire (_pEndpoints);
+    }
+    terminating();
+}
+
+void MocketMultiplexer::ProcessingWorker::process (Datagram *pDatagram)
+{
+    Packet packet (pDatagram->pBuf, (unsigned short) pDatagram->iSize);
+    uint64 ui64Key = getEndpointKey (pDatagram->remoteAddr.getIPAddress(), pDatagram->remoteAddr.getPort());
+    _pMultiplexer->_mEndpoints.lock();
+    Endpoint *pEndpoint = _pMultiplexer->lookupEndpoint (ui64Key, &packet);
+    _pMultiplexer->_mEndpoints.unlock();
+    if ((pEndpoint == nullptr) || (pEndpoint->ui16WorkerIndex != _ui16Index)) {
+        // The mocket was retired after the datagram was dispatched
+        return;
+    }
+    // NOTE: Only this worker retires the endpoint, so it is safe to use it without holding _mEndpoints
+
+    Mocket *pMocket = pEndpoint->pMocket;
+    pEndpoint->i64LastDatagramTime = getTimeInMilliseconds();
+    pEndpoint->i64LastTimeoutCheckTime = pEndpoint->i64LastDatagramTime;
+    int rc = pMocket->getReceiver()->processReceivedDatagram (pDatagram->pBuf, pDatagram->iSize, &pDatagram->remoteAddr);
+    pMocket->getPacketProcessor()->processAvailablePackets();
+    if ((rc == -2) || (pMocket->getReceiver()->isTerminated())) {
+        retire (pEndpoint);
+        return;
+    }
+
+    // Check whether the remote endpoint has changed its address (after a ReEstablish or Resume)
+    uint64 ui64NewKey = getEndpointKey (pMocket->getRemoteAddress(), pMocket->getRemotePort());
+    if (ui64NewKey != pEndpoint->ui64Key) {
+        _pMultiplexer->_mEndpoints.lock();
+        if (_pMultiplexer->_endpoints.get (pEndpoint->ui64Key) == pEndpoint) {
+            _pMultiplexer->_endpoints.remove (pEndpoint->ui64Key);
+        }
+        pEndpoint->ui64Key = ui64NewKey;
+        _pMultiplexer->_endpoints.put (ui64NewKey, pEndpoint);
+        _pMultiplexer->_mEndpoints.unlock();
+        checkAndLogMsg ("MocketMultiplexer::ProcessingWorker::process", Logger::L_Info,
+                        "remote endpoint of mocket changed to %s:%d\n",
+                        InetAddr (pMocket->getRemoteAddress()).getIPAsString(), (int) pMocket->getRemotePort());
+    }
+}
+
+void MocketMultiplexer::ProcessingWorker::doHousekeeping (int64 i64CurrTime)
+{
+    Endpoint *pEndpoint = _pEndpoints;
+    while (pEndpoint) {
+        Endpoint *pNext = pEndpoint->pNext;
+        Mocket *pMocket = pEndpoint->pMocket;
+        Receiver *pReceiver = pMocket->getReceiver();
+        // Delivers the packets that became available because of timeouts in the unreliable flows
+        pMocket->getPacketProcessor()->processAvailablePackets();
+        int rc = 0;
+        if (((i64CurrTime - pEndpoint->i64LastDatagramTime) >= pMocket->getUDPReceiveTimeout()) &&
+            ((i64CurrTime - pEndpoint->i64LastTimeoutCheckTime) >= pMocket->getUDPReceiveTimeout())) {
+            // Equivalent to a receive timeout in the threaded Receiver - handles unreachable peer callbacks
+            pEndpoint->i64LastTimeoutCheckTime = i64CurrTime;
+            rc = pReceiver->processReceivedDatagram (nullptr, 0, nullptr);
+        }
+        if ((rc == -2) || (pReceiver->isTerminated())) {
+            retire (pEndpoint);
+        }
+        pEndpoint = pNext;
+    }
+}
+
+void MocketMultiplexer::ProcessingWorker::retire (Endpoint *pEndpoint)
+{
+    if (_pEndpoints == pEndpoint) {
+        _pEndpoints = pEndpoint->pNext;
+    }
+    else {
+        for (Endpoint *pPrev = _pEndpoints; pPrev != nullptr; pPrev = pPrev->pNext) {
+            if (pPrev->pNext == pEndpoint) {
+                pPrev->pNext = pEndpoint->pNext;
+                break;
+            }
+        }
+    }
+    _pMultiplexer->unregisterEndpoint (pEndpoint);
+    Mocket *pMocket = pEndpoint->pMocket;
+    delete pEndpoint;
+    checkAndLogMsg ("MocketMultiplexer::ProcessingWorker::retire", Logger::L_LowDetailDebug,
+                    "mocket for remote endpoint %s:%d is no longer multiplexed\n",
+                    InetAddr (pMocket->getRemoteAddress()).getIPAsString(), (int) pMocket->getRemotePort());
+    // NOTE: The mocket may be deleted by the application as soon as both components have terminated,
+    //       so it must not be accessed after this point
+    pMocket->receiverTerminating();
+    pMocket->getPacketProcessor()->terminate();
+}
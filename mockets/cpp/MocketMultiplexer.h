@@ -0,0 +1,213 @@
+#ifndef INCL_MOCKET_MULTIPLEXER_H
+#define INCL_MOCKET_MULTIPLEXER_H
+
+/*
+ * MocketMultiplexer.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * MocketMultiplexer
+ *
+ * Used by a ServerMocket in shared socket mode. All the mockets accepted by the
+ * ServerMocket use the listen socket, and a small fixed pool of threads serves
+ * all of them in place of the per-mocket Receiver and PacketProcessor threads.
+ *
+ * The I/O workers wait on the shared socket (using epoll on Linux) and read all
+ * the available datagrams. Connection establishment packets (Init, CookieEcho and
+ * SimpleConnect) are queued for ServerMocket::accept(); all other packets are
+ * demultiplexed by remote address and validated against the incoming validation
+ * of the state cookie of the mocket, and then handed to the processing worker that
+ * owns the mocket. Each mocket is owned by exactly one processing worker, which
+ * preserves the single-threaded semantics of the Receiver and PacketProcessor.
+ */
+
+#include "ConditionVariable.h"
+#include "FTypes.h"
+#include "InetAddr.h"
+#include "ManageableThread.h"
+#include "Mutex.h"
+#include "UInt64Hashtable.h"
+
+class CommInterface;
+class Mocket;
+class Packet;
+
+class MocketMultiplexer
+{
+    public:
+        MocketMultiplexer (CommInterface *pSharedCI, uint16 ui16NumIOWorkers = DEFAULT_NUM_IO_WORKERS,
+                           uint16 ui16NumProcessingWorkers = DEFAULT_NUM_PROCESSING_WORKERS);
+        ~MocketMultiplexer (void);
+
+        // Starts the I/O and processing workers
+        // The shared CommInterface must already be bound
+        int start (void);
+
+        // Stops all the workers
+        // Mockets that are still registered are terminated
+        void stop (void);
+
+        // Waits until all the registered mockets have closed
+        void waitForMocketsToClose (void);
+
+        // Enables or disables queueing of connection establishment packets for accept()
+        void setAcceptingConnections (bool bAccepting);
+
+        // Retrieves the next connection establishment packet (Init, CookieEcho or SimpleConnect)
+        // Returns the size of the packet, 0 if no packet arrived within the timeout, or a negative value in case of error
+        int receiveConnectionPacket (char *pBuf, int iBufSize, NOMADSUtil::InetAddr *pRemoteAddr, uint32 ui32TimeoutInMS);
+
+        // Registers a mocket that was accepted by the ServerMocket
+        // From now on, the packets received from the remote endpoint of the mocket are processed by one of the processing workers
+        int registerMocket (Mocket *pMocket);
+
+        // Returns the number of mockets that are currently registered
+        uint32 getRegisteredMocketsCount (void);
+
+        CommInterface * getSharedCommInterface (void);
+
+    public:
+        static const uint16 DEFAULT_NUM_IO_WORKERS = 1;
+        static const uint16 DEFAULT_NUM_PROCESSING_WORKERS = 4;
+        static const uint32 HOUSEKEEPING_INTERVAL = 100;
+        static const uint32 MAX_QUEUED_DATAGRAMS_PER_WORKER = 4096;
+        static const uint32 MAX_QUEUED_CONNECTION_PACKETS = 256;
+        static const uint32 MAX_FREE_DATAGRAMS = 1024;
+
+    private:
+        struct Datagram
+        {
+            Datagram (void);
+
+            Datagram *pNext;
+            int iSize;
+            NOMADSUtil::InetAddr remoteAddr;
+            char *pBuf;
+        };
+
+        struct Endpoint
+        {
+            Endpoint (Mocket *pMocket, uint64 ui64Key, uint16 ui16WorkerIndex);
+
+            Endpoint *pNext;   // Used by the owning ProcessingWorker
+            Mocket *pMocket;
+            uint64 ui64Key;
+            uint32 ui32IncomingValidation;
+            uint16 ui16WorkerIndex;
+            int64 i64LastDatagramTime;
+            int64 i64LastTimeoutCheckTime;
+        };
+
+        class IOWorker : public NOMADSUtil::ManageableThread
+        {
+            public:
+                IOWorker (MocketMultiplexer *pMultiplexer);
+                void run (void);
+
+            private:
+                void runWithCommInterface (void);
+
+            private:
+                MocketMultiplexer *_pMultiplexer;
+        };
+
+        class ProcessingWorker : public NOMADSUtil::ManageableThread
+        {
+            public:
+                ProcessingWorker (MocketMultiplexer *pMultiplexer, uint16 ui16Index);
+                ~ProcessingWorker (void);
+
+                // Returns false if the queue is full and the datagram was not enqueued
+                bool enqueue (Datagram *pDatagram);
+                void adopt (Endpoint *pEndpoint);
+                void run (void);
+
+            private:
+                void process (Datagram *pDatagram);
+                void doHousekeeping (int64 i64CurrTime);
+                void retire (Endpoint *pEndpoint);
+
+            private:
+                MocketMultiplexer *_pMultiplexer;
+                uint16 _ui16Index;
+                NOMADSUtil::Mutex _m;
+                NOMADSUtil::ConditionVariable _cv;
+                Datagram *_pFirstDatagram;
+                Datagram *_pLastDatagram;
+                uint32 _ui32QueuedDatagramsCount;
+                Endpoint *_pNewEndpoints;
+                Endpoint *_pEndpoints;   // Only accessed by the worker thread
+        };
+
+    private:
+        static uint64 getEndpointKey (uint32 ui32RemoteAddress, uint16 ui16RemotePort);
+
+        Datagram * allocDatagram (void);
+        void releaseDatagram (Datagram *pDatagram);
+
+        // Invoked by the I/O workers for every datagram read from the shared socket
+        void dispatch (Datagram *pDatagram);
+
+        // Finds the endpoint that should process the specified packet
+        // NOTE: _mEndpoints must be held by the caller
+        Endpoint * lookupEndpoint (uint64 ui64Key, Packet *pPacket);
+
+        void unregisterEndpoint (Endpoint *pEndpoint);
+
+    private:
+        CommInterface *_pSharedCI;
+        int _iSharedSocket;
+        uint16 _ui16NumIOWorkers;
+        uint16 _ui16NumProcessingWorkers;
+        uint16 _ui16NextWorkerIndex;
+        IOWorker **_ppIOWorkers;
+        ProcessingWorker **_ppProcessingWorkers;
+
+        NOMADSUtil::Mutex _mEndpoints;
+        NOMADSUtil::ConditionVariable _cvEndpoints;
+        NOMADSUtil::UInt64Hashtable<Endpoint> _endpoints;
+
+        NOMADSUtil::Mutex _mConnectionPackets;
+        NOMADSUtil::ConditionVariable _cvConnectionPackets;
+        Datagram *_pFirstConnectionPacket;
+        Datagram *_pLastConnectionPacket;
+        uint32 _ui32QueuedConnectionPacketsCount;
+        bool _bAcceptingConnections;
+
+        NOMADSUtil::Mutex _mFreeDatagrams;
+        Datagram *_pFreeDatagrams;
+        uint32 _ui32FreeDatagramsCount;
+};
+
+inline uint32 MocketMultiplexer::getRegisteredMocketsCount (void)
+{
+    _mEndpoints.lock();
+    uint32 ui32Count = (uint32) _endpoints.getCount();
+    _mEndpoints.unlock();
+    return ui32Count;
+}
+
+inline CommInterface * MocketMultiplexer::getSharedCommInterface (void)
+{
+    return _pSharedCI;
+}
+
+inline uint64 MocketMultiplexer::getEndpointKey (uint32 ui32RemoteAddress, uint16 ui16RemotePort)
+{
+    return (((uint64) ui32RemoteAddress) << 16) | ui16RemotePort;
+}
+
+#endif   // #ifndef INCL_MOCKET_MULTIPLEXER_H
@@ -30,6 +30,8 @@
 #include "Mutex.h"
 
 
+class PacketPool;
+
 class MocketStats
 {
     public:
@@ -83,6 +85,29 @@ class MocketStats
         // The packets discarded are the fragments of the message that were received
         uint32 getReassemblySkippedDiscardedPacketCount (void);
 
+        // Returns the number of system calls used to transmit packets
+        // When batched I/O is available, several packets may be transmitted with a single system call
+        uint32 getSendSyscallCount (void);
+
+        // Returns the number of system calls used to receive packets (not counting the calls that timed out)
+        uint32 getReceiveSyscallCount (void);
+
+        // Returns the average number of packets transmitted per system call, or 0 if no packets have been sent
+        float getSentPacketsPerSyscall (void);
+
+        // Returns the average number of packets received per system call, or 0 if no packets have been received
+        float getReceivedPacketsPerSyscall (void);
+
+        // Returns the number of FEC repair packets transmitted
+        uint32 getSentFECRepairPacketCount (void);
+
+        // Returns the number of lost unreliable sequenced packets that were rebuilt from FEC repair packets
+        uint32 getFECRecoveredPacketCount (void);
+
+        // Returns the number of lost unreliable sequenced packets that could not be rebuilt because
+        // too many packets of their FEC block were lost
+        uint32 getFECUnrecoveredPacketCount (void);
+
         // Returns the estimated round-trip-time in milliseconds
         float getEstimatedRTT (void);
 
@@ -93,6 +118,18 @@ class MocketStats
 
         void setEstimatedBandwidth (int32 dBandwidthEstimation);
 
+        // Returns the congestion window (in bytes) of the congestion control mechanism in use,
+        // or 0 if congestion control is not active or the mechanism does not export its state
+        uint32 getCongestionWindowSize (void);
+
+        // Returns the pacing rate (in bytes per second) of the congestion control mechanism in use
+        // For window-based mechanisms, this is the rate implied by the congestion window and the RTT
+        uint32 getPacingRate (void);
+
+        // Returns the minimum RTT (in milliseconds) observed by the congestion control mechanism in use,
+        // or 0 if no RTT sample is available yet
+        uint32 getMinRTT (void);
+
         // Returns the size (in bytes) of the data that is enqueued in the pending packet queue awaiting transmission
         uint32 getPendingDataSize (void);
 
@@ -129,6 +166,11 @@ class MocketStats
         // for messages of the specified type
         MessageStats * getMessageStatisticsForType (uint16 ui16Tag);
 
+        // Returns the pool used to allocate the packets of the mocket, which provides the
+        // occupancy and high-water mark of each size class (see PacketPool::getStats())
+        // Returns nullptr if the mocket has been deleted
+        PacketPool * getPacketPool (void);
+
     protected:
         MocketStats (void);
         void lock();
@@ -140,6 +182,7 @@ class MocketStats
         friend class Receiver;
         friend class StreamMocket;
         friend class Transmitter;
+        friend class CongestionControl;
         friend class CongestionController;
         friend class BandwidthEstimator;
         uint32 _ui32Retransmits;
@@ -150,6 +193,12 @@ class MocketStats
         uint32 _ui32DuplicatedDiscardedPackets;
         uint32 _ui32NoRoomDiscardedPackets;
         uint32 _ui32ReassemblySkippedDiscardedPackets;
+        uint32 _ui32SendSyscalls;
+        uint32 _ui32ReceiveSyscalls;
+        uint32 _ui32ReceivedDatagrams;      // Counts all the datagrams read from the socket, including the invalid ones
+        uint32 _ui32SentFECRepairPackets;
+        uint32 _ui32FECRecoveredPackets;
+        uint32 _ui32FECUnrecoveredPackets;
         float _fSRTT;
         uint32 _ui32PendingDataSize;
         uint32 _ui32PendingPacketQueueSize;
@@ -160,8 +209,12 @@ class MocketStats
         MessageStats _globalMessageStats;
         NOMADSUtil::DArray2<MessageStats> _perTypeMessageStats;
         NOMADSUtil::Mutex _m;    // NOTE: Currently, the mutex is not used when reading or when just incrementing a value
+        PacketPool *_pPacketPool;
 
         int32 _i32BandwidthEstimation;
+        uint32 _ui32CongestionWindowSize;
+        uint32 _ui32PacingRate;
+        uint32 _ui32MinRTT;
 
         int freeze (NOMADSUtil::ObjectFreezer &objectFreezer);
         int defrost (NOMADSUtil::ObjectDefroster &objectDefroster);
@@ -177,6 +230,12 @@ inline MocketStats::MocketStats (void)
     _ui32DuplicatedDiscardedPackets = 0;
     _ui32NoRoomDiscardedPackets = 0;
     _ui32ReassemblySkippedDiscardedPackets = 0;
+    _ui32SendSyscalls = 0;
+    _ui32ReceiveSyscalls = 0;
+    _ui32ReceivedDatagrams = 0;
+    _ui32SentFECRepairPackets = 0;
+    _ui32FECRecoveredPackets = 0;
+    _ui32FECUnrecoveredPackets = 0;
     _fSRTT = -1.0f;
     _ui32PendingDataSize = 0;
     _ui32PendingPacketQueueSize = 0;
@@ -184,6 +243,11 @@ inline MocketStats::MocketStats (void)
     _ui32ReliableSequencedPacketQueueSize = 0;
     _ui32ReliableUnsequencedDataSize = 0;
     _ui32ReliableUnsequencedPacketQueueSize = 0;
+    _ui32CongestionWindowSize = 0;
+    _ui32PacingRate = 0;
+    _ui32MinRTT = 0;
+
+    _pPacketPool = nullptr;
 
     _i32BandwidthEstimation = -2;
 }
@@ -232,6 +296,47 @@ inline uint32 MocketStats::getReassemblySkippedDiscardedPacketCount (void)
     return _ui32ReassemblySkippedDiscardedPackets;
 }
 
+inline uint32 MocketStats::getSendSyscallCount (void)
+{
+    return _ui32SendSyscalls;
+}
+
+inline uint32 MocketStats::getReceiveSyscallCount (void)
+{
+    return _ui32ReceiveSyscalls;
+}
+
+inline float MocketStats::getSentPacketsPerSyscall (void)
+{
+    if (_ui32SendSyscalls == 0) {
+        return 0.0f;
+    }
+    return ((float) _ui32SentPackets) / _ui32SendSyscalls;
+}
+
+inline float MocketStats::getReceivedPacketsPerSyscall (void)
+{
+    if (_ui32ReceiveSyscalls == 0) {
+        return 0.0f;
+    }
+    return ((float) _ui32ReceivedDatagrams) / _ui32ReceiveSyscalls;
+}
+
+inline uint32 MocketStats::getSentFECRepairPacketCount (void)
+{
+    return _ui32SentFECRepairPackets;
+}
+
+inline uint32 MocketStats::getFECRecoveredPacketCount (void)
+{
+    return _ui32FECRecoveredPackets;
+}
+
+inline uint32 MocketStats::getFECUnrecoveredPacketCount (void)
+{
+    return _ui32FECUnrecoveredPackets;
+}
+
 inline float MocketStats::getEstimatedRTT (void)
 {
     return _fSRTT;
@@ -247,6 +352,21 @@ inline void MocketStats::setEstimatedBandwidth (int32 i32BandwidthEstimation)
     _i32BandwidthEstimation = i32BandwidthEstimation;
 }
 
+inline uint32 MocketStats::getCongestionWindowSize (void)
+{
+    return _ui32CongestionWindowSize;
+}
+
+inline uint32 MocketStats::getPacingRate (void)
+{
+    return _ui32PacingRate;
+}
+
+inline uint32 MocketStats::getMinRTT (void)
+{
+    return _ui32MinRTT;
+}
+
 inline void MocketStats::lock (void)
 {
     _m.lock();
@@ -307,6 +427,11 @@ inline MocketStats::MessageStats * MocketStats::getMessageStatisticsForType (uin
     return &(_perTypeMessageStats[ui16Tag]);
 }
 
+inline PacketPool * MocketStats::getPacketPool (void)
+{
+    return _pPacketPool;
+}
+
 inline int MocketStats::freeze (NOMADSUtil::ObjectFreezer &objectFreezer)
 {
     objectFreezer.putUInt32 (_ui32Retransmits);
@@ -325,6 +450,7 @@ inline int MocketStats::freeze (NOMADSUtil::ObjectFreezer &objectFreezer)
     objectFreezer.putUInt32 (_ui32ReliableUnsequencedDataSize);
     objectFreezer.putUInt32 (_ui32ReliableUnsequencedPacketQueueSize);
     // Do not freeze _dBandwidthEstimation since the connection from a new node will have a different bandwidth value
+    // The syscall counters are not frozen either, since they describe the local socket
 
 /*    printf ("MocketStats\n");
     printf ("_ui32Retransmits %lu\n", _ui32Retransmits);
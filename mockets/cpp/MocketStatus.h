@@ -40,7 +40,9 @@ enum MocketStatusFlags
     MSF_Undefined = 0x00,
     MSF_End = 0x01,
     MSF_OverallMessageStatistics = 0x02,
-    MSF_PerTypeMessageStatistics = 0x03
+    MSF_PerTypeMessageStatistics = 0x03,
+    MSF_PacketPoolStatistics = 0x04,
+    MSF_CongestionControlStatistics = 0x05
 };
 
 #pragma pack (push,1)
@@ -91,6 +93,23 @@ struct MessageStatisticsInfo
     uint32 ui32CancelledPackets;
 };
 
+// One of these is sent for each size class of the PacketPool of the mocket
+struct PacketPoolStatisticsInfo
+{
+    uint32 ui32BlockSize;
+    uint32 ui32InUse;
+    uint32 ui32HighWaterMark;
+    uint32 ui32Free;
+};
+
+// Sent only if a congestion control mechanism is active on the mocket
+struct CongestionControlStatisticsInfo
+{
+    uint32 ui32CongestionWindowSize;
+    uint32 ui32PacingRate;
+    uint32 ui32MinRTT;
+};
+
 #pragma pack (pop)
 
 #endif   // #ifndef INCL_MOCKET_STATUS_H
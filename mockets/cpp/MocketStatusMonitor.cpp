@@ -380,6 +380,40 @@ int MocketStatusMonitor::handleStatsUpdate (const char *pBuf, uint16 ui16BufLen)
         strcpy (_szBuf, "\n");
         handleMessage();
     }
+
+    // Occupancy of the packet pool of the mocket - one line per size class
+    const PacketPoolStatisticsInfo *pPPSI = nullptr;
+    while (nullptr != (pPPSI = getPacketPoolStatistics (pBuf, ui16BufLen, pPPSI))) {
+        #if defined (WIN32)
+            snprintf (_szBuf, sizeof (_szBuf) - 1, "%I64d, %I64d, Mockets, %lu, %s, PacketPool, %s, %d, %s, %d, %lu, %lu, %lu, %lu\n",
+        #else
+            snprintf (_szBuf, sizeof (_szBuf) - 1, "%lld, %lld, Mockets, %u, %s, PacketPool, %s, %d, %s, %d, %u, %u, %u, %u\n",
+        #endif
+                i64CurrTime, (i64CurrTime - _i64StartTime),
+                ui32PID,
+                (pszIdentifier[0] != '\0' ? pszIdentifier : "<unknown>"),
+                (const char*) localIPAddr, (int) pEPI->ui16LocalPort,
+                (const char*) remoteIPAddr, (int) pEPI->ui16RemotePort,
+                pPPSI->ui32BlockSize, pPPSI->ui32InUse, pPPSI->ui32HighWaterMark, pPPSI->ui32Free);
+        handleMessage();
+    }
+
+    // State of the congestion control mechanism (if one is active)
+    const CongestionControlStatisticsInfo *pCCSI = getCongestionControlStatistics (pBuf, ui16BufLen);
+    if (pCCSI != nullptr) {
+        #if defined (WIN32)
+            snprintf (_szBuf, sizeof (_szBuf) - 1, "%I64d, %I64d, Mockets, %lu, %s, CongestionControl, %s, %d, %s, %d, %lu, %lu, %lu\n",
+        #else
+            snprintf (_szBuf, sizeof (_szBuf) - 1, "%lld, %lld, Mockets, %u, %s, CongestionControl, %s, %d, %s, %d, %u, %u, %u\n",
+        #endif
+                i64CurrTime, (i64CurrTime - _i64StartTime),
+                ui32PID,
+                (pszIdentifier[0] != '\0' ? pszIdentifier : "<unknown>"),
+                (const char*) localIPAddr, (int) pEPI->ui16LocalPort,
+                (const char*) remoteIPAddr, (int) pEPI->ui16RemotePort,
+                pCCSI->ui32CongestionWindowSize, pCCSI->ui32PacingRate, pCCSI->ui32MinRTT);
+        handleMessage();
+    }
     return 0;
 }
 
@@ -508,6 +542,67 @@ const MessageStatisticsInfo * MocketStatusMonitor::getPerTypeMessageStatistics (
     return (MessageStatisticsInfo*) (pBuf + ui16Offset + 1);
 }
 
+const PacketPoolStatisticsInfo * MocketStatusMonitor::getPacketPoolStatistics (const char *pBuf, uint16 ui16BufLen, const PacketPoolStatisticsInfo *pPrev)
+{
+    if (getUpdateType (pBuf, ui16BufLen) != MSNT_Stats) {
+        return nullptr;
+    }
+    uint16 ui16Offset;
+    if (pPrev == nullptr) {
+        // Skip the overall and the per-type message statistics (if present)
+        uint16 ui16IdentifierLen = *((uint16*)(pBuf+5));
+        ui16Offset = 1 + 4 + 2 + ui16IdentifierLen + 1 + sizeof (EndPointsInfo) + sizeof (StatisticsInfo);
+        while ((ui16Offset < ui16BufLen) &&
+               ((MSF_OverallMessageStatistics == *((uint8*)(pBuf+ui16Offset))) ||
+                (MSF_PerTypeMessageStatistics == *((uint8*)(pBuf+ui16Offset))))) {
+            ui16Offset += (1 + sizeof (MessageStatisticsInfo));
+        }
+    }
+    else {
+        if ((const char*)pPrev <= pBuf) {
+            return nullptr;
+        }
+        ui16Offset = (uint16) (((const char*)pPrev) - pBuf);
+        ui16Offset += sizeof (PacketPoolStatisticsInfo);
+    }
+    if ((ui16Offset + 1 + sizeof (PacketPoolStatisticsInfo)) > ui16BufLen) {
+        return nullptr;
+    }
+    if (MSF_PacketPoolStatistics != *((uint8*)(pBuf+ui16Offset))) {
+        return nullptr;
+    }
+    return (PacketPoolStatisticsInfo*) (pBuf + ui16Offset + 1);
+}
+
+const CongestionControlStatisticsInfo * MocketStatusMonitor::getCongestionControlStatistics (const char *pBuf, uint16 ui16BufLen)
+{
+    if (getUpdateType (pBuf, ui16BufLen) != MSNT_Stats) {
+        return nullptr;
+    }
+    // Skip the message statistics and the packet pool statistics (if present)
+    uint16 ui16IdentifierLen = *((uint16*)(pBuf+5));
+    uint16 ui16Offset = 1 + 4 + 2 + ui16IdentifierLen + 1 + sizeof (EndPointsInfo) + sizeof (StatisticsInfo);
+    while (ui16Offset < ui16BufLen) {
+        uint8 ui8Flag = *((uint8*)(pBuf+ui16Offset));
+        if ((MSF_OverallMessageStatistics == ui8Flag) || (MSF_PerTypeMessageStatistics == ui8Flag)) {
+            ui16Offset += (1 + sizeof (MessageStatisticsInfo));
+        }
+        else if (MSF_PacketPoolStatistics == ui8Flag) {
+            ui16Offset += (1 + sizeof (PacketPoolStatisticsInfo));
+        }
+        else {
+            break;
+        }
+    }
+    if ((ui16Offset + 1 + sizeof (CongestionControlStatisticsInfo)) > ui16BufLen) {
+        return nullptr;
+    }
+    if (MSF_CongestionControlStatistics != *((uint8*)(pBuf+ui16Offset))) {
+        return nullptr;
+    }
+    return (CongestionControlStatisticsInfo*) (pBuf + ui16Offset + 1);
+}
+
 int MocketStatusMonitor::parseUpdate (const char *pBuf, uint16 ui16BufLen)
 {
     ((char*)pBuf)[ui16BufLen] = '\0';
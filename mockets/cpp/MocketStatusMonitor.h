@@ -77,6 +77,8 @@ class MocketStatusMonitor : public NOMADSUtil::ManageableThread
         const StatisticsInfo * getStatistics (const char *pBuf, uint16 ui16BufLen);
         const MessageStatisticsInfo * getMessageStatistics (const char *pBuf, uint16 ui16BufLen);
         const MessageStatisticsInfo * getPerTypeMessageStatistics (const char *pBuf, uint16 ui16BufLen, const MessageStatisticsInfo *pPrev);
+        const PacketPoolStatisticsInfo * getPacketPoolStatistics (const char *pBuf, uint16 ui16BufLen, const PacketPoolStatisticsInfo *pPrev);
+        const CongestionControlStatisticsInfo * getCongestionControlStatistics (const char *pBuf, uint16 ui16BufLen);
         virtual int parseUpdate (const char *pBuf, uint16 ui16BufLen);
 
         int handleMessage (void);
@@ -20,6 +20,7 @@
 #include "MocketStatusNotifier.h"
 
 #include "MocketStatus.h"
+#include "PacketPool.h"
 
 #include "Logger.h"
 
@@ -250,6 +251,18 @@ int MocketStatusNotifier::sendStatsASCII (const char *pszLocalIdentifier, Mocket
     _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
     sprintf (szBuf, "EstimatedRTT=%f\r\n", pStats->getEstimatedRTT());
     _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+    sprintf (szBuf, "PacketsPerSendSyscall=%f\r\n", pStats->getSentPacketsPerSyscall());
+    _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+    sprintf (szBuf, "PacketsPerReceiveSyscall=%f\r\n", pStats->getReceivedPacketsPerSyscall());
+    _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+    if (pStats->getCongestionWindowSize() != 0) {
+        sprintf (szBuf, "CongestionWindowSize=%u\r\n", pStats->getCongestionWindowSize());
+        _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+        sprintf (szBuf, "PacingRate=%u\r\n", pStats->getPacingRate());
+        _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+        sprintf (szBuf, "MinRTT=%u\r\n", pStats->getMinRTT());
+        _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+    }
 
     _bufWriter.writeBytes ("Overall Message Statistics\r\n", 28);
     writeMessageStats (pStats->getOverallMessageStatistics());
@@ -261,6 +274,23 @@ int MocketStatusNotifier::sendStatsASCII (const char *pszLocalIdentifier, Mocket
         }
     }
 
+    PacketPool *pPacketPool = pStats->getPacketPool();
+    if (pPacketPool != nullptr) {
+        _bufWriter.writeBytes ("Packet Pool Statistics\r\n", 24);
+        PacketPool::SizeClassStats scs;
+        for (uint8 ui8 = 0; ui8 < PacketPool::NUM_SIZE_CLASSES; ui8++) {
+            pPacketPool->getStats (ui8, &scs);
+            sprintf (szBuf, "PacketPool-%uBytes-InUse=%u\r\n", scs.ui32BlockSize, scs.ui32InUse);
+            _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+            sprintf (szBuf, "PacketPool-%uBytes-HighWaterMark=%u\r\n", scs.ui32BlockSize, scs.ui32HighWaterMark);
+            _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+            sprintf (szBuf, "PacketPool-%uBytes-Free=%u\r\n", scs.ui32BlockSize, scs.ui32Free);
+            _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+        }
+        sprintf (szBuf, "PacketPool-OversizedAllocations=%u\r\n", pPacketPool->getOversizedAllocationCount());
+        _bufWriter.writeBytes (szBuf, (unsigned long) strlen (szBuf));
+    }
+
     _bufWriter.writeBytes ("END ConnectionStats\r\n", 21);
 
     return sendPacket();
@@ -389,6 +419,32 @@ int MocketStatusNotifier::sendStatsBinary (const char *pszLocalIdentifier, Mocke
         }
     }
 
+    PacketPool *pPacketPool = pStats->getPacketPool();
+    if (pPacketPool != nullptr) {
+        PacketPool::SizeClassStats scs;
+        PacketPoolStatisticsInfo ppsi;
+        for (uint8 ui8 = 0; ui8 < PacketPool::NUM_SIZE_CLASSES; ui8++) {
+            pPacketPool->getStats (ui8, &scs);
+            ppsi.ui32BlockSize = scs.ui32BlockSize;
+            ppsi.ui32InUse = scs.ui32InUse;
+            ppsi.ui32HighWaterMark = scs.ui32HighWaterMark;
+            ppsi.ui32Free = scs.ui32Free;
+            ui8Flags = MSF_PacketPoolStatistics;
+            _bufWriter.write8 (&ui8Flags);
+            _bufWriter.writeBytes (&ppsi, sizeof (ppsi));
+        }
+    }
+
+    if (pStats->getCongestionWindowSize() != 0) {
+        CongestionControlStatisticsInfo ccsi;
+        ccsi.ui32CongestionWindowSize = pStats->getCongestionWindowSize();
+        ccsi.ui32PacingRate = pStats->getPacingRate();
+        ccsi.ui32MinRTT = pStats->getMinRTT();
+        ui8Flags = MSF_CongestionControlStatistics;
+        _bufWriter.write8 (&ui8Flags);
+        _bufWriter.writeBytes (&ccsi, sizeof (ccsi));
+    }
+
     ui8Flags = MSF_End;
     _bufWriter.write8 (&ui8Flags);
 
@@ -0,0 +1,124 @@
+/*
+ * MultiplexedCommInterface.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "MultiplexedCommInterface.h"
+
+#include "MocketMultiplexer.h"
+
+using namespace NOMADSUtil;
+
+MultiplexedCommInterface::MultiplexedCommInterface (MocketMultiplexer *pMultiplexer)
+{
+    _pSharedCI = pMultiplexer->getSharedCommInterface();
+}
+
+MultiplexedCommInterface::~MultiplexedCommInterface (void)
+{
+    _pSharedCI = nullptr;
+}
+
+CommInterface * MultiplexedCommInterface::newInstance (void)
+{
+    return nullptr;
+}
+
+int MultiplexedCommInterface::bind (uint16 ui16Port)
+{
+    // The shared socket has already been bound by the ServerMocket
+    return -1;
+}
+
+int MultiplexedCommInterface::bind (InetAddr *pLocalAddr)
+{
+    return -1;
+}
+
+InetAddr MultiplexedCommInterface::getLocalAddr (void)
+{
+    return _pSharedCI->getLocalAddr();
+}
+
+int MultiplexedCommInterface::getLocalPort (void)
+{
+    return _pSharedCI->getLocalPort();
+}
+
+int MultiplexedCommInterface::close (void)
+{
+    // Must not close the shared socket - the ServerMocket owns it
+    return 0;
+}
+
+int MultiplexedCommInterface::shutdown (bool bReadMode, bool bWriteMode)
+{
+    return 0;
+}
+
+int MultiplexedCommInterface::setReceiveTimeout (uint32 ui32TimeoutInMS)
+{
+    return 0;
+}
+
+int MultiplexedCommInterface::setReceiveBufferSize (uint32 ui32BufferSize)
+{
+    return 0;
+}
+
+int MultiplexedCommInterface::sendTo (InetAddr *pRemoteAddr, const void *pBuf, int iBufSize, const char *pszHints)
+{
+    return _pSharedCI->sendTo (pRemoteAddr, pBuf, iBufSize, pszHints);
+}
+
+int MultiplexedCommInterface::receive (void *pBuf, int iBufSize, InetAddr *pRemoteAddr)
+{
+    // Incoming packets are delivered by the MocketMultiplexer
+    return -1;
+}
+
+int MultiplexedCommInterface::getLastError (void)
+{
+    return _pSharedCI->getLastError();
+}
+
+int MultiplexedCommInterface::isRecoverableSocketError (void)
+{
+    return _pSharedCI->isRecoverableSocketError();
+}
+
+bool MultiplexedCommInterface::isBatchIOSupported (void)
+{
+    return _pSharedCI->isBatchIOSupported();
+}
+
+int MultiplexedCommInterface::enableTransmitTime (void)
+{
+    // Datagrams without a transmit time are not affected, so the
+    // option can be set on the socket shared with the other mockets
+    return _pSharedCI->enableTransmitTime();
+}
+
+int MultiplexedCommInterface::sendBatch (Datagram *pDatagrams, uint16 ui16Count, const char *pszHints)
+{
+    return _pSharedCI->sendBatch (pDatagrams, ui16Count, pszHints);
+}
+
+int MultiplexedCommInterface::receiveBatch (Datagram *pDatagrams, uint16 ui16Count)
+{
+    return -1;
+}
@@ -0,0 +1,63 @@
+#ifndef INCL_MULTIPLEXED_COMM_INTERFACE_H
+#define INCL_MULTIPLEXED_COMM_INTERFACE_H
+
+/*
+ * MultiplexedCommInterface.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * MultiplexedCommInterface
+ *
+ * CommInterface used by the mockets accepted by a ServerMocket in shared socket mode.
+ * Outgoing packets are sent through the socket of the ServerMocket. Incoming packets are
+ * never read through this interface: the MocketMultiplexer demultiplexes them and hands
+ * them directly to the Receiver of the mocket.
+ */
+
+#include "CommInterface.h"
+
+class MocketMultiplexer;
+
+class MultiplexedCommInterface : public CommInterface
+{
+    public:
+        MultiplexedCommInterface (MocketMultiplexer *pMultiplexer);
+        virtual ~MultiplexedCommInterface (void);
+
+        virtual CommInterface * newInstance (void);
+
+        virtual int bind (uint16 ui16Port);
+        virtual int bind (NOMADSUtil::InetAddr *pLocalAddr);
+        virtual NOMADSUtil::InetAddr getLocalAddr (void);
+        virtual int getLocalPort (void);
+        virtual int close (void);
+        virtual int shutdown (bool bReadMode, bool bWriteMode);
+        virtual int setReceiveTimeout (uint32 ui32TimeoutInMS);
+        virtual int setReceiveBufferSize (uint32 ui32BufferSize);
+        virtual int sendTo (NOMADSUtil::InetAddr *pRemoteAddr, const void *pBuf, int iBufSize, const char *pszHints = nullptr);
+        virtual int receive (void *pBuf, int iBufSize, NOMADSUtil::InetAddr *pRemoteAddr);
+        virtual int getLastError (void);
+        virtual int isRecoverableSocketError (void);
+        virtual bool isBatchIOSupported (void);
+        virtual int enableTransmitTime (void);
+        virtual int sendBatch (Datagram *pDatagrams, uint16 ui16Count, const char *pszHints = nullptr);
+        virtual int receiveBatch (Datagram *pDatagrams, uint16 ui16Count);
+
+    private:
+        CommInterface *_pSharedCI;
+};
+
+#endif   // #ifndef INCL_MULTIPLEXED_COMM_INTERFACE_H
@@ -24,6 +24,7 @@
 
 #include <assert.h>
 #include <memory.h>
+#include <new>
 
 #include "EndianHelper.h"
 
@@ -33,8 +34,10 @@ using namespace NOMADSUtil;
 Packet::Packet (Mocket *pMocket)
 {
     _usBufSize = pMocket->getMTU();
-    _pBuf = (char*) malloc (_usBufSize);
+    _pPool = pMocket->getPacketPool();
+    _pBuf = (char*) PacketPool::allocate (_pPool, _usBufSize);
     _bDeleteBuf = true;
+    _bPooledBuf = false;
     _usOffset = HEADER_SIZE;
     _usFirstChunkOffset = 0;
     _ui16PiggybackChunksOffset = 0;
@@ -51,8 +54,10 @@ Packet::Packet (Mocket *pMocket)
 Packet::Packet (unsigned short usBufSize)
 {
     _usBufSize = usBufSize;
-    _pBuf = (char*) malloc (_usBufSize);
+    _pPool = nullptr;
+    _pBuf = (char*) PacketPool::allocate (_pPool, _usBufSize);
     _bDeleteBuf = true;
+    _bPooledBuf = false;
     _usOffset = HEADER_SIZE;
     _usFirstChunkOffset = 0;
     _ui16PiggybackChunksOffset = 0;
@@ -72,6 +77,29 @@ Packet::Packet (char *pBuf, unsigned short usBufSize)
     _pBuf = pBuf;
     _usBufSize = usBufSize;
     _bDeleteBuf = false;
+    _bPooledBuf = false;
+    _pPool = nullptr;
+    _usOffset = HEADER_SIZE;      // Will be set by the call to parseHeader() below
+    _usFirstChunkOffset = 0;      // Will be set by the call to parseHeader() below
+    _ui16PiggybackChunksOffset = 0;
+    _bReadMode = true;
+    _bDataChunkAdded = false;     // Probably immaterial - since _bReadMode is set to true
+    _ui16TagId = 0;
+    _ui16Flags = 0;               // Will be set by the call to parseHeader() below
+    _ui32Validation = 0;          // Will be set by the call to parseHeader() below
+    _ui32SequenceNum = 0;         // Will be set by the call to parseHeader() below
+    _ui32WindowSize = 0;          // Will be set by the call to parseHeader() below
+    _i64SentTime = 0;
+    parseHeader();
+}
+
+Packet::Packet (char *pBuf, unsigned short usBufSize, PacketPool *pPool, bool bPooledBuf)
+{
+    _pBuf = pBuf;
+    _usBufSize = usBufSize;
+    _bDeleteBuf = false;
+    _bPooledBuf = bPooledBuf;
+    _pPool = pPool;
     _usOffset = HEADER_SIZE;      // Will be set by the call to parseHeader() below
     _usFirstChunkOffset = 0;      // Will be set by the call to parseHeader() below
     _ui16PiggybackChunksOffset = 0;
@@ -90,8 +118,10 @@ Packet::Packet (ObjectDefroster &objectDefroster)
 {
     objectDefroster >> _bReadMode;
     objectDefroster >> _usBufSize;
-    _pBuf = (char*) malloc (_usBufSize);
+    _pPool = nullptr;
+    _pBuf = (char*) PacketPool::allocate (_pPool, _usBufSize);
     _bDeleteBuf = true;
+    _bPooledBuf = false;
     unsigned short usOffset = 0;
     objectDefroster >> usOffset;
     
@@ -134,11 +164,35 @@ Packet::Packet (ObjectDefroster &objectDefroster)
 Packet::~Packet (void)
 {
     if (_bDeleteBuf && _pBuf) {
-        free (_pBuf);
+        PacketPool::release (_pBuf);
     }
     _pBuf = nullptr;
 }
 
+void * Packet::operator new (size_t size)
+{
+    return operator new (size, (PacketPool*) nullptr);
+}
+
+void * Packet::operator new (size_t size, PacketPool *pPool)
+{
+    void *p = PacketPool::allocate (pPool, size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void Packet::operator delete (void *p)
+{
+    PacketPool::release (p);
+}
+
+void Packet::operator delete (void *p, PacketPool *pPool)
+{
+    PacketPool::release (p);
+}
+
 int Packet::prepareForProcessing (void)
 {
     if ((!_bReadMode) || (_bDeleteBuf)) {
@@ -149,8 +203,13 @@ int Packet::prepareForProcessing (void)
         // There are one or more piggyback chunks - do not copy those
         _usBufSize = _ui16PiggybackChunksOffset;
     }
+    if (_bPooledBuf) {
+        // The buffer came from the PacketPool - just take ownership of it
+        _bDeleteBuf = true;
+        return 0;
+    }
     char *pOrigBuf = _pBuf;
-    _pBuf = (char*) malloc (_usBufSize);
+    _pBuf = (char*) PacketPool::allocate (_pPool, _usBufSize);
     memcpy (_pBuf, pOrigBuf, _usBufSize);
     _bDeleteBuf = true;
     return 0;
@@ -247,6 +306,12 @@ void Packet::dump (FILE *file)
             case CT_TimestampAck:
                  fprintf (file, "     Chunk Type: TimestampAck\n");
                  break;
+            case CT_FECRepair:
+                 fprintf (file, "     Chunk Type: FECRepair; size = %d\n", (int) ui16ChunkSize);
+                 break;
+            case CT_FECFeedback:
+                 fprintf (file, "     Chunk Type: FECFeedback\n");
+                 break;
             case CT_Suspend:
                  fprintf (file, "     Chunk Type: Suspend\n");
                  break;
@@ -649,6 +714,54 @@ int Packet::addTimestampAckChunk (int64 i64Timestamp)
     return 0;
 }
 
+int Packet::addFECRepairChunk (uint32 ui32BaseTSN, uint8 ui8SourcePackets, uint8 ui8RepairPackets, uint8 ui8RepairIndex,
+                               const char *pData, uint16 ui16DataLen)
+{
+    if (_bReadMode) {
+        return -1;
+    }
+    if (_ui16PiggybackChunksOffset != 0) {
+        return -2;
+    }
+    if ((_usBufSize - _usOffset) < FEC_REPAIR_CHUNK_HEADER_SIZE + ui16DataLen) {
+        return -3;
+    }
+    uint16 ui16ChunkType = CT_FECRepair;
+    uint16 ui16ChunkSize = FEC_REPAIR_CHUNK_HEADER_SIZE + ui16DataLen;
+    *((uint16*)(_pBuf + _usOffset + 0)) = EndianHelper::htons (ui16ChunkType);
+    *((uint16*)(_pBuf + _usOffset + 2)) = EndianHelper::htons (ui16ChunkSize);
+    *((uint32*)(_pBuf + _usOffset + 4)) = EndianHelper::htonl (ui32BaseTSN);
+    *((uint8*)(_pBuf + _usOffset + 8)) = ui8SourcePackets;
+    *((uint8*)(_pBuf + _usOffset + 9)) = ui8RepairPackets;
+    *((uint8*)(_pBuf + _usOffset + 10)) = ui8RepairIndex;
+    *((uint8*)(_pBuf + _usOffset + 11)) = 0;
+    memcpy (_pBuf + _usOffset + FEC_REPAIR_CHUNK_HEADER_SIZE, pData, ui16DataLen);
+    _usOffset += ui16ChunkSize;
+    return 0;
+}
+
+int Packet::addFECFeedbackChunk (uint32 ui32ExpectedPackets, uint32 ui32LostPackets)
+{
+    if (_bReadMode) {
+        return -1;
+    }
+    if ((_usBufSize - _usOffset) < CHUNK_HEADER_SIZE + 8) {
+        return -2;
+    }
+    if (_ui16PiggybackChunksOffset == 0) {
+        // This is the first piggyback chunk being added - remember the position
+        _ui16PiggybackChunksOffset = _usOffset;
+    }
+    uint16 ui16ChunkType = CT_FECFeedback;
+    uint16 ui16ChunkSize = CHUNK_HEADER_SIZE + 8;
+    *((uint16*)(_pBuf + _usOffset + 0)) = EndianHelper::htons (ui16ChunkType);
+    *((uint16*)(_pBuf + _usOffset + 2)) = EndianHelper::htons (ui16ChunkSize);
+    *((uint32*)(_pBuf + _usOffset + 4)) = EndianHelper::htonl (ui32ExpectedPackets);
+    *((uint32*)(_pBuf + _usOffset + 8)) = EndianHelper::htonl (ui32LostPackets);
+    _usOffset += ui16ChunkSize;
+    return 0;
+}
+
 int Packet::addDataChunk (uint16 ui16TagId, const char *pData, uint32 ui32DataLen)
 {
     if (_bReadMode) {
@@ -964,7 +1077,8 @@ Packet::ChunkType Packet::getChunkType (void)
         // Initialize the _ui16TagId variable from the data chunk
         _ui16TagId = EndianHelper::ntohs (*((uint16*)(_pBuf + _usOffset + 4)));
     }
-    else if ((ui16ChunkType == CT_SAck) || (ui16ChunkType == CT_Cancelled) || (ui16ChunkType == CT_SAckRecBandEst)) {
+    else if ((ui16ChunkType == CT_SAck) || (ui16ChunkType == CT_Cancelled) || (ui16ChunkType == CT_SAckRecBandEst) ||
+             (ui16ChunkType == CT_FECFeedback)) {
         if ((_bReadMode) && (_ui16PiggybackChunksOffset == 0)) {
             // Keep track of this position as the start of the piggyback chunks
             _ui16PiggybackChunksOffset = _usOffset;
@@ -980,7 +1094,7 @@ Packet::ChunkType Packet::getChunkType (void)
             (ui16ChunkType != CT_SuspendAck) && (ui16ChunkType != CT_Resume) && (ui16ChunkType != CT_ResumeAck) && 
             (ui16ChunkType != CT_ReEstablish) && (ui16ChunkType != CT_ReEstablishAck) && (ui16ChunkType != CT_SimpleSuspend) &&
             (ui16ChunkType != CT_SimpleSuspendAck) && (ui16ChunkType != CT_SimpleConnect) && (ui16ChunkType != CT_SimpleConnectAck) &&
-            (ui16ChunkType != CT_SAckRecBandEst)) {
+            (ui16ChunkType != CT_SAckRecBandEst) && (ui16ChunkType != CT_FECRepair) && (ui16ChunkType != CT_FECFeedback)) {
             return CT_None;
         }
     #endif
@@ -1074,6 +1188,18 @@ TimestampAckChunkAccessor Packet::getTimestampAckChunk (void)
     return TimestampAckChunkAccessor (_pBuf + _usOffset);
 }
 
+FECRepairChunkAccessor Packet::getFECRepairChunk (void)
+{
+    assert (getChunkType() == CT_FECRepair);
+    return FECRepairChunkAccessor (_pBuf + _usOffset);
+}
+
+FECFeedbackChunkAccessor Packet::getFECFeedbackChunk (void)
+{
+    assert (getChunkType() == CT_FECFeedback);
+    return FECFeedbackChunkAccessor (_pBuf + _usOffset);
+}
+
 DataChunkAccessor Packet::getDataChunk (void)
 {
     assert (getChunkType() == CT_Data);
@@ -22,10 +22,12 @@
 
 #include "PacketAccessors.h"
 #include "PacketMutators.h"
+#include "PacketPool.h"
 
 #include "FTypes.h"
 #include "EndianHelper.h"
 
+#include <stddef.h>
 #include <stdio.h>
 
 
@@ -50,14 +52,28 @@ class Packet
         // NOTE: Initially, the packet does not make a copy of the memory buffer
         //       Caller must invoke makePrivateCopyOfMemoryBuffer() if necessary
         Packet (char *pBuf, unsigned short usBufSize);
+
+        // Constructor used when parsing a packet that was received into a buffer allocated from a PacketPool
+        // The private copy made by prepareForProcessing() is allocated from pPool
+        // If bPooledBuf is true, pBuf was obtained from PacketPool::allocate() and prepareForProcessing()
+        //     takes ownership of it instead of making a copy
+        Packet (char *pBuf, unsigned short usBufSize, PacketPool *pPool, bool bPooledBuf);
         
         // Constructor used when defrosting
         Packet (NOMADSUtil::ObjectDefroster &objectDefroster);
 
         virtual ~Packet (void);
 
+        // Packet objects are allocated from the PacketPool of the mocket when one is specified
+        static void * operator new (size_t size);
+        static void * operator new (size_t size, PacketPool *pPool);
+        static void operator delete (void *p);
+        static void operator delete (void *p, PacketPool *pPool);
+
         // Removes any piggyback chunks that were in the packet and then duplicates the memory buffer
         // so that the buffer passed in the constructor may be reused
+        // If the buffer was allocated from a PacketPool (see constructor above), the packet takes ownership
+        // of the buffer instead of duplicating it
         int prepareForProcessing (void);
 
         // Write the contents of the packet for debugging purposes
@@ -65,6 +81,7 @@ class Packet
 
         static const uint16 CHUNK_HEADER_SIZE = 4;         // 2 bytes for chunk type, 2 bytes for chunk length
         static const uint16 DATA_CHUNK_HEADER_SIZE  = CHUNK_HEADER_SIZE + 2;   // 2 additional bytes for the tag value
+        static const uint16 FEC_REPAIR_CHUNK_HEADER_SIZE = CHUNK_HEADER_SIZE + 8;  // 4 bytes for the base TSN, 4 bytes for the block parameters
         static const uint16 CHUNK_CLASS_METADATA    = 0x1000;
         static const uint16 CHUNK_CLASS_DATA        = 0x2000;
         static const uint16 CHUNK_CLASS_STATECHANGE = 0x4000;
@@ -77,6 +94,8 @@ class Packet
             CT_Timestamp = CHUNK_CLASS_METADATA | 0x0004,
             CT_TimestampAck = CHUNK_CLASS_METADATA | 0x0005,
             CT_SAckRecBandEst = CHUNK_CLASS_METADATA | 0x0006,
+            CT_FECRepair = CHUNK_CLASS_METADATA | 0x0007,
+            CT_FECFeedback = CHUNK_CLASS_METADATA | 0x0008,
             CT_Data = CHUNK_CLASS_DATA | 0x0001,
             CT_Init = CHUNK_CLASS_STATECHANGE | 0x0001,
             CT_InitAck = CHUNK_CLASS_STATECHANGE | 0x0002,
@@ -136,6 +155,11 @@ class Packet
         CancelledChunkMutator addCancelledChunk (void);
         int addTimestampChunk (int64 i64Timestamp);
         int addTimestampAckChunk (int64 i64Timestamp);
+        // Adds a chunk with the repair packet ui8RepairIndex of the FEC block that starts at ui32BaseTSN
+        // NOTE: The repair chunk is not a piggyback chunk - it must be added before any piggyback chunk
+        int addFECRepairChunk (uint32 ui32BaseTSN, uint8 ui8SourcePackets, uint8 ui8RepairPackets, uint8 ui8RepairIndex,
+                               const char *pData, uint16 ui16DataLen);
+        int addFECFeedbackChunk (uint32 ui32ExpectedPackets, uint32 ui32LostPackets);
         int addDataChunk (uint16 ui16TagId, const char *pData, uint32 ui32DataLen);
         int addReEstablishChunk (void *pEnchriptedUUID, uint32 ui32EncryptedDataLen);
         int addReEstablishAckChunk (void);
@@ -217,6 +241,8 @@ class Packet
         CancelledChunkAccessor getCancelledChunk (void);
         TimestampChunkAccessor getTimestampChunk (void);
         TimestampAckChunkAccessor getTimestampAckChunk (void);
+        FECRepairChunkAccessor getFECRepairChunk (void);
+        FECFeedbackChunkAccessor getFECFeedbackChunk (void);
         DataChunkAccessor getDataChunk (void);
         SimpleSuspendChunkAccessor getSimpleSuspendChunk (void);
         SimpleSuspendAckChunkAccessor getSimpleSuspendAckChunk (void);
@@ -259,6 +285,8 @@ class Packet
     private:
         char *_pBuf;
         bool _bDeleteBuf;
+        bool _bPooledBuf;                   // True if a buffer passed to the constructor can be adopted by prepareForProcessing()
+        PacketPool *_pPool;                 // The pool from which the buffer is allocated - may be nullptr
         unsigned short _usBufSize;
         unsigned short _usOffset;
         unsigned short _usFirstChunkOffset; // Used to keep track of the location of the first chunk (for resetting the read iterator)
@@ -243,6 +243,34 @@ class TimestampAckChunkAccessor
         const char *_pBuf;
 };
 
+class FECRepairChunkAccessor
+{
+    public:
+        uint32 getBaseTSN (void);
+        uint8 getSourcePacketCount (void);
+        uint8 getRepairPacketCount (void);
+        uint8 getRepairIndex (void);
+        uint16 getDataLength (void);
+        const char * getData (void);
+    private:
+        friend class Packet;
+        FECRepairChunkAccessor (const char *pBuf);
+    private:
+        const char *_pBuf;
+};
+
+class FECFeedbackChunkAccessor
+{
+    public:
+        uint32 getExpectedPacketCount (void);
+        uint32 getLostPacketCount (void);
+    private:
+        friend class Packet;
+        FECFeedbackChunkAccessor (const char *pBuf);
+    private:
+        const char *_pBuf;
+};
+
 class DataChunkAccessor
 {
     public:
@@ -738,6 +766,60 @@ inline int64 TimestampAckChunkAccessor::getTimestamp (void)
     return NOMADSUtil::EndianHelper::ntoh64 (*((int64*)(_pBuf + 4)));
 }
 
+// Inline Methods for FECRepairChunkAccessor
+
+inline FECRepairChunkAccessor::FECRepairChunkAccessor (const char *pBuf)
+{
+    _pBuf = pBuf;
+}
+
+inline uint32 FECRepairChunkAccessor::getBaseTSN (void)
+{
+    return NOMADSUtil::EndianHelper::ntohl (*((uint32*)(_pBuf + 4)));
+}
+
+inline uint8 FECRepairChunkAccessor::getSourcePacketCount (void)
+{
+    return *((uint8*)(_pBuf + 8));
+}
+
+inline uint8 FECRepairChunkAccessor::getRepairPacketCount (void)
+{
+    return *((uint8*)(_pBuf + 9));
+}
+
+inline uint8 FECRepairChunkAccessor::getRepairIndex (void)
+{
+    return *((uint8*)(_pBuf + 10));
+}
+
+inline uint16 FECRepairChunkAccessor::getDataLength (void)
+{
+    return NOMADSUtil::EndianHelper::ntohs (*((uint16*)(_pBuf + 2))) - 12; // FEC_REPAIR_CHUNK_HEADER_SIZE is 12
+}
+
+inline const char * FECRepairChunkAccessor::getData (void)
+{
+    return (_pBuf + 12);
+}
+
+// Inline Methods for FECFeedbackChunkAccessor
+
+inline FECFeedbackChunkAccessor::FECFeedbackChunkAccessor (const char *pBuf)
+{
+    _pBuf = pBuf;
+}
+
+inline uint32 FECFeedbackChunkAccessor::getExpectedPacketCount (void)
+{
+    return NOMADSUtil::EndianHelper::ntohl (*((uint32*)(_pBuf + 4)));
+}
+
+inline uint32 FECFeedbackChunkAccessor::getLostPacketCount (void)
+{
+    return NOMADSUtil::EndianHelper::ntohl (*((uint32*)(_pBuf + 8)));
+}
+
 // Inline Methods for DataChunkAccessor
 
 inline DataChunkAccessor::DataChunkAccessor (const char *pBuf)
@@ -0,0 +1,189 @@
+/*
+ * PacketPool.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "PacketPool.h"
+
+#include "Logger.h"
+
+#include <stdlib.h>
+
+using namespace NOMADSUtil;
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+PacketPool::PacketPool (void)
+{
+    for (uint8 ui8 = 0; ui8 < NUM_SIZE_CLASSES; ui8++) {
+        _sizeClasses[ui8].pFirstFree = nullptr;
+        _sizeClasses[ui8].ui32InUse = 0;
+        _sizeClasses[ui8].ui32HighWaterMark = 0;
+        _sizeClasses[ui8].ui32Free = 0;
+    }
+    _pSlabs = nullptr;
+    _ui32TotalInUse = 0;
+    _ui32OversizedAllocations = 0;
+    _bClosed = false;
+}
+
+PacketPool::~PacketPool (void)
+{
+    while (_pSlabs != nullptr) {
+        Slab *pSlab = _pSlabs;
+        _pSlabs = pSlab->pNext;
+        free (pSlab->pMemory);
+        free (pSlab);
+    }
+}
+
+void * PacketPool::allocate (PacketPool *pPool, size_t size)
+{
+    if (pPool != nullptr) {
+        uint8 ui8SizeClass = getSizeClass (size);
+        if (ui8SizeClass < NUM_SIZE_CLASSES) {
+            return pPool->allocateBlock (ui8SizeClass);
+        }
+        pPool->_m.lock();
+        pPool->_ui32OversizedAllocations++;
+        pPool->_m.unlock();
+    }
+    BlockHeader *pHeader = (BlockHeader*) malloc (sizeof (BlockHeader) + size);
+    if (pHeader == nullptr) {
+        return nullptr;
+    }
+    pHeader->info.pPool = nullptr;
+    pHeader->info.ui8SizeClass = NUM_SIZE_CLASSES;
+    return pHeader + 1;
+}
+
+void PacketPool::release (void *pBlock)
+{
+    if (pBlock == nullptr) {
+        return;
+    }
+    BlockHeader *pHeader = ((BlockHeader*) pBlock) - 1;
+    if (pHeader->info.pPool == nullptr) {
+        free (pHeader);
+    }
+    else {
+        pHeader->info.pPool->releaseBlock (pHeader);
+    }
+}
+
+void PacketPool::close (void)
+{
+    _m.lock();
+    _bClosed = true;
+    bool bDelete = (_ui32TotalInUse == 0);
+    _m.unlock();
+    if (bDelete) {
+        delete this;
+    }
+}
+
+int PacketPool::getStats (uint8 ui8SizeClass, SizeClassStats *pStats)
+{
+    if ((ui8SizeClass >= NUM_SIZE_CLASSES) || (pStats == nullptr)) {
+        return -1;
+    }
+    _m.lock();
+    pStats->ui32BlockSize = getBlockSize (ui8SizeClass);
+    pStats->ui32InUse = _sizeClasses[ui8SizeClass].ui32InUse;
+    pStats->ui32HighWaterMark = _sizeClasses[ui8SizeClass].ui32HighWaterMark;
+    pStats->ui32Free = _sizeClasses[ui8SizeClass].ui32Free;
+    _m.unlock();
+    return 0;
+}
+
+uint32 PacketPool::getOversizedAllocationCount (void)
+{
+    return _ui32OversizedAllocations;
+}
+
+uint8 PacketPool::getSizeClass (size_t size)
+{
+    uint8 ui8SizeClass = 0;
+    while ((ui8SizeClass < NUM_SIZE_CLASSES) && (size > getBlockSize (ui8SizeClass))) {
+        ui8SizeClass++;
+    }
+    return ui8SizeClass;
+}
+
+void * PacketPool::allocateBlock (uint8 ui8SizeClass)
+{
+    _m.lock();
+    SizeClass *pSizeClass = &_sizeClasses[ui8SizeClass];
+    if ((pSizeClass->pFirstFree == nullptr) && (0 != addSlab (ui8SizeClass))) {
+        _m.unlock();
+        return nullptr;
+    }
+    BlockHeader *pHeader = pSizeClass->pFirstFree;
+    pSizeClass->pFirstFree = *((BlockHeader**) (pHeader + 1));
+    pSizeClass->ui32Free--;
+    pSizeClass->ui32InUse++;
+    if (pSizeClass->ui32InUse > pSizeClass->ui32HighWaterMark) {
+        pSizeClass->ui32HighWaterMark = pSizeClass->ui32InUse;
+    }
+    _ui32TotalInUse++;
+    _m.unlock();
+    return pHeader + 1;
+}
+
+void PacketPool::releaseBlock (BlockHeader *pHeader)
+{
+    _m.lock();
+    SizeClass *pSizeClass = &_sizeClasses[pHeader->info.ui8SizeClass];
+    *((BlockHeader**) (pHeader + 1)) = pSizeClass->pFirstFree;
+    pSizeClass->pFirstFree = pHeader;
+    pSizeClass->ui32InUse--;
+    pSizeClass->ui32Free++;
+    _ui32TotalInUse--;
+    bool bDelete = (_bClosed) && (_ui32TotalInUse == 0);
+    _m.unlock();
+    if (bDelete) {
+        delete this;
+    }
+}
+
+int PacketPool::addSlab (uint8 ui8SizeClass)
+{
+    const uint32 ui32Stride = sizeof (BlockHeader) + getBlockSize (ui8SizeClass);
+    Slab *pSlab = (Slab*) malloc (sizeof (Slab));
+    if (pSlab == nullptr) {
+        return -1;
+    }
+    if (nullptr == (pSlab->pMemory = (char*) malloc (ui32Stride * BLOCKS_PER_SLAB))) {
+        checkAndLogMsg ("PacketPool::addSlab", Logger::L_MildError,
+                        "failed to allocate a slab of %u bytes\n", ui32Stride * BLOCKS_PER_SLAB);
+        free (pSlab);
+        return -2;
+    }
+    pSlab->pNext = _pSlabs;
+    _pSlabs = pSlab;
+
+    SizeClass *pSizeClass = &_sizeClasses[ui8SizeClass];
+    for (uint16 ui16 = 0; ui16 < BLOCKS_PER_SLAB; ui16++) {
+        BlockHeader *pHeader = (BlockHeader*) (pSlab->pMemory + (ui16 * ui32Stride));
+        pHeader->info.pPool = this;
+        pHeader->info.ui8SizeClass = ui8SizeClass;
+        *((BlockHeader**) (pHeader + 1)) = pSizeClass->pFirstFree;
+        pSizeClass->pFirstFree = pHeader;
+    }
+    pSizeClass->ui32Free += BLOCKS_PER_SLAB;
+    return 0;
+}
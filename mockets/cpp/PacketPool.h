@@ -0,0 +1,132 @@
+#ifndef INCL_PACKET_POOL_H
+#define INCL_PACKET_POOL_H
+
+/*
+ * PacketPool.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * PacketPool
+ *
+ * Size-classed slab allocator used by a Mocket for the buffers of its packets and
+ * for the Packet and PacketWrapper objects themselves.
+ * Each size class keeps a free list of blocks that are carved out of slabs of
+ * BLOCKS_PER_SLAB blocks. Released blocks go back to the free list of their class,
+ * and slabs are only freed when the pool is deleted, so the memory held by the pool
+ * is bounded by the high-water mark of the mocket.
+ *
+ * Every block is preceded by a small header that records the pool it belongs to,
+ * so blocks can be released without knowing which mocket allocated them.
+ * Blocks allocated without a pool (or larger than MAX_BLOCK_SIZE) are obtained
+ * with malloc() and carry the same header, so release() works for all of them.
+ */
+
+#include "FTypes.h"
+#include "Mutex.h"
+
+#include <stddef.h>
+
+class PacketPool
+{
+    public:
+        PacketPool (void);
+
+        // Allocates a block of at least the specified size
+        // If pPool is nullptr or the size is larger than MAX_BLOCK_SIZE, the block is allocated with malloc()
+        // Returns nullptr if the memory could not be allocated
+        static void * allocate (PacketPool *pPool, size_t size);
+
+        // Returns a block obtained from allocate() to the pool it came from
+        static void release (void *pBlock);
+
+        // Invoked by the owner of the pool in place of deleting it
+        // The pool deletes itself as soon as all the blocks that are still in use have been released
+        void close (void);
+
+        struct SizeClassStats
+        {
+            uint32 ui32BlockSize;
+            uint32 ui32InUse;           // Number of blocks currently allocated
+            uint32 ui32HighWaterMark;   // Highest value reached by ui32InUse
+            uint32 ui32Free;            // Number of blocks available for reuse
+        };
+
+        // Fills in the statistics of the specified size class (from 0 to NUM_SIZE_CLASSES - 1)
+        // Returns 0 if successful or a negative value if the size class is not valid
+        int getStats (uint8 ui8SizeClass, SizeClassStats *pStats);
+
+        // Returns the number of allocations that were larger than MAX_BLOCK_SIZE and were served by malloc()
+        uint32 getOversizedAllocationCount (void);
+
+    public:
+        static const uint8 NUM_SIZE_CLASSES = 6;
+        static const uint32 MIN_BLOCK_SIZE = 64;
+        static const uint32 MAX_BLOCK_SIZE = 2048;     // Same as Mocket::MAXIMUM_MTU
+        static const uint16 BLOCKS_PER_SLAB = 16;
+
+    private:
+        // Use close() instead
+        ~PacketPool (void);
+
+        union BlockHeader
+        {
+            struct {
+                PacketPool *pPool;      // nullptr if the block was allocated with malloc()
+                uint8 ui8SizeClass;
+            } info;
+            int64 i64Alignment;         // Keeps the payload that follows the header suitably aligned
+            void *apAlignment[2];
+        };
+
+        struct Slab
+        {
+            Slab *pNext;
+            char *pMemory;
+        };
+
+        struct SizeClass
+        {
+            BlockHeader *pFirstFree;    // The link to the next free block is stored in the payload of the block
+            uint32 ui32InUse;
+            uint32 ui32HighWaterMark;
+            uint32 ui32Free;
+        };
+
+        static uint8 getSizeClass (size_t size);
+        static uint32 getBlockSize (uint8 ui8SizeClass);
+
+        void * allocateBlock (uint8 ui8SizeClass);
+        void releaseBlock (BlockHeader *pHeader);
+
+        // Carves a new slab into free blocks of the specified size class
+        // NOTE: _m must be held by the caller
+        int addSlab (uint8 ui8SizeClass);
+
+    private:
+        NOMADSUtil::Mutex _m;
+        SizeClass _sizeClasses[NUM_SIZE_CLASSES];
+        Slab *_pSlabs;
+        uint32 _ui32TotalInUse;
+        uint32 _ui32OversizedAllocations;
+        bool _bClosed;
+};
+
+inline uint32 PacketPool::getBlockSize (uint8 ui8SizeClass)
+{
+    return MIN_BLOCK_SIZE << ui8SizeClass;
+}
+
+#endif   // #ifndef INCL_PACKET_POOL_H
@@ -20,12 +20,16 @@
 #include "PacketProcessor.h"
 
 #include "DataBuffer.h"
+#include "FECDecoder.h"
+#include "FECEncoder.h"
 #include "Mocket.h"
 #include "Receiver.h"
 #include "SequencedPacketQueue.h"
+#include "Transmitter.h"
 #include "UnsequencedPacketQueue.h"
 #include "TSNRangeHandler.h"
 
+#include "EndianHelper.h"
 #include "Logger.h"
 
 #include <memory.h>
@@ -61,6 +65,11 @@ PacketProcessor::PacketProcessor (Mocket *pMocket)
     _pReliableUnsequencedPacketQueue = new UnsequencedPacketQueue (true);
     _pReliableUnsequencedPacketTracker = new ReceivedTSNRangeHandler();
     _pUnreliableUnsequencedPacketQueue = new UnsequencedPacketQueue (false);
+
+    _pFECDecoder = nullptr;
+    _bFECFeedbackPending = false;
+    _ui32LastFECExpectedPackets = 0;
+    _i64LastFECFeedbackRequestTime = 0;
 }
 
 PacketProcessor::~PacketProcessor (void)
@@ -99,6 +108,10 @@ PacketProcessor::~PacketProcessor (void)
         delete _pUnreliableUnsequencedPacketQueue;
         _pUnreliableUnsequencedPacketQueue = nullptr;
     }
+    if (_pFECDecoder) {
+        delete _pFECDecoder;
+        _pFECDecoder = nullptr;
+    }
 }
 
 int PacketProcessor::init (void)
@@ -320,6 +333,150 @@ int PacketProcessor::processUnreliableUnsequencedPacket (Packet *pPacket)
     return 0;
 }
 
+int PacketProcessor::processFECProtectedPacket (Packet *pPacket, int64 i64RecvTime)
+{
+    uint32 ui32SequenceNum = pPacket->getSequenceNum();
+    _mFEC.lock();
+    _pFECDecoder->addSourcePacket (pPacket);
+    _mFEC.unlock();
+    PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pPacket, i64RecvTime);
+    if (_pUnreliableSequencedPacketQueue->insert (pWrapper)) {
+        checkAndLogMsg ("PacketProcessor::processFECProtectedPacket", Logger::L_MediumDetailDebug,
+                        "enqueued packet with sequence number %lu into unreliable sequenced packet queue\n", ui32SequenceNum);
+        packetArrived();
+    }
+    else {
+        // Either a duplicate or a packet that arrived after the timeout expired
+        checkAndLogMsg ("PacketProcessor::processFECProtectedPacket", Logger::L_LowDetailDebug,
+                        "dropping unreliable sequenced packet with sequence number %lu\n", ui32SequenceNum);
+        dequeuedPacket (pPacket);
+        delete pWrapper;
+        delete pPacket;
+        _pMocket->getStatistics()->_ui32DuplicatedDiscardedPackets++;
+    }
+    return 0;
+}
+
+int PacketProcessor::processFECRepairChunk (FECRepairChunkAccessor repairChunkAccessor)
+{
+    _mFEC.lock();
+    if (_pFECDecoder == nullptr) {
+        // First repair chunk - from now on, buffer the unreliable sequenced packets
+        // so that the packets that are rebuilt can be delivered in order
+        _pUnreliableSequencedPacketQueue->lock();
+        _pUnreliableSequencedPacketQueue->setNextExpectedSequenceNum (_ui32NextUnreliableSequencedPacketTSN);
+        _pFECDecoder = new FECDecoder (this, _pMocket->getPacketPool(), _ui32NextUnreliableSequencedPacketTSN);
+        _pUnreliableSequencedPacketQueue->unlock();
+        checkAndLogMsg ("PacketProcessor::processFECRepairChunk", Logger::L_Info,
+                        "received the first FEC repair chunk; next expected unreliable sequenced TSN is %lu\n",
+                        _ui32NextUnreliableSequencedPacketTSN);
+    }
+    int rc = _pFECDecoder->processRepairChunk (repairChunkAccessor);
+    bool bSendFeedback = checkFECFeedback();
+    _mFEC.unlock();
+    if (bSendFeedback) {
+        // The counters are piggybacked on the next packet sent to the remote endpoint
+        // NOTE: Must not be invoked while holding _mFEC, since the Transmitter holds its own lock when calling getFECFeedback()
+        _pMocket->getTransmitter()->requestSAckTransmission();
+    }
+    packetArrived();
+    return rc;
+}
+
+bool PacketProcessor::getFECFeedback (uint32 &ui32ExpectedPackets, uint32 &ui32LostPackets)
+{
+    _mFEC.lock();
+    if ((!_bFECFeedbackPending) || (_pFECDecoder == nullptr)) {
+        _mFEC.unlock();
+        return false;
+    }
+    ui32ExpectedPackets = _pFECDecoder->getExpectedPacketCount();
+    ui32LostPackets = _pFECDecoder->getLostPacketCount();
+    _mFEC.unlock();
+    return true;
+}
+
+void PacketProcessor::fecFeedbackSent (void)
+{
+    _mFEC.lock();
+    _bFECFeedbackPending = false;
+    _mFEC.unlock();
+}
+
+int PacketProcessor::fecPacketRecovered (uint32 ui32TSN, const uint8 *pSymbol, uint16 ui16BodyLen)
+{
+    // Rebuild the packet - the window size is not used for unreliable packets
+    uint16 ui16PacketSize = Packet::HEADER_SIZE + ui16BodyLen;
+    char *pBuf = (char*) PacketPool::allocate (_pMocket->getPacketPool(), ui16PacketSize);
+    if (pBuf == nullptr) {
+        return -1;
+    }
+    *((uint16*)(pBuf + 0)) = *((const uint16*)(pSymbol + 0));
+    *((uint32*)(pBuf + 2)) = 0;
+    *((uint32*)(pBuf + 6)) = EndianHelper::htonl (_pMocket->getIncomingValidation());
+    *((uint32*)(pBuf + 10)) = EndianHelper::htonl (ui32TSN);
+    memcpy (pBuf + Packet::HEADER_SIZE, pSymbol + FECEncoder::SOURCE_SYMBOL_HEADER_SIZE, ui16BodyLen);
+
+    uint16 ui16Flags = EndianHelper::ntohs (*((uint16*)(pBuf + 0)));
+    if (((ui16Flags & (Packet::HEADER_FLAG_RELIABLE | Packet::HEADER_FLAG_SEQUENCED | Packet::HEADER_FLAG_CONTROL)) != Packet::HEADER_FLAG_SEQUENCED) ||
+        (FECEncoder::getSourceBodyLength (pBuf, ui16PacketSize) != ui16BodyLen)) {
+        checkAndLogMsg ("PacketProcessor::fecPacketRecovered", Logger::L_MildError,
+                        "rebuilt packet %lu is not a valid unreliable sequenced packet\n", ui32TSN);
+        PacketPool::release (pBuf);
+        return -2;
+    }
+
+    Packet *pPacket = new (_pMocket->getPacketPool()) Packet (pBuf, ui16PacketSize, _pMocket->getPacketPool(), true);
+    pPacket->resetChunkIterator();
+    pPacket->getChunkType();        // Initializes the tag of the packet from the data chunk
+    pPacket->prepareForProcessing();
+    _pReceiver->incrementQueuedDataSize (pPacket->getPacketSize());
+
+    PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pPacket, getTimeInMilliseconds());
+    if (!_pUnreliableSequencedPacketQueue->insert (pWrapper)) {
+        // The timeout for the packet expired before it could be rebuilt
+        checkAndLogMsg ("PacketProcessor::fecPacketRecovered", Logger::L_LowDetailDebug,
+                        "could not enqueue rebuilt packet %lu\n", ui32TSN);
+        dequeuedPacket (pPacket);
+        delete pWrapper;
+        delete pPacket;
+        return -3;
+    }
+    checkAndLogMsg ("PacketProcessor::fecPacketRecovered", Logger::L_MediumDetailDebug,
+                    "rebuilt lost packet %lu\n", ui32TSN);
+    _pMocket->getStatistics()->_ui32FECRecoveredPackets++;
+    return 0;
+}
+
+void PacketProcessor::fecPacketUnrecoverable (uint32 ui32TSN)
+{
+    _pUnreliableSequencedPacketQueue->lock();
+    if (_pUnreliableSequencedPacketQueue->canInsert (ui32TSN)) {
+        PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (ui32TSN, getTimeInMilliseconds());
+        _pUnreliableSequencedPacketQueue->insert (pWrapper);
+        _pMocket->getStatistics()->_ui32FECUnrecoveredPackets++;
+        checkAndLogMsg ("PacketProcessor::fecPacketUnrecoverable", Logger::L_MediumDetailDebug,
+                        "packet %lu was lost and could not be rebuilt\n", ui32TSN);
+    }
+    _pUnreliableSequencedPacketQueue->unlock();
+}
+
+bool PacketProcessor::checkFECFeedback (void)
+{
+    uint32 ui32ExpectedPackets = _pFECDecoder->getExpectedPacketCount();
+    if (ui32ExpectedPackets == _ui32LastFECExpectedPackets) {
+        return false;
+    }
+    int64 i64CurrTime = getTimeInMilliseconds();
+    if ((i64CurrTime - _i64LastFECFeedbackRequestTime) < Mocket::DEFAULT_FEC_FEEDBACK_INTERVAL) {
+        return false;
+    }
+    _ui32LastFECExpectedPackets = ui32ExpectedPackets;
+    _i64LastFECFeedbackRequestTime = i64CurrTime;
+    _bFECFeedbackPending = true;
+    return true;
+}
+
 int PacketProcessor::processPacket (Packet *pPacket)
 {
     bool bFoundDataChunk = false;
@@ -359,6 +516,11 @@ int PacketProcessor::processPacket (Packet *pPacket)
                                 ui32SequenceNum);
                 break;
             }
+
+            default:
+                // Metadata chunks (SAck, Heartbeat, Cancelled, FECRepair, FECFeedback, ...) have
+                // already been handled by the Receiver when the packet arrived
+                break;
         }
         if ((bFoundDataChunk) || (!pPacket->advanceToNextChunk())) {      // NOTE: It is important to check if a data chunk has been found first
             break;                                                        // If so, pPacket has been passed off to the receivedDataQueue, which
@@ -613,17 +775,7 @@ void PacketProcessor::run (void)
 
     _m.lock();
     while (!bDone) {
-        bool bDequeuedPacket = false;
-        if (tryToProcessFirstPacketFromControlQueue()) {
-            bDequeuedPacket = true;
-        }
-        if (tryToProcessFirstPacketFromReliableSequencedQueue()) {
-            bDequeuedPacket = true;
-        }
-        if (tryToProcessFirstPacketFromUnreliableSequencedQueue()) {
-            bDequeuedPacket = true;
-        }
-        if (!bDequeuedPacket) {
+        if (!dequeueReadyPackets()) {
             // If nothing has been dequeued, go to sleep until the next possible delivery timeout
             // Will also be woken up by the receiver calling packetArrived()
             /*!!*/ // Change the following so that there is a minimum wait time - right now getUnreliableSequencedDeliveryTimeout returns a constant time of 3000
@@ -637,10 +789,37 @@ void PacketProcessor::run (void)
         }
     }
     _m.unlock();
+    terminate();
+}
+
+void PacketProcessor::processAvailablePackets (void)
+{
+    _m.lock();
+    while (dequeueReadyPackets());
+    _m.unlock();
+}
+
+void PacketProcessor::terminate (void)
+{
     _receivedDataQueue.close();
     _pMocket->packetProcessorTerminating();
 }
 
+bool PacketProcessor::dequeueReadyPackets (void)
+{
+    bool bDequeuedPacket = false;
+    if (tryToProcessFirstPacketFromControlQueue()) {
+        bDequeuedPacket = true;
+    }
+    if (tryToProcessFirstPacketFromReliableSequencedQueue()) {
+        bDequeuedPacket = true;
+    }
+    if (tryToProcessFirstPacketFromUnreliableSequencedQueue()) {
+        bDequeuedPacket = true;
+    }
+    return bDequeuedPacket;
+}
+
 int PacketProcessor::freeze (ObjectFreezer &objectFreezer)
 {
     objectFreezer.beginNewObject ("PacketProcessor");
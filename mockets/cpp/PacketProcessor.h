@@ -20,6 +20,7 @@
  * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
  */
 
+#include "PacketAccessors.h"
 #include "PacketQueue.h"
 
 #include "ConditionVariable.h"
@@ -30,6 +31,7 @@
 #include <stdarg.h>
 
 
+class FECDecoder;
 class Mocket;
 class Packet;
 class Receiver;
@@ -67,6 +69,25 @@ class PacketProcessor : public NOMADSUtil::Thread
         // Called by the receiver to process an unreliable unsequenced packet
         int processUnreliableUnsequencedPacket (Packet *pPacket);
 
+        // Returns true once the remote Transmitter has started to send FEC repair packets
+        // From then on, unreliable sequenced packets are buffered so that the lost ones can be rebuilt
+        bool isFECActive (void);
+
+        // Called by the Receiver to process an unreliable sequenced packet when FEC is active
+        // The packet is enqueued into the unreliable sequenced packet queue and packetArrived() is invoked
+        int processFECProtectedPacket (Packet *pPacket, int64 i64RecvTime);
+
+        // Called by the Receiver to process an FEC repair chunk
+        // Any lost packet that is rebuilt is enqueued into the unreliable sequenced packet queue
+        int processFECRepairChunk (FECRepairChunkAccessor repairChunkAccessor);
+
+        // Called by the Transmitter when sending a packet
+        // Returns true if the FEC loss counters should be sent to the remote endpoint
+        bool getFECFeedback (uint32 &ui32ExpectedPackets, uint32 &ui32LostPackets);
+
+        // Called by the Transmitter after the FEC loss counters have been added to a packet
+        void fecFeedbackSent (void);
+
         // Returns the size of the next message that is ready to be delivered to the application,
         //     0 in case of the connection being closed, and -1 in case no data is available within the specified timeout
         // If no message is available, the call will block based on the timeout parameter
@@ -92,12 +113,37 @@ class PacketProcessor : public NOMADSUtil::Thread
 
         void run (void);
 
+        // Used in place of run() when the mocket shares the socket of a ServerMocket
+        // Delivers all the packets that are ready in the sequenced queues
+        void processAvailablePackets (void);
+
+        // Closes the queue of received data and notifies the mocket that the packet processor terminated
+        void terminate (void);
+
     private:
         friend class DataBuffer;
         void dequeuedPacket (Packet *pPacket);
 
+    private:
+        friend class FECDecoder;
+        // Enqueues a packet rebuilt by the FEC decoder
+        // Returns 0 if successful or a negative value if the packet could not be rebuilt or enqueued
+        int fecPacketRecovered (uint32 ui32TSN, const uint8 *pSymbol, uint16 ui16BodyLen);
+
+        // Enqueues a place holder for a lost packet that the FEC decoder could not rebuild,
+        // so that the following packets can be delivered without waiting for the timeout
+        void fecPacketUnrecoverable (uint32 ui32TSN);
+
+        // Called after a repair chunk has been processed - returns true if the FEC loss counters
+        // changed and were not sent recently, in which case they are marked as pending
+        // NOTE: _mFEC must be held by the caller
+        bool checkFECFeedback (void);
+
     private:
         friend class Mocket;
+        // Returns true if at least one packet was dequeued from the sequenced queues
+        // NOTE: _m must be held by the caller
+        bool dequeueReadyPackets (void);
         bool tryToProcessFirstPacketFromControlQueue (void);
         bool tryToProcessFirstPacketFromReliableSequencedQueue (void);
         bool tryToProcessFirstPacketFromUnreliableSequencedQueue (void);
@@ -147,6 +193,17 @@ class PacketProcessor : public NOMADSUtil::Thread
         NOMADSUtil::LList<Packet*> *_pUnreliableSequencedFragments;
         NOMADSUtil::LList<Packet*> *_pReliableUnsequencedFragments;
         NOMADSUtil::LList<Packet*> *_pUnreliableUnsequencedFragments;
+
+        NOMADSUtil::Mutex _mFEC;
+        FECDecoder *_pFECDecoder;               // Created when the first FEC repair chunk is received
+        bool _bFECFeedbackPending;
+        uint32 _ui32LastFECExpectedPackets;     // Value of the expected packets counter when the last feedback was requested
+        int64 _i64LastFECFeedbackRequestTime;
 };
 
+inline bool PacketProcessor::isFECActive (void)
+{
+    return (_pFECDecoder != nullptr);
+}
+
 #endif   // #ifndef INCL_PACKET_PROCESSOR_H
@@ -33,14 +33,19 @@
  *
  * After a packet has been received, the following information is used:
  *     i64LastIOTime - the time in milliseconds when the packet was received over the wire
+ * While awaiting acknowledgement, the state of the DeliveryRateEstimator of the Transmitter at the time the
+ * packet was last transmitted is also kept, so that a delivery rate sample can be computed when it is acknowledged
  * If a packet has been cancelled, the following information is used:
  *     ui32CancelledSequenceNum - the sequence number of the packet that was cancelled
  *     i64LastIOTime - the time in milliseconds when the cancelled packet notification was received over the wire
  */
 
+#include "PacketPool.h"
+
 #include "FTypes.h"
 #include "NLFLib.h"
 
+#include <new>
 #include <stddef.h>
 
 
@@ -52,6 +57,13 @@ class PacketWrapper
         PacketWrapper (Packet *pPacket, int64 i64LastIOTime);
         PacketWrapper (uint32 ui32CancelledSequenceNum, int64 i64LastIOTime);
         PacketWrapper (Packet *pPacket, int64 i64LastIOTime, uint8 ui8Priority, uint32 ui32MessageTSN, uint32 ui32RetryTimeout, uint32 ui32RetransmitTimeout);
+
+        // PacketWrapper objects are allocated from the PacketPool of the mocket when one is specified
+        static void * operator new (size_t size);
+        static void * operator new (size_t size, PacketPool *pPool);
+        static void operator delete (void *p);
+        static void operator delete (void *p, PacketPool *pPool);
+
         Packet * getPacket (void);
         uint32 getSequenceNum (void);
         int64 getEnqueueTime (void);
@@ -69,6 +81,15 @@ class PacketWrapper
         uint16 getRetransmitCount (void);
         void resetRetransmitCount (void);
         void incrementRetransmitCount (void);
+
+        // Delivery state at the time the packet was last transmitted (see DeliveryRateEstimator)
+        // The times are monotonic times in microseconds
+        void setDeliveryState (uint64 ui64Delivered, int64 i64DeliveredTime, int64 i64FirstSentTime, int64 i64SentTime);
+        uint64 getDelivered (void);
+        int64 getDeliveredTime (void);
+        int64 getFirstSentTime (void);
+        int64 getSentTime (void);
+
         int freeze (NOMADSUtil::ObjectFreezer &objectFreezer);
         int defrost (NOMADSUtil::ObjectDefroster &objectDefroster);
 
@@ -82,6 +103,10 @@ class PacketWrapper
         uint32 _ui32RetryTimeout;
         uint32 _ui32RetransmitTimeout;
         uint16 _ui16RetransmitCount;
+        uint64 _ui64Delivered;
+        int64 _i64DeliveredTime;
+        int64 _i64FirstSentTime;
+        int64 _i64SentTime;
 };
 
 inline PacketWrapper::PacketWrapper (Packet *pPacket, int64 i64LastIOTime)
@@ -95,6 +120,10 @@ inline PacketWrapper::PacketWrapper (Packet *pPacket, int64 i64LastIOTime)
     _ui32RetryTimeout = 0;
     _ui32RetransmitTimeout = 0;
     _ui16RetransmitCount = 0;
+    _ui64Delivered = 0;
+    _i64DeliveredTime = 0;
+    _i64FirstSentTime = 0;
+    _i64SentTime = 0;
 }
 
 inline PacketWrapper::PacketWrapper (uint32 ui32CancelledSequenceNum, int64 i64LastIOTime)
@@ -108,6 +137,10 @@ inline PacketWrapper::PacketWrapper (uint32 ui32CancelledSequenceNum, int64 i64L
     _ui32RetryTimeout = 0;
     _ui32RetransmitTimeout = 0;
     _ui16RetransmitCount = 0;
+    _ui64Delivered = 0;
+    _i64DeliveredTime = 0;
+    _i64FirstSentTime = 0;
+    _i64SentTime = 0;
 }
 
 inline PacketWrapper::PacketWrapper (Packet *pPacket, int64 i64LastIOTime, uint8 ui8Priority, uint32 ui32MessageTSN, uint32 ui32RetryTimeout, uint32 ui32RetransmitTimeout)
@@ -121,6 +154,34 @@ inline PacketWrapper::PacketWrapper (Packet *pPacket, int64 i64LastIOTime, uint8
     _ui32RetryTimeout = ui32RetryTimeout;
     _ui32RetransmitTimeout = ui32RetransmitTimeout;
     _ui16RetransmitCount = 0;
+    _ui64Delivered = 0;
+    _i64DeliveredTime = 0;
+    _i64FirstSentTime = 0;
+    _i64SentTime = 0;
+}
+
+inline void * PacketWrapper::operator new (size_t size)
+{
+    return operator new (size, (PacketPool*) nullptr);
+}
+
+inline void * PacketWrapper::operator new (size_t size, PacketPool *pPool)
+{
+    void *p = PacketPool::allocate (pPool, size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+inline void PacketWrapper::operator delete (void *p)
+{
+    PacketPool::release (p);
+}
+
+inline void PacketWrapper::operator delete (void *p, PacketPool *pPool)
+{
+    PacketPool::release (p);
 }
 
 inline Packet * PacketWrapper::getPacket (void)
@@ -213,6 +274,34 @@ inline void PacketWrapper::incrementRetransmitCount (void)
     _ui16RetransmitCount++;
 }
 
+inline void PacketWrapper::setDeliveryState (uint64 ui64Delivered, int64 i64DeliveredTime, int64 i64FirstSentTime, int64 i64SentTime)
+{
+    _ui64Delivered = ui64Delivered;
+    _i64DeliveredTime = i64DeliveredTime;
+    _i64FirstSentTime = i64FirstSentTime;
+    _i64SentTime = i64SentTime;
+}
+
+inline uint64 PacketWrapper::getDelivered (void)
+{
+    return _ui64Delivered;
+}
+
+inline int64 PacketWrapper::getDeliveredTime (void)
+{
+    return _i64DeliveredTime;
+}
+
+inline int64 PacketWrapper::getFirstSentTime (void)
+{
+    return _i64FirstSentTime;
+}
+
+inline int64 PacketWrapper::getSentTime (void)
+{
+    return _i64SentTime;
+}
+
 inline int PacketWrapper::freeze (NOMADSUtil::ObjectFreezer &objectFreezer)
 {
     //Data from _pPacket
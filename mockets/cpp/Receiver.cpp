@@ -23,6 +23,7 @@
 #include "Mocket.h"
 #include "MocketStatusNotifier.h"
 #include "PacketAccessors.h"
+#include "PacketPool.h"
 #include "PacketProcessor.h"
 #include "Transmitter.h"
 
@@ -96,6 +97,8 @@ Receiver::Receiver (Mocket *pMocket, bool bEnableRecvLogging)
         _filePacketRecvLog = nullptr;
     }
     _i64LogStartTime = _i64LastRecvLogTime = getTimeInMilliseconds();
+    _i64LastAppCallbackTime = 0;
+    _bCloseConn = false;
 }
 
 Receiver::~Receiver (void)
@@ -184,390 +187,444 @@ int Receiver::defrost (ObjectDefroster &objectDefroster)
 
 void Receiver::run (void)
 {
-    bool bDone = false;
-    bool bCloseConn = false;
-    int64 i64CloseWaitTime = 0;
-    char *pRecBuf = (char*) malloc (_pMocket->getMaximumMTU());
+    // Read several datagrams with one system call if the CommInterface supports it
+    // Datagrams are received into buffers allocated from the PacketPool, so that the packets that are
+    // queued for processing can keep the buffer instead of copying it
+    const uint16 ui16BatchSize = _pCommInterface->isBatchIOSupported() ? RECEIVE_BATCH_SIZE : 1;
+    PacketPool *pPacketPool = _pMocket->getPacketPool();
+    CommInterface::Datagram datagrams[RECEIVE_BATCH_SIZE];
+    for (uint16 ui16 = 0; ui16 < ui16BatchSize; ui16++) {
+        datagrams[ui16].pBuf = PacketPool::allocate (pPacketPool, _pMocket->getMaximumMTU());
+        datagrams[ui16].iBufSize = _pMocket->getMaximumMTU();
+    }
     _pCommInterface->setReceiveTimeout (_pMocket->getUDPReceiveTimeout());
-    int64 i64LastAppCallbackTime = 0;
 
+    bool bDone = false;
     while (!bDone) {
-        bool bReceiveError = false;
-        bool bNewRemoteNode = false;
-        InetAddr remoteAddr;
-        Packet *pRecvPacket = nullptr;
-        int rc = _pCommInterface->receive (pRecBuf, _pMocket->getMaximumMTU(), &remoteAddr);
-
-        // Check the return value of receive
-        if (rc < 0) {
-            checkAndLogMsg ("Receiver::run", Logger::L_LowDetailDebug,
-                            "error receiving a packet; remote endpoint = %s:%d; rc = %d; os error = %d\n",
-                            _pszRemoteAddress, (int) _ui16RemotePort, rc, _pCommInterface->getLastError());
-            bReceiveError = true;
+        int rcReceive = _pCommInterface->receiveBatch (datagrams, ui16BatchSize);
+        if (rcReceive > 0) {
+            _pMocket->getStatistics()->_ui32ReceiveSyscalls++;
+            _pMocket->getStatistics()->_ui32ReceivedDatagrams += rcReceive;
         }
-        else if (rc == 0) {
-            checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                            "error receiving a packet; socket timed out\n");
-            bReceiveError = true;
+        bool bError = false;
+        // When receiveBatch() timed out or failed, process its return value as a single datagram
+        for (int i = 0; i < ((rcReceive > 0) ? rcReceive : 1); i++) {
+            bool bBufAdopted = false;
+            int rc = processReceivedDatagram ((char*) datagrams[i].pBuf, (rcReceive > 0) ? datagrams[i].iDataSize : rcReceive,
+                                              &datagrams[i].remoteAddr, &bBufAdopted);
+            if (bBufAdopted) {
+                datagrams[i].pBuf = PacketPool::allocate (pPacketPool, _pMocket->getMaximumMTU());
+            }
+            if (rc == -2) {
+                bDone = true;
+                break;
+            }
+            else if (rc < 0) {
+                bError = true;
+            }
+            if (isTerminated()) {
+                bDone = true;
+                break;
+            }
         }
-        else if (rc < Packet::HEADER_SIZE) {
-            checkAndLogMsg ("Receiver::run", Logger::L_MildError,
-                            "error receiving a packet; received a short packet of size %d\n", rc);
-            bReceiveError = true;
+        if ((bError) && (!bDone)) {
+            /*!!*/ // NOTE: The following sleep is to protect from the problem where sometimes receive on the Datagram Socket
+                   // returns imemdiately, causing a loop that consumes too much CPU time.
+                   // Seems to occur on Win32 when the OS detects the condition where the remote application has gone away
+                   // (or some such condition)
+                   // Need to find out whether receive() is returning 0 or < 0 and only sleep in that case
+            sleepForMilliseconds (10);
         }
-        // Check the packet itself
-        else {
-            pRecvPacket = new Packet (pRecBuf, rc);
+    }
+
+    for (uint16 ui16 = 0; ui16 < ui16BatchSize; ui16++) {
+        PacketPool::release (datagrams[ui16].pBuf);
+    }
+    _pMocket->receiverTerminating();
+}
+
+bool Receiver::isTerminated (void)
+{
+    const auto smCurrentState = _pMocket->getStateMachine()->getCurrentState();
+    return ((smCurrentState == StateMachine::S_CLOSED) || (smCurrentState == StateMachine::S_APPLICATION_ABORT) ||
+            (smCurrentState == StateMachine::S_SUSPENDED));
+}
 
-            if (pRecvPacket->getValidation() != _ui32IncomingValidation) {
-                checkAndLogMsg ("Receiver::run", Logger::L_Warning,
-                                "error receiving a packet; received a packet with an incorrect validation - expecting %lu, got %lu\n",
-                                _ui32IncomingValidation, pRecvPacket->getValidation());
+int Receiver::processReceivedDatagram (char *pRecBuf, int rc, InetAddr *pRemoteAddr, bool *pbBufAdopted)
+{
+    bool bReceiveError = false;
+    Packet *pRecvPacket = nullptr;
+    // Check the return value of receive
+    if (rc < 0) {
+        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_LowDetailDebug,
+                        "error receiving a packet; remote endpoint = %s:%d; rc = %d; os error = %d\n",
+                        _pszRemoteAddress, (int) _ui16RemotePort, rc, _pCommInterface->getLastError());
+        bReceiveError = true;
+    }
+    else if (rc == 0) {
+        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                        "error receiving a packet; socket timed out\n");
+        bReceiveError = true;
+    }
+    else if (rc < Packet::HEADER_SIZE) {
+        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MildError,
+                        "error receiving a packet; received a short packet of size %d\n", rc);
+        bReceiveError = true;
+    }
+    // Check the packet itself
+    else {
+        pRecvPacket = new (_pMocket->getPacketPool()) Packet (pRecBuf, rc, _pMocket->getPacketPool(), pbBufAdopted != nullptr);
+
+        if (pRecvPacket->getValidation() != _ui32IncomingValidation) {
+            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_Warning,
+                            "error receiving a packet; received a packet with an incorrect validation - expecting %lu, got %lu\n",
+                            _ui32IncomingValidation, pRecvPacket->getValidation());
+            delete pRecvPacket;
+            pRecvPacket = nullptr;
+            bReceiveError = true;
+        }
+        else if((pRemoteAddr->getIPAddress() != _ui32RemoteAddress) || (pRemoteAddr->getPort() != _ui16RemotePort)) {
+
+            // It is possible that this is not an error condition if current node
+            // is in suspend_received and the received packet is a resume
+            // or if the message is a Reestablish message due to a change in the network attachment
+            if (((_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_SUSPEND_RECEIVED) &&
+                    (pRecvPacket->getChunkType() == Packet::CT_Resume)) || (pRecvPacket->getChunkType() == Packet::CT_ReEstablish)) {
+                bReceiveError = false;
+            }
+            // error
+            else {
+                checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_Warning,
+                                "error receiving a packet; received a packet from some other endpoint %s:%d\n",
+                                pRemoteAddr->getIPAsString(), (int) pRemoteAddr->getPort());
                 delete pRecvPacket;
                 pRecvPacket = nullptr;
                 bReceiveError = true;
             }
-            else if((remoteAddr.getIPAddress() != _ui32RemoteAddress) || (remoteAddr.getPort() != _ui16RemotePort)) {
-
-                // It is possible that this is not an error condition if current node
-                // is in suspend_received and the received packet is a resume
-                // or if the message is a Reestablish message due to a change in the network attachment
-                if (((_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_SUSPEND_RECEIVED) &&
-                        (pRecvPacket->getChunkType() == Packet::CT_Resume)) || (pRecvPacket->getChunkType() == Packet::CT_ReEstablish)) {
-                    bReceiveError = false;
-                }
-                // error
-                else {
-                    checkAndLogMsg ("Receiver::run", Logger::L_Warning,
-                                    "error receiving a packet; received a packet from some other endpoint %s:%d\n",
-                                    remoteAddr.getIPAsString(), (int) remoteAddr.getPort());
-                    delete pRecvPacket;
-                    pRecvPacket = nullptr;
-                    bReceiveError = true;
-                }
-            }
         }
+    }
 
-        if (bReceiveError) {
-            if (_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_APPLICATION_ABORT) {
-                checkAndLogMsg ("Receiver::run", Logger::L_LowDetailDebug,
-                                "application abort sent to the receiver thread");
-                break;
-            }
-            if (!bCloseConn) {
-                int64 i64CurrTime = getTimeInMilliseconds();
-                uint32 ui32ElapsedTime = (uint32) (i64CurrTime - _i64LastRecvTime);
-                if (ui32ElapsedTime > (_pMocket->getKeepAliveTimeout() * 2UL)) {
-                    // Call a specific callback function if the state is S_SUSPEND_RECEIVED
-                    // the application should know that the mocket has been suspended
-                    if (_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_SUSPEND_RECEIVED) {
-                        // If a suspendReceived callback function is defined
-                        if (_pMocket->_pSuspendReceivedWarningCallbackFn) {
-                            if ((i64CurrTime - i64LastAppCallbackTime) > 500) {
-                                // Only call the application once every 500 ms
-                                checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                                "suspend received callback invoked\n");
-                                if (_pMocket->_pSuspendReceivedWarningCallbackFn (_pMocket->_pSuspendReceivedCallbackArg, ui32ElapsedTime)) {
-                                    // Application has requested that the connection be closed
-                                    bCloseConn = true;
-                                    _pMocket->setConnectionLingerTime (1);   // Do not want to linger if the application has requested a close
-                                    _pMocket->close();
-                                }
-                                i64LastAppCallbackTime = i64CurrTime;
+    if (bReceiveError) {
+        if (_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_APPLICATION_ABORT) {
+            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_LowDetailDebug,
+                            "application abort sent to the receiver thread");
+            return -2;
+        }
+        if (!_bCloseConn) {
+            int64 i64CurrTime = getTimeInMilliseconds();
+            uint32 ui32ElapsedTime = (uint32) (i64CurrTime - _i64LastRecvTime);
+            if (ui32ElapsedTime > (_pMocket->getKeepAliveTimeout() * 2UL)) {
+                // Call a specific callback function if the state is S_SUSPEND_RECEIVED
+                // the application should know that the mocket has been suspended
+                if (_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_SUSPEND_RECEIVED) {
+                    // If a suspendReceived callback function is defined
+                    if (_pMocket->_pSuspendReceivedWarningCallbackFn) {
+                        if ((i64CurrTime - _i64LastAppCallbackTime) > 500) {
+                            // Only call the application once every 500 ms
+                            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                            "suspend received callback invoked\n");
+                            if (_pMocket->_pSuspendReceivedWarningCallbackFn (_pMocket->_pSuspendReceivedCallbackArg, ui32ElapsedTime)) {
+                                // Application has requested that the connection be closed
+                                _bCloseConn = true;
+                                _pMocket->setConnectionLingerTime (1);   // Do not want to linger if the application has requested a close
+                                _pMocket->close();
                             }
+                            _i64LastAppCallbackTime = i64CurrTime;
                         }
                     }
-                    else {
-                        // If a peer unreachable callback function is defined
-                        if (_pMocket->_pPeerUnreachableWarningCallbackFn) {
-                            if ((i64CurrTime - i64LastAppCallbackTime) > 500) {
-                                // Only call the application once every 500 ms
-                                checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                                "peer unreachable callback invoked\n");
-                                if (_pMocket->_pPeerUnreachableWarningCallbackFn (_pMocket->_pPeerUnreachableCallbackArg, ui32ElapsedTime)) {
-                                    // Application has requested that the connection be closed
-                                    bCloseConn = true;
-                                    _pMocket->setConnectionLingerTime (1);   // Do not want to linger if the application has requested a close
-                                    _pMocket->close();
-                                }
-                                i64LastAppCallbackTime = i64CurrTime;
+                }
+                else {
+                    // If a peer unreachable callback function is defined
+                    if (_pMocket->_pPeerUnreachableWarningCallbackFn) {
+                        if ((i64CurrTime - _i64LastAppCallbackTime) > 500) {
+                            // Only call the application once every 500 ms
+                            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                            "peer unreachable callback invoked\n");
+                            if (_pMocket->_pPeerUnreachableWarningCallbackFn (_pMocket->_pPeerUnreachableCallbackArg, ui32ElapsedTime)) {
+                                // Application has requested that the connection be closed
+                                _bCloseConn = true;
+                                _pMocket->setConnectionLingerTime (1);   // Do not want to linger if the application has requested a close
+                                _pMocket->close();
                             }
+                            _i64LastAppCallbackTime = i64CurrTime;
                         }
                     }
                 }
             }
-            /*!!*/ // NOTE: The following sleep is to protect from the problem where sometimes receive on the Datagram Socket
-                   // returns imemdiately, causing a loop that consumes too much CPU time.
-                   // Seems to occur on Win32 when the OS detects the condition where the remote application has gone away
-                   // (or some such condition)
-                   // Need to find out whether receive() is returning 0 or < 0 and only sleep in that case
-            sleepForMilliseconds (10);
         }
-        else {
+        return -1;
+    }
+    else {
 
-            // At this point, we have a validated packet
-            // If the state is S_SUSPEND_RECEIVED accept only resume and suspend packets
-            if (_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_SUSPEND_RECEIVED) {
-                if (pRecvPacket->getChunkType() == Packet::CT_Resume) {
-                    _i64LastRecvTime = getTimeInMilliseconds();
-                    _pMocket->getMocketStatusNotifier()->setLastContactTime (_i64LastRecvTime);
-                    // printf ("Receiver::run Received resume packet\n");
-                    // Extract, decrypt and check the nonce with this method
-                    _pMocket->getTransmitter()->processResumePacket(pRecvPacket->getResumeChunk(), remoteAddr.getIPAddress(), remoteAddr.getPort());
-                }
-                else if (pRecvPacket->getChunkType() == Packet::CT_Suspend) {
-                    _i64LastRecvTime = getTimeInMilliseconds();
-                    _pMocket->getMocketStatusNotifier()->setLastContactTime (_i64LastRecvTime);
-                    checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                    "received a valid packet of size %d from %s:%d\n",
-                                    rc, _pszRemoteAddress, _ui16RemotePort);
-                    //printf ("Receiver::run Received suspend packet when already suspended, send new suspend_ack\n");
-                    _pMocket->getTransmitter()->processSuspendPacket(pRecvPacket->getSuspendChunk());
-                }
+        // At this point, we have a validated packet
+        // If the state is S_SUSPEND_RECEIVED accept only resume and suspend packets
+        if (_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_SUSPEND_RECEIVED) {
+            if (pRecvPacket->getChunkType() == Packet::CT_Resume) {
+                _i64LastRecvTime = getTimeInMilliseconds();
+                _pMocket->getMocketStatusNotifier()->setLastContactTime (_i64LastRecvTime);
+                // printf ("Receiver::run Received resume packet\n");
+                // Extract, decrypt and check the nonce with this method
+                _pMocket->getTransmitter()->processResumePacket(pRecvPacket->getResumeChunk(), pRemoteAddr->getIPAddress(), pRemoteAddr->getPort());
             }
-            else {
-                if (i64LastAppCallbackTime > 0) {
-                    // The peer has been unreacheable and just came back, notify the application if a callback has been registered
-                    if (_pMocket->_pPeerReachableCallbackFn) {
-                        uint32 ui32UnreachabilityIntervalLength = (uint32)(getTimeInMilliseconds() - _i64LastRecvTime);
-                        _pMocket->_pPeerReachableCallbackFn (_pMocket->_pPeerReachableCallbackArg, ui32UnreachabilityIntervalLength);
-                    }
-                    // Reset callback time
-                    i64LastAppCallbackTime = 0;
-                }
-
+            else if (pRecvPacket->getChunkType() == Packet::CT_Suspend) {
                 _i64LastRecvTime = getTimeInMilliseconds();
                 _pMocket->getMocketStatusNotifier()->setLastContactTime (_i64LastRecvTime);
-                checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
+                checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
                                 "received a valid packet of size %d from %s:%d\n",
                                 rc, _pszRemoteAddress, _ui16RemotePort);
-                _ui32BytesReceived += rc;
+                //printf ("Receiver::run Received suspend packet when already suspended, send new suspend_ack\n");
+                _pMocket->getTransmitter()->processSuspendPacket(pRecvPacket->getSuspendChunk());
+            }
+        }
+        else {
+            if (_i64LastAppCallbackTime > 0) {
+                // The peer has been unreacheable and just came back, notify the application if a callback has been registered
+                if (_pMocket->_pPeerReachableCallbackFn) {
+                    uint32 ui32UnreachabilityIntervalLength = (uint32)(getTimeInMilliseconds() - _i64LastRecvTime);
+                    _pMocket->_pPeerReachableCallbackFn (_pMocket->_pPeerReachableCallbackArg, ui32UnreachabilityIntervalLength);
+                }
+                // Reset callback time
+                _i64LastAppCallbackTime = 0;
+            }
 
-                if (_filePacketRecvLog) {
-                    const char *pszFragment = "no";
-                    if (pRecvPacket->isFirstFragment()) {
-                        pszFragment = "First";
-                    }
-                    else if (pRecvPacket->isIntermediateFragment()) {
-                        pszFragment = "Int";
-                    }
-                    else if (pRecvPacket->isLastFragment()) {
-                        pszFragment = "Last";
-                    }
-                    #if defined (WIN32)
-                        fprintf (_filePacketRecvLog, "%I64d, %I64d, %d, %d, %s, %s, %s, %d\n",
-                    #else
-                        fprintf (_filePacketRecvLog, "%lld, %lld, %d, %d, %s, %s, %s, %d\n",
-                    #endif
-                                 (_i64LastRecvTime - _i64LogStartTime),
-                                 (_i64LastRecvTime - _i64LastRecvLogTime),
-                                 (int) pRecvPacket->getPacketSize(), (int) pRecvPacket->getSequenceNum(),
-                                 pRecvPacket->isReliablePacket() ? "yes" : "no",
-                                 pRecvPacket->isSequencedPacket() ? "yes" : "no",
-                                 pszFragment, (int) pRecvPacket->getTagId());
-                    _i64LastRecvLogTime = _i64LastRecvTime;
+            _i64LastRecvTime = getTimeInMilliseconds();
+            _pMocket->getMocketStatusNotifier()->setLastContactTime (_i64LastRecvTime);
+            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                            "received a valid packet of size %d from %s:%d\n",
+                            rc, _pszRemoteAddress, _ui16RemotePort);
+            _ui32BytesReceived += rc;
+
+            if (_filePacketRecvLog) {
+                const char *pszFragment = "no";
+                if (pRecvPacket->isFirstFragment()) {
+                    pszFragment = "First";
+                }
+                else if (pRecvPacket->isIntermediateFragment()) {
+                    pszFragment = "Int";
+                }
+                else if (pRecvPacket->isLastFragment()) {
+                    pszFragment = "Last";
                 }
+                #if defined (WIN32)
+                    fprintf (_filePacketRecvLog, "%I64d, %I64d, %d, %d, %s, %s, %s, %d\n",
+                #else
+                    fprintf (_filePacketRecvLog, "%lld, %lld, %d, %d, %s, %s, %s, %d\n",
+                #endif
+                             (_i64LastRecvTime - _i64LogStartTime),
+                             (_i64LastRecvTime - _i64LastRecvLogTime),
+                             (int) pRecvPacket->getPacketSize(), (int) pRecvPacket->getSequenceNum(),
+                             pRecvPacket->isReliablePacket() ? "yes" : "no",
+                             pRecvPacket->isSequencedPacket() ? "yes" : "no",
+                             pszFragment, (int) pRecvPacket->getTagId());
+                _i64LastRecvLogTime = _i64LastRecvTime;
+            }
+
+            // Update the remote window size
+            _pMocket->getTransmitter()->setRemoteWindowSize (pRecvPacket->getWindowSize());
+            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                            "remote window size is %d\n", (int) pRecvPacket->getWindowSize());
+
+            // Check for SAck Chunks and update the Transmitter
+            pRecvPacket->resetChunkIterator();
+            while (true) {
+
 
-                // Update the remote window size
-                _pMocket->getTransmitter()->setRemoteWindowSize (pRecvPacket->getWindowSize());
-                checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                "remote window size is %d\n", (int) pRecvPacket->getWindowSize());
-
-                // Check for SAck Chunks and update the Transmitter
-                pRecvPacket->resetChunkIterator();
-                while (true) {
-
-
-                    //printf("Packet size: %d!\n", pRecvPacket->getPacketSize());
-
-                    //printf("\nTTTEEEEEEEEEEEST!!: %d\n", pRecvPacket->getChunkType());
-
-                    switch (pRecvPacket->getChunkType()) {
-                        case Packet::CT_Init:
-                        case Packet::CT_InitAck:
-                        case Packet::CT_CookieEcho:
-                        case Packet::CT_CookieAck:
-                        case Packet::CT_ResumeAck:
-                        case Packet::CT_ReEstablishAck:
-                            //printf ("Receiver::run Received an unexpected packet\n");
-                            checkAndLogMsg ("Receiver::run", Logger::L_Warning,
-                                            "received an un expected chunk of type %d\n", (int) pRecvPacket->getChunkType());
-                            break;
-                        case Packet::CT_SAck:
-                            //printf ("Receiver::run Received SAck packet\n");
-                            _pMocket->getTransmitter()->processSAckChunk (pRecvPacket->getSAckChunk());
-                            _pMocket->getCancelledTSNManager()->processSAckChunk (pRecvPacket->getSAckChunk());
-                            break;
-                        case Packet::CT_SAckRecBandEst:
-                            //printf ("Receiver::run Received SAck packet\n");
-                            _pMocket->getTransmitter()->processSAckChunk (pRecvPacket->getSAckRecBandEstChunk());
-                            _pMocket->getCancelledTSNManager()->processSAckChunk (pRecvPacket->getSAckRecBandEstChunk());
-                            break;
-                        case Packet::CT_Cancelled:
-                            //printf ("Receiver::run Received cancelled packet\n");
-                            processCancelledChunk (pRecvPacket->getCancelledChunk());
-                            break;
-                        case Packet::CT_Timestamp:
-                            //printf ("Receiver::run Received timestamp chunk\n");
-                            _pMocket->getTransmitter()->processTimestampChunk (pRecvPacket->getTimestampChunk());
-                            break;
-                        case Packet::CT_TimestampAck:
-                            //printf ("Receiver::run Received timestampAck chunk\n");
-                            _pMocket->getTransmitter()->processTimestampAckChunk (pRecvPacket->getTimestampAckChunk());
-                            break;
-
-                        // Suspend/Resume process messages
-                        case Packet::CT_SimpleSuspend:
-                            //printf ("Receiver::run Received simpleSuspend packet\n");
-                            // Check for simultaneous suspension.
-                            // Continue to wait suspend_ack or go in SUSPEND_RECEIVED state
-                            _pMocket->getTransmitter()->processSimpleSuspendPacket(pRecvPacket->getSimpleSuspendChunk());
-                            break;
-                        case Packet::CT_SimpleSuspendAck:
-                            //printf ("Receiver::run Received simpleSuspendAck packet\n");
-                            // Extract, decrypt and save nonce (UUID) and Ks
-                            _pMocket->getTransmitter()->processSimpleSuspendAckPacket(pRecvPacket->getSimpleSuspendAckChunk());
-                            break;
-                        case Packet::CT_Suspend:
-                            //printf ("Receiver::run Received suspend packet\n");
-                            // Check for simultaneous suspension.
-                            // Continue to wait suspend_ack or go in SUSPEND_RECEIVED state
-                            _pMocket->getTransmitter()->processSuspendPacket(pRecvPacket->getSuspendChunk());
-                            break;
-                        case Packet::CT_SuspendAck:
-                            //printf ("Receiver::run Received suspendAck packet\n");
-                            // Extract, decrypt and save nonce (UUID) and Ks
-                            _pMocket->getTransmitter()->processSuspendAckPacket(pRecvPacket->getSuspendAckChunk());
-                            break;
-                        case Packet::CT_Resume:
-                            //printf ("Receiver::run Received resume packet\n");
-                            // Extract, decrypt and check the nonce
-                            _pMocket->getTransmitter()->processResumePacket(pRecvPacket->getResumeChunk(), remoteAddr.getIPAddress(), remoteAddr.getPort());
-                            break;
-                        case Packet::CT_ReEstablish:
-                            //printf ("Receiver::run Received reEstablish packet\n");
-                            // Extract, decrypt and check the nonce
-                            _pMocket->getTransmitter()->processReEstablishPacket(pRecvPacket->getReEstablishChunk(), remoteAddr.getIPAddress(), remoteAddr.getPort());
-                            break;
-                    };
-                    if (!pRecvPacket->advanceToNextChunk()) {
+                //printf("Packet size: %d!\n", pRecvPacket->getPacketSize());
+
+                //printf("\nTTTEEEEEEEEEEEST!!: %d\n", pRecvPacket->getChunkType());
+
+                switch (pRecvPacket->getChunkType()) {
+                    case Packet::CT_Init:
+                    case Packet::CT_InitAck:
+                    case Packet::CT_CookieEcho:
+                    case Packet::CT_CookieAck:
+                    case Packet::CT_ResumeAck:
+                    case Packet::CT_ReEstablishAck:
+                        //printf ("Receiver::run Received an unexpected packet\n");
+                        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_Warning,
+                                        "received an un expected chunk of type %d\n", (int) pRecvPacket->getChunkType());
+                        break;
+                    case Packet::CT_SAck:
+                        //printf ("Receiver::run Received SAck packet\n");
+                        _pMocket->getTransmitter()->processSAckChunk (pRecvPacket->getSAckChunk());
+                        _pMocket->getCancelledTSNManager()->processSAckChunk (pRecvPacket->getSAckChunk());
+                        break;
+                    case Packet::CT_SAckRecBandEst:
+                        //printf ("Receiver::run Received SAck packet\n");
+                        _pMocket->getTransmitter()->processSAckChunk (pRecvPacket->getSAckRecBandEstChunk());
+                        _pMocket->getCancelledTSNManager()->processSAckChunk (pRecvPacket->getSAckRecBandEstChunk());
+                        break;
+                    case Packet::CT_Cancelled:
+                        //printf ("Receiver::run Received cancelled packet\n");
+                        processCancelledChunk (pRecvPacket->getCancelledChunk());
+                        break;
+                    case Packet::CT_Timestamp:
+                        //printf ("Receiver::run Received timestamp chunk\n");
+                        _pMocket->getTransmitter()->processTimestampChunk (pRecvPacket->getTimestampChunk());
+                        break;
+                    case Packet::CT_TimestampAck:
+                        //printf ("Receiver::run Received timestampAck chunk\n");
+                        _pMocket->getTransmitter()->processTimestampAckChunk (pRecvPacket->getTimestampAckChunk());
+                        break;
+                    case Packet::CT_FECRepair:
+                        _pPacketProcessor->processFECRepairChunk (pRecvPacket->getFECRepairChunk());
+                        break;
+                    case Packet::CT_FECFeedback:
+                        _pMocket->getTransmitter()->processFECFeedbackChunk (pRecvPacket->getFECFeedbackChunk());
                         break;
-                    }
-                }
 
-                // Check the window size to see if there is room to accept this packet
-                /*if (getWindowSize() < pRecvPacket->getPacketSizeWithoutPiggybackChunks()) {
-                    checkAndLogMsg ("Receiver::run", Logger::L_LowDetailDebug,
-                                    "discarding packet with sequence number %lu because of insufficient room; there are %lu %lu %lu packets in the control, reliable sequenced, and unreliable sequenced queue\n",
-                                    pRecvPacket->getSequenceNum(), _ctrlPacketQueue.getPacketCount(), _reliableSequencedPacketQueue.getPacketCount(), _unreliableSequencedPacketQueue.getPacketCount());
-                    delete pRecvPacket;
-                    pRecvPacket = nullptr;
-                    // Update the discarded packet count statistic
-                    _pMocket->getStatistics()->_ui32NoRoomDiscardedPackets++;
+                    // Suspend/Resume process messages
+                    case Packet::CT_SimpleSuspend:
+                        //printf ("Receiver::run Received simpleSuspend packet\n");
+                        // Check for simultaneous suspension.
+                        // Continue to wait suspend_ack or go in SUSPEND_RECEIVED state
+                        _pMocket->getTransmitter()->processSimpleSuspendPacket(pRecvPacket->getSimpleSuspendChunk());
+                        break;
+                    case Packet::CT_SimpleSuspendAck:
+                        //printf ("Receiver::run Received simpleSuspendAck packet\n");
+                        // Extract, decrypt and save nonce (UUID) and Ks
+                        _pMocket->getTransmitter()->processSimpleSuspendAckPacket(pRecvPacket->getSimpleSuspendAckChunk());
+                        break;
+                    case Packet::CT_Suspend:
+                        //printf ("Receiver::run Received suspend packet\n");
+                        // Check for simultaneous suspension.
+                        // Continue to wait suspend_ack or go in SUSPEND_RECEIVED state
+                        _pMocket->getTransmitter()->processSuspendPacket(pRecvPacket->getSuspendChunk());
+                        break;
+                    case Packet::CT_SuspendAck:
+                        //printf ("Receiver::run Received suspendAck packet\n");
+                        // Extract, decrypt and save nonce (UUID) and Ks
+                        _pMocket->getTransmitter()->processSuspendAckPacket(pRecvPacket->getSuspendAckChunk());
+                        break;
+                    case Packet::CT_Resume:
+                        //printf ("Receiver::run Received resume packet\n");
+                        // Extract, decrypt and check the nonce
+                        _pMocket->getTransmitter()->processResumePacket(pRecvPacket->getResumeChunk(), pRemoteAddr->getIPAddress(), pRemoteAddr->getPort());
+                        break;
+                    case Packet::CT_ReEstablish:
+                        //printf ("Receiver::run Received reEstablish packet\n");
+                        // Extract, decrypt and check the nonce
+                        _pMocket->getTransmitter()->processReEstablishPacket(pRecvPacket->getReEstablishChunk(), pRemoteAddr->getIPAddress(), pRemoteAddr->getPort());
+                        break;
+                };
+                if (!pRecvPacket->advanceToNextChunk()) {
+                    break;
                 }
-                else {*/
-                    // Update the received packet count statistic
-                    _pMocket->getStatistics()->_ui32ReceivedPackets++;
-
-                    // Duplicate the buffer in the packet (and remove piggyback chunks if present)
-                    pRecvPacket->prepareForProcessing();
+            }
 
-                    incrementQueuedDataSize (pRecvPacket->getPacketSize());   // No need to use getPacketSizeWithoutPiggybackChunks() anymore because of the call to prepareForProcessing() above
+            // Check the window size to see if there is room to accept this packet
+            /*if (getWindowSize() < pRecvPacket->getPacketSizeWithoutPiggybackChunks()) {
+                checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_LowDetailDebug,
+                                "discarding packet with sequence number %lu because of insufficient room; there are %lu %lu %lu packets in the control, reliable sequenced, and unreliable sequenced queue\n",
+                                pRecvPacket->getSequenceNum(), _ctrlPacketQueue.getPacketCount(), _reliableSequencedPacketQueue.getPacketCount(), _unreliableSequencedPacketQueue.getPacketCount());
+                delete pRecvPacket;
+                pRecvPacket = nullptr;
+                // Update the discarded packet count statistic
+                _pMocket->getStatistics()->_ui32NoRoomDiscardedPackets++;
+            }
+            else {*/
+                // Update the received packet count statistic
+                _pMocket->getStatistics()->_ui32ReceivedPackets++;
+
+                // Duplicate the buffer in the packet (and remove piggyback chunks if present)
+                // If the buffer came from the PacketPool, the packet keeps it instead
+                pRecvPacket->prepareForProcessing();
+                if (pbBufAdopted != nullptr) {
+                    *pbBufAdopted = true;
+                }
 
-                    // Enqueue the packet if necessary
-                    if (pRecvPacket->isControlPacket()) {
-                        uint32 ui32SequenceNum = pRecvPacket->getSequenceNum();
-                        PacketWrapper *pWrapper = new PacketWrapper (pRecvPacket, _i64LastRecvTime);
-                        if (_ctrlPacketQueue.insert (pWrapper)) {
-                            checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                            "enqueued control packet with sequence number %lu into control packet queue\n", ui32SequenceNum);
-                            _pMocket->getACKManager()->receivedControlPacket (pRecvPacket->getSequenceNum());
-                            _pPacketProcessor->packetArrived();
-                        }
-                        else {
-                            decrementQueuedDataSize (pRecvPacket->getPacketSize());
-                            delete pWrapper;
-                            delete pRecvPacket;
-                            pRecvPacket = nullptr;
-                            _pMocket->getStatistics()->_ui32DuplicatedDiscardedPackets++;
-                            _pMocket->getTransmitter()->requestSAckTransmission();
-                            checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                            "dropped control packet with sequence number %lu\n", ui32SequenceNum);
-                        }
+                incrementQueuedDataSize (pRecvPacket->getPacketSize());   // No need to use getPacketSizeWithoutPiggybackChunks() anymore because of the call to prepareForProcessing() above
+
+                // Enqueue the packet if necessary
+                if (pRecvPacket->isControlPacket()) {
+                    uint32 ui32SequenceNum = pRecvPacket->getSequenceNum();
+                    PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pRecvPacket, _i64LastRecvTime);
+                    if (_ctrlPacketQueue.insert (pWrapper)) {
+                        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                        "enqueued control packet with sequence number %lu into control packet queue\n", ui32SequenceNum);
+                        _pMocket->getACKManager()->receivedControlPacket (pRecvPacket->getSequenceNum());
+                        _pPacketProcessor->packetArrived();
+                    }
+                    else {
+                        decrementQueuedDataSize (pRecvPacket->getPacketSize());
+                        delete pWrapper;
+                        delete pRecvPacket;
+                        pRecvPacket = nullptr;
+                        _pMocket->getStatistics()->_ui32DuplicatedDiscardedPackets++;
+                        _pMocket->getTransmitter()->requestSAckTransmission();
+                        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                        "dropped control packet with sequence number %lu\n", ui32SequenceNum);
+                    }
+                }
+                else if ((pRecvPacket->isReliablePacket()) && (pRecvPacket->isSequencedPacket())) {
+                    // This is a reliable sequenced packet
+                    uint32 ui32SequenceNum = pRecvPacket->getSequenceNum();
+                    PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pRecvPacket, _i64LastRecvTime);
+                    if (_reliableSequencedPacketQueue.insert (pWrapper)) {
+                        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                        "enqueued reliable sequenced packet with sequence number %lu into reliable sequenced packet queue\n", ui32SequenceNum);
+                        _pMocket->getACKManager()->receivedReliableSequencedPacket (ui32SequenceNum);
+                        _pPacketProcessor->packetArrived();
+                    }
+                    else {
+                        decrementQueuedDataSize (pRecvPacket->getPacketSize());
+                        delete pWrapper;
+                        delete pRecvPacket;
+                        pRecvPacket = nullptr;
+                        _pMocket->getStatistics()->_ui32DuplicatedDiscardedPackets++;
+                        _pMocket->getTransmitter()->requestSAckTransmission();
+                        checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                        "dropped reliable sequenced packet with sequence number %lu\n", ui32SequenceNum);
                     }
-                    else if ((pRecvPacket->isReliablePacket()) && (pRecvPacket->isSequencedPacket())) {
-                        // This is a reliable sequenced packet
+                }
+                else if (pRecvPacket->isReliablePacket()) {
+                    // This is a reliable unsequenced packet
+                    uint32 ui32SequenceNum = pRecvPacket->getSequenceNum();
+                    _pMocket->getACKManager()->receivedReliableUnsequencedPacket (pRecvPacket->getSequenceNum());
+                    _pPacketProcessor->processReliableUnsequencedPacket (pRecvPacket);
+                    checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                    "passed reliable unsequenced packet with sequence number %lu to the packet processor\n", ui32SequenceNum);
+                }
+                else if ((pRecvPacket->isSequencedPacket()) && (_pPacketProcessor->isFECActive())) {
+                    // This is an unreliable sequenced packet protected by FEC - it must be buffered
+                    // so that the packets rebuilt from the repair packets can be delivered in order
+                    _pPacketProcessor->processFECProtectedPacket (pRecvPacket, _i64LastRecvTime);
+                }
+                else if (pRecvPacket->isSequencedPacket()) {
+                    // This is an unreliable sequenced packet
+                    #if defined (USE_BUFFERING_FOR_UNRELIABLE_SEQUENCED)
                         uint32 ui32SequenceNum = pRecvPacket->getSequenceNum();
-                        PacketWrapper *pWrapper = new PacketWrapper (pRecvPacket, _i64LastRecvTime);
-                        if (_reliableSequencedPacketQueue.insert (pWrapper)) {
-                            checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                            "enqueued reliable sequenced packet with sequence number %lu into reliable sequenced packet queue\n", ui32SequenceNum);
-                            _pMocket->getACKManager()->receivedReliableSequencedPacket (ui32SequenceNum);
-                            _pPacketProcessor->packetArrived();
+                        PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pRecvPacket, _i64LastRecvTime);
+                        if (_unreliableSequencedPacketQueue.insert (pWrapper)) {
+                            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                            "enqueuing packet with sequence number %lu into unreliable sequenced packet queue\n", ui32SequenceNum);
+                                                    _pPacketProcessor->packetArrived();
                         }
                         else {
+                            // Should not have received a duplicate packet as the sender does not retransmit packets for unreliable flows
+                            checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_Warning,
+                                            "received a duplicate unreliable sequenced packet with sequence number %lu\n", ui32SequenceNum);
                             decrementQueuedDataSize (pRecvPacket->getPacketSize());
                             delete pWrapper;
                             delete pRecvPacket;
                             pRecvPacket = nullptr;
                             _pMocket->getStatistics()->_ui32DuplicatedDiscardedPackets++;
-                            _pMocket->getTransmitter()->requestSAckTransmission();
-                            checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                            "dropped reliable sequenced packet with sequence number %lu\n", ui32SequenceNum);
                         }
-                    }
-                    else if (pRecvPacket->isReliablePacket()) {
-                        // This is a reliable unsequenced packet
-                        uint32 ui32SequenceNum = pRecvPacket->getSequenceNum();
-                        _pMocket->getACKManager()->receivedReliableUnsequencedPacket (pRecvPacket->getSequenceNum());
-                        _pPacketProcessor->processReliableUnsequencedPacket (pRecvPacket);
-                        checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                        "passed reliable unsequenced packet with sequence number %lu to the packet processor\n", ui32SequenceNum);
-                    }
-                    else if (pRecvPacket->isSequencedPacket()) {
-                        // This is an unreliable sequenced packet
-                        #if defined (USE_BUFFERING_FOR_UNRELIABLE_SEQUENCED)
-                            uint32 ui32SequenceNum = pRecvPacket->getSequenceNum();
-                            PacketWrapper *pWrapper = new PacketWrapper (pRecvPacket, _i64LastRecvTime);
-                            if (_unreliableSequencedPacketQueue.insert (pWrapper)) {
-                                checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                                "enqueuing packet with sequence number %lu into unreliable sequenced packet queue\n", ui32SequenceNum);
-                                                        _pPacketProcessor->packetArrived();
-                            }
-                            else {
-                                // Should not have received a duplicate packet as the sender does not retransmit packets for unreliable flows
-                                checkAndLogMsg ("Receiver::run", Logger::L_Warning,
-                                                "received a duplicate unreliable sequenced packet with sequence number %lu\n", ui32SequenceNum);
-                                decrementQueuedDataSize (pRecvPacket->getPacketSize());
-                                delete pWrapper;
-                                delete pRecvPacket;
-                                pRecvPacket = nullptr;
-                                _pMocket->getStatistics()->_ui32DuplicatedDiscardedPackets++;
-                            }
-                        #else
-                            _pPacketProcessor->processUnreliableSequencedPacketWithoutBuffering (pRecvPacket);
-                        #endif
-                    }
-                    else {
-                        // This is an unreliable unsequenced packet
-                        // NOTE: Could just be something like a heartbeat packet also!
-                        _pPacketProcessor->processUnreliableUnsequencedPacket (pRecvPacket);
-                        checkAndLogMsg ("Receiver::run", Logger::L_MediumDetailDebug,
-                                        "passed unreliable unsequenced packet to the packet processor\n");
-                    }
-                //} // This is part of the if/else that checks the window size which is now commented out
-            }
-        }
-
-        const auto smCurrentState = _pMocket->getStateMachine()->getCurrentState();
-        if ((smCurrentState == StateMachine::S_CLOSED) || (smCurrentState == StateMachine::S_APPLICATION_ABORT) ||
-            (smCurrentState == StateMachine::S_SUSPENDED)) {
-            bDone = true;
+                    #else
+                        _pPacketProcessor->processUnreliableSequencedPacketWithoutBuffering (pRecvPacket);
+                    #endif
+                }
+                else {
+                    // This is an unreliable unsequenced packet
+                    // NOTE: Could just be something like a heartbeat packet also!
+                    _pPacketProcessor->processUnreliableUnsequencedPacket (pRecvPacket);
+                    checkAndLogMsg ("Receiver::processReceivedDatagram", Logger::L_MediumDetailDebug,
+                                    "passed unreliable unsequenced packet to the packet processor\n");
+                }
+            //} // This is part of the if/else that checks the window size which is now commented out
         }
     }
-
-    free (pRecBuf);
-    _pMocket->receiverTerminating();
+    return 0;
 }
 
 // Process a Cancelled Chunk, which contains sequence numbers of packets that have been
@@ -595,7 +652,7 @@ int Receiver::processCancelledChunk (CancelledChunkAccessor cancelledChunkAccess
                     for (uint32 ui32TSN = cancelledChunkAccessor.getStartTSN(); ui32TSN <= cancelledChunkAccessor.getEndTSN(); ui32TSN++) {
                         _reliableSequencedPacketQueue.lock();
                         if (_reliableSequencedPacketQueue.canInsert (ui32TSN)) {
-                            PacketWrapper *pWrapper = new PacketWrapper (ui32TSN, i64CurrTime);
+                            PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (ui32TSN, i64CurrTime);
                             if (!_reliableSequencedPacketQueue.insert (pWrapper)) {
                                 checkAndLogMsg ("Receiver::processCancelledChunk", Logger::L_Warning,
                                                 "failed to insert cancelled packet for sequence number %lu into reliable sequenced packet queue\n",
@@ -616,7 +673,7 @@ int Receiver::processCancelledChunk (CancelledChunkAccessor cancelledChunkAccess
                     //printf ("Received cancelled chunck msg. TSN: %d\n", ui32CancelledTSN);
                     _reliableSequencedPacketQueue.lock();
                     if (_reliableSequencedPacketQueue.canInsert (ui32CancelledTSN)) {
-                        PacketWrapper *pWrapper = new PacketWrapper (ui32CancelledTSN, i64CurrTime);
+                        PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (ui32CancelledTSN, i64CurrTime);
                         if (!_reliableSequencedPacketQueue.insert (pWrapper)) {
                             checkAndLogMsg ("Receiver::processCancelledChunk", Logger::L_Warning,
                                             "failed to insert cancelled packet for sequence number %lu into reliable sequenced packet queue\n",
@@ -644,7 +701,7 @@ int Receiver::processCancelledChunk (CancelledChunkAccessor cancelledChunkAccess
                     _unreliableSequencedPacketQueue.lock();
                     for (uint32 ui32TSN = cancelledChunkAccessor.getStartTSN(); ui32TSN <= cancelledChunkAccessor.getEndTSN(); ui32TSN++) {
                         if (_unreliableSequencedPacketQueue.canInsert (ui32TSN)) {
-                            PacketWrapper *pWrapper = new PacketWrapper (ui32TSN, i64CurrTime);
+                            PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (ui32TSN, i64CurrTime);
                             if (!_unreliableSequencedPacketQueue.insert (pWrapper)) {
                                 checkAndLogMsg ("Receiver::processCancelledChunk", Logger::L_Warning,
                                                 "failed to insert cancelled packet for sequence number %lu into unreliable sequenced packet queue\n",
@@ -660,7 +717,7 @@ int Receiver::processCancelledChunk (CancelledChunkAccessor cancelledChunkAccess
                     uint32 ui32CancelledTSN = cancelledChunkAccessor.getTSN();
                     _unreliableSequencedPacketQueue.lock();
                     if (_unreliableSequencedPacketQueue.canInsert (ui32CancelledTSN)) {
-                        PacketWrapper *pWrapper = new PacketWrapper (ui32CancelledTSN, i64CurrTime);
+                        PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (ui32CancelledTSN, i64CurrTime);
                         if (!_unreliableSequencedPacketQueue.insert (pWrapper)) {
                             checkAndLogMsg ("Receiver::processCancelledChunk", Logger::L_Warning,
                                             "failed to insert cancelled packet for sequence number %lu into unreliable sequenced packet queue\n",
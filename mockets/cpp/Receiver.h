@@ -34,6 +34,7 @@ class Transmitter;
 
 namespace NOMADSUtil
 {
+    class InetAddr;
     class UDPDatagramSocket;
 }
 
@@ -51,6 +52,18 @@ class Receiver : public NOMADSUtil::Thread
 
         void run (void);
 
+        // Processes a datagram that was read from the CommInterface (rc is the value returned by receive())
+        // Invoked by run() or, when the mocket shares the socket of a ServerMocket, by the MocketMultiplexer
+        // Returns 0 if a valid packet was processed, -1 in case of a receive error or an invalid packet,
+        // and -2 if the application aborted the connection
+        // If pbBufAdopted is not nullptr, pRecBuf must have been allocated from the PacketPool of the mocket and the
+        //     packet may keep it instead of making a copy; *pbBufAdopted is set to true if that happened, in which case
+        //     the caller must not reuse or release pRecBuf
+        int processReceivedDatagram (char *pRecBuf, int rc, NOMADSUtil::InetAddr *pRemoteAddr, bool *pbBufAdopted = nullptr);
+
+        // Returns true if the state of the mocket is such that no more packets should be received
+        bool isTerminated (void);
+
         // Used when estimating the bandwidth receiver side
         int64 getLastRecTime (void);
         uint32 getBytesReceived (void);
@@ -81,6 +94,8 @@ class Receiver : public NOMADSUtil::Thread
         char * _pszRemoteAddress;
         int64 _i64LastRecvTime;
         int64 _i64LastSentPacketTime;
+        int64 _i64LastAppCallbackTime;
+        bool _bCloseConn;
 
         // Used when estimating the bandwidth receiver side
         uint32 _ui32BytesReceived;
@@ -94,6 +109,9 @@ class Receiver : public NOMADSUtil::Thread
         FILE *_filePacketRecvLog;
         int64 _i64LogStartTime;
         int64 _i64LastRecvLogTime;
+
+        // Maximum number of datagrams read with one call to receiveBatch()
+        static const uint16 RECEIVE_BATCH_SIZE = 32;
 };
 
 inline void Receiver::resetRemoteAddress (uint32 ui32NewRemoteAddress, uint16 ui16NewRemotePort)
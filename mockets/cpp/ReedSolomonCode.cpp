@@ -0,0 +1,141 @@
+/*
+ * ReedSolomonCode.cpp
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "ReedSolomonCode.h"
+
+
+namespace
+{
+    // Log and exp tables for GF(2^8) with the primitive polynomial x^8 + x^4 + x^3 + x^2 + 1
+    // The exp table is doubled so that the sum of two logarithms can be used as an index without a modulo
+    struct GaloisFieldTables
+    {
+        GaloisFieldTables (void)
+        {
+            uint16 ui16Value = 1;
+            for (uint16 ui16 = 0; ui16 < 255; ui16++) {
+                aui8Exp[ui16] = (uint8) ui16Value;
+                aui8Exp[ui16 + 255] = (uint8) ui16Value;
+                aui16Log[ui16Value] = ui16;
+                ui16Value <<= 1;
+                if (ui16Value & 0x100) {
+                    ui16Value ^= 0x11D;
+                }
+            }
+            aui8Exp[510] = aui8Exp[0];
+            aui8Exp[511] = aui8Exp[1];
+            aui16Log[0] = 0;    // Never used - zero has no logarithm
+        }
+
+        uint8 aui8Exp[512];
+        uint16 aui16Log[256];
+    };
+
+    const GaloisFieldTables gfTables;
+}
+
+uint8 ReedSolomonCode::getCoefficient (uint8 ui8RepairIndex, uint8 ui8SourceIndex)
+{
+    // x(j) + y(i) is never zero because x(j) >= 128 and y(i) < 128
+    return inverse ((uint8) ((MAX_SOURCE_SYMBOLS + ui8RepairIndex) ^ ui8SourceIndex));
+}
+
+uint8 ReedSolomonCode::multiply (uint8 ui8A, uint8 ui8B)
+{
+    if ((ui8A == 0) || (ui8B == 0)) {
+        return 0;
+    }
+    return gfTables.aui8Exp[gfTables.aui16Log[ui8A] + gfTables.aui16Log[ui8B]];
+}
+
+uint8 ReedSolomonCode::inverse (uint8 ui8A)
+{
+    if (ui8A == 0) {
+        return 0;
+    }
+    return gfTables.aui8Exp[255 - gfTables.aui16Log[ui8A]];
+}
+
+void ReedSolomonCode::multiplyAndAdd (uint8 *pDest, const uint8 *pSrc, uint32 ui32Len, uint8 ui8Coefficient)
+{
+    if (ui8Coefficient == 0) {
+        return;
+    }
+    if (ui8Coefficient == 1) {
+        for (uint32 ui32 = 0; ui32 < ui32Len; ui32++) {
+            pDest[ui32] ^= pSrc[ui32];
+        }
+        return;
+    }
+    // Build the multiplication row for the coefficient, so that each byte only needs one lookup
+    uint8 aui8Row[256];
+    uint16 ui16LogCoefficient = gfTables.aui16Log[ui8Coefficient];
+    aui8Row[0] = 0;
+    for (uint16 ui16 = 1; ui16 < 256; ui16++) {
+        aui8Row[ui16] = gfTables.aui8Exp[ui16LogCoefficient + gfTables.aui16Log[ui16]];
+    }
+    for (uint32 ui32 = 0; ui32 < ui32Len; ui32++) {
+        pDest[ui32] ^= aui8Row[pSrc[ui32]];
+    }
+}
+
+int ReedSolomonCode::solve (uint8 *pMatrix, uint8 **ppRows, uint8 ui8Size, uint32 ui32Len)
+{
+    // Gauss-Jordan elimination, applying the same row operations to the buffers
+    for (uint8 ui8Col = 0; ui8Col < ui8Size; ui8Col++) {
+        uint8 ui8Pivot = ui8Col;
+        while ((ui8Pivot < ui8Size) && (pMatrix[ui8Pivot * ui8Size + ui8Col] == 0)) {
+            ui8Pivot++;
+        }
+        if (ui8Pivot == ui8Size) {
+            return -1;
+        }
+        if (ui8Pivot != ui8Col) {
+            for (uint8 ui8 = 0; ui8 < ui8Size; ui8++) {
+                uint8 ui8Tmp = pMatrix[ui8Pivot * ui8Size + ui8];
+                pMatrix[ui8Pivot * ui8Size + ui8] = pMatrix[ui8Col * ui8Size + ui8];
+                pMatrix[ui8Col * ui8Size + ui8] = ui8Tmp;
+            }
+            uint8 *pTmp = ppRows[ui8Pivot];
+            ppRows[ui8Pivot] = ppRows[ui8Col];
+            ppRows[ui8Col] = pTmp;
+        }
+        uint8 ui8Inverse = inverse (pMatrix[ui8Col * ui8Size + ui8Col]);
+        if (ui8Inverse != 1) {
+            for (uint8 ui8 = 0; ui8 < ui8Size; ui8++) {
+                pMatrix[ui8Col * ui8Size + ui8] = multiply (pMatrix[ui8Col * ui8Size + ui8], ui8Inverse);
+            }
+            uint8 *pRow = ppRows[ui8Col];
+            for (uint32 ui32 = 0; ui32 < ui32Len; ui32++) {
+                pRow[ui32] = multiply (pRow[ui32], ui8Inverse);
+            }
+        }
+        for (uint8 ui8Row = 0; ui8Row < ui8Size; ui8Row++) {
+            uint8 ui8Factor = pMatrix[ui8Row * ui8Size + ui8Col];
+            if ((ui8Row == ui8Col) || (ui8Factor == 0)) {
+                continue;
+            }
+            for (uint8 ui8 = 0; ui8 < ui8Size; ui8++) {
+                pMatrix[ui8Row * ui8Size + ui8] ^= multiply (pMatrix[ui8Col * ui8Size + ui8], ui8Factor);
+            }
+            multiplyAndAdd (ppRows[ui8Row], ppRows[ui8Col], ui32Len, ui8Factor);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef INCL_REED_SOLOMON_CODE_H
+#define INCL_REED_SOLOMON_CODE_H
+
+/*
+ * ReedSolomonCode.h
+ *
+ * This file is part of the IHMC Mockets Library/Component
+ * Copyright (c) 2002-2014 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * ReedSolomonCode
+ *
+ * Systematic Cauchy Reed-Solomon erasure code over GF(2^8), used for the forward
+ * error correction of unreliable sequenced packets.
+ * Repair symbol j of a block is the sum of the source symbols S(i), each one
+ * multiplied by the coefficient 1 / (x(j) + y(i)), where x(j) = 128 + j and y(i) = i.
+ * Since the coefficients do not depend on the number of source symbols in the block,
+ * the repair symbols can be computed incrementally as the source symbols become
+ * available, and any combination of K symbols out of a block of K source symbols
+ * and up to MAX_REPAIR_SYMBOLS repair symbols is enough to recover the block.
+ */
+
+#include "FTypes.h"
+
+class ReedSolomonCode
+{
+    public:
+        static const uint8 MAX_SOURCE_SYMBOLS = 128;
+        static const uint8 MAX_REPAIR_SYMBOLS = 128;
+
+        // Returns the coefficient of source symbol ui8SourceIndex in repair symbol ui8RepairIndex
+        static uint8 getCoefficient (uint8 ui8RepairIndex, uint8 ui8SourceIndex);
+
+        static uint8 multiply (uint8 ui8A, uint8 ui8B);
+        static uint8 inverse (uint8 ui8A);
+
+        // Adds ui8Coefficient * pSrc to pDest
+        static void multiplyAndAdd (uint8 *pDest, const uint8 *pSrc, uint32 ui32Len, uint8 ui8Coefficient);
+
+        // Solves the ui8Size x ui8Size linear system pMatrix * X = B, where each row of B is a buffer of ui32Len bytes
+        // The buffers in ppRows contain B when the method is invoked and X when it returns; pMatrix is modified
+        // pMatrix is stored by rows
+        // Returns 0 if successful or a negative value if the matrix is singular
+        static int solve (uint8 *pMatrix, uint8 **ppRows, uint8 ui8Size, uint32 ui32Len);
+};
+
+#endif   // #ifndef INCL_REED_SOLOMON_CODE_H
@@ -20,6 +20,8 @@
 #include "ServerMocket.h"
 
 #include "Mocket.h"
+#include "MocketMultiplexer.h"
+#include "MultiplexedCommInterface.h"
 #include "UDPCommInterface.h"
 #include "DTLSCommInterface.h"
 #include "UDPDatagramSocket.h"
@@ -46,6 +48,10 @@ ServerMocket::ServerMocket(
     _ui16Port = 0;
     _ui32ListenAddr = 0;
     _bEnableDtls = enableDtls;
+    _bSharedSocket = false;
+    _ui16NumIOWorkers = MocketMultiplexer::DEFAULT_NUM_IO_WORKERS;
+    _ui16NumProcessingWorkers = MocketMultiplexer::DEFAULT_NUM_PROCESSING_WORKERS;
+    _pMultiplexer = nullptr;
 
     if (pCI == nullptr) {
         _pCommInterface = nullptr;
@@ -71,6 +77,13 @@ ServerMocket::~ServerMocket (void)
         _cvInAccept.wait();
     }
     _mInAccept.unlock();
+    if (_pMultiplexer) {
+        _pMultiplexer->waitForMocketsToClose();
+        _pMultiplexer->stop();
+        delete _pMultiplexer;
+        _pMultiplexer = nullptr;
+        _pCommInterface->close();
+    }
     if (_bDeleteCIWhenDone) {
         delete _pCommInterface;
     }
@@ -113,6 +126,9 @@ int ServerMocket::listen (uint16 ui16Port)
         ui16Port = _pCommInterface->getLocalPort();
     }
     _ui16Port = ui16Port;
+    if (0 != startMultiplexer()) {
+        return -3;
+    }
     return ui16Port;
 }
 
@@ -172,10 +188,52 @@ int ServerMocket::listen (uint16 ui16Port, const char *pszListenAddr)
             ui16Port = _pCommInterface->getLocalPort();
         }
         _ui16Port = ui16Port;
+        if (0 != startMultiplexer()) {
+            return -3;
+        }
         return ui16Port;
     }
 }
 
+int ServerMocket::enableSharedSocket (uint16 ui16NumIOWorkers, uint16 ui16NumProcessingWorkers)
+{
+    if (_bEnableDtls) {
+        checkAndLogMsg ("ServerMocket::enableSharedSocket", Logger::L_MildError,
+                        "shared socket mode is not supported with DTLS\n");
+        return -1;
+    }
+    if (_bAccepting) {
+        checkAndLogMsg ("ServerMocket::enableSharedSocket", Logger::L_MildError,
+                        "shared socket mode must be enabled before calling listen()\n");
+        return -2;
+    }
+    if ((ui16NumIOWorkers == 0) || (ui16NumProcessingWorkers == 0)) {
+        return -3;
+    }
+    _bSharedSocket = true;
+    _ui16NumIOWorkers = ui16NumIOWorkers;
+    _ui16NumProcessingWorkers = ui16NumProcessingWorkers;
+    return 0;
+}
+
+int ServerMocket::startMultiplexer (void)
+{
+    if (!_bSharedSocket) {
+        return 0;
+    }
+    _pMultiplexer = new MocketMultiplexer (_pCommInterface, _ui16NumIOWorkers, _ui16NumProcessingWorkers);
+    int rc;
+    if (0 != (rc = _pMultiplexer->start())) {
+        checkAndLogMsg ("ServerMocket::startMultiplexer", Logger::L_MildError,
+                        "failed to start the multiplexer; rc = %d\n", rc);
+        delete _pMultiplexer;
+        _pMultiplexer = nullptr;
+        _bAccepting = false;
+        return -1;
+    }
+    return 0;
+}
+
 Mocket *ServerMocket::accept (uint16 ui16PortForNewConnection)
 {
     const char * const pszMethodName = "ServerMocket::accept";
@@ -193,12 +251,19 @@ Mocket *ServerMocket::accept (uint16 ui16PortForNewConnection)
         return nullptr;
     }
 
+    if ((_pMultiplexer) && (ui16PortForNewConnection != 0)) {
+        checkAndLogMsg (pszMethodName, Logger::L_MildError, "cannot specify a local port when using a shared socket\n");
+        return nullptr;
+    }
+
     #if defined (LINUX)
         // Linux seems to have different behavior than Solaris or MacOSX - when a thread is blocked
         // in a receive on a socket, closing the socket from a different thread does not unblock
         // the original thread
         // Hence - set a timeout which basically makes the accept() poll for one second intervals
-        _pCommInterface->setReceiveTimeout (1000);
+        if (_pMultiplexer == nullptr) {
+            _pCommInterface->setReceiveTimeout (1000);
+        }
     #endif
 
     while (true) {
@@ -231,7 +296,13 @@ Mocket *ServerMocket::accept (uint16 ui16PortForNewConnection)
             }
         }
 
-        rc = _pCommInterface->receive (buf, Mocket::MAXIMUM_MTU, &remoteAddr);
+        if (_pMultiplexer) {
+            // The socket is read by the multiplexer, which queues the connection packets for accept()
+            rc = _pMultiplexer->receiveConnectionPacket (buf, Mocket::MAXIMUM_MTU, &remoteAddr, 1000);
+        }
+        else {
+            rc = _pCommInterface->receive (buf, Mocket::MAXIMUM_MTU, &remoteAddr);
+        }
         if (rc < 0) {
             checkAndLogMsg (pszMethodName, Logger::L_MildError, "failed to receive a packet; rc = %d; OS error = %d\n",  rc, _pCommInterface->getLastError());
             // Originally, this was returning nullptr since the assumption was that this
@@ -286,6 +357,11 @@ int ServerMocket::close (void)
     if (_pCommInterface == nullptr) {
         return -1;
     }
+    if (_pMultiplexer) {
+        // The socket is still being used by the accepted mockets - it is closed by the destructor
+        _pMultiplexer->setAcceptingConnections (false);
+        return 0;
+    }
     return _pCommInterface->close();
 }
 
@@ -349,7 +425,13 @@ Mocket * ServerMocket::processIncomingPacket (Packet *pPacket, InetAddr *pRemote
             CookieRec *pCookieRec = getCookieRec (*pRemoteAddr);
             if (pCookieRec->ui16Count == 0) {
                 // This is the first CookieEcho - create a local endpoint
-                if (_bLocallyCreatedCI) {
+                if (_pMultiplexer) {
+                    // Shared socket mode - the new mocket uses the listen socket
+                    pCookieRec->ui16LocalPort = _ui16Port;
+                    pMocket = new Mocket (cookie, pRemoteAddr, _configFile, new MultiplexedCommInterface (_pMultiplexer), true);
+                    pMocket->setMultiplexer (_pMultiplexer);
+                }
+                else if (_bLocallyCreatedCI) {
                     if (_bEnableDtls) {
                         // We are not using a CommInterface that was passed into ServerMocket, so create a new one for this connection
                         UDPDatagramSocket *pDGSocket = new UDPDatagramSocket();
@@ -588,7 +670,13 @@ Mocket * ServerMocket::processIncomingPacket (Packet *pPacket, InetAddr *pRemote
             Mocket *pMocket = nullptr;
             uint16 ui16LocalPort = 0;
             // Create a local endpoint
-            if (_bLocallyCreatedCI) {
+            if (_pMultiplexer) {
+                // Shared socket mode - the new mocket uses the listen socket
+                ui16LocalPort = _ui16Port;
+                pMocket = new Mocket (cookie, pRemoteAddr, _configFile, new MultiplexedCommInterface (_pMultiplexer), true);
+                pMocket->setMultiplexer (_pMultiplexer);
+            }
+            else if (_bLocallyCreatedCI) {
                 // We are not using a CommInterface that was passed into ServerMocket, so create a new one for this connection
                 UDPDatagramSocket *pDGSocket = new UDPDatagramSocket();
                 if (_ui32ListenAddr != 0) {
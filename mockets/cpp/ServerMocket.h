@@ -30,6 +30,7 @@
 #include "DArray.h"
 #include "FTypes.h"
 #include "InetAddr.h"
+#include "MocketMultiplexer.h"
 #include "Mutex.h"
 #include "StrClass.h"
 
@@ -55,6 +56,14 @@ class ServerMocket
 
         int listen (uint16 ui16Port, const char *pszListenAddr);
 
+        // Enables the shared socket mode, in which all the accepted mockets use the listen socket
+        // A fixed pool of I/O and processing threads serves all the accepted mockets, instead of
+        // one Receiver and one PacketProcessor thread per mocket
+        // Must be invoked before listen(); not supported with DTLS
+        // When this mode is enabled, the destructor waits for all the accepted mockets to close
+        int enableSharedSocket (uint16 ui16NumIOWorkers = MocketMultiplexer::DEFAULT_NUM_IO_WORKERS,
+                                uint16 ui16NumProcessingWorkers = MocketMultiplexer::DEFAULT_NUM_PROCESSING_WORKERS);
+
         Mocket *accept (uint16 ui16PortForNewConnection = 0);
 
         int close (void);
@@ -79,6 +88,7 @@ class ServerMocket
         };
 
     private:
+        int startMultiplexer (void);
         Mocket * processIncomingPacket (Packet *pPacket, NOMADSUtil::InetAddr *pRemoteAddr, uint16 ui16PortForNewConnection);
         int clearCookieRec (NOMADSUtil::InetAddr remoteAddr);
         CookieRec * getCookieRec (NOMADSUtil::InetAddr remoteAddr);
@@ -97,6 +107,10 @@ class ServerMocket
         bool _bInAccept;
         bool _bEnableDtls;
         NOMADSUtil::DArray<CookieRec> _cookieHistory;
+        bool _bSharedSocket;
+        uint16 _ui16NumIOWorkers;
+        uint16 _ui16NumProcessingWorkers;
+        MocketMultiplexer *_pMultiplexer;
 
         char *_cpPathToCertificate;
         char* _cpPathToPrivateKey;
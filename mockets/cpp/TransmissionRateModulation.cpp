@@ -41,6 +41,10 @@ TransmissionRateModulation::TransmissionRateModulation (Mocket *pMocket)
     checkAndLogMsg ("TransmissionRateModulation::TransmissionRateModulation", Logger::L_MediumDetailDebug, "created a new instance of TransmissionRateModulation\n");
 }
 
+TransmissionRateModulation::~TransmissionRateModulation (void)
+{
+}
+
 void TransmissionRateModulation::update (void)
 {
     // We increase the bandwidth limit every time the bandwidth estimation reaches
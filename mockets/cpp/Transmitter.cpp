@@ -20,8 +20,10 @@
 #include "Transmitter.h"
 
 #include "CommInterface.h"
+#include "FECEncoder.h"
 #include "Mocket.h"
 #include "MocketStatusNotifier.h"
+#include "PacketProcessor.h"
 #include "Receiver.h"
 
 #include "Logger.h"
@@ -29,6 +31,9 @@
 #include "DLList.h"
 #include "NLFLib.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #if !defined (ANDROID) //No std support on ANDROID
     #include <cmath>
     #include <iostream>
@@ -91,6 +96,10 @@ Transmitter::Transmitter (Mocket *pMocket, bool bEnableXMitLogging)
     _pFastRetransmitReliableSequencedPackets = nullptr;
     _pFastRetransmitReliableUnsequencedPackets = nullptr;
 
+    _upqControlPackets.setDeliveryRateEstimator (&_deliveryRateEstimator);
+    _upqReliableSequencedPackets.setDeliveryRateEstimator (&_deliveryRateEstimator);
+    _upqReliableUnsequencedPackets.setDeliveryRateEstimator (&_deliveryRateEstimator);
+
     _fSRTT = (float) pMocket->getInitialAssumedRTT();
     _i64LastRTTEstimationTime = getTimeInMilliseconds();
 
@@ -101,11 +110,55 @@ Transmitter::Transmitter (Mocket *pMocket, bool bEnableXMitLogging)
 
     _i64NextTimeToTransmit = 0;
 
+    _bPacing = pMocket->usingPacing();
+    _bKernelPacing = false;
+    _i64NextPacedTransmitTime = 0;
+
+    _pFECEncoder = nullptr;
+    if (pMocket->usingForwardErrorCorrection()) {
+        _pFECEncoder = new FECEncoder (pMocket->getFECSourcePackets(), pMocket->getFECRepairPackets());
+    }
+    _ui32LastFECExpectedPackets = 0;
+    _ui32LastFECLostPackets = 0;
+    _fFECLossRate = 0.0f;
+
     _i64LastRecTimeTimestamp = 0;
     _ui32RecSideBytesReceived = 0;
 
     _pByteSentPerInterval = nullptr;
 
+    _pSendBatchBuf = nullptr;
+    _ui16SendBatchCount = 0;
+    _bBatchIOSupported = _pCommInterface->isBatchIOSupported();
+    if (_bBatchIOSupported) {
+        if (nullptr == (_pSendBatchBuf = (char*) malloc (Mocket::getMaximumMTU() * SEND_BATCH_SIZE))) {
+            checkAndLogMsg ("Transmitter::Transmitter", Logger::L_MildError,
+                            "failed to allocate the send batch buffer; packets will be transmitted one at a time\n");
+            _bBatchIOSupported = false;
+        }
+        else {
+            for (uint16 ui16 = 0; ui16 < SEND_BATCH_SIZE; ui16++) {
+                _sendBatch[ui16].pBuf = _pSendBatchBuf + (ui16 * Mocket::getMaximumMTU());
+            }
+        }
+    }
+    if (_bPacing && pMocket->usingKernelPacing()) {
+        // The transmit times are attached to the datagrams passed to sendBatch()
+        if (!_bBatchIOSupported) {
+            checkAndLogMsg ("Transmitter::Transmitter", Logger::L_Warning,
+                            "kernel pacing requires batched I/O; packets will be paced by the transmitter\n");
+        }
+        else {
+            int rc = _pCommInterface->enableTransmitTime();
+            if (rc != 0) {
+                checkAndLogMsg ("Transmitter::Transmitter", Logger::L_Warning,
+                                "failed to enable kernel pacing (rc = %d); packets will be paced by the transmitter\n", rc);
+            }
+            else {
+                _bKernelPacing = true;
+            }
+        }
+    }
 }
 
 Transmitter::~Transmitter (void)
@@ -140,6 +193,14 @@ Transmitter::~Transmitter (void)
         delete _pByteSentPerInterval;
         _pByteSentPerInterval = nullptr;
     }
+    if (_pSendBatchBuf != nullptr) {
+        free (_pSendBatchBuf);
+        _pSendBatchBuf = nullptr;
+    }
+    if (_pFECEncoder != nullptr) {
+        delete _pFECEncoder;
+        _pFECEncoder = nullptr;
+    }
 }
 
 void Transmitter::enableTransmitLogging (bool bEnableXMitLogging)
@@ -182,22 +243,32 @@ void Transmitter::enableTransmitLogging (bool bEnableXMitLogging)
 
 int Transmitter::setTransmitRateLimit (uint32 ui32TransmitRateLimit)
 {
-    _resLimits.ui32RateLimit = ui32TransmitRateLimit;   // bytes per second
-
     // High bandwidth limit, use the bandwidth limit based on calculations of packets sent over time
     if (ui32TransmitRateLimit > _pMocket->BANDWIDTH_LIMITATION_THRESHOLD) {
-        _resLimits.ui32BytesPerInterval = ui32TransmitRateLimit * _pMocket->BANDWIDTH_LIMITATION_DEFAULT_INTERVAL / 1000;
+        // Computed on 64 bits - the product overflows 32 bits for rates above ~43 MB/s
+        uint64 ui64BytesPerInterval = ((uint64) ui32TransmitRateLimit) * _pMocket->BANDWIDTH_LIMITATION_DEFAULT_INTERVAL / 1000;
+        _resLimits.ui32BytesPerInterval = (ui64BytesPerInterval > 0xFFFFFFFFUL) ? 0xFFFFFFFFUL : (uint32) ui64BytesPerInterval;
         if (_pByteSentPerInterval == nullptr) {
             _pByteSentPerInterval = new TimeIntervalAverage<uint32> (_pMocket->BANDWIDTH_LIMITATION_DEFAULT_INTERVAL);
         }
     }
-    else {
-        // Setting a small bandwidth limit (or removing the limit), stop enqueuing data in _pByteSentPerInterval
-        if (_pByteSentPerInterval != nullptr) {
-            delete _pByteSentPerInterval;
-            _pByteSentPerInterval = nullptr;
+    // When setting a small bandwidth limit (or removing the limit), data is no longer enqueued in
+    // _pByteSentPerInterval. It is not deleted here, since congestion control mechanisms change the
+    // limit from other threads while the transmitter may be using it - it is deleted in the destructor
+
+    if (_bPacing && (ui32TransmitRateLimit != 0)) {
+        // The slot of the next packet was computed with the old rate: do not make it wait longer
+        // than one MTU at the new rate, or a transient low rate would stall the transmitter
+        int64 i64MaxNextTransmitTime = getMonotonicTimeInNanoseconds() + ((int64) _pMocket->getMTU()) * 1000000000 / ui32TransmitRateLimit;
+        int64 i64NextTransmitTime = _i64NextPacedTransmitTime.load();
+        while ((i64NextTransmitTime > i64MaxNextTransmitTime) &&
+               (!_i64NextPacedTransmitTime.compare_exchange_weak (i64NextTransmitTime, i64MaxNextTransmitTime))) {
+            // i64NextTransmitTime has been updated with the current value - try again
         }
     }
+
+    // Set last, so that the transmitter never sees a high limit without _pByteSentPerInterval
+    _resLimits.ui32RateLimit = ui32TransmitRateLimit;   // bytes per second
     return 0;
 }
 
@@ -224,6 +295,10 @@ int Transmitter::send (bool bReliable, bool bSequenced, const void *pBuf, uint32
     if (_pMocket->isCrossSequencingEnabled()) {
         ui16AvailSize -= Packet::DELIVERY_PREREQUISITES_SIZE;
     }
+    if ((!bReliable) && (bSequenced) && (_pFECEncoder != nullptr)) {
+        // Leave room for the FEC repair chunk, which must fit the largest packet of the block
+        ui16AvailSize -= FECEncoder::REPAIR_PACKET_OVERHEAD;
+    }
 
     bool bFragmentationNeeded = ui32BufSize > ((uint32) ui16AvailSize);
     uint16 ui16FragmentNum = 0;
@@ -243,7 +318,7 @@ int Transmitter::send (bool bReliable, bool bSequenced, const void *pBuf, uint32
         if (ui32BytesToSend > ui16AvailSize) {
             ui32BytesToSend = ui16AvailSize;
         }
-        Packet *pPacket = new Packet (_pMocket);
+        Packet *pPacket = new (_pMocket->getPacketPool()) Packet (_pMocket);
         if (_pMocket->isCrossSequencingEnabled()) {
             pPacket->allocateSpaceForDeliveryPrerequisites();
         }
@@ -281,7 +356,7 @@ int Transmitter::send (bool bReliable, bool bSequenced, const void *pBuf, uint32
         if (ui32RTO < _pMocket->getMinimumRTO()) {
             ui32RTO = _pMocket->getMinimumRTO();
         }
-        PacketWrapper *pWrapper = new PacketWrapper (pPacket, 0, ui8Priority, ui32MessageTSN, ui32RetryTimeout, ui32RTO);
+        PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pPacket, 0, ui8Priority, ui32MessageTSN, ui32RetryTimeout, ui32RTO);
         if (!_pendingPacketQueue.insert (pWrapper, ui32EnqueueTimeout)) {
             checkAndLogMsg ("Transmitter::send", Logger::L_MediumDetailDebug,
                             "failed to enqueue packet into the packet queue within the specified timeout of %lu ms\n",
@@ -345,6 +420,10 @@ int Transmitter::gsend (bool bReliable, bool bSequenced, uint16 ui16Tag, uint8 u
     if (_pMocket->isCrossSequencingEnabled()) {
         ui16SpacePerPacket -= Packet::DELIVERY_PREREQUISITES_SIZE;
     }
+    if ((!bReliable) && (bSequenced) && (_pFECEncoder != nullptr)) {
+        // Leave room for the FEC repair chunk, which must fit the largest packet of the block
+        ui16SpacePerPacket -= FECEncoder::REPAIR_PACKET_OVERHEAD;
+    }
     uint32 ui32TotalBytes = ui32BufSize1;
     while (va_arg (valist1, const void*) != nullptr) {
         ui32TotalBytes += va_arg (valist1, uint32);
@@ -366,7 +445,7 @@ int Transmitter::gsend (bool bReliable, bool bSequenced, uint16 ui16Tag, uint8 u
         uint32 ui32BytesLeft = ui32BufSize;
         while (ui32BytesLeft > 0) {
             if (pPacket == nullptr) {
-                pPacket = new Packet (_pMocket);
+                pPacket = new (_pMocket->getPacketPool()) Packet (_pMocket);
                 if (_pMocket->isCrossSequencingEnabled()) {
                     pPacket->allocateSpaceForDeliveryPrerequisites();
                 }
@@ -404,7 +483,7 @@ int Transmitter::gsend (bool bReliable, bool bSequenced, uint16 ui16Tag, uint8 u
                         ui16FragmentNum++;
                     }
                 }
-                PacketWrapper *pWrapper = new PacketWrapper (pPacket, 0, ui8Priority, ui32MessageTSN, ui32RetryTimeout, getRetransmissionTimeout());
+                PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pPacket, 0, ui8Priority, ui32MessageTSN, ui32RetryTimeout, getRetransmissionTimeout());
                 if (!_pendingPacketQueue.insert (pWrapper, ui32EnqueueTimeout)) {
                     checkAndLogMsg ("Transmitter::gsend", Logger::L_MediumDetailDebug,
                                     "failed to enqueue packet into the packet queue within the specified timeout of %lu ms\n",
@@ -430,7 +509,7 @@ int Transmitter::gsend (bool bReliable, bool bSequenced, uint16 ui16Tag, uint8 u
             // Must be the last fragment
                 pPacket->setAsLastFragment();
         }
-        PacketWrapper *pWrapper = new PacketWrapper (pPacket, 0, ui8Priority, ui32MessageTSN, ui32RetryTimeout, getRetransmissionTimeout());
+        PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pPacket, 0, ui8Priority, ui32MessageTSN, ui32RetryTimeout, getRetransmissionTimeout());
         if (!_pendingPacketQueue.insert (pWrapper, ui32EnqueueTimeout)) {
             checkAndLogMsg ("Transmitter::gsend", Logger::L_MediumDetailDebug,
                             "failed to enqueue packet into the packet queue within the specified timeout of %lu ms\n",
@@ -666,9 +745,23 @@ void Transmitter::run (void)
                                         "processUnacknowledgedPacketQueues() failed with rc = %d\n", rc);
                     }
                     // Get estimated number of packet to be transmitted to stay within the bandwidth limit
-                    if ((rc = processPendingPacketQueue()) < 0) {
-                        checkAndLogMsg ("Transmitter::run", Logger::L_MildError,
-                                        "processPendingPacketQueue() failed with rc = %d\n", rc);
+                    // If the CommInterface supports batched I/O, drain up to SEND_BATCH_SIZE packets
+                    // and transmit them with a single system call
+                    uint16 ui16SentFromPPQ = 0;
+                    do {
+                        if ((rc = processPendingPacketQueue (_bBatchIOSupported)) < 0) {
+                            checkAndLogMsg ("Transmitter::run", Logger::L_MildError,
+                                            "processPendingPacketQueue() failed with rc = %d\n", rc);
+                        }
+                        else if (rc == 1) {
+                            ui16SentFromPPQ++;
+                        }
+                    } while ((rc == 1) && (_bBatchIOSupported) && (ui16SentFromPPQ < SEND_BATCH_SIZE));
+                    if (_ui16SendBatchCount > 0) {
+                        flushSendBatch();
+                    }
+                    if (ui16SentFromPPQ > 0) {
+                        rc = 1;
                     }
                     // mauro: in the Java implementation i64TimeToWait used to be the minimum value between
                     // 100 milliseconds and _outstandingPacketQueue.timeToNextRetransmission()
@@ -680,6 +773,20 @@ void Transmitter::run (void)
                     else if (rc == -10) {
                         // Don't wait if a packet wasn't sent because of transmit rate limit, try again right away -or we could wait 1 ms
                         i64TimeToWait = 1;
+                        if (_bPacing && (_resLimits.ui32RateLimit != 0)) {
+                            // Wait until the next paced transmission, sleeping without the lock if it is less than 1 ms away
+                            int64 i64TimeToNextTransmission = getTimeToNextPacedTransmission();
+                            if (i64TimeToNextTransmission < 1000000) {
+                                _m.unlock();
+                                sleepForMicroseconds ((i64TimeToNextTransmission / 1000) + 1);
+                                _m.lock();
+                                i64TimeToWait = 0;
+                            }
+                            else {
+                                // Check again at least every 10 ms, in case the rate limit is raised in the meantime
+                                i64TimeToWait = (i64TimeToNextTransmission < 10000000) ? (i64TimeToNextTransmission / 1000000) : 10;
+                            }
+                        }
                     }
                     else {
                         i64TimeToWait = 10;
@@ -700,6 +807,19 @@ void Transmitter::run (void)
                 _mFlushData.unlock();
                 i64TimeToWait = 10; // Wait few milliseconds so Mocket can change to the next state of the suspension process
             }
+            // Do not hold back the repair packets of a partial FEC block for too long
+            if ((_pFECEncoder != nullptr) && (_pFECEncoder->getBlockSourcePacketCount() > 0)) {
+                int64 i64BlockAge = getTimeInMilliseconds() - _pFECEncoder->getBlockStartTime();
+                if (i64BlockAge >= (int64) _pMocket->getFECBlockTimeout()) {
+                    if (0 != (rc = sendFECRepairPackets())) {
+                        checkAndLogMsg ("Transmitter::run", Logger::L_MildError,
+                                        "sendFECRepairPackets() failed with rc = %d\n", rc);
+                    }
+                }
+                else if (i64TimeToWait > (_pMocket->getFECBlockTimeout() - i64BlockAge)) {
+                    i64TimeToWait = _pMocket->getFECBlockTimeout() - i64BlockAge;
+                }
+            }
             // Send control information if needed
             int64 i64CurrTime = getTimeInMilliseconds();
             if ((_pMocket->getCancelledTSNManager()->haveInformation()) &&
@@ -931,6 +1051,10 @@ int Transmitter::processSAckChunk (SAckChunkAccessor sackChunkAccessor)
 
     // Update Congestion Control
     if(_pCongestionControl != nullptr) {
+        DeliveryRateSample sample;
+        if (_deliveryRateEstimator.getSample (sample)) {
+            _pCongestionControl->addDeliveryRateSample (sample);
+        }
         _pCongestionControl->update();
     }
 
@@ -972,6 +1096,52 @@ int Transmitter::processTimestampAckChunk (TimestampAckChunkAccessor tsaChunkAcc
     return 0;
 }
 
+int Transmitter::processFECFeedbackChunk (FECFeedbackChunkAccessor fecFeedbackChunkAccessor)
+{
+    uint32 ui32ExpectedPackets = fecFeedbackChunkAccessor.getExpectedPacketCount();
+    uint32 ui32LostPackets = fecFeedbackChunkAccessor.getLostPacketCount();
+    _m.lock();
+    if (_pFECEncoder == nullptr) {
+        _m.unlock();
+        return -1;
+    }
+    // The counters are cumulative, so only the difference with the previous feedback is used
+    uint32 ui32Expected = ui32ExpectedPackets - _ui32LastFECExpectedPackets;
+    uint32 ui32Lost = ui32LostPackets - _ui32LastFECLostPackets;
+    if ((ui32Expected == 0) || (ui32Expected > 0x7FFFFFFFUL) || (ui32Lost > ui32Expected)) {
+        // No new information, or an old feedback that arrived out of order
+        _m.unlock();
+        return 0;
+    }
+    float fLossRate = ((float) ui32Lost) / ui32Expected;
+    if (_ui32LastFECExpectedPackets == 0) {
+        // First feedback
+        _fFECLossRate = fLossRate;
+    }
+    else {
+        _fFECLossRate = (0.75f * _fFECLossRate) + (0.25f * fLossRate);
+    }
+    _ui32LastFECExpectedPackets = ui32ExpectedPackets;
+    _ui32LastFECLostPackets = ui32LostPackets;
+
+    if (_pMocket->usingAdaptiveFEC()) {
+        // Send enough repair packets to cover the measured loss with a 50% margin, plus one
+        uint8 ui8SourcePackets = _pFECEncoder->getSourcePacketCount();
+        uint32 ui32RepairPackets = ((uint32) (ui8SourcePackets * _fFECLossRate * 1.5f)) + 1;
+        if (ui32RepairPackets > ui8SourcePackets) {
+            ui32RepairPackets = ui8SourcePackets;
+        }
+        if (ui32RepairPackets != _pFECEncoder->getRepairPacketCount()) {
+            checkAndLogMsg ("Transmitter::processFECFeedbackChunk", Logger::L_LowDetailDebug,
+                            "loss rate is %.3f; changing the number of FEC repair packets from %d to %d\n",
+                            _fFECLossRate, (int) _pFECEncoder->getRepairPacketCount(), (int) ui32RepairPackets);
+            _pFECEncoder->setRepairPacketCount ((uint8) ui32RepairPackets);
+        }
+    }
+    _m.unlock();
+    return 0;
+}
+
 bool Transmitter::waitForFlush (void)
 {
     // Enters the SUSPEND_PENDING state
@@ -1391,6 +1561,9 @@ int Transmitter::computeAckBasedRTT (uint32 ui32MinAckTime)
     }
     _pMocket->getStatistics()->_fSRTT = _fSRTT;
     _i64LastRTTEstimationTime = getTimeInMilliseconds();
+    if (_pCongestionControl != nullptr) {
+        _pCongestionControl->addRTTSample (ui32MinAckTime);
+    }
     checkAndLogMsg ("Transmitter::computeAckBasedRTT", Logger::L_MediumDetailDebug,
                     "updated Estimated RTT to %.2f based on new min ack time of %lu\n",
                     _fSRTT, ui32MinAckTime);
@@ -1410,6 +1583,9 @@ int Transmitter::computeTimestampBasedRTT (int64 i64Timestamp)
     }
     _pMocket->getStatistics()->_fSRTT = _fSRTT;
     _i64LastRTTEstimationTime = getTimeInMilliseconds();
+    if (_pCongestionControl != nullptr) {
+        _pCongestionControl->addRTTSample ((uint32) i64RTT);
+    }
     checkAndLogMsg ("Transmitter::computeTimestampBasedRTT", Logger::L_MediumDetailDebug,
                     "updated Estimated RTT to %.2f based on new timestamp-based RTT of %lu\n",
                     _fSRTT, (uint32) i64RTT);
@@ -1422,6 +1598,11 @@ bool Transmitter::allowedToSend (void)
         // There is no bandwidth limitation
         return true;
     }
+    if (_bPacing) {
+        // Pacing. Mechanism: each packet is assigned a transmit time that follows the
+        // previous one by the time it takes to send the previous packet at the rate limit
+        return (getTimeToNextPacedTransmission() <= 0);
+    }
     // Small bandwidth limit. Mechanism: the time to send the next message has
     // been calculated given the bandwidth limit and the size of the last message
     // sent. I.e. it takes: message_size*1000/rate_limit
@@ -1443,6 +1624,16 @@ bool Transmitter::allowedToSend (void)
     return false;
 }
 
+int64 Transmitter::getTimeToNextPacedTransmission (void)
+{
+    int64 i64TimeToNextTransmission = _i64NextPacedTransmitTime.load() - getMonotonicTimeInNanoseconds();
+    if (_bKernelPacing) {
+        // The kernel holds the packet until its transmit time
+        i64TimeToNextTransmission -= KERNEL_PACING_HORIZON;
+    }
+    return i64TimeToNextTransmission;
+}
+
 int Transmitter::resetSRTT (void)
 {
     _fSRTT = (float)_pMocket->getInitialAssumedRTT();
@@ -1467,7 +1658,7 @@ int Transmitter::resetUnackPacketsRetransmitTimeoutRetransmitCount (uint32 ui32R
     return 0;
 }
 
-int Transmitter::processPendingPacketQueue (void)
+int Transmitter::processPendingPacketQueue (bool bBatch)
 {
     _pendingPacketQueue.lock();
     if (!_pendingPacketQueue.isEmpty()) {
@@ -1499,9 +1690,7 @@ int Transmitter::processPendingPacketQueue (void)
                 }
             }
 
-            uint32 ui32TotalQueuedDataSize = _upqControlPackets.getQueuedDataSize() +
-                                            _upqReliableSequencedPackets.getQueuedDataSize() +
-                                            _upqReliableUnsequencedPackets.getQueuedDataSize();
+            uint32 ui32TotalQueuedDataSize = getUnacknowledgedDataSize();
             _lckRemoteWindowSize.lock();
             uint32 ui32SpaceAvailable = _ui32RemoteWindowSize;
             if( _pCongestionControl != nullptr) {
@@ -1540,7 +1729,7 @@ int Transmitter::processPendingPacketQueue (void)
                     pPacket->setSequenceNum (_ui32UnreliableUnsequencedID++);
                 }
                 int rc;
-                if (0 != (rc = appendPiggybackDataAndTransmitPacket (pWrapper->getPacket(), "New From PPQ"))) {
+                if (0 != (rc = appendPiggybackDataAndTransmitPacket (pWrapper->getPacket(), "New From PPQ", bBatch))) {
                     checkAndLogMsg ("Transmitter::processPendingPacketQueue", Logger::L_MildError,
                                     "appendPiggybackDataAndTransmitPacket() failed with rc = %d\n", rc);
                 }
@@ -1548,6 +1737,9 @@ int Transmitter::processPendingPacketQueue (void)
                     pWrapper->setLastIOTime (getTimeInMilliseconds());
                 }
                 pWrapper->setEnqueueTime (getTimeInMilliseconds());
+                if (pPacket->isControlPacket() || pPacket->isReliablePacket()) {
+                    _deliveryRateEstimator.packetSent (pWrapper, ui32TotalQueuedDataSize);
+                }
                 if (pPacket->isControlPacket()) {
                     _upqControlPackets.insert (pWrapper);
                 }
@@ -1562,6 +1754,15 @@ int Transmitter::processPendingPacketQueue (void)
                     _pMocket->getStatistics()->_ui32ReliableUnsequencedPacketQueueSize = _upqReliableUnsequencedPackets.getPacketCount();
                 }
                 else {
+                    if ((_pFECEncoder != nullptr) && (pPacket->isSequencedPacket())) {
+                        // Unreliable sequenced packets are protected by FEC
+                        if (_pFECEncoder->addSourcePacket (pPacket, getTimeInMilliseconds())) {
+                            if (0 != (rc = sendFECRepairPackets (bBatch))) {
+                                checkAndLogMsg ("Transmitter::processPendingPacketQueue", Logger::L_MildError,
+                                                "sendFECRepairPackets() failed with rc = %d\n", rc);
+                            }
+                        }
+                    }
                     delete pWrapper->getPacket();
                     delete pWrapper;
                 }
@@ -1636,6 +1837,7 @@ int Transmitter::processUnacknowledgedPacketQueues (void)
                 ui32RTO = _pMocket->getMinimumRTO();
             }
             pWrapper->setRetransmitTimeout (ui32RTO);
+            _deliveryRateEstimator.packetSent (pWrapper, getUnacknowledgedDataSize());
             if (0 != (rc = _upqControlPackets.packetRetransmitted (pWrapper))) {
                 checkAndLogMsg ("Transmitter::processUnacknowledgedPacketQueues", Logger::L_MildError,
                                 "UnacknowledgedPacketQueue::packetRetransmitted() failed with rc = %d\n", rc);
@@ -1704,6 +1906,7 @@ int Transmitter::processUnacknowledgedPacketQueues (void)
                         ui32RTO = _pMocket->getMinimumRTO();
                     }
                     pWrapper->setRetransmitTimeout (ui32RTO);
+                    _deliveryRateEstimator.packetSent (pWrapper, getUnacknowledgedDataSize());
                     if (0 != (rc = _upqReliableSequencedPackets.packetRetransmitted (pWrapper))) {
                         checkAndLogMsg ("Transmitter::processUnacknowledgedPacketQueues", Logger::L_MildError,
                                         "UnacknowledgedPacketQueue::packetRetransmitted() failed with rc = %d\n", rc);
@@ -1774,6 +1977,7 @@ int Transmitter::processUnacknowledgedPacketQueues (void)
                         ui32RTO = _pMocket->getMinimumRTO();
                     }
                     pWrapper->setRetransmitTimeout (ui32RTO);
+                    _deliveryRateEstimator.packetSent (pWrapper, getUnacknowledgedDataSize());
                     if (0 != (rc = _upqReliableUnsequencedPackets.packetRetransmitted (pWrapper))) {
                         checkAndLogMsg ("Transmitter::processUnacknowledgedPacketQueues", Logger::L_MildError,
                                         "UnacknowledgedPacketQueue::packetRetransmitted() failed with rc = %d\n", rc);
@@ -1825,7 +2029,7 @@ int Transmitter::sendControlPacket (Packet *pPacket, uint8 ui8Priority)
     int rc;
     pPacket->setControlPacket (true);
     pPacket->setSequenceNum (_ui32ControlTSN++);
-    PacketWrapper *pWrapper = new PacketWrapper (pPacket, getTimeInMilliseconds(), ui8Priority, 0, 0, getRetransmissionTimeout());
+    PacketWrapper *pWrapper = new (_pMocket->getPacketPool()) PacketWrapper (pPacket, getTimeInMilliseconds(), ui8Priority, 0, 0, getRetransmissionTimeout());
     _upqControlPackets.lock();
     _upqControlPackets.insert (pWrapper);
     if (0 != (rc = appendPiggybackDataAndTransmitPacket (pWrapper->getPacket(), "New Ctrl"))) {
@@ -1850,6 +2054,26 @@ int Transmitter::sendHeartbeatPacket (void)
     return 0;
 }
 
+int Transmitter::sendFECRepairPackets (bool bBatch)
+{
+    uint8 ui8RepairPackets = _pFECEncoder->getBlockRepairPacketCount();
+    int rc = 0;
+    for (uint8 ui8 = 0; ui8 < ui8RepairPackets; ui8++) {
+        Packet packet (_pMocket);
+        if (_pFECEncoder->addRepairChunk (&packet, ui8)) {
+            rc = -1;
+            break;
+        }
+        if (appendPiggybackDataAndTransmitPacket (&packet, "FEC Repair", bBatch)) {
+            rc = -2;
+            break;
+        }
+        _pMocket->getStatistics()->_ui32SentFECRepairPackets++;
+    }
+    _pFECEncoder->startNewBlock();
+    return rc;
+}
+
 int Transmitter::sendSAckPacket (void)
 {
     Packet packet (_pMocket);
@@ -2031,7 +2255,7 @@ int Transmitter::sendReEstablishAckPacket (void)
     return 0;
 }
 
-int Transmitter::appendPiggybackDataAndTransmitPacket (Packet *pPacket, const char *pszPurpose)
+int Transmitter::appendPiggybackDataAndTransmitPacket (Packet *pPacket, const char *pszPurpose, bool bBatch)
 {
     if (_bSendTimestamp) {
         if (pPacket->addTimestampChunk (getTimeInMilliseconds())) {
@@ -2088,7 +2312,19 @@ int Transmitter::appendPiggybackDataAndTransmitPacket (Packet *pPacket, const ch
         }
     }
 
-    if (transmitPacket (pPacket, pszPurpose)) {
+    uint32 ui32FECExpectedPackets, ui32FECLostPackets;
+    PacketProcessor *pPacketProcessor = _pMocket->getPacketProcessor();
+    if ((pPacketProcessor != nullptr) && (pPacketProcessor->getFECFeedback (ui32FECExpectedPackets, ui32FECLostPackets))) {
+        if (pPacket->addFECFeedbackChunk (ui32FECExpectedPackets, ui32FECLostPackets)) {
+            checkAndLogMsg ("Transmitter::appendPiggybackDataAndTransmitPacket", Logger::L_MediumDetailDebug,
+                            "failed to append FEC feedback information to packet before transmitting\n");
+        }
+        else {
+            pPacketProcessor->fecFeedbackSent();
+        }
+    }
+
+    if (transmitPacket (pPacket, pszPurpose, bBatch)) {
         // Blindly remove the piggyback, if there is no piggyback nothing will change!
         pPacket->removePiggybackChunks();
         return -3;
@@ -2099,7 +2335,7 @@ int Transmitter::appendPiggybackDataAndTransmitPacket (Packet *pPacket, const ch
     return 0;
 }
 
-int Transmitter::transmitPacket (Packet *pPacket, const char *pszPurpose)
+int Transmitter::transmitPacket (Packet *pPacket, const char *pszPurpose, bool bBatch)
 {
     #ifdef DEBUG_MIGRATION
     // This IF is necessary to test the freeze/defrost process
@@ -2113,8 +2349,54 @@ int Transmitter::transmitPacket (Packet *pPacket, const char *pszPurpose)
     }
     #endif
     pPacket->setWindowSize (_pMocket->getReceiver()->getWindowSize());
-    InetAddr sendToAddr (_ui32RemoteAddress, _ui16RemotePort);
-    int rc = _pCommInterface->sendTo (&sendToAddr, pPacket->getPacket(), pPacket->getPacketSize());
+    int64 i64TransmitTime = 0;
+    uint32 ui32RateLimit = _resLimits.ui32RateLimit;
+    if (_bPacing && (ui32RateLimit != 0)) {
+        // Reserve the next transmission slot; a late transmitter thread may catch up by at most PACING_MAX_LAG
+        // The slot is reserved with a compare and swap, since setTransmitRateLimit() may move it concurrently
+        int64 i64CurrTime = getMonotonicTimeInNanoseconds();
+        int64 i64Duration = ((int64) pPacket->getPacketSize()) * 1000000000 / ui32RateLimit;
+        int64 i64NextTransmitTime = _i64NextPacedTransmitTime.load();
+        int64 i64SlotTime;
+        do {
+            i64SlotTime = (i64NextTransmitTime < (i64CurrTime - PACING_MAX_LAG)) ? i64CurrTime : i64NextTransmitTime;
+        } while (!_i64NextPacedTransmitTime.compare_exchange_weak (i64NextTransmitTime, i64SlotTime + i64Duration));
+        if (_bKernelPacing) {
+            i64TransmitTime = i64SlotTime;
+        }
+    }
+    int rc;
+    if (bBatch) {
+        // Copy the packet into the send batch - the piggyback chunks are removed by the caller
+        // as soon as this method returns, and the datagram is sent by flushSendBatch()
+        if (_ui16SendBatchCount >= SEND_BATCH_SIZE) {
+            flushSendBatch();
+        }
+        CommInterface::Datagram *pDatagram = &_sendBatch[_ui16SendBatchCount++];
+        memcpy (pDatagram->pBuf, pPacket->getPacket(), pPacket->getPacketSize());
+        pDatagram->iBufSize = pPacket->getPacketSize();
+        pDatagram->remoteAddr = InetAddr (_ui32RemoteAddress, _ui16RemotePort);
+        pDatagram->i64TransmitTime = i64TransmitTime;
+        rc = pPacket->getPacketSize();
+    }
+    else if (i64TransmitTime != 0) {
+        // The transmit time can only be passed to the kernel with sendBatch()
+        if (_ui16SendBatchCount > 0) {
+            flushSendBatch();
+        }
+        CommInterface::Datagram datagram;
+        datagram.pBuf = (void*) pPacket->getPacket();
+        datagram.iBufSize = pPacket->getPacketSize();
+        datagram.remoteAddr = InetAddr (_ui32RemoteAddress, _ui16RemotePort);
+        datagram.i64TransmitTime = i64TransmitTime;
+        rc = (_pCommInterface->sendBatch (&datagram, 1) == 1) ? pPacket->getPacketSize() : -1;
+        _pMocket->getStatistics()->_ui32SendSyscalls++;
+    }
+    else {
+        InetAddr sendToAddr (_ui32RemoteAddress, _ui16RemotePort);
+        rc = _pCommInterface->sendTo (&sendToAddr, pPacket->getPacket(), pPacket->getPacketSize());
+        _pMocket->getStatistics()->_ui32SendSyscalls++;
+    }
     if (rc <= 0) {
         if (_pMocket->getStateMachine()->getCurrentState() == StateMachine::S_APPLICATION_ABORT) {
             checkAndLogMsg("Transmitter::transmitPacket", Logger::L_MildError,"failed to send packet, State Machine set to Application Abort");
@@ -2150,7 +2432,7 @@ int Transmitter::transmitPacket (Packet *pPacket, const char *pszPurpose)
                         pPacket->getWindowSize());*/
     }
     _i64LastTransmitTime = getTimeInMilliseconds();
-    if (_resLimits.ui32RateLimit != 0) {
+    if ((_resLimits.ui32RateLimit != 0) && (!_bPacing)) {
         if (_resLimits.ui32RateLimit > _pMocket->BANDWIDTH_LIMITATION_THRESHOLD) {
             // There is a large bandwidth limit in place, update _pByteSentPerInterval
             _pByteSentPerInterval->add (pPacket->getPacketSizeWithoutPiggybackChunks());
@@ -2192,6 +2474,28 @@ int Transmitter::transmitPacket (Packet *pPacket, const char *pszPurpose)
     return 0;
 }
 
+int Transmitter::flushSendBatch (void)
+{
+    if (_ui16SendBatchCount == 0) {
+        return 0;
+    }
+    int rc = _pCommInterface->sendBatch (_sendBatch, _ui16SendBatchCount);
+    _pMocket->getStatistics()->_ui32SendSyscalls++;
+    if (rc < (int) _ui16SendBatchCount) {
+        // The packets that could not be sent are still in the unacknowledged packet
+        // queues (if reliable) and will be retransmitted after the timeout expires
+        uint16 ui16Unsent = _ui16SendBatchCount - ((rc > 0) ? (uint16) rc : 0);
+        checkAndLogMsg ("Transmitter::flushSendBatch", Logger::L_MildError,
+                        "failed to send %d out of %d packets; rc = %d\n",
+                        (int) ui16Unsent, (int) _ui16SendBatchCount, rc);
+        _pMocket->getStatistics()->_ui32SentPackets -= ui16Unsent;
+        _ui16SendBatchCount = 0;
+        return -1;
+    }
+    _ui16SendBatchCount = 0;
+    return 0;
+}
+
 int Transmitter::setBandwidthEstimationActive (uint16 ui16InitialAssumedBandwidth)
 {
     _pBandwidthEstimator = new BandwidthEstimator(_pMocket->getBandEstMaxSamplesNumber(), _pMocket->getBandEstTimeInterval(), _pMocket->getBandEstSamplingTime(), ui16InitialAssumedBandwidth);
@@ -2215,6 +2519,14 @@ int Transmitter::setCongestionControlActive (const char *pszCongestionControl)
         _pCongestionControl = new TransmissionRateModulation (_pMocket);
         return 0;
     }
+    if (strcmp("BBRCongestionController", pszCongestionControl) == 0) {
+        _pCongestionControl = new BBRCongestionController (_pMocket);
+        return 0;
+    }
+    if (strcmp("CubicCongestionController", pszCongestionControl) == 0) {
+        _pCongestionControl = new CubicCongestionController (_pMocket);
+        return 0;
+    }
     checkAndLogMsg ("Transmitter::setCongestionControlActive", Logger::L_MildError,
                     "ERROR: the requested congestion control mechanism: %s, is not implemented\n", pszCongestionControl);
     return -1;
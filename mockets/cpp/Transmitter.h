@@ -20,9 +20,13 @@
  * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
  */
 
+#include "CommInterface.h"
+#include "DeliveryRateEstimator.h"
 #include "PendingPacketQueue.h"
 #include "UnacknowledgedPacketQueue.h"
+#include "BBRCongestionController.h"
 #include "CongestionController.h"
+#include "CubicCongestionController.h"
 #include "TransmissionRateModulation.h"
 
 #include "ConditionVariable.h"
@@ -31,9 +35,11 @@
 #include "TimeIntervalAverage.h"
 #include "NLFLib.h"
 
+#include <atomic>
+
 //#include <stdio.h>
 
-class CommInterface;
+class FECEncoder;
 class Mocket;
 class Receiver;
 
@@ -88,6 +94,10 @@ class Transmitter : public NOMADSUtil::Thread
 
         int processTimestampAckChunk (TimestampAckChunkAccessor tsaChunkAccessor);
 
+        // Updates the loss rate measured by the remote FEC decoder and, if adaptive FEC is enabled,
+        // the number of repair packets sent for each block
+        int processFECFeedbackChunk (FECFeedbackChunkAccessor fecFeedbackChunkAccessor);
+
         // Request that a timestamp be sent, which will trigger the other side to send
         // a timestamp ack upon which the RTT will be measured
         int requestTimestampTransmission (void);
@@ -156,14 +166,26 @@ class Transmitter : public NOMADSUtil::Thread
         // has already obtained a lock on the mutex _m
 
         friend class Mocket;
+        friend class BBRCongestionController;
         friend class CongestionController;
+        friend class CubicCongestionController;
         friend class TransmissionRateModulation;
 
+        // Maximum number of packets from the pending packet queue that are transmitted with a single system call
+        static const uint16 SEND_BATCH_SIZE = 32;
+
+        // When the kernel paces packets (SO_TXTIME), packets are handed to the kernel at most this many nanoseconds before their transmit time
+        static const int64 KERNEL_PACING_HORIZON = 2000000;
+
+        // Maximum delay (in nanoseconds) of the transmitter thread that is recovered by sending the next packets closer together
+        // Bounds the burst that is sent after the thread wakes up late
+        static const int64 PACING_MAX_LAG = 1000000;
 
         // Check to see if there are packets in the pending packet queue that need to be processed
         // Transmits at the most one packet
+        // If bBatch is true, the packet is added to the send batch instead of being transmitted right away (see flushSendBatch())
         // Returns 0 if no packets were sent, 1 if a packet was sent, or a negative value in case of error
-        int processPendingPacketQueue (void);
+        int processPendingPacketQueue (bool bBatch = false);
 
         // Check to see if there are packets in the unacknowledged packet queues that need to be retransmitted due to a timeout
         // Transmits at the most three packets - one from each of the three queues
@@ -181,6 +203,8 @@ class Transmitter : public NOMADSUtil::Thread
 
         int sendHeartbeatPacket (void);
         int sendSAckPacket (void);
+        // Sends the repair packets for the current FEC block and starts a new block
+        int sendFECRepairPackets (bool bBatch = false);
         int sendCancelledTSNPacket (void);
         int sendShutdownPacket (void);
         int sendShutdownAckPacket (void);
@@ -215,13 +239,18 @@ class Transmitter : public NOMADSUtil::Thread
         //     appended but could not be removed
         // NOTE: Does not return an error if the piggyback chunks could not be appended
         // NOTE: The purpose argument is optional and is only used for logging
-        int appendPiggybackDataAndTransmitPacket (Packet *pPacket, const char *pszPurpose);
+        int appendPiggybackDataAndTransmitPacket (Packet *pPacket, const char *pszPurpose, bool bBatch = false);
 
         // Transmits the specified packet over the datagram socket to the remote endpoint
         // The window size is updated in the packet by querying the receiver before the packet is transmitted
         // After a successful transmission, _i64LastTransmitTime is updated to reflect the current time
+        // If bBatch is true, the packet is copied into the send batch and is transmitted by the next call to flushSendBatch()
         // NOTE: The purpose argument is optional and is only used for logging
-        int transmitPacket (Packet *pPacket, const char *pszPurpose);
+        int transmitPacket (Packet *pPacket, const char *pszPurpose, bool bBatch = false);
+
+        // Transmits all the packets in the send batch with a single call to CommInterface::sendBatch()
+        // Returns 0 if successful or a negative value in case of error
+        int flushSendBatch (void);
 
         uint32 getRetransmissionTimeout (void);
 
@@ -235,8 +264,14 @@ class Transmitter : public NOMADSUtil::Thread
         uint16 getNumberOfAcknowledgedPackets (void);
         uint32 getTransmitRateLimit (void);
 
+        // Returns the size (in bytes) of the data that has been transmitted and is awaiting acknowledgement
+        uint32 getUnacknowledgedDataSize (void);
+
         bool allowedToSend (void);
 
+        // Returns the number of nanoseconds until allowedToSend() will allow the next paced packet to be sent
+        int64 getTimeToNextPacedTransmission (void);
+
         int resetSRTT (void);
         int resetUnackPacketsRetransmitTimeoutRetransmitCount (uint32 ui32RetransmitTO);
 
@@ -313,6 +348,19 @@ class Transmitter : public NOMADSUtil::Thread
 
         int64 _i64NextTimeToTransmit;
 
+        // Pacing: packets are spread evenly at the transmit rate limit instead of being sent in bursts
+        bool _bPacing;
+        bool _bKernelPacing;                // The transmit time of each packet is passed to the kernel (SO_TXTIME)
+        // Monotonic time in nanoseconds; atomic since setTransmitRateLimit() is invoked by the
+        // congestion controllers from other threads while the transmitter is reserving slots
+        std::atomic<int64> _i64NextPacedTransmitTime;
+
+        // Forward error correction for unreliable sequenced packets
+        FECEncoder *_pFECEncoder;           // nullptr if FEC is not enabled
+        uint32 _ui32LastFECExpectedPackets; // Counters in the last feedback received from the remote FEC decoder
+        uint32 _ui32LastFECLostPackets;
+        float _fFECLossRate;                // Smoothed packet loss rate measured by the remote FEC decoder
+
         // Receiver side bandwidth estimation
         int64 _i64LastRecTimeTimestamp;
         uint32 _ui32RecSideBytesReceived;
@@ -321,6 +369,7 @@ class Transmitter : public NOMADSUtil::Thread
         UnacknowledgedPacketQueue _upqControlPackets;
         UnacknowledgedPacketQueue _upqReliableSequencedPackets;
         UnacknowledgedPacketQueue _upqReliableUnsequencedPackets;
+        DeliveryRateEstimator _deliveryRateEstimator;  // Notified by the three queues above
 
         ResourceLimits _resLimits;
 
@@ -334,6 +383,13 @@ class Transmitter : public NOMADSUtil::Thread
 
         TimeIntervalAverage<uint32> *_pByteSentPerInterval;
 
+        // Packets taken from the pending packet queue that are waiting to be transmitted with one system call
+        // The buffer is only allocated if the CommInterface supports batched I/O
+        CommInterface::Datagram _sendBatch[SEND_BATCH_SIZE];
+        char *_pSendBatchBuf;
+        uint16 _ui16SendBatchCount;
+        bool _bBatchIOSupported;
+
         // This is 2^32. It is used to check if the variable that contains the
         // number of bytes received so far from the receiver wrapped around
         static const uint32 UINT32_MAX_VALUE = 0xFFFFFFFFUL;
@@ -418,6 +474,13 @@ inline uint32 Transmitter::getTransmitRateLimit (void)
     return _resLimits.ui32RateLimit;
 }
 
+inline uint32 Transmitter::getUnacknowledgedDataSize (void)
+{
+    return _upqControlPackets.getQueuedDataSize() +
+           _upqReliableSequencedPackets.getQueuedDataSize() +
+           _upqReliableUnsequencedPackets.getQueuedDataSize();
+}
+
 inline void Transmitter::notify (void)
 {
     _m.lock();
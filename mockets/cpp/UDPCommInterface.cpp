@@ -22,12 +22,21 @@
 #if defined UNIX
     #include <cerrno>
 #endif
+#if defined (LINUX)
+    #include <string.h>
+    #include <time.h>
+    #include <linux/net_tstamp.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+#endif
 using namespace NOMADSUtil;
 
 UDPCommInterface::UDPCommInterface (UDPDatagramSocket *pDGSocket, bool bDeleteDGSocketWhenDone)
 {
     _pDGSocket = pDGSocket;
     _bDeleteDGSocketWhenDone = bDeleteDGSocketWhenDone;
+    _bTransmitTimeEnabled = false;
 }
 
 UDPCommInterface::~UDPCommInterface (void)
@@ -100,6 +109,171 @@ int UDPCommInterface::getLastError (void)
     return _pDGSocket->getLastError();
 }
 
+int UDPCommInterface::getLocalSocket (void)
+{
+    return _pDGSocket->getLocalSocket();
+}
+
+#if defined (LINUX)
+
+bool UDPCommInterface::isBatchIOSupported (void)
+{
+    return true;
+}
+
+int UDPCommInterface::enableTransmitTime (void)
+{
+    #if defined (SO_TXTIME)
+        struct sock_txtime txtime;
+        memset (&txtime, 0, sizeof (txtime));
+        txtime.clockid = CLOCK_MONOTONIC;
+        if (setsockopt (_pDGSocket->getLocalSocket(), SOL_SOCKET, SO_TXTIME, &txtime, sizeof (txtime)) < 0) {
+            return -2;
+        }
+        _bTransmitTimeEnabled = true;
+        return 0;
+    #else
+        return -1;
+    #endif
+}
+
+int UDPCommInterface::sendBatch (Datagram *pDatagrams, uint16 ui16Count, const char *pszHints)
+{
+    struct mmsghdr msgs[MAX_BATCH_SIZE];
+    struct iovec iovecs[MAX_BATCH_SIZE];
+    struct sockaddr_in remoteAddrs[MAX_BATCH_SIZE];
+    #if defined (SO_TXTIME)
+        // Control messages carrying the transmit time of each datagram
+        union {
+            char buf[CMSG_SPACE (sizeof (uint64))];
+            struct cmsghdr align;
+        } controls[MAX_BATCH_SIZE];
+    #endif
+    int sockfd = _pDGSocket->getLocalSocket();
+    int iSent = 0;
+    while (iSent < (int) ui16Count) {
+        unsigned int uiCount = ui16Count - iSent;
+        if (uiCount > MAX_BATCH_SIZE) {
+            uiCount = MAX_BATCH_SIZE;
+        }
+        memset (msgs, 0, sizeof (struct mmsghdr) * uiCount);
+        for (unsigned int ui = 0; ui < uiCount; ui++) {
+            Datagram *pDatagram = &pDatagrams[iSent + ui];
+            memset (&remoteAddrs[ui], 0, sizeof (struct sockaddr_in));
+            remoteAddrs[ui].sin_family = AF_INET;
+            remoteAddrs[ui].sin_port = htons (pDatagram->remoteAddr.getPort());
+            remoteAddrs[ui].sin_addr.s_addr = pDatagram->remoteAddr.getIPAddress();
+            iovecs[ui].iov_base = pDatagram->pBuf;
+            iovecs[ui].iov_len = pDatagram->iBufSize;
+            msgs[ui].msg_hdr.msg_name = &remoteAddrs[ui];
+            msgs[ui].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+            msgs[ui].msg_hdr.msg_iov = &iovecs[ui];
+            msgs[ui].msg_hdr.msg_iovlen = 1;
+            #if defined (SO_TXTIME)
+                if ((_bTransmitTimeEnabled) && (pDatagram->i64TransmitTime != 0)) {
+                    msgs[ui].msg_hdr.msg_control = controls[ui].buf;
+                    msgs[ui].msg_hdr.msg_controllen = sizeof (controls[ui].buf);
+                    struct cmsghdr *pCmsg = CMSG_FIRSTHDR (&msgs[ui].msg_hdr);
+                    pCmsg->cmsg_level = SOL_SOCKET;
+                    pCmsg->cmsg_type = SCM_TXTIME;
+                    pCmsg->cmsg_len = CMSG_LEN (sizeof (uint64));
+                    uint64 ui64TransmitTime = (uint64) pDatagram->i64TransmitTime;
+                    memcpy (CMSG_DATA (pCmsg), &ui64TransmitTime, sizeof (uint64));
+                }
+            #endif
+        }
+        int rc = sendmmsg (sockfd, msgs, uiCount, 0);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (iSent > 0) ? iSent : -1;
+        }
+        iSent += rc;
+    }
+    return iSent;
+}
+
+int UDPCommInterface::receiveBatch (Datagram *pDatagrams, uint16 ui16Count)
+{
+    struct mmsghdr msgs[MAX_BATCH_SIZE];
+    struct iovec iovecs[MAX_BATCH_SIZE];
+    struct sockaddr_in remoteAddrs[MAX_BATCH_SIZE];
+    if (ui16Count > MAX_BATCH_SIZE) {
+        ui16Count = MAX_BATCH_SIZE;
+    }
+    memset (msgs, 0, sizeof (struct mmsghdr) * ui16Count);
+    for (uint16 ui16 = 0; ui16 < ui16Count; ui16++) {
+        iovecs[ui16].iov_base = pDatagrams[ui16].pBuf;
+        iovecs[ui16].iov_len = pDatagrams[ui16].iBufSize;
+        msgs[ui16].msg_hdr.msg_name = &remoteAddrs[ui16];
+        msgs[ui16].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+        msgs[ui16].msg_hdr.msg_iov = &iovecs[ui16];
+        msgs[ui16].msg_hdr.msg_iovlen = 1;
+    }
+    int sockfd = _pDGSocket->getLocalSocket();
+
+    // Try to read without waiting first - under load there usually are datagrams
+    // available already, which saves the call to poll()
+    int rc = recvmmsg (sockfd, msgs, ui16Count, MSG_DONTWAIT, nullptr);
+    if (rc < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            return -1;
+        }
+        // poll() rather than select(), which can not handle descriptors >= FD_SETSIZE
+        int iTimeout = _pDGSocket->getTimeout();
+        struct pollfd pfd;
+        pfd.fd = sockfd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        rc = poll (&pfd, 1, (iTimeout > 0) ? iTimeout : -1);
+        if (rc == 0) {
+            return 0;
+        }
+        else if (rc < 0) {
+            return (errno == EINTR) ? 0 : -2;
+        }
+        for (uint16 ui16 = 0; ui16 < ui16Count; ui16++) {
+            msgs[ui16].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+        }
+        if ((rc = recvmmsg (sockfd, msgs, ui16Count, MSG_DONTWAIT, nullptr)) < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+                return 0;
+            }
+            return -3;
+        }
+    }
+    for (int i = 0; i < rc; i++) {
+        pDatagrams[i].iDataSize = (int) msgs[i].msg_len;
+        pDatagrams[i].remoteAddr = InetAddr (remoteAddrs[i].sin_addr.s_addr, ntohs (remoteAddrs[i].sin_port));
+    }
+    return rc;
+}
+
+#else
+
+bool UDPCommInterface::isBatchIOSupported (void)
+{
+    return false;
+}
+
+int UDPCommInterface::enableTransmitTime (void)
+{
+    return -1;
+}
+
+int UDPCommInterface::sendBatch (Datagram *pDatagrams, uint16 ui16Count, const char *pszHints)
+{
+    return CommInterface::sendBatch (pDatagrams, ui16Count, pszHints);
+}
+
+int UDPCommInterface::receiveBatch (Datagram *pDatagrams, uint16 ui16Count)
+{
+    return CommInterface::receiveBatch (pDatagrams, ui16Count);
+}
+
+#endif
+
 int UDPCommInterface::isRecoverableSocketError (void) 
 {
     int error = getLastError();
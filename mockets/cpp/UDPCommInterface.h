@@ -45,10 +45,19 @@ class UDPCommInterface : public CommInterface
         virtual int receive (void *pBuf, int iBufSize, NOMADSUtil::InetAddr *pRemoteAddr);
         virtual int getLastError (void);
         virtual int isRecoverableSocketError (void);
+        virtual int getLocalSocket (void);
+        virtual bool isBatchIOSupported (void);
+        virtual int enableTransmitTime (void);
+        virtual int sendBatch (Datagram *pDatagrams, uint16 ui16Count, const char *pszHints = nullptr);
+        virtual int receiveBatch (Datagram *pDatagrams, uint16 ui16Count);
+
+        // Maximum number of datagrams moved by a single sendmmsg() or recvmmsg() call
+        static const uint16 MAX_BATCH_SIZE = 64;
 
     private:
         NOMADSUtil::UDPDatagramSocket *_pDGSocket;
         bool _bDeleteDGSocketWhenDone;
+        bool _bTransmitTimeEnabled;
 };
 
 #endif   // #ifndef INCL_UDP_COMM_INTERFACE_H
@@ -24,12 +24,20 @@
  * transmitted, removing packets that have been acknowledged, and iterating over packets
  * that need to be retransmitted.
  *
- * The data structure is a dual double-linked list, with the first list sorted by the
- * sequence number of the packet and the second list sorted by the retransmission time.
- * The nodes in the first linked list point to the nodes in the second linked list in order
- * to efficiently handle removing packets that have been acknowledged.
+ * Each packet in the queue is kept in three indexes:
+ * - a ring of slots indexed by sequence number (the slot of a packet is its sequence
+ *   number modulo the size of the ring), which supports looking up a packet and removing
+ *   a range of acknowledged packets without scanning the rest of the queue.
+ *   The ring grows (by doubling) whenever the span between the lowest and the highest
+ *   sequence number in the queue exceeds its size;
+ * - a binary heap ordered by retransmission time (ties are broken by sequence number),
+ *   whose top is the next packet that will time out. Each entry remembers its position
+ *   in the heap, so that its retransmission time can be updated in O(log n);
+ * - a double-linked list ordered by the time the packets were last sent, which is used
+ *   to detect lost packets.
  */
 
+#include "DeliveryRateEstimator.h"
 #include "Packet.h"
 #include "PacketWrapper.h"
 #include "TSNRangeHandler.h"
@@ -43,6 +51,7 @@
 #include "NLFLib.h"
 #include "SequentialArithmetic.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 class UnacknowledgedPacketQueue
@@ -61,12 +70,17 @@ class UnacknowledgedPacketQueue
 
         bool isEmpty (void);
 
+        // Sets the estimator that is notified of each packet acknowledged, or nullptr (the default)
+        void setDeliveryRateEstimator (DeliveryRateEstimator *pDeliveryRateEstimator);
+
         // Returns a count of the number of packets in the queue
         uint32 getPacketCount (void);
 
         // Returns the total number of bytes enqueued (a sum of all the packet sizes)
         uint32 getQueuedDataSize (void);
 
+        // Returns 0 if successful or a negative value in case of error (including if
+        // a packet with the same sequence number is already in the queue)
         int insert (PacketWrapper *pWrapper);
 
         // Deletes packets in this queue whose sequence numbers are <= the specified sequence number
@@ -124,53 +138,68 @@ class UnacknowledgedPacketQueue
         int freeze (NOMADSUtil::ObjectFreezer &objectFreezer);
         int defrost (NOMADSUtil::ObjectDefroster &objectDefroster);
 
+    public:
+        static const uint32 INITIAL_RING_SIZE = 64;         // Must be a power of 2
+        static const uint32 MAXIMUM_RING_SIZE = 0x400000UL; // Limits the span of sequence numbers in the queue
+        static const uint32 INITIAL_HEAP_SIZE = 64;
+        static const uint32 BULK_REMOVAL_FRACTION = 8;      // Rebuild the heap when acknowledging more than 1/8 of the queue
+
     private:
-        struct Node
+        struct Entry
         {
-            Node (void);
-            Node *pPrev;
-            Node *pNext;
-            Node *pOtherListNode;
-            Node *pOtherListNode2;
+            Entry (PacketWrapper *pWrapper);
             PacketWrapper *pData;
-            virtual bool operator < (const Node &rhsNode) = 0;
+            int64 i64RetransmitTime;    // Key of the entry in the retransmit heap
+            uint32 ui32HeapIndex;
+            Entry *pPrevSent;           // Links in the list sorted by sent time
+            Entry *pNextSent;
         };
 
-        struct PacketSeqListNode : public Node
-        {
-            bool operator < (const Node &rhsNode);
-        };
+    private:
+        static int64 computeRetransmitTime (PacketWrapper *pWrapper);
 
-        struct RetransmitTimeListNode : public Node
-        {
-            bool operator < (const Node &rhsNode);
-        };
+        int insertEntry (PacketWrapper *pWrapper);
 
-        struct SentTimeListNode : public Node
-        {
-            bool operator < (const Node &rhsNode);
-        };
+        // Removes the entry from all the indexes, updates the counters, and deletes
+        // the entry along with its PacketWrapper and Packet
+        void deleteEntry (Entry *pEntry);
 
-        struct List
-        {
-            Node *pFirstNode;
-            Node *pLastNode;
-        };
+        void updateMinAckTime (Entry *pEntry, int64 i64CurrTime);
+        int expireLostPackets (Entry *pEntry);
 
-    private:
-        int insertIntoLists (PacketWrapper *pWrapper);
-        int insertIntoList (List *pList, Node *pNewNode);
-        int insertIntoListFromEnd (List *pList, Node *pNewNode);
-        int removeFromList (List *pList, Node *pNode);
-        int expireLostPackets (Node *pNode);
+        // Sequence number index
+        Entry * lookup (uint32 ui32SequenceNum);
+        int addToRing (Entry *pEntry);
+        void removeFromRing (Entry *pEntry);
+        int growRing (uint32 ui32MinSize);
+
+        // Retransmit time index
+        int addToHeap (Entry *pEntry);
+        void removeFromHeap (Entry *pEntry);
+        void updateRetransmitTime (Entry *pEntry, int64 i64RetransmitTime);
+        void moveToHeadOfHeap (Entry *pEntry);
+        void compactHeap (uint32 ui32HeapCount);
+        void siftUp (uint32 ui32Index);
+        void siftDown (uint32 ui32Index);
+        static bool precedes (const Entry *pLHS, const Entry *pRHS);
+
+        // Sent time index
+        void appendToSentTimeList (Entry *pEntry);
+        void removeFromSentTimeList (Entry *pEntry);
 
     private:
         NOMADSUtil::Mutex _m;
         NOMADSUtil::ConditionVariable _cv;
         bool _bUseLostPacketsDetection;
-        List _packetSeqList;
-        List _retransmitTimeList;
-        List _sentTimeList;
+        DeliveryRateEstimator *_pDeliveryRateEstimator;
+        Entry **_ppRing;
+        uint32 _ui32RingSize;
+        uint32 _ui32FirstSeqNum;    // Lowest and highest sequence numbers in the queue
+        uint32 _ui32LastSeqNum;     // (only valid if the queue is not empty)
+        Entry **_ppHeap;
+        uint32 _ui32HeapSize;
+        Entry *_pFirstSent;
+        Entry *_pLastSent;
         uint32 _ui32PacketsInQueue;
         uint32 _ui32BytesInQueue;
         uint32 _ui32MinAckTime;   // Keeps track of the minimum time that has elapsed between
@@ -181,30 +210,34 @@ class UnacknowledgedPacketQueue
 inline UnacknowledgedPacketQueue::UnacknowledgedPacketQueue (bool bUseLostPacketsDetection)
     : _cv (&_m)
 {
-    _packetSeqList.pFirstNode = _packetSeqList.pLastNode = nullptr;
-    _retransmitTimeList.pFirstNode = _retransmitTimeList.pLastNode = nullptr;
-    _sentTimeList.pFirstNode = _sentTimeList.pLastNode = nullptr;
+    _ppRing = nullptr;
+    _ui32RingSize = 0;
+    _ui32FirstSeqNum = 0;
+    _ui32LastSeqNum = 0;
+    _ppHeap = nullptr;
+    _ui32HeapSize = 0;
+    _pFirstSent = _pLastSent = nullptr;
     _ui32PacketsInQueue = 0;
     _ui32BytesInQueue = 0;
     _ui32MinAckTime = 0xFFFFFFFFUL;
     _bUseLostPacketsDetection = bUseLostPacketsDetection;
+    _pDeliveryRateEstimator = nullptr;
 }
 
 inline UnacknowledgedPacketQueue::~UnacknowledgedPacketQueue (void)
 {
-    Node *pTempNode = _packetSeqList.pFirstNode;
-    while (pTempNode != nullptr) {
-        Node *pNodeToDelete = pTempNode;
-        pTempNode = pTempNode->pNext;
-        delete pNodeToDelete->pData->getPacket();
-        delete pNodeToDelete->pData;
-        delete pNodeToDelete->pOtherListNode;
-        delete pNodeToDelete->pOtherListNode2;
-        delete pNodeToDelete;
-    }
-    _packetSeqList.pFirstNode = _packetSeqList.pLastNode = nullptr;
-    _retransmitTimeList.pFirstNode = _retransmitTimeList.pLastNode = nullptr;
-    _sentTimeList.pFirstNode = _sentTimeList.pLastNode = nullptr;
+    for (uint32 ui32 = 0; ui32 < _ui32PacketsInQueue; ui32++) {
+        delete _ppHeap[ui32]->pData->getPacket();
+        delete _ppHeap[ui32]->pData;
+        delete _ppHeap[ui32];
+    }
+    free (_ppRing);
+    _ppRing = nullptr;
+    _ui32RingSize = 0;
+    free (_ppHeap);
+    _ppHeap = nullptr;
+    _ui32HeapSize = 0;
+    _pFirstSent = _pLastSent = nullptr;
     _ui32PacketsInQueue = 0;
     _ui32BytesInQueue = 0;
     _ui32MinAckTime = 0xFFFFFFFFUL;
@@ -225,6 +258,11 @@ inline bool UnacknowledgedPacketQueue::isEmpty (void)
     return (_ui32PacketsInQueue == 0);
 }
 
+inline void UnacknowledgedPacketQueue::setDeliveryRateEstimator (DeliveryRateEstimator *pDeliveryRateEstimator)
+{
+    _pDeliveryRateEstimator = pDeliveryRateEstimator;
+}
+
 inline uint32 UnacknowledgedPacketQueue::getPacketCount (void)
 {
     return _ui32PacketsInQueue;
@@ -242,50 +280,52 @@ inline int UnacknowledgedPacketQueue::insert (PacketWrapper *pWrapper)
         return -1;
     }
 
-    return insertIntoLists (pWrapper);
+    return insertEntry (pWrapper);
 }
 
 inline int UnacknowledgedPacketQueue::acknowledgePacketsUpto (uint32 ui32SequenceNum, uint64 &ui64NumberOfAcknowledgedBytes)
 {
     int iCount = 0;
     _m.lock();
+    if ((_ui32PacketsInQueue == 0) || (NOMADSUtil::SequentialArithmetic::lessThan (ui32SequenceNum, _ui32FirstSeqNum))) {
+        _m.unlock();
+        return 0;
+    }
     int64 i64CurrTime = NOMADSUtil::getTimeInMilliseconds();
-    Node *pTemp = _packetSeqList.pFirstNode;
-
-    uint32 ui32AckTime;
-    while (pTemp != nullptr) {
-        if (NOMADSUtil::SequentialArithmetic::lessThanOrEqual (pTemp->pData->getPacket()->getSequenceNum(), ui32SequenceNum)) {
-            // Compute the acknowledgement time and update MinAckTime if appropriate
-            if (pTemp->pData->getRetransmitCount() == 0) {
-                ui32AckTime = (uint32) (i64CurrTime - pTemp->pData->getLastIOTime());
-                if (ui32AckTime < _ui32MinAckTime) {
-                    _ui32MinAckTime = ui32AckTime;
-                }
-            }
-
-            Node *pNodeToDelete = pTemp;
-            Node *pOtherNodeToDelete = pTemp->pOtherListNode;
-            Node *pOtherNodeToDelete2 = pTemp->pOtherListNode2;
-            if (_bUseLostPacketsDetection) {
-                expireLostPackets (pOtherNodeToDelete2);
-            }
-            pTemp = pTemp->pNext;
+    uint32 ui32HeapCount = _ui32PacketsInQueue;
+    uint32 ui32MaxCount = NOMADSUtil::SequentialArithmetic::lessThan (ui32SequenceNum, _ui32LastSeqNum) ?
+                          (ui32SequenceNum - _ui32FirstSeqNum + 1) : _ui32PacketsInQueue;
+    bool bBulkRemoval = (!_bUseLostPacketsDetection) && (ui32MaxCount > (_ui32PacketsInQueue / BULK_REMOVAL_FRACTION));
+
+    // Packets are removed starting from the lowest sequence number, which moves
+    // _ui32FirstSeqNum up to the next packet still in the queue
+    while ((_ui32PacketsInQueue > 0) && (NOMADSUtil::SequentialArithmetic::lessThanOrEqual (_ui32FirstSeqNum, ui32SequenceNum))) {
+        Entry *pEntry = lookup (_ui32FirstSeqNum);
+        updateMinAckTime (pEntry, i64CurrTime);
+        if (_bUseLostPacketsDetection) {
+            expireLostPackets (pEntry);
+        }
+        if (_pDeliveryRateEstimator != nullptr) {
+            _pDeliveryRateEstimator->packetAcknowledged (pEntry->pData);
+        }
+        ui64NumberOfAcknowledgedBytes += pEntry->pData->getPacket()->getPacketSize();
+        if (bBulkRemoval) {
+            // Leave the entry in the heap - it is removed by compactHeap() below
             _ui32PacketsInQueue--;
-            _ui32BytesInQueue -= pNodeToDelete->pData->getPacket()->getPacketSize();
-            ui64NumberOfAcknowledgedBytes += pNodeToDelete->pData->getPacket()->getPacketSize();
-
-            delete pNodeToDelete->pData->getPacket();
-            delete pNodeToDelete->pData;
-            removeFromList (&_packetSeqList, pNodeToDelete);
-            removeFromList (&_retransmitTimeList, pOtherNodeToDelete);
-            removeFromList (&_sentTimeList, pOtherNodeToDelete2);
-            iCount++;
+            _ui32BytesInQueue -= pEntry->pData->getPacket()->getPacketSize();
+            removeFromRing (pEntry);
+            removeFromSentTimeList (pEntry);
+            delete pEntry->pData->getPacket();
+            delete pEntry->pData;
+            pEntry->pData = nullptr;
         }
         else {
-            // Packets are sequentially ordered - so if the sequence number of the packet is greater than the specified
-            // sequence number, there is no need to check further
-            break;
+            deleteEntry (pEntry);
         }
+        iCount++;
+    }
+    if (bBulkRemoval) {
+        compactHeap (ui32HeapCount);
     }
     _m.unlock();
     return iCount;
@@ -295,45 +335,34 @@ inline int UnacknowledgedPacketQueue::acknowledgePacketsWithin (uint32 ui32Start
 {
     int iCount = 0;
     _m.lock();
+    if ((_ui32PacketsInQueue == 0) || (NOMADSUtil::SequentialArithmetic::lessThan (ui32EndSequenceNum, ui32StartSequenceNum))) {
+        _m.unlock();
+        return 0;
+    }
+    // Clip the range to the sequence numbers that are in the queue
+    if (NOMADSUtil::SequentialArithmetic::lessThan (ui32StartSequenceNum, _ui32FirstSeqNum)) {
+        ui32StartSequenceNum = _ui32FirstSeqNum;
+    }
+    if (NOMADSUtil::SequentialArithmetic::greaterThan (ui32EndSequenceNum, _ui32LastSeqNum)) {
+        ui32EndSequenceNum = _ui32LastSeqNum;
+    }
     int64 i64CurrTime = NOMADSUtil::getTimeInMilliseconds();
-    Node *pTemp = _packetSeqList.pFirstNode;
-
-    while (pTemp != nullptr) {
-        uint32 ui32SequenceNum = pTemp->pData->getPacket()->getSequenceNum();
-        if (NOMADSUtil::SequentialArithmetic::lessThanOrEqual (ui32StartSequenceNum, ui32SequenceNum) &&
-            NOMADSUtil::SequentialArithmetic::lessThanOrEqual (ui32SequenceNum, ui32EndSequenceNum)) {
-            // Compute the acknowledgement time and update MinAckTime if appropriate
-            if (pTemp->pData->getRetransmitCount() == 0) {
-                uint32 ui32AckTime = (uint32) (i64CurrTime - pTemp->pData->getLastIOTime());
-                if (ui32AckTime < _ui32MinAckTime) {
-                    _ui32MinAckTime = ui32AckTime;
-                }
-            }
-
-            Node *pNodeToDelete = pTemp;
-            Node *pOtherNodeToDelete = pTemp->pOtherListNode;
-            Node *pOtherNodeToDelete2 = pTemp->pOtherListNode2;
+    uint32 ui32SequenceNum = ui32StartSequenceNum;
+    while ((_ui32PacketsInQueue > 0) && (NOMADSUtil::SequentialArithmetic::lessThanOrEqual (ui32SequenceNum, ui32EndSequenceNum))) {
+        Entry *pEntry = lookup (ui32SequenceNum);
+        if (pEntry != nullptr) {
+            updateMinAckTime (pEntry, i64CurrTime);
             if (_bUseLostPacketsDetection) {
-                expireLostPackets (pOtherNodeToDelete2);
+                expireLostPackets (pEntry);
             }
-            pTemp = pTemp->pNext;
-            _ui32PacketsInQueue--;
-            _ui32BytesInQueue -= pNodeToDelete->pData->getPacket()->getPacketSize();
-            ui64NumberOfAcknowledgedBytes += pNodeToDelete->pData->getPacket()->getPacketSize();
-
-            delete pNodeToDelete->pData->getPacket();
-            delete pNodeToDelete->pData;
-            removeFromList (&_packetSeqList, pNodeToDelete);
-            removeFromList (&_retransmitTimeList, pOtherNodeToDelete);
-            removeFromList (&_sentTimeList, pOtherNodeToDelete2);
+            if (_pDeliveryRateEstimator != nullptr) {
+                _pDeliveryRateEstimator->packetAcknowledged (pEntry->pData);
+            }
+            ui64NumberOfAcknowledgedBytes += pEntry->pData->getPacket()->getPacketSize();
+            deleteEntry (pEntry);
             iCount++;
         }
-        else if (NOMADSUtil::SequentialArithmetic::lessThan (ui32SequenceNum, ui32StartSequenceNum)) {
-            pTemp = pTemp->pNext;      // Cannot stop yet - since the current packet is below the specified range
-        }
-        else {
-            break;
-        }
+        ui32SequenceNum++;
     }
     _m.unlock();
     return iCount;
@@ -341,8 +370,8 @@ inline int UnacknowledgedPacketQueue::acknowledgePacketsWithin (uint32 ui32Start
 
 inline PacketWrapper * UnacknowledgedPacketQueue::getNextTimedOutPacket (void)
 {
-    if (_retransmitTimeList.pFirstNode) {
-        PacketWrapper *pWrapper = _retransmitTimeList.pFirstNode->pData;
+    if (_ui32PacketsInQueue > 0) {
+        PacketWrapper *pWrapper = _ppHeap[0]->pData;
         if ((pWrapper->getLastIOTime() + pWrapper->getRetransmitTimeout()) < NOMADSUtil::getTimeInMilliseconds()) {
             return pWrapper;
         }
@@ -352,74 +381,38 @@ inline PacketWrapper * UnacknowledgedPacketQueue::getNextTimedOutPacket (void)
 
 inline int UnacknowledgedPacketQueue::prioritizeRetransmissionOfPacket (uint32 ui32SeqNum)
 {
-    Node *pTempSeq = _packetSeqList.pFirstNode;
-    Node *pTempRetr;
-
     _m.lock();
-    while (pTempSeq != nullptr) { //lookup for the packet with sequence number ui32SeqNum
-    if (pTempSeq->pData->getSequenceNum() == ui32SeqNum && !pTempSeq->pData->getRetransmitCount()) { //Note: maybe the check of the retransmit count should be done at a upper level
-            //when the correct packet is found, its lastIOTime is set to cause a timeout
-        pTempSeq->pData->setLastIOTime (pTempSeq->pData->getLastIOTime() - pTempSeq->pData->getRetransmitTimeout());
-        pTempRetr = pTempSeq->pOtherListNode;
-        //then the node is reordered in the retransmission list (it is positioned as first node)
-        if (pTempRetr != _retransmitTimeList.pFirstNode) {
-        if (pTempRetr == _retransmitTimeList.pLastNode) {
-            pTempRetr->pPrev->pNext = nullptr;
-            _retransmitTimeList.pLastNode = pTempRetr->pPrev;
-        }
-        else {
-            pTempRetr->pPrev->pNext = pTempRetr->pNext;
-                pTempRetr->pNext->pPrev = pTempRetr->pPrev;
-        }
-        pTempRetr->pPrev = nullptr;
-        pTempRetr->pNext = _retransmitTimeList.pFirstNode;
-            _retransmitTimeList.pFirstNode->pPrev = pTempRetr;
-            _retransmitTimeList.pFirstNode = pTempRetr;
-        pTempRetr = nullptr;
-        }
+    Entry *pEntry = lookup (ui32SeqNum);
+    //Note: maybe the check of the retransmit count should be done at a upper level
+    if ((pEntry == nullptr) || (pEntry->pData->getRetransmitCount() != 0)) {
+        //The packet with ui32SeqNum was not found
         _m.unlock();
-        return 1;
-    }
-        pTempSeq = pTempSeq->pNext;
+        return 0;
     }
-
-    //The packet with ui32SeqNum was not found
+    // Set the lastIOTime of the packet to cause a timeout and make it the next packet to be retransmitted
+    pEntry->pData->setLastIOTime (pEntry->pData->getLastIOTime() - pEntry->pData->getRetransmitTimeout());
+    moveToHeadOfHeap (pEntry);
     _m.unlock();
-    return 0;
+    return 1;
 }
 
 inline int UnacknowledgedPacketQueue::prioritizeRetransmissionOfPacketUpTo (uint32 ui32SeqNum)
 {
-    Node *pTempSeq = _packetSeqList.pFirstNode;
-    Node *pTempRetr;
-
     _m.lock();
-    while ((pTempSeq != nullptr) && (pTempSeq->pData->getSequenceNum() < ui32SeqNum)) { //lookup for the packet with sequence number ui32SeqNum
-    if (!pTempSeq->pData->getRetransmitCount()) { //Note: maybe the check of the retransmit count should be done at a upper level
-            //when the correct packet is found, its lastIOTime is set to cause a timeout
-        //pTempSeq->pData->setLastIOTime (pTempSeq->pData->getLastIOTime() - pTempSeq->pData->getRetransmitTimeout());
-        pTempSeq->pData->setRetransmitTimeout(0);
-        pTempRetr = pTempSeq->pOtherListNode;
-        //then the node is reordered in the retransmission list
-        if (pTempRetr != _retransmitTimeList.pFirstNode) {
-        if (pTempRetr == _retransmitTimeList.pLastNode) {
-            pTempRetr->pPrev->pNext = nullptr;
-            _retransmitTimeList.pLastNode = pTempRetr->pPrev;
-        }
-        else {
-            pTempRetr->pPrev->pNext = pTempRetr->pNext;
-                pTempRetr->pNext->pPrev = pTempRetr->pPrev;
-        }
-        pTempRetr->pPrev = nullptr;
-        pTempRetr->pNext = _retransmitTimeList.pFirstNode;
-            _retransmitTimeList.pFirstNode->pPrev = pTempRetr;
-            _retransmitTimeList.pFirstNode = pTempRetr;
-        pTempRetr = nullptr;
+    if (_ui32PacketsInQueue > 0) {
+        uint32 ui32SequenceNum = _ui32FirstSeqNum;
+        while (NOMADSUtil::SequentialArithmetic::lessThan (ui32SequenceNum, ui32SeqNum) &&
+               NOMADSUtil::SequentialArithmetic::lessThanOrEqual (ui32SequenceNum, _ui32LastSeqNum)) {
+            Entry *pEntry = lookup (ui32SequenceNum);
+            //Note: maybe the check of the retransmit count should be done at a upper level
+            if ((pEntry != nullptr) && (pEntry->pData->getRetransmitCount() == 0)) {
+                pEntry->pData->setRetransmitTimeout (0);
+                moveToHeadOfHeap (pEntry);
+                _m.unlock();
+                return 1;
+            }
+            ui32SequenceNum++;
         }
-        _m.unlock();
-        return 1;
-    }
-        pTempSeq = pTempSeq->pNext;
     }
 
     //The packet with ui32SeqNum was not found
@@ -430,21 +423,11 @@ inline int UnacknowledgedPacketQueue::prioritizeRetransmissionOfPacketUpTo (uint
 inline int UnacknowledgedPacketQueue::deleteNextPacketInRetransmitList (void)
 {
     _m.lock();
-    if (_retransmitTimeList.pFirstNode == nullptr) {
+    if (_ui32PacketsInQueue == 0) {
         _m.unlock();
         return -1;
     }
-    Node *pNodeToDelete = _retransmitTimeList.pFirstNode;
-    Node *pOtherNodeToDelete = pNodeToDelete->pOtherListNode;
-    Node *pOtherNodeToDelete2 = pNodeToDelete->pOtherListNode2;
-    _ui32PacketsInQueue--;
-    _ui32BytesInQueue -= pNodeToDelete->pData->getPacket()->getPacketSize();
-    delete pNodeToDelete->pData->getPacket();
-    delete pNodeToDelete->pData;
-    if ((removeFromList (&_retransmitTimeList, pNodeToDelete)) || (removeFromList (&_packetSeqList, pOtherNodeToDelete)) || (removeFromList (&_sentTimeList, pOtherNodeToDelete2))) {
-        _m.unlock();
-        return -2;
-    }
+    deleteEntry (_ppHeap[0]);
     _m.unlock();
     return 0;
 }
@@ -452,67 +435,21 @@ inline int UnacknowledgedPacketQueue::deleteNextPacketInRetransmitList (void)
 inline int UnacknowledgedPacketQueue::packetRetransmitted (PacketWrapper *pWrapper)
 {
     _m.lock();
-    if (_retransmitTimeList.pFirstNode == nullptr) {
+    if (_ui32PacketsInQueue == 0) {
         _m.unlock();
         return -1;
     }
-    else if (_retransmitTimeList.pFirstNode->pData != pWrapper) {
+    Entry *pEntry = _ppHeap[0];
+    if (pEntry->pData != pWrapper) {
         _m.unlock();
         return -2;
     }
-    else if (_retransmitTimeList.pFirstNode == _retransmitTimeList.pLastNode) {
-        // There is only one node, so nothing needs to be done
-        _m.unlock();
-        return 0;
-    }
-    // Reorder _sendTimeList: find the node and enqueue it at the end of the list
-    Node *pSentTimeListNode = _retransmitTimeList.pFirstNode->pOtherListNode2;
-    Node *pNode = _sentTimeList.pFirstNode;
-    if (pNode == pSentTimeListNode) {
-        if (_sentTimeList.pLastNode == pSentTimeListNode) {
-            // nothing to do
-            pNode = nullptr;
-        }
-        else {
-            _sentTimeList.pFirstNode = pNode->pNext;
-            _sentTimeList.pFirstNode->pPrev = nullptr;
-        }
-    }
-    else {
-        pNode = pNode->pNext;
-        while (pNode != nullptr) {
-            if (pNode == pSentTimeListNode) {
-                // Found the node to be reordered
-                if (_sentTimeList.pLastNode == pNode) {
-                    // The node is already at the end of the list, do nothing
-                    pNode = nullptr;
-                }
-                else {
-                    pNode->pPrev->pNext = pNode->pNext;
-                    pNode->pNext->pPrev = pNode->pPrev;
-                    pNode->pPrev = nullptr;
-                    pNode->pNext = nullptr;
-                }
-                break;
-            }
-            pNode = pNode->pNext;
-        }
-    }
-    if (pNode != nullptr) {
-        // The node needs to be moved to the end of the list
-        pNode->pPrev = _sentTimeList.pLastNode;
-        _sentTimeList.pLastNode->pNext = pNode;
-        _sentTimeList.pLastNode = pNode;
+    // The packet is now the most recently sent one
+    if (pEntry != _pLastSent) {
+        removeFromSentTimeList (pEntry);
+        appendToSentTimeList (pEntry);
     }
-
-    // Reorder _retransmitTimeList
-    pNode = _retransmitTimeList.pFirstNode;
-    _retransmitTimeList.pFirstNode = _retransmitTimeList.pFirstNode->pNext;
-    _retransmitTimeList.pFirstNode->pPrev = nullptr;
-    pNode->pNext = nullptr;
-    pNode->pPrev = nullptr;
-    insertIntoListFromEnd (&_retransmitTimeList, pNode);
-
+    updateRetransmitTime (pEntry, computeRetransmitTime (pWrapper));
     _m.unlock();
     return 0;
 }
@@ -521,26 +458,17 @@ inline int UnacknowledgedPacketQueue::cancel (uint16 ui16TagId, CancelledTSNMana
 {
     int iDeletedPackets = 0;
     _m.lock();
-    Node *pTemp = _packetSeqList.pFirstNode;
-    while (pTemp != nullptr) {
-        Packet *pPacket = pTemp->pData->getPacket();
-        if (pPacket->getTagId() == ui16TagId) {
-            Node *pNodeToDelete = pTemp;
-            Node *pOtherNodeToDelete = pTemp->pOtherListNode;
-            Node *pOtherNodeToDelete2 = pTemp->pOtherListNode2;
-            pTemp = pTemp->pNext;
-            _ui32PacketsInQueue--;
-            _ui32BytesInQueue -= pPacket->getPacketSize();
-            pCancelledTSNManager->addCancelledPacketTSN (pPacket->getSequenceNum());
-            delete pPacket;
-            delete pNodeToDelete->pData;
-            removeFromList (&_packetSeqList, pNodeToDelete);
-            removeFromList (&_retransmitTimeList, pOtherNodeToDelete);
-            removeFromList (&_sentTimeList, pOtherNodeToDelete2);
-            iDeletedPackets++;
-        }
-        else {
-            pTemp = pTemp->pNext;
+    if (_ui32PacketsInQueue > 0) {
+        uint32 ui32LastSeqNum = _ui32LastSeqNum;
+        uint32 ui32SequenceNum = _ui32FirstSeqNum;
+        while ((_ui32PacketsInQueue > 0) && (NOMADSUtil::SequentialArithmetic::lessThanOrEqual (ui32SequenceNum, ui32LastSeqNum))) {
+            Entry *pEntry = lookup (ui32SequenceNum);
+            if ((pEntry != nullptr) && (pEntry->pData->getPacket()->getTagId() == ui16TagId)) {
+                pCancelledTSNManager->addCancelledPacketTSN (ui32SequenceNum);
+                deleteEntry (pEntry);
+                iDeletedPackets++;
+            }
+            ui32SequenceNum++;
         }
     }
     _m.unlock();
@@ -563,12 +491,18 @@ inline void UnacknowledgedPacketQueue::dumpPacketSequenceNumbers (void)
         _m.lock();
         char szBuf[8192];
         szBuf[0] = '\0';
-        Node *pTempNode = _packetSeqList.pFirstNode;
-        while (pTempNode != nullptr) {
-            char szPacketNum[10];
-            sprintf (szPacketNum, "%u ", pTempNode->pData->getPacket()->getSequenceNum());
-            strcat (szBuf, szPacketNum);
-            pTempNode = pTempNode->pNext;
+        size_t len = 0;
+        if (_ui32PacketsInQueue > 0) {
+            for (uint32 ui32SequenceNum = _ui32FirstSeqNum; NOMADSUtil::SequentialArithmetic::lessThanOrEqual (ui32SequenceNum, _ui32LastSeqNum); ui32SequenceNum++) {
+                if (lookup (ui32SequenceNum) == nullptr) {
+                    continue;
+                }
+                if (len + 12 >= sizeof (szBuf)) {
+                    // Buffer is full
+                    break;
+                }
+                len += sprintf (szBuf + len, "%u ", ui32SequenceNum);
+            }
         }
         NOMADSUtil::pLogger->logMsg ("UnacknowledgedPacketQueue::dumpPacketSequenceNumbers", NOMADSUtil::Logger::L_MediumDetailDebug,
                                      "%s\n", szBuf);
@@ -579,43 +513,15 @@ inline void UnacknowledgedPacketQueue::dumpPacketSequenceNumbers (void)
 inline int UnacknowledgedPacketQueue::resetRetrTimeoutRetrCount (uint32 ui32RetransmitTO)
 {
     _m.lock();
-    // Loop through all the nodes (packets) in the list.
-    // Loop through _packetSeqList, but reorder nodes in _retransmitTimeList
-    Node *pTempNode = _packetSeqList.pFirstNode;
-    Node *pTempNodeRetrTimeList;
-    while (pTempNode != nullptr) {
-        pTempNodeRetrTimeList = pTempNode->pOtherListNode;
-        pTempNodeRetrTimeList->pData->setRetransmitTimeout (ui32RetransmitTO);
-        pTempNodeRetrTimeList->pData->resetRetransmitCount();
-        // Reorder _retransmitTimeList (remove and insert node)
-        // REMOVE
-        if (_retransmitTimeList.pFirstNode == pTempNodeRetrTimeList) {
-            // Removing the first element in the list
-            if (_retransmitTimeList.pLastNode == pTempNodeRetrTimeList) {
-                // This was also the only element in the list
-                _retransmitTimeList.pFirstNode = _retransmitTimeList.pLastNode = nullptr;
-            }
-            else {
-                _retransmitTimeList.pFirstNode = _retransmitTimeList.pFirstNode->pNext;
-                _retransmitTimeList.pFirstNode->pPrev = nullptr;
-            }
-        }
-        else if (_retransmitTimeList.pLastNode == pTempNodeRetrTimeList) {
-            // Removing the last element in the list
-            _retransmitTimeList.pLastNode = pTempNodeRetrTimeList->pPrev;
-            pTempNodeRetrTimeList->pPrev->pNext = nullptr;
-        }
-        else {
-            // Removing a non-boundary element in the list
-            pTempNodeRetrTimeList->pPrev->pNext = pTempNodeRetrTimeList->pNext;
-            pTempNodeRetrTimeList->pNext->pPrev = pTempNodeRetrTimeList->pPrev;
-        }
-
-        // INSERT in the correct order
-        if (insertIntoList (&_retransmitTimeList, pTempNodeRetrTimeList)) {
-            return -2;
-        }
-        pTempNode = pTempNode->pNext;
+    for (uint32 ui32 = 0; ui32 < _ui32PacketsInQueue; ui32++) {
+        Entry *pEntry = _ppHeap[ui32];
+        pEntry->pData->setRetransmitTimeout (ui32RetransmitTO);
+        pEntry->pData->resetRetransmitCount();
+        pEntry->i64RetransmitTime = computeRetransmitTime (pEntry->pData);
+    }
+    // Rebuild the heap, since all the retransmission times have changed
+    for (uint32 ui32 = _ui32PacketsInQueue / 2; ui32 > 0; ui32--) {
+        siftDown (ui32 - 1);
     }
     _m.unlock();
     return 0;
@@ -623,24 +529,17 @@ inline int UnacknowledgedPacketQueue::resetRetrTimeoutRetrCount (uint32 ui32Retr
 
 inline int UnacknowledgedPacketQueue::freeze (NOMADSUtil::ObjectFreezer &objectFreezer)
 {
-    // List _packetSeqList, List _retransmitTimeList and List _sentTimeList contain the same nodes
-    // but they are not in the same order. I can freeze only _retransmitTimeList,
-    // because it has newer information about the last transmission time, and during
-    // the insertion the two queues will be recreated in the correct order.
+    // The packets are frozen in the order in which they were sent, so that the list
+    // sorted by sent time is the same after defrosting. The other indexes are rebuilt
+    // by insert() while defrosting.
     objectFreezer.putUInt32 (_ui32PacketsInQueue);
 
-/*    printf ("UnacknowledgedPacketQueue\n");
-    printf ("_ui32PacketsInQueue %lu\n", _ui32PacketsInQueue);*/
-
     // Go through the whole list of nodes
-    Node *pCurrNode = _retransmitTimeList.pFirstNode;
-    for (uint32 i=0; i<_ui32PacketsInQueue; i++) {
-        //printf ("***** i = %d\n", i);
-        if (0 != pCurrNode->pData->freeze (objectFreezer)) {
+    for (Entry *pEntry = _pFirstSent; pEntry != nullptr; pEntry = pEntry->pNextSent) {
+        if (0 != pEntry->pData->freeze (objectFreezer)) {
             // return -1 is if objectFreezer.endObject() don't end with success
             return -2;
         }
-        pCurrNode = pCurrNode->pNext;
     }
     // Do not freeze _ui32BytesInQueue, it is computable
     // Do not frezze _ui32MinAckTime we can initializate it with the maximum
@@ -651,62 +550,51 @@ inline int UnacknowledgedPacketQueue::freeze (NOMADSUtil::ObjectFreezer &objectF
 
 inline int UnacknowledgedPacketQueue::defrost (NOMADSUtil::ObjectDefroster &objectDefroster)
 {
-    objectDefroster >> _ui32PacketsInQueue;
-
-/*    printf ("UnacknowledgedPacketQueue\n");
-    printf ("_ui32PacketsInQueue %lu\n", _ui32PacketsInQueue);*/
+    uint32 ui32PacketsInQueue = 0;
+    objectDefroster >> ui32PacketsInQueue;
 
     // Insert all nodes in the queues
-    for (uint32 i=0; i<_ui32PacketsInQueue; i++){
-        //printf ("***** i = %d\n", i);
+    for (uint32 i = 0; i < ui32PacketsInQueue; i++) {
         PacketWrapper *pWrapper = new PacketWrapper ((uint32) 0, (int64) 0); // Fake values for the initialization
         if (0 != pWrapper->defrost (objectDefroster)) {
+            delete pWrapper;
             return -2;
         }
-        insertIntoLists (pWrapper);
+        if (0 != insertEntry (pWrapper)) {
+            delete pWrapper->getPacket();
+            delete pWrapper;
+            return -3;
+        }
     }
     return 0;
 }
 
-inline int UnacknowledgedPacketQueue::insertIntoLists (PacketWrapper *pWrapper)
+inline int64 UnacknowledgedPacketQueue::computeRetransmitTime (PacketWrapper *pWrapper)
 {
-    PacketSeqListNode *pPacketSeqListNode = new PacketSeqListNode;
-    RetransmitTimeListNode *pRetransmitTimeListNode = new RetransmitTimeListNode;
-    SentTimeListNode *pSentTimeListNode = new SentTimeListNode;
-    pPacketSeqListNode->pData = pWrapper;
-    pRetransmitTimeListNode->pData = pWrapper;
-    pSentTimeListNode->pData = pWrapper;
-    pPacketSeqListNode->pOtherListNode = pRetransmitTimeListNode;
-    pPacketSeqListNode->pOtherListNode2 = pSentTimeListNode;
-    pRetransmitTimeListNode->pOtherListNode = pPacketSeqListNode;
-    pRetransmitTimeListNode->pOtherListNode2 = pSentTimeListNode;
-    pSentTimeListNode->pOtherListNode = pPacketSeqListNode;
-    pSentTimeListNode->pOtherListNode2 = pRetransmitTimeListNode;
+    return pWrapper->getLastIOTime() + pWrapper->getRetransmitTimeout();
+}
 
+inline int UnacknowledgedPacketQueue::insertEntry (PacketWrapper *pWrapper)
+{
+    Entry *pEntry = new Entry (pWrapper);
 
     _m.lock();
 
-    if (insertIntoListFromEnd (&_packetSeqList, pPacketSeqListNode)) {
+    if (addToRing (pEntry)) {
         _m.unlock();
+        delete pEntry;
         return -2;
     }
 
-    if (insertIntoListFromEnd (&_retransmitTimeList, pRetransmitTimeListNode)) {
+    if (addToHeap (pEntry)) {
+        removeFromRing (pEntry);
         _m.unlock();
+        delete pEntry;
         return -3;
     }
 
-    // Insert into _sentTimeList: always insert at the end
-    if (_sentTimeList.pFirstNode == nullptr) {
-        // There are no other elements - just insert at the beginning
-        _sentTimeList.pFirstNode = _sentTimeList.pLastNode = pSentTimeListNode;
-    }
-    else {
-        // Insert at the end
-        pSentTimeListNode->pPrev = _sentTimeList.pLastNode;
-        _sentTimeList.pLastNode->pNext = pSentTimeListNode;
-        _sentTimeList.pLastNode = pSentTimeListNode;
-    }
+    // Insert into the sent time list: always insert at the end
+    appendToSentTimeList (pEntry);
 
     _ui32PacketsInQueue++;
     _ui32BytesInQueue += pWrapper->getPacket()->getPacketSize();
@@ -714,232 +602,313 @@ inline int UnacknowledgedPacketQueue::insertIntoLists (PacketWrapper *pWrapper)
     return 0;
 }
 
-inline int UnacknowledgedPacketQueue::insertIntoList (List *pList, Node *pNewNode)
+inline void UnacknowledgedPacketQueue::deleteEntry (Entry *pEntry)
 {
-    if (pList->pFirstNode == nullptr) {
-        // There are no other elements - just insert at the beginning
-        pList->pFirstNode = pList->pLastNode = pNewNode;
-        return 0;
-    }
-    else if ((*pNewNode) < (*(pList->pFirstNode))) {
-        // Need to insert this new packet at the head of the list
-        pNewNode->pNext = pList->pFirstNode;
-        pList->pFirstNode->pPrev = pNewNode;
-        pList->pFirstNode = pNewNode;
-        return 0;
+    _ui32PacketsInQueue--;
+    removeFromRing (pEntry);
+    removeFromHeap (pEntry);
+    removeFromSentTimeList (pEntry);
+    _ui32BytesInQueue -= pEntry->pData->getPacket()->getPacketSize();
+    delete pEntry->pData->getPacket();
+    delete pEntry->pData;
+    delete pEntry;
+}
+
+inline void UnacknowledgedPacketQueue::updateMinAckTime (Entry *pEntry, int64 i64CurrTime)
+{
+    // Compute the acknowledgement time and update MinAckTime if appropriate
+    if (pEntry->pData->getRetransmitCount() == 0) {
+        uint32 ui32AckTime = (uint32) (i64CurrTime - pEntry->pData->getLastIOTime());
+        if (ui32AckTime < _ui32MinAckTime) {
+            _ui32MinAckTime = ui32AckTime;
+        }
     }
-    else {
-        // Find the right spot to insert the new node
-        Node *pTempNode = pList->pFirstNode->pNext;
-        while (pTempNode != nullptr) {
-            if ((*pTempNode) < (*pNewNode)) {
-                // Have not found the right place yet - continue
-                pTempNode = pTempNode->pNext;
-            }
-            else {
-                // Need to insert before pTempNode
-                pNewNode->pNext = pTempNode;
-                pNewNode->pPrev = pTempNode->pPrev;
-                pTempNode->pPrev->pNext = pNewNode;
-                pTempNode->pPrev = pNewNode;
-                return 0;
+}
+
+inline int UnacknowledgedPacketQueue::expireLostPackets (Entry *pEntry)
+{
+    // All the packets that were sent before the packet that has been acknowledged are considered lost
+    int iExpiredPackets = 0;
+    Entry *pTempEntry = _pFirstSent;
+    while ((pTempEntry != nullptr) && (pTempEntry != pEntry)) {
+        // Mark this packet for retransmission (i.e. expire the retransmission timeout)
+        // Only if it has not been marked already
+        if (pTempEntry->pData->getRetransmitTimeout() != 0) {
+            if (NOMADSUtil::pLogger) {
+                NOMADSUtil::pLogger->logMsg ("UnacknowledgedPacketQueue::expireLostPackets", NOMADSUtil::Logger::L_MediumDetailDebug,
+                                             "Expire retransmission timeout of packet %d\n", pTempEntry->pData->getSequenceNum());
             }
+            pTempEntry->pData->setRetransmitTimeout (0);
+            updateRetransmitTime (pTempEntry, computeRetransmitTime (pTempEntry->pData));
+            iExpiredPackets++;
         }
-        // Need to insert the node at the end
-        pNewNode->pPrev = pList->pLastNode;
-        pNewNode->pNext = nullptr;
-        pList->pLastNode->pNext = pNewNode;
-        pList->pLastNode = pNewNode;
-        return 0;
+        pTempEntry = pTempEntry->pNextSent;
     }
+    return iExpiredPackets;
 }
-inline int UnacknowledgedPacketQueue::insertIntoListFromEnd (List *pList, Node *pNewNode)
+
+inline UnacknowledgedPacketQueue::Entry * UnacknowledgedPacketQueue::lookup (uint32 ui32SequenceNum)
 {
-    if (pList->pLastNode == nullptr) {
-        // There are no other elements - just insert at the end (which is also the beginning)
-        pList->pFirstNode = pList->pLastNode = pNewNode;
-        return 0;
+    if ((_ui32PacketsInQueue == 0) || ((ui32SequenceNum - _ui32FirstSeqNum) > (_ui32LastSeqNum - _ui32FirstSeqNum))) {
+        return nullptr;
     }
-    else if ((*(pList->pLastNode)) < (*pNewNode)) {
-        // Need to insert this new packet at the tail of the list
-        pNewNode->pPrev = pList->pLastNode;
-        pList->pLastNode->pNext = pNewNode;
-        pList->pLastNode = pNewNode;
-        return 0;
+    Entry *pEntry = _ppRing[ui32SequenceNum & (_ui32RingSize - 1)];
+    if ((pEntry != nullptr) && (pEntry->pData->getSequenceNum() == ui32SequenceNum)) {
+        return pEntry;
     }
-    else {
-        // Find the right spot to insert the new node
-        Node *pTempNode = pList->pLastNode->pPrev;
-        while (pTempNode != nullptr) {
-            if ((*pNewNode) < (*pTempNode)) {
-                // Have not found the right place yet - continue
-                pTempNode = pTempNode->pPrev;
-            }
-            else {
-                // Need to insert after pTempNode
-                pNewNode->pPrev = pTempNode;
-                pNewNode->pNext = pTempNode->pNext;
-                pTempNode->pNext->pPrev = pNewNode;
-                pTempNode->pNext = pNewNode;
-                return 0;
+    return nullptr;
+}
+
+inline int UnacknowledgedPacketQueue::addToRing (Entry *pEntry)
+{
+    uint32 ui32SequenceNum = pEntry->pData->getSequenceNum();
+    uint32 ui32FirstSeqNum = ui32SequenceNum;
+    uint32 ui32LastSeqNum = ui32SequenceNum;
+    if (_ui32PacketsInQueue > 0) {
+        ui32FirstSeqNum = _ui32FirstSeqNum;
+        ui32LastSeqNum = _ui32LastSeqNum;
+        if (NOMADSUtil::SequentialArithmetic::lessThan (ui32SequenceNum, ui32FirstSeqNum)) {
+            ui32FirstSeqNum = ui32SequenceNum;
+        }
+        else if (NOMADSUtil::SequentialArithmetic::greaterThan (ui32SequenceNum, ui32LastSeqNum)) {
+            ui32LastSeqNum = ui32SequenceNum;
+        }
+        else if (lookup (ui32SequenceNum) != nullptr) {
+            if (NOMADSUtil::pLogger) {
+                NOMADSUtil::pLogger->logMsg ("UnacknowledgedPacketQueue::addToRing", NOMADSUtil::Logger::L_MildError,
+                                             "packet with sequence number %u is already in the queue\n", ui32SequenceNum);
             }
+            return -1;
         }
-        // Need to insert the node at the beginning
-        pNewNode->pNext = pList->pFirstNode;
-        pList->pFirstNode->pPrev = pNewNode;
-        pList->pFirstNode = pNewNode;
-        return 0;
     }
+    uint32 ui32Span = ui32LastSeqNum - ui32FirstSeqNum + 1;
+    if ((ui32Span > _ui32RingSize) && (growRing (ui32Span))) {
+        return -2;
+    }
+    _ppRing[ui32SequenceNum & (_ui32RingSize - 1)] = pEntry;
+    _ui32FirstSeqNum = ui32FirstSeqNum;
+    _ui32LastSeqNum = ui32LastSeqNum;
+    return 0;
 }
 
-inline int UnacknowledgedPacketQueue::removeFromList (List *pList, Node *pNode)
+inline void UnacknowledgedPacketQueue::removeFromRing (Entry *pEntry)
 {
-    if (pList->pFirstNode == nullptr) {
-        // There are no elements in the list
+    uint32 ui32SequenceNum = pEntry->pData->getSequenceNum();
+    const uint32 ui32Mask = _ui32RingSize - 1;
+    _ppRing[ui32SequenceNum & ui32Mask] = nullptr;
+    if (_ui32FirstSeqNum == _ui32LastSeqNum) {
+        // This was the only packet in the queue
+        return;
+    }
+    // There is at least one more packet in the queue, so the loops below terminate
+    if (ui32SequenceNum == _ui32FirstSeqNum) {
+        do {
+            _ui32FirstSeqNum++;
+        } while (_ppRing[_ui32FirstSeqNum & ui32Mask] == nullptr);
+    }
+    else if (ui32SequenceNum == _ui32LastSeqNum) {
+        do {
+            _ui32LastSeqNum--;
+        } while (_ppRing[_ui32LastSeqNum & ui32Mask] == nullptr);
+    }
+}
+
+inline int UnacknowledgedPacketQueue::growRing (uint32 ui32MinSize)
+{
+    uint32 ui32NewSize = (_ui32RingSize > 0) ? _ui32RingSize : INITIAL_RING_SIZE;
+    while ((ui32NewSize < ui32MinSize) && (ui32NewSize <= MAXIMUM_RING_SIZE)) {
+        ui32NewSize *= 2;
+    }
+    if (ui32NewSize > MAXIMUM_RING_SIZE) {
+        if (NOMADSUtil::pLogger) {
+            NOMADSUtil::pLogger->logMsg ("UnacknowledgedPacketQueue::growRing", NOMADSUtil::Logger::L_MildError,
+                                         "the span of sequence numbers in the queue (%u) exceeds the maximum of %u\n",
+                                         ui32MinSize, MAXIMUM_RING_SIZE);
+        }
         return -1;
     }
-    else if (pList->pFirstNode == pNode) {
-        // Removing the first element in the list
-        if (pList->pLastNode == pNode) {
-            // This was also the only element in the list
-            pList->pFirstNode = pList->pLastNode = nullptr;
+    Entry **ppNewRing = (Entry**) calloc (ui32NewSize, sizeof (Entry*));
+    if (ppNewRing == nullptr) {
+        return -2;
+    }
+    for (uint32 ui32 = 0; ui32 < _ui32RingSize; ui32++) {
+        if (_ppRing[ui32] != nullptr) {
+            ppNewRing[_ppRing[ui32]->pData->getSequenceNum() & (ui32NewSize - 1)] = _ppRing[ui32];
+        }
+    }
+    free (_ppRing);
+    _ppRing = ppNewRing;
+    _ui32RingSize = ui32NewSize;
+    return 0;
+}
+
+inline int UnacknowledgedPacketQueue::addToHeap (Entry *pEntry)
+{
+    if (_ui32PacketsInQueue == _ui32HeapSize) {
+        uint32 ui32NewSize = (_ui32HeapSize > 0) ? (_ui32HeapSize * 2) : INITIAL_HEAP_SIZE;
+        Entry **ppNewHeap = (Entry**) realloc (_ppHeap, ui32NewSize * sizeof (Entry*));
+        if (ppNewHeap == nullptr) {
+            return -1;
+        }
+        _ppHeap = ppNewHeap;
+        _ui32HeapSize = ui32NewSize;
+    }
+    // NOTE: _ui32PacketsInQueue is incremented by the caller
+    pEntry->ui32HeapIndex = _ui32PacketsInQueue;
+    _ppHeap[_ui32PacketsInQueue] = pEntry;
+    siftUp (_ui32PacketsInQueue);
+    return 0;
+}
+
+inline void UnacknowledgedPacketQueue::removeFromHeap (Entry *pEntry)
+{
+    // NOTE: _ui32PacketsInQueue must have already been decremented by the caller,
+    //       so it is the index of the last entry in the heap
+    uint32 ui32Index = pEntry->ui32HeapIndex;
+    uint32 ui32LastIndex = _ui32PacketsInQueue;
+    if (ui32Index != ui32LastIndex) {
+        // Move the last entry into the hole and restore the heap property
+        _ppHeap[ui32Index] = _ppHeap[ui32LastIndex];
+        _ppHeap[ui32Index]->ui32HeapIndex = ui32Index;
+        if ((ui32Index > 0) && precedes (_ppHeap[ui32Index], _ppHeap[(ui32Index - 1) / 2])) {
+            siftUp (ui32Index);
         }
         else {
-            pList->pFirstNode = pList->pFirstNode->pNext;
-            pList->pFirstNode->pPrev = nullptr;
+            siftDown (ui32Index);
         }
     }
-    else if (pList->pLastNode == pNode) {
-        // Removing the last element in the list
-        pList->pLastNode = pNode->pPrev;
-        pNode->pPrev->pNext = nullptr;
+    _ppHeap[ui32LastIndex] = nullptr;
+}
+
+inline void UnacknowledgedPacketQueue::updateRetransmitTime (Entry *pEntry, int64 i64RetransmitTime)
+{
+    int64 i64OldRetransmitTime = pEntry->i64RetransmitTime;
+    pEntry->i64RetransmitTime = i64RetransmitTime;
+    if (i64RetransmitTime < i64OldRetransmitTime) {
+        siftUp (pEntry->ui32HeapIndex);
     }
     else {
-        // Removing a non-boundary element in the list
-        pNode->pPrev->pNext = pNode->pNext;
-        pNode->pNext->pPrev = pNode->pPrev;
+        siftDown (pEntry->ui32HeapIndex);
     }
-    delete pNode;
-    return 0;
 }
 
-inline int UnacknowledgedPacketQueue::expireLostPackets (Node *pNode)
+inline void UnacknowledgedPacketQueue::moveToHeadOfHeap (Entry *pEntry)
 {
-    //if (NOMADSUtil::pLogger) {
-    //    NOMADSUtil::pLogger->logMsg ("UnacknowledgedPacketQueue::expireLostPackets", NOMADSUtil::Logger::L_MediumDetailDebug,
-    //                                 "removing %d\n", pNode->pData->getSequenceNum());
-    //}
-    _m.lock();
-    if ((_sentTimeList.pFirstNode == nullptr) || (_sentTimeList.pFirstNode->pData->getSequenceNum() == pNode->pData->getSequenceNum())) {
-        // There are no elements in the list or the element is the first one
-        //if (NOMADSUtil::pLogger) {
-        //    NOMADSUtil::pLogger->logMsg ("UnacknowledgedPacketQueue::expireLostPackets", NOMADSUtil::Logger::L_MediumDetailDebug,
-        //                                 "no lost packets to expire\n");
-        //}
-        _m.unlock();
-        return 0;
+    int64 i64RetransmitTime = computeRetransmitTime (pEntry->pData);
+    Entry *pHead = _ppHeap[0];
+    if ((pHead != pEntry) && (pHead->i64RetransmitTime <= i64RetransmitTime)) {
+        // Make sure that the packet goes ahead of the one currently at the head of the heap
+        i64RetransmitTime = pHead->i64RetransmitTime - 1;
     }
+    updateRetransmitTime (pEntry, i64RetransmitTime);
+}
 
-    int iExpiredPackets = 0;
-    // Cycle from the head of the list because if we did not exit with the first
-    // 'if' we need to expire the timeout of the head of the queue
-    Node *pTempSentTimeListNode = _sentTimeList.pFirstNode;
-    while (pTempSentTimeListNode != nullptr) {
-        if (pTempSentTimeListNode != pNode) {
-            // Mark this node for retransmission (i.e. expire the retransmission timeout)
-            // Only if it has not been marked already
-            if (pTempSentTimeListNode->pData->getRetransmitTimeout() != 0) {
-                if (NOMADSUtil::pLogger) {
-                    NOMADSUtil::pLogger->logMsg ("UnacknowledgedPacketQueue::expireLostPackets", NOMADSUtil::Logger::L_MediumDetailDebug,
-                                                 "Expire retransmission timeout of packet %d\n", pTempSentTimeListNode->pData->getSequenceNum());
-                }
-                pTempSentTimeListNode->pData->setRetransmitTimeout (0);
-                iExpiredPackets++;
-
-                // Reorder _retransmitTimeList
-                // Find the node and remove it from its current location
-                Node *pRetransmitTimeListNode = pTempSentTimeListNode->pOtherListNode2;
-                Node *pTempNode = _retransmitTimeList.pFirstNode;
-                if (pTempNode == pRetransmitTimeListNode) {
-                    if (_retransmitTimeList.pLastNode == pRetransmitTimeListNode) {
-                        // nothing to do
-                        _m.unlock();
-                        return 0;
-                    }
-                    _retransmitTimeList.pFirstNode = pRetransmitTimeListNode->pNext;
-                    _retransmitTimeList.pFirstNode->pPrev = nullptr;
-                }
-                else {
-                    pTempNode = pTempNode->pNext;
-                    while (pTempNode != nullptr) {
-                        if (pTempNode == pRetransmitTimeListNode) {
-                            // Found the node to be reordered
-                            if (_retransmitTimeList.pLastNode == pRetransmitTimeListNode) {
-                                pTempNode->pPrev->pNext = nullptr;
-                                _retransmitTimeList.pLastNode = pTempNode->pPrev;
-                            }
-                            else {
-                                pTempNode->pPrev->pNext = pTempNode->pNext;
-                                pTempNode->pNext->pPrev = pTempNode->pPrev;
-                            }
-                            pTempNode->pPrev = nullptr;
-                            pTempNode->pNext = nullptr;
-                            break;
-                        }
-                        pTempNode = pTempNode->pNext;
-                    }
-                }
-                // Reinsert in the correct order
-                insertIntoList (&_retransmitTimeList, pRetransmitTimeListNode);
-            }
+inline void UnacknowledgedPacketQueue::compactHeap (uint32 ui32HeapCount)
+{
+    // Deletes the entries whose packets have been removed (pData set to nullptr) and
+    // rebuilds the heap with the remaining _ui32PacketsInQueue entries
+    uint32 ui32NewIndex = 0;
+    for (uint32 ui32 = 0; ui32 < ui32HeapCount; ui32++) {
+        Entry *pEntry = _ppHeap[ui32];
+        _ppHeap[ui32] = nullptr;
+        if (pEntry->pData == nullptr) {
+            delete pEntry;
         }
         else {
-            break;
+            pEntry->ui32HeapIndex = ui32NewIndex;
+            _ppHeap[ui32NewIndex++] = pEntry;
         }
-        pTempSentTimeListNode = pTempSentTimeListNode->pNext;
     }
-
-    _m.unlock();
-    return iExpiredPackets;
+    for (uint32 ui32 = _ui32PacketsInQueue / 2; ui32 > 0; ui32--) {
+        siftDown (ui32 - 1);
+    }
 }
 
-inline UnacknowledgedPacketQueue::Node::Node (void)
+inline void UnacknowledgedPacketQueue::siftUp (uint32 ui32Index)
 {
-    pPrev = nullptr;
-    pNext = nullptr;
-    pOtherListNode = nullptr;
-    pOtherListNode2 = nullptr;
-    pData = nullptr;
+    Entry *pEntry = _ppHeap[ui32Index];
+    while (ui32Index > 0) {
+        uint32 ui32ParentIndex = (ui32Index - 1) / 2;
+        if (!precedes (pEntry, _ppHeap[ui32ParentIndex])) {
+            break;
+        }
+        _ppHeap[ui32Index] = _ppHeap[ui32ParentIndex];
+        _ppHeap[ui32Index]->ui32HeapIndex = ui32Index;
+        ui32Index = ui32ParentIndex;
+    }
+    _ppHeap[ui32Index] = pEntry;
+    pEntry->ui32HeapIndex = ui32Index;
 }
 
-inline bool UnacknowledgedPacketQueue::PacketSeqListNode::operator < (const Node &rhsNode)
+inline void UnacknowledgedPacketQueue::siftDown (uint32 ui32Index)
 {
-    return NOMADSUtil::SequentialArithmetic::lessThan (pData->getPacket()->getSequenceNum(), rhsNode.pData->getPacket()->getSequenceNum());
+    Entry *pEntry = _ppHeap[ui32Index];
+    while (true) {
+        uint32 ui32ChildIndex = (2 * ui32Index) + 1;
+        if (ui32ChildIndex >= _ui32PacketsInQueue) {
+            break;
+        }
+        if (((ui32ChildIndex + 1) < _ui32PacketsInQueue) && precedes (_ppHeap[ui32ChildIndex + 1], _ppHeap[ui32ChildIndex])) {
+            ui32ChildIndex++;
+        }
+        if (!precedes (_ppHeap[ui32ChildIndex], pEntry)) {
+            break;
+        }
+        _ppHeap[ui32Index] = _ppHeap[ui32ChildIndex];
+        _ppHeap[ui32Index]->ui32HeapIndex = ui32Index;
+        ui32Index = ui32ChildIndex;
+    }
+    _ppHeap[ui32Index] = pEntry;
+    pEntry->ui32HeapIndex = ui32Index;
 }
 
-inline bool UnacknowledgedPacketQueue::RetransmitTimeListNode::operator < (const Node &rhsNode)
+inline bool UnacknowledgedPacketQueue::precedes (const Entry *pLHS, const Entry *pRHS)
 {
-    int64 i64LHSTime = pData->getLastIOTime() + pData->getRetransmitTimeout();
-    int64 i64RHSTime = rhsNode.pData->getLastIOTime() + rhsNode.pData->getRetransmitTimeout();
-    if (i64LHSTime == i64RHSTime) {
+    if (pLHS->i64RetransmitTime == pRHS->i64RetransmitTime) {
         // Break the tie via the sequence number
-        return NOMADSUtil::SequentialArithmetic::lessThan (pData->getPacket()->getSequenceNum(), rhsNode.pData->getPacket()->getSequenceNum());
+        return NOMADSUtil::SequentialArithmetic::lessThan (pLHS->pData->getSequenceNum(), pRHS->pData->getSequenceNum());
+    }
+    return pLHS->i64RetransmitTime < pRHS->i64RetransmitTime;
+}
+
+inline void UnacknowledgedPacketQueue::appendToSentTimeList (Entry *pEntry)
+{
+    pEntry->pPrevSent = _pLastSent;
+    pEntry->pNextSent = nullptr;
+    if (_pLastSent == nullptr) {
+        _pFirstSent = pEntry;
     }
     else {
-        return i64LHSTime < i64RHSTime;
+        _pLastSent->pNextSent = pEntry;
     }
+    _pLastSent = pEntry;
 }
 
-inline bool UnacknowledgedPacketQueue::SentTimeListNode::operator < (const Node &rhsNode)
+inline void UnacknowledgedPacketQueue::removeFromSentTimeList (Entry *pEntry)
 {
-    // Not used: we always insert at the end of SentTimeList
-    // NB: the IO time will be the same for a lot of packets because we send many
-    // packets at the same time ordering by sequence number does not make much sense
-    if (pData->getLastIOTime() == rhsNode.pData->getLastIOTime()) {
-        // Break the tie via the sequence number
-        return NOMADSUtil::SequentialArithmetic::lessThan (pData->getPacket()->getSequenceNum(), rhsNode.pData->getPacket()->getSequenceNum());
+    if (pEntry->pPrevSent == nullptr) {
+        _pFirstSent = pEntry->pNextSent;
+    }
+    else {
+        pEntry->pPrevSent->pNextSent = pEntry->pNextSent;
     }
-    return pData->getLastIOTime() < rhsNode.pData->getLastIOTime();
+    if (pEntry->pNextSent == nullptr) {
+        _pLastSent = pEntry->pPrevSent;
+    }
+    else {
+        pEntry->pNextSent->pPrevSent = pEntry->pPrevSent;
+    }
+    pEntry->pPrevSent = nullptr;
+    pEntry->pNextSent = nullptr;
+}
+
+inline UnacknowledgedPacketQueue::Entry::Entry (PacketWrapper *pWrapper)
+{
+    pData = pWrapper;
+    i64RetransmitTime = computeRetransmitTime (pWrapper);
+    ui32HeapIndex = 0;
+    pPrevSent = nullptr;
+    pNextSent = nullptr;
 }
 
 #endif   // #ifndef INCL_UNACKNOWLEDGED_PACKET_QUEUE_H
@@ -26,21 +26,29 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := ACKManager.cpp \
 	BandwidthEstimator.cpp \
+	BBRCongestionController.cpp \
 	CancelledTSNManager.cpp \
 	CongestionController.cpp \
+	CubicCongestionController.cpp \
 	Dtls.cpp	\
 	DTLSCommInterface.cpp	\
 	CommInterface.cpp \
 	DataBuffer.cpp \
+	FECDecoder.cpp \
+	FECEncoder.cpp \
 	MessageSender.cpp \
 	Mocket.cpp \
 	MocketReader.cpp \
 	MocketStatusMonitor.cpp \
 	MocketStatusNotifier.cpp \
+	MocketMultiplexer.cpp \
 	MocketWriter.cpp \
+	MultiplexedCommInterface.cpp \
 	Packet.cpp \
+	PacketPool.cpp \
 	PacketProcessor.cpp \
 	Receiver.cpp \
+	ReedSolomonCode.cpp \
 	ServerMocket.cpp \
 	StateCookie.cpp \
 	StateMachine.cpp \
@@ -44,7 +44,9 @@ public class MocketStatus
         MSF_Undefined,
         MSF_End,
         MSF_OverallMessageStatistics,
-        MSF_PerTypeMessageStatistics
+        MSF_PerTypeMessageStatistics,
+        MSF_PacketPoolStatistics,
+        MSF_CongestionControlStatistics
     };
     
     public static class EndPointsInfo
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Logger.h"
+#include "Mocket.h"
+#include "MessageSender.h"
+#include "MocketStats.h"
+#include "NLFLib.h"
+#include "ServerMocket.h"
+#include "Thread.h"
+
+using namespace NOMADSUtil;
+
+// Transfers a stream of reliable sequenced messages using each of the congestion control
+// mechanisms that can be selected with the UseCongestionControl configuration parameter,
+// checks that the state of the mechanism is exported through MocketStats, and that BBR
+// achieves a throughput comparable to that of CUBIC
+
+static const uint32 NUM_MESSAGES = 5000;
+static const uint32 MESSAGE_SIZE = 1024;
+static const char * CONFIG_FILE = "CongestionControlTest.conf";
+
+// BBR must not be slower than this factor with respect to CUBIC over the loopback interface
+// (a factor and not an exact comparison, to tolerate the noise of a single run)
+static const uint32 MAX_SLOWDOWN_FACTOR = 2;
+
+class Sender : public Thread
+{
+    public:
+        Sender (uint16 ui16ServerPort);
+        void run (void);
+        volatile bool _bFinished;
+        uint32 _ui32CongestionWindowSize;
+        uint32 _ui32PacingRate;
+        uint32 _ui32MinRTT;
+
+    private:
+        uint16 _ui16ServerPort;
+};
+
+Sender::Sender (uint16 ui16ServerPort)
+{
+    _ui16ServerPort = ui16ServerPort;
+    _bFinished = false;
+    _ui32CongestionWindowSize = 0;
+    _ui32PacingRate = 0;
+    _ui32MinRTT = 0;
+}
+
+void Sender::run (void)
+{
+    Mocket mocket (CONFIG_FILE);
+    if (mocket.connect ("127.0.0.1", _ui16ServerPort)) {
+        printf ("Sender::run: failed to connect to server on port %d\n", (int) _ui16ServerPort);
+        _bFinished = true;
+        return;
+    }
+    MessageSender sender = mocket.getSender (true, true);
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    for (uint32 ui32 = 0; ui32 < NUM_MESSAGES; ui32++) {
+        memset (pBuf, (int) (ui32 % 256), MESSAGE_SIZE);
+        sender.send (pBuf, MESSAGE_SIZE);
+    }
+    free (pBuf);
+    _ui32CongestionWindowSize = mocket.getStatistics()->getCongestionWindowSize();
+    _ui32PacingRate = mocket.getStatistics()->getPacingRate();
+    _ui32MinRTT = mocket.getStatistics()->getMinRTT();
+    mocket.close();
+    _bFinished = true;
+}
+
+static int runTransfer (const char *pszCongestionControl, int64 &i64TransferTime)
+{
+    FILE *fileConfig = fopen (CONFIG_FILE, "w");
+    if (fileConfig == nullptr) {
+        printf ("runTransfer: failed to create %s\n", CONFIG_FILE);
+        return -1;
+    }
+    fprintf (fileConfig, "UseCongestionControl=%s\n", pszCongestionControl);
+    fclose (fileConfig);
+
+    ServerMocket serverMocket;
+    int iPort = serverMocket.listen (0);
+    if (iPort <= 0) {
+        printf ("runTransfer: listen failed; rc = %d\n", iPort);
+        return -2;
+    }
+    Sender *pSender = new Sender ((uint16) iPort);
+    pSender->start();
+    Mocket *pMocket = serverMocket.accept();
+    if (pMocket == nullptr) {
+        printf ("runTransfer: accept failed\n");
+        return -3;
+    }
+
+    int64 i64StartTime = getTimeInMilliseconds();
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    uint32 ui32Received = 0;
+    while (ui32Received < NUM_MESSAGES) {
+        if (pMocket->receive (pBuf, MESSAGE_SIZE, 10000) != (int) MESSAGE_SIZE) {
+            break;
+        }
+        if (((uint8) pBuf[0]) != (ui32Received % 256)) {
+            printf ("runTransfer: message %u is corrupted\n", ui32Received);
+            break;
+        }
+        ui32Received++;
+    }
+    free (pBuf);
+    int64 i64Time = getTimeInMilliseconds() - i64StartTime;
+    i64TransferTime = i64Time;
+
+    while (!pSender->_bFinished) {
+        sleepForMilliseconds (100);
+    }
+    printf ("%s: received %u out of %u messages in %d ms; congestion window %u bytes; pacing rate %u B/s; min RTT %u ms\n",
+            pszCongestionControl, ui32Received, NUM_MESSAGES, (int) i64Time,
+            pSender->_ui32CongestionWindowSize, pSender->_ui32PacingRate, pSender->_ui32MinRTT);
+    bool bStateExported = (pSender->_ui32CongestionWindowSize != 0) && (pSender->_ui32PacingRate != 0);
+    delete pSender;
+    pMocket->close();
+    delete pMocket;
+    serverMocket.close();
+
+    if (ui32Received != NUM_MESSAGES) {
+        return -4;
+    }
+    if (!bStateExported) {
+        printf ("runTransfer: the state of %s was not exported\n", pszCongestionControl);
+        return -5;
+    }
+    return 0;
+}
+
+int main (int argc, char *argv[])
+{
+    pLogger = new Logger();
+    pLogger->initLogFile ("CongestionControlTest.log");
+    pLogger->setDebugLevel (Logger::L_Warning);
+    pLogger->disableScreenOutput();
+
+    static const char * CONGESTION_CONTROLS[] = {"BBRCongestionController", "CubicCongestionController"};
+    int64 i64TransferTimes[2] = {0, 0};
+    int rc = 0;
+    for (uint8 ui8 = 0; ui8 < (sizeof (CONGESTION_CONTROLS) / sizeof (CONGESTION_CONTROLS[0])); ui8++) {
+        int rcTransfer = runTransfer (CONGESTION_CONTROLS[ui8], i64TransferTimes[ui8]);
+        if (rcTransfer != 0) {
+            printf ("main: transfer with %s failed; rc = %d\n", CONGESTION_CONTROLS[ui8], rcTransfer);
+            rc = -1;
+        }
+    }
+    if ((rc == 0) && (i64TransferTimes[0] > (i64TransferTimes[1] * MAX_SLOWDOWN_FACTOR))) {
+        printf ("main: the transfer with %s took %d ms, more than %u times the %d ms taken by %s\n",
+                CONGESTION_CONTROLS[0], (int) i64TransferTimes[0], MAX_SLOWDOWN_FACTOR,
+                (int) i64TransferTimes[1], CONGESTION_CONTROLS[1]);
+        rc = -2;
+    }
+    remove (CONFIG_FILE);
+
+    delete pLogger;
+    pLogger = nullptr;
+
+    return rc;
+}
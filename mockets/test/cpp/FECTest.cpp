@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "delaysimulator/wnetemu.h"
+
+#include "Logger.h"
+#include "Mocket.h"
+#include "MessageSender.h"
+#include "NLFLib.h"
+#include "ServerMocket.h"
+#include "Thread.h"
+#include "UDPCommInterface.h"
+#include "UDPDatagramSocket.h"
+
+using namespace NOMADSUtil;
+
+// Transfers a stream of unreliable sequenced messages over a lossy channel without FEC, with a
+// fixed number of FEC repair packets, and with adaptive FEC, and checks that the lost packets are
+// rebuilt by the receiver without retransmissions
+// The loss is simulated by the CommInterface of the sender with the same channel parameters used
+// by the netem based delay simulator, so that the test does not need root privileges
+
+static const uint32 NUM_MESSAGES = 2000;
+static const uint32 MESSAGE_SIZE = 512;
+static const uint32 TEN_PERCENT = 429496730;        // Random packet loss (0=none ~0=100%), as in delaysimulator
+static const char * CONFIG_FILE = "FECTest.conf";
+
+// Drops the datagrams sent through it according to the loss rate in the channel state
+// The loss is enabled only after the connection has been established
+class LossyCommInterface : public UDPCommInterface
+{
+    public:
+        LossyCommInterface (const channel_state_info_t *pChannelState);
+
+        CommInterface * newInstance (void);
+
+        int sendTo (InetAddr *pRemoteAddr, const void *pBuf, int iBufSize, const char *pszHints = nullptr);
+
+        // Send all the datagrams one at a time, through sendTo()
+        bool isBatchIOSupported (void);
+
+        void enableLoss (bool bEnable);
+        uint32 getDroppedCount (void);
+
+    private:
+        channel_state_info_t _channelState;
+        volatile bool _bLossEnabled;
+        uint32 _ui32Seed;
+        uint32 _ui32Dropped;
+};
+
+LossyCommInterface::LossyCommInterface (const channel_state_info_t *pChannelState)
+    : UDPCommInterface (new UDPDatagramSocket(), true)
+{
+    _channelState = *pChannelState;
+    _bLossEnabled = false;
+    _ui32Seed = 12345;      // Fixed seed, so that every run loses the same packets
+    _ui32Dropped = 0;
+}
+
+CommInterface * LossyCommInterface::newInstance (void)
+{
+    return new LossyCommInterface (&_channelState);
+}
+
+int LossyCommInterface::sendTo (InetAddr *pRemoteAddr, const void *pBuf, int iBufSize, const char *pszHints)
+{
+    if (_bLossEnabled) {
+        _ui32Seed = (_ui32Seed * 1664525) + 1013904223;
+        if (_ui32Seed < _channelState.loss_rate) {
+            // Pretend that the datagram was sent
+            _ui32Dropped++;
+            return iBufSize;
+        }
+    }
+    return UDPCommInterface::sendTo (pRemoteAddr, pBuf, iBufSize, pszHints);
+}
+
+bool LossyCommInterface::isBatchIOSupported (void)
+{
+    return false;
+}
+
+void LossyCommInterface::enableLoss (bool bEnable)
+{
+    _bLossEnabled = bEnable;
+}
+
+uint32 LossyCommInterface::getDroppedCount (void)
+{
+    return _ui32Dropped;
+}
+
+class Sender : public Thread
+{
+    public:
+        Sender (uint16 ui16ServerPort, const channel_state_info_t *pChannelState);
+        void run (void);
+        volatile bool _bFinished;
+        uint32 _ui32Dropped;
+        uint32 _ui32SentRepairPackets;
+
+    private:
+        uint16 _ui16ServerPort;
+        const channel_state_info_t *_pChannelState;
+};
+
+Sender::Sender (uint16 ui16ServerPort, const channel_state_info_t *pChannelState)
+{
+    _ui16ServerPort = ui16ServerPort;
+    _pChannelState = pChannelState;
+    _bFinished = false;
+    _ui32Dropped = 0;
+    _ui32SentRepairPackets = 0;
+}
+
+void Sender::run (void)
+{
+    LossyCommInterface *pCI = new LossyCommInterface (_pChannelState);
+    Mocket mocket (CONFIG_FILE, pCI, true);
+    if (mocket.connect ("127.0.0.1", _ui16ServerPort)) {
+        printf ("Sender::run: failed to connect to server on port %d\n", (int) _ui16ServerPort);
+        _bFinished = true;
+        return;
+    }
+    pCI->enableLoss (true);
+    MessageSender sender = mocket.getSender (false, true);
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    for (uint32 ui32 = 0; ui32 < NUM_MESSAGES; ui32++) {
+        memset (pBuf, (int) (ui32 % 256), MESSAGE_SIZE);
+        memcpy (pBuf, &ui32, sizeof (uint32));
+        sender.send (pBuf, MESSAGE_SIZE);
+        if ((ui32 % 10) == 9) {
+            // Do not overflow the socket buffers, which would add to the simulated loss
+            sleepForMilliseconds (1);
+        }
+    }
+    free (pBuf);
+    // Give the transmitter the time to send the repair packets of the last block
+    sleepForMilliseconds (500);
+    pCI->enableLoss (false);
+    _ui32Dropped = pCI->getDroppedCount();
+    _ui32SentRepairPackets = mocket.getStatistics()->getSentFECRepairPacketCount();
+    mocket.close();
+    _bFinished = true;
+}
+
+static int runTransfer (const char *pszDescription, const char *pszFECOptions, uint32 *pui32Received, uint32 *pui32SentRepairPackets)
+{
+    FILE *fileConfig = fopen (CONFIG_FILE, "w");
+    if (fileConfig == nullptr) {
+        printf ("runTransfer: failed to create %s\n", CONFIG_FILE);
+        return -1;
+    }
+    fprintf (fileConfig, "%s", pszFECOptions);
+    fclose (fileConfig);
+
+    channel_state_info_t channelState;
+    memset (&channelState, 0, sizeof (channelState));
+    channelState.loss_rate = TEN_PERCENT;
+
+    ServerMocket serverMocket;
+    int iPort = serverMocket.listen (0);
+    if (iPort <= 0) {
+        printf ("runTransfer: listen failed; rc = %d\n", iPort);
+        return -2;
+    }
+    Sender *pSender = new Sender ((uint16) iPort, &channelState);
+    pSender->start();
+    Mocket *pMocket = serverMocket.accept();
+    if (pMocket == nullptr) {
+        printf ("runTransfer: accept failed\n");
+        return -3;
+    }
+
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    uint32 ui32Received = 0;
+    uint32 ui32LastIndex = 0;
+    bool bCorrupted = false;
+    while (true) {
+        int rc = pMocket->receive (pBuf, MESSAGE_SIZE, 5000);
+        if (rc <= 0) {
+            break;
+        }
+        uint32 ui32Index;
+        memcpy (&ui32Index, pBuf, sizeof (uint32));
+        if ((rc != (int) MESSAGE_SIZE) || (ui32Index >= NUM_MESSAGES) || ((ui32Received > 0) && (ui32Index <= ui32LastIndex)) ||
+            (((uint8) pBuf[MESSAGE_SIZE - 1]) != (ui32Index % 256))) {
+            printf ("runTransfer: message %u is corrupted or out of order\n", ui32Received);
+            bCorrupted = true;
+            break;
+        }
+        ui32LastIndex = ui32Index;
+        ui32Received++;
+    }
+    free (pBuf);
+
+    while (!pSender->_bFinished) {
+        sleepForMilliseconds (100);
+    }
+    MocketStats *pStats = pMocket->getStatistics();
+    printf ("%s: received %u out of %u messages; %u packets dropped; %u repair packets sent; %u packets rebuilt; %u packets not rebuilt\n",
+            pszDescription, ui32Received, NUM_MESSAGES, pSender->_ui32Dropped, pSender->_ui32SentRepairPackets,
+            pStats->getFECRecoveredPacketCount(), pStats->getFECUnrecoveredPacketCount());
+    *pui32Received = ui32Received;
+    *pui32SentRepairPackets = pSender->_ui32SentRepairPackets;
+    uint32 ui32Recovered = pStats->getFECRecoveredPacketCount();
+    bool bUsingFEC = (pSender->_ui32SentRepairPackets > 0);
+    delete pSender;
+    pMocket->close();
+    delete pMocket;
+    serverMocket.close();
+
+    if (bCorrupted) {
+        return -4;
+    }
+    if ((strlen (pszFECOptions) > 0) && ((!bUsingFEC) || (ui32Recovered == 0))) {
+        printf ("runTransfer: no packets were rebuilt\n");
+        return -5;
+    }
+    return 0;
+}
+
+int main (int argc, char *argv[])
+{
+    pLogger = new Logger();
+    pLogger->initLogFile ("FECTest.log");
+    pLogger->setDebugLevel (Logger::L_Warning);
+    pLogger->disableScreenOutput();
+
+    int rc = 0;
+    int rcTransfer;
+    uint32 ui32ReceivedWithoutFEC = 0;
+    uint32 ui32ReceivedWithFEC = 0;
+    uint32 ui32ReceivedWithAdaptiveFEC = 0;
+    uint32 ui32RepairPackets = 0;
+    uint32 ui32AdaptiveRepairPackets = 0;
+    if (0 != (rcTransfer = runTransfer ("No FEC", "", &ui32ReceivedWithoutFEC, &ui32RepairPackets))) {
+        printf ("main: transfer without FEC failed; rc = %d\n", rcTransfer);
+        rc = -1;
+    }
+    if (0 != (rcTransfer = runTransfer ("FEC 8+2", "UseForwardErrorCorrection=true\nFECSourcePackets=8\nFECRepairPackets=2\n",
+                                        &ui32ReceivedWithFEC, &ui32RepairPackets))) {
+        printf ("main: transfer with FEC failed; rc = %d\n", rcTransfer);
+        rc = -1;
+    }
+    // Starts with a single repair packet per block, which is not enough for a 10% loss rate
+    if (0 != (rcTransfer = runTransfer ("Adaptive FEC", "UseForwardErrorCorrection=true\nFECSourcePackets=8\nFECRepairPackets=1\nUseAdaptiveFEC=true\n",
+                                        &ui32ReceivedWithAdaptiveFEC, &ui32AdaptiveRepairPackets))) {
+        printf ("main: transfer with adaptive FEC failed; rc = %d\n", rcTransfer);
+        rc = -1;
+    }
+    remove (CONFIG_FILE);
+
+    // Without FEC about 10% of the messages are lost; with FEC most of them must be rebuilt
+    if ((ui32ReceivedWithFEC < (NUM_MESSAGES * 97 / 100)) || (ui32ReceivedWithFEC <= ui32ReceivedWithoutFEC)) {
+        printf ("main: FEC did not rebuild enough packets\n");
+        rc = -1;
+    }
+    if ((ui32ReceivedWithAdaptiveFEC < (NUM_MESSAGES * 96 / 100)) || (ui32ReceivedWithAdaptiveFEC <= ui32ReceivedWithoutFEC)) {
+        printf ("main: adaptive FEC did not rebuild enough packets\n");
+        rc = -1;
+    }
+    // The loss feedback must have raised the number of repair packets above one per block
+    if (ui32AdaptiveRepairPackets <= (NUM_MESSAGES / 8)) {
+        printf ("main: adaptive FEC did not increase the number of repair packets\n");
+        rc = -1;
+    }
+
+    delete pLogger;
+    pLogger = nullptr;
+
+    return rc;
+}
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Logger.h"
+#include "Mocket.h"
+#include "MessageSender.h"
+#include "NLFLib.h"
+#include "ServerMocket.h"
+#include "Thread.h"
+
+using namespace NOMADSUtil;
+
+// Transfers a stream of reliable sequenced messages with a transmit rate limit, with and without
+// the UsePacing and UseKernelPacing configuration parameters, and checks that the rate limit is
+// respected and that packets are spread over time instead of being sent in bursts
+
+static const uint32 NUM_MESSAGES = 2000;
+static const uint32 MESSAGE_SIZE = 1024;
+static const uint32 RATE_LIMIT = 1000000;           // Bytes per second
+static const int64 BURST_WINDOW = 10000000;         // Nanoseconds
+static const char * CONFIG_FILE = "PacingTest.conf";
+
+class Sender : public Thread
+{
+    public:
+        Sender (uint16 ui16ServerPort);
+        void run (void);
+        volatile bool _bFinished;
+
+    private:
+        uint16 _ui16ServerPort;
+};
+
+Sender::Sender (uint16 ui16ServerPort)
+{
+    _ui16ServerPort = ui16ServerPort;
+    _bFinished = false;
+}
+
+void Sender::run (void)
+{
+    Mocket mocket (CONFIG_FILE);
+    if (mocket.connect ("127.0.0.1", _ui16ServerPort)) {
+        printf ("Sender::run: failed to connect to server on port %d\n", (int) _ui16ServerPort);
+        _bFinished = true;
+        return;
+    }
+    MessageSender sender = mocket.getSender (true, true);
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    for (uint32 ui32 = 0; ui32 < NUM_MESSAGES; ui32++) {
+        memset (pBuf, (int) (ui32 % 256), MESSAGE_SIZE);
+        sender.send (pBuf, MESSAGE_SIZE);
+    }
+    free (pBuf);
+    mocket.close();
+    _bFinished = true;
+}
+
+// Returns the largest number of messages that were received within BURST_WINDOW nanoseconds
+static uint32 getMaxBurst (int64 *pi64ReceiveTimes, uint32 ui32Count)
+{
+    uint32 ui32MaxBurst = 0;
+    uint32 ui32First = 0;
+    for (uint32 ui32 = 0; ui32 < ui32Count; ui32++) {
+        while ((pi64ReceiveTimes[ui32] - pi64ReceiveTimes[ui32First]) >= BURST_WINDOW) {
+            ui32First++;
+        }
+        if ((ui32 - ui32First + 1) > ui32MaxBurst) {
+            ui32MaxBurst = ui32 - ui32First + 1;
+        }
+    }
+    return ui32MaxBurst;
+}
+
+static int runTransfer (const char *pszDescription, const char *pszPacingOptions, bool bCheckBursts)
+{
+    FILE *fileConfig = fopen (CONFIG_FILE, "w");
+    if (fileConfig == nullptr) {
+        printf ("runTransfer: failed to create %s\n", CONFIG_FILE);
+        return -1;
+    }
+    fprintf (fileConfig, "TransmitRateLimit=%u\n%s", RATE_LIMIT, pszPacingOptions);
+    fclose (fileConfig);
+
+    ServerMocket serverMocket;
+    int iPort = serverMocket.listen (0);
+    if (iPort <= 0) {
+        printf ("runTransfer: listen failed; rc = %d\n", iPort);
+        return -2;
+    }
+    Sender *pSender = new Sender ((uint16) iPort);
+    pSender->start();
+    Mocket *pMocket = serverMocket.accept();
+    if (pMocket == nullptr) {
+        printf ("runTransfer: accept failed\n");
+        return -3;
+    }
+
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    int64 *pi64ReceiveTimes = (int64*) malloc (NUM_MESSAGES * sizeof (int64));
+    uint32 ui32Received = 0;
+    while (ui32Received < NUM_MESSAGES) {
+        if (pMocket->receive (pBuf, MESSAGE_SIZE, 10000) != (int) MESSAGE_SIZE) {
+            break;
+        }
+        pi64ReceiveTimes[ui32Received] = getMonotonicTimeInNanoseconds();
+        if (((uint8) pBuf[0]) != (ui32Received % 256)) {
+            printf ("runTransfer: message %u is corrupted\n", ui32Received);
+            break;
+        }
+        ui32Received++;
+    }
+    free (pBuf);
+
+    // The rate is measured from the first message, since the connection setup is not rate limited
+    uint32 ui32Rate = 0;
+    uint32 ui32MaxBurst = 0;
+    if (ui32Received > 1) {
+        int64 i64Time = pi64ReceiveTimes[ui32Received - 1] - pi64ReceiveTimes[0];
+        if (i64Time > 0) {
+            ui32Rate = (uint32) (((int64) (ui32Received - 1)) * MESSAGE_SIZE * 1000000000 / i64Time);
+        }
+        ui32MaxBurst = getMaxBurst (pi64ReceiveTimes, ui32Received);
+    }
+    free (pi64ReceiveTimes);
+
+    while (!pSender->_bFinished) {
+        sleepForMilliseconds (100);
+    }
+    // Number of messages that would be received in BURST_WINDOW at the rate limit
+    uint32 ui32ExpectedBurst = (uint32) (RATE_LIMIT * (BURST_WINDOW / 1000000) / 1000 / MESSAGE_SIZE) + 1;
+    printf ("%s: received %u out of %u messages at %u B/s (limit %u B/s); at most %u messages in %d ms (%u expected at the limit)\n",
+            pszDescription, ui32Received, NUM_MESSAGES, ui32Rate, RATE_LIMIT,
+            ui32MaxBurst, (int) (BURST_WINDOW / 1000000), ui32ExpectedBurst);
+    delete pSender;
+    pMocket->close();
+    delete pMocket;
+    serverMocket.close();
+
+    if (ui32Received != NUM_MESSAGES) {
+        return -4;
+    }
+    // Allow for the packet headers and for the timing of the scheduler
+    if ((ui32Rate > (RATE_LIMIT * 11 / 10)) || (ui32Rate < (RATE_LIMIT / 2))) {
+        printf ("runTransfer: the rate limit was not respected\n");
+        return -5;
+    }
+    if (bCheckBursts && (ui32MaxBurst > (3 * ui32ExpectedBurst))) {
+        printf ("runTransfer: packets were sent in bursts\n");
+        return -6;
+    }
+    return 0;
+}
+
+int main (int argc, char *argv[])
+{
+    pLogger = new Logger();
+    pLogger->initLogFile ("PacingTest.log");
+    pLogger->setDebugLevel (Logger::L_Warning);
+    pLogger->disableScreenOutput();
+
+    int rc = 0;
+    int rcTransfer;
+    // Without pacing the packets are sent in bursts at the start of each rate limit interval; only the rate is checked
+    if (0 != (rcTransfer = runTransfer ("No pacing", "", false))) {
+        printf ("main: transfer without pacing failed; rc = %d\n", rcTransfer);
+        rc = -1;
+    }
+    if (0 != (rcTransfer = runTransfer ("Pacing", "UsePacing=true\n", true))) {
+        printf ("main: transfer with pacing failed; rc = %d\n", rcTransfer);
+        rc = -1;
+    }
+    // Falls back to pacing in the transmitter if SO_TXTIME is not supported
+    if (0 != (rcTransfer = runTransfer ("Kernel pacing", "UseKernelPacing=true\n", true))) {
+        printf ("main: transfer with kernel pacing failed; rc = %d\n", rcTransfer);
+        rc = -1;
+    }
+    remove (CONFIG_FILE);
+
+    delete pLogger;
+    pLogger = nullptr;
+
+    return rc;
+}
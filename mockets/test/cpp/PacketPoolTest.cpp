@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Logger.h"
+#include "Mocket.h"
+#include "MessageSender.h"
+#include "MocketStats.h"
+#include "NLFLib.h"
+#include "PacketPool.h"
+#include "ServerMocket.h"
+#include "Thread.h"
+
+using namespace NOMADSUtil;
+
+// Checks the bookkeeping of the PacketPool and then transfers a stream of reliable sequenced
+// messages between two mockets, printing the occupancy of the packet pools at the end
+
+static const uint32 NUM_MESSAGES = 20000;
+static const uint32 MESSAGE_SIZE = 1024;
+
+static void printPoolStats (const char *pszName, PacketPool *pPool)
+{
+    PacketPool::SizeClassStats scs;
+    for (uint8 ui8 = 0; ui8 < PacketPool::NUM_SIZE_CLASSES; ui8++) {
+        pPool->getStats (ui8, &scs);
+        printf ("%s: block size %4u - in use %5u; high-water mark %5u; free %5u\n", pszName,
+                scs.ui32BlockSize, scs.ui32InUse, scs.ui32HighWaterMark, scs.ui32Free);
+    }
+}
+
+static int testPoolBookkeeping (void)
+{
+    PacketPool *pPool = new PacketPool();
+    void *apBlocks[100];
+    for (int i = 0; i < 100; i++) {
+        apBlocks[i] = PacketPool::allocate (pPool, (i % 2) ? 48 : 1500);
+        memset (apBlocks[i], i, (i % 2) ? 48 : 1500);
+    }
+    PacketPool::SizeClassStats scsSmall, scsLarge;
+    pPool->getStats (0, &scsSmall);
+    pPool->getStats (PacketPool::NUM_SIZE_CLASSES - 1, &scsLarge);
+    if ((scsSmall.ui32InUse != 50) || (scsLarge.ui32InUse != 50) || (scsLarge.ui32HighWaterMark != 50)) {
+        printf ("testPoolBookkeeping: unexpected occupancy %u and %u\n", scsSmall.ui32InUse, scsLarge.ui32InUse);
+        return -1;
+    }
+    for (int i = 0; i < 100; i++) {
+        PacketPool::release (apBlocks[i]);
+    }
+    pPool->getStats (PacketPool::NUM_SIZE_CLASSES - 1, &scsLarge);
+    if ((scsLarge.ui32InUse != 0) || (scsLarge.ui32HighWaterMark != 50) || (scsLarge.ui32Free < 50)) {
+        printf ("testPoolBookkeeping: blocks were not returned to the pool\n");
+        return -2;
+    }
+
+    // Blocks that are too large (or allocated without a pool) are obtained from malloc()
+    void *pOversized = PacketPool::allocate (pPool, PacketPool::MAX_BLOCK_SIZE + 1);
+    void *pUnpooled = PacketPool::allocate (nullptr, 100);
+    if ((pOversized == nullptr) || (pUnpooled == nullptr) || (pPool->getOversizedAllocationCount() != 1)) {
+        printf ("testPoolBookkeeping: failed to allocate blocks outside of the pool\n");
+        return -3;
+    }
+    PacketPool::release (pOversized);
+    PacketPool::release (pUnpooled);
+
+    // The pool must survive until the last outstanding block is released
+    void *pOutstanding = PacketPool::allocate (pPool, 100);
+    pPool->close();
+    PacketPool::release (pOutstanding);
+    return 0;
+}
+
+class Sender : public Thread
+{
+    public:
+        Sender (uint16 ui16ServerPort);
+        void run (void);
+        volatile bool _bFinished;
+
+    private:
+        uint16 _ui16ServerPort;
+};
+
+Sender::Sender (uint16 ui16ServerPort)
+{
+    _ui16ServerPort = ui16ServerPort;
+    _bFinished = false;
+}
+
+void Sender::run (void)
+{
+    Mocket mocket;
+    if (mocket.connect ("127.0.0.1", _ui16ServerPort)) {
+        printf ("Sender::run: failed to connect to server on port %d\n", (int) _ui16ServerPort);
+        _bFinished = true;
+        return;
+    }
+    MessageSender sender = mocket.getSender (true, true);
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    for (uint32 ui32 = 0; ui32 < NUM_MESSAGES; ui32++) {
+        memset (pBuf, (int) (ui32 % 256), MESSAGE_SIZE);
+        sender.send (pBuf, MESSAGE_SIZE);
+    }
+    free (pBuf);
+    mocket.close();
+    printPoolStats ("sender", mocket.getStatistics()->getPacketPool());
+    _bFinished = true;
+}
+
+int main (int argc, char *argv[])
+{
+    pLogger = new Logger();
+    pLogger->initLogFile ("PacketPoolTest.log");
+    pLogger->setDebugLevel (Logger::L_Warning);
+    pLogger->disableScreenOutput();
+
+    int rc;
+    if (0 != (rc = testPoolBookkeeping())) {
+        printf ("main: pool bookkeeping test failed; rc = %d\n", rc);
+        return -1;
+    }
+    printf ("main: pool bookkeeping test succeeded\n");
+
+    ServerMocket serverMocket;
+    int iPort = serverMocket.listen (0);
+    if (iPort <= 0) {
+        printf ("main: listen failed; rc = %d\n", iPort);
+        return -2;
+    }
+    Sender *pSender = new Sender ((uint16) iPort);
+    pSender->start();
+    Mocket *pMocket = serverMocket.accept();
+    if (pMocket == nullptr) {
+        printf ("main: accept failed\n");
+        return -3;
+    }
+
+    int64 i64StartTime = getTimeInMilliseconds();
+    char *pBuf = (char*) malloc (MESSAGE_SIZE);
+    uint32 ui32Received = 0;
+    while (ui32Received < NUM_MESSAGES) {
+        if (pMocket->receive (pBuf, MESSAGE_SIZE, 10000) != (int) MESSAGE_SIZE) {
+            break;
+        }
+        if (((uint8) pBuf[0]) != (ui32Received % 256)) {
+            printf ("main: message %u is corrupted\n", ui32Received);
+            break;
+        }
+        ui32Received++;
+    }
+    free (pBuf);
+    printf ("main: received %u out of %u messages in %d ms\n", ui32Received, NUM_MESSAGES,
+            (int) (getTimeInMilliseconds() - i64StartTime));
+    printPoolStats ("receiver", pMocket->getStatistics()->getPacketPool());
+
+    while (!pSender->_bFinished) {
+        sleepForMilliseconds (100);
+    }
+    pMocket->close();
+    delete pMocket;
+    serverMocket.close();
+
+    delete pLogger;
+    pLogger = nullptr;
+
+    return (ui32Received == NUM_MESSAGES) ? 0 : -4;
+}
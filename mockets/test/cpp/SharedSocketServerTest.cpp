@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Logger.h"
+#include "Mocket.h"
+#include "MessageSender.h"
+#include "NLFLib.h"
+#include "ServerMocket.h"
+#include "Thread.h"
+
+#if defined (_DEBUG)
+    #include <crtdbg.h>
+#endif
+
+using namespace NOMADSUtil;
+
+// Connects many clients to a ServerMocket running in shared socket mode
+// Each connection handler sends a fixed number of reliable sequenced messages
+// and each client checks that all of them were received in order
+
+static const uint16 NUM_CLIENTS = 100;
+static const uint16 NUM_MESSAGES = 50;
+
+class Client : public Thread
+{
+    public:
+        Client (uint16 ui16ClientId, uint16 ui16ServerPort);
+        void run (void);
+        bool finished (void);
+        bool succeeded (void);
+
+    private:
+        uint16 _ui16ClientId;
+        uint16 _ui16ServerPort;
+        volatile bool _bFinished;
+        bool _bSucceeded;
+};
+
+class ConnHandler : public Thread
+{
+    public:
+        ConnHandler (Mocket *pMocket);
+        void run (void);
+
+    private:
+        Mocket *_pMocket;
+};
+
+Client::Client (uint16 ui16ClientId, uint16 ui16ServerPort)
+{
+    _ui16ClientId = ui16ClientId;
+    _ui16ServerPort = ui16ServerPort;
+    _bFinished = false;
+    _bSucceeded = false;
+}
+
+void Client::run (void)
+{
+    Mocket mocket;
+    if (mocket.connect ("127.0.0.1", _ui16ServerPort)) {
+        printf ("Client::run: client %d failed to connect to server on port %d\n", (int) _ui16ClientId, (int) _ui16ServerPort);
+        _bFinished = true;
+        return;
+    }
+    char buf[256];
+    uint16 ui16MsgCount = 0;
+    while (true) {
+        int rc = mocket.receive (buf, sizeof (buf), 10000);
+        if (rc <= 0) {
+            break;
+        }
+        uint16 ui16MsgNum = (uint16) atoi (buf);
+        if (ui16MsgNum != ui16MsgCount) {
+            printf ("Client::run: client %d received message %d - expecting %d\n", (int) _ui16ClientId, (int) ui16MsgNum, (int) ui16MsgCount);
+            break;
+        }
+        ui16MsgCount++;
+    }
+    _bSucceeded = (ui16MsgCount == NUM_MESSAGES);
+    if (!_bSucceeded) {
+        printf ("Client::run: client %d received %d out of %d messages\n", (int) _ui16ClientId, (int) ui16MsgCount, (int) NUM_MESSAGES);
+    }
+    mocket.close();
+    _bFinished = true;
+}
+
+bool Client::finished (void)
+{
+    return _bFinished;
+}
+
+bool Client::succeeded (void)
+{
+    return _bSucceeded;
+}
+
+ConnHandler::ConnHandler (Mocket *pMocket)
+{
+    _pMocket = pMocket;
+}
+
+void ConnHandler::run (void)
+{
+    MessageSender sender = _pMocket->getSender (true, true);
+    char msg[256];
+    for (uint16 ui16 = 0; ui16 < NUM_MESSAGES; ui16++) {
+        sprintf (msg, "%d - the quick brown fox jumps over the lazy dog", (int) ui16);
+        sender.send (msg, strlen (msg) + 1);
+    }
+    _pMocket->close();
+    delete _pMocket;
+}
+
+int main (int argc, char *argv[])
+{
+    #if defined (WIN32) && defined (_DEBUG)
+        _CrtSetReportMode (_CRT_ERROR, _CRTDBG_MODE_FILE);
+        _CrtSetReportFile (_CRT_ERROR, _CRTDBG_FILE_STDERR);
+        _CrtSetReportMode (_CRT_WARN, _CRTDBG_MODE_FILE);
+        _CrtSetReportFile (_CRT_WARN, _CRTDBG_FILE_STDERR);
+    #endif
+
+    uint16 ui16NumProcessingWorkers = MocketMultiplexer::DEFAULT_NUM_PROCESSING_WORKERS;
+    if (argc > 1) {
+        ui16NumProcessingWorkers = (uint16) atoi (argv[1]);
+    }
+
+    pLogger = new Logger();
+    pLogger->initLogFile ("SharedSocketServerTest.log");
+    pLogger->setDebugLevel (Logger::L_Warning);
+    pLogger->disableScreenOutput();
+
+    ServerMocket *pServerMocket = new ServerMocket();
+    if (0 != pServerMocket->enableSharedSocket (MocketMultiplexer::DEFAULT_NUM_IO_WORKERS, ui16NumProcessingWorkers)) {
+        printf ("main: failed to enable shared socket mode\n");
+        return -1;
+    }
+    int iPort = pServerMocket->listen (0);
+    if (iPort <= 0) {
+        printf ("main: listen failed; rc = %d\n", iPort);
+        return -2;
+    }
+    printf ("main: listening on port %d with %d processing workers\n", iPort, (int) ui16NumProcessingWorkers);
+
+    Client *apClients[NUM_CLIENTS];
+    for (uint16 ui16 = 0; ui16 < NUM_CLIENTS; ui16++) {
+        apClients[ui16] = new Client (ui16, (uint16) iPort);
+        apClients[ui16]->start();
+    }
+    int64 i64StartTime = getTimeInMilliseconds();
+    for (uint16 ui16 = 0; ui16 < NUM_CLIENTS; ui16++) {
+        Mocket *pMocket = pServerMocket->accept();
+        if (pMocket == nullptr) {
+            printf ("main: accept failed\n");
+            return -3;
+        }
+        ConnHandler *pHandler = new ConnHandler (pMocket);
+        pHandler->start();
+    }
+
+    uint16 ui16Succeeded = 0;
+    for (uint16 ui16 = 0; ui16 < NUM_CLIENTS; ui16++) {
+        while (!apClients[ui16]->finished()) {
+            sleepForMilliseconds (100);
+        }
+        if (apClients[ui16]->succeeded()) {
+            ui16Succeeded++;
+        }
+    }
+    printf ("main: %d out of %d clients succeeded in %d ms\n", (int) ui16Succeeded,
+            (int) NUM_CLIENTS, (int) (getTimeInMilliseconds() - i64StartTime));
+
+    pServerMocket->close();
+    delete pServerMocket;
+
+    delete pLogger;
+    pLogger = nullptr;
+
+    return (ui16Succeeded == NUM_CLIENTS) ? 0 : -4;
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "Logger.h"
+#include "NLFLib.h"
+#include "Packet.h"
+#include "PacketWrapper.h"
+#include "UnacknowledgedPacketQueue.h"
+
+#include "ListUnacknowledgedPacketQueue.h"
+
+using namespace NOMADSUtil;
+
+// Compares the UnacknowledgedPacketQueue with the original list-based implementation
+// (ListUnacknowledgedPacketQueue) for different numbers of outstanding packets.
+// Both queues are driven through the same sequence of operations: filling the window,
+// processing selective acknowledgements, prioritizing retransmissions, retransmitting
+// timed out packets, and finally a cumulative acknowledgement of the whole window.
+// The number of packets affected by each phase must be the same for both queues.
+
+static const uint32 NUM_SACK_OPERATIONS = 1000;
+static const uint32 NUM_PRIORITIZE_OPERATIONS = 1000;
+static const uint32 NUM_RETRANSMISSIONS = 1000;
+static const uint32 PACKETS_PER_MS = 16;
+static const uint32 RETRANSMIT_TIMEOUT = 3000;
+
+struct Results
+{
+    int64 ai64Microseconds[5];
+    uint32 aui32Counts[5];
+};
+
+static const char * PHASE_NAMES[5] = {"insert", "sack", "prioritize", "retransmit", "cumack"};
+
+static int64 getMicroseconds (void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Simple deterministic generator, so that both queues see the same operations
+static uint32 nextRandom (uint32 &ui32State)
+{
+    ui32State = (ui32State * 1103515245UL) + 12345UL;
+    return (ui32State >> 8);
+}
+
+template <class Q> void runBenchmark (uint32 ui32NumPackets, Results *pResults)
+{
+    Q *pQueue = new Q();
+    uint32 ui32Random = 42;
+    int64 i64StartTime = getTimeInMilliseconds() - (ui32NumPackets / PACKETS_PER_MS) - (2 * RETRANSMIT_TIMEOUT);
+
+    // Fill the window - packets are sent in order, PACKETS_PER_MS every millisecond
+    int64 i64Start = getMicroseconds();
+    for (uint32 ui32 = 0; ui32 < ui32NumPackets; ui32++) {
+        Packet *pPacket = new Packet ((unsigned short) 64);
+        pPacket->setSequenceNum (ui32);
+        PacketWrapper *pWrapper = new PacketWrapper (pPacket, i64StartTime + (ui32 / PACKETS_PER_MS), 0, 0, 0, RETRANSMIT_TIMEOUT);
+        if (0 != pQueue->insert (pWrapper)) {
+            printf ("failed to insert packet %u\n", ui32);
+        }
+    }
+    pResults->ai64Microseconds[0] = getMicroseconds() - i64Start;
+    pResults->aui32Counts[0] = pQueue->getPacketCount();
+
+    // Selective acknowledgements of short ranges in the upper half of the window
+    uint64 ui64AckedBytes = 0;
+    uint32 ui32Count = 0;
+    i64Start = getMicroseconds();
+    for (uint32 ui32 = 0; ui32 < NUM_SACK_OPERATIONS; ui32++) {
+        uint32 ui32StartTSN = (ui32NumPackets / 2) + (nextRandom (ui32Random) % (ui32NumPackets / 2));
+        ui32Count += pQueue->acknowledgePacketsWithin (ui32StartTSN, ui32StartTSN + 1, ui64AckedBytes);
+    }
+    pResults->ai64Microseconds[1] = getMicroseconds() - i64Start;
+    pResults->aui32Counts[1] = ui32Count;
+
+    // Prioritize the retransmission of random packets
+    ui32Count = 0;
+    i64Start = getMicroseconds();
+    for (uint32 ui32 = 0; ui32 < NUM_PRIORITIZE_OPERATIONS; ui32++) {
+        ui32Count += pQueue->prioritizeRetransmissionOfPacket (nextRandom (ui32Random) % ui32NumPackets);
+    }
+    pResults->ai64Microseconds[2] = getMicroseconds() - i64Start;
+    pResults->aui32Counts[2] = ui32Count;
+
+    // Retransmit the packets that have timed out
+    ui32Count = 0;
+    int64 i64CurrTime = getTimeInMilliseconds();
+    i64Start = getMicroseconds();
+    for (uint32 ui32 = 0; ui32 < NUM_RETRANSMISSIONS; ui32++) {
+        PacketWrapper *pWrapper = pQueue->getNextTimedOutPacket();
+        if (pWrapper == nullptr) {
+            break;
+        }
+        pWrapper->setLastIOTime (i64CurrTime);
+        pWrapper->incrementRetransmitCount();
+        if (0 == pQueue->packetRetransmitted (pWrapper)) {
+            ui32Count++;
+        }
+    }
+    pResults->ai64Microseconds[3] = getMicroseconds() - i64Start;
+    pResults->aui32Counts[3] = ui32Count;
+
+    // Acknowledge the whole window
+    i64Start = getMicroseconds();
+    pResults->aui32Counts[4] = pQueue->acknowledgePacketsUpto (ui32NumPackets, ui64AckedBytes);
+    pResults->ai64Microseconds[4] = getMicroseconds() - i64Start;
+
+    delete pQueue;
+}
+
+int main (int argc, char *argv[])
+{
+    pLogger = new Logger();
+    pLogger->initLogFile ("UnacknowledgedPacketQueueBenchmark.log");
+    pLogger->setDebugLevel (Logger::L_Warning);
+    pLogger->disableScreenOutput();
+
+    static const uint32 WINDOW_SIZES[] = {1000, 10000, 100000};
+    int rc = 0;
+    for (uint8 ui8 = 0; ui8 < (sizeof (WINDOW_SIZES) / sizeof (WINDOW_SIZES[0])); ui8++) {
+        Results indexed, list;
+        runBenchmark<UnacknowledgedPacketQueue> (WINDOW_SIZES[ui8], &indexed);
+        runBenchmark<ListUnacknowledgedPacketQueue> (WINDOW_SIZES[ui8], &list);
+        printf ("%u outstanding packets:\n", WINDOW_SIZES[ui8]);
+        for (uint8 ui8Phase = 0; ui8Phase < 5; ui8Phase++) {
+            printf ("    %-10s indexed %10lld us    list %10lld us    (%u packets)\n", PHASE_NAMES[ui8Phase],
+                    (long long) indexed.ai64Microseconds[ui8Phase], (long long) list.ai64Microseconds[ui8Phase],
+                    indexed.aui32Counts[ui8Phase]);
+            if (indexed.aui32Counts[ui8Phase] != list.aui32Counts[ui8Phase]) {
+                printf ("    ERROR: the list-based queue affected %u packets\n", list.aui32Counts[ui8Phase]);
+                rc = -1;
+            }
+        }
+    }
+
+    delete pLogger;
+    pLogger = nullptr;
+
+    return rc;
+}
@@ -0,0 +1,127 @@
+/*
+ * DuplicateMessageFilter.cpp
+ *
+ * This file is part of the IHMC Network Message Service Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "DuplicateMessageFilter.h"
+
+#include "InetAddr.h"
+#include "Logger.h"
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+using namespace NOMADSUtil;
+
+DuplicateMessageFilter::DuplicateMessageFilter (void)
+    : _pShards (new Shard[NUMBER_OF_SHARDS]),
+      _overflow (true),     // bDelValues
+      _bFullWarningLogged (false)
+{
+}
+
+DuplicateMessageFilter::~DuplicateMessageFilter (void)
+{
+    delete[] _pShards;
+    _pShards = NULL;
+}
+
+bool DuplicateMessageFilter::checkAndSetReceived (uint32 ui32SourceAddress, uint16 ui16SessionId,
+                                                  uint16 ui16MsgId, bool &bNewSession)
+{
+    bNewSession = false;
+    Window *pWindow = getWindow (ui32SourceAddress);
+    if (pWindow != NULL) {
+        return checkAndSetReceived (*pWindow, ui16SessionId, ui16MsgId, bNewSession);
+    }
+
+    // The shard is full: the source is tracked in the overflow table
+    if (!_bFullWarningLogged.exchange (true)) {
+        InetAddr addr (ui32SourceAddress);
+        checkAndLogMsg ("DuplicateMessageFilter::checkAndSetReceived", Logger::L_Warning,
+                        "no free window to track messages from %s; new sources that do not "
+                        "fit in the table are tracked in the overflow table\n", addr.getIPAsString());
+    }
+    _mOverflow.lock();
+    pWindow = getOverflowWindow (ui32SourceAddress);
+    const bool bReceived = checkAndSetReceived (*pWindow, ui16SessionId, ui16MsgId, bNewSession);
+    _mOverflow.unlock();
+    return bReceived;
+}
+
+bool DuplicateMessageFilter::checkAndSetReceived (Window &window, uint16 ui16SessionId,
+                                                  uint16 ui16MsgId, bool &bNewSession)
+{
+    const uint32 ui32Session = toSession (ui16SessionId);
+    uint32 ui32CurrSession = window.ui32Session.load (std::memory_order_acquire);
+    if (ui32CurrSession != ui32Session) {
+        if (window.ui32Session.compare_exchange_strong (ui32CurrSession, ui32Session, std::memory_order_acq_rel) &&
+            (ui32CurrSession != 0U)) {
+            // The bitmap of a new window is already clear: clearing it here
+            // could undo the bits set by the threads that lost the race
+            for (unsigned int i = 0; i < 4; i++) {
+                window.aui32Bitmap[i].store (0U, std::memory_order_release);
+            }
+            bNewSession = true;
+        }
+        // else another receiver thread has just changed the session: check
+        // the message against the window of the session that won
+    }
+
+    const uint16 ui16Bit = ui16MsgId % 128;
+    const uint16 ui16BitArrayIndex = ui16Bit / 32;
+    const uint32 ui32Mask = 0x00000001UL << (ui16MsgId % 32);
+    const uint32 ui32Prev = window.aui32Bitmap[ui16BitArrayIndex].fetch_or (ui32Mask, std::memory_order_acq_rel);
+    // Reset the uint32 bitmap that is farthest away
+    window.aui32Bitmap[(ui16BitArrayIndex + 2) % 4].store (0U, std::memory_order_release);
+
+    return ((ui32Prev & ui32Mask) == 0);
+}
+
+DuplicateMessageFilter::Window * DuplicateMessageFilter::getWindow (uint32 ui32SourceAddress)
+{
+    const uint32 ui32Hash = hash (ui32SourceAddress);
+    Shard &shard = _pShards[(ui32Hash >> 26) % NUMBER_OF_SHARDS];
+    const uint64 ui64Key = toKey (ui32SourceAddress);
+    for (uint16 i = 0; i < WINDOWS_PER_SHARD; i++) {
+        Window &window = shard.windows[((ui32Hash >> 19) + i) % WINDOWS_PER_SHARD];
+        uint64 ui64CurrKey = window.ui64Key.load (std::memory_order_acquire);
+        if (ui64CurrKey == ui64Key) {
+            return &window;
+        }
+        if (ui64CurrKey == 0U) {
+            if (window.ui64Key.compare_exchange_strong (ui64CurrKey, ui64Key, std::memory_order_acq_rel) ||
+                (ui64CurrKey == ui64Key)) {
+                // Either this thread claimed the window, or another thread
+                // has just claimed it for the same source
+                return &window;
+            }
+        }
+    }
+    return NULL;
+}
+
+DuplicateMessageFilter::Window * DuplicateMessageFilter::getOverflowWindow (uint32 ui32SourceAddress)
+{
+    // _mOverflow must be locked
+    Window *pWindow = _overflow.get (ui32SourceAddress);
+    if (pWindow == NULL) {
+        pWindow = new Window();
+        pWindow->ui64Key.store (toKey (ui32SourceAddress), std::memory_order_relaxed);
+        _overflow.put (ui32SourceAddress, pWindow);
+    }
+    return pWindow;
+}
@@ -0,0 +1,120 @@
+/*
+ * DuplicateMessageFilter.h
+ *
+ * This file is part of the IHMC Network Message Service Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Keeps track of the manycast messages that were recently received from
+ * each (source, session) pair, in order to detect duplicates.
+ * For each source, a 128-message sliding window bitmap is stored in a
+ * fixed-size, open-addressing table that is split into shards.  Slots are
+ * claimed with a compare-and-swap and bits are tested and set with a single
+ * atomic fetch-or, so receiver threads never block on each other.
+ * Sources that do not fit in their shard are tracked in an overflow
+ * hashtable that is protected by a mutex, so that their duplicates are
+ * still detected (a full table must not cause a rebroadcast storm).
+ * The window is reset whenever a new session id is seen for a source.
+ */
+
+#ifndef INCL_DUPLICATE_MESSAGE_FILTER_H
+#define INCL_DUPLICATE_MESSAGE_FILTER_H
+
+#include "FTypes.h"
+#include "Mutex.h"
+#include "UInt32Hashtable.h"
+
+#include <atomic>
+
+namespace NOMADSUtil
+{
+    class DuplicateMessageFilter
+    {
+        public:
+            static const uint16 NUMBER_OF_SHARDS = 64;
+            static const uint16 WINDOWS_PER_SHARD = 128;
+
+            DuplicateMessageFilter (void);
+            ~DuplicateMessageFilter (void);
+
+            // Returns true if ui16MsgId had not been received yet from the
+            // specified source in session ui16SessionId, and marks it as
+            // received.  bNewSession is set to true if the message started
+            // a new session for a source that was already known.
+            // Messages from the same source are expected to be checked in
+            // order (concurrent calls for the same source are safe, but the
+            // oldest part of the window may be cleared out of order).
+            bool checkAndSetReceived (uint32 ui32SourceAddress, uint16 ui16SessionId,
+                                      uint16 ui16MsgId, bool &bNewSession);
+
+        private:
+            struct Window
+            {
+                Window (void);
+
+                std::atomic<uint64> ui64Key;      // 0 if the slot is free
+                std::atomic<uint32> ui32Session;  // 0 until the first message is received
+                std::atomic<uint32> aui32Bitmap[4];
+            };
+
+            struct Shard
+            {
+                Window windows[WINDOWS_PER_SHARD];
+            };
+
+            Window * getWindow (uint32 ui32SourceAddress);
+            Window * getOverflowWindow (uint32 ui32SourceAddress);
+            static bool checkAndSetReceived (Window &window, uint16 ui16SessionId,
+                                             uint16 ui16MsgId, bool &bNewSession);
+
+            static uint32 hash (uint32 ui32SourceAddress);
+            static uint64 toKey (uint32 ui32SourceAddress);
+            static uint32 toSession (uint16 ui16SessionId);
+
+        private:
+            static const uint64 KEY_IN_USE_FLAG = 0x0000000100000000ULL;
+            static const uint32 SESSION_SET_FLAG = 0x00010000UL;
+
+            Shard *_pShards;
+            Mutex _mOverflow;
+            UInt32Hashtable<Window> _overflow;
+            std::atomic<bool> _bFullWarningLogged;
+    };
+
+    inline DuplicateMessageFilter::Window::Window (void)
+        : ui64Key (0U), ui32Session (0U)
+    {
+        for (unsigned int i = 0; i < 4; i++) {
+            aui32Bitmap[i].store (0U, std::memory_order_relaxed);
+        }
+    }
+
+    inline uint32 DuplicateMessageFilter::hash (uint32 ui32SourceAddress)
+    {
+        // Fibonacci hashing: the high bits select the shard, the low bits the first probed window
+        return ui32SourceAddress * 2654435761UL;
+    }
+
+    inline uint64 DuplicateMessageFilter::toKey (uint32 ui32SourceAddress)
+    {
+        return KEY_IN_USE_FLAG | ui32SourceAddress;
+    }
+
+    inline uint32 DuplicateMessageFilter::toSession (uint16 ui16SessionId)
+    {
+        return SESSION_SET_FLAG | ui16SessionId;
+    }
+}
+
+#endif  // INCL_DUPLICATE_MESSAGE_FILTER_H
@@ -295,7 +295,6 @@ NetworkMessageServiceImpl::NetworkMessageServiceImpl (PROPAGATION_MODE mode, boo
       _pKey (createKey (pszGroupKeyFilename)),
       _pNetIntMgr (pNetIntMgr),
       _pInstr (NULL),
-      _lastMsgs (true, true),
       _cvDeliveryQueue (&_mDeliveryQueue)
 {
 }
@@ -317,7 +316,6 @@ NetworkMessageServiceImpl::~NetworkMessageServiceImpl (void)
         delete pInterface;
     }
     _tQueueLengthByInterface.removeAll();
-    _lastMsgs.removeAll();
     if (_pKey != NULL) {
         delete _pKey;
         _pKey = NULL;
@@ -583,36 +581,17 @@ uint8 NetworkMessageServiceImpl::getNeighborQueueLength (const char *pchIncoming
 
 //////////////////////////// Private Methods ///////////////////////////////////
 
-bool NetworkMessageServiceImpl::checkOldMessages (uint32 ui32SourceAddress, uint16 ui16SessionId, uint16 ui16MsgId)
+bool NetworkMessageServiceImpl::checkAndUpdateOldMessages (uint32 ui32SourceAddress, uint16 ui16SessionId, uint16 ui16MsgId)
 {
-    PeerState *pPS = _lastMsgs.get (ui32SourceAddress);
-    if (pPS == NULL) {
-        // New host
-        return true;
-    }
-    else {
-        if (ui16SessionId != pPS->ui16SessionId) {
-            return true;
-        }
-        return !pPS->checkIfReceived (ui16MsgId);
-    }
-}
-
-void NetworkMessageServiceImpl::updateOldMessagesList (uint32 ui32SourceAddress, uint16 ui16SessionId, uint16 ui16MsgId)
-{
-    PeerState *pPS = _lastMsgs.get (ui32SourceAddress);
-    if (pPS == NULL) {
-        pPS = new PeerState;
-        pPS->ui16SessionId = ui16SessionId;
-        _lastMsgs.put (ui32SourceAddress, pPS);
-    }
-    else if (pPS->ui16SessionId != ui16SessionId) {
-        pPS->ui16SessionId = ui16SessionId;
-        pPS->resetMessageHistory();
+    bool bNewSession = false;
+    const bool bNewMessage = _oldMsgs.checkAndSetReceived (ui32SourceAddress, ui16SessionId, ui16MsgId, bNewSession);
+    if (bNewSession) {
+        _mxMsgCounts.lock();
         resetCounter (_manycastCountMap, ui32SourceAddress);
         resetCounter (_unicastCountMap, ui32SourceAddress);
+        _mxMsgCounts.unlock();
     }
-    pPS->setAsReceived (ui16MsgId);
+    return bNewMessage;
 }
 
 int NetworkMessageServiceImpl::messageArrived (NetworkMessage *pNetMsg, const char *pszIncomingInterface, unsigned long ulSenderRemoteAddress)
@@ -637,7 +616,10 @@ int NetworkMessageServiceImpl::messageArrived (NetworkMessage *pNetMsg, const ch
         _pInstr->receivedBytes (addr.getIPAsString(), pszIncomingInterface, pNetMsg->getMsgLen());
     }
 
-    _mxMessageArrived.lock();
+    // Messages from the same source must be processed in order
+    const uint32 ui32Stripe = (ui32SourceAddress ^ (ui32SourceAddress >> 8) ^ (ui32SourceAddress >> 16) ^ (ui32SourceAddress >> 24));
+    Mutex &mxMessageArrived = _mxMessageArrived[ui32Stripe % MESSAGE_ARRIVED_LOCK_STRIPES];
+    mxMessageArrived.lock();
     _reassembler.refresh(ui32SourceAddress);
     //if the message contains a queue length, update the value for the corresponding neighbor
     uint8 ui8QueueLength;
@@ -661,8 +643,10 @@ int NetworkMessageServiceImpl::messageArrived (NetworkMessage *pNetMsg, const ch
 
             // Update counter
             const bool bNewSessionId = _reassembler.isNewSessionId (ui32SourceAddress, pNetMsg->getSessionId());
+            _mxMsgCounts.lock();
             const uint64 ui64GroupCount = getCounter (_manycastCountMap, ui32SourceAddress);
             const uint64 ui64UnicastCount = updateCounter (_unicastCountMap, ui32SourceAddress, bNewSessionId);
+            _mxMsgCounts.unlock();
             if (!_reassembler.hasTSN (ui32SourceAddress, ui16MsgId) || bNewSessionId) {
                 // It MAY be a new message
                 int ret = _reassembler.push (ui32SourceAddress, pNetMsg);
@@ -728,10 +712,11 @@ int NetworkMessageServiceImpl::messageArrived (NetworkMessage *pNetMsg, const ch
             }
         }
         else {
+            _mxMsgCounts.lock();
             const uint64 ui64UnicastCount = getCounter (_unicastCountMap, ui32SourceAddress);
             const uint64 ui64ManycastCount = updateCounter (_manycastCountMap, ui32SourceAddress);
-            bool bNewMessage = checkOldMessages (ui32SourceAddress, pNetMsg->getSessionId(), ui16MsgId);
-            updateOldMessagesList (ui32SourceAddress, pNetMsg->getSessionId(), ui16MsgId);
+            _mxMsgCounts.unlock();
+            const bool bNewMessage = checkAndUpdateOldMessages (ui32SourceAddress, pNetMsg->getSessionId(), ui16MsgId);
             if (bNewMessage) {
                 // Retransmit and notify (need to be mutex-ed since other
                 // interfaces may be re-broadcasting the same message)
@@ -752,7 +737,7 @@ int NetworkMessageServiceImpl::messageArrived (NetworkMessage *pNetMsg, const ch
         }
     }
     // TODO: delete arrived message ???
-    _mxMessageArrived.unlock();
+    mxMessageArrived.unlock();
     return 0;
 }
 
@@ -1169,12 +1154,6 @@ int NetworkMessageServiceImpl::setRetransmissionTimeout (uint32 ui32Timeout)
     return 0;
 }
 
-NetworkMessageServiceImpl::PeerState::PeerState (void)
-{
-    ui16SessionId = 0;
-    resetMessageHistory();
-}
-
 NetworkMessageServiceImpl::UnackedMessageWrapper::UnackedMessageWrapper (NetworkMessage *pNetMsg, bool bDeleteNetMsg)
 {
     _pNetMsg = pNetMsg;
@@ -23,6 +23,7 @@
 #define INCL_NETWORK_MESSAGE_SERVICE_IMPLEMENTATION_H
 
 #include "NetworkMessageService.h"
+#include "DuplicateMessageFilter.h"
 #include "FIFOQueue.h"
 #include "ManageableThread.h"
 #include "OSThread.h"
@@ -118,10 +119,10 @@ namespace NOMADSUtil
 
             //------------------------------------------------------------------
             // Use only in case the received message has been either multicast
-            // or broadcast
+            // or broadcast.  Returns true if the message had not been received
+            // yet, and marks it as received.
             //------------------------------------------------------------------
-            bool checkOldMessages (uint32 ui32SourceAddress, uint16 ui16SessionId, uint16 ui16MsgId);
-            void updateOldMessagesList (uint32 ui32SourceAddress, uint16 ui16SessionId, uint16 ui16MsgId);
+            bool checkAndUpdateOldMessages (uint32 ui32SourceAddress, uint16 ui16SessionId, uint16 ui16MsgId);
             static void deliveryThread (void *pArg);
 
         private:
@@ -171,16 +172,6 @@ namespace NOMADSUtil
                 UInt32Hashtable<ByNeighbor> _tByNeighbor;
             };
 
-            struct PeerState
-            {
-                PeerState (void);
-                void resetMessageHistory (void);
-                void setAsReceived (uint16 ui16MsgSeqId);
-                bool checkIfReceived (uint16 ui16MsgseqId);
-                uint16 ui16SessionId;
-                uint32 ui32ReceivedMessageHistoryBitmap[4];
-            };
-
             struct UnackedMessageWrapper
             {
                 UnackedMessageWrapper (NetworkMessage *pNetMsg, bool bDeleteNetMsg=true);
@@ -214,7 +205,7 @@ namespace NOMADSUtil
             CryptoUtils::AES256Key *_pKey;
             NetworkInterfaceManager *_pNetIntMgr;
             IHMC_NMS::Instrumentation *_pInstr;
-            UInt32Hashtable<PeerState> _lastMsgs;
+            DuplicateMessageFilter _oldMsgs;
             // Reliable transmission: data structures to handle unacked messages
             UnackedSentMessagesByDestination _unackedSentMessagesByDestination;
             CumulativeTSNByDestination _cumulativeTSNByDestination;
@@ -226,7 +217,12 @@ namespace NOMADSUtil
             std::map<uint32, uint64> _unicastCountMap;
             Mutex _m;
             Mutex _mKey;
-            Mutex _mxMessageArrived;
+            // Messages that arrive from different sources are processed
+            // concurrently, while the messages from each source are serialized
+            // on the stripe that the source address hashes to
+            static const uint8 MESSAGE_ARRIVED_LOCK_STRIPES = 32;
+            Mutex _mxMessageArrived[MESSAGE_ARRIVED_LOCK_STRIPES];
+            Mutex _mxMsgCounts;
             Mutex _mxUnackedSentMessagesByDestination;
             Mutex _mQueueLengthsTable;
             // Variables and methods for asynchronous delivery
@@ -238,43 +234,6 @@ namespace NOMADSUtil
             CRC* _pCrc;
     };
 
-    inline void NetworkMessageServiceImpl::PeerState::setAsReceived (uint16 ui16MsgSeqId)
-    {
-        uint16 ui16Bit = ui16MsgSeqId % 128;
-        uint16 ui16BitArrayIndex = ui16Bit / 32;
-        uint16 ui16BitOffset = ui16MsgSeqId % 32;
-        // Reset the uint32 bitmap that is farthest away
-        if (ui16BitArrayIndex == 0) {
-            ui32ReceivedMessageHistoryBitmap[2] = 0;
-        }
-        else if (ui16BitArrayIndex == 1) {
-            ui32ReceivedMessageHistoryBitmap[3] = 0;
-        }
-        else if (ui16BitArrayIndex == 2) {
-            ui32ReceivedMessageHistoryBitmap[0] = 0;
-        }
-        else {
-            ui32ReceivedMessageHistoryBitmap[1] = 0;
-        }
-        ui32ReceivedMessageHistoryBitmap[ui16BitArrayIndex] |= (0x00000001UL << ui16BitOffset);
-    }
-
-    inline void NetworkMessageServiceImpl::PeerState::resetMessageHistory (void)
-    {
-        ui32ReceivedMessageHistoryBitmap[0] = 0;
-        ui32ReceivedMessageHistoryBitmap[1] = 0;
-        ui32ReceivedMessageHistoryBitmap[2] = 0;
-        ui32ReceivedMessageHistoryBitmap[3] = 0;
-    }
-
-    inline bool NetworkMessageServiceImpl::PeerState::checkIfReceived (uint16 ui16MsgSeqId)
-    {
-        uint16 ui16Bit = ui16MsgSeqId % 128;
-        uint16 ui16BitArrayIndex = ui16Bit / 32;
-        uint16 ui16BitOffset = ui16MsgSeqId % 32;
-        return ((ui32ReceivedMessageHistoryBitmap[ui16BitArrayIndex] & (0x00000001UL << ui16BitOffset)) != 0);
-    }
-
     inline bool NetworkMessageServiceImpl::UnackedMessageWrapper::operator == (UnackedMessageWrapper &rhsUnackedMessageWrapper)
     {
         return (_pNetMsg->getMsgId() == rhsUnackedMessageWrapper._pNetMsg->getMsgId());
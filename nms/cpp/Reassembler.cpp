@@ -59,6 +59,7 @@ Reassembler::~Reassembler (void)
 
 uint32 * Reassembler::getNeighborsToBeAcknowledged (uint32 &ui32NumOfNeighbors)
 {
+    MutexUnlocker unlocker (&_m);
     ui32NumOfNeighbors = _msgsBySourceAddress.getCount();
     if (ui32NumOfNeighbors == 0) {
         return NULL;
@@ -99,6 +100,7 @@ uint32 * Reassembler::getNeighborsToBeAcknowledged (uint32 &ui32NumOfNeighbors)
 
 void * Reassembler::getSacks (uint32 ui32SourceAddress, uint32 ui32MaxLength, uint32 &ui32Lentgh)
 {
+    MutexUnlocker unlocker (&_m);
     MsgQueue *pMQ = _msgsBySourceAddress.get (ui32SourceAddress);
     if (pMQ) {
         // If the _ui8MaxTimeOfLostRetransmissions is reached, the recipient
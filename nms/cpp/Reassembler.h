@@ -112,6 +112,7 @@ namespace NOMADSUtil
 
     inline uint16 Reassembler::getCumulativeTSN (uint32 ui32SourceAddress)
     {
+        MutexUnlocker unlocker (&_m);
         MsgQueue *pMQ = _msgsBySourceAddress.get (ui32SourceAddress);
         uint16 ui16CumulativeTSN;
         if (pMQ != NULL) {
@@ -126,6 +127,7 @@ namespace NOMADSUtil
 
     inline bool Reassembler::isNewSessionId (uint32 ui32SourceAddress, uint16 ui16SessionId)
     {
+        MutexUnlocker unlocker (&_m);
         MsgQueue *pMQ = _msgsBySourceAddress.get (ui32SourceAddress);
         if (pMQ == NULL) {
             return false;
@@ -135,6 +137,7 @@ namespace NOMADSUtil
 
     inline bool Reassembler::hasTSN (uint32 ui32SourceAddress, uint16 ui16TSN)
     {
+        MutexUnlocker unlocker (&_m);
         MsgQueue *pMQ = _msgsBySourceAddress.get (ui32SourceAddress);
         return ((pMQ != NULL) ? pMQ->_sAcks.hasTSN (ui16TSN) : false);
     }
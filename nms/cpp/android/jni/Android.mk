@@ -31,7 +31,8 @@ include $(CLEAR_VARS)
 #include $(PREBUILT_SHARED_LIBRARY)
 
 include $(CLEAR_VARS)
-LOCAL_SRC_FILES := Fragmenter.cpp \
+LOCAL_SRC_FILES := DuplicateMessageFilter.cpp \
+        Fragmenter.cpp \
         ManycastForwardingNetworkInterface.cpp \
 	ManycastNetworkMessageReceiver.cpp \
 	MessageFactory.cpp \
@@ -0,0 +1,113 @@
+/*
+ * DuplicateMessageFilterTest.cpp
+ *
+ * This file is part of the IHMC Network Message Service Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Checks that DuplicateMessageFilter detects the duplicates of every source,
+ * including when there are more sources than windows in the table, so that
+ * the shards fill up and the remaining sources go to the overflow table.
+ * The messages are checked by several threads, as the receivers of
+ * different interfaces do.
+ * Returns 0 if successful, a negative number otherwise.
+ */
+
+#include "DuplicateMessageFilter.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+
+using namespace NOMADSUtil;
+
+namespace DUPLICATE_MESSAGE_FILTER_TEST
+{
+    static const uint32 TABLE_SIZE = DuplicateMessageFilter::NUMBER_OF_SHARDS * DuplicateMessageFilter::WINDOWS_PER_SHARD;
+    static const uint32 SOURCES = 2 * TABLE_SIZE;
+    static const uint16 MESSAGES_PER_SOURCE = 4;
+    static const unsigned int THREADS = 4;
+
+    uint32 toSourceAddress (uint32 ui32Source)
+    {
+        // 10.x.y.z
+        return 0x0A000000UL | (ui32Source + 1);
+    }
+
+    // Each thread receives a copy of every message, as if it arrived on every interface
+    void receive (DuplicateMessageFilter *pFilter, uint16 ui16SessionId, std::atomic<uint32> *pNewMessages)
+    {
+        for (uint16 ui16MsgId = 1; ui16MsgId <= MESSAGES_PER_SOURCE; ui16MsgId++) {
+            for (uint32 i = 0; i < SOURCES; i++) {
+                bool bNewSession = false;
+                if (pFilter->checkAndSetReceived (toSourceAddress (i), ui16SessionId, ui16MsgId, bNewSession)) {
+                    (*pNewMessages)++;
+                }
+            }
+        }
+    }
+
+    // Returns the number of messages that were considered new
+    uint32 receiveConcurrently (DuplicateMessageFilter *pFilter, uint16 ui16SessionId)
+    {
+        std::atomic<uint32> newMessages (0U);
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < THREADS; i++) {
+            threads.push_back (std::thread (receive, pFilter, ui16SessionId, &newMessages));
+        }
+        for (unsigned int i = 0; i < THREADS; i++) {
+            threads[i].join();
+        }
+        return newMessages.load();
+    }
+}
+
+using namespace DUPLICATE_MESSAGE_FILTER_TEST;
+
+int main (int argc, char *argv[])
+{
+    DuplicateMessageFilter filter;
+    const uint32 ui32Expected = SOURCES * MESSAGES_PER_SOURCE;
+
+    // Every message must be delivered once, even by the sources that do not fit in the table
+    uint32 ui32New = receiveConcurrently (&filter, 1);
+    printf ("session 1: %u messages from %u sources were new, %u expected\n",
+            (unsigned int) ui32New, (unsigned int) SOURCES, (unsigned int) ui32Expected);
+    if (ui32New != ui32Expected) {
+        return -1;
+    }
+
+    // Receiving the same messages again must not deliver any of them
+    ui32New = receiveConcurrently (&filter, 1);
+    printf ("session 1, again: %u messages were new, 0 expected\n", (unsigned int) ui32New);
+    if (ui32New != 0) {
+        return -2;
+    }
+
+    // A new session resets the window of the source
+    bool bNewSession = false;
+    if (!filter.checkAndSetReceived (toSourceAddress (SOURCES - 1), 2, 1, bNewSession) || !bNewSession) {
+        printf ("the new session of a source was not detected\n");
+        return -3;
+    }
+    if (filter.checkAndSetReceived (toSourceAddress (SOURCES - 1), 2, 1, bNewSession) || bNewSession) {
+        printf ("the duplicate of a message of the new session was not detected\n");
+        return -4;
+    }
+
+    printf ("DuplicateMessageFilterTest passed\n");
+    return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * NetworkMessageServiceReceiveBenchmark.cpp
+ *
+ * This file is part of the IHMC Network Message Service Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Measures the throughput of the NMS receive path.  The messages from many
+ * sources are serialized in advance; then one thread per simulated interface
+ * de-serializes them and passes them to NetworkMessageServiceImpl::messageArrived(),
+ * the same way the NetworkMessageReceivers do.  Every message is received on
+ * more than one interface, so that duplicate detection is exercised as well.
+ */
+
+#include "NetworkMessageServiceImpl.h"
+#include "NetworkInterfaceManager.h"
+#include "NetworkMessageServiceListener.h"
+#include "MessageFactory.h"
+
+#include "ConfigManager.h"
+#include "NLFLib.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined (WIN32)
+    #include <winsock2.h>
+#elif defined (UNIX)
+    #include <arpa/inet.h>
+#endif
+
+using namespace NOMADSUtil;
+
+namespace BENCHMARK
+{
+    static const uint8 MSG_TYPE = 1;
+    static const uint16 PAYLOAD_LEN = 128;
+
+    class CountingListener : public NetworkMessageServiceListener
+    {
+        public:
+            CountingListener (void);
+
+            int messageArrived (const char *pszIncomingInterface, uint32 ui32SourceIPAddress, uint8 ui8MsgType,
+                                uint16 ui16MsgId, uint8 ui8HopCount, uint8 ui8TTL, bool bUnicast,
+                                const void *pMsgMetaData, uint16 ui16MsgMetaDataLen,
+                                const void *pMsg, uint16 ui16MsgLen, int64 i64Timestamp,
+                                uint64 ui64GroupMsgCount, uint64 ui64UnicastMsgCount);
+
+            std::atomic<uint64> _ui64Delivered;
+    };
+
+    struct Options
+    {
+        Options (void);
+
+        uint32 ui32Sources;
+        uint32 ui32Interfaces;
+        uint32 ui32MsgsPerSource;
+        uint32 ui32Copies;
+    };
+
+    CountingListener::CountingListener (void)
+        : NetworkMessageServiceListener (0), _ui64Delivered (0U)
+    {
+    }
+
+    int CountingListener::messageArrived (const char *, uint32, uint8, uint16, uint8, uint8, bool, const void *, uint16,
+                                          const void *, uint16, int64, uint64, uint64)
+    {
+        _ui64Delivered++;
+        return 0;
+    }
+
+    Options::Options (void)
+        : ui32Sources (256), ui32Interfaces (4), ui32MsgsPerSource (1000), ui32Copies (2)
+    {
+    }
+
+    uint32 getSourceAddress (uint32 ui32Source)
+    {
+        // 10.1.x.y, in network byte order
+        return htonl ((10U << 24) | (1U << 16) | (ui32Source + 1));
+    }
+
+    // Interface ui32Iface receives the messages of every source s such that
+    // ui32Iface is one of the ui32Copies interfaces that follow (s % ui32Interfaces)
+    bool isReceivedOn (const Options &opts, uint32 ui32Source, uint32 ui32Iface)
+    {
+        const uint32 ui32Distance = (ui32Iface + opts.ui32Interfaces - (ui32Source % opts.ui32Interfaces)) % opts.ui32Interfaces;
+        return ui32Distance < opts.ui32Copies;
+    }
+
+    // Serializes the messages of each source, back to back, in serializedMsgs[source]
+    uint16 serializeMessages (const Options &opts, std::vector<std::vector<char> > &serializedMsgs)
+    {
+        char achPayload[PAYLOAD_LEN];
+        for (uint16 i = 0; i < PAYLOAD_LEN; i++) {
+            achPayload[i] = (char) (i * 31);
+        }
+        uint16 ui16SerializedLen = 0;
+        serializedMsgs.resize (opts.ui32Sources);
+        for (uint32 ui32Source = 0; ui32Source < opts.ui32Sources; ui32Source++) {
+            for (uint32 ui32MsgIdx = 0; ui32MsgIdx < opts.ui32MsgsPerSource; ui32MsgIdx++) {
+                // The receiver increments the hop count up to the TTL: the messages are not rebroadcast
+                NetworkMessage *pNetMsg = MessageFactory::createNetworkMessageFromFields (MSG_TYPE, getSourceAddress (ui32Source), INADDR_BROADCAST,
+                                                                                          1, (uint16) ui32MsgIdx, 0, 1,
+                                                                                          NetworkMessage::CT_DataMsgComplete, false,
+                                                                                          NULL, 0, achPayload, PAYLOAD_LEN, 2);
+                ui16SerializedLen = pNetMsg->getLength();
+                const char *pBuf = (const char *) pNetMsg->getBuf();
+                serializedMsgs[ui32Source].insert (serializedMsgs[ui32Source].end(), pBuf, pBuf + ui16SerializedLen);
+                delete pNetMsg;
+            }
+        }
+        return ui16SerializedLen;
+    }
+
+    void injectMessages (NetworkInterfaceManagerListener *pNMS, const Options &opts, uint32 ui32Iface,
+                         const std::vector<std::vector<char> > &serializedMsgs, uint16 ui16SerializedLen)
+    {
+        char szIface[32];
+        sprintf (szIface, "10.%u.0.1", (unsigned int) ui32Iface + 2);
+        std::vector<uint32> sources;
+        for (uint32 ui32Source = 0; ui32Source < opts.ui32Sources; ui32Source++) {
+            if (isReceivedOn (opts, ui32Source, ui32Iface)) {
+                sources.push_back (ui32Source);
+            }
+        }
+        // Interleave the sources, while keeping the messages from each of them in order
+        for (uint32 ui32MsgIdx = 0; ui32MsgIdx < opts.ui32MsgsPerSource; ui32MsgIdx++) {
+            for (uint32 ui32Source : sources) {
+                const char *pBuf = &serializedMsgs[ui32Source][ui32MsgIdx * ui16SerializedLen];
+                NetworkMessage *pNetMsg = MessageFactory::createNetworkMessageFromBuffer (pBuf, ui16SerializedLen, 2);
+                pNetMsg->incrementHopCount();
+                pNMS->messageArrived (pNetMsg, szIface, getSourceAddress (ui32Source));
+            }
+        }
+    }
+
+    void printUsageAndExit (const char *pszProgName)
+    {
+        fprintf (stderr, "Usage: %s [-s <sources>] [-i <interfaces>] [-n <messages per source>] [-c <copies of each message>]\n",
+                 pszProgName);
+        exit (-1);
+    }
+}
+
+using namespace BENCHMARK;
+
+int main (int argc, char *argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        if ((i + 1) >= argc) {
+            printUsageAndExit (argv[0]);
+        }
+        const uint32 ui32Value = atoui32 (argv[++i]);
+        if (0 == strcmp (argv[i-1], "-s")) {
+            opts.ui32Sources = ui32Value;
+        }
+        else if (0 == strcmp (argv[i-1], "-i")) {
+            opts.ui32Interfaces = ui32Value;
+        }
+        else if (0 == strcmp (argv[i-1], "-n")) {
+            opts.ui32MsgsPerSource = ui32Value;
+        }
+        else if (0 == strcmp (argv[i-1], "-c")) {
+            opts.ui32Copies = ui32Value;
+        }
+        else {
+            printUsageAndExit (argv[0]);
+        }
+    }
+    if ((opts.ui32Sources == 0) || (opts.ui32Sources > 0xFFFE) || (opts.ui32Interfaces == 0) ||
+        (opts.ui32Copies == 0) || (opts.ui32Copies > opts.ui32Interfaces) || (opts.ui32MsgsPerSource == 0)) {
+        printUsageAndExit (argv[0]);
+    }
+
+    ConfigManager cfgMgr;
+    cfgMgr.init();
+    cfgMgr.setValue ("nms.instrumented", "false");
+    NetworkInterfaceManager netIntMgr (BROADCAST, false, false);
+    NetworkMessageServiceImpl nms (BROADCAST, false, 2, &netIntMgr);
+    if (0 != nms.init (&cfgMgr)) {
+        fprintf (stderr, "failed to initialize the NetworkMessageService\n");
+        return -2;
+    }
+    CountingListener listener;
+    nms.registerHandlerCallback (MSG_TYPE, &listener);
+
+    std::vector<std::vector<char> > serializedMsgs;
+    const uint16 ui16SerializedLen = serializeMessages (opts, serializedMsgs);
+
+    const int64 i64Start = getTimeInMilliseconds();
+    std::vector<std::thread> threads;
+    for (uint32 ui32Iface = 0; ui32Iface < opts.ui32Interfaces; ui32Iface++) {
+        threads.emplace_back (injectMessages, &nms, std::cref (opts), ui32Iface, std::cref (serializedMsgs), ui16SerializedLen);
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    const int64 i64ElapsedTime = getTimeInMilliseconds() - i64Start;
+
+    const uint64 ui64Unique = (uint64) opts.ui32Sources * opts.ui32MsgsPerSource;
+    const uint64 ui64Injected = ui64Unique * opts.ui32Copies;
+    const uint64 ui64Delivered = listener._ui64Delivered.load();
+    const double dSeconds = (i64ElapsedTime > 0 ? i64ElapsedTime : 1) / 1000.0;
+    printf ("sources: %u, interfaces: %u, copies per message: %u\n",
+            opts.ui32Sources, opts.ui32Interfaces, opts.ui32Copies);
+    printf ("injected %llu messages (%llu unique) in %lld ms: %.0f msgs/sec\n",
+            (unsigned long long) ui64Injected, (unsigned long long) ui64Unique,
+            (long long) i64ElapsedTime, ui64Injected / dSeconds);
+    printf ("delivered %llu messages; %llu duplicates suppressed; %llu late duplicates delivered\n",
+            (unsigned long long) ui64Delivered,
+            (unsigned long long) (ui64Injected > ui64Delivered ? ui64Injected - ui64Delivered : 0),
+            (unsigned long long) (ui64Delivered > ui64Unique ? ui64Delivered - ui64Unique : 0));
+
+    nms.deregisterHandlerCallback (MSG_TYPE, &listener);
+    return (ui64Delivered >= ui64Unique) ? 0 : -3;
+}
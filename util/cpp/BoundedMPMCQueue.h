@@ -0,0 +1,151 @@
+/*
+ * BoundedMPMCQueue.h
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Fixed-capacity FIFO queue that any number of threads can enqueue into
+ * and dequeue from without locks (D. Vyukov's bounded MPMC queue).
+ * Each cell carries a sequence number that tells producers and consumers
+ * whether it is free or full, so that a thread only contends with others
+ * for the enqueue or the dequeue position, never for the cell itself.
+ */
+
+#ifndef INCL_BOUNDED_MPMC_QUEUE_H
+#define INCL_BOUNDED_MPMC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+#include "FTypes.h"
+
+namespace NOMADSUtil
+{
+    template <typename T>
+    class BoundedMPMCQueue
+    {
+        public:
+            // ui32Size is rounded up to a power of 2
+            explicit BoundedMPMCQueue (uint32 ui32Size);
+            ~BoundedMPMCQueue (void);
+
+            // Returns false if the queue is full
+            bool enqueue (const T &element);
+
+            // Returns false if the queue is empty
+            bool dequeue (T &element);
+
+            // Approximate, when other threads are using the queue
+            bool isEmpty (void) const;
+
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> sequence;
+                T element;
+            };
+
+            BoundedMPMCQueue (const BoundedMPMCQueue &);
+            BoundedMPMCQueue & operator = (const BoundedMPMCQueue &);
+
+        private:
+            Cell *_pCells;
+            size_t _mask;
+            char _padding0[64];
+            std::atomic<size_t> _enqueuePos;
+            char _padding1[64];
+            std::atomic<size_t> _dequeuePos;
+    };
+
+    template <typename T>
+    BoundedMPMCQueue<T>::BoundedMPMCQueue (uint32 ui32Size)
+        : _enqueuePos (0),
+          _dequeuePos (0)
+    {
+        size_t size = 2;
+        while (size < ui32Size) {
+            size <<= 1;
+        }
+        _pCells = new Cell[size];
+        _mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            _pCells[i].sequence.store (i, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename T>
+    BoundedMPMCQueue<T>::~BoundedMPMCQueue (void)
+    {
+        delete[] _pCells;
+    }
+
+    template <typename T>
+    bool BoundedMPMCQueue<T>::enqueue (const T &element)
+    {
+        size_t pos = _enqueuePos.load (std::memory_order_relaxed);
+        while (true) {
+            Cell *pCell = &_pCells[pos & _mask];
+            const size_t seq = pCell->sequence.load (std::memory_order_acquire);
+            const ptrdiff_t diff = (ptrdiff_t) seq - (ptrdiff_t) pos;
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed)) {
+                    pCell->element = element;
+                    pCell->sequence.store (pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                // The cell still holds the element enqueued one lap earlier
+                return false;
+            }
+            else {
+                pos = _enqueuePos.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <typename T>
+    bool BoundedMPMCQueue<T>::dequeue (T &element)
+    {
+        size_t pos = _dequeuePos.load (std::memory_order_relaxed);
+        while (true) {
+            Cell *pCell = &_pCells[pos & _mask];
+            const size_t seq = pCell->sequence.load (std::memory_order_acquire);
+            const ptrdiff_t diff = (ptrdiff_t) seq - (ptrdiff_t) (pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed)) {
+                    element = pCell->element;
+                    pCell->sequence.store (pos + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = _dequeuePos.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <typename T>
+    bool BoundedMPMCQueue<T>::isEmpty (void) const
+    {
+        const size_t pos = _dequeuePos.load (std::memory_order_acquire);
+        return _pCells[pos & _mask].sequence.load (std::memory_order_acquire) != (pos + 1);
+    }
+}
+
+#endif   // #ifndef INCL_BOUNDED_MPMC_QUEUE_H
@@ -0,0 +1,374 @@
+/*
+ * IndexedPtrHeap.h
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Priority queue that stores pointers to objects, each one identified by a
+ * unique string key and ordered by a priority of type P, which must define
+ * operator <.  The element with the highest priority is at the top.
+ * The queue is a 4-ary heap of (priority, entry) pairs, so that comparisons
+ * do not need to dereference the elements, plus a hashtable from the keys to
+ * the entries, each of which knows its position in the heap: elements can be
+ * looked up by key in constant time, and removed or re-prioritized by key in
+ * logarithmic time.
+ * Like PtrLList, the heap does not delete the elements it stores, unless
+ * requested through removeAll() or removeIf().
+ */
+
+#ifndef INCL_INDEXED_PTR_HEAP_H
+#define INCL_INDEXED_PTR_HEAP_H
+
+#include <stddef.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NOMADSUtil
+{
+    template <class T, class P>
+    class IndexedPtrHeap
+    {
+        public:
+            IndexedPtrHeap (void);
+            ~IndexedPtrHeap (void);
+
+            // Inserts pel, unless an element with the same key is already in the heap:
+            // in that case pel is not inserted, and it is returned.  Returns NULL otherwise.
+            T * insertUnique (const char *pszKey, const P &priority, T *pel);
+
+            // Inserts pel; if an element with the same key is already in the heap,
+            // pel replaces it, and the replaced element is returned.  Returns NULL otherwise.
+            T * insertOrReplace (const char *pszKey, const P &priority, T *pel);
+
+            // Changes the priority of the element with the specified key.
+            // Returns false if there is no such element.
+            bool updatePriority (const char *pszKey, const P &priority);
+
+            T * get (const char *pszKey) const;
+            bool getPriority (const char *pszKey, P &priority) const;
+            bool contains (const char *pszKey) const;
+
+            // Returns the element with the highest priority, or NULL if the heap is empty
+            T * getFirst (void) const;
+
+            // Removes and returns the element with the highest priority, or NULL if the heap is empty
+            T * removeFirst (void);
+
+            // Returns the removed element, or NULL if there is no element with the specified key
+            T * remove (const char *pszKey);
+
+            // Removes all the elements for which isRemovable (pel) returns true, and
+            // returns how many were removed.  Takes linear time, regardless of how many
+            // elements are removed.
+            template <class Predicate>
+            unsigned int removeIf (Predicate isRemovable, bool bDeleteValues);
+
+            void removeAll (bool bDeleteValues = false);
+
+            // Elements in heap order, which is NOT sorted by priority except for the first one.
+            // ui < getCount() must hold.
+            T * getAt (unsigned int ui) const;
+
+            unsigned int getCount (void) const;
+            bool isEmpty (void) const;
+
+        private:
+            static const size_t ARITY = 4;
+
+            struct Entry
+            {
+                T *pel;
+                size_t pos;
+            };
+
+            typedef std::unordered_map<std::string, Entry> EntryMap;
+
+            struct Slot
+            {
+                P priority;
+                typename EntryMap::value_type *pEntry;
+            };
+
+            IndexedPtrHeap (const IndexedPtrHeap &);
+            IndexedPtrHeap & operator = (const IndexedPtrHeap &);
+
+            void place (size_t pos, const Slot &slot);
+            void siftUp (size_t pos);
+            void siftDown (size_t pos);
+            void removeAt (size_t pos);
+
+        private:
+            std::vector<Slot> _heap;
+            EntryMap _entries;
+    };
+
+    template <class T, class P>
+    IndexedPtrHeap<T, P>::IndexedPtrHeap (void)
+    {
+    }
+
+    template <class T, class P>
+    IndexedPtrHeap<T, P>::~IndexedPtrHeap (void)
+    {
+    }
+
+    template <class T, class P>
+    T * IndexedPtrHeap<T, P>::insertUnique (const char *pszKey, const P &priority, T *pel)
+    {
+        if (pszKey == NULL) {
+            return pel;
+        }
+        std::pair<typename EntryMap::iterator, bool> res = _entries.insert (typename EntryMap::value_type (pszKey, Entry()));
+        if (!res.second) {
+            return pel;
+        }
+        res.first->second.pel = pel;
+        res.first->second.pos = _heap.size();
+        Slot slot = { priority, &(*res.first) };
+        _heap.push_back (slot);
+        siftUp (_heap.size() - 1);
+        return NULL;
+    }
+
+    template <class T, class P>
+    T * IndexedPtrHeap<T, P>::insertOrReplace (const char *pszKey, const P &priority, T *pel)
+    {
+        if (pszKey == NULL) {
+            return pel;
+        }
+        typename EntryMap::iterator it = _entries.find (pszKey);
+        if (it == _entries.end()) {
+            return insertUnique (pszKey, priority, pel);
+        }
+        T *pOldEl = it->second.pel;
+        it->second.pel = pel;
+        updatePriority (pszKey, priority);
+        return pOldEl;
+    }
+
+    template <class T, class P>
+    bool IndexedPtrHeap<T, P>::updatePriority (const char *pszKey, const P &priority)
+    {
+        if (pszKey == NULL) {
+            return false;
+        }
+        typename EntryMap::const_iterator it = _entries.find (pszKey);
+        if (it == _entries.end()) {
+            return false;
+        }
+        const size_t pos = it->second.pos;
+        const bool bIncreased = _heap[pos].priority < priority;
+        _heap[pos].priority = priority;
+        if (bIncreased) {
+            siftUp (pos);
+        }
+        else {
+            siftDown (pos);
+        }
+        return true;
+    }
+
+    template <class T, class P>
+    T * IndexedPtrHeap<T, P>::get (const char *pszKey) const
+    {
+        if (pszKey == NULL) {
+            return NULL;
+        }
+        typename EntryMap::const_iterator it = _entries.find (pszKey);
+        return (it == _entries.end() ? NULL : it->second.pel);
+    }
+
+    template <class T, class P>
+    bool IndexedPtrHeap<T, P>::getPriority (const char *pszKey, P &priority) const
+    {
+        if (pszKey == NULL) {
+            return false;
+        }
+        typename EntryMap::const_iterator it = _entries.find (pszKey);
+        if (it == _entries.end()) {
+            return false;
+        }
+        priority = _heap[it->second.pos].priority;
+        return true;
+    }
+
+    template <class T, class P>
+    bool IndexedPtrHeap<T, P>::contains (const char *pszKey) const
+    {
+        return (pszKey != NULL) && (_entries.find (pszKey) != _entries.end());
+    }
+
+    template <class T, class P>
+    T * IndexedPtrHeap<T, P>::getFirst (void) const
+    {
+        return (_heap.empty() ? NULL : _heap[0].pEntry->second.pel);
+    }
+
+    template <class T, class P>
+    T * IndexedPtrHeap<T, P>::removeFirst (void)
+    {
+        if (_heap.empty()) {
+            return NULL;
+        }
+        T *pel = _heap[0].pEntry->second.pel;
+        removeAt (0);
+        return pel;
+    }
+
+    template <class T, class P>
+    T * IndexedPtrHeap<T, P>::remove (const char *pszKey)
+    {
+        if (pszKey == NULL) {
+            return NULL;
+        }
+        typename EntryMap::const_iterator it = _entries.find (pszKey);
+        if (it == _entries.end()) {
+            return NULL;
+        }
+        T *pel = it->second.pel;
+        removeAt (it->second.pos);
+        return pel;
+    }
+
+    template <class T, class P>
+    template <class Predicate>
+    unsigned int IndexedPtrHeap<T, P>::removeIf (Predicate isRemovable, bool bDeleteValues)
+    {
+        // Compact the slots that are kept, then restore the heap property bottom-up
+        size_t kept = 0;
+        for (size_t i = 0; i < _heap.size(); i++) {
+            T *pel = _heap[i].pEntry->second.pel;
+            if (isRemovable (pel)) {
+                _entries.erase (_entries.find (_heap[i].pEntry->first));
+                if (bDeleteValues) {
+                    delete pel;
+                }
+            }
+            else {
+                place (kept++, _heap[i]);
+            }
+        }
+        const unsigned int uiRemoved = (unsigned int) (_heap.size() - kept);
+        _heap.erase (_heap.begin() + kept, _heap.end());
+        if (kept > 1) {
+            for (size_t i = (kept - 2) / ARITY + 1; i > 0; i--) {
+                siftDown (i - 1);
+            }
+        }
+        return uiRemoved;
+    }
+
+    template <class T, class P>
+    void IndexedPtrHeap<T, P>::removeAll (bool bDeleteValues)
+    {
+        if (bDeleteValues) {
+            for (size_t i = 0; i < _heap.size(); i++) {
+                delete _heap[i].pEntry->second.pel;
+            }
+        }
+        _heap.clear();
+        _entries.clear();
+    }
+
+    template <class T, class P>
+    inline T * IndexedPtrHeap<T, P>::getAt (unsigned int ui) const
+    {
+        return _heap[ui].pEntry->second.pel;
+    }
+
+    template <class T, class P>
+    inline unsigned int IndexedPtrHeap<T, P>::getCount (void) const
+    {
+        return (unsigned int) _heap.size();
+    }
+
+    template <class T, class P>
+    inline bool IndexedPtrHeap<T, P>::isEmpty (void) const
+    {
+        return _heap.empty();
+    }
+
+    template <class T, class P>
+    inline void IndexedPtrHeap<T, P>::place (size_t pos, const Slot &slot)
+    {
+        _heap[pos] = slot;
+        _heap[pos].pEntry->second.pos = pos;
+    }
+
+    template <class T, class P>
+    void IndexedPtrHeap<T, P>::siftUp (size_t pos)
+    {
+        const Slot slot = _heap[pos];
+        while (pos > 0) {
+            const size_t parent = (pos - 1) / ARITY;
+            if (!(_heap[parent].priority < slot.priority)) {
+                break;
+            }
+            place (pos, _heap[parent]);
+            pos = parent;
+        }
+        place (pos, slot);
+    }
+
+    template <class T, class P>
+    void IndexedPtrHeap<T, P>::siftDown (size_t pos)
+    {
+        const Slot slot = _heap[pos];
+        const size_t size = _heap.size();
+        while (true) {
+            const size_t firstChild = pos * ARITY + 1;
+            if (firstChild >= size) {
+                break;
+            }
+            const size_t lastChild = (firstChild + ARITY < size) ? firstChild + ARITY : size;
+            size_t maxChild = firstChild;
+            for (size_t child = firstChild + 1; child < lastChild; child++) {
+                if (_heap[maxChild].priority < _heap[child].priority) {
+                    maxChild = child;
+                }
+            }
+            if (!(slot.priority < _heap[maxChild].priority)) {
+                break;
+            }
+            place (pos, _heap[maxChild]);
+            pos = maxChild;
+        }
+        place (pos, slot);
+    }
+
+    template <class T, class P>
+    void IndexedPtrHeap<T, P>::removeAt (size_t pos)
+    {
+        _entries.erase (_entries.find (_heap[pos].pEntry->first));
+        const size_t last = _heap.size() - 1;
+        if (pos == last) {
+            _heap.pop_back();
+            return;
+        }
+        const bool bIncreased = _heap[pos].priority < _heap[last].priority;
+        place (pos, _heap[last]);
+        _heap.pop_back();
+        if (bIncreased) {
+            siftUp (pos);
+        }
+        else {
+            siftDown (pos);
+        }
+    }
+}
+
+#endif   // #ifndef INCL_INDEXED_PTR_HEAP_H
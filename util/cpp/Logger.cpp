@@ -13,6 +13,11 @@
 #include <time.h>
 #include <string.h>
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "Logger.h"
 #include "HTTPClient.h"
 #include "Json.h"
@@ -30,7 +35,10 @@
         #define snprintf _snprintf
     #endif
 #elif defined (UNIX)
+    #include <errno.h>
     #include <syslog.h>
+    #include <unistd.h>
+    #include <sys/uio.h>
     #if defined (OSX)
         #include <sys/syslimits.h>
         #define INADDR_NONE 0xffffffff
@@ -103,6 +111,504 @@ namespace LOGGER
         return String (buffer);
     }
 
+#if defined (WIN32)
+    WORD toEventLogType (uint8 ui8DbgDetLevel)
+    {
+        switch (ui8DbgDetLevel) {
+            case Logger::L_SevereError:
+            case Logger::L_MildError:
+                return EVENTLOG_ERROR_TYPE;
+            case Logger::L_Warning:
+                return EVENTLOG_WARNING_TYPE;
+            default:
+                return EVENTLOG_INFORMATION_TYPE;
+        }
+    }
+#elif defined (LINUX)
+    int toSyslogPriority (uint8 ui8DbgDetLevel)
+    {
+        switch (ui8DbgDetLevel) {
+            case Logger::L_SevereError:
+                return LOG_CRIT;
+            case Logger::L_MildError:
+                return LOG_ERR;
+            case Logger::L_Warning:
+                return LOG_WARNING;
+            case Logger::L_Info:
+                return LOG_INFO;
+            default:
+                return LOG_DEBUG;
+        }
+    }
+#endif
+
+    // Message logged in asynchronous mode.  The source and the message are
+    // formatted by the logging thread into achText ("<source>\0<message>"),
+    // or into pszOverflow, allocated by malloc(), when they do not fit.
+    struct AsyncLogRecord
+    {
+        static const uint32 TEXT_SIZE = 472;
+
+        const char * getSource (void) const;
+        const char * getMessage (void) const;
+
+        int64 i64Time;
+        uint64 ui64SeqId;
+        char *pszOverflow;
+        uint32 ui32SourceLen;
+        uint32 ui32MessageLen;
+        uint16 ui16Indent;
+        uint8 ui8Level;
+        char achText[TEXT_SIZE];
+    };
+
+    inline const char * AsyncLogRecord::getSource (void) const
+    {
+        return (pszOverflow != NULL) ? pszOverflow : achText;
+    }
+
+    inline const char * AsyncLogRecord::getMessage (void) const
+    {
+        return getSource() + ui32SourceLen + 1;
+    }
+
+    // Ring of records written by a single logging thread and read by the
+    // writer thread, without locks
+    class AsyncLogRing
+    {
+        public:
+            explicit AsyncLogRing (uint32 ui32Size);
+            ~AsyncLogRing (void);
+
+            // Returns NULL if the ring is full.  The record is published by
+            // commit().
+            AsyncLogRecord * reserve (void);
+            void commit (void);
+
+            // Records that can be read, starting from peek (0)
+            uint32 getPendingCount (void) const;
+            AsyncLogRecord * peek (uint32 ui32Offset);
+            void consume (uint32 ui32Count);
+
+            std::atomic<bool> bThreadExited;
+            std::atomic<bool> bWriterStopped;
+
+        private:
+            AsyncLogRing (const AsyncLogRing &);
+            AsyncLogRing & operator = (const AsyncLogRing &);
+
+            const uint32 _ui32Mask;
+            AsyncLogRecord *_pRecords;
+            // Written by the logging thread only
+            std::atomic<uint32> _ui32Head;
+            char _padding[64];
+            // Written by the writer thread only
+            std::atomic<uint32> _ui32Tail;
+    };
+
+    AsyncLogRing::AsyncLogRing (uint32 ui32Size)
+        : bThreadExited (false),
+          bWriterStopped (false),
+          _ui32Mask (ui32Size - 1),
+          _pRecords (new AsyncLogRecord[ui32Size]),
+          _ui32Head (0),
+          _ui32Tail (0)
+    {
+    }
+
+    AsyncLogRing::~AsyncLogRing (void)
+    {
+        // Release the messages that were never written
+        for (uint32 i = 0; i < getPendingCount(); i++) {
+            free (peek (i)->pszOverflow);
+        }
+        delete[] _pRecords;
+    }
+
+    inline AsyncLogRecord * AsyncLogRing::reserve (void)
+    {
+        const uint32 ui32Head = _ui32Head.load (std::memory_order_relaxed);
+        if ((ui32Head - _ui32Tail.load (std::memory_order_acquire)) > _ui32Mask) {
+            return NULL;
+        }
+        return &_pRecords[ui32Head & _ui32Mask];
+    }
+
+    inline void AsyncLogRing::commit (void)
+    {
+        _ui32Head.store (_ui32Head.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    inline uint32 AsyncLogRing::getPendingCount (void) const
+    {
+        return _ui32Head.load (std::memory_order_acquire) - _ui32Tail.load (std::memory_order_relaxed);
+    }
+
+    inline AsyncLogRecord * AsyncLogRing::peek (uint32 ui32Offset)
+    {
+        return &_pRecords[(_ui32Tail.load (std::memory_order_relaxed) + ui32Offset) & _ui32Mask];
+    }
+
+    inline void AsyncLogRing::consume (uint32 ui32Count)
+    {
+        _ui32Tail.store (_ui32Tail.load (std::memory_order_relaxed) + ui32Count, std::memory_order_release);
+    }
+
+    // Rings of the current thread, one for each Logger in asynchronous mode.
+    // When the thread terminates, the writers release the rings once they
+    // have written the pending messages.
+    struct ThreadAsyncLogRings
+    {
+        ~ThreadAsyncLogRings (void);
+
+        std::vector<std::pair<uint64, std::shared_ptr<AsyncLogRing> > > rings;
+    };
+
+    ThreadAsyncLogRings::~ThreadAsyncLogRings (void)
+    {
+        for (size_t i = 0; i < rings.size(); i++) {
+            rings[i].second->bThreadExited = true;
+        }
+    }
+
+    thread_local ThreadAsyncLogRings tlAsyncLogRings;
+    std::atomic<uint64> ui64NextAsyncLogWriterId (1);
+
+#if defined (UNIX)
+    void writeFully (int fd, struct iovec *pIov, int iCount)
+    {
+        while (iCount > 0) {
+            ssize_t written = writev (fd, pIov, iCount);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            while ((iCount > 0) && ((size_t) written >= pIov->iov_len)) {
+                written -= pIov->iov_len;
+                pIov++;
+                iCount--;
+            }
+            if (iCount > 0) {
+                pIov->iov_base = (char *) pIov->iov_base + written;
+                pIov->iov_len -= written;
+            }
+        }
+    }
+#endif
+}
+
+namespace NOMADSUtil
+{
+    // Writes the messages logged in asynchronous mode
+    class AsyncLogWriter : public ManageableThread
+    {
+        public:
+            AsyncLogWriter (Logger *pLogger, uint32 ui32RingSize);
+            ~AsyncLogWriter (void);
+
+            LOGGER::AsyncLogRing * getRingForCurrentThread (void);
+            uint64 nextSeqId (void);
+            void messageDropped (void);
+            uint64 getDroppedMessagesCount (void) const;
+
+            void run (void);
+
+        private:
+            struct Prefix
+            {
+                char szTime[24];
+                char szLevel[8];
+            };
+
+            // Writes the messages pending in all the rings and returns their number
+            uint32 drain (void);
+            void write (void);
+            void writeToFile (FILE *pFile, bool bErrorsOnly);
+
+            static const int64 IDLE_SLEEP_TIME = 5;
+
+            Logger *_pLogger;
+            const uint64 _ui64Id;
+            const uint32 _ui32RingSize;
+            std::atomic<uint64> _ui64NextSeqId;
+            std::atomic<uint64> _ui64Dropped;
+            uint64 _ui64ReportedDrops;
+            Mutex _mRings;
+            std::vector<std::shared_ptr<LOGGER::AsyncLogRing> > _rings;
+            // Used only by drain()
+            std::vector<LOGGER::AsyncLogRecord *> _batch;
+            std::vector<Prefix> _prefixes;
+            LOGGER::AsyncLogRecord _dropsRecord;
+    };
+
+    AsyncLogWriter::AsyncLogWriter (Logger *pLogger, uint32 ui32RingSize)
+        : _pLogger (pLogger),
+          _ui64Id (LOGGER::ui64NextAsyncLogWriterId++),
+          _ui32RingSize (ui32RingSize),
+          _ui64NextSeqId (0),
+          _ui64Dropped (0),
+          _ui64ReportedDrops (0)
+    {
+        _dropsRecord.pszOverflow = NULL;
+        _dropsRecord.ui16Indent = 0;
+    }
+
+    AsyncLogWriter::~AsyncLogWriter (void)
+    {
+        if (isRunning()) {
+            requestTerminationAndWait();
+        }
+    }
+
+    LOGGER::AsyncLogRing * AsyncLogWriter::getRingForCurrentThread (void)
+    {
+        std::vector<std::pair<uint64, std::shared_ptr<LOGGER::AsyncLogRing> > > &rings = LOGGER::tlAsyncLogRings.rings;
+        for (size_t i = 0; i < rings.size(); i++) {
+            if (rings[i].first == _ui64Id) {
+                return rings[i].second.get();
+            }
+        }
+
+        // First message logged by this thread: forget the rings of the
+        // writers that have been stopped, and register a new one
+        for (size_t i = rings.size(); i > 0; i--) {
+            if (rings[i-1].second->bWriterStopped) {
+                rings.erase (rings.begin() + (i-1));
+            }
+        }
+        std::shared_ptr<LOGGER::AsyncLogRing> pRing (new LOGGER::AsyncLogRing (_ui32RingSize));
+        _mRings.lock();
+        _rings.push_back (pRing);
+        _mRings.unlock();
+        rings.push_back (std::make_pair (_ui64Id, pRing));
+        return pRing.get();
+    }
+
+    inline uint64 AsyncLogWriter::nextSeqId (void)
+    {
+        return _ui64NextSeqId.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    inline void AsyncLogWriter::messageDropped (void)
+    {
+        _ui64Dropped.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    uint64 AsyncLogWriter::getDroppedMessagesCount (void) const
+    {
+        return _ui64Dropped.load (std::memory_order_relaxed);
+    }
+
+    void AsyncLogWriter::run (void)
+    {
+        started();
+        while (!terminationRequested()) {
+            if (drain() == 0) {
+                sleepForMilliseconds (IDLE_SLEEP_TIME);
+            }
+        }
+        // Write what has been logged before asynchronous mode was disabled
+        drain();
+        _mRings.lock();
+        for (size_t i = 0; i < _rings.size(); i++) {
+            _rings[i]->bWriterStopped = true;
+        }
+        _mRings.unlock();
+        terminating();
+    }
+
+    uint32 AsyncLogWriter::drain (void)
+    {
+        _mRings.lock();
+        std::vector<std::shared_ptr<LOGGER::AsyncLogRing> > rings (_rings);
+        _mRings.unlock();
+
+        std::vector<uint32> counts (rings.size());
+        _batch.clear();
+        for (size_t i = 0; i < rings.size(); i++) {
+            counts[i] = rings[i]->getPendingCount();
+            for (uint32 j = 0; j < counts[i]; j++) {
+                _batch.push_back (rings[i]->peek (j));
+            }
+        }
+        const uint32 ui32Count = (uint32) _batch.size();
+
+        // Messages are stamped with a sequence number when they are logged:
+        // write them in that order, regardless of the ring they were put into
+        struct BySeqId
+        {
+            bool operator () (const LOGGER::AsyncLogRecord *pLeft, const LOGGER::AsyncLogRecord *pRight) const
+            {
+                return pLeft->ui64SeqId < pRight->ui64SeqId;
+            }
+        };
+        std::sort (_batch.begin(), _batch.end(), BySeqId());
+
+        const uint64 ui64Dropped = getDroppedMessagesCount();
+        if (ui64Dropped > _ui64ReportedDrops) {
+            int iLen = snprintf (_dropsRecord.achText, sizeof (_dropsRecord.achText),
+                                 "Logger%c%llu messages dropped because the logging queue was full\n", '\0',
+                                 (unsigned long long) (ui64Dropped - _ui64ReportedDrops));
+            _dropsRecord.i64Time = getTimeInMilliseconds();
+            _dropsRecord.ui8Level = Logger::L_Warning;
+            _dropsRecord.ui32SourceLen = 6;
+            _dropsRecord.ui32MessageLen = std::min<uint32> ((uint32) iLen, sizeof (_dropsRecord.achText) - 1) - 7;
+            _batch.push_back (&_dropsRecord);
+            _ui64ReportedDrops = ui64Dropped;
+        }
+
+        if (!_batch.empty()) {
+            write();
+        }
+        for (size_t i = 0; i < rings.size(); i++) {
+            for (uint32 j = 0; j < counts[i]; j++) {
+                free (rings[i]->peek (j)->pszOverflow);
+            }
+            rings[i]->consume (counts[i]);
+        }
+
+        // Release the rings of the threads that have terminated
+        _mRings.lock();
+        for (size_t i = _rings.size(); i > 0; i--) {
+            if (_rings[i-1]->bThreadExited && (_rings[i-1]->getPendingCount() == 0)) {
+                _rings.erase (_rings.begin() + (i-1));
+            }
+        }
+        _mRings.unlock();
+        return ui32Count;
+    }
+
+    void AsyncLogWriter::write (void)
+    {
+        _prefixes.resize (_batch.size());
+        for (size_t i = 0; i < _batch.size(); i++) {
+            const LOGGER::AsyncLogRecord *pRecord = _batch[i];
+            if (_pLogger->_bDisplayRelativeTime) {
+                snprintf (_prefixes[i].szTime, sizeof (_prefixes[i].szTime), "%lu - ",
+                          (unsigned long) (uint32) (pRecord->i64Time - _pLogger->_i64StartTime));
+            }
+            else {
+                time_t t = (time_t) (pRecord->i64Time / 1000);
+                struct tm *ptm = localtime (&t);
+                snprintf (_prefixes[i].szTime, sizeof (_prefixes[i].szTime), "%02d:%02d:%02d - ",
+                          ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
+            }
+            snprintf (_prefixes[i].szLevel, sizeof (_prefixes[i].szLevel), " %d ", (int) pRecord->ui8Level);
+        }
+
+        // Serialize with the messages that may be logged synchronously,
+        // while asynchronous mode is being enabled or disabled
+        _pLogger->_mLog.lock();
+        if (_pLogger->_bWriteToScreen) {
+#if defined (ANDROID)
+            for (size_t i = 0; i < _batch.size(); i++) {
+                __android_log_write (LOGGER::toAndroidLoggingLevel (_batch[i]->ui8Level),
+                                     _batch[i]->getSource(), _batch[i]->getMessage());
+            }
+#else
+            writeToFile (stdout, false);
+#endif
+        }
+        if (_pLogger->_bServiceDialogOutput) {
+            for (size_t i = 0; i < _batch.size(); i++) {
+                char szMsg[PATH_MAX];
+                snprintf (szMsg, sizeof (szMsg), "Source: %s\nDebug level: %d\nMessage: %s\n",
+                          _batch[i]->getSource(), (int) _batch[i]->ui8Level, _batch[i]->getMessage());
+                #if defined (WIN32)
+                    MessageBox (NULL, szMsg, "warning", MB_OK);
+                #else
+                    fputs (szMsg, stderr);
+                #endif
+            }
+        }
+        if ((_pLogger->_bWriteToFile) && (_pLogger->_fileLog != NULL)) {
+            writeToFile (_pLogger->_fileLog, false);
+        }
+        if ((_pLogger->_bWriteToErrorLogFile) && (_pLogger->_fileErrorLog != NULL)) {
+            writeToFile (_pLogger->_fileErrorLog, true);
+        }
+        for (size_t i = 0; i < _batch.size(); i++) {
+            const LOGGER::AsyncLogRecord *pRecord = _batch[i];
+            if (_pLogger->_bWriteToNetwork) {
+                char szBuf[65535];
+                snprintf (szBuf, sizeof (szBuf), "%s %d %s", pRecord->getSource(), (int) pRecord->ui8Level, pRecord->getMessage());
+                _pLogger->_pDGSocket->sendTo (_pLogger->_ui32DestAddr, _pLogger->_ui16DestPort, szBuf, (int) strlen (szBuf));
+            }
+            if (_pLogger->_bWriteToSplunk) {
+                String json (LOGGER::toSplunkEvent (pRecord->i64Time, pRecord->ui8Level, _pLogger->_localHost,
+                                                    pRecord->getSource(), pRecord->getMessage()));
+                HTTPClient::postData (_pLogger->_splunkSrvIPAddr, _pLogger->_ui16DestPort, "/services/collector/event", json);
+            }
+            if ((_pLogger->_bWriteToOSLog) && (pRecord->ui8Level <= _pLogger->_uchOSLogDebugLevel)) {
+                #if defined (WIN32)
+                    LPCTSTR lpStrings[1];
+                    lpStrings[0] = pRecord->getMessage();
+                    ReportEvent (_pLogger->_eventLogHandle, LOGGER::toEventLogType (pRecord->ui8Level), 0, 1, NULL, 1, 0, lpStrings, NULL);
+                #elif defined (LINUX)
+                    syslog (LOGGER::toSyslogPriority (pRecord->ui8Level), "%s", pRecord->getMessage());
+                #endif
+            }
+        }
+        _pLogger->_mLog.unlock();
+    }
+
+    void AsyncLogWriter::writeToFile (FILE *pFile, bool bErrorsOnly)
+    {
+#if defined (UNIX)
+        // Write the whole batch with as few system calls as possible
+        static const int MAX_IOV_COUNT = 256;
+        struct iovec iov[MAX_IOV_COUNT];
+        int iCount = 0;
+        fflush (pFile);
+        const int fd = fileno (pFile);
+        for (size_t i = 0; i < _batch.size(); i++) {
+            LOGGER::AsyncLogRecord *pRecord = _batch[i];
+            if (bErrorsOnly && (pRecord->ui8Level > Logger::L_Warning)) {
+                continue;
+            }
+            if (pRecord->ui16Indent > 0) {
+                // The indentation goes through the stream, after the
+                // messages that precede it
+                LOGGER::writeFully (fd, iov, iCount);
+                iCount = 0;
+                _pLogger->writeIndentSpace (pFile, pRecord->ui16Indent);
+                fflush (pFile);
+            }
+            iov[iCount].iov_base = _prefixes[i].szTime;
+            iov[iCount++].iov_len = strlen (_prefixes[i].szTime);
+            iov[iCount].iov_base = (void *) pRecord->getSource();
+            iov[iCount++].iov_len = pRecord->ui32SourceLen;
+            iov[iCount].iov_base = _prefixes[i].szLevel;
+            iov[iCount++].iov_len = strlen (_prefixes[i].szLevel);
+            iov[iCount].iov_base = (void *) pRecord->getMessage();
+            iov[iCount++].iov_len = pRecord->ui32MessageLen;
+            if (iCount == MAX_IOV_COUNT) {
+                LOGGER::writeFully (fd, iov, iCount);
+                iCount = 0;
+            }
+        }
+        if (iCount > 0) {
+            LOGGER::writeFully (fd, iov, iCount);
+        }
+#else
+        for (size_t i = 0; i < _batch.size(); i++) {
+            const LOGGER::AsyncLogRecord *pRecord = _batch[i];
+            if (bErrorsOnly && (pRecord->ui8Level > Logger::L_Warning)) {
+                continue;
+            }
+            if (pRecord->ui16Indent > 0) {
+                _pLogger->writeIndentSpace (pFile, pRecord->ui16Indent);
+            }
+            fputs (_prefixes[i].szTime, pFile);
+            fwrite (pRecord->getSource(), 1, pRecord->ui32SourceLen, pFile);
+            fputs (_prefixes[i].szLevel, pFile);
+            fwrite (pRecord->getMessage(), 1, pRecord->ui32MessageLen, pFile);
+        }
+        fflush (pFile);
+#endif
+    }
 }
 
 namespace NOMADSUtil
@@ -117,6 +623,7 @@ const char * Logger::SCREEN_LOGGING_PROPERTY = "util.logger.out.screen.enabled";
 const char * Logger::FILE_LOGGING_PROPERTY = "util.logger.out.file.enabled";
 const char * Logger::ERROR_FILE_LOGGING_PROPERTY = "util.logger.error.file.path";
 const char * Logger::LOGGING_LEVEL_PROPERTY = "util.logger.detail";
+const char * Logger::ASYNC_LOGGING_PROPERTY = "util.logger.async.enabled";
 
 Logger::Logger (void)
     : _i64StartTime (getTimeInMilliseconds())
@@ -144,6 +651,10 @@ Logger::Logger (void)
     _bServiceDialogOutput = false;
     _usCurrIndent = 0;
     _bDisplayRelativeTime = true;
+    _bAsyncMode = false;
+    _ui32AsyncLoggers = 0;
+    _pAsyncWriter = NULL;
+    _ui64AsyncDropped = 0;
     #if defined (WIN32)
         _eventLogHandle = NULL;
     #endif
@@ -151,6 +662,10 @@ Logger::Logger (void)
 
 Logger::~Logger (void)
 {
+    // Waits for the threads that are logging asynchronously: the ones that
+    // log from now on take _mLog, so the files are closed while holding it
+    disableAsyncMode();
+    _mLog.lock();
     if (_fileLog) {
         fclose (_fileLog);
         _fileLog = NULL;
@@ -159,6 +674,9 @@ Logger::~Logger (void)
         fclose (_fileErrorLog);
         _fileErrorLog = NULL;
     }
+    _bWriteToFile = false;
+    _bWriteToErrorLogFile = false;
+    _mLog.unlock();
     if (_pDGSocket) {
         delete _pDGSocket;
         _pDGSocket = NULL;
@@ -213,6 +731,11 @@ int Logger::configure (ConfigManager *pCfgMgr)
                                  "Invalid Logger detail debug level. Setting it to %d\n",
                                  Logger::L_LowDetailDebug);
         }
+        if (pCfgMgr->getValueAsBool (ASYNC_LOGGING_PROPERTY, false)) {
+            if (pLogger->enableAsyncMode() < 0) {
+                return -6;
+            }
+        }
     }
     else if (pLogger != NULL) {
         delete pLogger;
@@ -374,12 +897,139 @@ int Logger::writeHistoryToFile (void)
     return -1;
 }
 
+int Logger::enableAsyncMode (uint32 ui32RingSize)
+{
+    if ((ui32RingSize == 0) || (ui32RingSize > 0x80000000U)) {
+        return -1;
+    }
+    uint32 ui32Size = 1;
+    while (ui32Size < ui32RingSize) {
+        ui32Size <<= 1;
+    }
+    _mAsyncMode.lock();
+    if (_pAsyncWriter != NULL) {
+        _mAsyncMode.unlock();
+        return -2;
+    }
+    _pAsyncWriter = new AsyncLogWriter (this, ui32Size);
+    if (_pAsyncWriter->start() != 0) {
+        delete _pAsyncWriter;
+        _pAsyncWriter = NULL;
+        _mAsyncMode.unlock();
+        return -3;
+    }
+    // requestTerminationAndWait() returns right away if the writer has not
+    // started yet, so disableAsyncMode() could delete it while it is running
+    while (!_pAsyncWriter->isRunning()) {
+        sleepForMilliseconds (1);
+    }
+    _bAsyncMode = true;
+    _mAsyncMode.unlock();
+    return 0;
+}
+
+void Logger::disableAsyncMode (void)
+{
+    _mAsyncMode.lock();
+    if (_pAsyncWriter == NULL) {
+        _mAsyncMode.unlock();
+        return;
+    }
+    // From now on logMsg() logs synchronously: wait for the threads that
+    // have already seen asynchronous mode enabled to commit their messages
+    _bAsyncMode = false;
+    while (_ui32AsyncLoggers > 0) {
+        sleepForMilliseconds (1);
+    }
+    // The writer writes the pending messages before terminating
+    _pAsyncWriter->requestTerminationAndWait();
+    _ui64AsyncDropped += _pAsyncWriter->getDroppedMessagesCount();
+    delete _pAsyncWriter;
+    _pAsyncWriter = NULL;
+    _mAsyncMode.unlock();
+}
+
+uint64 Logger::getDroppedMessagesCount (void) const
+{
+    _mAsyncMode.lock();
+    uint64 ui64Dropped = _ui64AsyncDropped;
+    if (_pAsyncWriter != NULL) {
+        ui64Dropped += _pAsyncWriter->getDroppedMessagesCount();
+    }
+    _mAsyncMode.unlock();
+    return ui64Dropped;
+}
+
+int Logger::logMsgAsync (const char *pszSource, unsigned char uchLevel, const char *pszMsg, va_list vargs)
+{
+    AsyncLogRing *pRing = _pAsyncWriter->getRingForCurrentThread();
+    AsyncLogRecord *pRecord = pRing->reserve();
+    if (pRecord == NULL) {
+        // The writer can not keep up: drop the message rather than blocking
+        _pAsyncWriter->messageDropped();
+        return -1;
+    }
+    pRecord->i64Time = getTimeInMilliseconds();
+    pRecord->ui64SeqId = _pAsyncWriter->nextSeqId();
+    pRecord->ui16Indent = _usCurrIndent;
+    pRecord->ui8Level = uchLevel;
+    pRecord->pszOverflow = NULL;
+    if (pszSource == NULL) {
+        pszSource = "";
+    }
+
+    // The arguments are formatted here, since they may not be valid anymore
+    // by the time the writer gets to the message
+    const size_t sourceLen = strlen (pszSource);
+    va_list vargsCopy;
+    va_copy (vargsCopy, vargs);
+    int iMsgLen = -1;
+    if ((sourceLen + 1) < AsyncLogRecord::TEXT_SIZE) {
+        memcpy (pRecord->achText, pszSource, sourceLen + 1);
+        iMsgLen = vsnprintf (pRecord->achText + sourceLen + 1, AsyncLogRecord::TEXT_SIZE - sourceLen - 1, pszMsg, vargs);
+    }
+    if ((iMsgLen < 0) || ((sourceLen + 1 + iMsgLen) >= AsyncLogRecord::TEXT_SIZE)) {
+        va_list vargsLen;
+        va_copy (vargsLen, vargsCopy);
+        iMsgLen = vsnprintf (NULL, 0, pszMsg, vargsLen);
+        va_end (vargsLen);
+        if (iMsgLen >= 0) {
+            pRecord->pszOverflow = (char *) malloc (sourceLen + 1 + iMsgLen + 1);
+        }
+        if (pRecord->pszOverflow == NULL) {
+            va_end (vargsCopy);
+            _pAsyncWriter->messageDropped();
+            return -2;
+        }
+        memcpy (pRecord->pszOverflow, pszSource, sourceLen + 1);
+        vsnprintf (pRecord->pszOverflow + sourceLen + 1, iMsgLen + 1, pszMsg, vargsCopy);
+    }
+    va_end (vargsCopy);
+    pRecord->ui32SourceLen = (uint32) sourceLen;
+    pRecord->ui32MessageLen = (uint32) iMsgLen;
+    pRing->commit();
+    return 0;
+}
+
 int Logger::logMsg (const char *pszSource, unsigned char uchLevel, const char *pszMsg, ...)
 {
     if (uchLevel > _uchDebugLevel) {
         return 0;
     }
     va_list vargs;
+    if (_bAsyncMode) {
+        // Checked again after registering, so that disableAsyncMode() either
+        // waits for this thread or makes it log synchronously
+        _ui32AsyncLoggers++;
+        if (_bAsyncMode) {
+            va_start (vargs, pszMsg);
+            int rc = logMsgAsync (pszSource, uchLevel, pszMsg, vargs);
+            va_end (vargs);
+            _ui32AsyncLoggers--;
+            return rc;
+        }
+        _ui32AsyncLoggers--;
+    }
 
     const int64 i64Now = getTimeInMilliseconds();
     uint32 ui32ElapsedTime = (uint32) (i64Now - _i64StartTime);
@@ -477,19 +1127,7 @@ int Logger::logMsg (const char *pszSource, unsigned char uchLevel, const char *p
     }
     if ((_bWriteToOSLog) && (uchLevel <= _uchOSLogDebugLevel)) {
         #if defined (WIN32)
-            WORD wType;
-            switch (uchLevel) {
-                case L_SevereError:
-                case L_MildError:
-                    wType = EVENTLOG_ERROR_TYPE;
-                    break;
-                case L_Warning:
-                    wType = EVENTLOG_WARNING_TYPE;
-                    break;
-                default:
-                    wType = EVENTLOG_INFORMATION_TYPE;
-                    break;
-            }
+            WORD wType = toEventLogType (uchLevel);
             char szBuf[1024];
             va_start (vargs, pszMsg);
             _vsnprintf (szBuf, sizeof(szBuf), pszMsg, vargs);
@@ -499,26 +1137,8 @@ int Logger::logMsg (const char *pszSource, unsigned char uchLevel, const char *p
             if (!ReportEvent (_eventLogHandle, wType, 0, 1, NULL, 1, 0, lpStrings, NULL)) {
             }
         #elif defined (LINUX)
-            int iPriority;
-            switch (uchLevel) {
-                case L_SevereError:
-                    iPriority = LOG_CRIT;
-                    break;
-                case L_MildError:
-                    iPriority = LOG_ERR;
-                    break;
-                case L_Warning:
-                    iPriority = LOG_WARNING;
-                    break;
-                case L_Info:
-                    iPriority = LOG_INFO;
-                    break;
-                default:
-                    iPriority = LOG_DEBUG;
-                    break;
-            }
             va_start (vargs, pszMsg);
-            vsyslog (iPriority, pszMsg, vargs);
+            vsyslog (toSyslogPriority (uchLevel), pszMsg, vargs);
             va_end (vargs);
         #endif
     }
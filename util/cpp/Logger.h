@@ -20,7 +20,9 @@
 #ifndef INCL_LOGGER_H
 #define INCL_LOGGER_H
 
+#include <stdarg.h>
 #include <stdio.h>
+#include <atomic>
 #include <cstring>
 
 #include "FTypes.h"
@@ -41,6 +43,7 @@
 
 namespace NOMADSUtil
 {
+    class AsyncLogWriter;
     class ConfigManager;
     class UDPDatagramSocket;
 
@@ -76,6 +79,9 @@ namespace NOMADSUtil
             static const char * FILE_LOGGING_PROPERTY;
             static const char * ERROR_FILE_LOGGING_PROPERTY;
             static const char * LOGGING_LEVEL_PROPERTY;
+            static const char * ASYNC_LOGGING_PROPERTY;
+
+            static const uint32 DEFAULT_ASYNC_RING_SIZE = 256;
 
             static int configure (ConfigManager *pCfgMgr);
 
@@ -113,9 +119,29 @@ namespace NOMADSUtil
             int outdent (unsigned short usCount = 2);
             int logMsg (const char *pszSource, unsigned char uchLevel, const char *pszMsg, ...);
 
+            // In asynchronous mode, logMsg() formats the message into a ring
+            // buffer owned by the calling thread, without taking any lock, and
+            // a background thread writes the messages of all the threads in
+            // batches.  ui32RingSize is the number of messages that each thread
+            // can have pending (rounded up to a power of 2): when its ring is
+            // full, a message is dropped and counted instead of blocking the
+            // caller.  Returns -2 if asynchronous mode is already enabled.
+            int enableAsyncMode (uint32 ui32RingSize = DEFAULT_ASYNC_RING_SIZE);
+            // Waits for the threads that are logging asynchronously, writes
+            // the pending messages and goes back to synchronous mode.
+            // Asynchronous mode can then be enabled again.
+            void disableAsyncMode (void);
+            // Number of messages dropped because the ring of the logging
+            // thread was full, since the Logger was created
+            uint64 getDroppedMessagesCount (void) const;
+
         protected:
             void writeIndentSpace (FILE *file, unsigned short usCount);
 
+        private:
+            friend class AsyncLogWriter;
+            int logMsgAsync (const char *pszSource, unsigned char uchLevel, const char *pszMsg, va_list vargs);
+
         protected:
             Mutex _mLog;
             const int64 _i64StartTime;
@@ -142,6 +168,13 @@ namespace NOMADSUtil
             bool _bServiceDialogOutput;
             unsigned short _usCurrIndent;
             bool _bDisplayRelativeTime;
+            std::atomic<bool> _bAsyncMode;
+            // Number of threads that are in logMsgAsync()
+            std::atomic<uint32> _ui32AsyncLoggers;
+            mutable Mutex _mAsyncMode;
+            AsyncLogWriter *_pAsyncWriter;
+            // Dropped by the writers that have been deleted
+            uint64 _ui64AsyncDropped;
             #if defined (WIN32)
                 HANDLE _eventLogHandle;
             #endif
@@ -100,6 +100,41 @@ void NOMADSUtil::sleepForMilliseconds (int64 i64MilliSec)
     #endif
 }
 
+int64 NOMADSUtil::getMonotonicTimeInNanoseconds (void)
+{
+    #if defined (WIN32)
+        static LARGE_INTEGER liFrequency = {0};
+        if (liFrequency.QuadPart == 0) {
+            QueryPerformanceFrequency (&liFrequency);
+        }
+        LARGE_INTEGER liCounter;
+        QueryPerformanceCounter (&liCounter);
+        // Split the conversion to avoid overflowing the multiplication
+        return ((liCounter.QuadPart / liFrequency.QuadPart) * (int64) 1000000000) +
+               (((liCounter.QuadPart % liFrequency.QuadPart) * (int64) 1000000000) / liFrequency.QuadPart);
+    #elif defined (UNIX)
+        struct timespec ts;
+        if (clock_gettime (CLOCK_MONOTONIC, &ts) == -1) {
+            return getTimeInMilliseconds() * (int64) 1000000;
+        }
+        return ((int64) ts.tv_sec * (int64) 1000000000) + (int64) ts.tv_nsec;
+    #endif
+}
+
+void NOMADSUtil::sleepForMicroseconds (int64 i64MicroSec)
+{
+    #if defined (WIN32)
+        // Sleep() has a granularity of one millisecond at best
+        Sleep ((uint32) ((i64MicroSec + 999) / 1000));
+    #elif defined (UNIX)
+        struct timespec ts;
+        ts.tv_sec = (time_t) (i64MicroSec / 1000000);
+        ts.tv_nsec = (long) ((i64MicroSec % 1000000) * 1000);
+        while ((nanosleep (&ts, &ts) == -1) && (errno == EINTR)) {
+        }
+    #endif
+}
+
 uint32 NOMADSUtil::atoui32 (const char *pszValue)
 {
     const char *pszStart = pszValue;
@@ -46,6 +46,11 @@ namespace NOMADSUtil
     int64 getTimeInMilliseconds (void);
     void sleepForMilliseconds (int64 i64MilliSec);
 
+    // Returns the time in nanoseconds according to a monotonic clock (CLOCK_MONOTONIC where available)
+    // The value has no relation to the wall clock time and should only be used to measure intervals
+    int64 getMonotonicTimeInNanoseconds (void);
+    void sleepForMicroseconds (int64 i64MicroSec);
+
     // Convert from degrees to radians
     inline double degToRad (double deg)
     {
@@ -21,140 +21,245 @@
 
 using namespace NOMADSUtil;
 
+namespace THREAD_POOL
+{
+    // Worker that is running on the current thread, if any
+    thread_local void *tlpCurrentWorker = NULL;
+}
+
 ThreadPool::ThreadPool (int iMaxNumWorkers)
-    : _cvTaskQueue (&_mTaskQueue)
+    : _injectionQueue (INJECTION_QUEUE_SIZE),
+      _pTPWorkers (NULL),
+      _cvPark (&_mPark),
+      _iNumActiveWorkers (0),
+      _iNumIdleWorkers (0),
+      _iNumParkedWorkers (0),
+      _iMaxNumWorkers (iMaxNumWorkers > 0 ? iMaxNumWorkers : 0),
+      _bTerminate (false)
 {
-    if (iMaxNumWorkers <= 0) {
-        _pTPWorkers = NULL;
-        return;
+    if (_iMaxNumWorkers > 0) {
+        _pTPWorkers = new ThreadPoolWorker*[_iMaxNumWorkers];
     }
-
-    _iMaxNumWorkers = iMaxNumWorkers;
-    _pTPWorkers = new ThreadPoolWorker*[iMaxNumWorkers];
-
-    _iNumActiveWorkers = 0;
-    _iNumBusyWorkers = 0;
 }
 
 ThreadPool::~ThreadPool()
 {
-    if (_pTPWorkers) {
-        while (_iNumActiveWorkers > 0) {
-            delete _pTPWorkers[_iNumActiveWorkers];
-            _iNumActiveWorkers--;
-        }
+    _bTerminate = true;
+    _mPark.lock();
+    _cvPark.notifyAll();
+    _mPark.unlock();
+
+    // No worker is activated once _bTerminate is set.  The workers
+    // terminate once there are no more tasks to execute.
+    _mWorkers.lock();
+    const int iNumActiveWorkers = _iNumActiveWorkers;
+    _mWorkers.unlock();
+    for (int i = 0; i < iNumActiveWorkers; i++) {
+        _pTPWorkers[i]->join();
     }
+    // The workers may steal from each other until the last one terminates
+    for (int i = 0; i < iNumActiveWorkers; i++) {
+        delete _pTPWorkers[i];
+    }
+    delete[] _pTPWorkers;
+    _pTPWorkers = NULL;
 }
 
 int ThreadPool::enqueue (Runnable *pRunnable, bool bDeleteWhenFinished, ThreadPoolMonitor *pTPMon)
 {
-    checkAndActivateThreads();
-
-    ThreadPoolTask tpt (pRunnable, bDeleteWhenFinished, pTPMon);
-    _mTaskQueue.lock();
-
-    _taskQueue.enqueue (tpt);
+    ThreadPoolTask *pTask = new ThreadPoolTask (pRunnable, bDeleteWhenFinished, pTPMon);
+    if (enqueueTask (pTask) < 0) {
+        delete pTask;
+        return -1;
+    }
+    return 0;
+}
 
-    // Raffaele: I think that doing simply a notify() here will not cause the "lost signal"
-    // problem, because the worker will check the _cvTaskQueue.isEmpty() before waiting again.
-    // So it's like using _cvTaskQueue's current size as an indicator of how many notify()
-    // have been issued.
+int ThreadPool::enqueueTask (ThreadPoolTask *pTask)
+{
+    if (_iMaxNumWorkers == 0) {
+        return -1;
+    }
+    checkAndActivateThreads();
 
-    _cvTaskQueue.notify();
-    //_cvTaskQueue.notifyAll();
-    _mTaskQueue.unlock();
+    ThreadPoolWorker *pWorker = static_cast<ThreadPoolWorker *> (THREAD_POOL::tlpCurrentWorker);
+    if ((pWorker != NULL) && (pWorker->_pThreadPool == this)) {
+        pWorker->_deque.push (pTask);
+    }
+    else {
+        while (!_injectionQueue.enqueue (pTask)) {
+            // The workers are falling behind: let them catch up
+            unparkWorker();
+            Thread::yield();
+        }
+    }
+    unparkWorker();
     return 0;
 }
 
-int ThreadPool::dequeueTask (ThreadPool::ThreadPoolTask &tpt)
+ThreadPool::ThreadPoolTask * ThreadPool::findTask (ThreadPoolWorker *pWorker)
 {
-    _mTaskQueue.lock();
-    while (_taskQueue.isEmpty()) {
-        _cvTaskQueue.wait();
+    ThreadPoolTask *pTask;
+    if (pWorker->_deque.pop (pTask)) {
+        return pTask;
+    }
+    if (_injectionQueue.dequeue (pTask)) {
+        return pTask;
     }
-    _taskQueue.dequeue(tpt);
-    _mTaskQueue.unlock();
 
-    return 0;
+    // Try to steal from the other workers, starting from a random one
+    const int iNumActiveWorkers = _iNumActiveWorkers.load (std::memory_order_acquire);
+    pWorker->_ui32Seed ^= pWorker->_ui32Seed << 13;
+    pWorker->_ui32Seed ^= pWorker->_ui32Seed >> 17;
+    pWorker->_ui32Seed ^= pWorker->_ui32Seed << 5;
+    const int iStart = (int) (pWorker->_ui32Seed % (uint32) iNumActiveWorkers);
+    for (int i = 0; i < iNumActiveWorkers; i++) {
+        ThreadPoolWorker *pVictim = _pTPWorkers[(iStart + i) % iNumActiveWorkers];
+        if ((pVictim != pWorker) && pVictim->_deque.steal (pTask)) {
+            return pTask;
+        }
+    }
+    return NULL;
 }
 
-void ThreadPool::threadBusyStatusChanged (bool bThreadBusy)
+ThreadPool::ThreadPoolTask * ThreadPool::waitForTask (ThreadPoolWorker *pWorker)
 {
-    _mBusyWorkerCount.lock();
+    _iNumIdleWorkers++;
+    int iSpins = 0;
+    while (true) {
+        ThreadPoolTask *pTask = findTask (pWorker);
+        if (pTask != NULL) {
+            _iNumIdleWorkers--;
+            return pTask;
+        }
+        if (_bTerminate) {
+            _iNumIdleWorkers--;
+            return NULL;
+        }
+        if (iSpins < SPINS_BEFORE_PARKING) {
+            iSpins++;
+            Thread::yield();
+            continue;
+        }
 
-    if (bThreadBusy) {
-        _iNumBusyWorkers++;
+        _mPark.lock();
+        _iNumParkedWorkers++;
+        // Pairs with the fence in unparkWorker(): either the thread that
+        // enqueued a task sees this worker as parked, or this worker sees
+        // the task
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        if (!_bTerminate && !hasPendingTasks()) {
+            _cvPark.wait (PARKING_TIMEOUT);
+        }
+        _iNumParkedWorkers--;
+        _mPark.unlock();
+        iSpins = 0;
     }
-    else {
-        _iNumBusyWorkers--;
+}
+
+bool ThreadPool::hasPendingTasks (void)
+{
+    if (!_injectionQueue.isEmpty()) {
+        return true;
+    }
+    const int iNumActiveWorkers = _iNumActiveWorkers.load (std::memory_order_acquire);
+    for (int i = 0; i < iNumActiveWorkers; i++) {
+        if (!_pTPWorkers[i]->_deque.isEmpty()) {
+            return true;
+        }
     }
+    return false;
+}
 
-    _mBusyWorkerCount.unlock();
+void ThreadPool::unparkWorker (void)
+{
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    if (_iNumParkedWorkers.load (std::memory_order_relaxed) > 0) {
+        _mPark.lock();
+        _cvPark.notify();
+        _mPark.unlock();
+    }
 }
 
 void ThreadPool::checkAndActivateThreads()
 {
-    if (_iNumActiveWorkers >= _iMaxNumWorkers) {
+    if ((_iNumActiveWorkers >= _iMaxNumWorkers) || (_iNumIdleWorkers > 0)) {
         return;
     }
 
-    _mBusyWorkerCount.lock();
-
-    int iNumFreeWorkers = _iNumActiveWorkers - _iNumBusyWorkers;
-    if (iNumFreeWorkers == 0) {
-        ThreadPoolWorker *pTPWAux = new ThreadPoolWorker (this);
-        _pTPWorkers[_iNumActiveWorkers++] = pTPWAux;
-        pTPWAux->start();
+    _mWorkers.lock();
+    if ((_iNumActiveWorkers < _iMaxNumWorkers) && (_iNumIdleWorkers == 0) && !_bTerminate) {
+        const int iIndex = _iNumActiveWorkers;
+        ThreadPoolWorker *pTPWAux = new ThreadPoolWorker (this, (uint32) iIndex);
+        _pTPWorkers[iIndex] = pTPWAux;
+        // The worker counts as idle until it finds its first task, so that
+        // a burst of tasks does not activate a worker for each one of them
+        _iNumIdleWorkers++;
+        _iNumActiveWorkers.store (iIndex + 1, std::memory_order_release);
+        pTPWAux->start (false);
     }
-
-    _mBusyWorkerCount.unlock();
+    _mWorkers.unlock();
 }
 
 // ============================================
 // ThreadPoolWorker
 // ============================================
-ThreadPool::ThreadPoolWorker::ThreadPoolWorker (ThreadPool *pThreadPool)
+ThreadPool::ThreadPoolWorker::ThreadPoolWorker (ThreadPool *pThreadPool, uint32 ui32Seed)
+    : _pThreadPool (pThreadPool),
+      _ui32Seed ((2463534242U + ui32Seed * 2654435761U) | 1U)
 {
-    _pThreadPool = pThreadPool;
 }
 
 void ThreadPool::ThreadPoolWorker::run()
 {
-    ThreadPool::ThreadPoolTask tpt;
+    THREAD_POOL::tlpCurrentWorker = this;
+    _pThreadPool->_iNumIdleWorkers--;
 
     while (true) {
-        _pThreadPool->dequeueTask (tpt);
-        _pThreadPool->threadBusyStatusChanged (true);
-
-        if (tpt.pRunnable != NULL) {
-            int rc = tpt.pRunnable->run();
-
-            if (tpt.bDeleteWhenFinished) {
-                delete tpt.pRunnable;
-            }
-            if (tpt.pThreadPoolMon != NULL) {
-                tpt.pThreadPoolMon->runFinished (tpt.pRunnable, rc);
+        ThreadPoolTask *pTask = _pThreadPool->findTask (this);
+        if (pTask == NULL) {
+            pTask = _pThreadPool->waitForTask (this);
+            if (pTask == NULL) {
+                break;
             }
         }
-
-        _pThreadPool->threadBusyStatusChanged (false);
+        pTask->run();
+        delete pTask;
     }
+    THREAD_POOL::tlpCurrentWorker = NULL;
 }
 
 // ============================================
 // ThreadPoolTask
 // ============================================
-ThreadPool::ThreadPoolTask::ThreadPoolTask()
+ThreadPool::ThreadPoolTask::ThreadPoolTask (Runnable *pRunnable, bool bDeleteWhenFinished, ThreadPoolMonitor *pTPMon)
+{
+    this->pRunnable = pRunnable;
+    this->bDeleteWhenFinished = bDeleteWhenFinished;
+    this->pThreadPoolMon = pTPMon;
+}
+
+ThreadPool::ThreadPoolTask::ThreadPoolTask (const std::function<void (void)> &fn)
 {
     this->pRunnable = NULL;
     this->bDeleteWhenFinished = false;
     this->pThreadPoolMon = NULL;
+    this->fn = fn;
 }
 
-ThreadPool::ThreadPoolTask::ThreadPoolTask (Runnable *pRunnable, bool bDeleteWhenFinished, ThreadPoolMonitor *pTPMon)
+void ThreadPool::ThreadPoolTask::run (void)
 {
-    this->pRunnable = pRunnable;
-    this->bDeleteWhenFinished = bDeleteWhenFinished;
-    this->pThreadPoolMon = pTPMon;
-}
+    if (pRunnable != NULL) {
+        int rc = pRunnable->run();
 
+        if (bDeleteWhenFinished) {
+            delete pRunnable;
+        }
+        if (pThreadPoolMon != NULL) {
+            pThreadPoolMon->runFinished (pRunnable, rc);
+        }
+    }
+    else if (fn) {
+        fn();
+    }
+}
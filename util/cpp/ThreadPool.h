@@ -20,72 +20,116 @@
 #ifndef INCL_THREAD_POOL_H
 #define INCL_THREAD_POOL_H
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+#include "BoundedMPMCQueue.h"
 #include "ConditionVariable.h"
 #include "Mutex.h"
-#include "Queue.h"
 #include "Runnable.h"
 #include "Thread.h"
+#include "WorkStealingDeque.h"
 
 namespace NOMADSUtil
 {
 
     class ThreadPoolMonitor;
 
+    // Work-stealing executor.
+    // Each worker has its own deque: tasks enqueued by a worker (by a task
+    // that is running) go to the bottom of the worker's deque, and are
+    // executed by that worker in LIFO order, unless an idle worker steals
+    // them from the top.  Tasks enqueued by any other thread go through a
+    // shared lock-free injection queue.  Workers are activated on demand, up
+    // to iMaxNumWorkers, and park on a condition variable when they can not
+    // find any task.
+    // The destructor waits for all the enqueued tasks to be executed.
     class ThreadPool
     {
         public:
             ThreadPool (int iMaxNumWorkers = 10);
             ~ThreadPool (void);
 
+            // Returns a negative value if the pool has no workers
             int enqueue (Runnable *pRunnable, bool bDeleteWhenFinished = true, ThreadPoolMonitor *pTPMon = NULL);
 
+            // Enqueues fn and returns a future for its result.  If the pool
+            // has no workers, fn is executed by the calling thread.
+            // A task should not wait on the future of a task it enqueued if
+            // all the workers may be waiting in the same way.
+            template <typename F>
+            std::future<typename std::result_of<F()>::type> submit (F fn);
+
+            int getMaxNumWorkers (void) const;
+            int getNumActiveWorkers (void) const;
+
         private:
             class ThreadPoolTask
             {
                 public:
                     ThreadPoolTask (Runnable *pRunnable, bool bDeleteWhenFinished, ThreadPoolMonitor *pTPMon);
-                    ThreadPoolTask (void);
+                    explicit ThreadPoolTask (const std::function<void (void)> &fn);
+
+                    void run (void);
 
                 public:
                     Runnable *pRunnable;
                     bool bDeleteWhenFinished;
                     ThreadPoolMonitor *pThreadPoolMon;
+                    std::function<void (void)> fn;
             }; // class ThreadPoolTask
 
             class ThreadPoolWorker : public Thread
             {
                 public:
-                    ThreadPoolWorker (ThreadPool *pThreadPool);
+                    ThreadPoolWorker (ThreadPool *pThreadPool, uint32 ui32Seed);
                     void run();
 
                 private:
+                    friend class ThreadPool;
+
                     ThreadPool * _pThreadPool;
+                    uint32 _ui32Seed;
+                    WorkStealingDeque<ThreadPoolTask *> _deque;
             }; // class ThreadPoolWorker
 
         private:
-            int dequeueTask (ThreadPoolTask &tpt);
+            static const uint32 INJECTION_QUEUE_SIZE = 4096;
+            static const int SPINS_BEFORE_PARKING = 64;
+            static const int64 PARKING_TIMEOUT = 100;
+
+            int enqueueTask (ThreadPoolTask *pTask);
+            ThreadPoolTask * findTask (ThreadPoolWorker *pWorker);
+            ThreadPoolTask * waitForTask (ThreadPoolWorker *pWorker);
+            bool hasPendingTasks (void);
+            void unparkWorker (void);
             void checkAndActivateThreads (void);
-            void threadBusyStatusChanged (bool bThreadBusy);
 
         private:
-            //friend class ThreadPoolWorker;
-
-            Queue<ThreadPoolTask> _taskQueue;
-            Mutex _mTaskQueue;
-            ConditionVariable _cvTaskQueue;
+            BoundedMPMCQueue<ThreadPoolTask *> _injectionQueue;
 
             ThreadPoolWorker ** _pTPWorkers;
+            Mutex _mWorkers;
 
-            Mutex _mBusyWorkerCount;
+            Mutex _mPark;
+            ConditionVariable _cvPark;
 
             // total number of Worker Threads that have been activated.
-            int _iNumActiveWorkers;
+            std::atomic<int> _iNumActiveWorkers;
+
+            // number of Active worker threads that are looking for a task, or parked.
+            std::atomic<int> _iNumIdleWorkers;
 
-            // number of Active worker threads that are executing a task.
-            int _iNumBusyWorkers;
+            // number of Active worker threads that are parked.
+            std::atomic<int> _iNumParkedWorkers;
 
             // maximun number of WorkerThreads that will ever be activated.
             int _iMaxNumWorkers;
+
+            std::atomic<bool> _bTerminate;
     };
 
     class ThreadPoolMonitor
@@ -94,7 +138,30 @@ namespace NOMADSUtil
             virtual void runFinished (Runnable *pRunnable, int iRunRC) = 0;
     };
 
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> ThreadPool::submit (F fn)
+    {
+        typedef typename std::result_of<F()>::type R;
+        std::shared_ptr<std::packaged_task<R (void)> > pPackagedTask (new std::packaged_task<R (void)> (fn));
+        std::future<R> result (pPackagedTask->get_future());
+        ThreadPoolTask *pTask = new ThreadPoolTask ([pPackagedTask]() { (*pPackagedTask)(); });
+        if (enqueueTask (pTask) < 0) {
+            pTask->run();
+            delete pTask;
+        }
+        return result;
+    }
+
+    inline int ThreadPool::getMaxNumWorkers (void) const
+    {
+        return _iMaxNumWorkers;
+    }
+
+    inline int ThreadPool::getNumActiveWorkers (void) const
+    {
+        return _iNumActiveWorkers.load();
+    }
+
 }
 
 #endif //INCL_THREAD_POOL_H
-
@@ -126,7 +126,9 @@ int UDPDatagramSocket::init (uint16 ui16Port, uint32 ui32ListenAddr)
     memset ((void*) local.sin_zero, 0, sizeof (local.sin_zero));
 
     // Enables local address reuse
-    if (setsockopt (sockfd, SOL_SOCKET, SO_REUSEADDR, (char*)&opt_val, sizeof (opt_val)) < 0) {
+    // Only done when binding to a specific port: with port 0, Linux may assign the same
+    // ephemeral port to several sockets that have SO_REUSEADDR set
+    if ((ui16Port != 0) && (setsockopt (sockfd, SOL_SOCKET, SO_REUSEADDR, (char*)&opt_val, sizeof (opt_val)) < 0)) {
         return -3;
     }
 
@@ -0,0 +1,203 @@
+/*
+ * WorkStealingDeque.h
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Chase-Lev work-stealing deque.
+ * The owner thread pushes and pops elements at the bottom, without any
+ * atomic read-modify-write unless the deque holds a single element, while
+ * any other thread can steal elements from the top.  The deque grows when
+ * it is full; the arrays it outgrows are kept until it is deleted, since
+ * a thief may still be reading from them.
+ * T must be trivially copyable (typically, a pointer).
+ */
+
+#ifndef INCL_WORK_STEALING_DEQUE_H
+#define INCL_WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+#include "FTypes.h"
+
+namespace NOMADSUtil
+{
+    template <typename T>
+    class WorkStealingDeque
+    {
+        public:
+            // ui32InitialSize is rounded up to a power of 2
+            explicit WorkStealingDeque (uint32 ui32InitialSize = 256);
+            ~WorkStealingDeque (void);
+
+            // Methods that may only be called by the owner of the deque
+            void push (T element);
+            bool pop (T &element);
+
+            // Can be called by any thread.  Returns false if the deque is
+            // empty, or if another thread took the top element first.
+            bool steal (T &element);
+
+            // Approximate, when called by a thread other than the owner
+            bool isEmpty (void) const;
+
+        private:
+            struct Array
+            {
+                explicit Array (int64 i64Size);
+                ~Array (void);
+
+                T get (int64 i64Index) const;
+                void put (int64 i64Index, T element);
+
+                const int64 i64Size;
+                std::atomic<T> *pElements;
+                Array *pPrevious;
+            };
+
+            WorkStealingDeque (const WorkStealingDeque &);
+            WorkStealingDeque & operator = (const WorkStealingDeque &);
+
+            Array * grow (Array *pArray, int64 i64Bottom, int64 i64Top);
+
+        private:
+            std::atomic<int64> _i64Top;
+            char _padding[64];
+            std::atomic<int64> _i64Bottom;
+            std::atomic<Array *> _pArray;
+    };
+
+    template <typename T>
+    WorkStealingDeque<T>::Array::Array (int64 i64Size)
+        : i64Size (i64Size),
+          pElements (new std::atomic<T>[(size_t) i64Size]),
+          pPrevious (NULL)
+    {
+    }
+
+    template <typename T>
+    WorkStealingDeque<T>::Array::~Array (void)
+    {
+        delete[] pElements;
+    }
+
+    template <typename T>
+    inline T WorkStealingDeque<T>::Array::get (int64 i64Index) const
+    {
+        return pElements[i64Index & (i64Size - 1)].load (std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    inline void WorkStealingDeque<T>::Array::put (int64 i64Index, T element)
+    {
+        pElements[i64Index & (i64Size - 1)].store (element, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    WorkStealingDeque<T>::WorkStealingDeque (uint32 ui32InitialSize)
+        : _i64Top (0),
+          _i64Bottom (0)
+    {
+        int64 i64Size = 2;
+        while (i64Size < ui32InitialSize) {
+            i64Size <<= 1;
+        }
+        _pArray.store (new Array (i64Size), std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    WorkStealingDeque<T>::~WorkStealingDeque (void)
+    {
+        Array *pArray = _pArray.load (std::memory_order_relaxed);
+        while (pArray != NULL) {
+            Array *pPrevious = pArray->pPrevious;
+            delete pArray;
+            pArray = pPrevious;
+        }
+    }
+
+    template <typename T>
+    void WorkStealingDeque<T>::push (T element)
+    {
+        const int64 i64Bottom = _i64Bottom.load (std::memory_order_relaxed);
+        const int64 i64Top = _i64Top.load (std::memory_order_acquire);
+        Array *pArray = _pArray.load (std::memory_order_relaxed);
+        if ((i64Bottom - i64Top) > (pArray->i64Size - 1)) {
+            pArray = grow (pArray, i64Bottom, i64Top);
+        }
+        pArray->put (i64Bottom, element);
+        _i64Bottom.store (i64Bottom + 1, std::memory_order_release);
+    }
+
+    template <typename T>
+    bool WorkStealingDeque<T>::pop (T &element)
+    {
+        const int64 i64Bottom = _i64Bottom.load (std::memory_order_relaxed) - 1;
+        Array *pArray = _pArray.load (std::memory_order_relaxed);
+        _i64Bottom.store (i64Bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        int64 i64Top = _i64Top.load (std::memory_order_relaxed);
+        if (i64Top > i64Bottom) {
+            // Empty
+            _i64Bottom.store (i64Bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        element = pArray->get (i64Bottom);
+        if (i64Top == i64Bottom) {
+            // Last element: race with the thieves for it
+            const bool bWon = _i64Top.compare_exchange_strong (i64Top, i64Top + 1, std::memory_order_seq_cst,
+                                                               std::memory_order_relaxed);
+            _i64Bottom.store (i64Bottom + 1, std::memory_order_relaxed);
+            return bWon;
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool WorkStealingDeque<T>::steal (T &element)
+    {
+        int64 i64Top = _i64Top.load (std::memory_order_acquire);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        const int64 i64Bottom = _i64Bottom.load (std::memory_order_acquire);
+        if (i64Top >= i64Bottom) {
+            return false;
+        }
+        Array *pArray = _pArray.load (std::memory_order_acquire);
+        element = pArray->get (i64Top);
+        return _i64Top.compare_exchange_strong (i64Top, i64Top + 1, std::memory_order_seq_cst,
+                                                std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    bool WorkStealingDeque<T>::isEmpty (void) const
+    {
+        return _i64Bottom.load (std::memory_order_acquire) <= _i64Top.load (std::memory_order_acquire);
+    }
+
+    template <typename T>
+    typename WorkStealingDeque<T>::Array * WorkStealingDeque<T>::grow (Array *pArray, int64 i64Bottom, int64 i64Top)
+    {
+        Array *pNewArray = new Array (pArray->i64Size * 2);
+        for (int64 i = i64Top; i < i64Bottom; i++) {
+            pNewArray->put (i, pArray->get (i));
+        }
+        pNewArray->pPrevious = pArray;
+        _pArray.store (pNewArray, std::memory_order_release);
+        return pNewArray;
+    }
+}
+
+#endif   // #ifndef INCL_WORK_STEALING_DEQUE_H
@@ -84,6 +84,7 @@ LOCAL_SRC_FILES := AVList.cpp \
 	ManageableDatagramSocket.cpp \
 	MulticastUDPDatagramSocket.cpp \
 	Mutex.cpp \
+	net/InternetChecksum.cpp \
 	net/NetUtils.cpp \
 	net/NetworkHeaders.cpp \
 	net/WakeOnLAN.cpp \
@@ -94,7 +95,9 @@ LOCAL_SRC_FILES := AVList.cpp \
 	OSThread.cpp \
 	Pipe.cpp \
 	ProcessExecutor.cpp \
+	proxy/PipelinedRpc.cpp \
 	proxy/Protocol.cpp \
+	proxy/ShmRpcChannel.cpp \
 	proxy/StubCallbackHandler.cpp \
 	proxy/Stub.cpp \
 	ProxyDatagramSocket.cpp \
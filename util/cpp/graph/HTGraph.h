@@ -965,11 +965,9 @@ namespace NOMADSUtil
         }
         pPath->prepend (strDup (pszDestVertexKey));
 
-        auto iter = previous.getAllElements();
-        while (iter.getKey() != nullptr) {
-            auto currKey = iter.getKey();
-            iter.nextElement();
-            free (const_cast<char*> (previous.remove (currKey)));
+        // The keys are deleted by the hashtable, the values were allocated by strDup()
+        for (auto iter = previous.getAllElements(); !iter.end(); iter.nextElement()) {
+            free (const_cast<char*> (iter.getValue()));
         }
         free (pInitializationArray);
 
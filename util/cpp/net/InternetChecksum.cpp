@@ -0,0 +1,251 @@
+/*
+ * InternetChecksum.cpp
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2017 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "InternetChecksum.h"
+
+#include <string.h>
+
+#if defined (__x86_64__) || defined (__i386__) || defined (_M_X64) || defined (_M_IX86)
+    #define INTERNET_CHECKSUM_X86
+    #include <immintrin.h>
+    #if defined (_MSC_VER)
+        #include <intrin.h>
+        #define X86_TARGET(arch)
+    #else
+        #define X86_TARGET(arch) __attribute__ ((target (arch)))
+    #endif
+#endif
+
+using namespace NOMADSUtil;
+
+namespace
+{
+    // The vector kernels add two 16-bit words to each 32-bit lane of the accumulator for every
+    // block they load, so they can load up to this many blocks before the lanes may overflow
+    const uint32 MAX_BLOCKS_PER_ROUND = 32768;
+
+    uint32 fold64 (uint64 ui64Sum)
+    {
+        ui64Sum = (ui64Sum & 0xFFFFFFFFU) + (ui64Sum >> 32);
+        ui64Sum = (ui64Sum & 0xFFFFFFFFU) + (ui64Sum >> 32);
+        return (uint32) ui64Sum;
+    }
+
+    // Adds 32-bit words instead of 16-bit words: since 2^16 is congruent to 1 modulo 2^16 - 1,
+    // the folded result is the same, and the loop runs half as many times
+    uint64 scalarSum (const uint8 *pui8Buf, uint32 ui32Len)
+    {
+        uint64 ui64Sum = 0;
+        uint32 ui32Word;
+        while (ui32Len >= 8) {
+            memcpy (&ui32Word, pui8Buf, 4);
+            ui64Sum += ui32Word;
+            memcpy (&ui32Word, pui8Buf + 4, 4);
+            ui64Sum += ui32Word;
+            pui8Buf += 8;
+            ui32Len -= 8;
+        }
+        if (ui32Len >= 4) {
+            memcpy (&ui32Word, pui8Buf, 4);
+            ui64Sum += ui32Word;
+            pui8Buf += 4;
+            ui32Len -= 4;
+        }
+        uint16 ui16Word;
+        if (ui32Len >= 2) {
+            memcpy (&ui16Word, pui8Buf, 2);
+            ui64Sum += ui16Word;
+            pui8Buf += 2;
+            ui32Len -= 2;
+        }
+        if (ui32Len > 0) {
+            // Pad the last byte with a zero byte, regardless of the byte order of the host
+            const uint8 ui8LastWord[2] = {*pui8Buf, 0};
+            memcpy (&ui16Word, ui8LastWord, 2);
+            ui64Sum += ui16Word;
+        }
+        return ui64Sum;
+    }
+
+    #if defined (INTERNET_CHECKSUM_X86)
+        X86_TARGET ("sse2")
+        uint64 sse2Sum (const uint8 *pui8Buf, uint32 ui32Len)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            uint64 ui64Sum = 0;
+            while (ui32Len >= 16) {
+                uint32 ui32Blocks = ui32Len / 16;
+                if (ui32Blocks > MAX_BLOCKS_PER_ROUND) {
+                    ui32Blocks = MAX_BLOCKS_PER_ROUND;
+                }
+                ui32Len -= ui32Blocks * 16;
+                __m128i acc = zero;
+                for (uint32 i = 0; i < ui32Blocks; i++) {
+                    const __m128i words = _mm_loadu_si128 ((const __m128i *) pui8Buf);
+                    acc = _mm_add_epi32 (acc, _mm_unpacklo_epi16 (words, zero));
+                    acc = _mm_add_epi32 (acc, _mm_unpackhi_epi16 (words, zero));
+                    pui8Buf += 16;
+                }
+                uint32 ui32Lanes[4];
+                _mm_storeu_si128 ((__m128i *) ui32Lanes, acc);
+                for (int i = 0; i < 4; i++) {
+                    ui64Sum += ui32Lanes[i];
+                }
+            }
+            return ui64Sum + scalarSum (pui8Buf, ui32Len);
+        }
+
+        X86_TARGET ("avx2")
+        uint64 avx2Sum (const uint8 *pui8Buf, uint32 ui32Len)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            uint64 ui64Sum = 0;
+            while (ui32Len >= 32) {
+                uint32 ui32Blocks = ui32Len / 32;
+                if (ui32Blocks > MAX_BLOCKS_PER_ROUND) {
+                    ui32Blocks = MAX_BLOCKS_PER_ROUND;
+                }
+                ui32Len -= ui32Blocks * 32;
+                __m256i acc = zero;
+                for (uint32 i = 0; i < ui32Blocks; i++) {
+                    const __m256i words = _mm256_loadu_si256 ((const __m256i *) pui8Buf);
+                    acc = _mm256_add_epi32 (acc, _mm256_unpacklo_epi16 (words, zero));
+                    acc = _mm256_add_epi32 (acc, _mm256_unpackhi_epi16 (words, zero));
+                    pui8Buf += 32;
+                }
+                uint32 ui32Lanes[8];
+                _mm256_storeu_si256 ((__m256i *) ui32Lanes, acc);
+                for (int i = 0; i < 8; i++) {
+                    ui64Sum += ui32Lanes[i];
+                }
+            }
+            return ui64Sum + scalarSum (pui8Buf, ui32Len);
+        }
+
+        bool cpuSupportsAVX2 (void)
+        {
+            #if defined (_MSC_VER)
+                int cpuInfo[4];
+                __cpuid (cpuInfo, 0);
+                if (cpuInfo[0] < 7) {
+                    return false;
+                }
+                __cpuid (cpuInfo, 1);
+                // The OS must save the YMM registers on context switches (OSXSAVE and XCR0 bits 1-2)
+                if (((cpuInfo[2] & (1 << 27)) == 0) || ((_xgetbv (0) & 0x6) != 0x6)) {
+                    return false;
+                }
+                __cpuidex (cpuInfo, 7, 0);
+                return (cpuInfo[1] & (1 << 5)) != 0;
+            #else
+                return __builtin_cpu_supports ("avx2") != 0;
+            #endif
+        }
+
+        bool cpuSupportsSSE2 (void)
+        {
+            #if defined (__x86_64__) || defined (_M_X64)
+                return true;
+            #elif defined (_MSC_VER)
+                int cpuInfo[4];
+                __cpuid (cpuInfo, 1);
+                return (cpuInfo[3] & (1 << 26)) != 0;
+            #else
+                return __builtin_cpu_supports ("sse2") != 0;
+            #endif
+        }
+    #endif
+
+    InternetChecksum::Kernel detectBestKernel (void)
+    {
+        #if defined (INTERNET_CHECKSUM_X86)
+            if (cpuSupportsAVX2()) {
+                return InternetChecksum::K_AVX2;
+            }
+            if (cpuSupportsSSE2()) {
+                return InternetChecksum::K_SSE2;
+            }
+        #endif
+        return InternetChecksum::K_Scalar;
+    }
+}
+
+uint32 InternetChecksum::partialSum (const void *pBuf, uint32 ui32Len, uint32 ui32InitialSum)
+{
+    return partialSum (getBestKernel(), pBuf, ui32Len, ui32InitialSum);
+}
+
+uint32 InternetChecksum::partialSum (Kernel kernel, const void *pBuf, uint32 ui32Len, uint32 ui32InitialSum)
+{
+    const uint8 *pui8Buf = (const uint8 *) pBuf;
+    switch (kernel) {
+        case K_Scalar:
+            return fold64 (ui32InitialSum + scalarSum (pui8Buf, ui32Len));
+
+        #if defined (INTERNET_CHECKSUM_X86)
+            case K_SSE2:
+                return fold64 (ui32InitialSum + sse2Sum (pui8Buf, ui32Len));
+
+            case K_AVX2:
+                return fold64 (ui32InitialSum + avx2Sum (pui8Buf, ui32Len));
+        #endif
+
+        default:
+            return 0;
+    }
+}
+
+bool InternetChecksum::isKernelSupported (Kernel kernel)
+{
+    switch (kernel) {
+        case K_Scalar:
+            return true;
+
+        #if defined (INTERNET_CHECKSUM_X86)
+            case K_SSE2:
+                return cpuSupportsSSE2();
+
+            case K_AVX2:
+                return cpuSupportsAVX2();
+        #endif
+
+        default:
+            return false;
+    }
+}
+
+InternetChecksum::Kernel InternetChecksum::getBestKernel (void)
+{
+    static const Kernel BEST_KERNEL = detectBestKernel();
+    return BEST_KERNEL;
+}
+
+const char * InternetChecksum::getKernelName (Kernel kernel)
+{
+    switch (kernel) {
+        case K_Scalar:
+            return "scalar";
+        case K_SSE2:
+            return "SSE2";
+        case K_AVX2:
+            return "AVX2";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * InternetChecksum.h
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2017 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * One's-complement sum used by the IP, ICMP, TCP and UDP checksums (RFC 1071)
+ * and incremental update of a checksum after a header field is rewritten (RFC 1624).
+ *
+ * The sum is byte-order independent: summing the 16-bit words of a buffer as they
+ * are stored in memory yields the checksum in the same byte order as the buffer.
+ * Likewise, the update() methods work on any byte order, as long as the checksum
+ * and the old and new field values are all expressed in the same one.
+ * On x86 processors, the sum is computed with AVX2 or SSE2 instructions, depending
+ * on what the CPU supports; on any other architecture, a scalar loop is used.
+ */
+
+#ifndef INCL_INTERNET_CHECKSUM_H
+#define INCL_INTERNET_CHECKSUM_H
+
+#include "FTypes.h"
+
+namespace NOMADSUtil
+{
+    class InternetChecksum
+    {
+        public:
+            enum Kernel
+            {
+                K_Scalar,
+                K_SSE2,
+                K_AVX2
+            };
+
+            // Returns the one's-complement sum of the 16-bit words in pBuf added to ui32InitialSum,
+            // without folding it or complementing it; if ui32Len is odd, the buffer is padded with a
+            // zero byte. Partial sums of different buffers (e.g., a pseudo-header and a segment)
+            // can be chained through ui32InitialSum, as long as all buffers but the last one have
+            // an even length.
+            static uint32 partialSum (const void *pBuf, uint32 ui32Len, uint32 ui32InitialSum = 0);
+
+            // Same as above, but uses the specified kernel; returns 0 if the kernel is not supported
+            // Used to test and benchmark the kernels against each other
+            static uint32 partialSum (Kernel kernel, const void *pBuf, uint32 ui32Len, uint32 ui32InitialSum = 0);
+
+            // Folds a partial sum into 16 bits
+            static uint16 fold (uint32 ui32Sum);
+
+            // Returns the checksum of pBuf, i.e., the complement of the folded sum of its words
+            static uint16 compute (const void *pBuf, uint32 ui32Len);
+
+            // Returns the checksum updated after a 16-bit or a 32-bit field covered by it changed
+            // from the old value to the new value, according to eqn. 3 of RFC 1624
+            static uint16 update (uint16 ui16Checksum, uint16 ui16OldValue, uint16 ui16NewValue);
+            static uint16 update (uint16 ui16Checksum, uint32 ui32OldValue, uint32 ui32NewValue);
+
+            static bool isKernelSupported (Kernel kernel);
+
+            // Returns the kernel used by partialSum() on this CPU
+            static Kernel getBestKernel (void);
+            static const char * getKernelName (Kernel kernel);
+    };
+
+    inline uint16 InternetChecksum::fold (uint32 ui32Sum)
+    {
+        ui32Sum = (ui32Sum & 0xFFFF) + (ui32Sum >> 16);
+        ui32Sum = (ui32Sum & 0xFFFF) + (ui32Sum >> 16);
+        return (uint16) ui32Sum;
+    }
+
+    inline uint16 InternetChecksum::compute (const void *pBuf, uint32 ui32Len)
+    {
+        return (uint16) ~fold (partialSum (pBuf, ui32Len));
+    }
+
+    inline uint16 InternetChecksum::update (uint16 ui16Checksum, uint16 ui16OldValue, uint16 ui16NewValue)
+    {
+        // HC' = ~(~HC + ~m + m')
+        const uint32 ui32Sum = (uint32) (uint16) ~ui16Checksum + (uint16) ~ui16OldValue + ui16NewValue;
+        return (uint16) ~fold (ui32Sum);
+    }
+
+    inline uint16 InternetChecksum::update (uint16 ui16Checksum, uint32 ui32OldValue, uint32 ui32NewValue)
+    {
+        const uint32 ui32Sum = (uint32) (uint16) ~ui16Checksum +
+                               (uint16) ~(ui32OldValue >> 16) + (uint16) ~ui32OldValue +
+                               (ui32NewValue >> 16) + (ui32NewValue & 0xFFFF);
+        return (uint16) ~fold (ui32Sum);
+    }
+}
+
+#endif   // #ifndef INCL_INTERNET_CHECKSUM_H
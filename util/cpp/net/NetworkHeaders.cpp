@@ -19,6 +19,8 @@
 
 #include "NetworkHeaders.h"
 
+#include "InternetChecksum.h"
+
 #if defined (UNIX)
     #include <arpa/inet.h>
 #elif defined (WIN32)
@@ -131,21 +133,8 @@ void ARPPacket::hton (void)
 
 uint16 IPHeader::computeChecksum (void *pBuf, uint16 ui16BufLen)
 {
-    // The following code is adapted from the "C" implementation example in RFC 1071 - Computing the Internet Checksum
-    uint32 ui32Sum = 0;
-    uint8 *pui8ChecksumData = (uint8*) pBuf;
-    while (ui16BufLen > 1) {
-        ui32Sum += *((uint16*)pui8ChecksumData);
-        pui8ChecksumData += 2;
-        ui16BufLen -= 2;
-    }
-    if (ui16BufLen > 0) {
-        ui32Sum += *pui8ChecksumData;
-    }
-    while (ui32Sum >> 16) {
-        ui32Sum = (ui32Sum & 0xFFFF) + (ui32Sum >> 16);
-    }
-    return (uint16) (~ui32Sum);
+    // Internet Checksum as defined in RFC 1071
+    return InternetChecksum::compute (pBuf, ui16BufLen);
 }
 
 void IPHeader::computeChecksum (IPHeader *pIPHeader)
@@ -225,19 +214,8 @@ void TCPHeader::computeChecksum (uint8 *pIPPacket)
     ui32Sum += (pIPHeader->ui8Proto << 8);
     ui32Sum += htons (ui16TCPLen);
     pTCPHeader->hton();
-    uint8 *pui8ChecksumData = (uint8*) pTCPHeader;
-    while (ui16TCPLen > 1) {
-        ui32Sum += *((uint16*)pui8ChecksumData);
-        pui8ChecksumData += 2;
-        ui16TCPLen -= 2;
-    }
-    if (ui16TCPLen > 0) {
-        ui32Sum += *pui8ChecksumData;
-    }
-    while (ui32Sum >> 16) {
-        ui32Sum = (ui32Sum & 0xFFFF) + (ui32Sum >> 16);
-    }
-    pTCPHeader->ui16CRC = (uint16) (~ui32Sum);
+    ui32Sum = InternetChecksum::partialSum (pTCPHeader, ui16TCPLen, ui32Sum);
+    pTCPHeader->ui16CRC = (uint16) ~InternetChecksum::fold (ui32Sum);
     pTCPHeader->ntoh();
 }
 
@@ -0,0 +1,659 @@
+/*
+ * PipelinedRpc.cpp
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "PipelinedRpc.h"
+
+#include "BufferReader.h"
+#include "Logger.h"
+#include "NLFLib.h"
+#include "SimpleCommHelper2.h"
+#include "TCPSocket.h"
+#include "Writer.h"
+
+// After the socket headers, that may define htonl() and the like as macros
+#include "EndianHelper.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+using namespace NOMADSUtil;
+
+namespace PIPELINED_RPC
+{
+    // Shared by all the clients, so that a request id that was issued on a
+    // connection that has been replaced does not match a request on the new one
+    std::atomic<uint32> nextRequestId (1U);
+
+    // Writes the payload in place in a frame reserved on the channel, or only
+    // counts its length if pBuf is NULL
+    class FrameWriter : public Writer
+    {
+        public:
+            FrameWriter (char *pBuf, uint32 ui32BufLen)
+                : _pBuf (pBuf), _ui32BufLen (ui32BufLen), _ui32Pos (0U) {}
+
+            int writeBytes (const void *pData, unsigned long ulCount)
+            {
+                if (ulCount > (unsigned long) (_ui32BufLen - _ui32Pos)) {
+                    return -1;
+                }
+                if (_pBuf != NULL) {
+                    memcpy (_pBuf + _ui32Pos, pData, ulCount);
+                }
+                _ui32Pos += (uint32) ulCount;
+                return 0;
+            }
+
+            uint32 getLength (void) const
+            {
+                return _ui32Pos;
+            }
+
+        private:
+            char *_pBuf;
+            const uint32 _ui32BufLen;
+            uint32 _ui32Pos;
+    };
+}
+
+using namespace PIPELINED_RPC;
+
+const String PipelinedRpc::REGISTER_PROXY_RPC = "RegisterProxyRpc";
+const uint32 PipelinedRpc::HEADER_LEN;
+const uint32 PipelinedRpc::MAX_PAYLOAD_LEN;
+
+void PipelinedRpc::writeHeader (char *pszHeader, uint32 ui32PayloadLen, uint32 ui32RequestId,
+                                uint16 ui16Method, uint16 ui16Status)
+{
+    ui32PayloadLen = EndianHelper::htonl (ui32PayloadLen);
+    ui32RequestId = EndianHelper::htonl (ui32RequestId);
+    ui16Method = EndianHelper::htons (ui16Method);
+    ui16Status = EndianHelper::htons (ui16Status);
+    memcpy (pszHeader, &ui32PayloadLen, 4);
+    memcpy (pszHeader + 4, &ui32RequestId, 4);
+    memcpy (pszHeader + 8, &ui16Method, 2);
+    memcpy (pszHeader + 10, &ui16Status, 2);
+}
+
+int64 PipelinedRpc::readHeader (const char *pszHeader, uint32 &ui32RequestId, uint16 &ui16Method,
+                                uint16 &ui16Status)
+{
+    uint32 ui32PayloadLen = 0U;
+    memcpy (&ui32PayloadLen, pszHeader, 4);
+    memcpy (&ui32RequestId, pszHeader + 4, 4);
+    memcpy (&ui16Method, pszHeader + 8, 2);
+    memcpy (&ui16Status, pszHeader + 10, 2);
+    ui32PayloadLen = EndianHelper::ntohl (ui32PayloadLen);
+    ui32RequestId = EndianHelper::ntohl (ui32RequestId);
+    ui16Method = EndianHelper::ntohs (ui16Method);
+    ui16Status = EndianHelper::ntohs (ui16Status);
+    if (ui32PayloadLen > MAX_PAYLOAD_LEN) {
+        return -1;
+    }
+    return (int64) ui32PayloadLen;
+}
+
+const void * PipelinedRpc::readInPlace (Reader *pRequest, uint32 ui32Len)
+{
+    // PipelinedRpcServer unmarshals the requests with a BufferReader on the frame
+    BufferReader *pReader = dynamic_cast<BufferReader *> (pRequest);
+    if ((pReader == NULL) || (pReader->getBytesAvailable() < ui32Len)) {
+        return NULL;
+    }
+    const uint8 *pData = pReader->getBuffer() + (pReader->getBufferLength() - pReader->getBytesAvailable());
+    if ((ui32Len > 0) && (pReader->skipBytes (ui32Len) < 0)) {
+        return NULL;
+    }
+    return pData;
+}
+
+//==============================================================================
+// RpcChannel
+//==============================================================================
+
+RpcChannel::~RpcChannel (void)
+{
+}
+
+uint32 RpcChannel::getMaxFrameLength (void)
+{
+    return PipelinedRpc::HEADER_LEN + PipelinedRpc::MAX_PAYLOAD_LEN;
+}
+
+TCPRpcChannel::TCPRpcChannel (SimpleCommHelper2 *pCommHelper)
+    : _pCommHelper (pCommHelper),
+      _pSendBuf (NULL),
+      _ui32SendBufLen (0U),
+      _ui32ReservedLen (0U),
+      _pFrameBuf (NULL),
+      _ui32FrameBufLen (0U)
+{
+}
+
+TCPRpcChannel::~TCPRpcChannel (void)
+{
+    if (_pCommHelper != NULL) {
+        SimpleCommHelper2::Error error;
+        _pCommHelper->closeConnection (error);
+        delete _pCommHelper;
+        _pCommHelper = NULL;
+    }
+    free (_pSendBuf);
+    free (_pFrameBuf);
+}
+
+int TCPRpcChannel::sendFrame (const char *pszHeader, const void *pPayload, uint32 ui32PayloadLen)
+{
+    char *pFrame = reserveFrame (PipelinedRpc::HEADER_LEN + ui32PayloadLen);
+    if (pFrame == NULL) {
+        return -1;
+    }
+    memcpy (pFrame, pszHeader, PipelinedRpc::HEADER_LEN);
+    if (ui32PayloadLen > 0) {
+        memcpy (pFrame + PipelinedRpc::HEADER_LEN, pPayload, ui32PayloadLen);
+    }
+    return commitFrame();
+}
+
+char * TCPRpcChannel::reserveFrame (uint32 ui32FrameLen)
+{
+    // The header and the payload are written at once, to avoid sending them
+    // in separate segments (Nagle's algorithm is disabled on proxy sockets)
+    if (ui32FrameLen > _ui32SendBufLen) {
+        char *pSendBuf = (char *) realloc (_pSendBuf, ui32FrameLen);
+        if (pSendBuf == NULL) {
+            return NULL;
+        }
+        _pSendBuf = pSendBuf;
+        _ui32SendBufLen = ui32FrameLen;
+    }
+    _ui32ReservedLen = ui32FrameLen;
+    return _pSendBuf;
+}
+
+int TCPRpcChannel::commitFrame (void)
+{
+    const uint32 ui32FrameLen = _ui32ReservedLen;
+    _ui32ReservedLen = 0U;
+    if (_pCommHelper->getWriterRef()->writeBytes (_pSendBuf, ui32FrameLen) != 0) {
+        return -2;
+    }
+    return 0;
+}
+
+void TCPRpcChannel::cancelFrame (void)
+{
+    _ui32ReservedLen = 0U;
+}
+
+int TCPRpcChannel::receiveFrame (const char **ppFrame, uint32 &ui32FrameLen)
+{
+    Reader *pReader = _pCommHelper->getReaderRef();
+    char header[PipelinedRpc::HEADER_LEN];
+    if (pReader->readBytes (header, PipelinedRpc::HEADER_LEN) < 0) {
+        return -1;
+    }
+    uint32 ui32RequestId = 0U;
+    uint16 ui16Method = 0U;
+    uint16 ui16Status = 0U;
+    const int64 i64PayloadLen = PipelinedRpc::readHeader (header, ui32RequestId, ui16Method, ui16Status);
+    if (i64PayloadLen < 0) {
+        return -2;
+    }
+    ui32FrameLen = PipelinedRpc::HEADER_LEN + (uint32) i64PayloadLen;
+    if (ui32FrameLen > _ui32FrameBufLen) {
+        char *pFrameBuf = (char *) realloc (_pFrameBuf, ui32FrameLen);
+        if (pFrameBuf == NULL) {
+            return -3;
+        }
+        _pFrameBuf = pFrameBuf;
+        _ui32FrameBufLen = ui32FrameLen;
+    }
+    memcpy (_pFrameBuf, header, PipelinedRpc::HEADER_LEN);
+    if ((i64PayloadLen > 0) && (pReader->readBytes (_pFrameBuf + PipelinedRpc::HEADER_LEN, (uint32) i64PayloadLen) < 0)) {
+        return -4;
+    }
+    *ppFrame = _pFrameBuf;
+    return 0;
+}
+
+void TCPRpcChannel::releaseFrame (void)
+{
+}
+
+void TCPRpcChannel::disableReceive (void)
+{
+    // Closing the socket does not wake up the thread that is blocked reading
+    // from it: shut the socket down instead, and close it only once the
+    // thread has terminated
+    TCPSocket *pSocket = dynamic_cast<TCPSocket *> (_pCommHelper->getSocket());
+    if (pSocket != NULL) {
+        pSocket->shutdown (true, false);
+    }
+}
+
+//==============================================================================
+// PipelinedRpcClient
+//==============================================================================
+
+PipelinedRpcClient::Response::Response (void)
+    : bArrived (false),
+      ui16Status (PipelinedRpc::RPC_OK),
+      ui32PayloadLen (0U),
+      pPayload (NULL)
+{
+}
+
+PipelinedRpcClient::Response::~Response (void)
+{
+    if (pPayload != NULL) {
+        free (pPayload);
+    }
+}
+
+PipelinedRpcClient::PipelinedRpcClient (SimpleCommHelper2 *pCommHelper)
+    : _bConnected (pCommHelper != NULL),
+      _ui32RefCount (1U),
+      _pChannel (pCommHelper == NULL ? NULL : new TCPRpcChannel (pCommHelper)),
+      _cvPending (&_mPending),
+      _pending (true)     // bDelValues
+{
+}
+
+PipelinedRpcClient::PipelinedRpcClient (RpcChannel *pChannel)
+    : _bConnected (pChannel != NULL),
+      _ui32RefCount (1U),
+      _pChannel (pChannel),
+      _cvPending (&_mPending),
+      _pending (true)     // bDelValues
+{
+}
+
+PipelinedRpcClient::~PipelinedRpcClient (void)
+{
+    requestTerminationAndWait();
+    delete _pChannel;
+    _pChannel = NULL;
+}
+
+void PipelinedRpcClient::addRef (void)
+{
+    _mPending.lock();
+    _ui32RefCount++;
+    _mPending.unlock();
+}
+
+void PipelinedRpcClient::release (void)
+{
+    _mPending.lock();
+    const bool bDelete = (--_ui32RefCount == 0U);
+    _mPending.unlock();
+    if (bDelete) {
+        delete this;
+    }
+}
+
+bool PipelinedRpcClient::isConnected (void)
+{
+    _mPending.lock();
+    const bool bConnected = _bConnected;
+    _mPending.unlock();
+    return bConnected;
+}
+
+uint32 PipelinedRpcClient::addPendingRequest (void)
+{
+    // The request must be pending before it is sent, since the response may
+    // be read before the frame is sent
+    _mPending.lock();
+    if (!_bConnected) {
+        _mPending.unlock();
+        return 0U;
+    }
+    uint32 ui32RequestId = nextRequestId++;
+    if (ui32RequestId == 0U) {
+        ui32RequestId = nextRequestId++;
+    }
+    _pending.put (ui32RequestId, new Response());
+    _mPending.unlock();
+    return ui32RequestId;
+}
+
+void PipelinedRpcClient::removePendingRequest (uint32 ui32RequestId)
+{
+    _mPending.lock();
+    delete _pending.remove (ui32RequestId);
+    _mPending.unlock();
+}
+
+uint32 PipelinedRpcClient::send (uint16 ui16Method, const void *pPayload, uint32 ui32PayloadLen)
+{
+    const char *pszMethodName = "PipelinedRpcClient::send";
+    const uint32 ui32RequestId = addPendingRequest();
+    if (ui32RequestId == 0U) {
+        return 0U;
+    }
+
+    int rc = -1;
+    if ((ui32PayloadLen <= getMaxPayloadLength()) && ((pPayload != NULL) || (ui32PayloadLen == 0))) {
+        char header[PipelinedRpc::HEADER_LEN];
+        PipelinedRpc::writeHeader (header, ui32PayloadLen, ui32RequestId, ui16Method, PipelinedRpc::RPC_OK);
+        _mWrite.lock();
+        rc = _pChannel->sendFrame (header, pPayload, ui32PayloadLen);
+        _mWrite.unlock();
+    }
+    if (rc < 0) {
+        checkAndLogMsg (pszMethodName, Logger::L_MildError, "could not send request %u "
+                        "for method %u; rc = %d\n", ui32RequestId, (unsigned int) ui16Method, rc);
+        removePendingRequest (ui32RequestId);
+        return 0U;
+    }
+    return ui32RequestId;
+}
+
+uint32 PipelinedRpcClient::send (uint16 ui16Method, RpcMarshalFnPtr pMarshaller, const void *pArg)
+{
+    uint32 ui32RequestId = 0U;
+    if (sendRequest (ui16Method, pMarshaller, pArg, ui32RequestId) < 0) {
+        return 0U;
+    }
+    return ui32RequestId;
+}
+
+int PipelinedRpcClient::sendRequest (uint16 ui16Method, RpcMarshalFnPtr pMarshaller, const void *pArg,
+                                     uint32 &ui32RequestId)
+{
+    const char *pszMethodName = "PipelinedRpcClient::sendRequest";
+    ui32RequestId = 0U;
+
+    // The first pass only computes the length of the payload
+    FrameWriter counter (NULL, PipelinedRpc::MAX_PAYLOAD_LEN);
+    if ((pMarshaller == NULL) || (pMarshaller (pArg, &counter) < 0)) {
+        return -1;
+    }
+    const uint32 ui32PayloadLen = counter.getLength();
+    if (ui32PayloadLen > getMaxPayloadLength()) {
+        checkAndLogMsg (pszMethodName, Logger::L_Info, "the %u bytes request for method %u "
+                        "does not fit in a frame\n", ui32PayloadLen, (unsigned int) ui16Method);
+        return -2;
+    }
+    ui32RequestId = addPendingRequest();
+    if (ui32RequestId == 0U) {
+        return -3;
+    }
+
+    int rc = 0;
+    _mWrite.lock();
+    char *pFrame = _pChannel->reserveFrame (PipelinedRpc::HEADER_LEN + ui32PayloadLen);
+    if (pFrame == NULL) {
+        rc = -1;
+    }
+    else {
+        PipelinedRpc::writeHeader (pFrame, ui32PayloadLen, ui32RequestId, ui16Method, PipelinedRpc::RPC_OK);
+        FrameWriter payload (pFrame + PipelinedRpc::HEADER_LEN, ui32PayloadLen);
+        if ((pMarshaller (pArg, &payload) < 0) || (payload.getLength() != ui32PayloadLen)) {
+            _pChannel->cancelFrame();
+            rc = -2;
+        }
+        else {
+            rc = _pChannel->commitFrame();
+        }
+    }
+    _mWrite.unlock();
+    if (rc < 0) {
+        checkAndLogMsg (pszMethodName, Logger::L_MildError, "could not send request %u "
+                        "for method %u; rc = %d\n", ui32RequestId, (unsigned int) ui16Method, rc);
+        removePendingRequest (ui32RequestId);
+        ui32RequestId = 0U;
+        return -3;
+    }
+    return 0;
+}
+
+int PipelinedRpcClient::wait (uint32 ui32RequestId, BufferReader **ppResponse)
+{
+    if (ppResponse != NULL) {
+        *ppResponse = NULL;
+    }
+    _mPending.lock();
+    Response *pResponse = _pending.get (ui32RequestId);
+    if (pResponse == NULL) {
+        _mPending.unlock();
+        return -1;
+    }
+    while (!pResponse->bArrived && _bConnected) {
+        _cvPending.wait();
+    }
+    _pending.remove (ui32RequestId);
+    _mPending.unlock();
+
+    int rc = 0;
+    if (!pResponse->bArrived) {
+        rc = -2;
+    }
+    else if (pResponse->ui16Status != PipelinedRpc::RPC_OK) {
+        rc = -3;
+    }
+    else if (ppResponse != NULL) {
+        // The reader takes ownership of the payload
+        *ppResponse = new BufferReader (pResponse->pPayload, pResponse->ui32PayloadLen, true);
+        pResponse->pPayload = NULL;
+    }
+    delete pResponse;
+    return rc;
+}
+
+int PipelinedRpcClient::call (uint16 ui16Method, const void *pPayload, uint32 ui32PayloadLen,
+                              BufferReader **ppResponse)
+{
+    if (ui32PayloadLen > getMaxPayloadLength()) {
+        return -4;
+    }
+    const uint32 ui32RequestId = send (ui16Method, pPayload, ui32PayloadLen);
+    if (ui32RequestId == 0U) {
+        return -2;
+    }
+    return wait (ui32RequestId, ppResponse);
+}
+
+int PipelinedRpcClient::call (uint16 ui16Method, RpcMarshalFnPtr pMarshaller, const void *pArg,
+                              BufferReader **ppResponse)
+{
+    uint32 ui32RequestId = 0U;
+    const int rc = sendRequest (ui16Method, pMarshaller, pArg, ui32RequestId);
+    if (rc < 0) {
+        return (rc == -2 ? -4 : -2);
+    }
+    return wait (ui32RequestId, ppResponse);
+}
+
+uint32 PipelinedRpcClient::getMaxPayloadLength (void)
+{
+    const uint32 ui32MaxFrameLen = _pChannel->getMaxFrameLength();
+    if (ui32MaxFrameLen <= PipelinedRpc::HEADER_LEN) {
+        return 0U;
+    }
+    return minimum (ui32MaxFrameLen - PipelinedRpc::HEADER_LEN, PipelinedRpc::MAX_PAYLOAD_LEN);
+}
+
+void PipelinedRpcClient::run (void)
+{
+    const char *pszMethodName = "PipelinedRpcClient::run";
+    setName (pszMethodName);
+    started();
+
+    while (!terminationRequested()) {
+        const char *pFrame = NULL;
+        uint32 ui32FrameLen = 0U;
+        const int rc = _pChannel->receiveFrame (&pFrame, ui32FrameLen);
+        if (rc < 0) {
+            if (!terminationRequested()) {
+                checkAndLogMsg (pszMethodName, Logger::L_MildError,
+                                "could not read response; rc = %d\n", rc);
+            }
+            break;
+        }
+        uint32 ui32RequestId = 0U;
+        uint16 ui16Method = 0U;
+        uint16 ui16Status = 0U;
+        const uint32 ui32PayloadLen = ui32FrameLen - PipelinedRpc::HEADER_LEN;
+        PipelinedRpc::readHeader (pFrame, ui32RequestId, ui16Method, ui16Status);
+        // The response outlives the frame
+        void *pPayload = NULL;
+        if (ui32PayloadLen > 0) {
+            pPayload = malloc (ui32PayloadLen);
+            if (pPayload == NULL) {
+                _pChannel->releaseFrame();
+                break;
+            }
+            memcpy (pPayload, pFrame + PipelinedRpc::HEADER_LEN, ui32PayloadLen);
+        }
+        _pChannel->releaseFrame();
+
+        _mPending.lock();
+        Response *pResponse = _pending.get (ui32RequestId);
+        if ((pResponse == NULL) || pResponse->bArrived) {
+            _mPending.unlock();
+            checkAndLogMsg (pszMethodName, Logger::L_Warning, "received response to unknown "
+                            "request %u for method %u\n", ui32RequestId, (unsigned int) ui16Method);
+            free (pPayload);
+            continue;
+        }
+        pResponse->ui16Status = ui16Status;
+        pResponse->ui32PayloadLen = ui32PayloadLen;
+        pResponse->pPayload = pPayload;
+        pResponse->bArrived = true;
+        _cvPending.notifyAll();
+        _mPending.unlock();
+    }
+
+    // Wake up the callers whose requests will never be answered
+    _mPending.lock();
+    _bConnected = false;
+    _cvPending.notifyAll();
+    _mPending.unlock();
+
+    terminating();
+}
+
+void PipelinedRpcClient::requestTermination (void)
+{
+    ManageableThread::requestTermination();
+    if (_pChannel != NULL) {
+        _pChannel->disableReceive();
+    }
+}
+
+void PipelinedRpcClient::requestTerminationAndWait (void)
+{
+    requestTermination();
+    ManageableThread::requestTerminationAndWait();
+}
+
+//==============================================================================
+// PipelinedRpcServer
+//==============================================================================
+
+PipelinedRpcServer::PipelinedRpcServer (SimpleCommHelper2 *pCommHelper, RpcUnmarshalFnPtr pUnmarshaller, void *pSvc)
+    : _pChannel (pCommHelper == NULL ? NULL : new TCPRpcChannel (pCommHelper)),
+      _pUnmarshaller (pUnmarshaller),
+      _pSvc (pSvc)
+{
+}
+
+PipelinedRpcServer::PipelinedRpcServer (RpcChannel *pChannel, RpcUnmarshalFnPtr pUnmarshaller, void *pSvc)
+    : _pChannel (pChannel),
+      _pUnmarshaller (pUnmarshaller),
+      _pSvc (pSvc)
+{
+}
+
+PipelinedRpcServer::~PipelinedRpcServer (void)
+{
+    requestTerminationAndWait();
+    delete _pChannel;
+    _pChannel = NULL;
+}
+
+void PipelinedRpcServer::run (void)
+{
+    const char *pszMethodName = "PipelinedRpcServer::run";
+    setName (pszMethodName);
+    started();
+
+    BufferWriter response;
+    while (!terminationRequested()) {
+        const char *pFrame = NULL;
+        uint32 ui32FrameLen = 0U;
+        int rc = _pChannel->receiveFrame (&pFrame, ui32FrameLen);
+        if (rc < 0) {
+            if (!terminationRequested()) {
+                checkAndLogMsg (pszMethodName, Logger::L_Info,
+                                "could not read request; rc = %d\n", rc);
+            }
+            break;
+        }
+        uint32 ui32RequestId = 0U;
+        uint16 ui16Method = 0U;
+        uint16 ui16Status = 0U;
+        PipelinedRpc::readHeader (pFrame, ui32RequestId, ui16Method, ui16Status);
+
+        // The request is unmarshalled from the frame, without copying it
+        BufferReader request (pFrame + PipelinedRpc::HEADER_LEN, ui32FrameLen - PipelinedRpc::HEADER_LEN, false);
+        response.reset();
+        rc = _pUnmarshaller (_pSvc, ui16Method, &request, &response);
+        _pChannel->releaseFrame();
+        if (rc < 0) {
+            checkAndLogMsg (pszMethodName, Logger::L_Warning, "method %u of request %u "
+                            "failed; rc = %d\n", (unsigned int) ui16Method, ui32RequestId, rc);
+            ui16Status = PipelinedRpc::RPC_ERROR;
+            response.reset();
+        }
+        else {
+            ui16Status = PipelinedRpc::RPC_OK;
+        }
+        char header[PipelinedRpc::HEADER_LEN];
+        PipelinedRpc::writeHeader (header, response.getBufferLength(), ui32RequestId, ui16Method, ui16Status);
+        if (_pChannel->sendFrame (header, response.getBuffer(), response.getBufferLength()) < 0) {
+            checkAndLogMsg (pszMethodName, Logger::L_MildError,
+                            "could not send response to request %u\n", ui32RequestId);
+            break;
+        }
+    }
+
+    terminating();
+}
+
+void PipelinedRpcServer::requestTermination (void)
+{
+    ManageableThread::requestTermination();
+    if (_pChannel != NULL) {
+        _pChannel->disableReceive();
+    }
+}
+
+void PipelinedRpcServer::requestTerminationAndWait (void)
+{
+    requestTermination();
+    ManageableThread::requestTerminationAndWait();
+}
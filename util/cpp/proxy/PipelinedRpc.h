@@ -0,0 +1,269 @@
+/*
+ * PipelinedRpc.h
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Binary, pipelined remote method invocation over a dedicated proxy
+ * connection.
+ * Each request and each response is a single frame made of a fixed-size
+ * header (payload length, request id, method id, status) followed by the
+ * payload.  Responses carry the id of the request they answer, therefore
+ * the client does not need to wait for the response to a request before
+ * sending the next one, and several threads can have calls in flight on
+ * the same connection.
+ *
+ * The frames are exchanged on an RpcChannel: a TCP connection (TCPRpcChannel)
+ * or, for clients running on the same host as the server, a pair of
+ * shared-memory rings (ShmRpcChannel).
+ *
+ * The text protocol of the proxies is not affected: the RPC connection is
+ * opened in addition to the command and callback connections, and it is
+ * registered with REGISTER_PROXY_RPC, therefore servers keep accepting
+ * clients that only use the text protocol.  Clients must opt in, since
+ * servers that predate REGISTER_PROXY_RPC do not reply to it.
+ */
+
+#ifndef INCL_PIPELINED_RPC_H
+#define INCL_PIPELINED_RPC_H
+
+#include "BufferWriter.h"
+#include "ConditionVariable.h"
+#include "ManageableThread.h"
+#include "Mutex.h"
+#include "StrClass.h"
+#include "UInt32Hashtable.h"
+
+namespace NOMADSUtil
+{
+    class BufferReader;
+    class Reader;
+    class SimpleCommHelper2;
+    class Writer;
+
+    // Unmarshals the request, invokes ui16Method on pSvc, and marshals the
+    // results into pResponse.
+    // pRequest reads the payload in place in the frame, that stays valid until
+    // the function returns: see PipelinedRpc::readInPlace().
+    // Returns 0 if successful, a negative number otherwise.
+    typedef int (*RpcUnmarshalFnPtr) (void *pSvc, uint16 ui16Method, Reader *pRequest, Writer *pResponse);
+
+    // Marshals the payload of a request described by pArg into pPayload.
+    // It is invoked twice, first to compute the length of the payload and
+    // then to write it in place in the frame, and it must write the same
+    // bytes both times.
+    // Returns 0 if successful, a negative number otherwise.
+    typedef int (*RpcMarshalFnPtr) (const void *pArg, Writer *pPayload);
+
+    class PipelinedRpc
+    {
+        public:
+            enum Status
+            {
+                RPC_OK = 0x00,
+                RPC_ERROR = 0x01
+            };
+
+            static const String REGISTER_PROXY_RPC;
+            static const uint32 HEADER_LEN = 12;
+            static const uint32 MAX_PAYLOAD_LEN = 64U * 1024U * 1024U;
+
+            static void writeHeader (char *pszHeader, uint32 ui32PayloadLen, uint32 ui32RequestId,
+                                     uint16 ui16Method, uint16 ui16Status);
+
+            // Returns the payload length, or a negative number if the header
+            // is not valid
+            static int64 readHeader (const char *pszHeader, uint32 &ui32RequestId, uint16 &ui16Method,
+                                     uint16 &ui16Status);
+
+            // Returns a pointer to the next ui32Len bytes of the request read
+            // by pRequest, that must be the reader passed to an
+            // RpcUnmarshalFnPtr, and skips them, so that large fields are not
+            // copied out of the frame.  The pointer is valid until the
+            // RpcUnmarshalFnPtr returns.
+            // Returns NULL if there are fewer than ui32Len bytes left.
+            static const void * readInPlace (Reader *pRequest, uint32 ui32Len);
+    };
+
+    // The connection on which the frames are exchanged.
+    // Frames can be sent and received concurrently, but each of them by one
+    // thread at a time.
+    class RpcChannel
+    {
+        public:
+            virtual ~RpcChannel (void);
+
+            // Sends the frame made of the header and of the payload.
+            // Returns 0 if successful, a negative number otherwise.
+            virtual int sendFrame (const char *pszHeader, const void *pPayload, uint32 ui32PayloadLen) = 0;
+
+            // Sends a frame that the caller writes in place: reserveFrame()
+            // returns room for ui32FrameLen bytes, header included, or NULL
+            // in case of error.  The frame is then either sent by
+            // commitFrame(), that returns 0 if successful and a negative
+            // number otherwise, or discarded by cancelFrame().
+            virtual char * reserveFrame (uint32 ui32FrameLen) = 0;
+            virtual int commitFrame (void) = 0;
+            virtual void cancelFrame (void) = 0;
+
+            // Blocks until the next frame arrives. The frame, header
+            // included, is valid until releaseFrame() is invoked.
+            // Returns 0 if successful, a negative number otherwise.
+            virtual int receiveFrame (const char **ppFrame, uint32 &ui32FrameLen) = 0;
+            virtual void releaseFrame (void) = 0;
+
+            // Unblocks receiveFrame(), that will fail from now on
+            virtual void disableReceive (void) = 0;
+
+            // Returns the length of the longest frame, header included,
+            // that can be sent on the channel
+            virtual uint32 getMaxFrameLength (void);
+    };
+
+    class TCPRpcChannel : public RpcChannel
+    {
+        public:
+            // The channel deletes pCommHelper
+            explicit TCPRpcChannel (SimpleCommHelper2 *pCommHelper);
+            ~TCPRpcChannel (void);
+
+            int sendFrame (const char *pszHeader, const void *pPayload, uint32 ui32PayloadLen);
+            char * reserveFrame (uint32 ui32FrameLen);
+            int commitFrame (void);
+            void cancelFrame (void);
+            int receiveFrame (const char **ppFrame, uint32 &ui32FrameLen);
+            void releaseFrame (void);
+            void disableReceive (void);
+
+        private:
+            SimpleCommHelper2 *_pCommHelper;
+            char *_pSendBuf;            // The header and the payload are written at once
+            uint32 _ui32SendBufLen;
+            uint32 _ui32ReservedLen;
+            char *_pFrameBuf;
+            uint32 _ui32FrameBufLen;
+    };
+
+    class PipelinedRpcClient : public ManageableThread
+    {
+        public:
+            // pCommHelper must be connected and registered with
+            // REGISTER_PROXY_RPC. The client deletes it when done
+            explicit PipelinedRpcClient (SimpleCommHelper2 *pCommHelper);
+            explicit PipelinedRpcClient (RpcChannel *pChannel);
+            virtual ~PipelinedRpcClient (void);
+
+            // The client is reference counted, so that it can be replaced
+            // (by a reconnect) while other threads are still using it: the
+            // creator holds the first reference, and release() deletes the
+            // client when the last one is released
+            void addRef (void);
+            void release (void);
+
+            bool isConnected (void);
+
+            // Sends the request without waiting for the response.
+            // Returns the id of the request, or 0 in case of error.
+            // NOTE: the response must be retrieved with wait(), otherwise
+            // it is kept until the client is deleted
+            uint32 send (uint16 ui16Method, const void *pPayload, uint32 ui32PayloadLen);
+
+            // Same as above, but the payload is marshalled by pMarshaller
+            // directly into the frame, rather than copied from a buffer
+            uint32 send (uint16 ui16Method, RpcMarshalFnPtr pMarshaller, const void *pArg);
+
+            // Waits for the response to the request ui32RequestId.
+            // Request ids are not reused by other clients in the same process.
+            // If the call was successful, ppResponse is set to a reader on
+            // the response payload, that must be deleted by the caller.
+            // Returns 0 if successful, -1 if the request is not pending,
+            // -2 if the connection was lost, -3 if the server could not
+            // execute the call.
+            int wait (uint32 ui32RequestId, BufferReader **ppResponse);
+
+            // send() followed by wait().
+            // Returns the same values as wait(), and -2 if the request could
+            // not be sent, or -4 if the payload is longer than the channel
+            // can send (see getMaxPayloadLength()), in which case the caller
+            // may split it into smaller requests.
+            int call (uint16 ui16Method, const void *pPayload, uint32 ui32PayloadLen,
+                      BufferReader **ppResponse);
+            int call (uint16 ui16Method, RpcMarshalFnPtr pMarshaller, const void *pArg,
+                      BufferReader **ppResponse);
+
+            // Returns the length of the longest payload that can be sent
+            uint32 getMaxPayloadLength (void);
+
+            // Reads the responses
+            void run (void);
+
+            void requestTermination (void);
+            void requestTerminationAndWait (void);
+
+        private:
+            // Sets ui32RequestId to the id of the request that was sent.
+            // Returns 0 if successful, -1 if the request could not be
+            // marshalled, -2 if it is too long for the channel, or -3 if it
+            // could not be sent.
+            int sendRequest (uint16 ui16Method, RpcMarshalFnPtr pMarshaller, const void *pArg,
+                             uint32 &ui32RequestId);
+
+            // Returns the id of the new pending request, or 0 if not connected
+            uint32 addPendingRequest (void);
+            void removePendingRequest (uint32 ui32RequestId);
+
+            struct Response
+            {
+                Response (void);
+                ~Response (void);
+
+                bool bArrived;
+                uint16 ui16Status;
+                uint32 ui32PayloadLen;
+                void *pPayload;
+            };
+
+            bool _bConnected;
+            uint32 _ui32RefCount;
+            RpcChannel *_pChannel;
+            Mutex _mWrite;
+            Mutex _mPending;
+            ConditionVariable _cvPending;
+            UInt32Hashtable<Response> _pending;
+    };
+
+    class PipelinedRpcServer : public ManageableThread
+    {
+        public:
+            // pUnmarshaller is invoked on pSvc for each request, in the
+            // order in which they arrive.
+            // pCommHelper (or pChannel) is deleted by the server
+            PipelinedRpcServer (SimpleCommHelper2 *pCommHelper, RpcUnmarshalFnPtr pUnmarshaller, void *pSvc);
+            PipelinedRpcServer (RpcChannel *pChannel, RpcUnmarshalFnPtr pUnmarshaller, void *pSvc);
+            virtual ~PipelinedRpcServer (void);
+
+            void run (void);
+
+            void requestTermination (void);
+            void requestTerminationAndWait (void);
+
+        private:
+            RpcChannel *_pChannel;
+            RpcUnmarshalFnPtr _pUnmarshaller;
+            void *_pSvc;
+    };
+}
+
+#endif    /* INCL_PIPELINED_RPC_H */
@@ -0,0 +1,789 @@
+/*
+ * ShmRpcChannel.cpp
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ */
+
+#include "ShmRpcChannel.h"
+
+#include "Logger.h"
+#include "NLFLib.h"
+#include "SimpleCommHelper2.h"
+#include "TCPSocket.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined (LINUX)
+    #include <atomic>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <new>
+    #include <poll.h>
+    #include <stdlib.h>
+    #include <stddef.h>
+    #include <sys/eventfd.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+
+    #ifndef MFD_CLOEXEC
+        #define MFD_CLOEXEC 0x0001U
+    #endif
+    #ifndef MFD_ALLOW_SEALING
+        #define MFD_ALLOW_SEALING 0x0002U
+    #endif
+#endif
+
+#define checkAndLogMsg if (pLogger) pLogger->logMsg
+
+using namespace NOMADSUtil;
+
+const String ShmRpcChannel::REGISTER_PROXY_SHM = "RegisterProxyShm";
+const uint32 ShmRpcChannel::REQUEST_RING_SIZE;
+const uint32 ShmRpcChannel::RESPONSE_RING_SIZE;
+
+#if defined (LINUX)
+
+namespace SHM_RPC_CHANNEL
+{
+    // Shared by the two processes, at the beginning of the shared memory.
+    // head and tail count the bytes written and read since the ring was
+    // created, and are on separate cache lines since they are written by
+    // different processes
+    struct RingHeader
+    {
+        std::atomic<uint64> head;
+        char pad0[64 - sizeof (std::atomic<uint64>)];
+        std::atomic<uint64> tail;
+        char pad1[64 - sizeof (std::atomic<uint64>)];
+        std::atomic<uint32> readerWaiting;
+        std::atomic<uint32> writerWaiting;
+        std::atomic<uint32> closed;
+        uint32 ui32Size;
+        char pad2[64 - 4 * sizeof (uint32)];
+    };
+
+    // Each record is the length of the frame, followed by the frame itself,
+    // padded to a multiple of 8 bytes.  A record never wraps around the end
+    // of the ring: a WRAP record fills the space left at the end instead
+    static const uint32 RECORD_HEADER_LEN = 8U;
+    static const uint32 WRAP = 0xFFFFFFFFU;
+    static const uint32 TOKEN_LEN = 32U;
+    static const char NAME_PREFIX[] = "nomads-proxy-rpc-";
+    static const uint32 FD_COUNT = 5U;       // memfd and 4 eventfds
+    static const int NEGOTIATION_TIMEOUT = 5000;
+
+    uint32 recordLen (uint32 ui32FrameLen)
+    {
+        return (RECORD_HEADER_LEN + ui32FrameLen + 7U) & ~7U;
+    }
+
+    uint32 memoryLen (void)
+    {
+        return 2 * sizeof (RingHeader) + ShmRpcChannel::REQUEST_RING_SIZE + ShmRpcChannel::RESPONSE_RING_SIZE;
+    }
+
+    void signal (int iEventFd)
+    {
+        const uint64 ui64One = 1U;
+        if (write (iEventFd, &ui64One, sizeof (ui64One)) < 0) {
+            // The counter can only overflow if the peer never reads it
+        }
+    }
+
+    void closeAll (int *pFds, unsigned int uiCount)
+    {
+        for (unsigned int i = 0; i < uiCount; i++) {
+            if (pFds[i] >= 0) {
+                close (pFds[i]);
+                pFds[i] = -1;
+            }
+        }
+    }
+
+    int getControlFd (SimpleCommHelper2 *pControl)
+    {
+        TCPSocket *pSocket = dynamic_cast<TCPSocket *> (pControl->getSocket());
+        return (pSocket == NULL ? -1 : pSocket->getFileDescriptor());
+    }
+
+    void setReceiveTimeout (int iFd, int iTimeout)
+    {
+        struct timeval tv;
+        tv.tv_sec = iTimeout / 1000;
+        tv.tv_usec = (iTimeout % 1000) * 1000;
+        setsockopt (iFd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv));
+    }
+
+    int makeToken (char *pszToken)
+    {
+        unsigned char random[TOKEN_LEN / 2];
+        int iFd = open ("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        if (iFd < 0) {
+            return -1;
+        }
+        const ssize_t rc = read (iFd, random, sizeof (random));
+        close (iFd);
+        if (rc != (ssize_t) sizeof (random)) {
+            return -2;
+        }
+        for (unsigned int i = 0; i < sizeof (random); i++) {
+            sprintf (pszToken + 2 * i, "%02x", (unsigned int) random[i]);
+        }
+        return 0;
+    }
+
+    bool isLoopbackPeer (int iFd)
+    {
+        struct sockaddr_storage addr;
+        socklen_t addrLen = sizeof (addr);
+        if (getpeername (iFd, (struct sockaddr *) &addr, &addrLen) < 0) {
+            return false;
+        }
+        if (addr.ss_family == AF_INET) {
+            const struct sockaddr_in *pAddr = (const struct sockaddr_in *) &addr;
+            return ((ntohl (pAddr->sin_addr.s_addr) >> 24) == 127U);
+        }
+        if (addr.ss_family == AF_INET6) {
+            const struct in6_addr *pAddr = &((const struct sockaddr_in6 *) &addr)->sin6_addr;
+            return (IN6_IS_ADDR_LOOPBACK (pAddr) || (IN6_IS_ADDR_V4MAPPED (pAddr) && (pAddr->s6_addr[12] == 127U)));
+        }
+        return false;
+    }
+
+    // Names are "nomads-proxy-rpc-<pid>-<counter>", see ShmRpcChannel::offer().
+    // Returns the pid, or a negative number if the name is not valid
+    pid_t parseName (const char *pszName)
+    {
+        if (strncmp (pszName, NAME_PREFIX, sizeof (NAME_PREFIX) - 1) != 0) {
+            return -1;
+        }
+        const char *pszPid = pszName + sizeof (NAME_PREFIX) - 1;
+        const char *pszDash = strchr (pszPid, '-');
+        if ((pszDash == NULL) || (pszDash == pszPid) || (pszDash - pszPid > 10) || (pszDash[1] == '\0') ||
+            (strspn (pszPid, "0123456789") != (size_t) (pszDash - pszPid)) ||
+            (strspn (pszDash + 1, "0123456789") != strlen (pszDash + 1)) || (strlen (pszDash + 1) > 10)) {
+            return -2;
+        }
+        const long lPid = strtol (pszPid, NULL, 10);
+        return (lPid > 0 && lPid <= 0x7FFFFFFFL ? (pid_t) lPid : -3);
+    }
+
+    bool isValidToken (const char *pszToken)
+    {
+        // Written by makeToken()
+        return ((strlen (pszToken) == TOKEN_LEN) && (strspn (pszToken, "0123456789abcdef") == TOKEN_LEN));
+    }
+
+    socklen_t abstractAddress (const char *pszName, struct sockaddr_un &addr)
+    {
+        memset (&addr, 0, sizeof (addr));
+        addr.sun_family = AF_UNIX;
+        size_t len = strlen (pszName);
+        if (len > sizeof (addr.sun_path) - 1U) {
+            len = sizeof (addr.sun_path) - 1U;
+        }
+        memcpy (addr.sun_path + 1, pszName, len);   // sun_path[0] = '\0': abstract namespace
+        return (socklen_t) (offsetof (struct sockaddr_un, sun_path) + 1 + len);
+    }
+}
+
+using namespace SHM_RPC_CHANNEL;
+
+namespace NOMADSUtil
+{
+    // Single-producer, single-consumer ring of frames
+    class ShmRing
+    {
+        public:
+            // iDataFd is signaled when a frame is written, iSpaceFd when a
+            // frame is read.  The ring closes the file descriptors.
+            ShmRing (RingHeader *pHeader, char *pData, uint32 ui32Size, int iDataFd, int iSpaceFd, int iControlFd);
+            ~ShmRing (void);
+
+            // Producer side: reserve() blocks until there is space for the
+            // frame, and returns NULL if the frame can never fit or if the
+            // channel was closed
+            char * reserve (uint32 ui32FrameLen);
+            uint32 getMaxFrameLength (void) const;
+            void commit (void);
+            void cancel (void);
+
+            // Consumer side: peek() blocks until a frame is available, and
+            // returns NULL if the channel was closed
+            const char * peek (uint32 &ui32FrameLen);
+            void release (void);
+
+            void disableReceive (void);
+            void close (void);
+
+        private:
+            bool wait (std::atomic<uint32> &waiting, int iEventFd);
+
+            RingHeader *_pHeader;
+            char *_pData;
+            const uint32 _ui32Size;     // not read from the shared memory, that the peer could modify
+            int _iDataFd;
+            int _iSpaceFd;
+            const int _iControlFd;
+            uint64 _ui64Head;           // producer side
+            uint64 _ui64CommittedHead;
+            uint64 _ui64Tail;           // consumer side
+            uint64 _ui64NextTail;
+            std::atomic<bool> _bReceiveDisabled;
+    };
+}
+
+ShmRing::ShmRing (RingHeader *pHeader, char *pData, uint32 ui32Size, int iDataFd, int iSpaceFd, int iControlFd)
+    : _pHeader (pHeader),
+      _pData (pData),
+      _ui32Size (ui32Size),
+      _iDataFd (iDataFd),
+      _iSpaceFd (iSpaceFd),
+      _iControlFd (iControlFd),
+      _ui64Head (pHeader->head.load()),
+      _ui64CommittedHead (_ui64Head),
+      _ui64Tail (pHeader->tail.load()),
+      _ui64NextTail (_ui64Tail),
+      _bReceiveDisabled (false)
+{
+}
+
+ShmRing::~ShmRing (void)
+{
+    int fds[] = { _iDataFd, _iSpaceFd };
+    closeAll (fds, 2);
+}
+
+bool ShmRing::wait (std::atomic<uint32> &waiting, int iEventFd)
+{
+    struct pollfd fds[2];
+    fds[0].fd = iEventFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = _iControlFd;
+    fds[1].events = POLLIN;
+    int rc = poll (fds, (_iControlFd < 0 ? 1 : 2), -1);
+    waiting.store (0U);
+    if (rc < 0) {
+        return (errno == EINTR);
+    }
+    if (fds[0].revents & POLLIN) {
+        uint64 ui64Count = 0U;
+        if (read (iEventFd, &ui64Count, sizeof (ui64Count)) < 0) {
+            // EAGAIN: another wake up consumed the signal
+        }
+    }
+    // Nothing is sent on the control connection once the channel is set up:
+    // it is readable only if the peer went away
+    return ((_iControlFd < 0) || (fds[1].revents == 0));
+}
+
+char * ShmRing::reserve (uint32 ui32FrameLen)
+{
+    const uint32 ui32RecordLen = recordLen (ui32FrameLen);
+    if ((ui32FrameLen > PipelinedRpc::HEADER_LEN + PipelinedRpc::MAX_PAYLOAD_LEN) || (ui32RecordLen > _ui32Size / 2)) {
+        return NULL;
+    }
+    uint32 ui32Offset = (uint32) (_ui64Head & (_ui32Size - 1));
+    const uint32 ui32Contiguous = _ui32Size - ui32Offset;
+    const uint32 ui32Needed = (ui32RecordLen <= ui32Contiguous ? ui32RecordLen : ui32Contiguous + ui32RecordLen);
+    while (_ui32Size - (uint32) (_ui64Head - _pHeader->tail.load()) < ui32Needed) {
+        if (_pHeader->closed.load() != 0U) {
+            return NULL;
+        }
+        // Check again after announcing that the producer is waiting, since
+        // the consumer checks writerWaiting after updating the tail
+        _pHeader->writerWaiting.store (1U);
+        if (_ui32Size - (uint32) (_ui64Head - _pHeader->tail.load()) >= ui32Needed) {
+            _pHeader->writerWaiting.store (0U);
+            break;
+        }
+        if (!wait (_pHeader->writerWaiting, _iSpaceFd)) {
+            return NULL;
+        }
+    }
+    if (ui32RecordLen > ui32Contiguous) {
+        memcpy (_pData + ui32Offset, &WRAP, sizeof (WRAP));
+        _ui64Head += ui32Contiguous;
+        ui32Offset = 0U;
+    }
+    memcpy (_pData + ui32Offset, &ui32FrameLen, sizeof (ui32FrameLen));
+    _ui64Head += ui32RecordLen;
+    return _pData + ui32Offset + RECORD_HEADER_LEN;
+}
+
+uint32 ShmRing::getMaxFrameLength (void) const
+{
+    // The longest frame whose record fits in reserve()
+    const uint32 ui32MaxFrameLen = _ui32Size / 2 - RECORD_HEADER_LEN;
+    return minimum (ui32MaxFrameLen, PipelinedRpc::HEADER_LEN + PipelinedRpc::MAX_PAYLOAD_LEN);
+}
+
+void ShmRing::commit (void)
+{
+    _ui64CommittedHead = _ui64Head;
+    _pHeader->head.store (_ui64Head);
+    if (_pHeader->readerWaiting.load() != 0U) {
+        signal (_iDataFd);
+    }
+}
+
+void ShmRing::cancel (void)
+{
+    // The consumer has not seen the frame, nor the wrap record before it
+    _ui64Head = _ui64CommittedHead;
+}
+
+const char * ShmRing::peek (uint32 &ui32FrameLen)
+{
+    while (true) {
+        if (_pHeader->head.load() != _ui64Tail) {
+            const uint32 ui32Offset = (uint32) (_ui64Tail & (_ui32Size - 1));
+            memcpy (&ui32FrameLen, _pData + ui32Offset, sizeof (ui32FrameLen));
+            if (ui32FrameLen == WRAP) {
+                _ui64Tail += _ui32Size - ui32Offset;
+                _ui64NextTail = _ui64Tail;
+                release();
+                continue;
+            }
+            // The length is written by the peer: checked before recordLen(),
+            // that would wrap around for lengths close to 4GB
+            if ((ui32FrameLen < PipelinedRpc::HEADER_LEN) || (ui32FrameLen > _ui32Size - ui32Offset - RECORD_HEADER_LEN)) {
+                return NULL;
+            }
+            _ui64NextTail = _ui64Tail + recordLen (ui32FrameLen);
+            return _pData + ui32Offset + RECORD_HEADER_LEN;
+        }
+        if (_bReceiveDisabled.load() || (_pHeader->closed.load() != 0U)) {
+            return NULL;
+        }
+        // Check again after announcing that the consumer is waiting, since
+        // the producer checks readerWaiting after updating the head
+        _pHeader->readerWaiting.store (1U);
+        if ((_pHeader->head.load() != _ui64Tail) || _bReceiveDisabled.load()) {
+            _pHeader->readerWaiting.store (0U);
+            continue;
+        }
+        if (!wait (_pHeader->readerWaiting, _iDataFd)) {
+            return NULL;
+        }
+    }
+}
+
+void ShmRing::release (void)
+{
+    _ui64Tail = _ui64NextTail;
+    _pHeader->tail.store (_ui64Tail);
+    if (_pHeader->writerWaiting.load() != 0U) {
+        signal (_iSpaceFd);
+    }
+}
+
+void ShmRing::disableReceive (void)
+{
+    _bReceiveDisabled.store (true);
+    signal (_iDataFd);
+}
+
+void ShmRing::close (void)
+{
+    _pHeader->closed.store (1U);
+    signal (_iDataFd);
+    signal (_iSpaceFd);
+}
+
+//==============================================================================
+// ShmRpcChannel
+//==============================================================================
+
+ShmRpcChannel::ShmRpcChannel (SimpleCommHelper2 *pControl, void *pMemory, uint32 ui32MemoryLen,
+                              ShmRing *pSendRing, ShmRing *pReceiveRing)
+    : _pControl (pControl),
+      _pMemory (pMemory),
+      _ui32MemoryLen (ui32MemoryLen),
+      _pSendRing (pSendRing),
+      _pReceiveRing (pReceiveRing)
+{
+}
+
+ShmRpcChannel::~ShmRpcChannel (void)
+{
+    // Wakes up the peer, if it is waiting
+    _pSendRing->close();
+    _pReceiveRing->close();
+    delete _pSendRing;
+    delete _pReceiveRing;
+    munmap (_pMemory, _ui32MemoryLen);
+    if (_pControl != NULL) {
+        SimpleCommHelper2::Error error;
+        _pControl->closeConnection (error);
+        delete _pControl;
+        _pControl = NULL;
+    }
+}
+
+int ShmRpcChannel::sendFrame (const char *pszHeader, const void *pPayload, uint32 ui32PayloadLen)
+{
+    char *pFrame = _pSendRing->reserve (PipelinedRpc::HEADER_LEN + ui32PayloadLen);
+    if (pFrame == NULL) {
+        return -1;
+    }
+    memcpy (pFrame, pszHeader, PipelinedRpc::HEADER_LEN);
+    if (ui32PayloadLen > 0) {
+        memcpy (pFrame + PipelinedRpc::HEADER_LEN, pPayload, ui32PayloadLen);
+    }
+    _pSendRing->commit();
+    return 0;
+}
+
+char * ShmRpcChannel::reserveFrame (uint32 ui32FrameLen)
+{
+    return _pSendRing->reserve (ui32FrameLen);
+}
+
+uint32 ShmRpcChannel::getMaxFrameLength (void)
+{
+    return _pSendRing->getMaxFrameLength();
+}
+
+int ShmRpcChannel::commitFrame (void)
+{
+    _pSendRing->commit();
+    return 0;
+}
+
+void ShmRpcChannel::cancelFrame (void)
+{
+    _pSendRing->cancel();
+}
+
+int ShmRpcChannel::receiveFrame (const char **ppFrame, uint32 &ui32FrameLen)
+{
+    *ppFrame = _pReceiveRing->peek (ui32FrameLen);
+    return (*ppFrame == NULL ? -1 : 0);
+}
+
+void ShmRpcChannel::releaseFrame (void)
+{
+    _pReceiveRing->release();
+}
+
+void ShmRpcChannel::disableReceive (void)
+{
+    _pReceiveRing->disableReceive();
+}
+
+ShmRpcChannel * ShmRpcChannel::offer (SimpleCommHelper2 *pControl, uint16 ui16ApplicationId)
+{
+    const char *pszMethodName = "ShmRpcChannel::offer";
+    const int iControlFd = getControlFd (pControl);
+    if (iControlFd < 0) {
+        return NULL;
+    }
+
+    // Shared memory, sealed so that the server can not be made to fault by
+    // shrinking it, and the eventfds
+    int fds[FD_COUNT] = { -1, -1, -1, -1, -1 };
+    const uint32 ui32MemoryLen = memoryLen();
+    fds[0] = (int) syscall (SYS_memfd_create, "nomads-proxy-rpc", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if ((fds[0] < 0) || (ftruncate (fds[0], ui32MemoryLen) < 0) ||
+        (fcntl (fds[0], F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "could not create the shared memory; errno = %d\n", errno);
+        closeAll (fds, FD_COUNT);
+        return NULL;
+    }
+    for (unsigned int i = 1; i < FD_COUNT; i++) {
+        if ((fds[i] = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0) {
+            closeAll (fds, FD_COUNT);
+            return NULL;
+        }
+    }
+    void *pMemory = mmap (NULL, ui32MemoryLen, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    if (pMemory == MAP_FAILED) {
+        closeAll (fds, FD_COUNT);
+        return NULL;
+    }
+    RingHeader *pRequestHeader = new (pMemory) RingHeader();
+    RingHeader *pResponseHeader = new (pRequestHeader + 1) RingHeader();
+    pRequestHeader->ui32Size = REQUEST_RING_SIZE;
+    pResponseHeader->ui32Size = RESPONSE_RING_SIZE;
+
+    // The server proves that it received the token on the control
+    // connection before the file descriptors are passed to it
+    char szName[64];
+    char szToken[TOKEN_LEN + 1];
+    static std::atomic<uint32> ui32Counter (0U);
+    snprintf (szName, sizeof (szName), "%s%d-%u", NAME_PREFIX, (int) getpid(), (unsigned int) ui32Counter++);
+    int iListenFd = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr;
+    const socklen_t addrLen = abstractAddress (szName, addr);
+    if ((makeToken (szToken) < 0) || (iListenFd < 0) || (bind (iListenFd, (struct sockaddr *) &addr, addrLen) < 0) ||
+        (listen (iListenFd, 1) < 0)) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "could not set up the unix socket; errno = %d\n", errno);
+        if (iListenFd >= 0) {
+            close (iListenFd);
+        }
+        munmap (pMemory, ui32MemoryLen);
+        closeAll (fds, FD_COUNT);
+        return NULL;
+    }
+
+    SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+    pControl->sendLine (error, "%s %d", REGISTER_PROXY_SHM.c_str(), (int) ui16ApplicationId);
+    if (error == SimpleCommHelper2::None) {
+        pControl->sendLine (error, "%s %s", szName, szToken);
+    }
+    int iConnFd = -1;
+    if (error == SimpleCommHelper2::None) {
+        // A server on a different host, or one that refuses the channel,
+        // replies on the control connection without connecting
+        struct pollfd pfds[2];
+        pfds[0].fd = iListenFd;
+        pfds[0].events = POLLIN;
+        pfds[1].fd = iControlFd;
+        pfds[1].events = POLLIN;
+        if ((poll (pfds, 2, NEGOTIATION_TIMEOUT) > 0) && (pfds[0].revents & POLLIN)) {
+            iConnFd = accept4 (iListenFd, NULL, NULL, SOCK_CLOEXEC);
+        }
+    }
+    close (iListenFd);
+
+    bool bSent = false;
+    if (iConnFd >= 0) {
+        char szReceivedToken[TOKEN_LEN];
+        setReceiveTimeout (iConnFd, NEGOTIATION_TIMEOUT);
+        if ((recv (iConnFd, szReceivedToken, TOKEN_LEN, MSG_WAITALL) == (ssize_t) TOKEN_LEN) &&
+            (memcmp (szReceivedToken, szToken, TOKEN_LEN) == 0)) {
+            char cmsgBuf[CMSG_SPACE (sizeof (fds))];
+            memset (cmsgBuf, 0, sizeof (cmsgBuf));
+            uint32 ui32Len = ui32MemoryLen;
+            struct iovec iov;
+            iov.iov_base = &ui32Len;
+            iov.iov_len = sizeof (ui32Len);
+            struct msghdr msg;
+            memset (&msg, 0, sizeof (msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = cmsgBuf;
+            msg.msg_controllen = sizeof (cmsgBuf);
+            struct cmsghdr *pCmsg = CMSG_FIRSTHDR (&msg);
+            pCmsg->cmsg_level = SOL_SOCKET;
+            pCmsg->cmsg_type = SCM_RIGHTS;
+            pCmsg->cmsg_len = CMSG_LEN (sizeof (fds));
+            memcpy (CMSG_DATA (pCmsg), fds, sizeof (fds));
+            bSent = (sendmsg (iConnFd, &msg, MSG_NOSIGNAL) == (ssize_t) sizeof (ui32Len));
+        }
+        close (iConnFd);
+    }
+    if (bSent) {
+        pControl->receiveMatch (error, "OK");
+    }
+    close (fds[0]);     // the mapping is still valid
+    fds[0] = -1;
+    if (!bSent || (error != SimpleCommHelper2::None)) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "the server did not accept the shared memory channel\n");
+        munmap (pMemory, ui32MemoryLen);
+        closeAll (fds, FD_COUNT);
+        return NULL;
+    }
+
+    char *pRequestData = (char *) (pResponseHeader + 1);
+    char *pResponseData = pRequestData + REQUEST_RING_SIZE;
+    ShmRing *pSendRing = new ShmRing (pRequestHeader, pRequestData, REQUEST_RING_SIZE, fds[1], fds[2], iControlFd);
+    ShmRing *pReceiveRing = new ShmRing (pResponseHeader, pResponseData, RESPONSE_RING_SIZE, fds[3], fds[4], iControlFd);
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "opened shared memory channel for proxy %d\n", (int) ui16ApplicationId);
+    return new ShmRpcChannel (pControl, pMemory, ui32MemoryLen, pSendRing, pReceiveRing);
+}
+
+ShmRpcChannel * ShmRpcChannel::accept (SimpleCommHelper2 *pControl)
+{
+    const char *pszMethodName = "ShmRpcChannel::accept";
+    const int iControlFd = getControlFd (pControl);
+    SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+    const char **ppszBuf = pControl->receiveParsedSpecific ("1 1", error);
+    if ((iControlFd < 0) || (error != SimpleCommHelper2::None)) {
+        return NULL;
+    }
+
+    // The abstract socket namespace is shared by all the processes in the
+    // network namespace: the request is only honored if it comes from this
+    // host, and for a socket that is bound by a process of the same user
+    // whose pid is the one in the name, so that the token is never sent to,
+    // and the file descriptors are never read from, some other process
+    const pid_t clientPid = parseName (ppszBuf[0]);
+    if (!isLoopbackPeer (iControlFd) || (clientPid < 0) || !isValidToken (ppszBuf[1])) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "rejected a request that did not come from "
+                        "a local client or that was not valid\n");
+        return NULL;
+    }
+    int iConnFd = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr;
+    const socklen_t addrLen = abstractAddress (ppszBuf[0], addr);
+    if ((iConnFd < 0) || (connect (iConnFd, (struct sockaddr *) &addr, addrLen) < 0)) {
+        checkAndLogMsg (pszMethodName, Logger::L_Info, "could not connect to the client's unix socket; "
+                        "errno = %d\n", errno);
+        if (iConnFd >= 0) {
+            close (iConnFd);
+        }
+        return NULL;
+    }
+    struct ucred cred;
+    memset (&cred, 0, sizeof (cred));
+    socklen_t credLen = sizeof (cred);
+    if ((getsockopt (iConnFd, SOL_SOCKET, SO_PEERCRED, &cred, &credLen) < 0) || (cred.uid != geteuid()) ||
+        (cred.pid != clientPid)) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "the client's unix socket is bound by process %d "
+                        "of user %d, not by process %d of user %d\n", (int) cred.pid, (int) cred.uid,
+                        (int) clientPid, (int) geteuid());
+        close (iConnFd);
+        return NULL;
+    }
+    if (send (iConnFd, ppszBuf[1], TOKEN_LEN, MSG_NOSIGNAL) != (ssize_t) TOKEN_LEN) {
+        close (iConnFd);
+        return NULL;
+    }
+
+    int fds[FD_COUNT] = { -1, -1, -1, -1, -1 };
+    uint32 ui32MemoryLen = 0U;
+    struct iovec iov;
+    iov.iov_base = &ui32MemoryLen;
+    iov.iov_len = sizeof (ui32MemoryLen);
+    char cmsgBuf[CMSG_SPACE (sizeof (fds))];
+    struct msghdr msg;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsgBuf;
+    msg.msg_controllen = sizeof (cmsgBuf);
+    setReceiveTimeout (iConnFd, NEGOTIATION_TIMEOUT);
+    const ssize_t rc = recvmsg (iConnFd, &msg, MSG_CMSG_CLOEXEC);
+    close (iConnFd);
+    struct cmsghdr *pCmsg = CMSG_FIRSTHDR (&msg);
+    if ((pCmsg != NULL) && (pCmsg->cmsg_level == SOL_SOCKET) && (pCmsg->cmsg_type == SCM_RIGHTS) &&
+        (pCmsg->cmsg_len == CMSG_LEN (sizeof (fds)))) {
+        memcpy (fds, CMSG_DATA (pCmsg), sizeof (fds));
+    }
+    struct stat st;
+    const int iSeals = (fds[0] < 0 ? 0 : fcntl (fds[0], F_GET_SEALS));
+    if ((rc != (ssize_t) sizeof (ui32MemoryLen)) || (fds[FD_COUNT - 1] < 0) || (ui32MemoryLen != memoryLen()) ||
+        (iSeals < 0) || ((iSeals & F_SEAL_SHRINK) == 0) || (fstat (fds[0], &st) < 0) ||
+        (st.st_size < (off_t) ui32MemoryLen)) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "did not receive a valid shared memory\n");
+        closeAll (fds, FD_COUNT);
+        return NULL;
+    }
+    void *pMemory = mmap (NULL, ui32MemoryLen, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    close (fds[0]);
+    fds[0] = -1;
+    if (pMemory == MAP_FAILED) {
+        closeAll (fds, FD_COUNT);
+        return NULL;
+    }
+
+    // The ring sizes are not read from the shared memory
+    RingHeader *pRequestHeader = static_cast<RingHeader *> (pMemory);
+    RingHeader *pResponseHeader = pRequestHeader + 1;
+    char *pRequestData = (char *) (pResponseHeader + 1);
+    char *pResponseData = pRequestData + REQUEST_RING_SIZE;
+    ShmRing *pSendRing = new ShmRing (pResponseHeader, pResponseData, RESPONSE_RING_SIZE, fds[3], fds[4], iControlFd);
+    ShmRing *pReceiveRing = new ShmRing (pRequestHeader, pRequestData, REQUEST_RING_SIZE, fds[1], fds[2], iControlFd);
+    return new ShmRpcChannel (pControl, pMemory, ui32MemoryLen, pSendRing, pReceiveRing);
+}
+
+#else
+
+namespace NOMADSUtil
+{
+    class ShmRing
+    {
+    };
+}
+
+ShmRpcChannel::ShmRpcChannel (SimpleCommHelper2 *pControl, void *pMemory, uint32 ui32MemoryLen,
+                              ShmRing *pSendRing, ShmRing *pReceiveRing)
+    : _pControl (pControl),
+      _pMemory (pMemory),
+      _ui32MemoryLen (ui32MemoryLen),
+      _pSendRing (pSendRing),
+      _pReceiveRing (pReceiveRing)
+{
+}
+
+ShmRpcChannel::~ShmRpcChannel (void)
+{
+    delete _pSendRing;
+    delete _pReceiveRing;
+    delete _pControl;
+}
+
+int ShmRpcChannel::sendFrame (const char *, const void *, uint32)
+{
+    return -1;
+}
+
+char * ShmRpcChannel::reserveFrame (uint32)
+{
+    return NULL;
+}
+
+uint32 ShmRpcChannel::getMaxFrameLength (void)
+{
+    return 0U;
+}
+
+int ShmRpcChannel::commitFrame (void)
+{
+    return -1;
+}
+
+void ShmRpcChannel::cancelFrame (void)
+{
+}
+
+int ShmRpcChannel::receiveFrame (const char **, uint32 &)
+{
+    return -1;
+}
+
+void ShmRpcChannel::releaseFrame (void)
+{
+}
+
+void ShmRpcChannel::disableReceive (void)
+{
+}
+
+ShmRpcChannel * ShmRpcChannel::offer (SimpleCommHelper2 *, uint16)
+{
+    checkAndLogMsg ("ShmRpcChannel::offer", Logger::L_Info, "shared memory channels are not supported on this platform\n");
+    return NULL;
+}
+
+ShmRpcChannel * ShmRpcChannel::accept (SimpleCommHelper2 *pControl)
+{
+    // Consume the rest of the request
+    SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+    pControl->receiveLine (error);
+    return NULL;
+}
+
+#endif
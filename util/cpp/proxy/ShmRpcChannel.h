@@ -0,0 +1,104 @@
+/*
+ * ShmRpcChannel.h
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * RpcChannel that exchanges the frames of the pipelined RPC protocol through
+ * shared memory, for proxy clients running on the same host as the server.
+ *
+ * The client allocates a memfd holding two single-producer, single-consumer
+ * rings (one for the requests, one for the responses) and four eventfds, used
+ * to wake up a peer that is waiting for data or for space in a ring.  Frames
+ * are written in place in the rings (see RpcChannel::reserveFrame()), and the
+ * server unmarshals the requests directly from the shared memory, therefore
+ * payloads are not copied through the kernel.  The eventfds are only written
+ * when the peer is waiting.
+ *
+ * The channel is negotiated on a TCP connection to the proxy server, that is
+ * then only used to detect that the peer has gone away:
+ *   client: REGISTER_PROXY_SHM <application id>
+ *   client: <socket name> <token>
+ *   server connects to the abstract unix socket <socket name> and writes <token>
+ *   client sends the file descriptors on the unix socket
+ *   server: OK
+ * The file descriptors can only be passed on a unix socket, therefore the
+ * negotiation fails for clients on a different host, that then fall back on
+ * the TCP connection.
+ * The server only connects if the control connection comes from a loopback
+ * address, if the socket name is nomads-proxy-rpc-<pid>-<counter> and the
+ * token is hexadecimal, and it only sends the token if the socket is bound by
+ * the process <pid> of the same user (SO_PEERCRED): clients that run as a
+ * different user, or in a different pid namespace, use the TCP connection.
+ *
+ * Only supported on Linux.
+ */
+
+#ifndef INCL_SHM_RPC_CHANNEL_H
+#define INCL_SHM_RPC_CHANNEL_H
+
+#include "PipelinedRpc.h"
+
+namespace NOMADSUtil
+{
+    class ShmRing;
+
+    class ShmRpcChannel : public RpcChannel
+    {
+        public:
+            static const String REGISTER_PROXY_SHM;
+            static const uint32 REQUEST_RING_SIZE = 16U * 1024U * 1024U;
+            static const uint32 RESPONSE_RING_SIZE = 1024U * 1024U;
+
+            ~ShmRpcChannel (void);
+
+            // Client side: sends REGISTER_PROXY_SHM on pControl, that must be
+            // connected to the proxy server, and sets up the channel.
+            // On success, the channel takes ownership of pControl.
+            // Returns NULL if the channel could not be set up.
+            static ShmRpcChannel * offer (SimpleCommHelper2 *pControl, uint16 ui16ApplicationId);
+
+            // Server side: completes the negotiation after REGISTER_PROXY_SHM
+            // has been received on pControl.  The caller must then reply "OK".
+            // On success, the channel takes ownership of pControl.
+            // Returns NULL if the channel could not be set up.
+            static ShmRpcChannel * accept (SimpleCommHelper2 *pControl);
+
+            // Frames longer than the ring can not be sent
+            int sendFrame (const char *pszHeader, const void *pPayload, uint32 ui32PayloadLen);
+            char * reserveFrame (uint32 ui32FrameLen);
+            int commitFrame (void);
+            void cancelFrame (void);
+            int receiveFrame (const char **ppFrame, uint32 &ui32FrameLen);
+            void releaseFrame (void);
+            void disableReceive (void);
+
+            // A frame can take up to half of the ring
+            uint32 getMaxFrameLength (void);
+
+        private:
+            ShmRpcChannel (SimpleCommHelper2 *pControl, void *pMemory, uint32 ui32MemoryLen,
+                           ShmRing *pSendRing, ShmRing *pReceiveRing);
+
+        private:
+            SimpleCommHelper2 *_pControl;
+            void *_pMemory;
+            uint32 _ui32MemoryLen;
+            ShmRing *_pSendRing;
+            ShmRing *_pReceiveRing;
+    };
+}
+
+#endif    /* INCL_SHM_RPC_CHANNEL_H */
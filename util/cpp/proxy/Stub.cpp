@@ -22,7 +22,9 @@
 
 #include "Stub.h"
 
+#include "PipelinedRpc.h"
 #include "Protocol.h"
+#include "ShmRpcChannel.h"
 
 #include "NLFLib.h"
 #include "SemClass.h"
@@ -34,9 +36,13 @@
 using namespace NOMADSUtil;
 
 Stub::Stub (uint16 ui16ADesiredApplicationId, StubUnmarshalFnPtr pUnmarshaller,
-            const char *pszService, const char *pszVersion, bool bUseBackgroundReconnect)
+            const char *pszService, const char *pszVersion, bool bUseBackgroundReconnect,
+            bool bUsePipelinedRpc, bool bUseSharedMemory)
     : _pCommHelper (NULL),
+      _pRpcClient (NULL),
       _bUsingBackgroundReconnect (bUseBackgroundReconnect),
+      _bUsingPipelinedRpc (bUsePipelinedRpc),
+      _bUsingSharedMemory (bUseSharedMemory),
       _bReconnectStarted (false),
       _ui16ApplicationId (ui16ADesiredApplicationId),
       _ui16Port (0),
@@ -66,12 +72,28 @@ Stub::~Stub (void)
         delete _pCommHelper;
         _pCommHelper = NULL;
     }
+    if (_pRpcClient != NULL) {
+        _pRpcClient->requestTermination();
+        _pRpcClient->release();
+        _pRpcClient = NULL;
+    }
     _stubMutex.unlock();
     _pListener = NULL;
     delete _pReconnectSemaphore;
     _pReconnectSemaphore = NULL;
 }
 
+PipelinedRpcClient * Stub::getRpcClient (void)
+{
+    _stubMutex.lock();
+    PipelinedRpcClient *pRpcClient = _pRpcClient;
+    if (pRpcClient != NULL) {
+        pRpcClient->addRef();
+    }
+    _stubMutex.unlock();
+    return pRpcClient;
+}
+
 uint16 Stub::getApplicationId (void)
 {
     return _ui16ApplicationId;
@@ -161,6 +183,13 @@ void Stub::run()
             delete _pHandler;
             _pHandler = NULL;
         }
+        if (_pRpcClient != NULL) {
+            // Wakes up the callers waiting for responses, that still hold
+            // a reference to the client
+            _pRpcClient->requestTermination();
+            _pRpcClient->release();
+            _pRpcClient = NULL;
+        }
         _stubMutex.unlock();
 
         while (tryConnect() != 0) {
@@ -296,6 +325,57 @@ int Stub::registerProxy (SimpleCommHelper2 *pch, SimpleCommHelper2 *pchCallback,
     }
 }
 
+PipelinedRpcClient * Stub::registerProxyRpc (uint16 ui16ApplicationId)
+{
+    const char *pszMethodName = "Stub::registerProxyRpc";
+
+    SimpleCommHelper2 *pchRpc = connectToServer (_sHost.c_str(), _ui16Port);
+    if (pchRpc == NULL) {
+        return NULL;
+    }
+    SimpleCommHelper2::Error error = Protocol::doHandshake (pchRpc, _service, _version);
+    if (error == SimpleCommHelper2::None) {
+        pchRpc->sendLine (error, "%s %d", PipelinedRpc::REGISTER_PROXY_RPC.c_str(), static_cast<int>(ui16ApplicationId));
+    }
+    if (error == SimpleCommHelper2::None) {
+        pchRpc->receiveMatch (error, "OK");
+    }
+    if (error != SimpleCommHelper2::None) {
+        checkAndLogMsg (pszMethodName, Logger::L_Warning, "the server did not accept the pipelined "
+                        "RPC connection (error %d), using the text protocol only.\n", static_cast<int>(error));
+        delete pchRpc;
+        return NULL;
+    }
+    PipelinedRpcClient *pRpcClient = new PipelinedRpcClient (pchRpc);
+    pRpcClient->start();
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "registered pipelined RPC connection for proxy %d.\n",
+                    static_cast<int>(ui16ApplicationId));
+    return pRpcClient;
+}
+
+PipelinedRpcClient * Stub::registerProxyShm (uint16 ui16ApplicationId)
+{
+    const char *pszMethodName = "Stub::registerProxyShm";
+
+    SimpleCommHelper2 *pchRpc = connectToServer (_sHost.c_str(), _ui16Port);
+    if (pchRpc == NULL) {
+        return NULL;
+    }
+    SimpleCommHelper2::Error error = Protocol::doHandshake (pchRpc, _service, _version);
+    ShmRpcChannel *pChannel = (error == SimpleCommHelper2::None ? ShmRpcChannel::offer (pchRpc, ui16ApplicationId) : NULL);
+    if (pChannel == NULL) {
+        checkAndLogMsg (pszMethodName, Logger::L_Info, "the server did not accept the shared "
+                        "memory channel, using the TCP connection.\n");
+        delete pchRpc;
+        return NULL;
+    }
+    PipelinedRpcClient *pRpcClient = new PipelinedRpcClient (pChannel);
+    pRpcClient->start();
+    checkAndLogMsg (pszMethodName, Logger::L_Info, "registered shared memory RPC channel for proxy %d.\n",
+                    static_cast<int>(ui16ApplicationId));
+    return pRpcClient;
+}
+
 int Stub::tryConnect (void)
 {
     const char *pszMethodName = "Stub::run";
@@ -325,12 +405,20 @@ int Stub::tryConnect (void)
         return -3;
     }
     _ui16ApplicationId = static_cast<uint16>(rc);   // The server may have assigned a different id than requested
+    PipelinedRpcClient *pRpcClient = NULL;
+    if (_bUsingPipelinedRpc && _bUsingSharedMemory) {
+        pRpcClient = registerProxyShm (_ui16ApplicationId);
+    }
+    if (_bUsingPipelinedRpc && (pRpcClient == NULL)) {
+        pRpcClient = registerProxyRpc (_ui16ApplicationId);
+    }
 
     _stubMutex.lock();
     checkAndLogMsg (pszMethodName, Logger::L_Info,
                     "connected to proxy server, appid %d\n", _ui16ApplicationId);
 
     _pCommHelper = pch;
+    _pRpcClient = pRpcClient;
     _pHandler = new StubCallbackHandler (this, pchCallback, _pUnmarshaller);
     _pHandler->start();
 
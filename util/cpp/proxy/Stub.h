@@ -32,6 +32,7 @@
 
 namespace NOMADSUtil
 {
+    class PipelinedRpcClient;
     class Semaphore;
     class SimpleCommHelper2;
 
@@ -46,8 +47,14 @@ namespace NOMADSUtil
     {
         public:
             // pUnmarshaller is a function that is in charge of unmarshaling the callbacks
+            // If bUsePipelinedRpc is set, the stub also opens a connection for the
+            // pipelined binary protocol (see PipelinedRpc.h), if the server supports it.
+            // If bUseSharedMemory is also set, the pipelined RPC frames are exchanged
+            // through shared memory when the server runs on the same host (see
+            // ShmRpcChannel.h), and on the TCP connection otherwise
             Stub (uint16 ui16DesiredApplicationId, StubUnmarshalFnPtr pUnmarshaller,
-                  const char *pszService, const char *pszVersion, bool bUseBackgroundReconnect = false);
+                  const char *pszService, const char *pszVersion, bool bUseBackgroundReconnect = false,
+                  bool bUsePipelinedRpc = false, bool bUseSharedMemory = false);
             virtual ~Stub (void);
 
             // Initialize the proxy by connecting it to the DisseminationService Proxy Server
@@ -72,22 +79,33 @@ namespace NOMADSUtil
         protected:
             int reregisterListeners (void);
 
+            // Returns the pipelined RPC client with a reference that the
+            // caller must release(), or NULL if the connection is not open.
+            // _stubMutex must not be held while waiting for a response, and
+            // a reconnect does not delete a client that is still in use
+            PipelinedRpcClient * getRpcClient (void);
+
         private:
             friend class StubCallbackHandler;
 
             SimpleCommHelper2 * connectToServer (const char *pszHost, uint16 ui16Port);
             int registerProxy (SimpleCommHelper2 *pch, SimpleCommHelper2 *pchCallback,
                                uint16 ui16DesiredApplicationId);
+            PipelinedRpcClient * registerProxyRpc (uint16 ui16ApplicationId);
+            PipelinedRpcClient * registerProxyShm (uint16 ui16ApplicationId);
             int tryConnect (void);
             bool startReconnect (void);
             bool checkConnection (void);
 
         protected:
             SimpleCommHelper2 *_pCommHelper;
+            PipelinedRpcClient *_pRpcClient;    // NULL unless the pipelined RPC connection is open
             mutable Mutex _stubMutex;
 
         private:
             const bool _bUsingBackgroundReconnect;
+            const bool _bUsingPipelinedRpc;
+            const bool _bUsingSharedMemory;
             bool _bReconnectStarted;
             uint16 _ui16ApplicationId;
             uint16 _ui16Port;
@@ -0,0 +1,145 @@
+/*
+ * LoggerAsyncModeTest.cpp
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Checks that asynchronous mode can be enabled again after it has been
+ * disabled, and that no message is lost while it is enabled and disabled
+ * under several threads that keep logging: every message must be written
+ * to the log file, or counted as dropped.
+ * Returns 0 if successful, a negative number otherwise.
+ */
+
+#include "Logger.h"
+#include "NLFLib.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace NOMADSUtil;
+
+namespace LOGGER_ASYNC_MODE_TEST
+{
+    static const char * const LOG_FILE = "LoggerAsyncModeTest.log";
+    static const char * const SOURCE = "LoggerAsyncModeTest";
+    static const unsigned int THREADS = 4;
+    static const unsigned int MESSAGES_PER_THREAD = 20000;
+    static const unsigned int TOGGLES = 50;
+    // Small enough for some of the messages to be dropped
+    static const uint32 RING_SIZE = 64;
+
+    void produce (Logger *pLog, unsigned int uiThread)
+    {
+        for (unsigned int i = 0; i < MESSAGES_PER_THREAD; i++) {
+            pLog->logMsg (SOURCE, Logger::L_Info, "thread %u message %u\n", uiThread, i);
+        }
+    }
+
+    // Returns the number of lines logged by the test, or a negative number
+    long countLoggedMessages (void)
+    {
+        FILE *pFile = fopen (LOG_FILE, "r");
+        if (pFile == NULL) {
+            return -1;
+        }
+        long lCount = 0;
+        char szLine[256];
+        while (fgets (szLine, sizeof (szLine), pFile) != NULL) {
+            if (strstr (szLine, SOURCE) != NULL) {
+                lCount++;
+            }
+        }
+        fclose (pFile);
+        return lCount;
+    }
+}
+
+using namespace LOGGER_ASYNC_MODE_TEST;
+
+int main (int argc, char *argv[])
+{
+    Logger *pLog = new Logger();
+    if (pLog->initLogFile (LOG_FILE, false) < 0) {
+        printf ("could not open %s\n", LOG_FILE);
+        return -1;
+    }
+    pLog->enableFileOutput();
+    pLog->setDebugLevel (Logger::L_Info);
+
+    // Enable, log, disable and enable again
+    if (pLog->enableAsyncMode (RING_SIZE) != 0) {
+        printf ("could not enable asynchronous mode\n");
+        return -2;
+    }
+    if (pLog->enableAsyncMode (RING_SIZE) != -2) {
+        printf ("asynchronous mode was enabled twice\n");
+        return -3;
+    }
+    pLog->logMsg (SOURCE, Logger::L_Info, "single message\n");
+    pLog->disableAsyncMode();
+    if (pLog->enableAsyncMode (RING_SIZE) != 0) {
+        printf ("could not enable asynchronous mode again after disabling it\n");
+        return -4;
+    }
+
+    // Keep enabling and disabling asynchronous mode while the threads log
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < THREADS; i++) {
+        threads.push_back (std::thread (produce, pLog, i));
+    }
+    for (unsigned int i = 0; i < TOGGLES; i++) {
+        sleepForMilliseconds (2);
+        pLog->disableAsyncMode();
+        sleepForMilliseconds (1);
+        if (pLog->enableAsyncMode (RING_SIZE) != 0) {
+            printf ("could not enable asynchronous mode again after disabling it\n");
+            return -5;
+        }
+    }
+    for (unsigned int i = 0; i < THREADS; i++) {
+        threads[i].join();
+    }
+    pLog->disableAsyncMode();
+
+    const uint64 ui64Dropped = pLog->getDroppedMessagesCount();
+    const long lExpected = (long) (1 + THREADS * MESSAGES_PER_THREAD - ui64Dropped);
+    const long lLogged = countLoggedMessages();
+    printf ("%ld messages written and %lu dropped, %ld written expected\n",
+            lLogged, (unsigned long) ui64Dropped, lExpected);
+    if (lLogged != lExpected) {
+        return -6;
+    }
+
+    // Deleting the logger disables asynchronous mode
+    if (pLog->enableAsyncMode (RING_SIZE) != 0) {
+        printf ("could not enable asynchronous mode again after disabling it\n");
+        return -7;
+    }
+    pLog->logMsg (SOURCE, Logger::L_Info, "last message\n");
+    delete pLog;
+    if (countLoggedMessages() != lExpected + 1) {
+        printf ("the message logged before deleting the logger was not written\n");
+        return -8;
+    }
+
+    remove (LOG_FILE);
+    printf ("LoggerAsyncModeTest passed\n");
+    return 0;
+}
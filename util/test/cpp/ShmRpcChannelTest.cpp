@@ -0,0 +1,177 @@
+/*
+ * ShmRpcChannelTest.cpp
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Sets up a shared memory channel on a loopback connection and checks that
+ * the receiving side rejects the frames whose length, written by the peer
+ * in the shared memory, does not fit in the ring, rather than returning a
+ * frame that extends past the mapping.
+ * Returns 0 if successful, a negative number otherwise.
+ */
+
+#include "InetAddr.h"
+#include "PipelinedRpc.h"
+#include "ShmRpcChannel.h"
+#include "SimpleCommHelper2.h"
+#include "TCPSocket.h"
+
+#include <thread>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace NOMADSUtil;
+
+namespace SHM_RPC_CHANNEL_TEST
+{
+    // Size of the length that precedes each frame in the ring
+    static const uint32 RECORD_HEADER_LEN = 8U;
+
+    SimpleCommHelper2 * newCommHelper (TCPSocket *pSocket)
+    {
+        pSocket->bufferingMode (false);
+        SimpleCommHelper2 *pch = new SimpleCommHelper2();
+        if (pch->init (pSocket) != 0) {
+            delete pch;
+            delete pSocket;
+            return NULL;
+        }
+        pch->setDeleteUnderlyingSocket (true);
+        return pch;
+    }
+
+    // Server side of the negotiation
+    void acceptChannel (SimpleCommHelper2 *pCommHelper, ShmRpcChannel **ppChannel)
+    {
+        SimpleCommHelper2::Error error = SimpleCommHelper2::None;
+        const char **ppszBuf = pCommHelper->receiveParsedSpecific ("1 1", error);
+        if ((error == SimpleCommHelper2::None) && (0 == strcmp (ppszBuf[0], ShmRpcChannel::REGISTER_PROXY_SHM.c_str()))) {
+            *ppChannel = ShmRpcChannel::accept (pCommHelper);
+        }
+        if (*ppChannel != NULL) {
+            pCommHelper->sendLine (error, "OK");
+        }
+        else {
+            delete pCommHelper;
+        }
+    }
+
+    // Sets up the two sides of a channel on a loopback connection
+    int openChannel (ShmRpcChannel **ppClient, ShmRpcChannel **ppServer)
+    {
+        TCPSocket serverSocket;
+        if (serverSocket.setupToReceive (0, 1, InetAddr ("127.0.0.1").getIPAddress()) != 0) {
+            return -1;
+        }
+        TCPSocket *pClientSocket = new TCPSocket();
+        if (pClientSocket->connect ("127.0.0.1", serverSocket.getLocalPort()) != 0) {
+            delete pClientSocket;
+            return -2;
+        }
+        TCPSocket *pServerSocket = static_cast<TCPSocket *> (serverSocket.accept());
+        if (pServerSocket == NULL) {
+            delete pClientSocket;
+            return -3;
+        }
+        SimpleCommHelper2 *pServer = newCommHelper (pServerSocket);
+        SimpleCommHelper2 *pClient = newCommHelper (pClientSocket);
+        if ((pServer == NULL) || (pClient == NULL)) {
+            delete pServer;
+            delete pClient;
+            return -4;
+        }
+        *ppServer = NULL;
+        std::thread acceptor (acceptChannel, pServer, ppServer);
+        *ppClient = ShmRpcChannel::offer (pClient, 1);
+        acceptor.join();
+        if (*ppClient == NULL) {
+            delete pClient;
+        }
+        if ((*ppClient == NULL) || (*ppServer == NULL)) {
+            return -5;
+        }
+        return 0;
+    }
+}
+
+using namespace SHM_RPC_CHANNEL_TEST;
+
+int main (int argc, char *argv[])
+{
+    ShmRpcChannel *pClient = NULL;
+    ShmRpcChannel *pServer = NULL;
+    int rc = openChannel (&pClient, &pServer);
+    if (rc < 0) {
+        printf ("could not set up the shared memory channel; rc = %d\n", rc);
+        delete pClient;
+        delete pServer;
+        return -1;
+    }
+
+    // A valid frame goes through
+    char achHeader[PipelinedRpc::HEADER_LEN];
+    memset (achHeader, 0, sizeof (achHeader));
+    const char achPayload[] = "payload";
+    const char *pFrame = NULL;
+    uint32 ui32FrameLen = 0U;
+    if ((pClient->sendFrame (achHeader, achPayload, sizeof (achPayload)) != 0) ||
+        (pServer->receiveFrame (&pFrame, ui32FrameLen) != 0) ||
+        (ui32FrameLen != PipelinedRpc::HEADER_LEN + sizeof (achPayload)) ||
+        (memcmp (pFrame + PipelinedRpc::HEADER_LEN, achPayload, sizeof (achPayload)) != 0)) {
+        printf ("a valid frame was not received\n");
+        delete pClient;
+        delete pServer;
+        return -2;
+    }
+    pServer->releaseFrame();
+
+    // The client plays a peer that corrupts the length of the next record
+    char *pReserved = pClient->reserveFrame (PipelinedRpc::HEADER_LEN);
+    if (pReserved == NULL) {
+        printf ("could not reserve a frame\n");
+        delete pClient;
+        delete pServer;
+        return -3;
+    }
+    memcpy (pReserved, achHeader, PipelinedRpc::HEADER_LEN);
+    pClient->commitFrame();
+    const uint32 corruptLengths[] = {
+        0xFFFFFFF8U, 0xFFFFFFFBU, 0xFFFFFFFEU,      // wrap around when padded
+        ShmRpcChannel::REQUEST_RING_SIZE,           // longer than the ring
+        PipelinedRpc::HEADER_LEN - 1                // shorter than a header
+    };
+    rc = 0;
+    for (unsigned int i = 0; i < sizeof (corruptLengths) / sizeof (corruptLengths[0]); i++) {
+        memcpy (pReserved - RECORD_HEADER_LEN, &corruptLengths[i], sizeof (uint32));
+        ui32FrameLen = 0U;
+        if (pServer->receiveFrame (&pFrame, ui32FrameLen) == 0) {
+            printf ("a frame with the corrupt length 0x%08x was accepted, and returned with length %u\n",
+                    (unsigned int) corruptLengths[i], (unsigned int) ui32FrameLen);
+            rc = -4;
+        }
+        else {
+            printf ("the corrupt length 0x%08x was rejected\n", (unsigned int) corruptLengths[i]);
+        }
+    }
+
+    delete pClient;
+    delete pServer;
+    if (rc == 0) {
+        printf ("ShmRpcChannelTest passed\n");
+    }
+    return rc;
+}
@@ -0,0 +1,313 @@
+/*
+ * ThreadPoolPerformanceTest.cpp
+ *
+ * This file is part of the IHMC Util Library
+ * Copyright (c) 1993-2016 IHMC.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 (GPLv3) as published by the Free Software Foundation.
+ *
+ * U.S. Government agencies and organizations may redistribute
+ * and/or modify this program under terms equivalent to
+ * "Government Purpose Rights" as defined by DFARS
+ * 252.227-7014(a)(12) (February 2014).
+ *
+ * Alternative licenses that allow for use within commercial products may be
+ * available. Contact Niranjan Suri at IHMC (nsuri@ihmc.us) for details.
+ *
+ * Measures how the throughput of ThreadPool scales from 1 to N workers,
+ * compared with a pool that dispatches the tasks through a single queue
+ * protected by a mutex, as ThreadPool used to do.
+ * - external: the main thread enqueues all the tasks
+ * - nested: each task splits its range in two and enqueues both halves,
+ *   so that most of the tasks are enqueued by the workers themselves
+ * Finally, it checks the results returned by submit() through futures.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "ConditionVariable.h"
+#include "Mutex.h"
+#include "NLFLib.h"
+#include "Queue.h"
+#include "Thread.h"
+#include "ThreadPool.h"
+
+#if defined (UNIX)
+    #include <unistd.h>
+#endif
+
+using namespace NOMADSUtil;
+
+namespace ThreadPoolPerformanceTest
+{
+    // Pool with a fixed number of workers and a single locked queue
+    class LockedQueuePool
+    {
+        public:
+            explicit LockedQueuePool (int iNumWorkers);
+            ~LockedQueuePool (void);
+
+            int enqueue (Runnable *pRunnable, bool bDeleteWhenFinished, ThreadPoolMonitor *pTPMon);
+
+        private:
+            struct Task
+            {
+                Runnable *pRunnable;
+                bool bDeleteWhenFinished;
+                ThreadPoolMonitor *pTPMon;
+            };
+
+            class Worker : public Thread
+            {
+                public:
+                    explicit Worker (LockedQueuePool *pPool) : _pPool (pPool) {}
+                    void run (void);
+
+                private:
+                    LockedQueuePool *_pPool;
+            };
+
+            Queue<Task> _tasks;
+            Mutex _m;
+            ConditionVariable _cv;
+            bool _bTerminate;
+            std::vector<Worker *> _workers;
+    };
+
+    LockedQueuePool::LockedQueuePool (int iNumWorkers)
+        : _cv (&_m),
+          _bTerminate (false)
+    {
+        for (int i = 0; i < iNumWorkers; i++) {
+            _workers.push_back (new Worker (this));
+            _workers.back()->start (false);
+        }
+    }
+
+    LockedQueuePool::~LockedQueuePool (void)
+    {
+        _m.lock();
+        _bTerminate = true;
+        _cv.notifyAll();
+        _m.unlock();
+        for (size_t i = 0; i < _workers.size(); i++) {
+            _workers[i]->join();
+            delete _workers[i];
+        }
+    }
+
+    int LockedQueuePool::enqueue (Runnable *pRunnable, bool bDeleteWhenFinished, ThreadPoolMonitor *pTPMon)
+    {
+        Task task = { pRunnable, bDeleteWhenFinished, pTPMon };
+        _m.lock();
+        _tasks.enqueue (task);
+        _cv.notify();
+        _m.unlock();
+        return 0;
+    }
+
+    void LockedQueuePool::Worker::run (void)
+    {
+        while (true) {
+            Task task;
+            _pPool->_m.lock();
+            while (_pPool->_tasks.isEmpty() && !_pPool->_bTerminate) {
+                _pPool->_cv.wait();
+            }
+            if (_pPool->_tasks.isEmpty()) {
+                _pPool->_m.unlock();
+                return;
+            }
+            _pPool->_tasks.dequeue (task);
+            _pPool->_m.unlock();
+            int rc = task.pRunnable->run();
+            if (task.bDeleteWhenFinished) {
+                delete task.pRunnable;
+            }
+            if (task.pTPMon != NULL) {
+                task.pTPMon->runFinished (task.pRunnable, rc);
+            }
+        }
+    }
+
+    std::atomic<uint32> ui32Sink;
+
+    void work (uint32 ui32Iterations)
+    {
+        uint32 ui32Value = ui32Iterations;
+        for (uint32 i = 0; i < ui32Iterations; i++) {
+            ui32Value = ui32Value * 1664525U + 1013904223U;
+        }
+        ui32Sink.store (ui32Value, std::memory_order_relaxed);
+    }
+
+    class CompletionMonitor : public ThreadPoolMonitor
+    {
+        public:
+            explicit CompletionMonitor (uint32 ui32Expected)
+                : _ui32Left (ui32Expected), _cv (&_m) {}
+
+            void runFinished (Runnable *pRunnable, int iRunRC)
+            {
+                _m.lock();
+                _ui32Left--;
+                if (_ui32Left == 0) {
+                    _cv.notifyAll();
+                }
+                _m.unlock();
+            }
+
+            void waitForAll (void)
+            {
+                _m.lock();
+                while (_ui32Left > 0) {
+                    _cv.wait();
+                }
+                _m.unlock();
+            }
+
+        private:
+            uint32 _ui32Left;
+            Mutex _m;
+            ConditionVariable _cv;
+    };
+
+    class WorkTask : public Runnable
+    {
+        public:
+            explicit WorkTask (uint32 ui32Iterations) : _ui32Iterations (ui32Iterations) {}
+            int run (void)
+            {
+                work (_ui32Iterations);
+                return 0;
+            }
+
+        private:
+            const uint32 _ui32Iterations;
+    };
+
+    // Splits [ui32Begin, ui32End) in two halves until a single leaf is left
+    template <class Pool> class SplitTask : public Runnable
+    {
+        public:
+            SplitTask (Pool *pPool, CompletionMonitor *pMonitor, uint32 ui32Begin, uint32 ui32End, uint32 ui32Iterations)
+                : _pPool (pPool), _pMonitor (pMonitor), _ui32Begin (ui32Begin), _ui32End (ui32End),
+                  _ui32Iterations (ui32Iterations) {}
+
+            int run (void)
+            {
+                if ((_ui32End - _ui32Begin) > 1) {
+                    const uint32 ui32Middle = _ui32Begin + (_ui32End - _ui32Begin) / 2;
+                    _pPool->enqueue (new SplitTask (_pPool, _pMonitor, _ui32Begin, ui32Middle, _ui32Iterations), true, _pMonitor);
+                    _pPool->enqueue (new SplitTask (_pPool, _pMonitor, ui32Middle, _ui32End, _ui32Iterations), true, _pMonitor);
+                }
+                else {
+                    work (_ui32Iterations);
+                }
+                return 0;
+            }
+
+        private:
+            Pool *_pPool;
+            CompletionMonitor *_pMonitor;
+            const uint32 _ui32Begin;
+            const uint32 _ui32End;
+            const uint32 _ui32Iterations;
+    };
+
+    // Returns the number of tasks executed per second
+    template <class Pool> double runExternal (int iNumWorkers, uint32 ui32Tasks, uint32 ui32Iterations)
+    {
+        Pool pool (iNumWorkers);
+        CompletionMonitor monitor (ui32Tasks);
+        const int64 i64Start = getTimeInMilliseconds();
+        for (uint32 i = 0; i < ui32Tasks; i++) {
+            pool.enqueue (new WorkTask (ui32Iterations), true, &monitor);
+        }
+        monitor.waitForAll();
+        const int64 i64Elapsed = getTimeInMilliseconds() - i64Start;
+        return (ui32Tasks * 1000.0) / (i64Elapsed > 0 ? i64Elapsed : 1);
+    }
+
+    template <class Pool> double runNested (int iNumWorkers, uint32 ui32Leaves, uint32 ui32Iterations)
+    {
+        Pool pool (iNumWorkers);
+        // A binary tree with ui32Leaves leaves has 2 * ui32Leaves - 1 nodes
+        const uint32 ui32Tasks = (2 * ui32Leaves) - 1;
+        CompletionMonitor monitor (ui32Tasks);
+        const int64 i64Start = getTimeInMilliseconds();
+        pool.enqueue (new SplitTask<Pool> (&pool, &monitor, 0, ui32Leaves, ui32Iterations), true, &monitor);
+        monitor.waitForAll();
+        const int64 i64Elapsed = getTimeInMilliseconds() - i64Start;
+        return (ui32Tasks * 1000.0) / (i64Elapsed > 0 ? i64Elapsed : 1);
+    }
+
+    int checkFutures (int iNumWorkers)
+    {
+        ThreadPool pool (iNumWorkers);
+        std::vector<std::future<uint64> > results;
+        for (uint64 i = 0; i < 1000; i++) {
+            results.push_back (pool.submit ([i]() { return i * i; }));
+        }
+        for (uint64 i = 0; i < results.size(); i++) {
+            if (results[i].get() != i * i) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+}
+
+using namespace ThreadPoolPerformanceTest;
+
+int main (int argc, char **ppszArgv)
+{
+    int iMaxWorkers = 4;
+    #if defined (UNIX)
+        const long lCPUs = sysconf (_SC_NPROCESSORS_ONLN);
+        if (lCPUs > 0) {
+            iMaxWorkers = (int) lCPUs;
+        }
+    #endif
+    if (argc > 1) {
+        iMaxWorkers = atoi (ppszArgv[1]);
+    }
+    const uint32 ui32Tasks = (argc > 2) ? (uint32) atoi (ppszArgv[2]) : 200000;
+    const uint32 ui32Iterations = (argc > 3) ? (uint32) atoi (ppszArgv[3]) : 1000;
+    if ((iMaxWorkers <= 0) || (ui32Tasks == 0)) {
+        fprintf (stderr, "usage: %s [<maxWorkers> [<tasks> [<iterationsPerTask>]]]\n", ppszArgv[0]);
+        return -1;
+    }
+
+    printf ("%u tasks, %u iterations per task\n", ui32Tasks, ui32Iterations);
+    printf ("%7s | %-8s | %14s | %16s | %7s\n", "workers", "test", "locked tasks/s", "stealing tasks/s", "speedup");
+    for (int iWorkers = 1; ; iWorkers *= 2) {
+        if (iWorkers > iMaxWorkers) {
+            iWorkers = iMaxWorkers;
+        }
+        const double dLockedExternal = runExternal<LockedQueuePool> (iWorkers, ui32Tasks, ui32Iterations);
+        const double dStealingExternal = runExternal<ThreadPool> (iWorkers, ui32Tasks, ui32Iterations);
+        printf ("%7d | %-8s | %14.0f | %16.0f | %6.2fx\n", iWorkers, "external",
+                dLockedExternal, dStealingExternal, dStealingExternal / dLockedExternal);
+        const double dLockedNested = runNested<LockedQueuePool> (iWorkers, ui32Tasks / 2, ui32Iterations);
+        const double dStealingNested = runNested<ThreadPool> (iWorkers, ui32Tasks / 2, ui32Iterations);
+        printf ("%7d | %-8s | %14.0f | %16.0f | %6.2fx\n", iWorkers, "nested",
+                dLockedNested, dStealingNested, dStealingNested / dLockedNested);
+        if (iWorkers == iMaxWorkers) {
+            break;
+        }
+    }
+
+    if (checkFutures (iMaxWorkers) < 0) {
+        fprintf (stderr, "submit() returned a wrong result\n");
+        return -2;
+    }
+    return 0;
+}